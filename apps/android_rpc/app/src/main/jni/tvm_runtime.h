@@ -44,6 +44,7 @@
 #include "../src/runtime/module.cc"
 #include "../src/runtime/registry.cc"
 #include "../src/runtime/file_util.cc"
+#include "../src/runtime/mapped_file.cc"
 #include "../src/runtime/dso_library.cc"
 #include "../src/runtime/rpc/rpc_session.cc"
 #include "../src/runtime/rpc/rpc_event_impl.cc"
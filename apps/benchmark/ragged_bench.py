@@ -0,0 +1,177 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Benchmark script for ragged kernels over length distributions.
+see README.md for the usage of this script.
+"""
+import argparse
+import json
+import sys
+
+import numpy as np
+
+import tvm
+import topi
+
+from ragged_util import sample_batches, padding_waste
+
+
+def get_kernel(name, batch_size, max_len, hidden):
+    """Get the compute declaration and schedule of a ragged kernel
+
+    Parameters
+    ----------
+    name: str
+        The name of the kernel, can be 'softmax', 'layer_norm' or 'batch_matmul'
+    batch_size: int
+        batch size
+    max_len: int
+        The padded sequence length
+    hidden: int
+        The hidden size
+
+    Returns
+    -------
+    sch: Schedule
+        The schedule of the kernel
+    args: list of Tensor
+        The arguments of the kernel. The last one before the output is
+        the lengths tensor.
+    """
+    lengths = tvm.placeholder((batch_size,), name='lengths', dtype='int32')
+    if name == 'softmax':
+        x = tvm.placeholder((batch_size, max_len, max_len), name='x')
+        out = topi.nn.ragged_softmax(x, lengths, axis=2, batch_axis=0)
+        inputs = [x]
+        sch = topi.generic.schedule_ragged_softmax([out])
+    elif name == 'layer_norm':
+        x = tvm.placeholder((batch_size, max_len, hidden), name='x')
+        gamma = tvm.placeholder((hidden,), name='gamma')
+        beta = tvm.placeholder((hidden,), name='beta')
+        out = topi.nn.ragged_layer_norm(x, gamma, beta, lengths)
+        inputs = [x, gamma, beta]
+        sch = topi.generic.schedule_ragged_layer_norm([out])
+    elif name == 'batch_matmul':
+        x = tvm.placeholder((batch_size, max_len, hidden), name='x')
+        y = tvm.placeholder((batch_size, hidden, hidden), name='y')
+        out = topi.nn.ragged_batch_matmul(x, y, lengths)
+        inputs = [x, y]
+        sch = topi.generic.schedule_ragged_batch_matmul([out])
+    else:
+        raise ValueError("Unsupported kernel: " + name)
+    return sch, inputs + [lengths, out]
+
+
+def benchmark(name, target, batches, args):
+    """Measure a kernel on every batch of lengths, and once with every
+    length padded to max_len as the dense baseline."""
+    with target:
+        sch, tensors = get_kernel(name, args.batch_size, args.max_len, args.hidden)
+    func = tvm.build(sch, tensors, target)
+
+    ctx = tvm.context(str(target), 0)
+    nd_args = [tvm.nd.array(np.random.uniform(size=topi.util.get_const_tuple(t.shape))
+                            .astype(t.dtype), ctx) for t in tensors]
+    ftimer = func.time_evaluator(func.entry_name, ctx, number=args.number, repeat=args.repeat)
+
+    def measure(batch):
+        nd_args[-2] = tvm.nd.array(np.array(batch, dtype='int32'), ctx)
+        return np.mean(ftimer(*nd_args).results) * 1000  # millisecond
+
+    latencies = np.array([measure(batch) for batch in batches])
+    dense_latency = measure([args.max_len] * args.batch_size)
+    tokens = np.array([sum(batch) for batch in batches], dtype='float64')
+    return {
+        'kernel': name,
+        'batch_size': args.batch_size,
+        'max_len': args.max_len,
+        'hidden': args.hidden,
+        'latency_ms': {
+            'mean': float(np.mean(latencies)),
+            'p50': float(np.percentile(latencies, 50)),
+            'p90': float(np.percentile(latencies, 90)),
+            'p99': float(np.percentile(latencies, 99)),
+        },
+        'dense_latency_ms': float(dense_latency),
+        'speedup': float(dense_latency / np.mean(latencies)),
+        # throughput counts the valid tokens only, for both versions
+        'tokens_per_sec': float(np.sum(tokens) / np.sum(latencies) * 1000),
+        'dense_tokens_per_sec': float(np.mean(tokens) / dense_latency * 1000),
+        'padding_waste': float(np.mean([padding_waste(b, args.max_len) for b in batches])),
+    }
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--kernel", type=str,
+                        choices=['softmax', 'layer_norm', 'batch_matmul'],
+                        help="The ragged kernel to benchmark. All of them by default.")
+    parser.add_argument("--target", type=str, default='cuda', help="The tvm compilation target")
+    parser.add_argument("--dist", type=str, default='uniform',
+                        choices=['uniform', 'zipf', 'trace', 'squad', 'wmt'],
+                        help="The length distribution")
+    parser.add_argument("--path", type=str,
+                        help="The trace file, SQuAD json or WMT text for the trace, squad and "
+                             "wmt distributions")
+    parser.add_argument("--min-len", type=int, default=1,
+                        help="The smallest length of the uniform distribution")
+    parser.add_argument("--zipf-a", type=float, default=1.5,
+                        help="The exponent of the zipf distribution")
+    parser.add_argument("--batch-size", type=int, default=32)
+    parser.add_argument("--max-len", type=int, default=512)
+    parser.add_argument("--hidden", type=int, default=768)
+    parser.add_argument("--num-batches", type=int, default=20,
+                        help="The number of batches of lengths to sample")
+    parser.add_argument("--number", type=int, default=10)
+    parser.add_argument("--repeat", type=int, default=3)
+    parser.add_argument("--seed", type=int, default=0)
+    parser.add_argument("--output", type=str,
+                        help="The json file to write the results to. Stdout by default.")
+    args = parser.parse_args()
+
+    if args.dist in ('trace', 'squad', 'wmt') and args.path is None:
+        parser.error("--path is required for the %s distribution" % args.dist)
+
+    kernels = [args.kernel] if args.kernel else ['softmax', 'layer_norm', 'batch_matmul']
+    target = tvm.target.create(args.target)
+    batches = sample_batches(args.dist, args.batch_size, args.max_len, args.num_batches,
+                             seed=args.seed, min_len=args.min_len, zipf_a=args.zipf_a,
+                             path=args.path)
+
+    results = [benchmark(kernel, target, batches, args) for kernel in kernels]
+    report = {
+        'target': str(target),
+        'dist': args.dist,
+        'path': args.path,
+        'num_batches': args.num_batches,
+        'results': results,
+    }
+
+    sys.stderr.write("%-14s %-10s %-10s %-10s %-10s %-8s %-8s\n" %
+                     ("Kernel", "p50 (ms)", "p99 (ms)", "Dense (ms)", "Speedup", "Waste",
+                      "Ktok/s"))
+    for res in results:
+        sys.stderr.write("%-14s %-10.3f %-10.3f %-10.3f %-10.2f %-8.2f %-8.1f\n" %
+                         (res['kernel'], res['latency_ms']['p50'], res['latency_ms']['p99'],
+                          res['dense_latency_ms'], res['speedup'], res['padding_waste'],
+                          res['tokens_per_sec'] / 1000))
+
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump(report, f, indent=2)
+    else:
+        json.dump(report, sys.stdout, indent=2)
+        sys.stdout.write("\n")
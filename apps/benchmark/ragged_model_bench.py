@@ -0,0 +1,439 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Benchmark script for end-to-end ragged models.
+see README.md for the usage of this script.
+"""
+import argparse
+import json
+import sys
+import time
+
+import numpy as np
+
+import tvm
+import topi
+from tvm.contrib import cublas, cudnn
+
+from ragged_util import sample_batches, tree_level_widths
+
+
+class Op(object):
+    """An operator of a model, built once with a fixed schedule and run
+    on every batch of lengths.
+
+    Parameters
+    ----------
+    name: str
+        The name of the op in the model
+    sch: Schedule
+        The schedule of the op
+    tensors: list of Tensor
+        The arguments of the op, the output last
+    feeds: function, optional
+        Maps a batch of lengths to one dict per call of the op, from the
+        index of an argument to its value for the call. Arguments that
+        are not fed are random. An op that is not fed is called once.
+    """
+    def __init__(self, name, sch, tensors, feeds=None):
+        self.name = name
+        self.sch = sch
+        self.tensors = tensors
+        self.feeds = feeds
+        self.func = None
+        self.args = None
+
+    def build(self, target, ctx):
+        """Build the op and allocate its arguments."""
+        self.func = tvm.build(self.sch, self.tensors, target)
+        self.args = []
+        for t in self.tensors:
+            shape = topi.util.get_const_tuple(t.shape)
+            if 'int' in t.dtype:
+                value = np.zeros(shape, dtype=t.dtype)
+            else:
+                value = np.random.uniform(size=shape).astype(t.dtype)
+            self.args.append(tvm.nd.array(value, ctx))
+
+    def calls(self, batch, ctx):
+        """The arguments of each call of the op on a batch of lengths."""
+        if self.feeds is None:
+            return [self.args]
+        calls = []
+        for feed in self.feeds(batch):
+            args = list(self.args)
+            for i, value in feed.items():
+                args[i] = tvm.nd.array(value, ctx)
+            calls.append(args)
+        return calls
+
+    def memory_bytes(self):
+        """The device memory of the arguments of the op."""
+        return sum(int(np.prod(a.shape)) * np.dtype(a.dtype).itemsize for a in self.args)
+
+
+def _lengths(values):
+    return np.array(values, dtype='int32')
+
+
+def _batch_matmul(name, batch, rows, k, n, feeds=None, vendor=False):
+    """x[batch, rows, k] times y[batch, n, k]^T, ragged over the rows,
+    or with cuBLAS over all of them."""
+    x = tvm.placeholder((batch, rows, k), name='x')
+    y = tvm.placeholder((batch, n, k), name='y')
+    if vendor:
+        out = cublas.batch_matmul(x, y, transb=True)
+        return Op(name, tvm.create_schedule(out.op), [x, y, out])
+    lengths = tvm.placeholder((batch,), name='lengths', dtype='int32')
+    out = topi.nn.ragged_batch_matmul(x, y, lengths)
+    sch = topi.generic.schedule_ragged_batch_matmul([out])
+    return Op(name, sch, [x, y, lengths, out], feeds)
+
+
+def _layer_norm(name, batch, rows, hidden, feeds):
+    x = tvm.placeholder((batch, rows, hidden), name='x')
+    gamma = tvm.placeholder((hidden,), name='gamma')
+    beta = tvm.placeholder((hidden,), name='beta')
+    lengths = tvm.placeholder((batch,), name='lengths', dtype='int32')
+    out = topi.nn.ragged_layer_norm(x, gamma, beta, lengths)
+    sch = topi.generic.schedule_ragged_layer_norm([out])
+    return Op(name, sch, [x, gamma, beta, lengths, out], feeds)
+
+
+def transformer(args, vendor):
+    """One encoder layer of a transformer over a batch of sequences.
+    The lengths are those of the sequences."""
+    b, l, h, heads = args.batch_size, args.max_len, args.hidden, args.heads
+    head_dim = h // heads
+
+    def feeds(index):
+        return lambda batch: [{index: _lengths(batch)}]
+
+    ops = []
+    if vendor:
+        q = tvm.placeholder((b, l, h), name='q')
+        k = tvm.placeholder((b, l, h), name='k')
+        v = tvm.placeholder((b, l, h), name='v')
+        w = tvm.placeholder((cudnn.multi_head_attn_weights_size(
+            h, h, h, heads, head_dim, head_dim, head_dim, h),), name='w')
+        qo_lengths = tvm.placeholder((b,), name='qo_lengths', dtype='int32')
+        kv_lengths = tvm.placeholder((b,), name='kv_lengths', dtype='int32')
+        out = cudnn.multi_head_attn_forward(q, k, v, w, qo_lengths, kv_lengths, heads,
+                                            head_dim, head_dim, head_dim, h)
+        # Includes the input and output projections.
+        ops.append(Op('attention', tvm.create_schedule(out.op),
+                      [q, k, v, w, qo_lengths, kv_lengths, out],
+                      lambda batch: [{4: _lengths(batch), 5: _lengths(batch)}]))
+    else:
+        ops.append(_batch_matmul('qkv_proj', b, l, h, 3 * h, feeds(2)))
+        q = tvm.placeholder((b, heads, l, head_dim), name='q')
+        k = tvm.placeholder((b, heads, l, head_dim), name='k')
+        v = tvm.placeholder((b, heads, l, head_dim), name='v')
+        lengths = tvm.placeholder((b,), name='lengths', dtype='int32')
+        out = topi.nn.ragged_attention(q, k, v, lengths, scale=1.0 / np.sqrt(head_dim))
+        ops.append(Op('attention', topi.generic.schedule_ragged_attention([out]),
+                      [q, k, v, lengths, out], feeds(3)))
+        ops.append(_batch_matmul('out_proj', b, l, h, h, feeds(2)))
+    ops.append(_layer_norm('layer_norm1', b, l, h, feeds(3)))
+    ops.append(_batch_matmul('ffn1', b, l, h, 4 * h, feeds(2), vendor))
+    ops.append(_batch_matmul('ffn2', b, l, 4 * h, h, feeds(2), vendor))
+    ops.append(_layer_norm('layer_norm2', b, l, h, feeds(3)))
+    return ops
+
+
+def treelstm(args, vendor):
+    """A binary TreeLSTM over a batch of trees, evaluated a level at a
+    time from the leaves up, as dynamic batching does. The lengths are
+    the numbers of leaves of the trees. The element-wise cell updates
+    are not included."""
+    b, l, h = args.batch_size, args.max_len, args.hidden
+    max_nodes = b * l
+    # The nodes of all levels, which is the most for trees of max_len
+    # leaves.
+    max_total_nodes = sum(tree_level_widths([l] * b))
+
+    def input_feeds(batch):
+        return [{2: _lengths([sum(tree_level_widths(batch))])}]
+
+    def level_feeds(batch):
+        return [{2: _lengths([width])} for width in tree_level_widths(batch)]
+
+    def vendor_level_feeds(batch):
+        return [{} for _ in tree_level_widths(batch)]
+
+    if vendor:
+        # The matmuls are as large as the widest level, the leaves of
+        # trees padded to max_len.
+        x = tvm.placeholder((max_total_nodes, h), name='x')
+        w = tvm.placeholder((4 * h, h), name='w')
+        out = cublas.matmul(x, w, transb=True)
+        input_proj = Op('input_proj', tvm.create_schedule(out.op), [x, w, out])
+        x = tvm.placeholder((max_nodes, h), name='h')
+        u = tvm.placeholder((4 * h, h), name='u')
+        out = cublas.matmul(x, u, transb=True)
+        level_gates = Op('level_gates', tvm.create_schedule(out.op), [x, u, out],
+                         vendor_level_feeds)
+        return [input_proj, level_gates]
+    return [_batch_matmul('input_proj', 1, max_total_nodes, h, 4 * h, input_feeds),
+            _batch_matmul('level_gates', 1, max_nodes, h, 4 * h, level_feeds)]
+
+
+def gnn(args, vendor):
+    """A graph convolution layer, a sum over the neighbors of each node
+    followed by a linear transform. The lengths are the degrees of the
+    nodes."""
+    n, l, h = args.num_nodes, args.max_len, args.hidden
+    if vendor:
+        adj = tvm.placeholder((n, n), name='adj')
+        feat = tvm.placeholder((n, h), name='feat')
+        out = cublas.matmul(adj, feat)
+        aggregate = Op('aggregate', tvm.create_schedule(out.op), [adj, feat, out])
+        x = tvm.placeholder((n, h), name='x')
+        w = tvm.placeholder((h, h), name='w')
+        out = cublas.matmul(x, w, transb=True)
+        return [aggregate, Op('transform', tvm.create_schedule(out.op), [x, w, out])]
+
+    def csr_feeds(batch):
+        degrees = np.array(batch, dtype='int32')
+        indptr = np.zeros(n + 1, dtype='int32')
+        indptr[1:] = np.cumsum(degrees)
+        indices = np.zeros(n * l, dtype='int32')
+        rng = np.random.RandomState(args.seed)
+        indices[:indptr[-1]] = rng.randint(0, n, size=indptr[-1])
+        return [{1: indices, 2: indptr}]
+
+    data = tvm.placeholder((n * l,), name='data')
+    indices = tvm.placeholder((n * l,), name='indices', dtype='int32')
+    indptr = tvm.placeholder((n + 1,), name='indptr', dtype='int32')
+    feat = tvm.placeholder((n, h), name='feat')
+    out = topi.sparse.csrmm_ragged(data, indices, indptr, feat)
+    aggregate = Op('aggregate', topi.generic.schedule_sparse_ragged([out]),
+                   [data, indices, indptr, feat, out], csr_feeds)
+    transform = _batch_matmul('transform', 1, n, h, h, lambda batch: [{2: _lengths([n])}])
+    return [aggregate, transform]
+
+
+def moe(args, vendor):
+    """A mixture of experts layer, a gate followed by the feed forward
+    networks of the experts over the tokens routed to them. The lengths
+    are the numbers of tokens of the experts, at most max_len."""
+    e, l, h = args.experts, args.max_len, args.hidden
+    if vendor:
+        x = tvm.placeholder((e * l, h), name='x')
+        wg = tvm.placeholder((e, h), name='wg')
+        out = cublas.matmul(x, wg, transb=True)
+        gate = Op('gate', tvm.create_schedule(out.op), [x, wg, out])
+    else:
+        gate = _batch_matmul('gate', 1, e * l, h, e,
+                             lambda batch: [{2: _lengths([sum(batch)])}])
+
+    def feeds(batch):
+        return [{2: _lengths(batch)}]
+
+    return [gate,
+            _batch_matmul('expert_ffn1', e, l, h, 4 * h, feeds, vendor),
+            _batch_matmul('expert_ffn2', e, l, 4 * h, h, feeds, vendor)]
+
+
+MODELS = {
+    'transformer': transformer,
+    'treelstm': treelstm,
+    'gnn': gnn,
+    'moe': moe,
+}
+
+
+def num_lengths(model, args):
+    """The number of lengths in a batch of a model."""
+    return {'gnn': args.num_nodes, 'moe': args.experts}.get(model, args.batch_size)
+
+
+def _percentiles(latencies):
+    return {
+        'mean': float(np.mean(latencies)),
+        'p50': float(np.percentile(latencies, 50)),
+        'p90': float(np.percentile(latencies, 90)),
+        'p99': float(np.percentile(latencies, 99)),
+    }
+
+
+def run_variant(model, variant, target, batches, args):
+    """Measure each op of a model and the whole model on every batch.
+
+    The padded variant runs the ragged ops with every length set to
+    max_len, and the vendor variant runs cuBLAS and cuDNN where they
+    have the op and the padded ragged op otherwise."""
+    ctx = tvm.context(str(target), 0)
+    with target:
+        ops = MODELS[model](args, variant == 'vendor')
+    for op in ops:
+        op.build(target, ctx)
+    if variant != 'ragged':
+        batches = [[args.max_len] * len(batch) for batch in batches]
+
+    op_latencies = {op.name: [] for op in ops}
+    latencies = []
+    for batch in batches:
+        calls = [(op, op.calls(batch, ctx)) for op in ops]
+        for op, op_calls in calls:
+            ftimer = op.func.time_evaluator(op.func.entry_name, ctx, number=args.number,
+                                            repeat=args.repeat)
+            op_latencies[op.name].append(
+                sum(np.mean(ftimer(*call).results) for call in op_calls) * 1000)
+        # The whole model is timed from the host, so that it includes
+        # the launch overhead between the ops.
+        runs = []
+        for _ in range(args.repeat):
+            ctx.sync()
+            start = time.time()
+            for _ in range(args.number):
+                for op, op_calls in calls:
+                    for call in op_calls:
+                        op.func(*call)
+            ctx.sync()
+            runs.append((time.time() - start) / args.number * 1000)
+        latencies.append(np.mean(runs))
+
+    return {
+        'latency_ms': _percentiles(latencies),
+        'memory_mb': sum(op.memory_bytes() for op in ops) / 2.0 ** 20,
+        'ops': [{
+            'name': op.name,
+            'latency_ms': _percentiles(op_latencies[op.name]),
+            'memory_mb': op.memory_bytes() / 2.0 ** 20,
+        } for op in ops],
+    }
+
+
+def benchmark(model, target, variants, args):
+    batches = sample_batches(args.dist, num_lengths(model, args), args.max_len,
+                             args.num_batches, seed=args.seed, min_len=args.min_len,
+                             zipf_a=args.zipf_a, path=args.path)
+    result = {'model': model}
+    for variant in variants:
+        result[variant] = run_variant(model, variant, target, batches, args)
+    return result
+
+
+def vendor_available(target):
+    """Whether the target can run the cuBLAS and cuDNN baselines."""
+    return target.target_name == 'cuda' and \
+        tvm.get_global_func("tvm.contrib.cublas.batch_matmul", True) is not None and \
+        tvm.get_global_func("tvm.contrib.cudnn.multi_head_attn.forward", True) is not None
+
+
+def find_regressions(report, previous, tolerance):
+    """The ragged latencies of a report that are slower than in a
+    previous report by more than tolerance, as (name, old, new)."""
+    def p50s(rep):
+        ret = {}
+        for res in rep['results']:
+            ret[res['model']] = res['ragged']['latency_ms']['p50']
+            for op in res['ragged']['ops']:
+                ret['%s/%s' % (res['model'], op['name'])] = op['latency_ms']['p50']
+        return ret
+
+    old, new = p50s(previous), p50s(report)
+    return [(name, old[name], new[name]) for name in sorted(new)
+            if name in old and new[name] > old[name] * (1 + tolerance)]
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--model", type=str, choices=sorted(MODELS),
+                        help="The model to benchmark. All of them by default.")
+    parser.add_argument("--target", type=str, default='cuda', help="The tvm compilation target")
+    parser.add_argument("--dist", type=str, default='zipf',
+                        choices=['uniform', 'zipf', 'trace', 'squad', 'wmt'],
+                        help="The length distribution")
+    parser.add_argument("--path", type=str,
+                        help="The trace file, SQuAD json or WMT text for the trace, squad and "
+                             "wmt distributions")
+    parser.add_argument("--min-len", type=int, default=1,
+                        help="The smallest length of the uniform distribution")
+    parser.add_argument("--zipf-a", type=float, default=1.5,
+                        help="The exponent of the zipf distribution")
+    parser.add_argument("--batch-size", type=int, default=32,
+                        help="The number of sequences or trees of a batch")
+    parser.add_argument("--max-len", type=int, default=128,
+                        help="The padded length of the sequences, leaves of the trees, degrees "
+                             "of the nodes and tokens of the experts")
+    parser.add_argument("--hidden", type=int, default=512)
+    parser.add_argument("--heads", type=int, default=8)
+    parser.add_argument("--num-nodes", type=int, default=4096,
+                        help="The number of nodes of the graph of the gnn model")
+    parser.add_argument("--experts", type=int, default=8,
+                        help="The number of experts of the moe model")
+    parser.add_argument("--num-batches", type=int, default=10,
+                        help="The number of batches of lengths to sample")
+    parser.add_argument("--number", type=int, default=10)
+    parser.add_argument("--repeat", type=int, default=3)
+    parser.add_argument("--seed", type=int, default=0)
+    parser.add_argument("--output", type=str,
+                        help="The json file to write the results to. Stdout by default.")
+    parser.add_argument("--compare", type=str,
+                        help="The json results of a previous run. The script fails if a "
+                             "ragged latency regressed by more than --tolerance.")
+    parser.add_argument("--tolerance", type=float, default=0.1)
+    args = parser.parse_args()
+
+    if args.dist in ('trace', 'squad', 'wmt') and args.path is None:
+        parser.error("--path is required for the %s distribution" % args.dist)
+
+    models = [args.model] if args.model else sorted(MODELS)
+    target = tvm.target.create(args.target)
+    variants = ['ragged', 'padded'] + (['vendor'] if vendor_available(target) else [])
+
+    results = [benchmark(model, target, variants, args) for model in models]
+    report = {
+        'target': str(target),
+        'dist': args.dist,
+        'path': args.path,
+        'num_batches': args.num_batches,
+        'config': {key: getattr(args, key) for key in
+                   ('batch_size', 'max_len', 'hidden', 'heads', 'num_nodes', 'experts',
+                    'seed')},
+        'variants': variants,
+        'results': results,
+    }
+
+    sys.stderr.write("%-24s %-8s %-10s %-10s %-10s\n" %
+                     ("Model/Op", "Variant", "p50 (ms)", "p99 (ms)", "Mem (MB)"))
+    for res in results:
+        for variant in variants:
+            var = res[variant]
+            sys.stderr.write("%-24s %-8s %-10.3f %-10.3f %-10.1f\n" %
+                             (res['model'], variant, var['latency_ms']['p50'],
+                              var['latency_ms']['p99'], var['memory_mb']))
+            for op in var['ops']:
+                sys.stderr.write("  %-22s %-8s %-10.3f %-10.3f %-10.1f\n" %
+                                 (op['name'], variant, op['latency_ms']['p50'],
+                                  op['latency_ms']['p99'], op['memory_mb']))
+
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump(report, f, indent=2)
+    else:
+        json.dump(report, sys.stdout, indent=2)
+        sys.stdout.write("\n")
+
+    if args.compare:
+        with open(args.compare) as f:
+            regressions = find_regressions(report, json.load(f), args.tolerance)
+        for name, old, new in regressions:
+            sys.stderr.write("regression: %s %.3f ms -> %.3f ms\n" % (name, old, new))
+        if regressions:
+            sys.exit(1)
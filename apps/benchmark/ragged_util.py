@@ -0,0 +1,150 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Length distributions for benchmarking ragged kernels"""
+
+import json
+
+import numpy as np
+
+
+def lengths_from_trace(path):
+    """Read sequence lengths from a trace file, either a JSON list or one
+    length per line.
+
+    Parameters
+    ----------
+    path: str
+        The trace file
+
+    Returns
+    -------
+    lengths: list of int
+    """
+    with open(path) as f:
+        text = f.read()
+    if text.lstrip().startswith('['):
+        return [int(x) for x in json.loads(text)]
+    return [int(line) for line in text.split() if line]
+
+
+def lengths_from_squad(path):
+    """Read the lengths, in whitespace separated tokens, of the question
+    and context pairs of a SQuAD json file.
+
+    Parameters
+    ----------
+    path: str
+        A SQuAD train or dev json file
+
+    Returns
+    -------
+    lengths: list of int
+    """
+    with open(path) as f:
+        data = json.load(f)['data']
+    lengths = []
+    for article in data:
+        for paragraph in article['paragraphs']:
+            context = len(paragraph['context'].split())
+            for qa in paragraph['qas']:
+                lengths.append(context + len(qa['question'].split()))
+    return lengths
+
+
+def lengths_from_text(path):
+    """Read the lengths, in whitespace separated tokens, of the lines of
+    a text corpus with one sentence per line, such as the WMT corpora.
+
+    Parameters
+    ----------
+    path: str
+        The text file
+
+    Returns
+    -------
+    lengths: list of int
+    """
+    with open(path) as f:
+        return [len(line.split()) for line in f if line.strip()]
+
+
+def sample_batches(dist, batch_size, max_len, num_batches, seed=0, **kwargs):
+    """Sample batches of sequence lengths.
+
+    Parameters
+    ----------
+    dist: str
+        'uniform' draws lengths uniformly from [min_len, max_len],
+        'zipf' from a Zipf distribution with exponent zipf_a, and
+        'trace', 'squad' and 'wmt' from the lengths read from path.
+    batch_size: int
+        The number of lengths in a batch
+    max_len: int
+        The padded length. Longer lengths are truncated to it.
+    num_batches: int
+        The number of batches
+    seed: int
+        The random seed
+    kwargs: dict
+        min_len, zipf_a or path, depending on dist
+
+    Returns
+    -------
+    batches: list of list of int
+    """
+    rng = np.random.RandomState(seed)
+    size = (num_batches, batch_size)
+    if dist == 'uniform':
+        lengths = rng.randint(kwargs.get('min_len', 1), max_len + 1, size=size)
+    elif dist == 'zipf':
+        lengths = rng.zipf(kwargs.get('zipf_a', 1.5), size=size)
+    elif dist in ('trace', 'squad', 'wmt'):
+        read = {'trace': lengths_from_trace,
+                'squad': lengths_from_squad,
+                'wmt': lengths_from_text}[dist]
+        population = read(kwargs['path'])
+        assert population, "no lengths in " + kwargs['path']
+        lengths = rng.choice(population, size=size)
+    else:
+        raise ValueError("Unsupported length distribution: " + dist)
+    return np.clip(lengths, 1, max_len).astype('int32').tolist()
+
+
+def padding_waste(batch, max_len):
+    """The fraction of a padded batch that is padding."""
+    return 1.0 - float(sum(batch)) / (len(batch) * max_len)
+
+
+def tree_level_widths(batch):
+    """The number of nodes at each level, from the leaves up, of a batch
+    of binary trees as balanced as their numbers of leaves allow.
+
+    Parameters
+    ----------
+    batch: list of int
+        The number of leaves of each tree
+
+    Returns
+    -------
+    widths: list of int
+    """
+    widths = []
+    level = [int(n) for n in batch]
+    while any(n > 0 for n in level):
+        widths.append(sum(level))
+        level = [(n + 1) // 2 if n > 1 else 0 for n in level]
+    return widths
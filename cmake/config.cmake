@@ -165,6 +165,9 @@ set(USE_CUDNN OFF)
 # Whether use cuBLAS
 set(USE_CUBLAS OFF)
 
+# Whether use NCCL, for the collectives between the shards of ragged tensors
+set(USE_NCCL OFF)
+
 # Whether use MIOpen
 set(USE_MIOPEN OFF)
 
@@ -55,6 +55,13 @@ if(USE_CUDA)
     endif()
   endif(USE_CUBLAS)
 
+  if(USE_NCCL)
+    message(STATUS "Build with NCCL support")
+    file(GLOB CONTRIB_NCCL_SRCS src/runtime/contrib/nccl/*.cc)
+    list(APPEND RUNTIME_SRCS ${CONTRIB_NCCL_SRCS})
+    list(APPEND TVM_RUNTIME_LINKER_LIBS ${CUDA_NCCL_LIBRARY})
+  endif(USE_NCCL)
+
 else(USE_CUDA)
   list(APPEND COMPILER_SRCS src/target/opt/build_cuda_off.cc)
 endif(USE_CUDA)
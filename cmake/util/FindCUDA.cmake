@@ -34,6 +34,7 @@
 # - CUDA_NVRTC_LIBRARY
 # - CUDA_CUDNN_LIBRARY
 # - CUDA_CUBLAS_LIBRARY
+# - CUDA_NCCL_LIBRARY
 #
 macro(find_cuda use_cuda)
   set(__use_cuda ${use_cuda})
@@ -73,6 +74,9 @@ macro(find_cuda use_cuda)
       find_library(CUDA_CUBLASLT_LIBRARY cublaslt
         ${CUDA_TOOLKIT_ROOT_DIR}/lib/x64
         ${CUDA_TOOLKIT_ROOT_DIR}/lib/Win32)
+      find_library(CUDA_NCCL_LIBRARY nccl
+        ${CUDA_TOOLKIT_ROOT_DIR}/lib/x64
+        ${CUDA_TOOLKIT_ROOT_DIR}/lib/Win32)
     else(MSVC)
       find_library(_CUDA_CUDA_LIBRARY cuda
         PATHS ${CUDA_TOOLKIT_ROOT_DIR}
@@ -94,6 +98,9 @@ macro(find_cuda use_cuda)
       find_library(CUDA_CUBLASLT_LIBRARY cublaslt
         ${CUDA_TOOLKIT_ROOT_DIR}/lib64
         ${CUDA_TOOLKIT_ROOT_DIR}/lib)
+      find_library(CUDA_NCCL_LIBRARY nccl
+        ${CUDA_TOOLKIT_ROOT_DIR}/lib64
+        ${CUDA_TOOLKIT_ROOT_DIR}/lib)
     endif(MSVC)
     message(STATUS "Found CUDA_TOOLKIT_ROOT_DIR=" ${CUDA_TOOLKIT_ROOT_DIR})
     message(STATUS "Found CUDA_CUDA_LIBRARY=" ${CUDA_CUDA_LIBRARY})
@@ -102,5 +109,6 @@ macro(find_cuda use_cuda)
     message(STATUS "Found CUDA_CUDNN_LIBRARY=" ${CUDA_CUDNN_LIBRARY})
     message(STATUS "Found CUDA_CUBLAS_LIBRARY=" ${CUDA_CUBLAS_LIBRARY})
     message(STATUS "Found CUDA_CUBLASLT_LIBRARY=" ${CUDA_CUBLASLT_LIBRARY})
+    message(STATUS "Found CUDA_NCCL_LIBRARY=" ${CUDA_NCCL_LIBRARY})
   endif(CUDA_FOUND)
 endmacro(find_cuda)
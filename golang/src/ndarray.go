@@ -47,15 +47,37 @@ func (parray Array) nativeCPtr() (retVal uintptr) {
 }
 
 func (parray Array) nativeCopyFrom(data unsafe.Pointer, datalen int) (err error) {
+    return parray.nativeCopyFromBytes(data, datalen, false)
+}
+
+func (parray Array) nativeCopyFromBytes(data unsafe.Pointer, datalen int,
+                                        ragged bool) (err error) {
     ret := C.TVMArrayCopyFromBytes((*C.DLTensor)(unsafe.Pointer(parray.nativeCPtr())),
                                    data,
-                                   C.ulong(datalen))
+                                   C.ulong(datalen),
+                                   C.bool(ragged))
     if ret != 0 {
         err = errors.New(getTVMLastError())
     }
     return
 }
 
+// CopyFromRagged copies the packed data of a ragged Array, the valid
+// entries of its rows one after the other, from a golang data slice,
+// which may be shorter than the dense shape of the Array implies.
+//
+// `val` is interface holding a slice of Array data type.
+//
+// returns err is any.
+func (parray Array) CopyFromRagged(val interface{}) (err error) {
+    rval := reflect.ValueOf(val)
+    if rval.Kind() != reflect.Slice || rval.Len() == 0 {
+        return fmt.Errorf("Given type not supported : %v", reflect.TypeOf(val))
+    }
+    datalen := rval.Len() * int(rval.Type().Elem().Size())
+    return parray.nativeCopyFromBytes(unsafe.Pointer(rval.Pointer()), datalen, true)
+}
+
 // CopyFrom copies given golang data slice into Array.
 //
 // `val` is interface homding a slice of Array data type.
@@ -128,7 +150,8 @@ func (parray Array) CopyFrom(val interface{}) (err error) {
 func (parray Array) nativeCopyTo (data unsafe.Pointer, datalen int) (err error){
     ret := C.TVMArrayCopyToBytes((*C.DLTensor)(unsafe.Pointer(parray.nativeCPtr())),
                                   unsafe.Pointer(data),
-                                  C.ulong(datalen))
+                                  C.ulong(datalen),
+                                  C.bool(false))
 
     if ret != 0 {
         err = errors.New(getTVMLastError())
@@ -336,6 +359,129 @@ func Empty(shape []int64, args ...interface{}) (parray *Array, err error) {
     return
 }
 
+// nativeTVMRaggedArrayAlloc is used to allocate a ragged TVMArray of
+// given attributes, with room for `flatSize` packed entries.
+func nativeTVMRaggedArrayAlloc(shape []int64, flatSize int64, ndim int32,
+                   dtypeCode int32, dtypeBits int32, dtypeLanes int32,
+                   deviceType int32, deviceID int32) (retVal uintptr, err error) {
+    ret := (int32)(C.TVMRaggedArrayAlloc((*C.long)(&(shape[0])),
+                                         C.long(flatSize),
+                                         C.int(ndim),
+                                         C.int(dtypeCode),
+                                         C.int(dtypeBits),
+                                         C.int(dtypeLanes),
+                                         C.int(deviceType),
+                                         C.int(deviceID),
+                                         (*C.TVMArrayHandle)(unsafe.Pointer(&retVal))))
+    if ret != 0 {
+        err = errors.New(getTVMLastError())
+        return
+    }
+    return
+}
+
+// EmptyRagged is used to allocate a TVM ragged array of given dense
+// shape, with room for `flatSize` packed entries.
+//
+// `args` are as for Empty.
+//
+// returns pointer to Array on successful execution and error if any.
+func EmptyRagged(shape []int64, flatSize int64, args ...interface{}) (parray *Array, err error) {
+    typeName := "float32"
+    ctx := Context{KDLCPU, 0}
+
+    if len(shape) < 1 {
+        err = fmt.Errorf("Invalid shape for Array creation: %v", len(shape))
+        return
+    }
+
+    for i, val := range args {
+        switch val.(type) {
+            case string:
+                typeName = args[i].(string)
+            case Context:
+                ctx = args[i].(Context)
+            default:
+                err = fmt.Errorf("Invalid Optional Argument Type: %T", val)
+                return
+        }
+    }
+
+    tvmType, err := dtypeToTVMType(typeName)
+    if err != nil {
+        return
+    }
+    ndim := int32(len(shape))
+    newArray, err := nativeTVMRaggedArrayAlloc(shape, flatSize, ndim, int32(tvmType.code),
+                                               int32(tvmType.bits), int32(tvmType.lanes),
+                                               ctx.DeviceType, ctx.DeviceID)
+    if err != nil {
+        return
+    }
+    handle := new(Array)
+    *handle = Array(newArray)
+
+    finalizer := func (ahandle *Array) {
+        nativeTVMArrayFree(*ahandle)
+        ahandle = nil
+    }
+    runtime.SetFinalizer(handle, finalizer)
+    parray = handle
+    return
+}
+
+// RaggedData returns a golang slice over the first `flatSize` packed
+// entries of a ragged Array in CPU memory, without copying them, so that
+// the data of requests can be written directly into the Array. The
+// slice is only valid as long as the Array is.
+//
+// returns the slice, of the Array data type, and err if any.
+func (parray Array) RaggedData(flatSize int64) (retVal interface{}, err error) {
+    if parray.GetCtx().DeviceType != KDLCPU {
+        err = fmt.Errorf("Ragged data is only accessible for CPU arrays")
+        return
+    }
+    data := ((*C.DLTensor)(unsafe.Pointer(parray))).data
+    n := int(flatSize)
+
+    switch parray.GetDType() {
+        case "int8":
+            retVal = (*[1 << 30]int8)(data)[:n:n]
+        case "int16":
+            retVal = (*[1 << 29]int16)(data)[:n:n]
+        case "int32":
+            retVal = (*[1 << 28]int32)(data)[:n:n]
+        case "int64":
+            retVal = (*[1 << 27]int64)(data)[:n:n]
+        case "uint8":
+            retVal = (*[1 << 30]uint8)(data)[:n:n]
+        case "uint16":
+            retVal = (*[1 << 29]uint16)(data)[:n:n]
+        case "uint32":
+            retVal = (*[1 << 28]uint32)(data)[:n:n]
+        case "uint64":
+            retVal = (*[1 << 27]uint64)(data)[:n:n]
+        case "float32":
+            retVal = (*[1 << 28]float32)(data)[:n:n]
+        case "float64":
+            retVal = (*[1 << 27]float64)(data)[:n:n]
+        default:
+            err = fmt.Errorf("Given type not supported : %v", parray.GetDType())
+    }
+    return
+}
+
+// LengthsFromOffsets returns the lengths of the rows of packed ragged
+// data from the offsets of its rows, of which there is one more than
+// rows, the last being the end of the data.
+func LengthsFromOffsets(offsets []int64) (retVal []int32) {
+    retVal = make([]int32, 0, len(offsets))
+    for ii := 1; ii < len(offsets); ii++ {
+        retVal = append(retVal, int32(offsets[ii] - offsets[ii - 1]))
+    }
+    return
+}
+
 // nativeTVMArrayFree is used to release the Array.
 //
 // `parray` is the Array handle.
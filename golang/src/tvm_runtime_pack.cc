@@ -24,13 +24,16 @@
 #include "src/runtime/c_runtime_api.cc"
 #include "src/runtime/cpu_device_api.cc"
 #include "src/runtime/workspace_pool.cc"
+#include "src/runtime/memory_profile.cc"
 #include "src/runtime/library_module.cc"
 #include "src/runtime/module.cc"
 #include "src/runtime/registry.cc"
 #include "src/runtime/file_util.cc"
+#include "src/runtime/mapped_file.cc"
 #include "src/runtime/threading_backend.cc"
 #include "src/runtime/thread_pool.cc"
 #include "src/runtime/ndarray.cc"
+#include "src/runtime/prep_code_cache.cc"
 #include "src/runtime/object.cc"
 
 // NOTE: all the files after this are optional modules
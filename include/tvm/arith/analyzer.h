@@ -351,6 +351,23 @@ class IntSetAnalyzer {
   Impl* impl_;
 };
 
+/*!
+ * \brief The number of proofs Analyzer::CanProve and
+ *  Analyzer::CanProveGreaterEqual settled at each tier of analyzers.
+ */
+struct ProofTierStats {
+  /*! \brief Proofs settled by rewrite simplification. */
+  int64_t rewrite_simplify{0};
+  /*! \brief Proofs settled by constant integer bounds. */
+  int64_t const_int_bound{0};
+  /*! \brief Proofs settled by canonical simplification. */
+  int64_t canonical_simplify{0};
+  /*! \brief Proofs settled by z3. */
+  int64_t z3{0};
+  /*! \brief Conditions no tier could prove. */
+  int64_t unproven{0};
+};
+
 /*!
  * \brief Analyzer that contains bunch of sub-analyzers.
  *
@@ -380,6 +397,8 @@ class Analyzer {
   IntSetAnalyzer int_set;
   /*! \brief sub-analyzer: Z3 */
   Z3Analyzer z3_analyzer;
+  /*! \brief The number of proofs settled at each tier. */
+  ProofTierStats proof_stats;
   /*! \brief constructor */
   Analyzer();
   /*!
@@ -455,7 +474,11 @@ class Analyzer {
    * \param cond The expression to be proved.
    * \return The result.
    *
-   * \note Analyzer will call into sub-analyzers to get the result.
+   * \note Analyzer will call into sub-analyzers to get the result,
+   *  from the cheapest to the most precise: rewrite simplification,
+   *  constant integer bounds of comparisons, canonical simplification
+   *  and finally z3. The tier that settles the proof is counted in
+   *  proof_stats.
    */
   bool CanProve(const PrimExpr& cond);
   /*!
@@ -5,6 +5,7 @@
 #include <tvm/ir/expr.h>
 #include <tvm/support/with.h>
 #include <tvm/tir/expr.h>
+#include <tvm/tir/expr_equality.h>
 #include <tvm/tir/expr_functor.h>
 
 #include <limits>
@@ -115,15 +116,48 @@ class Z3Analyzer {
   void RemoveLastConstraint();
   z3::expr ConvertToZ3(const PrimExpr& expr);
   bool CanProve(const PrimExpr& cond);
+  /*! \brief Set the time, in milliseconds, the solver may spend on
+   * each query. Queries that time out are not proven. */
+  void SetTimeout(unsigned timeout_ms);
+
+  /*! \brief Process wide totals of the queries made to solvers. */
+  struct Stats {
+    int64_t num_queries;
+    int64_t query_us;
+  };
+  static Stats GlobalStats();
 
  private:
-  bool CanProveInternal_(z3::expr& antecedent, z3::expr& consequent, bool print);
+  void PushGeneralConstraint_(const z3::expr& constraint);
+  void ConstraintsChanged_();
+  void EnsureSolver_();
   void InitCall_();
 
   z3::context ctx;
   std::unique_ptr<Z3Converter> converter;
   std::unordered_map<const Object*, z3exprvec> var_constraints;
   z3exprvec general_constraints;
+
+  // The solver holds the var constraints at its base level and each
+  // general constraint in a scope of its own, so that they can be
+  // popped by RemoveLastConstraint. Queries are checked in a scope of
+  // their own on top. It is rebuilt from the constraints when it is
+  // stale.
+  std::unique_ptr<z3::solver> solver;
+  bool solver_stale{true};
+  // Whether the constraints are known to be satisfiable.
+  bool consistency_checked{false};
+  unsigned timeout_ms{500};
+
+  // Proof results are cached per set of constraints. Each set gets a
+  // new id, and removing the last general constraint goes back to the
+  // id the set had before it was added.
+  uint64_t state_id{0};
+  uint64_t next_state_id{0};
+  std::vector<uint64_t> state_id_stack;
+  std::unordered_map<uint64_t,
+                     std::unordered_map<PrimExpr, bool, DeeperExprHash, DeeperExprEquality>>
+      proof_cache;
 };
 }  // namespace arith
 }  // namespace tvm
@@ -0,0 +1,97 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file tvm/driver/pass_profiler.h
+ * \brief Compile time profiling of the lowering pipeline.
+ *
+ *  When enabled, every pass run records a span with its wall time,
+ *  the size of the IR it returned and the Z3 queries it made. The
+ *  spans are reported as a chrome trace (chrome://tracing, Perfetto).
+ */
+#ifndef TVM_DRIVER_PASS_PROFILER_H_
+#define TVM_DRIVER_PASS_PROFILER_H_
+
+#include <tvm/node/node.h>
+#include <tvm/runtime/packed_func.h>
+
+#include <chrono>
+#include <string>
+
+namespace tvm {
+
+/*! \brief Whether pass spans are being recorded. */
+TVM_DLL bool PassProfilingEnabled();
+
+/*! \brief Start recording pass spans, dropping those recorded before. */
+TVM_DLL void StartPassProfiling();
+
+/*!
+ * \brief Stop recording pass spans.
+ * \return The spans recorded since StartPassProfiling, as a chrome
+ *  trace JSON document.
+ */
+TVM_DLL std::string StopPassProfiling();
+
+/*!
+ * \brief A span of the profile, recorded on destruction if profiling
+ *  is enabled at construction.
+ */
+class TVM_DLL PassSpan {
+ public:
+  explicit PassSpan(std::string name);
+  ~PassSpan();
+  /*! \brief Set the IR the pass returned, whose nodes are counted. */
+  void SetResult(const ObjectRef& result);
+
+ private:
+  bool enabled_;
+  std::string name_;
+  std::chrono::steady_clock::time_point start_;
+  int64_t z3_queries_;
+  int64_t z3_us_;
+  int64_t num_nodes_{-1};
+};
+
+/*!
+ * \brief Run a pass under a span.
+ * \param name The name of the pass.
+ * \param pass A callable returning the result of the pass.
+ */
+template <typename F>
+inline auto ProfilePass(const char* name, F pass) -> decltype(pass()) {
+  if (!PassProfilingEnabled()) return pass();
+  PassSpan span(name);
+  auto ret = pass();
+  span.SetResult(ret);
+  return ret;
+}
+
+/*!
+ * \brief Wrap a packed function so that its calls are profiled as a
+ *  pass.
+ */
+TVM_DLL runtime::PackedFunc ProfiledPackedFunc(const char* name, runtime::PackedFunc body);
+
+inline runtime::PackedFunc ProfiledPackedFunc(const char* name, runtime::PackedFunc::FType body) {
+  return ProfiledPackedFunc(name, runtime::PackedFunc(body));
+}
+
+}  // namespace tvm
+#endif  // TVM_DRIVER_PASS_PROFILER_H_
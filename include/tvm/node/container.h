@@ -172,6 +172,18 @@ class Array : public ObjectRef {
   Array(const std::vector<T>& init) {  // NOLINT(*)
     assign(init.begin(), init.end());
   }
+  /*!
+   * \brief constructor from a vector whose elements are moved
+   * \param init The vector
+   */
+  Array(std::vector<T>&& init) {  // NOLINT(*)
+    auto n = make_object<ArrayNode>();
+    n->data.reserve(init.size());
+    for (auto& elem : init) {
+      n->data.push_back(std::move(elem));
+    }
+    data_ = std::move(n);
+  }
   /*!
    * \brief Constructs a container with n elements. Each element is a copy of val
    * \param n The size of the container
@@ -179,6 +191,7 @@ class Array : public ObjectRef {
    */
   explicit Array(size_t n, const T& val) {
     auto tmp_node = make_object<ArrayNode>();
+    tmp_node->data.reserve(n);
     for (size_t i = 0; i < n; ++i) {
       tmp_node->data.push_back(val);
     }
@@ -211,6 +224,8 @@ class Array : public ObjectRef {
   template <typename IterType>
   void assign(IterType begin, IterType end) {
     auto n = make_object<ArrayNode>();
+    ReserveFor(&n->data, begin, end,
+               typename std::iterator_traits<IterType>::iterator_category());
     for (IterType it = begin; it != end; ++it) {
       n->data.push_back(T(*it));
     }
@@ -237,13 +252,26 @@ class Array : public ObjectRef {
    *
    * \return Handle to the internal node container(which ganrantees to be unique)
    */
-  inline ArrayNode* CopyOnWrite() {
-    if (data_.get() == nullptr || !data_.unique()) {
+  inline ArrayNode* CopyOnWrite() { return CopyOnWrite(0); }
+  /*!
+   * \brief copy on write semantics, with room for extra elements
+   * \param extra The number of elements about to be added, which a copy
+   *  reserves room for so that adding them does not reallocate it.
+   * \return Handle to the internal node container(which ganrantees to be unique)
+   */
+  inline ArrayNode* CopyOnWrite(size_t extra) {
+    if (data_.get() == nullptr) {
+      data_ = make_object<ArrayNode>();
+    } else if (!data_.unique()) {
       ObjectPtr<ArrayNode> n = make_object<ArrayNode>();
-      n->data = static_cast<ArrayNode*>(data_.get())->data;
+      const auto& src = static_cast<ArrayNode*>(data_.get())->data;
+      n->data.reserve(src.size() + extra);
+      n->data.insert(n->data.end(), src.begin(), src.end());
       ObjectPtr<Object>(std::move(n)).swap(data_);
     }
-    return static_cast<ArrayNode*>(data_.get());
+    ArrayNode* n = static_cast<ArrayNode*>(data_.get());
+    if (extra) n->data.reserve(n->data.size() + extra);
+    return n;
   }
   /*!
    * \brief push a new item to the back of the list
@@ -253,22 +281,42 @@ class Array : public ObjectRef {
     ArrayNode* n = this->CopyOnWrite();
     n->data.push_back(item);
   }
+  /*!
+   * \brief push a new item to the back of the list
+   * \param item The item to be moved to the back.
+   */
+  inline void push_back(T&& item) {
+    ArrayNode* n = this->CopyOnWrite();
+    n->data.push_back(std::move(item));
+  }
   /*!
    * \brief push new items to the back of the list
    * \param item The items to be pushed.
    */
   inline void push_back_all(const Array<T>& items) {
+    if (items.empty()) return;
+    // The extra reference keeps the items intact when they are this
+    // array's own, by making the write copy it.
+    Array<T> src_ref = items;
+    const auto& src = static_cast<const ArrayNode*>(src_ref.get())->data;
+    ArrayNode* n = this->CopyOnWrite(src.size());
+    n->data.insert(n->data.end(), src.begin(), src.end());
+  }
+  /*!
+   * \brief Reserve room for a number of elements, so that pushing them
+   *  does not reallocate the storage.
+   * \param capacity The number of elements.
+   */
+  inline void reserve(size_t capacity) {
     ArrayNode* n = this->CopyOnWrite();
-    for (auto item : items) {
-      n->data.push_back(item);
-    }
+    n->data.reserve(capacity);
   }
   /*!
    * \brief Check if the array contains an element
    * \param item The item to checked.
    */
   inline bool Contains(const T& item) const {
-    auto data = static_cast<const ArrayNode*>(data_.get())->data;
+    const auto& data = static_cast<const ArrayNode*>(data_.get())->data;
     return std::find(data.begin(), data.end(), item) != data.end();
   }
   /*!
@@ -276,7 +324,7 @@ class Array : public ObjectRef {
    * \param item The item to checked.
    */
   inline size_t GetIdx(const T& item) const {
-    auto data = static_cast<const ArrayNode*>(data_.get())->data;
+    const auto& data = static_cast<const ArrayNode*>(data_.get())->data;
     return std::distance(data.begin(), std::find(data.begin(), data.end(), item));
   }
   /*!
@@ -296,6 +344,15 @@ class Array : public ObjectRef {
     ArrayNode* n = this->CopyOnWrite();
     n->data[i] = value;
   }
+  /*!
+   * \brief set i-th element of the array.
+   * \param i The index
+   * \param value The value to be moved in.
+   */
+  inline void Set(size_t i, T&& value) {
+    ArrayNode* n = this->CopyOnWrite();
+    n->data[i] = std::move(value);
+  }
   /*! \return whether array is empty */
   inline bool empty() const { return size() == 0; }
   /*!
@@ -368,6 +425,17 @@ class Array : public ObjectRef {
   inline reverse_iterator rend() const {
     return reverse_iterator(static_cast<const ArrayNode*>(data_.get())->data.rend());
   }
+
+ private:
+  // Iterators whose distance is cheap to compute give the size to
+  // reserve up front.
+  template <typename IterType>
+  static void ReserveFor(std::vector<ObjectRef>* data, IterType begin, IterType end,
+                         std::random_access_iterator_tag) {
+    data->reserve(std::distance(begin, end));
+  }
+  template <typename IterType, typename Tag>
+  static void ReserveFor(std::vector<ObjectRef>* data, IterType begin, IterType end, Tag) {}
 };
 
 /*!
@@ -459,6 +527,7 @@ class Map : public ObjectRef {
   template <typename IterType>
   void assign(IterType begin, IterType end) {
     ObjectPtr<MapNode> n = make_object<MapNode>();
+    n->data.reserve(std::distance(begin, end));
     for (IterType i = begin; i != end; ++i) {
       n->data.emplace(std::make_pair(i->first, i->second));
     }
@@ -515,6 +584,24 @@ class Map : public ObjectRef {
     MapNode* n = this->CopyOnWrite();
     n->data[key] = value;
   }
+  /*!
+   * \brief set the Map.
+   * \param key The index key.
+   * \param value The value to be moved in.
+   */
+  inline void Set(const K& key, V&& value) {
+    MapNode* n = this->CopyOnWrite();
+    n->data[key] = std::move(value);
+  }
+  /*!
+   * \brief Reserve room for a number of entries, so that adding them
+   *  does not rehash the map.
+   * \param capacity The number of entries.
+   */
+  inline void reserve(size_t capacity) {
+    MapNode* n = this->CopyOnWrite();
+    n->data.reserve(capacity);
+  }
 
   /*! \return whether array is empty */
   inline bool empty() const { return size() == 0; }
@@ -47,5 +47,37 @@ TVM_DLL std::string SaveJSON(const runtime::ObjectRef& node);
  */
 TVM_DLL runtime::ObjectRef LoadJSON(std::string json_str);
 
+/*!
+ * \brief save the node as well as all the node it depends on in a
+ *  compact binary format.
+ *
+ *  Structurally equal expressions, statements and containers are
+ *  saved once and shared when loaded back. Nodes with an identity,
+ *  such as variables and operations, are never merged.
+ *
+ * \return The binary representation of the node.
+ */
+TVM_DLL std::string SaveBinary(const runtime::ObjectRef& node);
+
+/*!
+ * \brief Load tvm Node object saved by SaveBinary.
+ * \param data The binary representation of the node.
+ *
+ * \return The loaded node.
+ */
+TVM_DLL runtime::ObjectRef LoadBinary(const std::string& data);
+
+/*!
+ * \brief Hash the node and all the nodes it depends on by their
+ *  contents.
+ *
+ *  The hash does not depend on the addresses of the nodes, so it is
+ *  the same across processes. Nodes that are distinct only by their
+ *  identity, such as two variables of the same name, hash alike.
+ *
+ * \return The hash.
+ */
+TVM_DLL uint64_t StructuralHash(const runtime::ObjectRef& node);
+
 }  // namespace tvm
 #endif  // TVM_NODE_SERIALIZATION_H_
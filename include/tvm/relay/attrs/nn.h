@@ -317,6 +317,71 @@ struct SoftmaxAttrs : public tvm::AttrsNode<SoftmaxAttrs> {
   }
 };
 
+/*! \brief Attributes used in the ragged softmax operator */
+struct RaggedSoftmaxAttrs : public tvm::AttrsNode<RaggedSoftmaxAttrs> {
+  int axis;
+  int batch_axis;
+  double scale;
+  std::string mode;
+  int tile;
+
+  TVM_DECLARE_ATTRS(RaggedSoftmaxAttrs, "relay.attrs.RaggedSoftmaxAttrs") {
+    TVM_ATTR_FIELD(axis).set_default(1)
+      .describe("The padded axis to sum over when computing softmax.");
+    TVM_ATTR_FIELD(batch_axis).set_default(0)
+      .describe("The axis that indexes the valid lengths of axis.");
+    TVM_ATTR_FIELD(scale).set_default(1.0)
+      .describe("The scale of integer input data, applied after the max of "
+                "each sequence is subtracted.");
+    TVM_ATTR_FIELD(mode).set_default("ragged")
+      .describe("How the kernel iterates the padded axis. 'ragged' visits the "
+                "valid elements only, 'tiled' rounds each length up to a multiple "
+                "of tile and 'dense' visits the whole padded axis; the last two "
+                "mask the padding instead of branching on it.");
+    TVM_ATTR_FIELD(tile).set_default(1)
+      .describe("The tile the lengths are rounded up to in 'tiled' mode.");
+  }
+};
+
+/*! \brief Attributes used in the ragged batch_matmul operator */
+struct RaggedBatchMatmulAttrs : public tvm::AttrsNode<RaggedBatchMatmulAttrs> {
+  DataType out_dtype;
+  std::string mode;
+  int tile;
+
+  TVM_DECLARE_ATTRS(RaggedBatchMatmulAttrs, "relay.attrs.RaggedBatchMatmulAttrs") {
+    // use 0 bits to indicate none.
+    TVM_ATTR_FIELD(out_dtype)
+        .set_default(NullValue<DataType>())
+        .describe("Output data type, set to explicit type under mixed precision setting");
+    TVM_ATTR_FIELD(mode).set_default("ragged")
+        .describe("How the kernel iterates the rows of x, one of 'ragged', "
+                  "'tiled' or 'dense', see RaggedSoftmaxAttrs.");
+    TVM_ATTR_FIELD(tile).set_default(1)
+        .describe("The tile the lengths are rounded up to in 'tiled' mode.");
+  }
+};
+
+/*! \brief Attributes used in the ragged attention operator */
+struct RaggedAttentionAttrs : public tvm::AttrsNode<RaggedAttentionAttrs> {
+  double scale;
+
+  TVM_DECLARE_ATTRS(RaggedAttentionAttrs, "relay.attrs.RaggedAttentionAttrs") {
+    TVM_ATTR_FIELD(scale).set_default(1.0)
+        .describe("The scale of the scores, typically 1 / sqrt(head_dim).");
+  }
+};
+
+/*! \brief Attributes used in the ragged embedding bag operator */
+struct RaggedEmbeddingBagAttrs : public tvm::AttrsNode<RaggedEmbeddingBagAttrs> {
+  std::string mode;
+
+  TVM_DECLARE_ATTRS(RaggedEmbeddingBagAttrs, "relay.attrs.RaggedEmbeddingBagAttrs") {
+    TVM_ATTR_FIELD(mode).set_default("sum")
+        .describe("How the rows of a bag are reduced: sum, mean or max.");
+  }
+};
+
 /*! \brief Attributes used in transposed convolution operator */
 struct Conv2DTransposeAttrs : public tvm::AttrsNode<Conv2DTransposeAttrs> {
   IndexExpr channels;
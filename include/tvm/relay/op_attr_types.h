@@ -80,6 +80,13 @@ using TOpIsStateful = bool;
  */
 using TNonComputational = bool;
 
+/*!
+ * \brief Mark the operator as ragged: its loops only visit the valid
+ *  prefix of a padded axis. Injective producers fused into it are
+ *  inlined, and so are never evaluated on the padding.
+ */
+using TRaggedOp = bool;
+
 /*!
  * \brief Mark the operator whether output shape is data dependant.
  */
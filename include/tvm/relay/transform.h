@@ -199,7 +199,9 @@ TVM_DLL Pass CombineParallelConv2D(uint64_t min_num_branches = 3);
 /*!
  * \brief Combine parallel dense ops into a single batch_matmul if the
  * number of branches of this dense operator is not less than
- * `min_num_branch`.
+ * `min_num_branch`. Dense ops on different fields of one tuple are
+ * combined into a ragged_batch_matmul when their inputs have different
+ * numbers of rows.
  *
  * \param min_num_branches The minimun number of branches.
  *
@@ -237,6 +239,14 @@ TVM_DLL Pass FoldScaleAxis();
  */
 TVM_DLL Pass CanonicalizeOps();
 
+/*!
+ * \brief Rewrite softmaxes over length masked inputs into ragged softmaxes,
+ * whose reductions only visit the valid prefix of each row.
+ *
+ * \return The pass.
+ */
+TVM_DLL Pass LowerToRagged();
+
 /*!
  * \brief Alternate the layouts of operators or replace primitive operators
  * with other expressions.
@@ -116,6 +116,31 @@ TVM_DLL void TVMBackendCopyMemory(const void* from, size_t from_offset, void* to
                                   int to_device_type, int to_device_id, int dtype_code_hint,
                                   int dtype_bits_hint);
 
+/*!
+ * \brief Backend function to copy memory from the host to a device
+ *  without blocking the host.
+ *
+ *  The copy is ordered on the stream currently set for the device,
+ *  so kernels launched afterwards on that stream see the copied
+ *  data. The source memory may be reused as soon as the call
+ *  returns. Copies that are not host to device fall back to
+ *  TVMBackendCopyMemory.
+ *
+ * \param from The source pointer.
+ * \param from_offset The offset from from to start copying from.
+ * \param to The destination pointer.
+ * \param to_offset The offset from to to start copying to.
+ * \param num_bytes Number of bytes to copy.
+ * \param from_device_type The source device type where the source data resides.
+ * \param from_device_id The source device id where the source data resides.
+ * \param to_device_type The destination device type where the copied data should reside.
+ * \param to_device_id The destination device id where the copied data should reside.
+ */
+TVM_DLL void TVMBackendCopyMemoryAsync(const void* from, size_t from_offset, void* to,
+                                       size_t to_offset, size_t num_bytes, int from_device_type,
+                                       int from_device_id, int to_device_type, int to_device_id,
+                                       int dtype_code_hint, int dtype_bits_hint);
+
 /*!
  * \brief Environment for TVM parallel task.
  */
@@ -126,6 +151,10 @@ typedef struct {
   void* sync_handle;
   /*! \brief total amount of task */
   int32_t num_task;
+  /*!
+   * \brief Auxiliary used for dynamic scheduling of the parallel loop
+   */
+  void* chunk_handle;
 } TVMParallelGroupEnv;
 
 /*!
@@ -156,6 +185,23 @@ TVM_DLL int TVMBackendParallelLaunch(FTVMParallelLambda flambda, void* cdata, in
  */
 TVM_DLL int TVMBackendParallelBarrier(int task_id, TVMParallelGroupEnv* penv);
 
+/*!
+ * \brief Claim the next chunk of iterations of the parallel loop of a
+ *  launch, so that tasks which finish early take over the iterations
+ *  of the others.
+ * \param penv The parallel environment backs the execution.
+ * \param extent The number of iterations of the loop.
+ * \param min_chunk The minimum number of iterations of a chunk.
+ * \param guided Whether the chunks shrink with the remaining iterations,
+ *           rather than all having min_chunk iterations.
+ * \param begin The first iteration of the claimed chunk.
+ * \param end One past the last iteration of the claimed chunk.
+ * \return 1 when a chunk is claimed, 0 when all the iterations are.
+ */
+TVM_DLL int TVMBackendParallelNextChunk(TVMParallelGroupEnv* penv, int64_t extent,
+                                        int64_t min_chunk, int guided, int64_t* begin,
+                                        int64_t* end);
+
 /*!
  * \brief Simple static initialization function.
  *  Run f once and set handle to be not null.
@@ -69,9 +69,18 @@
 #ifdef __cplusplus
 extern "C" {
 #endif
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
+// Default arguments are C++ only; C callers, such as the Go and Rust
+// bindings, pass all the arguments.
+#ifdef __cplusplus
+#define TVM_DEFAULT_ARG(value) = value
+#else
+#define TVM_DEFAULT_ARG(value)
+#endif
+
 /*! \brief type of array index. */
 typedef int64_t tvm_index_t;
 
@@ -390,6 +399,25 @@ TVM_DLL int TVMRaggedArrayAlloc(const tvm_index_t* shape, const tvm_index_t flat
                                 int dtype_code, int dtype_bits, int dtype_lanes, int device_type,
                                 int device_id, TVMArrayHandle* out);
 
+/*!
+ * \brief Create a ragged nd-array over packed ragged data owned by the
+ *  caller, without copying it. The data is never freed by the array.
+ *
+ * \param data The packed ragged data, on the device of the array
+ * \param dense_shape The dense shape of the array
+ * \param ndim The number of dimension of the array.
+ * \param dtype_code The type code of the dtype
+ * \param dtype_bits The number of bits of dtype
+ * \param dtype_lanes The number of lanes in the dtype.
+ * \param device_type The device type of context
+ * \param device_id The device id of context.
+ * \param out The output handle.
+ * \return 0 when success, -1 when failure happens
+ */
+TVM_DLL int TVMRaggedArrayFromData(void* data, const tvm_index_t* dense_shape, int ndim,
+                                   int dtype_code, int dtype_bits, int dtype_lanes,
+                                   int device_type, int device_id, TVMArrayHandle* out);
+
 /*!
  * \brief Create a view of an existing array
  *
@@ -406,6 +434,37 @@ TVM_DLL int TVMArrayCreateView(TVMArrayHandle array, const tvm_index_t* new_shap
                                int dtype_code, int dtype_bits, int dtype_lanes,
                                TVMArrayHandle* out);
 
+/*!
+ * \brief Create a view of an existing array starting at an element
+ *  offset into it, with the dtype of the array.
+ *
+ * \param array The array to create a view of
+ * \param elem_offset The offset of the view in elements of the array
+ * \param shape The new shape of the view
+ * \param ndim The number of dimension of the result array.
+ * \param elem_limit The end of the view's ragged row in elements of
+ *  the array, or -1 if the view is not a ragged row
+ * \param out The output handle.
+ * \return 0 when success, -1 when failure happens
+ */
+TVM_DLL int TVMArrayCreateOffsetView(TVMArrayHandle array, int64_t elem_offset,
+                                     const tvm_index_t* new_shape, int ndim, int64_t elem_limit,
+                                     TVMArrayHandle* out);
+
+/*!
+ * \brief Create a ragged array with the given dense shape that shares
+ *  the packed data of an existing array.
+ *
+ * \param array The array holding the packed ragged data
+ * \param dense_shape The dense shape of the ragged array
+ * \param ndim The number of dimension of the result array.
+ * \param flat_size The flattened ragged size, in elements
+ * \param out The output handle.
+ * \return 0 when success, -1 when failure happens
+ */
+TVM_DLL int TVMArrayCreateRaggedView(TVMArrayHandle array, const tvm_index_t* dense_shape,
+                                     int ndim, int64_t flat_size, TVMArrayHandle* out);
+
 /*!
  * \brief Free the TVM Array.
  * \param handle The array handle to be freed.
@@ -424,7 +483,22 @@ TVM_DLL int TVMArrayFree(TVMArrayHandle handle);
  * \return 0 when success, -1 when failure happens
  */
 TVM_DLL int TVMArrayCopyFromBytes(TVMArrayHandle handle, void* data, size_t nbytes,
-                                  bool is_dst_ragged = false);
+                                  bool is_dst_ragged TVM_DEFAULT_ARG(false));
+
+/*!
+ * \brief Copy the data of several arrays on the same context from CPU
+ *  byte arrays. The data are packed into one staging buffer and copied
+ *  to the device with a single transfer, from which they are scattered
+ *  to the arrays on the device.
+ * \param handles The array handles.
+ * \param data The data pointers.
+ * \param nbytes The number of bytes to copy to each array, which may be
+ *  smaller than the array for ragged arrays.
+ * \param num The number of arrays.
+ * \return 0 when success, -1 when failure happens
+ */
+TVM_DLL int TVMArrayCopyFromBytesBatch(TVMArrayHandle* handles, void** data, size_t* nbytes,
+                                       int num);
 
 /*!
  * \brief Copy array data to CPU byte array.
@@ -437,7 +511,7 @@ TVM_DLL int TVMArrayCopyFromBytes(TVMArrayHandle handle, void* data, size_t nbyt
  * \return 0 when success, -1 when failure happens
  */
 TVM_DLL int TVMArrayCopyToBytes(TVMArrayHandle handle, void* data, size_t nbytes,
-                                bool is_src_ragged = false);
+                                bool is_src_ragged TVM_DEFAULT_ARG(false));
 
 /*!
  * \brief Copy the array, both from and to must be valid during the copy.
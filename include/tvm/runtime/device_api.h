@@ -117,6 +117,30 @@ class TVM_DLL DeviceAPI {
                               TVMContext ctx_to,
                               DLDataType type_hint,
                               TVMStreamHandle stream) = 0;
+  /*!
+   * \brief copy data from the host to the device, ordered on the
+   *  stream currently set for the calling thread.
+   *
+   *  Unlike CopyDataFromTo, the copy may still be in flight when this
+   *  returns, but the caller is free to reuse the source memory
+   *  immediately. The default implementation performs a synchronous
+   *  copy.
+   *
+   * \param from The source host array.
+   * \param from_offset The byte offeset in the from.
+   * \param to The target array.
+   * \param to_offset The byte offset in the to.
+   * \param num_bytes The size of the memory in bytes
+   * \param ctx_to The target context
+   * \param type_hint The type of elements, only neded by certain backends.
+   */
+  virtual void CopyDataToDeviceStreamOrdered(const void* from,
+                                             size_t from_offset,
+                                             void* to,
+                                             size_t to_offset,
+                                             size_t num_bytes,
+                                             TVMContext ctx_to,
+                                             DLDataType type_hint);
     /*!
    * \brief Create a new stream of execution.
    *
@@ -144,6 +168,14 @@ class TVM_DLL DeviceAPI {
    * \param stream The stream to be set.
    */
   virtual void SetStream(TVMContext ctx, TVMStreamHandle stream) {}
+  /*!
+   * \brief Get the stream the calling thread runs its operations on, as
+   *  set by SetStream. Workspaces are only reused on the stream they
+   *  were freed on.
+   * \param ctx The context of the stream.
+   * \return The stream, nullptr for the default stream.
+   */
+  virtual TVMStreamHandle GetStream(TVMContext ctx) { return nullptr; }
   /*!
    * \brief Synchronize 2 streams of execution.
    *
@@ -159,6 +191,68 @@ class TVM_DLL DeviceAPI {
   virtual void SyncStreamFromTo(TVMContext ctx,
                                         TVMStreamHandle event_src,
                                         TVMStreamHandle event_dst);
+  /*!
+   * \brief Create an event, which marks a point in a stream that the
+   *  host or other streams can wait for. The default implementation,
+   *  for devices running their operations synchronously, returns
+   *  events that are always complete.
+   * \param ctx The context of the event.
+   * \return The event.
+   */
+  virtual void* CreateEvent(TVMContext ctx) { return nullptr; }
+  /*!
+   * \brief Free an event.
+   * \param ctx The context of the event.
+   * \param event The event to be freed.
+   */
+  virtual void FreeEvent(TVMContext ctx, void* event) {}
+  /*!
+   * \brief Record an event at the current end of a stream, replacing the
+   *  point it marked before.
+   * \param ctx The context of the event.
+   * \param event The event.
+   * \param stream The stream, nullptr for the default stream.
+   */
+  virtual void RecordEvent(TVMContext ctx, void* event, TVMStreamHandle stream) {}
+  /*!
+   * \brief Wait on the host until the operations before the point an
+   *  event marks have completed.
+   * \param ctx The context of the event.
+   * \param event The event.
+   */
+  virtual void EventSync(TVMContext ctx, void* event) {}
+  /*!
+   * \brief Whether the operations before the point an event marks have
+   *  completed, without waiting for them.
+   * \param ctx The context of the event.
+   * \param event The event.
+   */
+  virtual bool EventQuery(TVMContext ctx, void* event) { return true; }
+  /*!
+   * \brief Make a stream wait for an event before running the operations
+   *  enqueued on it afterwards, without blocking the host.
+   * \param ctx The context of the stream.
+   * \param stream The stream, nullptr for the default stream.
+   * \param event The event.
+   */
+  virtual void StreamWaitEvent(TVMContext ctx, TVMStreamHandle stream, void* event) {}
+  /*!
+   * \brief Create an event that also records the time the device reaches
+   *  it, for timing the operations between two events on the device
+   *  rather than on the host. The default implementation returns
+   *  nullptr, for devices without timing events.
+   * \param ctx The context of the event.
+   * \return The event, or nullptr if the device cannot time events.
+   */
+  virtual void* CreateTimingEvent(TVMContext ctx) { return nullptr; }
+  /*!
+   * \brief Get the time between two completed timing events.
+   * \param ctx The context of the events.
+   * \param start The event marking the start.
+   * \param end The event marking the end.
+   * \return The elapsed time in milliseconds.
+   */
+  virtual double EventElapsed(TVMContext ctx, void* start, void* end) { return 0; }
   /*!
    * \brief Allocate temporal workspace for backend execution.
    *
@@ -207,6 +301,7 @@ inline const char* DeviceName(int type) {
   switch (type) {
     case kDLCPU: return "cpu";
     case kDLGPU: return "gpu";
+    case kDLCPUPinned: return "cpu_pinned";
     case kDLOpenCL: return "opencl";
     case kDLSDAccel: return "sdaccel";
     case kDLAOCL: return "aocl";
@@ -24,7 +24,9 @@
 #define TVM_RUNTIME_MEMORY_H_
 
 #include <tvm/runtime/object.h>
+#include <cstddef>
 #include <cstdlib>
+#include <new>
 #include <utility>
 #include <type_traits>
 
@@ -39,6 +41,107 @@ namespace runtime {
 template<typename T, typename... Args>
 inline ObjectPtr<T> make_object(Args&&... args);
 
+/*!
+ * \brief Thread-local free lists of the memory of small objects, one
+ *  per size class.
+ *
+ *  Compilation creates and drops huge numbers of short lived IR
+ *  nodes. While an ObjectPoolScope is active on a thread, the memory
+ *  of the small objects it frees goes to the free lists of its pool
+ *  instead of the heap, and is reused by the objects it allocates next.
+ *  The memory left in the pool is released in bulk when the scope ends.
+ *
+ *  Each chunk is allocated from the heap on its own, so objects can
+ *  outlive the scope and be freed on any thread. Chunks are rounded up
+ *  to their size class whether a pool is active or not, so that any
+ *  chunk can be reused for any object of its class.
+ */
+class ObjectPool {
+ public:
+  /*! \brief The granularity of the size classes. */
+  static constexpr size_t kGranularity = 16;
+  /*! \brief The size of the largest objects that are pooled. */
+  static constexpr size_t kMaxSize = 512;
+
+  ~ObjectPool() {
+    for (void*& head : free_) {
+      while (head) {
+        void* next = *static_cast<void**>(head);
+        ::operator delete(head);
+        head = next;
+      }
+    }
+  }
+
+  /*! \brief The size of the chunks of objects of the given size. */
+  static constexpr size_t ChunkSize(size_t size) {
+    return (size + kGranularity - 1) / kGranularity * kGranularity;
+  }
+
+  /*! \brief Whether objects of the given size and alignment are pooled. */
+  static constexpr bool Pooled(size_t size, size_t align) {
+    return size <= kMaxSize && align <= alignof(std::max_align_t);
+  }
+
+  /*! \brief Allocate a chunk for an object of a pooled size. */
+  static void* Alloc(size_t size) {
+    ObjectPool* pool = ThreadLocal();
+    if (pool) {
+      void*& head = pool->free_[ChunkSize(size) / kGranularity - 1];
+      if (head) {
+        void* ret = head;
+        head = *static_cast<void**>(head);
+        return ret;
+      }
+    }
+    return ::operator new(ChunkSize(size));
+  }
+
+  /*! \brief Free the chunk of an object of a pooled size. */
+  static void Free(void* ptr, size_t size) {
+    ObjectPool* pool = ThreadLocal();
+    if (!pool) {
+      ::operator delete(ptr);
+      return;
+    }
+    void*& head = pool->free_[ChunkSize(size) / kGranularity - 1];
+    *static_cast<void**>(ptr) = head;
+    head = ptr;
+  }
+
+  /*! \brief The pool of the current thread, or nullptr. */
+  TVM_DLL static ObjectPool*& ThreadLocal();
+
+ private:
+  void* free_[kMaxSize / kGranularity] = {nullptr};
+};
+
+/*!
+ * \brief Makes the objects freed by the current thread recycle their
+ *  memory through an ObjectPool until it is destroyed. Nested scopes
+ *  share the pool of the outermost one.
+ */
+class ObjectPoolScope {
+ public:
+  /*! \param enable Whether the scope is active, for opt-in use. */
+  explicit ObjectPoolScope(bool enable = true) {
+    if (enable && !ObjectPool::ThreadLocal()) {
+      owned_ = new ObjectPool();
+      ObjectPool::ThreadLocal() = owned_;
+    }
+  }
+
+  ~ObjectPoolScope() {
+    if (owned_) {
+      ObjectPool::ThreadLocal() = nullptr;
+      delete owned_;
+    }
+  }
+
+ private:
+  ObjectPool* owned_{nullptr};
+};
+
 // Detail implementations after this
 //
 // The current design allows swapping the
@@ -46,7 +149,6 @@ inline ObjectPtr<T> make_object(Args&&... args);
 //
 // Possible future allocator optimizations:
 // - Arena allocator that gives ownership of memory to arena (deleter_= nullptr)
-// - Thread-local object pools: one pool per size and alignment requirement.
 // - Can specialize by type of object to give the specific allocator to each object.
 
 /*!
@@ -121,7 +223,12 @@ class SimpleObjAllocator :
       // class with non-virtual destructor.
       // We are fine here as we captured the right deleter during construction.
       // This is also the right way to get storage type for an object pool.
-      StorageType* data = new StorageType();
+      StorageType* data;
+      if (kPooled) {
+        data = static_cast<StorageType*>(ObjectPool::Alloc(sizeof(StorageType)));
+      } else {
+        data = new StorageType();
+      }
       new (data) T(std::forward<Args>(args)...);
       return reinterpret_cast<T*>(data);
     }
@@ -141,8 +248,14 @@ class SimpleObjAllocator :
       // instead of tptr->~T(), which could mean the intention
       // call a virtual destructor(which may not be available and is not required).
       tptr->T::~T();
-      delete reinterpret_cast<StorageType*>(tptr);
+      if (kPooled) {
+        ObjectPool::Free(tptr, sizeof(StorageType));
+      } else {
+        delete reinterpret_cast<StorageType*>(tptr);
+      }
     }
+
+    static constexpr bool kPooled = ObjectPool::Pooled(sizeof(StorageType), alignof(StorageType));
   };
 
   // Array handler that uses new/delete.
@@ -232,6 +232,44 @@ constexpr const char* tvm_set_device = "__tvm_set_device";
 constexpr const char* tvm_global_barrier_state = "__tvm_global_barrier_state";
 /*! \brief Prepare the global barrier before kernels that uses global barrier. */
 constexpr const char* tvm_prepare_global_barrier = "__tvm_prepare_global_barrier";
+/*! \brief Suffix of the constant memory copies of the aux arguments of a kernel. */
+constexpr const char* tvm_aux_constant_suffix = "_aux_const";
+/*!
+ * \brief Check the prep code cache before running prep code.
+ *
+ *  Called as (func_name, num_aux_buffers, aux_buffer_0, ...,
+ *  aux_buffer_n, length_0, ..., length_m), where a length is either
+ *  an integer or a host buffer followed by its size in bytes.
+ *  Returns 1 if the auxiliary buffers already hold the prep code
+ *  results for the given lengths.
+ */
+constexpr const char* tvm_prep_code_cache_lookup = "__tvm_prep_code_cache_lookup";
+/*!
+ * \brief Called at the start of instrumented prep code, with the
+ *  function name as argument.
+ */
+constexpr const char* tvm_prep_code_profile_begin = "__tvm_prep_code_profile_begin";
+/*!
+ * \brief Called at the end of instrumented prep code with the function
+ *  name, the number of auxiliary arrays and the number of bytes
+ *  copied from the host to the device.
+ */
+constexpr const char* tvm_prep_code_profile_end = "__tvm_prep_code_profile_end";
+/*!
+ * \brief Called before the launch of a kernel instrumented to record
+ *  the cycle counter of its blocks, with the function name, the index
+ *  of the kernel in it, the number of blocks and the device type and
+ *  id. Returns the device buffer of two int64 per block the kernel
+ *  records the cycle counter at its entry and exit in.
+ */
+constexpr const char* tvm_block_cycles_buffer = "__tvm_block_cycles_buffer";
+/*! \brief Suffix of the fast call entries of functions, see GetFastCall. */
+constexpr const char* tvm_fast_call_suffix = "_fastcall";
+/*!
+ * \brief Function of a module returning the address of the fast call
+ *  entry of the function named by its argument, or nullptr.
+ */
+constexpr const char* tvm_get_fast_call = "__tvm_get_fast_call";
 /*! \brief Placeholder for the module's entry function. */
 constexpr const char* tvm_module_main = "__tvm_main__";
 }  // namespace symbol
@@ -104,6 +104,30 @@ class NDArray : public ObjectRef {
    * \note The memory size of new array must be smaller than the current one.
    */
   TVM_DLL NDArray CreateView(std::vector<int64_t> shape, DLDataType dtype);
+  /*!
+   * \brief Create a NDArray that shares the data memory with the
+   *  current one, starting elem_offset elements into it. Used to
+   *  expose the rows of a packed ragged array without copying.
+   * \param elem_offset The offset of the view, in elements of the current array.
+   * \param shape The shape of the new array.
+   * \param elem_limit The end of the view's row, in elements of the
+   *  current array, given by the prefix sum of the row lengths; or -1
+   *  to only check against the current array.
+   * \note The view must lie within the current array.
+   */
+  TVM_DLL NDArray CreateOffsetView(int64_t elem_offset, std::vector<int64_t> shape,
+                                   int64_t elem_limit = -1);
+  /*!
+   * \brief Create a ragged NDArray, as created by RaggedEmpty, that
+   *  shares the data memory with the current one. The current array
+   *  holds the packed ragged data, for example after being imported
+   *  from a jagged framework tensor through DLPack.
+   * \param dense_shape The dense shape of the ragged array.
+   * \param flat_size The flattened ragged size, i.e. the prefix sum of
+   *  the row lengths over all rows, which must fit in the current array.
+   * \note The dense shape may be bigger than the current array.
+   */
+  TVM_DLL NDArray CreateRaggedView(std::vector<int64_t> dense_shape, int64_t flat_size);
   /*!
    * \brief Create a reference view of NDArray that
    *  represents as DLManagedTensor.
@@ -128,6 +152,17 @@ class NDArray : public ObjectRef {
    */
   TVM_DLL static NDArray RaggedEmpty(std::vector<int64_t> shape, int64_t flat_size,
                                      DLDataType dtype, DLContext ctx);
+  /*!
+   * \brief Create a ragged NDArray over memory owned by the caller,
+   *  such as packed ragged inputs already resident on the device.
+   * \param data The packed ragged data, which must outlive the array.
+   * \param dense_shape The dense shape of the ragged array.
+   * \param dtype The data type of the array.
+   * \param ctx The context of the data.
+   * \return The created Array, which never frees data.
+   */
+  TVM_DLL static NDArray RaggedFromData(void* data, std::vector<int64_t> dense_shape,
+                                        DLDataType dtype, DLContext ctx);
   /*!
    * \brief Create a NDArray backed by a dlpack tensor.
    *
@@ -190,8 +225,21 @@ class NDArray : public ObjectRef {
  * \brief Save a DLTensor to stream
  * \param strm The outpu stream
  * \param tensor The tensor to be saved.
+ * \param padding The number of zero bytes written before the data, recorded
+ *  in the reserved field of the header so that loaders skip them. Used to
+ *  align the data in files that are memory mapped.
  */
-inline bool SaveDLTensor(dmlc::Stream* strm, const DLTensor* tensor);
+inline bool SaveDLTensor(dmlc::Stream* strm, const DLTensor* tensor, uint64_t padding = 0);
+
+/*!
+ * \brief Get the padding that aligns the data of a saved DLTensor.
+ * \param pos The position in the stream the tensor is saved at.
+ * \param tensor The tensor to be saved.
+ * \param alignment The alignment of the data, relative to the start of
+ *  the stream.
+ * \return The padding to pass to SaveDLTensor.
+ */
+inline uint64_t DLTensorDataPadding(size_t pos, const DLTensor* tensor, size_t alignment);
 
 /*!
  * \brief The container base structure
@@ -366,8 +414,18 @@ inline Object* TVMArrayHandleToObjectHandle(TVMArrayHandle handle) {
 /*! \brief Magic number for NDArray file */
 constexpr uint64_t kTVMNDArrayMagic = 0xDD5E40F096B4A13F;
 
-inline bool SaveDLTensor(dmlc::Stream* strm, const DLTensor* tensor) {
-  uint64_t header = kTVMNDArrayMagic, reserved = 0;
+inline uint64_t DLTensorDataPadding(size_t pos, const DLTensor* tensor, size_t alignment) {
+  if (alignment <= 1) return 0;
+  // The magic, the reserved field, the context, ndim, the dtype, the
+  // shape and the data size precede the data.
+  size_t header_bytes = sizeof(uint64_t) * 2 + sizeof(DLContext) + sizeof(int) +
+                        sizeof(DLDataType) + sizeof(int64_t) * tensor->ndim + sizeof(int64_t);
+  size_t end = pos + header_bytes;
+  return static_cast<uint64_t>((alignment - end % alignment) % alignment);
+}
+
+inline bool SaveDLTensor(dmlc::Stream* strm, const DLTensor* tensor, uint64_t padding) {
+  uint64_t header = kTVMNDArrayMagic, reserved = padding;
   strm->Write(header);
   strm->Write(reserved);
   // Always save data as CPU context
@@ -394,6 +452,10 @@ inline bool SaveDLTensor(dmlc::Stream* strm, const DLTensor* tensor) {
   }
   int64_t data_byte_size = type_bytes * num_elems;
   strm->Write(data_byte_size);
+  if (padding != 0) {
+    std::vector<uint8_t> zeros(padding, 0);
+    strm->Write(dmlc::BeginPtr(zeros), padding);
+  }
 
   if (DMLC_IO_NO_ENDIAN_SWAP && tensor->ctx.device_type == kDLCPU && tensor->strides == nullptr &&
       tensor->byte_offset == 0) {
@@ -440,6 +502,11 @@ inline bool NDArray::Load(dmlc::Stream* strm) {
   int64_t data_byte_size;
   CHECK(strm->Read(&data_byte_size)) << "Invalid DLTensor file format";
   CHECK(data_byte_size == num_elems * elem_bytes) << "Invalid DLTensor file format";
+  // The reserved field holds the padding aligning the data.
+  if (reserved != 0) {
+    std::vector<uint8_t> padding(reserved);
+    CHECK(strm->Read(dmlc::BeginPtr(padding), reserved)) << "Invalid DLTensor file format";
+  }
   CHECK(strm->Read(ret->data, data_byte_size)) << "Invalid DLTensor file format";
   if (!DMLC_IO_NO_ENDIAN_SWAP) {
     dmlc::ByteSwap(ret->data, elem_bytes, num_elems);
@@ -1522,6 +1522,27 @@ inline TVMRetValue::operator T() const {
   return AsObjectRef<T>();
 }
 
+/*!
+ * \brief Get the fast call entry of a function of a module built with
+ *  the fast_call_api option: a plain C function taking the arguments of
+ *  the function in order, as DLTensor* for buffers and as values for
+ *  scalars, and returning 0 on success, which can be called without
+ *  boxing the arguments into TVMValues.
+ * \tparam FType The function pointer type of the entry, such as
+ *  int32_t (*)(DLTensor*, DLTensor*, int32_t).
+ * \param mod The module.
+ * \param name The name of the function.
+ * \return The entry, or nullptr if the module has none for the function.
+ * \note The entry does not check the types of its arguments.
+ */
+template <typename FType>
+inline FType GetFastCall(Module mod, const std::string& name) {
+  PackedFunc f = mod.GetFunction(symbol::tvm_get_fast_call);
+  if (f == nullptr) return nullptr;
+  void* addr = f(name);
+  return reinterpret_cast<FType>(addr);
+}
+
 inline PackedFunc Module::GetFunction(const std::string& name, bool query_imports) {
   return (*this)->GetFunction(name, query_imports);
 }
@@ -26,6 +26,7 @@
 
 #include <functional>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace tvm {
@@ -51,10 +52,13 @@ class ThreadGroup {
     *        If  `true`, worker0 will not be launched in a new thread and
     *        `worker_callback` will only be called for values >= 1. This
     *        allows use of the main thread as a worker.
+    * \param cpus The CPUs to bind the threads to, in order, instead of
+    *        those of the system (or of its NUMA node) by frequency.
     */
   ThreadGroup(int num_workers,
               std::function<void(int)> worker_callback,
-              bool exclude_worker0 = false);
+              bool exclude_worker0 = false,
+              std::vector<unsigned int> cpus = {});
   ~ThreadGroup();
 
    /*!
@@ -95,6 +99,47 @@ void Yield();
  */
 int MaxConcurrency();
 
+/*!
+ * \return The NUMA node the thread pool is bound to, set by the
+ *  TVM_NUMA_NODE environment variable, or -1 if it is not bound.
+ */
+int BoundNumaNode();
+
+/*!
+ * \return The number of NUMA nodes of the system, 1 if it is unknown.
+ */
+int NumNumaNodes();
+
+/*!
+ * \param node A NUMA node.
+ * \return The ids of the CPUs of the node, empty if it is unknown.
+ */
+std::vector<unsigned int> NumaNodeCpus(int node);
+
+/*!
+ * \return Whether the calling thread runs a task of a parallel launch.
+ */
+bool InParallelLaunch();
+
+/*!
+ * \brief Create a named thread pool, which threads bound to it launch
+ *  their parallel jobs on instead of their own pool. Sessions bound to
+ *  pools on disjoint CPUs run side by side without contending for
+ *  workers.
+ * \param name The name of the pool.
+ * \param num_workers The number of workers, 0 for one per CPU of cpus.
+ * \param cpus The CPUs to bind the workers to, one per worker.
+ */
+void CreateThreadPool(const std::string& name, int num_workers,
+                      const std::vector<unsigned int>& cpus);
+
+/*!
+ * \brief Bind the calling thread to a named thread pool.
+ * \param name The name of the pool, empty for the own pool of the thread.
+ * \return The name of the pool the thread was bound to.
+ */
+std::string BindThreadPool(const std::string& name);
+
 
 }  // namespace threading
 }  // namespace runtime
@@ -36,6 +36,9 @@
 
 namespace tvm {
 namespace runtime {
+
+class MappedFile;
+
 namespace vm {
 
 /*!
@@ -79,6 +82,30 @@ class VMClosure : public Closure {
   TVM_DEFINE_OBJECT_REF_METHODS(VMClosure, Closure, VMClosureObj);
 };
 
+/*!
+ * \brief An object representing a ragged tensor. The rows of the
+ *  tensor are packed back to back in data, which has the dense shape
+ *  (rows, max_len, ...) of the tensor but only the packed size.
+ */
+class RaggedTensorObj : public Object {
+ public:
+  /*! \brief The packed data, viewed with the dense shape. */
+  NDArray data;
+  /*! \brief The int32 row offsets into data, in rows + 1 entries. */
+  NDArray offsets;
+
+  static constexpr const uint32_t _type_index = TypeIndex::kDynamic;
+  static constexpr const char* _type_key = "vm.RaggedTensor";
+  TVM_DECLARE_FINAL_OBJECT_INFO(RaggedTensorObj, Object);
+};
+
+/*! \brief reference to ragged tensor. */
+class RaggedTensor : public ObjectRef {
+ public:
+  RaggedTensor(NDArray data, NDArray offsets);
+  TVM_DEFINE_OBJECT_REF_METHODS(RaggedTensor, ObjectRef, RaggedTensorObj);
+};
+
 /*! \brief Magic number for NDArray list file  */
 constexpr uint64_t kTVMNDArrayListMagic = 0xF7E58D4F05049CB7;
 
@@ -113,6 +140,7 @@ enum class Opcode {
   LoadConsti = 14U,
   Fatal = 15U,
   AllocStorage = 16U,
+  AllocRaggedTensor = 17U,
 };
 
 /*! \brief A single virtual machine instruction.
@@ -240,6 +268,14 @@ struct Instruction {
       /*! \brief The hint of the dtype. */
       DLDataType dtype_hint;
     } alloc_storage;
+    struct /* AllocRaggedTensor Operands */ {
+      /*! \brief The register to read the dense shape out of. */
+      RegName shape_register;
+      /*! \brief The register to read the row lengths out of. */
+      RegName lengths;
+      /*! \brief The datatype of tensor to be allocated. */
+      DLDataType dtype;
+    } alloc_ragged_tensor;
   };
 
   /*!
@@ -381,6 +417,16 @@ struct Instruction {
    */
   static Instruction AllocStorage(RegName size, RegName alignment,
                                   DLDataType dtype_hint, RegName dst);
+  /*!
+   * \brief Allocate a ragged tensor, sized by the sum of its row lengths.
+   * \param shape_register The register containing the dense shape.
+   * \param lengths The register containing the int32 row lengths.
+   * \param dtype The dtype of the tensor.
+   * \param dst The destination register.
+   * \return The alloc ragged tensor instruction.
+   */
+  static Instruction AllocRaggedTensor(RegName shape_register, RegName lengths,
+                                       DLDataType dtype, RegName dst);
 
   Instruction();
   Instruction(const Instruction& instr);
@@ -494,6 +540,19 @@ class Executable : public ModuleNode {
    */
   static runtime::Module Load(const std::string& code, const runtime::Module lib);
 
+  /*!
+   * \brief Load a saved VM executable by mapping its file into memory.
+   *
+   *  The constants of the executable view the mapping in place, so that
+   *  they are neither read nor copied before being uploaded to the device.
+   *
+   * \param file_name The file the bytecode was saved to.
+   * \param lib The compiled runtime library.
+   *
+   * \return exe The constructed executable.
+   */
+  static runtime::Module LoadFromFile(const std::string& file_name, const runtime::Module lib);
+
   /*!
    * \brief Get the serialized form of the `functions`. This is
    * essentially bytecode serialization.
@@ -586,11 +645,12 @@ class Executable : public ModuleNode {
   void SaveGlobalSection(dmlc::Stream* strm);
 
   /*!
-   * \brief Save the constant pool.
+   * \brief Save the constant pool, with the data of each constant aligned
+   *  for the executable to be memory mapped.
    *
    * \param strm The input stream.
    */
-  void SaveConstantSection(dmlc::Stream* strm);
+  void SaveConstantSection(dmlc::SeekStream* strm);
 
   /*!
    * \brief Save primitive op names.
@@ -617,8 +677,11 @@ class Executable : public ModuleNode {
    * \brief Load the constant pool.
    *
    * \param strm The input stream.
+   * \param file The mapped file the stream is over, if any, which the
+   *  constants view in place.
    */
-  void LoadConstantSection(dmlc::Stream* strm);
+  void LoadConstantSection(dmlc::SeekStream* strm,
+                           const std::shared_ptr<MappedFile>& file = nullptr);
 
   /*!
    * \brief Load primitive op names.
@@ -724,9 +787,10 @@ class VirtualMachine : public runtime::ModuleNode {
   /*!
    * \brief Read a VM register.
    * \param reg The register to read from.
-   * \return The read object.
+   * \return The read object, valid until the register is written or its
+   *  frame is popped.
    */
-  inline ObjectRef ReadRegister(RegName reg) const;
+  inline const ObjectRef& ReadRegister(RegName reg) const;
 
   /*!
    * \brief Read a VM register and cast it to int32_t
@@ -787,13 +851,24 @@ class VirtualMachine : public runtime::ModuleNode {
    *
    * This does not begin execution of the VM.
    */
-  void InvokeGlobal(const VMFunction& func, const std::vector<ObjectRef>& args);
+  void InvokeGlobal(Index func_index, const std::vector<ObjectRef>& args);
 
   /*!
    * \brief The constant pool for runtime. It caches the device dependent
    * object to avoid rellocation of constants during inference.
    */
   std::vector<ObjectRef> const_pool_;
+  /*!
+   * \brief The scalars loaded by the LoadConsti instructions of each
+   *  function, by program counter, made the first time they run.
+   */
+  std::vector<std::vector<ObjectRef>> consti_pool_;
+  /*! \brief The register files of popped frames, reused by later calls. */
+  std::vector<std::vector<ObjectRef>> free_register_files_;
+  /*! \brief Scratch space for the arguments of packed calls, reused across calls. */
+  std::vector<ObjectRef> packed_args_;
+  std::vector<TVMValue> packed_values_;
+  std::vector<int> packed_codes_;
 };
 
 }  // namespace vm
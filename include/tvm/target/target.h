@@ -189,12 +189,21 @@ class BuildConfigNode : public Object {
    * done. Otherwise, a split will be done with this factor and the inner loop will be unrolled.
    */
   int double_buffer_split_loop = 1;
+  /*!
+   * \brief Whether the fetches of double buffered shared memory stages from global memory
+   * are made by asynchronous copies (cp.async), which requires CUDA compute capability 8.0.
+   */
+  bool double_buffer_async_copy = false;
   /*! \brief Threshold of number of steps in the loop to be automatically unrolled */
   int auto_unroll_max_step = 0;
   /*! \brief The maximum nested level of loops that can be automatically unrolled */
   int auto_unroll_max_depth = 8;
   /*! \brief The maximum extent of loop that will be unrolled */
   int auto_unroll_max_extent = 0;
+  /*! \brief The maximum upper bound of the extent of innermost
+   * loops with a runtime extent, such as ragged loops, that are
+   * unrolled into guarded copies of their body, or 0 for none. */
+  int auto_unroll_max_ragged_extent = 0;
   /*!
    * \brief Whether to explicitly unroll the loop. If set to false, the unroll hint will
    * be passed to the CodeGen phase. Set to true if CodeGen supports unroll pragma.
@@ -231,20 +240,122 @@ class BuildConfigNode : public Object {
   /*! \brief Whether to run the load hoisting pass. */
   bool hoist_loads = false;
 
-  /*! \brief Mode specifying how to process prep_code. */
+  /*! \brief Mode specifying how to process prep_code. One of
+   * "with_prep_code", "with_cached_prep_code", "no_prep_code",
+   * "only_prep_code", "external_prep_code" and "fused_prep_code". */
   std::string prep_code_mode = "with_prep_code";
 
   /*! \brief Whether to fill in bodies of prep code functions. Used
    * for debugging. */
   bool fill_in_function_bodies = true;
 
+  /*! \brief Whether to generate the prep code (A-functions and
+   * fusion functions) as kernels on the target device instead of as
+   * host loops followed by a copy. */
+  bool prep_code_on_device = false;
+
+  /*! \brief Whether the fused to outer and fused to inner maps of
+   * ragged fused loops are computed where they are used, by a binary
+   * search over the start positions of the outer iterations, instead
+   * of being materialized by the prep code. */
+  bool fused_maps_on_the_fly = false;
+
+  /*! \brief Whether to instrument the prep code to report its time,
+   * number of auxiliary arrays and bytes copied to the runtime. */
+  bool instrument_prep_code = false;
+
+  /*! \brief Whether the blocks of CUDA kernels record the cycle
+   * counter at their entry and exit, for the runtime to report the
+   * distribution of their durations. */
+  bool instrument_block_cycles = false;
+
+  /*! \brief Whether to allocate the runtime sized intermediate
+   * buffers of ragged tensors out of a single arena. */
+  bool ragged_arena_allocation = false;
+
+  /*! \brief Whether loops over ragged scan dimensions in kernels
+   * should exit at each sequence's length instead of running to the
+   * maximum length under a predicate. */
+  bool ragged_scan_early_exit = false;
+
+  /*! \brief If positive, the number of blocks of the persistent grid
+   * that kernels with a runtime sized grid, such as those of fused
+   * ragged loops, are rewritten to. */
+  int persistent_ragged_blocks = 0;
+
+  /*! \brief The number of iterations a block of a persistent grid
+   * takes from the work queue at a time. */
+  int persistent_ragged_chunk = 1;
+
+  /*! \brief If positive, the distance, in loop iterations, at which
+   * gathers through aux arrays are software prefetched. */
+  int indirect_prefetch_distance = 0;
+
+  /*! \brief Whether loops in kernels are partitioned on the ragged
+   * bounds of the conditions in their bodies. */
+  bool partition_ragged_loops = false;
+
+  /*! \brief The number of threads the loop nests of the stages of a
+   * schedule are built on when it is lowered. */
+  int schedule_ops_threads = 1;
+
+  /*! \brief Whether structurally equal expressions are hash-consed
+   * into shared nodes during lowering. */
+  bool intern_exprs = false;
+
+  /*! \brief Whether index subexpressions that occur more than once
+   * are bound to variables at the end of lowering. */
+  bool eliminate_common_subexpr = false;
+
+  /*! \brief Whether lowering recycles the memory of the IR nodes it
+   * frees through a thread-local pool, see runtime::ObjectPool. */
+  bool pool_ir_nodes = false;
+
+  /*! \brief Whether the read-only aux structures of CUDA kernels are
+   * read from constant memory when they fit. */
+  bool aux_constant_memory = false;
+
+  /*! \brief The number of threads the code of the functions of an
+   * LLVM module is generated and optimized on. */
+  int llvm_codegen_threads = 1;
+
+  /*! \brief The maximum number of registers a thread of a CUDA kernel
+   * compiled with NVRTC may use, or 0 for no cap. */
+  int cuda_max_registers = 0;
+
+  /*! \brief The number of threads the kernels of a CUDA module are
+   * compiled on, as separate translation units. */
+  int cuda_compile_threads = 1;
+
+  /*! \brief How the iterations of parallel loops on the CPU are
+   * distributed among the tasks: "static" (in equal blocks), "dynamic"
+   * (in chunks of parallel_min_chunk iterations claimed by the tasks as
+   * they become idle) or "guided" (in claimed chunks that shrink with
+   * the remaining iterations). */
+  std::string parallel_schedule = "static";
+
+  /*! \brief The minimum number of iterations of a chunk of a dynamically
+   * scheduled parallel loop. */
+  int parallel_min_chunk = 1;
+
+  /*! \brief Whether a fast call entry, callable as a plain C function
+   * without boxing the arguments, is built along with every packed
+   * host function. */
+  bool fast_call_api = false;
+
+  /*! \brief Whether lowering warns about every ragged extent that
+   * bound inference over-approximated, see te::DiagnoseRaggedBounds. */
+  bool diagnose_ragged_bounds = false;
+
   void VisitAttrs(AttrVisitor* v) {
     v->Visit("data_alignment", &data_alignment);
     v->Visit("offset_factor", &offset_factor);
     v->Visit("double_buffer_split_loop", &double_buffer_split_loop);
+    v->Visit("double_buffer_async_copy", &double_buffer_async_copy);
     v->Visit("auto_unroll_max_step", &auto_unroll_max_step);
     v->Visit("auto_unroll_max_depth", &auto_unroll_max_depth);
     v->Visit("auto_unroll_max_extent", &auto_unroll_max_extent);
+    v->Visit("auto_unroll_max_ragged_extent", &auto_unroll_max_ragged_extent);
     v->Visit("unroll_explicit", &unroll_explicit);
     v->Visit("restricted_func", &restricted_func);
     v->Visit("detect_global_barrier", &detect_global_barrier);
@@ -257,6 +368,28 @@ class BuildConfigNode : public Object {
     v->Visit("prep_code_mode", &prep_code_mode);
     v->Visit("hoist_loads", &hoist_loads);
     v->Visit("fill_in_function_bodies", &fill_in_function_bodies);
+    v->Visit("prep_code_on_device", &prep_code_on_device);
+    v->Visit("fused_maps_on_the_fly", &fused_maps_on_the_fly);
+    v->Visit("instrument_prep_code", &instrument_prep_code);
+    v->Visit("instrument_block_cycles", &instrument_block_cycles);
+    v->Visit("ragged_arena_allocation", &ragged_arena_allocation);
+    v->Visit("ragged_scan_early_exit", &ragged_scan_early_exit);
+    v->Visit("persistent_ragged_blocks", &persistent_ragged_blocks);
+    v->Visit("persistent_ragged_chunk", &persistent_ragged_chunk);
+    v->Visit("indirect_prefetch_distance", &indirect_prefetch_distance);
+    v->Visit("partition_ragged_loops", &partition_ragged_loops);
+    v->Visit("schedule_ops_threads", &schedule_ops_threads);
+    v->Visit("intern_exprs", &intern_exprs);
+    v->Visit("eliminate_common_subexpr", &eliminate_common_subexpr);
+    v->Visit("pool_ir_nodes", &pool_ir_nodes);
+    v->Visit("aux_constant_memory", &aux_constant_memory);
+    v->Visit("llvm_codegen_threads", &llvm_codegen_threads);
+    v->Visit("cuda_max_registers", &cuda_max_registers);
+    v->Visit("cuda_compile_threads", &cuda_compile_threads);
+    v->Visit("parallel_schedule", &parallel_schedule);
+    v->Visit("parallel_min_chunk", &parallel_min_chunk);
+    v->Visit("fast_call_api", &fast_call_api);
+    v->Visit("diagnose_ragged_bounds", &diagnose_ragged_bounds);
   }
 
   static constexpr const char* _type_key = "BuildConfig";
@@ -157,6 +157,12 @@ class DimensionRelationGraphNode : public Object {
 
   static DimensionRelationGraph make(Array<Dimension> root_dimensions);
 
+  /*!
+   * \brief Whether the leaf dimensions differ from the root
+   * dimensions, i.e. the layout has been split, fused or reordered.
+   */
+  bool IsChanged() const;
+
   static constexpr const char* _type_key = "DimensionRelationGraph";
   TVM_DECLARE_FINAL_OBJECT_INFO(DimensionRelationGraphNode, Object);
 };
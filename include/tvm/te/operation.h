@@ -625,6 +625,27 @@ class ConditionalOpNode : public BaseVarDimOpNode {
   Array<IterVar> explicit_loop_ivs;
   Array<DimInfo> explicit_dimensions;
 
+  /*!
+   * \brief How the condition is lowered, set by the "lowering" attr.
+   *
+   *  kBranch guards each branch by an IfThenElse on the condition.
+   *  kPredicated computes both branches for every element and selects
+   *  the result when storing it, which avoids divergence for cheap
+   *  branches. kPartitioned iterates over a permutation of the
+   *  elements, computed in the prep code, that places the elements
+   *  taking the then branch before the others, so that the branch
+   *  only diverges at a single boundary.
+   */
+  enum LoweringMode : int { kBranch = 0, kPredicated = 1, kPartitioned = 2 };
+  int lowering_mode{kBranch};
+  /*!
+   * \brief For kPartitioned, the permutation from iteration positions
+   *  to elements and the position where the elements taking the else
+   *  branch start. Their bodies are set when generating the prep code.
+   */
+  UninterpFun partition_perm_uf;
+  UninterpFun partition_then_end_uf;
+
   /*! \brief constructor */
   ConditionalOpNode() {}
   // override behavior.
@@ -665,6 +686,9 @@ class ConditionalOpNode : public BaseVarDimOpNode {
     v->Visit("explicit_dims", &explicit_dims);
     v->Visit("explicit_loop_ivs", &explicit_loop_ivs);
     v->Visit("explicit_dimensions", &explicit_dimensions);
+    v->Visit("lowering_mode", &lowering_mode);
+    v->Visit("partition_perm_uf", &partition_perm_uf);
+    v->Visit("partition_then_end_uf", &partition_then_end_uf);
   }
   static Operation make(std::string name, std::string tag, Map<std::string, ObjectRef> attrs,
                         UninterpFun condition_uf, Array<Tensor> from_then, Array<Tensor> then_case,
@@ -687,6 +711,16 @@ class SpecializationEnvelopeOpNode : public BaseVarDimOpNode {
   Array<Array<Tensor>> inputs;
   std::vector<const BaseVarDimOpNode*> input_ops;
   Array<Dimension> spatial_dimensions_;
+  /*!
+   * \brief When defined, by the "dispatch_conditions" attr, a single
+   *  specialization computes the whole output: the first whose
+   *  condition holds, or the last one if none does. The conditions
+   *  are evaluated once, into dispatch_var, before the main body, and
+   *  the specializations, which are otherwise all run, are guarded by
+   *  it.
+   */
+  Array<PrimExpr> dispatch_conditions;
+  Var dispatch_var;
 
   /*! \brief constructor */
   SpecializationEnvelopeOpNode() {}
@@ -723,7 +757,11 @@ class SpecializationEnvelopeOpNode : public BaseVarDimOpNode {
     v->Visit("attrs", &attrs);
     v->Visit("inputs", &inputs);
     v->Visit("spatial_dimensions_", &spatial_dimensions_);
+    v->Visit("dispatch_conditions", &dispatch_conditions);
+    v->Visit("dispatch_var", &dispatch_var);
   }
+  /*! \brief The value of dispatch_var for the given call. */
+  PrimExpr DispatchValue() const;
   static Operation make(std::string name, std::string tag, Map<std::string, ObjectRef> attrs,
                         Array<Array<Tensor>> inputs);
 
@@ -796,6 +834,16 @@ class ExternOpNode : public OperationNode {
   Array<Buffer> input_placeholders;
   /*! \brief Symbolic placeholder representation of outputs */
   Array<Buffer> output_placeholders;
+  /*! \brief Symbolic placeholders of the offset arrays of ragged
+   * inputs and outputs, i.e. the materialized A-functions of their
+   * storage layouts, passed to the body along with the data. */
+  Array<Buffer> aux_placeholders;
+  /*! \brief For each aux placeholder, the index of the buffer whose
+   * layout it belongs to, counting inputs first, then outputs. */
+  Array<Integer> aux_buffer_indices;
+  /*! \brief For each aux placeholder, the dimension of the layout
+   * whose A-function it holds. */
+  Array<Integer> aux_dims;
   /*! \brief the statement that generates the computation. */
   Stmt body;
 
@@ -806,6 +854,7 @@ class ExternOpNode : public OperationNode {
   Array<IterVar> root_iter_vars() const final;
   DataType output_dtype(size_t i) const final;
   Array<PrimExpr> output_shape(size_t i) const final;
+  Modes output_layout(size_t i) const final;
   Array<Tensor> InputTensors() const final;
   Operation ReplaceInputs(const Operation& self,
                           const std::unordered_map<Tensor, Tensor>& rmap) const final;
@@ -832,6 +881,9 @@ class ExternOpNode : public OperationNode {
     v->Visit("inputs", &inputs);
     v->Visit("input_placeholders", &input_placeholders);
     v->Visit("output_placeholders", &output_placeholders);
+    v->Visit("aux_placeholders", &aux_placeholders);
+    v->Visit("aux_buffer_indices", &aux_buffer_indices);
+    v->Visit("aux_dims", &aux_dims);
     v->Visit("body", &body);
   }
   TVM_DLL static Operation make(std::string name, std::string tag,
@@ -839,6 +891,16 @@ class ExternOpNode : public OperationNode {
                                 Array<Buffer> input_placeholders, Array<Buffer> output_placeholders,
                                 Stmt body);
 
+  TVM_DLL static Operation make(std::string name, std::string tag,
+                                Map<std::string, ObjectRef> attrs, Array<Tensor> inputs,
+                                Array<Buffer> input_placeholders, Array<Buffer> output_placeholders,
+                                Array<Buffer> aux_placeholders, Array<Integer> aux_buffer_indices,
+                                Array<Integer> aux_dims, Stmt body);
+
+  /*! \brief The storage layout of the idx-th input or output, counting
+   * inputs first, as seen by the A-function generation. */
+  Modes buffer_layout(size_t idx) const;
+
   static constexpr const char* _type_key = "ExternOp";
   TVM_DECLARE_FINAL_OBJECT_INFO(ExternOpNode, OperationNode);
 };
@@ -868,6 +930,7 @@ class HybridOpNode : public OperationNode {
   Array<IterVar> root_iter_vars() const final;
   DataType output_dtype(size_t i) const final;
   Array<PrimExpr> output_shape(size_t i) const final;
+  Modes output_layout(size_t i) const final;
   Array<Tensor> InputTensors() const final;
   Operation ReplaceInputs(const Operation& self,
                           const std::unordered_map<Tensor, Tensor>& rmap) const final;
@@ -33,6 +33,7 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace tvm {
 namespace te {
@@ -255,6 +256,37 @@ class Stage : public ObjectRef {
    * \return reference to self.
    */
   TVM_DLL Stage& peel(IterVar var);  // NOLINT(*)
+  /*!
+   * \brief Split a loop over a ragged dimension into tiles of factor
+   * iterations. The tiles that lie entirely within the ragged bound of
+   * each row are generated without predicates, and the partial last
+   * tile of the row separately, after them.
+   * \param parent The parent iteration domain.
+   * \param factor The constant tile size.
+   * \param p_outer The result outer domain, iterating over the tiles.
+   * \param p_inner The result inner domain, iterating within a tile.
+   * \return reference to self.
+   */
+  TVM_DLL Stage& ragged_tile(IterVar parent, PrimExpr factor, IterVar* p_outer,
+                             IterVar* p_inner);  // NOLINT(*)
+  /*!
+   * \brief Schedule a copy loop over a ragged row, such as that of a
+   * cache_read_opaque stage, as a vectorized, coalesced fetch. The row
+   * is ragged tiled into tiles of lanes consecutive elements per
+   * thread, the lanes are vectorized and moved innermost, and
+   * consecutive threads fetch consecutive vectors. Full tiles are
+   * fetched without predicates, and the partial last tile of the row is
+   * left scalar.
+   * \param parent The loop over the row.
+   * \param lanes The number of elements fetched together by a thread.
+   * \param thread The thread the fetch is distributed over, or an
+   *  undefined IterVar for a single thread.
+   * \param p_tile The result outer domain, iterating over the tiles.
+   * \param p_lane The result vectorized domain.
+   * \return reference to self.
+   */
+  TVM_DLL Stage& vectorized_fetch(IterVar parent, int lanes, IterVar thread, IterVar* p_tile,
+                                  IterVar* p_lane);  // NOLINT(*)
   /*!
    * \brief Split the iteration.
    * \param var The axis to be split.
@@ -299,10 +331,12 @@ class Stage : public ObjectRef {
   TVM_DLL Stage& storage_align(IterVar axis, int factor, int offset);     // NOLINT(*)
   TVM_DLL Stage& storage_align_dim(int dim_idx, int factor, int offset);  // NOLINT(*)
   /*!
-   * \brief Compute current stage with double buffering.
+   * \brief Compute current stage with double buffering, or with
+   *  num_stages buffers fetched that many iterations ahead.
+   * \param num_stages The number of buffers, at least 2.
    * \return reference to self.
    */
-  TVM_DLL Stage& double_buffer();  // NOLINT(*)
+  TVM_DLL Stage& double_buffer(int num_stages = 2);  // NOLINT(*)
   /*!
    * \brief Schedule for OpenGL fragment shader.
    * \return reference to self.
@@ -471,8 +505,12 @@ class Schedule : public ObjectRef {
    * \brief Note a hfusion group
    * \param ops the operations involved in the hfusion group
    * \param ivs the leaf vars of the corresponding operations
+   * \param weights the cost of one iteration of each of ivs. If
+   *  given, the fused iterations are interleaved according to these
+   *  costs instead of being concatenated.
    */
-  TVM_DLL void hfuse(const Array<Operation>& ops, const Array<IterVar>& ivs);
+  TVM_DLL void hfuse(const Array<Operation>& ops, const Array<IterVar>& ivs,
+                     const Array<PrimExpr>& weights = {});
 
   /*!
    * \brief Split a dimension of a tensor. This can be used to change
@@ -529,11 +567,14 @@ class Schedule : public ObjectRef {
    */
   Schedule normalize();
   /*!
-   * \brief Freeze tensor dimensions.
+   * \brief Freeze tensor dimensions. The storage layouts of the
+   * stages whose tensor dimensions were split, fused or reordered are
+   * changed, and the accesses to them rewritten. Other stages are
+   * left alone.
    *
-   * \return A normalized schedule, can be same as current one.
+   * \return The stages whose storage layouts were changed.
    */
-  void freeze_tensor_dimensions(const Map<IterVar, Range>& dom_map_);
+  Array<Stage> freeze_tensor_dimensions(const Map<IterVar, Range>& dom_map_);
   /*!
    * \brief access the internal node container
    * \return the pointer to the internal node container
@@ -577,6 +618,21 @@ class IterVarAttr : public ObjectRef {
   inline const IterVarAttrNode* operator->() const;
 };
 
+/*!
+ * \brief A memoized run of DimensionPassDownDomain over the dimension
+ *  relations of a stage.
+ */
+struct DimensionDomainMemo {
+  /*! \brief The op and the relations the domains were passed over. */
+  const Object* op;
+  const Object* relations;
+  size_t num_relations;
+  bool allow_missing;
+  /*! \brief The domains passed down, and the resulting ones. */
+  std::unordered_map<const DimensionNode*, Range> input;
+  std::unordered_map<const DimensionNode*, Range> output;
+};
+
 /*!
  * \brief represents a stage.
  *
@@ -645,6 +701,8 @@ class StageNode : public Object {
   bool is_opengl{false};
   /*! \brief Whether apply double buffer optimization to this stage */
   bool double_buffer{false};
+  /*! \brief The number of buffers of the double buffer optimization */
+  int double_buffer_stages{2};
   /*!
    * \brief The parent group of the current stage.
    *  The stage cannot be assigned to stages outside the group.
@@ -665,6 +723,10 @@ class StageNode : public Object {
   /*! \brief We create dimensions for leaf vars as well. This is a mapping between the leaf vars and
    * their dimensions */
   Map<IterVar, Dimension> leaf_var_dim_map;
+  /*! \brief Recent runs of DimensionPassDownDomain over the stage,
+   * which is called with the same domains for each consumer during
+   * lowering. Cleared by ScheduleNode::InvalidateCache. */
+  mutable std::vector<DimensionDomainMemo> dim_domain_memo;
 
   void VisitAttrs(AttrVisitor* v) {
     v->Visit("op", &op);
@@ -682,6 +744,7 @@ class StageNode : public Object {
     v->Visit("is_output", &is_output);
     v->Visit("is_opengl", &is_opengl);
     v->Visit("double_buffer", &double_buffer);
+    v->Visit("double_buffer_stages", &double_buffer_stages);
     v->Visit("group", &group);
     v->Visit("num_child_stages", &num_child_stages);
     v->Visit("leaf_var_dim_map", &leaf_var_dim_map);
@@ -712,6 +775,10 @@ class ScheduleNode : public Object {
    *  This is created on demand and can be invalidated.
    */
   std::unordered_map<const Object*, Stage> op2stage_cache_;
+  /*! \brief Whether op2stage_cache_ is to be refreshed by InitCache. */
+  bool cache_dirty_{true};
+  /*! \brief Whether stages is to be sorted in post order again. */
+  bool post_order_dirty_{false};
 
   /*! \brief map storing mapping from cached to original ops for
       equality purposes. */
@@ -728,9 +795,12 @@ class ScheduleNode : public Object {
     v->Visit("num_hfuse_groups", &num_hfuse_groups);
   }
 
-  /*! \brief Initialize temp cache. */
+  /*!
+   * \brief Initialize temp cache. Only the entries of the stages whose
+   *  op changed since the cache was last invalidated are updated.
+   */
   void InitCache();
-  /*! \brief Invalidate temp cache. */
+  /*! \brief Invalidate temp cache, which is refreshed by the next InitCache. */
   void InvalidateCache();
 
   /*!
@@ -754,7 +824,16 @@ class ScheduleNode : public Object {
    */
   TVM_DLL static Schedule make(Array<Operation> ops);
 
+  /*! \brief Sort the stages in post order of the read graph of the outputs. */
   TVM_DLL void remakePostOrder();
+  /*!
+   * \brief Mark the stages as to be sorted in post order again, which
+   *  is done once before the schedule is copied or lowered rather than
+   *  after each primitive that reorders the graph.
+   */
+  void InvalidatePostOrder() { post_order_dirty_ = true; }
+  /*! \brief Sort the stages in post order if they were marked so. */
+  TVM_DLL void EnsurePostOrder();
 
   static constexpr const char* _type_key = "Schedule";
   TVM_DECLARE_FINAL_OBJECT_INFO(ScheduleNode, Object);
@@ -793,6 +872,8 @@ class IterVarAttrNode : public Object {
   Array<PrimExpr> pragma_values;
   /*! \brief hfusion group id, if any */
   int hfuse_group_id = -1;
+  /*! \brief cost of one iteration in a weighted hfusion group, if any */
+  PrimExpr hfuse_weight;
   /*! \brief whether to unroll, if bound to a vthread/cthread */
   bool unroll_vthread = true;
 
@@ -807,6 +888,7 @@ class IterVarAttrNode : public Object {
     v->Visit("pragma_keys", &pragma_keys);
     v->Visit("pragma_values", &pragma_values);
     v->Visit("hfuse_group_id", &hfuse_group_id);
+    v->Visit("hfuse_weight", &hfuse_weight);
     v->Visit("unroll_vthread", &unroll_vthread);
   }
 
@@ -41,6 +41,22 @@ namespace te {
  */
 InferBoundsResult InferBound(const Schedule& sch);
 
+/*!
+ * \brief Find where inferred bounds over-approximate ragged extents.
+ *
+ *  A root iter var of a stage with a ragged, non-constant extent is
+ *  reported when its inferred extent cannot be proven to be at most
+ *  the ragged one. The inferred extent is that of the loops over the
+ *  iter var and of the allocation of the stage.
+ *
+ * \param sch The schedule the bounds were inferred for.
+ * \param bounds The result of InferBound.
+ * \return For each such iter var, its op, the iter var, its declared
+ *  range, its inferred range and the condition that failed to be proven.
+ */
+Array<Array<ObjectRef>> DiagnoseRaggedBounds(const Schedule& sch,
+                                             const InferBoundsResult& bounds);
+
 /*!
  * \brief Schedule s' dependent operations.
  *
@@ -53,11 +69,20 @@ InferBoundsResult InferBound(const Schedule& sch);
  * \param distinct_device Is the target other then the host CPU.
  * \param debug_fill_function_bodies Whether to fill in bodies of prep
  * code functions. Used for debugging.
+ * \param afuns_needed_for Buffers whose A-functions should be generated.
+ * \param prep_code_on_device Whether to generate the prep code as
+ * device kernels when the target is a distinct device.
+ * \param fused_maps_on_the_fly Whether the fused to outer and fused
+ * to inner maps of fused loops are computed where they are used
+ * instead of being stored in auxiliary arrays.
+ * \param num_threads The number of threads the bodies of the producers
+ * of stages are built on, ahead of their composition.
 \return the result Stmt
  */
 Stmt ScheduleOps(Schedule s, InferBoundsResult bounds, bool debug_keep_trivial_loop,
                  bool distinct_device, bool debug_fill_function_bodies,
-                 Array<Buffer> afuns_needed_for);
+                 Array<Buffer> afuns_needed_for, bool prep_code_on_device = false,
+                 bool fused_maps_on_the_fly = false, int num_threads = 1);
 
 /*!
  * \brief To automatically inline the element-wise operations.
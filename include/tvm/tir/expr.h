@@ -1306,6 +1306,14 @@ constexpr const char* tvm_storage_sync = "tvm_storage_sync";
 constexpr const char* tvm_warp_shuffle = "tvm_warp_shuffle";
 constexpr const char* tvm_warp_shuffle_down = "tvm_warp_shuffle_down";
 constexpr const char* tvm_warp_activemask = "tvm_warp_activemask";
+/*!
+ * \brief See pseudo code
+ *
+ *  uint32 tvm_warp_ballot(uint32 mask, bool pred) {
+ *     return (bit mask of the lanes in mask for which pred holds);
+ *  }
+ */
+constexpr const char* tvm_warp_ballot = "tvm_warp_ballot";
 
 /*!
  * \brief Initialize the global barrier.
@@ -1376,6 +1384,57 @@ constexpr const char* tvm_store_matrix_sync = "tvm_store_matrix_sync";
 // Prep code copy intrinsics
 constexpr const char* tvm_memcopy_to_device = "tvm_memcopy_to_device";
 
+/*!
+ * \brief The outer iteration a fused iteration of a ragged fused loop
+ *  belongs to, found by a binary search of num_steps steps over the
+ *  start positions of the outer iterations. Lowered to a loop by
+ *  LowerFusedMapSearch.
+ *
+ *  int32 tvm_fused_map_search(Var pos_data, Expr pos_offset,
+ *                             Expr pos_dtype_zero, Expr fused,
+ *                             Expr outer_extent, int num_steps) {
+ *     int lo = 0;
+ *     for (int step = 1 << (num_steps - 1); step > 0; step >>= 1) {
+ *       int candidate = lo + step;
+ *       if (candidate < outer_extent &&
+ *           pos_data[pos_offset + candidate] <= fused) lo = candidate;
+ *     }
+ *     return lo;
+ *  }
+ */
+constexpr const char* tvm_fused_map_search = "tvm_fused_map_search";
+/*!
+ * \brief Asynchronous copy of bytes bytes (4, 8 or 16) from global to
+ *  shared memory, as cp.async on CUDA devices of compute capability
+ *  8.0 and later. The copy is complete once a tvm_cp_async_wait_group
+ *  no longer allows the group it was committed in to be pending.
+ *
+ *  void tvm_cp_async(Expr dst_access_ptr, Expr src_access_ptr, int bytes);
+ */
+constexpr const char* tvm_cp_async = "tvm_cp_async";
+/*!
+ * \brief Commits the asynchronous copies issued by the thread since
+ *  the last commit as a group.
+ *
+ *  void tvm_cp_async_commit_group();
+ */
+constexpr const char* tvm_cp_async_commit_group = "tvm_cp_async_commit_group";
+/*!
+ * \brief Waits until at most num_pending of the groups committed by
+ *  the thread are incomplete.
+ *
+ *  void tvm_cp_async_wait_group(int num_pending);
+ */
+constexpr const char* tvm_cp_async_wait_group = "tvm_cp_async_wait_group";
+/*!
+ * \brief The value of the cycle counter of the processor the calling
+ *  thread runs on, clock64() on CUDA devices and the time stamp
+ *  counter on CPUs.
+ *
+ *  int64 tvm_cycle_counter();
+ */
+constexpr const char* tvm_cycle_counter = "tvm_cycle_counter";
+
 /*! \brief The kind of structure field info used in intrinsic */
 enum TVMStructFieldKind : int {
   // array head address
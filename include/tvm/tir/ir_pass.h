@@ -27,6 +27,7 @@
 #ifndef TVM_TIR_IR_PASS_H_
 #define TVM_TIR_IR_PASS_H_
 
+#include <tvm/runtime/ndarray.h>
 #include <tvm/te/schedule.h>
 #include <tvm/tir/buffer.h>
 #include <tvm/tir/expr.h>
@@ -235,6 +236,14 @@ Stmt RewriteForTensorCore(Stmt stmt, te::Schedule schedule, Map<te::Tensor, Buff
  */
 bool VerifyCompactBuffer(Stmt stmt);
 
+/*!
+ * \brief Collect the tensors that have a region bound to a buffer.
+ *
+ * \param stmt The stmt to be searched.
+ * \return The tensors of all buffer_bind_scope attributes in stmt.
+ */
+Array<te::Tensor> CompactBufferBoundTensors(Stmt stmt);
+
 /*!
  * \brief Remove No Op from the Stmt.
  * \param stmt The stmt to be trasnformed
@@ -257,6 +266,18 @@ Stmt RemoveNoOp(Stmt stmt);
 Stmt UnrollLoop(Stmt stmt, int auto_max_step, int auto_max_depth, int auto_max_extent,
                 bool explicit_unroll);
 
+/*!
+ * \brief Unroll the innermost serial loops whose extent is not constant,
+ *  such as ragged loops, but has a constant upper bound of at most
+ *  max_extent. Each copy of the body is guarded by whether its
+ *  iteration is within the extent.
+ *
+ * \param stmt The statment to be unrolled.
+ * \param max_extent The maximum upper bound of the extents of the loops to unroll.
+ * \return Transformed stmt.
+ */
+Stmt UnrollRaggedLoop(Stmt stmt, int max_extent);
+
 /*!
  * \brief peel the loop marked by unroll.
  *
@@ -267,7 +288,9 @@ Stmt UnrollLoop(Stmt stmt, int auto_max_step, int auto_max_depth, int auto_max_e
 LoweredFunc PeelLoop(LoweredFunc stmt);
 
 /*!
- * \brief Add env loops for CPU (c and llvm, for now) targets.
+ * \brief Add env loops for CPU (c and llvm, for now) targets. The
+ *  outermost block loop is parallel, and the thread loops are split at
+ *  the shared memory barriers and vectorized when their extent allows.
  *
  * \param stmt The statment to be transformed.
  * \return Transformed stmt.
@@ -314,9 +337,11 @@ Stmt InjectPrefetch(Stmt stmt);
  * \brief Inject double buffer into stmt.
  * \param stmt The statement to be transformed.
  * \param split_loop Loop splitting factor.
+ * \param async_copy Whether fetches from global to shared memory are
+ *  made with asynchronous copies.
  * \return Transformed stmt.
  */
-Stmt InjectDoubleBuffer(Stmt stmt, int split_loop);
+Stmt InjectDoubleBuffer(Stmt stmt, int split_loop, bool async_copy = false);
 
 /*!
  * \brief Inject copy intrinsics with optional pad.
@@ -354,6 +379,19 @@ Stmt StorageRewrite(Stmt stmt);
 Stmt LoopPartition(Stmt stmt, bool split_const_loop);
 Stmt RemoveLikelyTags(Stmt stmt);
 
+/*!
+ * \brief Partition serial loops on the loop invariant, typically
+ *  ragged, bounds of the conditions in their bodies, such as i <
+ *  l_fun(o), so that the loop in which the condition holds is free of
+ *  the branch.
+ * \param f The function to transform.
+ * \param constraints Constraints on the uninterpreted functions and
+ *  auxiliary arrays the bounds are made of.
+ * \return Transformed function.
+ */
+LoweredFunc RaggedLoopPartition(LoweredFunc f, Array<PrimExpr> constraints);
+Stmt RaggedLoopPartitionStmt(Stmt stmt, Array<PrimExpr> constraints);
+
 /*!
  * \brief Detect and insert sync points to co-processor.
  *
@@ -406,10 +444,18 @@ Stmt HoistIfThenElse(Stmt stmt);
 /*!
  * \brief More aggresive loop invariant code motion which locates and hoists if statements.
  * \param stmt The stmt to do if statement hoisting.
+ * \param branch_profile Optional observed probabilities that the
+ *  conditions of the IfThenElse nodes of the input, numbered in
+ *  pre-order, are true. They decide which side of the profiled
+ *  branches is laid out as the fall-through, mark the others as
+ *  cold, and keep loops from being duplicated for branches of which
+ *  only one side is taken.
  * \return Transformed stmt.
  */
-LoweredFunc BetterHoistIfThenElse(LoweredFunc f, std::string target, Array<PrimExpr> constraints);
-Stmt BetterHoistIfThenElseStmt(Stmt f, std::string target, Array<PrimExpr> constraints);
+LoweredFunc BetterHoistIfThenElse(LoweredFunc f, std::string target, Array<PrimExpr> constraints,
+                                  Map<Integer, FloatImm> branch_profile = {});
+Stmt BetterHoistIfThenElseStmt(Stmt f, std::string target, Array<PrimExpr> constraints,
+                               Map<Integer, FloatImm> branch_profile = {});
 
 /*!
  * \brief Hoist loop invariant buffer loads.
@@ -427,6 +473,151 @@ LoweredFunc HoistLoads(LoweredFunc f);
 LoweredFunc RemoveRedundantIfsFromFunc(LoweredFunc f, std::string target,
                                        Array<PrimExpr> constraints);
 
+/*!
+ * \brief Carve the runtime sized global allocations of ragged
+ *  intermediate tensors out of a single arena allocated after the
+ *  prep code, instead of allocating each of them separately.
+ * \param stmt The stmt to transform.
+ * \return Transformed stmt.
+ */
+Stmt PlanRaggedArena(Stmt stmt);
+
+/*!
+ * \brief Estimate the peak bytes of the global allocations of a
+ *  statement, such as the ragged intermediate tensors and workspaces
+ *  of a lowered function, as an expression of its inputs.
+ * \param stmt The stmt to analyze.
+ * \return The peak number of bytes, as an int64 expression.
+ */
+PrimExpr EstimateMemoryFootprint(Stmt stmt);
+
+/*!
+ * \brief Evaluate an expression for the given values of the variables
+ *  and the integer host arrays, such as the lengths, that it reads.
+ *  Sums over ranges that become known are evaluated.
+ * \param expr The expression.
+ * \param scalars The values of the variables, by name.
+ * \param arrays The arrays, by the name of their buffer or tensor.
+ * \return The simplified expression.
+ */
+PrimExpr BindFootprintInputs(PrimExpr expr, Map<std::string, PrimExpr> scalars,
+                             Map<std::string, runtime::NDArray> arrays);
+
+/*!
+ * \brief Count the floating point operations and the bytes of global
+ *  memory accesses of a statement, outside of its prep code, as
+ *  expressions of its inputs such as the lengths.
+ * \param stmt The stmt to analyze.
+ * \param aux_vars The data variables of the auxiliary arrays, whose
+ *  accesses are counted separately.
+ * \return The flops, the bytes of the other accesses and the bytes of
+ *  the auxiliary array accesses, as int64 expressions.
+ */
+Array<PrimExpr> CountWork(Stmt stmt, Array<Var> aux_vars);
+
+/*!
+ * \brief Shorten serial loops in device code whose body is guarded by
+ *  a loop invariant upper bound on the loop variable, such as the
+ *  per-sequence length check of a ragged scan, so that they exit at
+ *  that bound.
+ * \param stmt The stmt to transform.
+ * \return Transformed stmt.
+ */
+Stmt RaggedScanEarlyExit(Stmt stmt);
+
+/*!
+ * \brief RaggedScanEarlyExit on the body of a function. It runs after
+ *  ThreadSync, so that loops whose bodies have barriers that only
+ *  some threads would reach are left alone.
+ * \param f The mixed function, before SplitHostDevice.
+ * \return Transformed function.
+ */
+LoweredFunc RaggedScanEarlyExitFunc(LoweredFunc f);
+
+/*!
+ * \brief Rewrite kernels whose grid is sized by a runtime extent, such
+ *  as fused ragged loops bound to blockIdx.x, to a persistent grid
+ *  whose blocks take chunks of the iteration space from a global
+ *  atomic counter.
+ * \param stmt The stmt to transform.
+ * \param num_blocks The number of blocks of the persistent grid.
+ * \param chunk_size The number of iterations a block takes at a time.
+ * \return Transformed stmt.
+ */
+Stmt PersistentRaggedBlocks(Stmt stmt, int num_blocks, int chunk_size);
+
+/*!
+ * \brief PersistentRaggedBlocks on the body of a function. It runs
+ *  after ThreadSync, so that kernels with grid-wide barriers, or with
+ *  barriers that only some threads of a block reach, are left alone.
+ * \param f The mixed function, before SplitHostDevice.
+ * \param num_blocks The number of blocks of the persistent grid.
+ * \param chunk_size The number of iterations a block takes at a time.
+ * \return Transformed function.
+ */
+LoweredFunc PersistentRaggedBlocksFunc(LoweredFunc f, int num_blocks, int chunk_size);
+
+/*!
+ * \brief Make the blocks of the kernels of a function record the
+ *  cycle counter at their entry and exit, in device buffers of two
+ *  int64 per block that the host gets from the runtime before each
+ *  launch, keyed by the function name and the index of the kernel.
+ * \param f The mixed function, before SplitHostDevice.
+ * \param device_type The device type of the kernels.
+ * \return Transformed function.
+ */
+LoweredFunc InstrumentBlockCycles(LoweredFunc f, int device_type);
+
+/*!
+ * \brief Inject software prefetches for the gathers through aux
+ *  arrays, such as A[a_fun[o + 1] * H + j], that serial loops perform.
+ *  The aux entries are prefetched 2 * distance iterations ahead and
+ *  the data they point to distance iterations ahead.
+ * \param stmt The stmt to transform.
+ * \param distance The prefetch distance, in iterations.
+ * \return Transformed stmt.
+ */
+Stmt InjectIndirectPrefetch(Stmt stmt, int distance);
+
+/*!
+ * \brief Hash-cons the expressions of a stmt, so that structurally
+ *  equal subexpressions, such as those produced by repeated position
+ *  computations and UninterpFun inlining, share a single node. This
+ *  reduces memory and lets deep comparisons stop at shared nodes.
+ * \param stmt The stmt to transform.
+ * \return Transformed stmt.
+ */
+Stmt InternExprs(Stmt stmt);
+
+/*!
+ * \brief Bind the subexpressions that occur more than once in the
+ *  indices of loads and stores, such as the ragged position
+ *  computations, to variables at the start of the outermost scope in
+ *  which they can be evaluated.
+ * \param stmt The stmt to transform.
+ * \return Transformed stmt.
+ */
+Stmt EliminateCommonSubexpr(Stmt stmt);
+
+/*!
+ * \brief Separate the loops tiled by Stage::ragged_tile into a loop
+ *  over the full tiles, from which the predicates on the ragged bound
+ *  are removed, and the partial last tile.
+ * \param stmt The stmt to transform.
+ * \return Transformed stmt.
+ */
+Stmt RaggedTileLoops(Stmt stmt);
+
+/*!
+ * \brief Lower the tvm_fused_map_search calls that compute the maps of
+ *  ragged fused loops on the fly into binary search loops, placed
+ *  before the outermost statement within which their arguments are
+ *  defined.
+ * \param stmt The stmt to transform.
+ * \return Transformed stmt.
+ */
+Stmt LowerFusedMapSearch(Stmt stmt);
+
 /*!
  * \brief Remove redundant if conditions
  * \param stmt The stmt to optimize.
@@ -435,11 +626,14 @@ LoweredFunc RemoveRedundantIfsFromFunc(LoweredFunc f, std::string target,
 Stmt RemoveRedundantIfs(Stmt stmt, Array<PrimExpr> constraints);
 
 /*!
- * \brief Expand intrisic if then else expressions.
+ * \brief Expand intrisic if then else expressions. Those whose branches
+ *  are cheap and safe to evaluate unconditionally are lowered to
+ *  selects instead, which is worth more work in the branches on GPUs.
  * \param stmt The stmt.
+ * \param for_gpu Whether stmt is lowered for a GPU target.
  * \return Transformed stmt.
  */
-Stmt ExpandIntrinsicITE(Stmt stmt);
+Stmt ExpandIntrinsicITE(Stmt stmt, bool for_gpu);
 
 class MakeAPIResult;
 
@@ -448,14 +642,22 @@ class MakeAPIResultNode : public runtime::Object {
   LoweredFunc function;
   Array<Buffer> host_intermediate_buffers;
   Array<Buffer> device_intermediate_buffers;
+  /*! \brief Views of the individual auxiliary arrays (A-functions
+   *  and fusion maps) into the device aggregate buffer. Their
+   *  elem_offset, shape and dtype describe where the prep code writes
+   *  each array, so that prep code results can be shared among
+   *  functions with matching layouts. */
+  Array<Buffer> aux_buffer_layout;
 
   TVM_DLL static MakeAPIResult make(LoweredFunc function, Array<Buffer> host_intermediate_buffers,
-                                    Array<Buffer> device_intermediate_buffers);
+                                    Array<Buffer> device_intermediate_buffers,
+                                    Array<Buffer> aux_buffer_layout = {});
 
   void VisitAttrs(AttrVisitor* v) {
     v->Visit("function", &function);
     v->Visit("host_intermediate_buffers", &host_intermediate_buffers);
     v->Visit("device_intermediate_buffers", &device_intermediate_buffers);
+    v->Visit("aux_buffer_layout", &aux_buffer_layout);
   }
 
   static constexpr const char* _type_key = "tir.MakeAPIResult";
@@ -520,10 +722,25 @@ enum class PrepCodeMode {
   kWithPrepCode = 1,
   kNoPrepCode = 2,
   kOnlyPrepCode = 3,
+  /*! \brief Like kWithPrepCode, but skip the prep code when the
+   *  runtime prep code cache reports the auxiliary buffers to be up
+   *  to date for the lengths passed in. */
+  kWithCachedPrepCode = 4,
+  /*! \brief Only the main body, but with the same arguments as
+   *  kWithPrepCode and kOnlyPrepCode. The auxiliary buffers are
+   *  expected to have been filled in by a separately built
+   *  kOnlyPrepCode function with a matching aux_buffer_layout. */
+  kExternalPrepCode = 5,
+  /*! \brief Like kWithPrepCode, for prep code generated as device
+   *  kernels. The length buffers are passed in on the device and the
+   *  prep code and the main kernels are launched back to back with
+   *  no copies or other host work in between, so that the call is
+   *  asynchronous with respect to the host. */
+  kFusedPrepCode = 6,
 };
 MakeAPIResult MakeAPI(Stmt body, std::string name, Array<ObjectRef> length_api_args,
                       Array<ObjectRef> tensor_api_args, int num_unpacked_args, bool is_restricted,
-                      PrepCodeMode prep_code_mode);
+                      PrepCodeMode prep_code_mode, bool instrument_prep_code = false);
 
 /*!
  * \brief Bind the device type of host function to be device_type.
@@ -532,6 +749,16 @@ MakeAPIResult MakeAPI(Stmt body, std::string name, Array<ObjectRef> length_api_a
  * \return The binded function.
  */
 LoweredFunc BindDeviceType(LoweredFunc func, int device_type);
+/*!
+ * \brief Make the fast call entry of a host function made by MakeAPI: a
+ *  plain function named func->name + "_fastcall" that takes the api_args
+ *  of the function directly, in order, as DLTensor* for buffers and as
+ *  values for vars, and returns 0 on success. It skips the unpacking and
+ *  the type code checks of the TVMValue arguments of the packed function.
+ * \param func The host function, after SplitHostDevice.
+ * \return The fast call entry, to be built along with func.
+ */
+LoweredFunc MakeFastCall(LoweredFunc func);
 /*!
  * \brief Find undefined vars in the statment.
  * \param stmt The function to be checked.
@@ -8,6 +8,8 @@
 #include <tvm/tir/expr.h>
 #include <tvm/tir/uninterp_fun.h>
 
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 namespace tvm {
@@ -41,10 +43,27 @@ class ModesNode : public runtime::Object {
   Array<UninterpFun> a_funs;
   /*! \brief Whether this modes object represents a loop nest */
   bool loop_layout;
-  /*! \brief Map from a dimension to all dimensions that depend on it transitively wrt l_funs */
-  mutable Map<Dimension, Array<Dimension>> transitive_dependent_dims;
-  /*! \brief Map from a dimension to all dimensions that immediately depend on it wrt l_funs */
-  mutable Map<Dimension, Array<Dimension>> immediate_dependent_dims;
+  /*! \brief For tiled ragged storage layouts, the tile multiple each
+   * dimension's width is padded up to. Empty for untiled layouts. The
+   * l_funs and l_maxes above are already padded. */
+  Array<Integer> tile_factors;
+  /*! \brief For paged storage layouts, the dimension whose rows are
+   * stored in fixed size pages from a pool, and -1 otherwise. */
+  int paged_dim{-1};
+  /*! \brief The number of rows of paged_dim in a page. */
+  int page_size{0};
+  /*! \brief The page table of a paged layout. It maps the coordinates
+   * of the dimensions outer to paged_dim, and the index of a page of a
+   * row of paged_dim, to the page of the pool the page is stored in. */
+  UninterpFun page_table;
+  /*! \brief The number of pages in the pool of a paged layout. */
+  PrimExpr num_pages;
+  /*! \brief Map from a dimension to all dimensions that depend on it transitively wrt
+   * l_funs. Computed once when the object is constructed. */
+  Map<Dimension, Array<Dimension>> transitive_dependent_dims;
+  /*! \brief Map from a dimension to all dimensions that immediately depend on it wrt
+   * l_funs. Computed once when the object is constructed. */
+  Map<Dimension, Array<Dimension>> immediate_dependent_dims;
 
   void VisitAttrs(AttrVisitor* v) {
     v->Visit("dimensions", &dimensions);
@@ -54,6 +73,11 @@ class ModesNode : public runtime::Object {
     v->Visit("transitive_dependent_dims", &transitive_dependent_dims);
     v->Visit("immediate_dependent_dims", &immediate_dependent_dims);
     v->Visit("loop_layout", &loop_layout);
+    v->Visit("tile_factors", &tile_factors);
+    v->Visit("paged_dim", &paged_dim);
+    v->Visit("page_size", &page_size);
+    v->Visit("page_table", &page_table);
+    v->Visit("num_pages", &num_pages);
   }
 
   TVM_DLL static Modes make(Array<tvm::te::Dimension> dimensions, Array<PrimExpr> l_maxes,
@@ -76,6 +100,24 @@ class ModesNode : public runtime::Object {
                                            Array<PrimExpr> l_maxes, Array<UninterpFun> l_funs,
                                            Map<Dimension, UninterpFun> user_a_funs);
 
+  /*! \brief Storage layout where the width of dimension i is padded
+   * up to a multiple of tile_factors[i], so that every ragged row
+   * starts at a tile aligned offset. A factor of 1 leaves the
+   * dimension unpadded. */
+  TVM_DLL static Modes make_tiled_storage_layout(Array<tvm::te::Dimension> dimensions,
+                                                 Array<PrimExpr> l_maxes, Array<UninterpFun> l_funs,
+                                                 Map<Dimension, UninterpFun> user_a_funs,
+                                                 Array<Integer> tile_factors);
+
+  /*! \brief Storage layout where the rows of dimension paged_dim are
+   * stored in pages of page_size rows, looked up in page_table, so
+   * that a row can grow a page at a time without moving the others.
+   * The dimensions inner to paged_dim must be dense. */
+  TVM_DLL static Modes make_paged_storage_layout(Array<tvm::te::Dimension> dimensions,
+                                                 Array<PrimExpr> l_maxes, Array<UninterpFun> l_funs,
+                                                 int paged_dim, int page_size,
+                                                 UninterpFun page_table, PrimExpr num_pages);
+
   TVM_DLL static Modes make(std::string name, Array<PrimExpr> dense_shape, bool is_loop_layout);
 
   /*! \brief Get dense overapproximated shape. */
@@ -88,6 +130,14 @@ class ModesNode : public runtime::Object {
 
   const bool is_ragged(int i) const;
 
+  const bool is_tiled() const { return tile_factors.size() > 0; }
+
+  const bool is_paged() const { return paged_dim >= 0; }
+
+  const int tile_factor(int i) const {
+    return is_tiled() ? static_cast<int>(tile_factors[i]->value) : 1;
+  }
+
   const std::string str() const;
 
   const bool has_dependent_dims(int idx) const;
@@ -109,7 +159,36 @@ class ModesNode : public runtime::Object {
   TVM_DECLARE_FINAL_OBJECT_INFO(ModesNode, Object);
 
  private:
-  const void setup_transitive_dependences() const;
+  void setup_transitive_dependences();
+
+  /*! \brief Key for memoized position expressions. all_dims is set
+   * for positions computed without explicit relevant dimensions. */
+  struct PositionKey {
+    Array<PrimExpr> coords;
+    Array<Dimension> relevant_dims;
+    bool all_dims;
+  };
+
+  class PositionKeyHasher {
+   public:
+    size_t operator()(const PositionKey& key) const;
+  };
+
+  class PositionKeyEquality {
+   public:
+    bool operator()(const PositionKey& k1, const PositionKey& k2) const;
+  };
+
+  /*! \brief Index based copies of the dependence maps above, for
+   * cheap lookups from the position computations. */
+  std::vector<Array<Dimension>> transitive_deps_by_idx;
+  std::vector<Array<Dimension>> immediate_deps_by_idx;
+  /*! \brief Memo of (not yet inlined) position expressions. */
+  mutable std::unordered_map<PositionKey, PrimExpr, PositionKeyHasher, PositionKeyEquality>
+      position_cache;
+  /*! \brief Guards position_cache, as the loop nests of stages
+   * sharing a layout may be built concurrently. */
+  mutable std::mutex position_cache_mutex;
 };
 
 /*!
@@ -704,6 +704,25 @@ constexpr const char* aux_data_structure = "aux_data_structure";
 /*! \brief Mark a hfuse group */
 constexpr const char* hfuse_group = "hfuse_group";
 
+/*!
+ * \brief Mark the cost of one block of a body in a weighted hfuse
+ *  group. stmt.node is the hfused IterVar, stmt.value the cost.
+ */
+constexpr const char* hfuse_weight = "hfuse_weight";
+
+/*!
+ * \brief Mark the minimum number of blocks of a kernel that should be
+ *  resident on a multiprocessor, from the launch_min_blocks pragma
+ *  of a thread axis. stmt.node is the thread IterVar.
+ */
+constexpr const char* launch_min_blocks = "launch_min_blocks";
+
+/*!
+ * \brief Mark the observed probability that the condition of the
+ *  IfThenElse in the body is true. stmt.value is a FloatImm.
+ */
+constexpr const char* branch_probability = "branch_probability";
+
 /*!
  * \brief Mark alignment of buffer dimension
  *  stmt.node is Tensor
@@ -764,6 +783,13 @@ constexpr const char* fragment_layout = "fragment_layout";
  */
 constexpr const char* prep_code_scope = "prep_code_scope";
 
+/*!
+ * \brief Mark the layout of the auxiliary arrays in the aggregate
+ *  buffers of the prep code. stmt.node is an Array<Buffer> of the
+ *  device side views into the device aggregate buffer.
+ */
+constexpr const char* aux_buffer_layout = "aux_buffer_layout";
+
 /*!
  * \brief Check if attr_key is a pragma key extension
  * \param attr_key The attr key to be compared
@@ -110,6 +110,9 @@ class UninterpFunNode : public FunctionBaseNode {
   Range range;
   /*! \brief The kind of uinterpreted function */
   UninterpFunType type;
+  /*! \brief For kAFun functions, which are prefix sums, the summand
+   * in terms of the parameter, if known: f(x + 1) - f(x) = summand(x). */
+  PrimExpr summand;
   /*! \brief Used for FO and FI funs to maintain pointers to fields of
       the RaggedFusedSplitNode */
   RaggedFusionInfo fusion_info;
@@ -121,6 +124,7 @@ class UninterpFunNode : public FunctionBaseNode {
     v->Visit("body", &body);
     v->Visit("range", &range);
     v->Visit("type", &type);
+    v->Visit("summand", &summand);
     v->Visit("fusion_info", &fusion_info);
   }
 
@@ -144,6 +148,8 @@ class UninterpFunNode : public FunctionBaseNode {
 
   void SetRange(Range r);
 
+  void SetSummand(PrimExpr expr);
+
   /*! \brief Get the arity. */
   size_t arity() const;
 
@@ -29,7 +29,7 @@ from ._ffi.registry import register_object, register_func, register_extension
 # top-level alias
 # tvm.runtime
 from .runtime.object import Object
-from .runtime.ndarray import context, cpu, gpu, opencl, cl, vulkan, metal, mtl
+from .runtime.ndarray import context, cpu, gpu, cpu_pinned, opencl, cl, vulkan, metal, mtl
 from .runtime.ndarray import vpi, rocm, opengl, ext_dev, micro_dev
 from .runtime import ndarray as nd
 
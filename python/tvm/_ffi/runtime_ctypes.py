@@ -135,6 +135,7 @@ class TVMContext(ctypes.Structure):
     MASK2STR = {
         1 : 'cpu',
         2 : 'gpu',
+        3 : 'cpu_pinned',
         4 : 'opencl',
         5 : 'aocl',
         6 : 'sdaccel',
@@ -154,6 +155,7 @@ class TVMContext(ctypes.Structure):
         'gpu': 2,
         'cuda': 2,
         'nvptx': 2,
+        'cpu_pinned': 3,
         'cl': 4,
         'opencl': 4,
         'aocl' : 5,
@@ -87,6 +87,8 @@ class Analyzer:
         self._rewrite_simplify = _mod("rewrite_simplify")
         self._canonical_simplify = _mod("canonical_simplify")
         self._int_set = _mod("int_set")
+        self._can_prove = _mod("can_prove")
+        self._proof_stats = _mod("proof_stats")
         self._enter_constraint_context = _mod("enter_constraint_context")
 
     def const_int_bound(self, expr):
@@ -164,6 +166,35 @@ class Analyzer:
         """
         return self._canonical_simplify(expr)
 
+    def can_prove(self, cond):
+        """Try to prove a condition, with rewrite simplification,
+        constant integer bounds and canonical simplification first,
+        and z3 as a last resort.
+
+        Parameters
+        ----------
+        cond : PrimExpr
+            The condition.
+
+        Returns
+        -------
+        result : bool
+            Whether the condition could be proven.
+        """
+        return bool(self._can_prove(cond))
+
+    def proof_stats(self):
+        """The number of proofs can_prove settled at each tier.
+
+        Returns
+        -------
+        result : Dict[str, int]
+            The counts for "rewrite_simplify", "const_int_bound",
+            "canonical_simplify" and "z3", and of the "unproven"
+            conditions.
+        """
+        return {k: v.value for k, v in self._proof_stats().items()}
+
     def int_set(self, expr, dom_map):
         """Compute a symbolic IntSet that covers expr for all values in dom_map.
 
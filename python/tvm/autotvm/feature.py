@@ -38,11 +38,12 @@ def ana_lower(sch, args,
     """Do lower while keeping all axes in IR
     i.e. Do not eliminate loop with extent of 1, do not vectorize, unroll or inject virtual threads
     """
-    binds, _ = build_module.get_binds(args, binds)
     sch = sch.normalize()
     # Phase 0
     bounds = schedule.InferBound(sch)
-    stmt = schedule.ScheduleOps(sch, bounds, True)
+    stmt = schedule.ScheduleOps(sch, bounds, True, False, True, [])
+    compact = ir_pass.VerifyCompactBuffer(stmt)
+    binds, _ = build_module.get_binds(sch, args, compact, binds)
     stmt = ir_pass.StorageFlatten(stmt, binds, 64)
     stmt = ir_pass.CanonicalSimplify(stmt)
     assert simple_mode
@@ -59,7 +60,14 @@ except ValueError as e:
     _get_buffer_curve_sample_flatten = _get_itervar_feature = _get_itervar_feature_flatten = \
         raise_error
 
-def get_itervar_feature(sch, args, take_log=False):
+def _length_args(length_distribution):
+    """The length distribution as arguments of the c++ API"""
+    if length_distribution is None:
+        return []
+    lengths, weights = length_distribution.element_lengths()
+    return [[int(x) for x in lengths], [float(w) for w in weights]]
+
+def get_itervar_feature(sch, args, take_log=False, length_distribution=None):
     """get features of iter vars
 
     Parameters
@@ -69,13 +77,16 @@ def get_itervar_feature(sch, args, take_log=False):
         the buffer args for lower
     take_log: bool
         whether take log of numerical statics
+    length_distribution: LengthDistribution, optional
+        the distribution ragged loop extents are evaluated against.
+        Without one, they are bounded by the range of their length functions
 
     Returns
     -------
     features of every axis in the IR, see doc/features.md for detail
     """
     stmt = ana_lower(sch, args, simple_mode=True)
-    feas = _get_itervar_feature(stmt, take_log)
+    feas = _get_itervar_feature(stmt, take_log, *_length_args(length_distribution))
 
     # convert tvm node to python type
     ret = []
@@ -106,7 +117,7 @@ def flatten_itervar_feature(fea):
             flatten.append(pair[1:])
     return np.concatenate(flatten)
 
-def get_itervar_feature_flatten(sch, args, take_log=True):
+def get_itervar_feature_flatten(sch, args, take_log=True, length_distribution=None):
     """get flatten features of iter vars
     this is equivalent to get_itervar_feature + flatten_itervar_feature, but much faster.
 
@@ -117,6 +128,8 @@ def get_itervar_feature_flatten(sch, args, take_log=True):
         the buffer args for lower
     take_log: bool
         whether take log of numerical statics
+    length_distribution: LengthDistribution, optional
+        the distribution ragged loop extents are evaluated against
 
     Returns
     -------
@@ -124,7 +137,7 @@ def get_itervar_feature_flatten(sch, args, take_log=True):
         one-dimensional vector
     """
     stmt = ana_lower(sch, args, simple_mode=True)
-    feas = _get_itervar_feature_flatten(stmt, take_log)
+    feas = _get_itervar_feature_flatten(stmt, take_log, *_length_args(length_distribution))
     feas = struct.unpack('%df' % (len(feas)//4), feas)
     return feas
 
@@ -145,6 +158,7 @@ def get_flatten_name(fea):
         "_attr_": ["length", "nest_level", "topdown", "bottomup"] +
                   ["ann_%d" % i for i in range(20)],
         "_arith_": ["add", "mul", "div"],
+        "_ragged_": ["p50", "p99", "bound", "aux"],
         "buf_touch": ["stride", "mod", "count", "reuse", "T_count", "T_reuse"],
     }
 
@@ -176,7 +190,7 @@ def get_flatten_name(fea):
     return names
 
 
-def get_buffer_curve_sample_flatten(sch, args, sample_n=30):
+def get_buffer_curve_sample_flatten(sch, args, sample_n=30, length_distribution=None):
     """
     Get flatten curve sample feature (relation feature)
 
@@ -187,6 +201,8 @@ def get_buffer_curve_sample_flatten(sch, args, sample_n=30):
         the buffer args for lower
     sample_n: int
         number of sample points along one dimension
+    length_distribution: LengthDistribution, optional
+        the distribution ragged loop extents are evaluated against
 
     Returns
     -------
@@ -194,6 +210,6 @@ def get_buffer_curve_sample_flatten(sch, args, sample_n=30):
         one-dimensional vector
     """
     stmt = ana_lower(sch, args, simple_mode=True)
-    feas = _get_buffer_curve_sample_flatten(stmt, sample_n, False)
+    feas = _get_buffer_curve_sample_flatten(stmt, sample_n, *_length_args(length_distribution))
     feas = struct.unpack('%df' % (len(feas)//4), feas)
     return feas
@@ -177,12 +177,15 @@ class RPCRunner(Runner):
         Whether check correctness after measurement. This will use llvm cpu target to
         call your template and get the reference output.
         This can work for TOPI templates, but may not work for your custom template.
+    length_distribution: autotvm.ragged.LengthDistribution, optional
+        For ragged kernels, the lengths to measure with. The cost of a config is
+        then its expected latency over the distribution.
     """
     def __init__(self,
                  key, host, port, priority=1,
                  timeout=10, n_parallel=None,
                  number=4, repeat=3, min_repeat_ms=0, cooldown_interval=0.1,
-                 check_correctness=False):
+                 check_correctness=False, length_distribution=None):
         super(RPCRunner, self).__init__(timeout, n_parallel)
 
         self.key = key
@@ -199,6 +202,8 @@ class RPCRunner(Runner):
         self.ref_output = None
         self.check_correctness = check_correctness
         self.cooldown_interval = cooldown_interval
+        self.length_distribution = length_distribution
+        self.input_sets = None
 
         self.executor = LocalExecutor()
 
@@ -225,6 +230,12 @@ class RPCRunner(Runner):
             func(*tvm_buf)
             self.ref_output = [x.asnumpy() for x in tvm_buf]
 
+        if self.length_distribution is not None:
+            with task.target:
+                _, arg_bufs = task.instantiate(task.config_space.get(0))
+            self.input_sets = self.length_distribution.input_sets(
+                [(get_const_tuple(x.shape), x.dtype) for x in arg_bufs])
+
     def get_build_kwargs(self):
         kwargs = {}
         if 'cuda' in self.task.target.keys or 'opencl' in self.task.target.keys or \
@@ -262,7 +273,8 @@ class RPCRunner(Runner):
                                            self.cooldown_interval,
                                            remote_args,
                                            self.ref_input,
-                                           self.ref_output)
+                                           self.ref_output,
+                                           self.input_sets)
                 futures.append(ret)
 
             for future in futures:
@@ -304,6 +316,9 @@ class LocalRunner(RPCRunner):
         Whether check correctness after measurement. This will use llvm cpu target to
         call your template and get the reference output.
         This can work for TOPI templates, but may not work for your custom template.
+    length_distribution: autotvm.ragged.LengthDistribution, optional
+        For ragged kernels, the lengths to measure with. The cost of a config is
+        then its expected latency over the distribution.
 
     Note
     ----
@@ -313,13 +328,14 @@ class LocalRunner(RPCRunner):
     def __init__(self,
                  timeout=10,
                  number=4, repeat=3, min_repeat_ms=0, cooldown_interval=0.1,
-                 check_correctness=False):
+                 check_correctness=False, length_distribution=None):
         super(LocalRunner, self).__init__('', None, None, 0,
                                           timeout=timeout, n_parallel=1,
                                           number=number, repeat=repeat,
                                           min_repeat_ms=min_repeat_ms,
                                           cooldown_interval=cooldown_interval,
-                                          check_correctness=check_correctness)
+                                          check_correctness=check_correctness,
+                                          length_distribution=length_distribution)
         self.tracker = None
         self.server = None
 
@@ -416,7 +432,7 @@ def _wrap_build_func(build_func):
 
 def run_through_rpc(measure_input, build_result,
                     number, repeat, min_repeat_ms, cooldown_interval,
-                    remote_args, ref_input=None, ref_output=None):
+                    remote_args, ref_input=None, ref_output=None, input_sets=None):
     """Run a generated library through rpc
 
     Parameters
@@ -449,6 +465,9 @@ def run_through_rpc(measure_input, build_result,
         The reference input used for checking correctness
     ref_output: List of np.ndarray
         The reference output used for checking correctness
+    input_sets: List of (float, List of np.ndarray)
+        Weighted inputs, e.g. for different lengths of a ragged kernel. If given,
+        the cost is the weighted mean of the costs of the inputs.
     """
     if isinstance(build_result, MeasureResult):
         return build_result
@@ -481,7 +500,16 @@ def run_through_rpc(measure_input, build_result,
             args = [nd.array(x, ctx=ctx) for x in args]
             ctx.sync()
 
-        costs = time_f(*args).results
+        if input_sets:
+            expected = 0.0
+            for weight, inputs in input_sets:
+                sample_args = [nd.array(x, ctx=ctx) for x in inputs]
+                ctx.sync()
+                sample_costs = time_f(*sample_args).results
+                expected += weight * sum(sample_costs) / len(sample_costs)
+            costs = (expected,)
+        else:
+            costs = time_f(*args).results
 
         # clean up remote files
         remote.remove(build_result.filename)
@@ -494,7 +522,7 @@ def run_through_rpc(measure_input, build_result,
             costs = tuple(costs[1:-1])
 
         # check correctness of output
-        if ref_output:
+        if ref_output and not input_sets:
             for expected, real in zip(ref_output, args):
                 if not np.allclose(expected, real.asnumpy(), rtol=1e-4):
                     logger.warning("Wrong Answer!")
@@ -0,0 +1,411 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Tunable GPU schedule templates for ragged operators.
+
+The functions here define a search space over the ragged scheduling
+decisions of operators declared with ragged_compute, namely whether to
+fuse the batch loop with a ragged loop (and the padding assumed for
+the fused loop), the thread block size, the parallelization strategy
+of reductions and unrolling, and apply the configuration using the
+existing schedule primitives. They are meant to be called from an
+autotvm.template, so that the usual tuners can search the space. The
+XGBoost tuner with feature_type="itervar" uses the loop features of
+autotvm.feature, which bound ragged loop extents by the ranges of
+their uninterpreted functions, or evaluate them against a
+LengthDistribution given to the tuner.
+
+.. code-block:: python
+
+    @autotvm.template
+    def ragged_softmax(...):
+        out = ... # ragged_compute ops
+        s = te.create_schedule(out.op)
+        autotvm.ragged.schedule_ragged_softmax(autotvm.get_config(), s, out)
+        return s, [...]
+"""
+from tvm import te
+from tvm.tir import IntImm
+
+
+def _const_extent(iv):
+    extent = iv.dom.extent
+    return extent.value if isinstance(extent, IntImm) else None
+
+
+def _compute_ops(outs):
+    """Compute ops reachable from outs, producers first."""
+    visited = set()
+    ret = []
+
+    def visit(op):
+        if op in visited:
+            return
+        visited.add(op)
+        for t in op.input_tensors:
+            visit(t.op)
+        if isinstance(op, te.ComputeOp):
+            ret.append(op)
+
+    for t in outs:
+        visit(t.op)
+    return ret
+
+
+def define_ragged_schedule(cfg, sch, op, strategies=None, fuse_padding=1, max_threads=1024,
+                           prefix=""):
+    """Define the search space of, and schedule according to cfg, one
+    ragged compute op on a GPU.
+
+    Loops over the spatial axes of the op are, outermost first, the
+    batch loop, possibly a ragged loop and then the others. The first
+    two can be fused into a loop over the ragged iteration space only.
+    Strategies are:
+
+    * "elementwise": the spatial loops are fused and split over blocks
+      and threads.
+    * "cross_thread": for reductions, one block per spatial point, with
+      the reduction split across the threads of the block.
+    * "tiled": for reductions with a constant innermost spatial axis,
+      such as matmuls, threads take tiles of the innermost axis, of
+      "tile" elements each, and the reduction runs serially, unrolled.
+
+    Parameters
+    ----------
+    cfg : ConfigSpace or ConfigEntity
+        The config, as returned by autotvm.get_config().
+
+    sch : Schedule
+        The schedule.
+
+    op : Operation or Tensor
+        The op to schedule.
+
+    strategies : list of str, optional
+        The strategies to search over. Defaults to those that apply to
+        the op.
+
+    fuse_padding : int, optional
+        A multiple that the lengths of the fused ragged loop are padded
+        to. Powers of two dividing it are searched as the padding
+        assumed by the fused loop, which removes predicates.
+
+    max_threads : int, optional
+        The maximum number of threads per block.
+
+    prefix : str, optional
+        A prefix for the names of the knobs.
+    """
+    if isinstance(op, te.Tensor):
+        op = op.op
+    axes = list(op.axis)
+    reduce_axes = list(op.reduce_axis)
+
+    can_fuse = len(axes) >= 2 and _const_extent(axes[1]) is None
+    if strategies is None:
+        if reduce_axes:
+            strategies = ["cross_thread"]
+            if len(axes) >= 2 and _const_extent(axes[-1]) is not None:
+                strategies.append("tiled")
+        else:
+            strategies = ["elementwise"]
+    cfg.define_knob(prefix + "strategy", strategies)
+    cfg.define_knob(prefix + "ragged_fuse", [0, 1] if can_fuse else [0])
+    cfg.define_knob(prefix + "fuse_padding",
+                    [p for p in [1, 2, 4, 8, 16, 32, 64] if fuse_padding % p == 0]
+                    if can_fuse else [1])
+    cfg.define_knob(prefix + "num_threads",
+                    [t for t in [32, 64, 128, 256, 512, 1024] if t <= max_threads])
+    cfg.define_knob(prefix + "unroll", [0, 16, 64, 512])
+    cfg.define_knob(prefix + "tile", [1, 2, 4] if "tiled" in strategies else [1])
+
+    strategy = cfg[prefix + "strategy"].val
+    num_threads = cfg[prefix + "num_threads"].val
+    stage = sch[op]
+
+    spatial = axes
+    if cfg[prefix + "ragged_fuse"].val:
+        padding = cfg[prefix + "fuse_padding"].val
+        fused = stage.fuse(axes[0], axes[1], padding=padding if padding > 1 else -1)
+        spatial = [fused] + axes[2:]
+
+    block_x = te.thread_axis("blockIdx.x")
+    thread_x = te.thread_axis("threadIdx.x")
+    if strategy == "elementwise":
+        fused = stage.fuse(*spatial) if len(spatial) > 1 else spatial[0]
+        outer, inner = stage.split(fused, factor=num_threads)
+        stage.bind(outer, block_x)
+        stage.bind(inner, thread_x)
+    elif strategy == "cross_thread":
+        fused = stage.fuse(*spatial) if len(spatial) > 1 else spatial[0]
+        rest = reduce_axes[1:]
+        ko, ki = stage.split(reduce_axes[0], factor=num_threads)
+        stage.reorder(fused, ko, *rest, ki)
+        stage.bind(fused, block_x)
+        stage.bind(ki, thread_x)
+        # Only one thread writes the reduced value.
+        stage.set_store_predicate(thread_x.var.equal(0))
+    elif strategy == "tiled":
+        outer_spatial = spatial[:-1]
+        tile = cfg[prefix + "tile"].val
+        jo, ji = stage.split(spatial[-1], factor=num_threads * tile)
+        jt, ji = stage.split(ji, factor=tile)
+        fused = stage.fuse(*(outer_spatial + [jo])) if outer_spatial else jo
+        stage.reorder(fused, jt, ji, *reduce_axes)
+        stage.bind(fused, block_x)
+        stage.bind(jt, thread_x)
+        if tile > 1:
+            stage.unroll(ji)
+    else:
+        raise ValueError("Unknown ragged schedule strategy " + strategy)
+
+    unroll = cfg[prefix + "unroll"].val
+    if unroll > 0:
+        stage.pragma(fused, "auto_unroll_max_step", unroll)
+
+
+def define_hfuse(cfg, sch, num_sms, prefix=""):
+    """Define the maximum number of independent stages of the schedule
+    that are horizontally fused into one kernel, and fuse them with
+    te.hfuse_planner.plan_hfuse. A group size of 1 disables fusion.
+
+    Parameters
+    ----------
+    cfg : ConfigSpace or ConfigEntity
+        The config.
+
+    sch : Schedule
+        The schedule, with its stages bound to blocks and threads.
+
+    num_sms : int
+        The number of streaming multiprocessors of the device.
+
+    prefix : str, optional
+        A prefix for the name of the knob.
+    """
+    # pylint: disable=import-outside-toplevel
+    from tvm.te.hfuse_planner import plan_hfuse
+    cfg.define_knob(prefix + "hfuse_group_size", [1, 2, 4, 8])
+    group_size = cfg[prefix + "hfuse_group_size"].val
+    if group_size > 1:
+        plan_hfuse(sch, num_sms, max_group_size=group_size)
+
+
+def schedule_ragged_graph(cfg, sch, outs, fuse_padding=1, max_threads=1024, num_sms=None):
+    """Schedule all the compute ops of a ragged operator, each with its
+    own knobs, prefixed by the op's name.
+
+    Parameters
+    ----------
+    cfg : ConfigSpace or ConfigEntity
+        The config.
+
+    sch : Schedule
+        The schedule.
+
+    outs : Tensor or list of Tensor
+        The outputs of the operator.
+
+    fuse_padding : int, optional
+        See define_ragged_schedule.
+
+    max_threads : int, optional
+        See define_ragged_schedule.
+
+    num_sms : int, optional
+        If given, independent stages are also horizontally fused, see
+        define_hfuse.
+    """
+    outs = [outs] if isinstance(outs, te.Tensor) else outs
+    for op in _compute_ops(outs):
+        define_ragged_schedule(cfg, sch, op, fuse_padding=fuse_padding,
+                               max_threads=max_threads, prefix=op.name + ".")
+    if num_sms is not None:
+        define_hfuse(cfg, sch, num_sms)
+
+
+def schedule_ragged_batch_matmul(cfg, sch, out, fuse_padding=1, max_threads=1024):
+    """Template for a batched matmul whose rows are ragged: the output
+    columns are spread over threads and the ragged rows of the batch
+    fused into the blocks."""
+    define_ragged_schedule(cfg, sch, out, strategies=["tiled", "cross_thread"],
+                           fuse_padding=fuse_padding, max_threads=max_threads)
+
+
+def schedule_ragged_spmm(cfg, sch, out, max_threads=1024):
+    """Template for a CSR sparse matmul declared with ragged_compute,
+    whose reduction runs over the nonzeros of a row. "cross_thread"
+    reduces the nonzeros of a row across threads; "tiled" gives threads
+    the dense columns, which suits wide dense operands."""
+    define_ragged_schedule(cfg, sch, out, strategies=["cross_thread", "tiled"],
+                           max_threads=max_threads)
+
+
+def schedule_ragged_softmax(cfg, sch, outs, fuse_padding=1, max_threads=1024, num_sms=None):
+    """Template for a softmax over ragged rows. The max and sum
+    reductions and the normalization are scheduled separately."""
+    schedule_ragged_graph(cfg, sch, outs, fuse_padding, max_threads, num_sms)
+
+
+def schedule_ragged_layernorm(cfg, sch, outs, fuse_padding=1, max_threads=1024, num_sms=None):
+    """Template for a layer normalization of the rows of a ragged
+    tensor. The mean and variance reductions and the normalization are
+    scheduled separately."""
+    schedule_ragged_graph(cfg, sch, outs, fuse_padding, max_threads, num_sms)
+
+
+def schedule_ragged_attention(cfg, sch, outs, fuse_padding=1, max_threads=1024, num_sms=None):
+    """Template for attention over ragged sequences. The scores, the
+    stages of the softmax and the weighted sum are scheduled
+    separately."""
+    schedule_ragged_graph(cfg, sch, outs, fuse_padding, max_threads, num_sms)
+
+
+class LengthDistribution(object):
+    """A distribution of the lengths that ragged kernels are measured
+    with. Runners given one measure every config on each sample and
+    report the expected latency over the distribution, instead of the
+    latency at a single, arbitrary set of lengths.
+
+    Parameters
+    ----------
+    samples : list of list of int
+        Samples of the lengths tensor, e.g. the sequence lengths of
+        batches drawn from a dataset. Lengths must not exceed the padded
+        extents of the task.
+
+    weights : list of float, optional
+        The probability of each sample. Uniform by default.
+
+    arg_indices : list of int, optional
+        The positions of the lengths tensors in the arguments of the
+        task. By default, every 1-D int32 argument with as many elements
+        as a sample.
+    """
+    def __init__(self, samples, weights=None, arg_indices=None):
+        assert samples, "a length distribution needs at least one sample"
+        if weights is None:
+            weights = [1.0] * len(samples)
+        assert len(weights) == len(samples)
+        total = float(sum(weights))
+        self.samples = [list(s) for s in samples]
+        self.weights = [w / total for w in weights]
+        self.arg_indices = arg_indices
+
+    @staticmethod
+    def from_dataset(lengths, batch_size, num_samples=8, seed=0):
+        """Draw batches of lengths from the lengths of a dataset.
+
+        Parameters
+        ----------
+        lengths : list of int
+            The lengths of the examples of a dataset.
+
+        batch_size : int
+            The number of lengths in a sample.
+
+        num_samples : int, optional
+            The number of samples to draw.
+
+        seed : int, optional
+            The random seed.
+
+        Returns
+        -------
+        dist : LengthDistribution
+            Equally likely samples.
+        """
+        # pylint: disable=import-outside-toplevel
+        import numpy as np
+        rng = np.random.RandomState(seed)
+        samples = [rng.choice(lengths, batch_size).tolist() for _ in range(num_samples)]
+        return LengthDistribution(samples)
+
+    def element_lengths(self):
+        """The distribution of a single length, pooled over the samples.
+
+        Returns
+        -------
+        lengths : list of int
+            The lengths in all samples.
+
+        weights : list of float
+            The probability of each length.
+        """
+        lengths, weights = [], []
+        for weight, sample in zip(self.weights, self.samples):
+            lengths.extend(sample)
+            weights.extend([weight / len(sample)] * len(sample))
+        return lengths, weights
+
+    def statistics(self):
+        """Summary statistics of the pooled lengths, which cost models can
+        be conditioned on: the log2 of the mean, median, 90th and 99th
+        percentile and max length, the coefficient of variation and the
+        fraction of the max length that the mean fills.
+
+        Returns
+        -------
+        stats : list of float
+        """
+        # pylint: disable=import-outside-toplevel
+        import numpy as np
+        lengths, weights = self.element_lengths()
+        lengths = np.array(lengths, dtype='float64')
+        weights = np.array(weights, dtype='float64')
+        order = np.argsort(lengths)
+        cumulative = np.cumsum(weights[order])
+        def _quantile(q):
+            return lengths[order][min(np.searchsorted(cumulative, q - 1e-9), len(order) - 1)]
+        mean = float(np.dot(lengths, weights))
+        std = float(np.sqrt(np.dot((lengths - mean) ** 2, weights)))
+        max_len = float(np.max(lengths))
+        return [np.log2(mean + 1), np.log2(_quantile(0.5) + 1), np.log2(_quantile(0.9) + 1),
+                np.log2(_quantile(0.99) + 1), np.log2(max_len + 1),
+                std / max(mean, 1e-8), mean / max(max_len, 1e-8)]
+
+    def is_lengths_arg(self, index, shape, dtype):
+        """Whether the argument at index holds lengths."""
+        if self.arg_indices is not None:
+            return index in self.arg_indices
+        return len(shape) == 1 and dtype == "int32" and shape[0] == len(self.samples[0])
+
+    def input_sets(self, arg_info):
+        """Inputs to measure with, for each sample.
+
+        Parameters
+        ----------
+        arg_info : list of (tuple of int, str)
+            The shape and dtype of the arguments of the task.
+
+        Returns
+        -------
+        input_sets : list of (float, list of numpy.ndarray)
+            The weight and the arguments of each sample. Lengths
+            arguments hold the sample, the others random values.
+        """
+        # pylint: disable=import-outside-toplevel
+        import numpy as np
+        ret = []
+        for weight, sample in zip(self.weights, self.samples):
+            args = []
+            for i, (shape, dtype) in enumerate(arg_info):
+                if self.is_lengths_arg(i, shape, dtype):
+                    args.append(np.array(sample, dtype=dtype))
+                else:
+                    args.append(np.random.uniform(size=shape).astype(dtype))
+            ret.append((weight, args))
+        return ret
@@ -134,6 +134,10 @@ def extract_from_multiple_program(mods, params, ops, target, target_host=None,
         tvm.relay.op.nn.deformable_conv2d: [topi.nn.deformable_conv2d_nchw],
         tvm.relay.op.nn.conv1d_transpose: [topi.nn.conv1d_transpose_ncw],
         tvm.relay.op.nn.conv3d: [topi.nn.conv3d],
+        tvm.relay.op.nn.ragged_softmax: [topi.nn.ragged_softmax],
+        tvm.relay.op.nn.ragged_batch_matmul: [topi.nn.ragged_batch_matmul],
+        tvm.relay.op.nn.ragged_layer_norm: [topi.nn.ragged_layer_norm],
+        tvm.relay.op.nn.ragged_attention: [topi.nn.ragged_attention],
     }
 
     topi_funcs = []
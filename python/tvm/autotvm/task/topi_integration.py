@@ -30,7 +30,7 @@ import tvm.te._ffi_api
 
 from ... import tensor, placeholder
 
-from .task import args_to_workload, dispatcher, register
+from .task import args_to_workload, dispatcher, register, get_config
 from ..util import get_const_tuple
 
 # A table that records all registered dispatcher for all targets
@@ -96,6 +96,10 @@ class TaskExtractEnv:
             topi.nn.deformable_conv2d_nchw: "topi_nn_deformable_conv2d_nchw",
             topi.nn.conv1d_transpose_ncw: "topi_nn_conv1d_transpose_ncw",
             topi.nn.conv3d: "topi_nn_conv3d",
+            topi.nn.ragged_softmax: "topi_nn_ragged_softmax",
+            topi.nn.ragged_batch_matmul: "topi_nn_ragged_batch_matmul",
+            topi.nn.ragged_layer_norm: "topi_nn_ragged_layer_norm",
+            topi.nn.ragged_attention: "topi_nn_ragged_attention",
         }
 
         self.topi_to_schedule = {
@@ -115,6 +119,10 @@ class TaskExtractEnv:
             topi.nn.deformable_conv2d_nchw: [topi.generic.schedule_deformable_conv2d_nchw],
             topi.nn.conv1d_transpose_ncw: [topi.generic.schedule_conv1d_transpose_ncw],
             topi.nn.conv3d: [topi.generic.schedule_conv3d_ndhwc],
+            topi.nn.ragged_softmax: [topi.generic.schedule_ragged_softmax],
+            topi.nn.ragged_batch_matmul: [topi.generic.schedule_ragged_batch_matmul],
+            topi.nn.ragged_layer_norm: [topi.generic.schedule_ragged_layer_norm],
+            topi.nn.ragged_attention: [topi.generic.schedule_ragged_attention],
         }
 
         # function reflection for tracing
@@ -133,6 +141,10 @@ class TaskExtractEnv:
             topi.nn.deformable_conv2d_nchw: lambda x: setattr(topi.nn, 'deformable_conv2d_nchw', x),
             topi.nn.conv1d_transpose_ncw:   lambda x: setattr(topi.nn, 'conv1d_transpose_ncw', x),
             topi.nn.conv3d:                 lambda x: setattr(topi.nn, 'conv3d', x),
+            topi.nn.ragged_softmax:         lambda x: setattr(topi.nn, 'ragged_softmax', x),
+            topi.nn.ragged_batch_matmul:    lambda x: setattr(topi.nn, 'ragged_batch_matmul', x),
+            topi.nn.ragged_layer_norm:      lambda x: setattr(topi.nn, 'ragged_layer_norm', x),
+            topi.nn.ragged_attention:       lambda x: setattr(topi.nn, 'ragged_attention', x),
         }
 
         self.allow_duplicate = allow_duplicate
@@ -175,6 +187,7 @@ class TaskExtractEnv:
         """register tuning wrapper for topi function"""
         # pylint: disable=import-outside-toplevel
         import topi
+        from .. import ragged as _ragged
 
         # Avoid double registration for certain targets
         if TaskExtractEnv.registered:
@@ -302,6 +315,48 @@ class TaskExtractEnv:
             s = topi.generic.schedule_deformable_conv2d_nchw([C])
             return s, [A, Offset, W, C]
 
+        # Ragged templates use the knobs of autotvm.ragged. Measure them
+        # with a LengthDistribution, as random lengths are out of range.
+        @register("topi_nn_ragged_softmax")
+        def _topi_nn_ragged_softmax(*args, **kwargs):
+            assert not kwargs, "Do not support kwargs in template function call"
+            args = deserialize_args(args)
+            A, L = args[:2]
+            C = topi.nn.ragged_softmax(*args, **kwargs)
+            s = tvm.te.create_schedule([C.op])
+            _ragged.schedule_ragged_softmax(get_config(), s, C)
+            return s, [A, L, C]
+
+        @register("topi_nn_ragged_batch_matmul")
+        def _topi_nn_ragged_batch_matmul(*args, **kwargs):
+            assert not kwargs, "Do not support kwargs in template function call"
+            args = deserialize_args(args)
+            A, B, L = args[:3]
+            C = topi.nn.ragged_batch_matmul(*args, **kwargs)
+            s = tvm.te.create_schedule([C.op])
+            _ragged.schedule_ragged_batch_matmul(get_config(), s, C)
+            return s, [A, B, L, C]
+
+        @register("topi_nn_ragged_layer_norm")
+        def _topi_nn_ragged_layer_norm(*args, **kwargs):
+            assert not kwargs, "Do not support kwargs in template function call"
+            args = deserialize_args(args)
+            A, G, B, L = args[:4]
+            C = topi.nn.ragged_layer_norm(*args, **kwargs)
+            s = tvm.te.create_schedule([C.op])
+            _ragged.schedule_ragged_layernorm(get_config(), s, C)
+            return s, [A, G, B, L, C]
+
+        @register("topi_nn_ragged_attention")
+        def _topi_nn_ragged_attention(*args, **kwargs):
+            assert not kwargs, "Do not support kwargs in template function call"
+            args = deserialize_args(args)
+            Q, K, V, L = args[:4]
+            C = topi.nn.ragged_attention(*args, **kwargs)
+            s = tvm.te.create_schedule([C.op])
+            _ragged.schedule_ragged_attention(get_config(), s, C)
+            return s, [Q, K, V, L, C]
+
         @register("topi_nn_conv2d_NCHWc")
         def _topi_nn_conv2d_NCHWc(*args, **kwargs):
             assert not kwargs, "Do not support kwargs in template function call"
@@ -68,9 +68,12 @@ class XGBoostCostModel(CostModel):
         If is not none, the cost model will print training log every `log_interval` iterations.
     upper_model: XGBoostCostModel, optional
         The upper model used in transfer learning
+    length_distribution: LengthDistribution, optional
+        The distribution ragged loop extents are evaluated against by
+        the 'itervar' and 'curve' features
     """
     def __init__(self, task, feature_type, loss_type, num_threads=None, log_interval=25,
-                 upper_model=None):
+                 upper_model=None, length_distribution=None):
         super(XGBoostCostModel, self).__init__()
 
         if xgb is None:
@@ -86,6 +89,7 @@ class XGBoostCostModel(CostModel):
         self.loss_type = loss_type
         self.num_threads = num_threads
         self.log_interval = log_interval
+        self.length_distribution = length_distribution
 
         if loss_type == 'reg':
             self.xgb_params = {
@@ -144,20 +148,21 @@ class XGBoostCostModel(CostModel):
         self._sample_size = 0
         self._reset_pool(self.space, self.target, self.task)
 
-    def _reset_pool(self, space, target, task):
+    def _reset_pool(self, space, target, task, length_distribution=None):
         """reset processing pool for feature extraction"""
 
         if self.upper_model:  # base model will reuse upper model's pool,
-            self.upper_model._reset_pool(space, target, task)
+            self.upper_model._reset_pool(space, target, task, length_distribution)
             return
 
         self._close_pool()
 
         # use global variable to pass common arguments
-        global _extract_space, _extract_target, _extract_task
+        global _extract_space, _extract_target, _extract_task, _extract_length_distribution
         _extract_space = space
         _extract_target = target
         _extract_task = task
+        _extract_length_distribution = length_distribution or self.length_distribution
         self.pool = multiprocessing.Pool(self.num_threads)
 
     def _close_pool(self):
@@ -216,36 +221,7 @@ class XGBoostCostModel(CostModel):
     def fit_log(self, records, plan_size):
         tic = time.time()
 
-        # filter data, only pick the data with a same task
-        data = []
-        for inp, res in records:
-            if inp.task.name == self.task.name and \
-                            inp.config.template_key == self.task.config_space.template_key:
-                data.append((inp, res))
-
-        logger.debug("XGB load %d entries from history log file", len(data))
-
-        # extract feature
-        self._reset_pool(self.space, self.target, self.task)
-        pool = self._get_pool()
-        if self.fea_type == 'itervar':
-            feature_extract_func = _extract_itervar_feature_log
-        elif self.fea_type == 'knob':
-            feature_extract_func = _extract_knob_feature_log
-        elif self.fea_type == 'curve':
-            feature_extract_func = _extract_curve_feature_log
-        else:
-            raise RuntimeError("Invalid feature type: " + self.fea_type)
-        res = pool.map(feature_extract_func, data)
-
-        # filter out feature with different shapes
-        fea_len = len(self._get_feature([0])[0])
-
-        xs, ys = [], []
-        for x, y in res:
-            if len(x) == fea_len:
-                xs.append(x)
-                ys.append(y)
+        xs, ys = self._extract_log(records)
 
         if len(xs) < 500:  # no enough samples
             return False
@@ -276,6 +252,49 @@ class XGBoostCostModel(CostModel):
 
         return True
 
+    def _extract_log(self, records, length_distribution=None):
+        """extract features and throughputs of the records with the same
+        task, measured with length_distribution"""
+        # filter data, only pick the data with a same task
+        data = []
+        for inp, res in records:
+            if inp.task.name == self.task.name and \
+                            inp.config.template_key == self.task.config_space.template_key:
+                data.append((inp, res))
+
+        logger.debug("XGB load %d entries from history log file", len(data))
+
+        # filter out feature with different shapes
+        fea_len = len(self._get_feature([0])[0])
+
+        # extract feature
+        self._reset_pool(self.space, self.target, self.task, length_distribution)
+        pool = self._get_pool()
+        if self.fea_type == 'itervar':
+            feature_extract_func = _extract_itervar_feature_log
+        elif self.fea_type == 'knob':
+            feature_extract_func = _extract_knob_feature_log
+        elif self.fea_type == 'curve':
+            feature_extract_func = _extract_curve_feature_log
+        else:
+            raise RuntimeError("Invalid feature type: " + self.fea_type)
+        res = pool.map(feature_extract_func, data)
+
+        xs, ys = [], []
+        for item in res:
+            if item is None:
+                continue
+            x, y = item
+            x = self._condition(np.array(x)[np.newaxis], length_distribution)[0]
+            if len(x) == fea_len:
+                xs.append(x)
+                ys.append(y)
+        return xs, ys
+
+    def _condition(self, feas, length_distribution=None):  # pylint: disable=unused-argument
+        """append the features the model is conditioned on to feas"""
+        return feas
+
     def predict(self, xs, output_margin=False):
         feas = self._get_feature(xs)
         dtest = xgb.DMatrix(feas)
@@ -322,15 +341,125 @@ class XGBoostCostModel(CostModel):
         for i, ii in enumerate(indexes):
             t = fea_cache[ii]
             ret[i, :] = t if t is not None else 0
-        return ret
+        return self._condition(ret)
 
     def __del__(self):
         self._close_pool()
 
 
+class RaggedXGBoostCostModel(XGBoostCostModel):
+    """XGBoost cost model for ragged tasks, conditioned on the statistics
+    of the length distribution the configs are measured with.
+
+    History measured with other distributions can be loaded with
+    fit_log, grouped by distribution, so that a model trained on the
+    traffic of one deployment warm-starts tuning for another. The
+    statistics make the model learn how the best configs shift with the
+    lengths, instead of averaging over the distributions.
+
+    Parameters
+    ----------
+    task: Task
+        The tuning task
+    feature_type: str
+        See XGBoostCostModel. The 'itervar' and 'curve' features evaluate
+        ragged loop extents against the distribution.
+    loss_type: str
+        See XGBoostCostModel
+    length_distribution: LengthDistribution
+        The distribution the task is tuned for
+    num_threads: int, optional
+        The number of threads.
+    log_interval: int, optional
+        If is not none, the cost model will print training log every `log_interval` iterations.
+    upper_model: XGBoostCostModel, optional
+        The upper model used in transfer learning
+    """
+    def __init__(self, task, feature_type, loss_type, length_distribution, num_threads=None,
+                 log_interval=25, upper_model=None):
+        super(RaggedXGBoostCostModel, self).__init__(task, feature_type, loss_type,
+                                                     num_threads, log_interval, upper_model,
+                                                     length_distribution)
+
+    def fit_log(self, records, plan_size):
+        """Fit the model on history records.
+
+        Parameters
+        ----------
+        records: list of (MeasureInput, MeasureResult), or list of
+                 (LengthDistribution, list of (MeasureInput, MeasureResult))
+            The records, measured with the distribution of this model, or
+            grouped by the distribution they were measured with.
+        plan_size: int
+            The plan size of tuner
+        """
+        tic = time.time()
+
+        records = list(records)
+        if records and _is_length_distribution(records[0][0]):
+            groups = records
+        else:
+            groups = [(self.length_distribution, records)]
+
+        xs, ys = [], []
+        for length_distribution, group in groups:
+            group_xs, group_ys = self._extract_log(group, length_distribution)
+            if not group_ys:
+                continue
+            # throughputs are normalized per distribution, as they are not
+            # comparable across distributions
+            y_max = np.max(group_ys)
+            xs.extend(group_xs)
+            ys.extend(np.array(group_ys) / max(y_max, 1e-8))
+        self._reset_pool(self.space, self.target, self.task)
+
+        if len(xs) < 500:  # no enough samples
+            return False
+
+        x_train, y_train = np.array(xs), np.array(ys)
+        index = np.random.permutation(len(x_train))
+        dtrain = xgb.DMatrix(x_train[index], y_train[index])
+
+        plan_size *= 2
+        self.bst = xgb.train(self.xgb_params, dtrain,
+                             num_boost_round=400,
+                             callbacks=[custom_callback(
+                                 stopping_rounds=100,
+                                 metric='tr-a-recall@%d' % plan_size,
+                                 evals=[(dtrain, 'tr')],
+                                 maximize=True,
+                                 fevals=[
+                                     xgb_average_recalln_curve_score(plan_size),
+                                 ],
+                                 verbose_eval=self.log_interval)])
+
+        logger.debug("XGB train: %.2f\tobs: %d\tdistributions: %d",
+                     time.time() - tic, len(xs), len(groups))
+
+        return True
+
+    def spawn_base_model(self):
+        return RaggedXGBoostCostModel(self.task, self.fea_type, self.loss_type,
+                                      self.length_distribution, self.num_threads,
+                                      self.log_interval, self)
+
+    def _condition(self, feas, length_distribution=None):
+        if length_distribution is None:
+            length_distribution = self.length_distribution
+        stats = np.array(length_distribution.statistics(), dtype=feas.dtype)
+        return np.concatenate((feas, np.tile(stats, (feas.shape[0], 1))), axis=1)
+
+
+def _is_length_distribution(obj):
+    # pylint: disable=import-outside-toplevel
+    from ..ragged import LengthDistribution
+    return isinstance(obj, LengthDistribution)
+
+
 _extract_space = None
 _extract_target = None
 _extract_task = None
+_extract_length_distribution = None
 
 def _extract_itervar_feature_index(index):
     """extract iteration var feature for an index in extract_space"""
@@ -338,7 +467,8 @@ def _extract_itervar_feature_index(index):
         config = _extract_space.get(index)
         with _extract_target:
             sch, args = _extract_task.instantiate(config)
-        fea = feature.get_itervar_feature_flatten(sch, args, take_log=True)
+        fea = feature.get_itervar_feature_flatten(
+            sch, args, take_log=True, length_distribution=_extract_length_distribution)
         fea = np.concatenate((fea, list(config.get_other_option().values())))
         return fea
     except Exception:  # pylint: disable=broad-except
@@ -351,7 +481,8 @@ def _extract_itervar_feature_log(arg):
         config = inp.config
         with inp.target:
             sch, args = inp.task.instantiate(config)
-        fea = feature.get_itervar_feature_flatten(sch, args, take_log=True)
+        fea = feature.get_itervar_feature_flatten(
+            sch, args, take_log=True, length_distribution=_extract_length_distribution)
         x = np.concatenate((fea, list(config.get_other_option().values())))
 
         if res.error_no == 0:
@@ -393,7 +524,8 @@ def _extract_curve_feature_index(index):
         config = _extract_space.get(index)
         with _extract_target:
             sch, args = _extract_task.instantiate(config)
-        fea = feature.get_buffer_curve_sample_flatten(sch, args, sample_n=20)
+        fea = feature.get_buffer_curve_sample_flatten(
+            sch, args, sample_n=20, length_distribution=_extract_length_distribution)
         fea = np.concatenate((fea, list(config.get_other_option().values())))
         return np.array(fea)
     except Exception:  # pylint: disable=broad-except
@@ -406,7 +538,8 @@ def _extract_curve_feature_log(arg):
         config = inp.config
         with inp.target:
             sch, args = inp.task.instantiate(config)
-        fea = feature.get_buffer_curve_sample_flatten(sch, args, sample_n=20)
+        fea = feature.get_buffer_curve_sample_flatten(
+            sch, args, sample_n=20, length_distribution=_extract_length_distribution)
         x = np.concatenate((fea, list(config.get_other_option().values())))
 
         if res.error_no == 0:
@@ -17,7 +17,7 @@
 """Tuner that uses xgboost as cost model"""
 
 from .model_based_tuner import ModelBasedTuner, ModelOptimizer
-from .xgboost_cost_model import XGBoostCostModel
+from .xgboost_cost_model import XGBoostCostModel, RaggedXGBoostCostModel
 from .sa_model_optimizer import SimulatedAnnealingOptimizer
 
 class XGBTuner(ModelBasedTuner):
@@ -67,15 +67,30 @@ class XGBTuner(ModelBasedTuner):
         The verbose level.
         If is 0, output nothing.
         Otherwise, output debug information every `verbose` iterations.
+
+    length_distribution: LengthDistribution, optional
+        The distribution a ragged task is tuned for. The cost model then
+        evaluates ragged loop extents against it and is conditioned on its
+        statistics, so that load_history also accepts records grouped by
+        the distributions they were measured with, see RaggedXGBoostCostModel.
     """
     def __init__(self, task, plan_size=64,
                  feature_type='itervar', loss_type='rank', num_threads=None,
-                 optimizer='sa', diversity_filter_ratio=None, log_interval=50):
-        cost_model = XGBoostCostModel(task,
-                                      feature_type=feature_type,
-                                      loss_type=loss_type,
-                                      num_threads=num_threads,
-                                      log_interval=log_interval // 2)
+                 optimizer='sa', diversity_filter_ratio=None, log_interval=50,
+                 length_distribution=None):
+        if length_distribution is None:
+            cost_model = XGBoostCostModel(task,
+                                          feature_type=feature_type,
+                                          loss_type=loss_type,
+                                          num_threads=num_threads,
+                                          log_interval=log_interval // 2)
+        else:
+            cost_model = RaggedXGBoostCostModel(task,
+                                                feature_type=feature_type,
+                                                loss_type=loss_type,
+                                                length_distribution=length_distribution,
+                                                num_threads=num_threads,
+                                                log_interval=log_interval // 2)
         if optimizer == 'sa':
             optimizer = SimulatedAnnealingOptimizer(task, log_interval=log_interval)
         else:
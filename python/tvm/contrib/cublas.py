@@ -74,3 +74,46 @@ def batch_matmul(lhs, rhs, transa=False, transb=False, dtype=None):
         lambda ins, outs: tvm.tir.call_packed(
             "tvm.contrib.cublas.batch_matmul",
             ins[0], ins[1], outs[0], transa, transb), dtype=dtype, name="C")
+
+def grouped_matmul(lhs, rhs, m, n, k, out_size, transa=False, transb=False, dtype=None,
+                   name="C"):
+    """Create an extern op that computes the matrix mults of a group of
+    problems of varying sizes with cuBLAS, such as the sequences of a
+    ragged batch.
+
+    Problem i computes the row major M_i x N_i matrix C_i = A_i B_i. The
+    matrices of the problems are stored back to back in lhs, rhs and the
+    result, A_i being M_i x K_i (K_i x M_i if transa) and B_i being
+    K_i x N_i (N_i x K_i if transb).
+
+    Parameters
+    ----------
+    lhs : Tensor
+        The left matrix operands
+    rhs : Tensor
+        The right matrix operands
+    m : Tensor
+        1-D int32 tensor of M_i, such as the lengths of a ragged batch
+    n : Tensor
+        1-D int32 tensor of N_i
+    k : Tensor
+        1-D int32 tensor of K_i
+    out_size : PrimExpr or int
+        The number of elements of the result, the sum of M_i * N_i
+    transa : bool
+        Whether transpose the left operands
+    transb : bool
+        Whether transpose the right operands
+
+    Returns
+    -------
+    C : Tensor
+        The 1-D result tensor.
+    """
+    dtype = dtype if dtype is not None else lhs.dtype
+    return _api.extern(
+        (out_size,), [lhs, rhs, m, n, k],
+        lambda ins, outs: tvm.tir.call_packed(
+            "tvm.contrib.cublas.grouped_matmul",
+            ins[0], ins[1], outs[0], ins[2], ins[3], ins[4], transa, transb),
+        dtype=dtype, name=name)
@@ -0,0 +1,60 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Replay of the kernel launches of built functions as CUDA graphs.
+
+A ragged layer made of several kernels is launched kernel by kernel,
+and for small batches the launch overhead dominates. Wrapping the
+function captures the launches of its first call into a CUDA graph,
+which later calls replay with a single launch.
+
+.. code-block:: python
+
+    # The prep code runs on the host, so it is built apart from the
+    # kernels, which are captured.
+    with tvm.build_config(prep_code_mode="external_prep_code"):
+        mod = tvm.build(s, args, "cuda")
+    f = tvm.contrib.cuda_graph.wrap(mod.entry_func)
+    f(*args)  # captures and runs
+    f(*args)  # replays
+"""
+import tvm._ffi
+
+
+def wrap(func):
+    """Wrap a function so that its device work is replayed as a CUDA graph.
+
+    Only the work the function issues on the current CUDA stream is
+    captured, and its host computations are not replayed. Buffers are
+    read when the graph is replayed, so their contents may change
+    between calls. When the arguments change (the addresses or shapes
+    of tensors, or scalars), the function is captured again, and the
+    kernel parameters of the graph are patched if its sequence of
+    launches is the same. The function may not synchronize with the
+    device.
+
+    Parameters
+    ----------
+    func : PackedFunc
+        The function, such as the entry function of a module built for
+        cuda, or the run function of a graph runtime module.
+
+    Returns
+    -------
+    wrapped : PackedFunc
+        The wrapped function.
+    """
+    return tvm._ffi.get_global_func("runtime.CUDAGraphWrap")(func)
@@ -401,3 +401,170 @@ def conv_forward(x,
             ins[1],
             outs[0],
             conv_dtype), name="y")
+
+
+# RNN modes, from cudnnRNNMode_t
+_RNN_MODES = ["rnn_relu", "rnn_tanh", "lstm", "gru"]
+
+
+def rnn_params_size(input_size, hidden_size, num_layers=1, mode="lstm",
+                    bidirectional=False, dtype="float32"):
+    """Get the number of elements of the packed weights of a CuDNN RNN
+
+    Parameters
+    ----------
+    input_size: int
+        size of the input vectors
+    hidden_size: int
+        size of the hidden state
+    num_layers: int
+        number of stacked layers
+    mode: str
+        "rnn_relu", "rnn_tanh", "lstm" or "gru"
+    bidirectional: bool
+        whether the RNN is bidirectional
+    dtype: str
+        data type
+
+    Returns
+    -------
+    size: int
+        number of weight elements, in the layout of cudnnGetRNNLinLayerMatrixParams
+    """
+    func = _get_global_func("tvm.contrib.cudnn.rnn.params_size")
+    size = func(input_size, hidden_size, num_layers, _RNN_MODES.index(mode),
+                bidirectional, dtype)
+    return size // (tvm.runtime.DataType(dtype).bits // 8)
+
+
+def rnn_forward(x, w, lengths, hidden_size, num_layers=1, mode="lstm",
+                bidirectional=False):
+    """Create an extern op that runs a CuDNN RNN over sequences of
+    variable lengths, such as the rows of a ragged batch
+
+    Parameters
+    ----------
+    x: Tensor
+        (batch, max_seq_len, input_size) padded input sequences
+    w: Tensor
+        packed weights, of rnn_params_size elements
+    lengths: Tensor
+        1-D int32 tensor of the batch sequence lengths
+    hidden_size: int
+        size of the hidden state
+    num_layers: int
+        number of stacked layers
+    mode: str
+        "rnn_relu", "rnn_tanh", "lstm" or "gru"
+    bidirectional: bool
+        whether the RNN is bidirectional
+
+    Returns
+    -------
+    y: Tensor
+        (batch, max_seq_len, hidden_size * num_directions) output of the
+        last layer, zero past the length of each sequence
+    """
+    oshape = [x.shape[0], x.shape[1], hidden_size * (2 if bidirectional else 1)]
+    return _api.extern(
+        oshape, [x, w, lengths],
+        lambda ins, outs: tvm.tir.call_packed(
+            "tvm.contrib.cudnn.rnn.forward",
+            ins[0],
+            ins[1],
+            ins[2],
+            outs[0],
+            hidden_size,
+            num_layers,
+            _RNN_MODES.index(mode),
+            bidirectional), name="y")
+
+
+def multi_head_attn_weights_size(q_size, k_size, v_size, num_heads,
+                                 q_proj_size, k_proj_size, v_proj_size, o_proj_size,
+                                 dtype="float32"):
+    """Get the number of elements of the packed projection weights of
+    CuDNN multi-head attention
+
+    Parameters
+    ----------
+    q_size, k_size, v_size: int
+        sizes of the query, key and value vectors
+    num_heads: int
+        number of attention heads
+    q_proj_size, k_proj_size, v_proj_size, o_proj_size: int
+        sizes of the projections per head, 0 for no projection
+    dtype: str
+        data type
+
+    Returns
+    -------
+    size: int
+        number of weight elements, in the layout of cudnnGetMultiHeadAttnWeights
+    """
+    func = _get_global_func("tvm.contrib.cudnn.multi_head_attn.weights_size")
+    size = func(q_size, k_size, v_size, num_heads,
+                q_proj_size, k_proj_size, v_proj_size, o_proj_size, dtype)
+    return size // (tvm.runtime.DataType(dtype).bits // 8)
+
+
+def multi_head_attn_forward(q, k, v, w, qo_lengths, kv_lengths, num_heads,
+                            q_proj_size, k_proj_size, v_proj_size, o_proj_size,
+                            sm_scaler=None, causal=False):
+    """Create an extern op that computes CuDNN multi-head attention over
+    sequences of variable lengths, such as the rows of a ragged batch
+
+    Parameters
+    ----------
+    q: Tensor
+        (batch, max_qo_len, q_size) padded queries
+    k: Tensor
+        (batch, max_kv_len, k_size) padded keys
+    v: Tensor
+        (batch, max_kv_len, v_size) padded values
+    w: Tensor
+        packed projection weights, of multi_head_attn_weights_size elements
+    qo_lengths: Tensor
+        1-D int32 tensor of the query sequence lengths
+    kv_lengths: Tensor
+        1-D int32 tensor of the key and value sequence lengths
+    num_heads: int
+        number of attention heads
+    q_proj_size, k_proj_size, v_proj_size, o_proj_size: int
+        sizes of the projections per head, 0 for no projection
+    sm_scaler: float
+        softmax scale, 1 / sqrt(k_proj_size) by default
+    causal: bool
+        whether query i only attends to keys up to i
+
+    Returns
+    -------
+    out: Tensor
+        (batch, max_qo_len, o_size) attention output, where o_size is
+        o_proj_size, or num_heads times the value size if it is 0
+    """
+    if sm_scaler is None:
+        sm_scaler = 1.0 / np.sqrt(k_proj_size if k_proj_size > 0 else k.shape[2].value)
+    if o_proj_size > 0:
+        o_size = o_proj_size
+    else:
+        o_size = num_heads * (v_proj_size if v_proj_size > 0 else v.shape[2])
+    oshape = [q.shape[0], q.shape[1], o_size]
+    return _api.extern(
+        oshape, [q, k, v, w, qo_lengths, kv_lengths],
+        lambda ins, outs: tvm.tir.call_packed(
+            "tvm.contrib.cudnn.multi_head_attn.forward",
+            ins[0],
+            ins[1],
+            ins[2],
+            ins[3],
+            ins[4],
+            ins[5],
+            outs[0],
+            num_heads,
+            q_proj_size,
+            k_proj_size,
+            v_proj_size,
+            o_proj_size,
+            float(sm_scaler),
+            causal), name="out")
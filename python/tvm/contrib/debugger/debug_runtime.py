@@ -16,6 +16,7 @@
 # under the License.
 """Graph debug runtime executes TVM debug packed functions."""
 
+import json
 import os
 import tempfile
 import shutil
@@ -104,6 +105,7 @@ class GraphModuleDebug(graph_runtime.GraphModule):
         self._dump_path = None
         self._get_output_by_layer = module["get_output_by_layer"]
         self._run_individual = module["run_individual"]
+        self._profile_ops = module["profile_ops"]
         graph_runtime.GraphModule.__init__(self, module)
         self._create_debug_env(graph_json_str, ctx)
 
@@ -244,6 +246,29 @@ class GraphModuleDebug(graph_runtime.GraphModule):
         ret = self._run_individual(number, repeat, min_repeat_ms)
         return ret.strip(",").split(",") if ret else []
 
+    def profile_ops(self, number=10):
+        """Time each op along with the work it does.
+
+        Ops are timed with device events where the device has them. The
+        work of an op is counted in the elements of its outputs, of which
+        ragged outputs only hold the useful ones for the current row
+        lengths, so that ops spending their time on padding stand out.
+
+        Parameters
+        ----------
+        number : int
+            The number of times to run each op for taking average.
+
+        Returns
+        -------
+        profile : list of dict
+            For each op, its "name", mean "time_us", whether it was timed
+            with device events ("device_timer"), "padded_elems" and
+            "useful_elems" of its outputs, the fraction of "padding" and
+            the "useful_elems_per_sec".
+        """
+        return json.loads(self._profile_ops(number))
+
     def exit(self):
         """Exits the dump folder and all its contents"""
         self._remove_dump_root()
@@ -15,6 +15,8 @@
 # specific language governing permissions and limitations
 # under the License.
 """Minimum graph runtime that executes graph containing TVM PackedFunc."""
+import json
+
 import numpy as np
 import tvm._ffi
 
@@ -63,6 +65,47 @@ def create(graph_json_str, libmod, ctx):
     return GraphModule(fcreate(graph_json_str, libmod, *device_type_id))
 
 
+def mark_ragged(graph_json_str, ragged):
+    """Mark entries of a graph as ragged, so that the runtime sizes their
+    storage for their packed data when the graph runs rather than for
+    their dense shape.
+
+    Parameters
+    ----------
+    graph_json_str : str
+        The graph in json format.
+
+    ragged : dict of str to str
+        Maps the names of the nodes whose first output is ragged, with
+        a dense shape of (rows, max_length) + inner_shape, to the names
+        of the nodes whose first output holds their 1-D integer row
+        lengths. Ragged graph inputs are not resized and are bound with
+        GraphModule.set_ragged_input_zero_copy.
+
+    Notes
+    -----
+    In a graph with ragged entries, the entries other than inputs are
+    placed in one arena per device before each run. Their placement uses
+    their sizes for the current row lengths and the range of ops they
+    are live in, so peak memory follows the tokens in the batch rather
+    than the padded maximum. Entries share arena space only when the
+    graph runs on a single worker.
+
+    Returns
+    -------
+    graph_json_str : str
+        The graph with the ragged_lengths attribute.
+    """
+    graph = json.loads(graph_json_str)
+    node_ids = {node["name"]: i for i, node in enumerate(graph["nodes"])}
+    row_ptr = graph["node_row_ptr"]
+    lengths = [-1] * row_ptr[-1]
+    for name, lengths_name in ragged.items():
+        lengths[row_ptr[node_ids[name]]] = row_ptr[node_ids[lengths_name]]
+    graph["attrs"]["ragged_lengths"] = ["list_int", lengths]
+    return json.dumps(graph)
+
+
 def get_device_ctx(libmod, ctx):
     """Parse and validate all the device context(s).
 
@@ -137,7 +180,11 @@ class GraphModule(object):
         self._get_input = module["get_input"]
         self._get_num_outputs = module["get_num_outputs"]
         self._load_params = module["load_params"]
+        self._load_params_from_file = module["load_params_from_file"]
         self._share_params = module["share_params"]
+        self._set_thread_pool = module["set_thread_pool"]
+        self._set_parallelism = module["set_parallelism"]
+        self._set_ragged_input_zero_copy = module["set_ragged_input_zero_copy"]
 
     def set_input(self, key=None, value=None, **params):
         """Set inputs to the module via kwargs
@@ -163,6 +210,25 @@ class GraphModule(object):
             for k in keys:
                 self._get_input(k).copyfrom(params[k])
 
+    def set_ragged_input_zero_copy(self, key, value, lengths_key):
+        """Bind a ragged input and its row lengths input to the module
+        without copying them.
+
+        Parameters
+        ----------
+        key : int or str
+           The input key of the packed ragged data
+
+        value : tvm.runtime.ndarray.RaggedNDArray
+           The ragged input, as made by tvm.nd.ragged_from_data for data
+           resident on the device. It must stay alive while the module
+           runs.
+
+        lengths_key : int or str
+           The input key of the row lengths
+        """
+        self._set_ragged_input_zero_copy(key, value.data, lengths_key, value.lengths)
+
     def run(self, **input_dict):
         """Run forward execution of the graph
 
@@ -243,6 +309,20 @@ class GraphModule(object):
         """
         self._load_params(bytearray(params_bytes))
 
+    def load_params_from_file(self, file_name):
+        """Load parameters from a file holding a serialized parameter dict.
+
+        The file is mapped into memory rather than read. Parameters on
+        devices are copied from the mapping, and those on the CPU are used
+        in place if saved with an alignment by save_param_dict.
+
+        Parameters
+        ----------
+        file_name : str
+            The file the serialized parameter dict was written to.
+        """
+        self._load_params_from_file(file_name)
+
     def share_params(self, other, params_bytes):
         """Share parameters from pre-existing GraphRuntime instance.
 
@@ -256,6 +336,30 @@ class GraphModule(object):
         """
         self._share_params(other.module, bytearray(params_bytes))
 
+    def set_thread_pool(self, name):
+        """Run the graph on a named thread pool.
+
+        Parameters
+        ----------
+        name : str
+            The name of a pool made by tvm.runtime.create_thread_pool,
+            or "" for the default pool of the thread calling run.
+        """
+        self._set_thread_pool(name)
+
+    def set_parallelism(self, num_workers):
+        """Run the independent ops of the graph concurrently.
+
+        Parameters
+        ----------
+        num_workers : int
+            The number of threads running ops, 1 to run them one by one.
+            On a graph with GPU ops, each thread launches them on a
+            stream of its own, so that independent branches overlap on
+            the device.
+        """
+        self._set_parallelism(num_workers)
+
     def __getitem__(self, key):
         """Get internal module function
 
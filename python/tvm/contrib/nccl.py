@@ -0,0 +1,169 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""External function interface to NCCL collectives on ragged tensors.
+
+The rows of a ragged tensor that is sharded by token count, as
+tvm.contrib.ragged_shard does, are split unevenly over the ranks. The
+collectives here take the number of rows of every rank, and run on the
+current stream of the device, after the kernels launched before them
+and without a synchronization of the host:
+
+.. code-block:: python
+
+  comm = nccl.Communicator.init_all([0, 1])
+  counts = tvm.te.placeholder((2,), name='counts', dtype='int32')
+  x = tvm.te.placeholder((local_rows, hidden), name='x')
+  y = nccl.all_gatherv(x, counts, total_rows, comm.comm_id)
+
+When the counts are on the device, they are copied back on the stream,
+which waits for the work queued before the collective. Passing them in
+host memory to the packed functions avoids the wait, so that the
+collective can overlap the kernels on other streams.
+"""
+import tvm
+from .. import api as _api
+from .. import get_global_func as _get_global_func
+
+
+def get_unique_id():
+    """Create the id that the ranks of a communicator agree on.
+
+    Returns
+    -------
+    unique_id : bytearray
+        The id, to be sent to every rank, for instance over the rpc.
+    """
+    return bytearray(_get_global_func("tvm.contrib.nccl.get_unique_id")())
+
+
+class Communicator(object):
+    """A NCCL communicator, identified by comm_id in the collectives."""
+    _next_id = 0
+
+    def __init__(self, comm_id):
+        self.comm_id = comm_id
+
+    @classmethod
+    def _new_id(cls):
+        comm_id = cls._next_id
+        cls._next_id += 1
+        return comm_id
+
+    @classmethod
+    def init_rank(cls, device_id, nranks, rank, unique_id, comm_id=None):
+        """Join a communicator that spans processes, as one of its ranks.
+
+        Parameters
+        ----------
+        device_id : int
+            The GPU of the rank
+        nranks : int
+            The number of ranks
+        rank : int
+            The rank of this process
+        unique_id : bytearray
+            The id from get_unique_id on one of the ranks
+        comm_id : int, optional
+            The id of the communicator in this process
+
+        Returns
+        -------
+        comm : Communicator
+        """
+        comm_id = cls._new_id() if comm_id is None else comm_id
+        _get_global_func("tvm.contrib.nccl.init_rank")(
+            comm_id, device_id, nranks, rank, bytearray(unique_id))
+        return cls(comm_id)
+
+    @classmethod
+    def init_all(cls, device_ids, comm_id=None):
+        """Create a communicator with one rank per GPU of this process.
+        The ranks have to be driven from a thread per device.
+
+        Parameters
+        ----------
+        device_ids : list of int
+            The GPUs, in rank order
+        comm_id : int, optional
+            The id of the communicator in this process
+
+        Returns
+        -------
+        comm : Communicator
+        """
+        comm_id = cls._new_id() if comm_id is None else comm_id
+        _get_global_func("tvm.contrib.nccl.init_all")(comm_id, *device_ids)
+        return cls(comm_id)
+
+    def destroy(self):
+        """Release the communicator on every device of this process."""
+        _get_global_func("tvm.contrib.nccl.destroy")(self.comm_id)
+
+
+def all_gatherv(data, counts, total_rows, comm_id, name="gathered"):
+    """Create an extern op that gathers the rows of every rank.
+
+    Parameters
+    ----------
+    data : Tensor
+        The counts[rank] rows of this rank
+    counts : Tensor
+        The int32 or int64 number of rows of every rank
+    total_rows : PrimExpr
+        The number of rows of the output, at least the sum of the counts
+    comm_id : int
+        The communicator
+
+    Returns
+    -------
+    out : Tensor
+        The rows of all the ranks, in rank order.
+    """
+    return _api.extern(
+        [total_rows] + list(data.shape[1:]), [data, counts],
+        lambda ins, outs: tvm.tir.call_packed(
+            "tvm.contrib.nccl.all_gatherv",
+            ins[0], ins[1], outs[0], comm_id), dtype=data.dtype, name=name)
+
+
+def reduce_scatterv(data, counts, local_rows, comm_id, op="sum", name="scattered"):
+    """Create an extern op that reduces the rows of every rank, and
+    scatters the result so that rank r gets its counts[r] rows.
+
+    Parameters
+    ----------
+    data : Tensor
+        The rows to reduce, at least the sum of the counts of them
+    counts : Tensor
+        The int32 or int64 number of rows of every rank
+    local_rows : PrimExpr
+        The number of rows of the output, at least counts[rank]
+    comm_id : int
+        The communicator
+    op : str
+        The reduction, one of "sum", "prod", "max" and "min"
+
+    Returns
+    -------
+    out : Tensor
+        The reduced rows of this rank.
+    """
+    return _api.extern(
+        [local_rows] + list(data.shape[1:]), [data, counts],
+        lambda ins, outs: tvm.tir.call_packed(
+            "tvm.contrib.nccl.reduce_scatterv",
+            ins[0], ins[1], outs[0], comm_id, op), dtype=data.dtype, name=name)
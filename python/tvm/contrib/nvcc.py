@@ -18,8 +18,10 @@
 """Utility to invoke nvcc compiler in the system"""
 from __future__ import absolute_import as _abs
 
+import hashlib
 import subprocess
 import os
+import threading
 import warnings
 from tvm.runtime import ndarray as nd
 
@@ -27,6 +29,26 @@ from . import util
 from ..api import register_func
 from .._ffi.base import py_str
 
+def _cache_file(code, cmd, target):
+    """The file nvcc output for code and cmd is kept in, when the kernel
+    cache is enabled by setting TVM_CUDA_KERNEL_CACHE to 1."""
+    if os.environ.get("TVM_CUDA_KERNEL_CACHE") != "1":
+        return None
+    if "TVM_CACHE_DIR" in os.environ:
+        cache_dir = os.environ["TVM_CACHE_DIR"]
+    elif "XDG_CACHE_HOME" in os.environ:
+        cache_dir = os.path.join(os.environ["XDG_CACHE_HOME"], "tvm")
+    else:
+        cache_dir = os.path.join(os.path.expanduser("~"), ".cache", "tvm")
+    cache_dir = os.path.join(cache_dir, "nvcc")
+    try:
+        os.makedirs(cache_dir, exist_ok=True)
+    except OSError:
+        return None
+    key = hashlib.sha256(("\0".join([code] + cmd)).encode("utf-8")).hexdigest()
+    return os.path.join(cache_dir, "%s.%s" % (key, target))
+
+
 def compile_cuda(code,
                  target="ptx",
                  arch=None,
@@ -51,6 +73,11 @@ def compile_cuda(code,
     path_target : str, optional
         Output file.
 
+    With TVM_CUDA_KERNEL_CACHE set to 1 and no output file, the output
+    is kept in the nvcc directory of the TVM cache directory, keyed by
+    the hash of the code and the options, and the code is compiled
+    only once.
+
     Return
     ------
     cubin : bytearray
@@ -91,6 +118,13 @@ def compile_cuda(code,
         else:
             raise ValueError("options must be str or list of str")
 
+    cache_file = None if path_target else _cache_file(code, cmd, target)
+    if cache_file and os.path.isfile(cache_file):
+        with open(cache_file, "rb") as f:
+            data = bytearray(f.read())
+        if data:
+            return data
+
     cmd += ["-o", file_target]
     cmd += [temp_code]
 
@@ -118,6 +152,13 @@ def compile_cuda(code,
     if not data:
         raise RuntimeError(
             "Compilation error: empty result is generated")
+    if cache_file:
+        # Renamed into place, so that concurrent builds never read a
+        # partial file.
+        temp_cache = "%s.tmp%d_%d" % (cache_file, os.getpid(), threading.get_ident())
+        with open(temp_cache, "wb") as f:
+            f.write(data)
+        os.replace(temp_cache, cache_file)
     return data
 
 def find_cuda_path():
@@ -0,0 +1,134 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Continuous batching of sequence requests for ragged kernels.
+
+The scheduler admits requests into the slots of a fixed size batch
+under a token budget, and calls a step function, which runs the prelude
+and kernels of a model, once per step until every request is done:
+
+.. code-block:: python
+
+  def step(lengths, changed_rows, deltas):
+      graph.run([(name, [x, lengths, out]) for name in layers])
+
+  sched = ragged_scheduler.create(32, 4096, step, tvm.gpu(0))
+  sched.register_prefix_sum(row_offsets, 0)
+  sched.add_request(0, prompt_len=17, max_new_tokens=64)
+  while sched.step() > 0:
+      done = sched.pop_retired()
+"""
+import tvm._ffi
+
+
+def create(max_batch_size, token_budget, step_fn, ctx=None):
+    """Create a scheduler.
+
+    Parameters
+    ----------
+    max_batch_size : int
+        The number of slots of the batch
+
+    token_budget : int
+        The largest sum of lengths that admitting a request may lead to
+
+    step_fn : function(lengths, changed_rows, deltas)
+        Runs a step on the batch. lengths holds the int32 length of
+        every slot, 0 for free slots, and changed_rows and deltas the
+        slots whose lengths changed since the last step and by how much.
+
+    ctx : TVMContext, optional
+        The context of the lengths passed to step_fn. The host by default.
+
+    Returns
+    -------
+    scheduler : RaggedBatchScheduler
+    """
+    fcreate = tvm._ffi.get_global_func("tvm.ragged_batch_scheduler.create")
+    if ctx is None:
+        return RaggedBatchScheduler(fcreate(max_batch_size, token_budget, step_fn))
+    return RaggedBatchScheduler(fcreate(max_batch_size, token_budget, step_fn,
+                                        ctx.device_type, ctx.device_id))
+
+
+class RaggedBatchScheduler(object):
+    """Wrapper of the scheduler runtime module.
+
+    Parameters
+    ----------
+    module : tvm.runtime.Module
+        The internal tvm module that holds the actual scheduler.
+    """
+    def __init__(self, module):
+        self.module = module
+        self._add_request = module["add_request"]
+        self._finish = module["finish"]
+        self._step = module["step"]
+        self._register_prefix_sum = module["register_prefix_sum"]
+        self._get_slot_ids = module["get_slot_ids"]
+        self._pop_retired = module["pop_retired"]
+        self._num_waiting = module["num_waiting"]
+
+    def add_request(self, request_id, prompt_len, max_new_tokens):
+        """Queue a request of prompt_len tokens that generates up to
+        max_new_tokens tokens."""
+        self._add_request(request_id, prompt_len, max_new_tokens)
+
+    def finish(self, request_id):
+        """Retire a request at the next step, for instance after it
+        generated an end of sequence token."""
+        self._finish(request_id)
+
+    def step(self):
+        """Retire the done sequences, admit waiting requests and run the
+        step function.
+
+        Returns
+        -------
+        num_active : int
+            The number of sequences in the batch, 0 once all requests
+            are done.
+        """
+        return self._step()
+
+    def register_prefix_sum(self, aux, elem_offset):
+        """Patch a prefix sum array over the lengths of the slots before
+        every step instead of recomputing it, see
+        :py:func:`tvm.runtime.module.patch_ragged_prefix_sum`. The array must
+        be zero, as the lengths are, before the first step.
+
+        Parameters
+        ----------
+        aux : NDArray
+            The int32 auxiliary buffer that holds the array
+
+        elem_offset : int
+            The offset of the array in aux
+        """
+        self._register_prefix_sum(aux, elem_offset)
+
+    def get_slot_ids(self):
+        """The request in every slot, -1 for free slots."""
+        return self._get_slot_ids()
+
+    def pop_retired(self):
+        """The requests retired since the last call."""
+        return self._pop_retired()
+
+    @property
+    def num_waiting(self):
+        """The number of requests not admitted yet."""
+        return self._num_waiting()
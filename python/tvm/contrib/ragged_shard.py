@@ -0,0 +1,159 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Sharding of ragged batches across devices.
+
+A ragged batch is split into contiguous ranges of sequences, one per
+device, that hold about the same number of tokens (the prefix sums of
+the lengths) rather than the same number of sequences. Each device
+runs the function on its range, computing the prelude of its own
+lengths, and the outputs are gathered back into one batch:
+
+.. code-block:: python
+
+    mod = tvm.build(s, [x, lengths, out], "cuda")
+    f = tvm.contrib.ragged_shard.ShardedFunction(
+        mod.entry_func, [tvm.gpu(i) for i in range(4)],
+        arg_kinds=['batch', 'lengths', 'batch'], num_outputs=1)
+    out_np = f(x_np, lengths_np, out_np)
+"""
+import numpy as np
+
+from .. import runtime
+
+
+def balance_tokens(lengths, num_parts):
+    """Split sequences into contiguous ranges of balanced token counts.
+
+    The ranges minimize the largest number of tokens in a range.
+
+    Parameters
+    ----------
+    lengths : array_like of int
+        The lengths of the sequences of the batch
+
+    num_parts : int
+        The number of ranges
+
+    Returns
+    -------
+    ranges : list of (int, int)
+        The [begin, end) sequence range of each part. Trailing ranges
+        may be empty when there are fewer sequences than parts.
+    """
+    lengths = np.asarray(lengths, dtype='int64')
+    prefix = np.concatenate([[0], np.cumsum(lengths)])
+
+    def _split(capacity):
+        # Greedily fill each range up to capacity tokens.
+        bounds = [0]
+        while bounds[-1] < len(lengths) and len(bounds) <= num_parts:
+            limit = prefix[bounds[-1]] + capacity
+            end = int(np.searchsorted(prefix, limit, side='right')) - 1
+            bounds.append(max(end, bounds[-1] + 1))
+        return bounds
+
+    # Binary search the smallest capacity that fits in num_parts ranges.
+    lo = int(lengths.max()) if lengths.size else 0
+    hi = int(prefix[-1])
+    while lo < hi:
+        mid = (lo + hi) // 2
+        if _split(mid)[-1] >= len(lengths):
+            hi = mid
+        else:
+            lo = mid + 1
+    bounds = _split(lo)
+    bounds += [len(lengths)] * (num_parts + 1 - len(bounds))
+    return [(bounds[i], bounds[i + 1]) for i in range(num_parts)]
+
+
+class ShardedFunction(object):
+    """A function run on several devices, each on a range of the
+    sequences of a ragged batch.
+
+    Parameters
+    ----------
+    func : PackedFunc or list of PackedFunc
+        The function, such as the entry function of a built module, or
+        one function per device, such as wrappers around the graph
+        runtime modules created on each device. Outputs are passed as
+        the last arguments, as for built functions.
+
+    ctxs : list of TVMContext
+        The devices
+
+    arg_kinds : list of str
+        How each argument is split: 'lengths' for the lengths of the
+        sequences, 'batch' for tensors whose first axis is the
+        sequence, 'tokens' for packed ragged tensors whose first axis
+        is the token, and 'replicate' for tensors, such as weights,
+        that each device gets a copy of.
+
+    num_outputs : int
+        The number of trailing arguments that are outputs.
+    """
+    def __init__(self, func, ctxs, arg_kinds, num_outputs=1):
+        if 'lengths' not in arg_kinds:
+            raise ValueError("One of the arguments should be the lengths")
+        self.funcs = func if isinstance(func, (list, tuple)) else [func] * len(ctxs)
+        self.ctxs = ctxs
+        self.arg_kinds = arg_kinds
+        self.num_outputs = num_outputs
+        # The replicated arguments are only copied when they change.
+        self._replicated = {}
+
+    def _slice(self, idx, arg, begin, end, token_begin, token_end, ctx):
+        kind = self.arg_kinds[idx]
+        if kind == 'replicate':
+            key = (idx, ctx.device_type, ctx.device_id)
+            cached = self._replicated.get(key)
+            if cached is None or cached[0] is not arg:
+                cached = (arg, runtime.ndarray.array(arg, ctx))
+                self._replicated[key] = cached
+            return cached[1]
+        if kind in ('batch', 'lengths'):
+            return runtime.ndarray.array(np.ascontiguousarray(arg[begin:end]), ctx)
+        if kind == 'tokens':
+            return runtime.ndarray.array(np.ascontiguousarray(arg[token_begin:token_end]), ctx)
+        raise ValueError("Unknown argument kind " + kind)
+
+    def __call__(self, *args):
+        """Run the function on the numpy arrays args, and return the
+        outputs gathered from the devices."""
+        if len(args) != len(self.arg_kinds):
+            raise ValueError("Expected %d arguments" % len(self.arg_kinds))
+        lengths = np.asarray(args[self.arg_kinds.index('lengths')])
+        prefix = np.concatenate([[0], np.cumsum(lengths)])
+        ranges = balance_tokens(lengths, len(self.ctxs))
+
+        shards = []
+        for (begin, end), func, ctx in zip(ranges, self.funcs, self.ctxs):
+            if begin == end:
+                continue
+            nd_args = [self._slice(i, arg, begin, end, int(prefix[begin]), int(prefix[end]), ctx)
+                       for i, arg in enumerate(args)]
+            # Launches are asynchronous, so the devices run concurrently.
+            func(*nd_args)
+            shards.append((ctx, nd_args[len(args) - self.num_outputs:]))
+
+        outputs = []
+        for i in range(self.num_outputs):
+            parts = []
+            for ctx, outs in shards:
+                ctx.sync()
+                parts.append(outs[i].asnumpy())
+            outputs.append(np.concatenate(parts, axis=0))
+        return outputs[0] if self.num_outputs == 1 else outputs
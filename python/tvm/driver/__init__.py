@@ -15,4 +15,7 @@
 # specific language governing permissions and limitations
 # under the License.
 """Namespace for driver APIs"""
-from .build_module import lower, build
+from .build_module import lower, build, build_multiversioned, build_shared_prelude, \
+    build_dense_fast_path, build_respecializing
+from .memory_footprint import estimate_memory_footprint, MemoryFootprint
+from .roofline import count_work, WorkCount, RooflineReport
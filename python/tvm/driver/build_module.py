@@ -19,11 +19,16 @@
 This module provides the functions to transform schedule to
 LoweredFunc and compiled Module.
 """
+import collections
+import functools
+import threading
 import warnings
 
 import tvm.tir
 
 from tvm.runtime import ndarray
+from tvm.runtime.stream import Stream
+from tvm.runtime.object import ObjectPool
 from tvm.ir import container
 from tvm.target import codegen, BuildConfig
 from tvm.tir import ir_pass
@@ -32,6 +37,8 @@ from tvm.tir.stmt import LoweredFunc
 from tvm.te import tensor
 from tvm.te import schedule
 from tvm import target as _target
+from . import compile_cache
+from .compile_profiler import span
 
 
 def get_binds(sch, args, compact=False, binds=None):
@@ -123,15 +130,35 @@ def form_body(sch, distinct_device, afuns_for):
     # normalize schedule first
     sch = sch.normalize()
     # print("[TVM] Made schedule")
-    bounds = schedule.InferBound(sch)
+    with span("InferBound"):
+        bounds = schedule.InferBound(sch)
+    if cfg.diagnose_ragged_bounds:
+        for diagnostic in schedule.diagnose_ragged_bounds(sch, bounds):
+            warnings.warn("Dense bound: %s" % diagnostic)
     # print("[TVM] Inferred bounds")
-    stmt = schedule.ScheduleOps(sch, bounds, False, distinct_device,
-                                cfg.fill_in_function_bodies, afuns_for)
+    with span("ScheduleOps") as set_result:
+        stmt = schedule.ScheduleOps(sch, bounds, False, distinct_device,
+                                    cfg.fill_in_function_bodies, afuns_for,
+                                    cfg.prep_code_on_device, cfg.fused_maps_on_the_fly,
+                                    cfg.schedule_ops_threads)
+        set_result(stmt)
     # print("[TVM] Lowered code")
     stmt = ir_pass.InjectPrefetch(stmt)
     return stmt
 
 
+def _pool_ir_nodes(func):
+    """Run func in an ObjectPool when the pool_ir_nodes option is set."""
+    @functools.wraps(func)
+    def wrapped(*args, **kwargs):
+        if not BuildConfig.current().pool_ir_nodes:
+            return func(*args, **kwargs)
+        with ObjectPool():
+            return func(*args, **kwargs)
+    return wrapped
+
+
+@_pool_ir_nodes
 def lower(sch,
           args,
           target,
@@ -195,6 +222,8 @@ def lower(sch,
     # Phase 0
     if isinstance(sch, schedule.Schedule):
         stmt = form_body(sch, target != "c" and target != "llvm", afuns_for)
+    if cfg.intern_exprs:
+        stmt = ir_pass.InternExprs(stmt)
     # exit(0)
 
     for f in lower_phase0:
@@ -208,6 +237,10 @@ def lower(sch,
     # if simple_mode: print(stmt)
     # exit(0)
     stmt = ir_pass.StorageFlatten(stmt, binds, 64, cfg.instrument_bound_checkers)
+    if cfg.fused_maps_on_the_fly:
+        stmt = ir_pass.LowerFusedMapSearch(stmt)
+    if cfg.intern_exprs:
+        stmt = ir_pass.InternExprs(stmt)
     # stmt = ir_pass.CanonicalSimplify(stmt)
     for f in lower_phase1:
         stmt = f(stmt)
@@ -219,6 +252,7 @@ def lower(sch,
     # if not simple_mode:
         # stmt = ir_pass.LoopPartition(stmt, cfg.partition_const_loop)
 
+    stmt = ir_pass.RaggedTileLoops(stmt)
     stmt = ir_pass.RemoveLikelyTags(stmt)
 
     # print(stmt)
@@ -231,8 +265,13 @@ def lower(sch,
     else:
         stmt = ir_pass.VectorizeLoop(stmt)
     stmt = ir_pass.InjectVirtualThread(stmt)
-    stmt = ir_pass.InjectDoubleBuffer(stmt, cfg.double_buffer_split_loop)
+    stmt = ir_pass.InjectDoubleBuffer(stmt, cfg.double_buffer_split_loop,
+                                      cfg.double_buffer_async_copy)
     stmt = ir_pass.StorageRewrite(stmt)
+    if cfg.ragged_arena_allocation:
+        stmt = ir_pass.PlanRaggedArena(stmt)
+    if cfg.auto_unroll_max_ragged_extent > 0:
+        stmt = ir_pass.UnrollRaggedLoop(stmt, cfg.auto_unroll_max_ragged_extent)
     stmt = ir_pass.UnrollLoop(
         stmt,
         cfg.auto_unroll_max_step,
@@ -245,6 +284,10 @@ def lower(sch,
     # Phase 3
     stmt = ir_pass.Simplify(stmt)
     stmt = ir_pass.RemoveNoOp(stmt)
+    if cfg.indirect_prefetch_distance > 0:
+        stmt = ir_pass.InjectIndirectPrefetch(stmt, cfg.indirect_prefetch_distance)
+    if cfg.eliminate_common_subexpr:
+        stmt = ir_pass.EliminateCommonSubexpr(stmt)
     if not cfg.disable_select_rewriting:
         stmt = ir_pass.RewriteUnsafeSelect(stmt)
     for f in lower_phase3:
@@ -257,7 +300,7 @@ def lower(sch,
     # Adding this pass here results in incorrect optimizations being
     # applied. Disabling for now
     # stmt = ir_pass.HoistIfThenElse(stmt)
-    stmt = ir_pass.ExpandIntrinsicITE(stmt)
+    stmt = ir_pass.ExpandIntrinsicITE(stmt, target != "c" and target != "llvm")
 
     if substitutes and not substitute_after_hfuse:
         print('Lowering substitute')
@@ -279,19 +322,33 @@ def lower(sch,
     # Remove duplicates
     arg_list = [list(dict.fromkeys(l)) for l in arg_list]
     if cfg.prep_code_mode == "with_prep_code":
-        make_api_result = ir_pass.MakeAPIWithPrepCode(stmt, name, arg_list[0], arg_list[1], 0, cfg.restricted_func)
+        make_api_result = ir_pass.MakeAPIWithPrepCode(stmt, name, arg_list[0], arg_list[1], 0, cfg.restricted_func, cfg.instrument_prep_code)
+    elif cfg.prep_code_mode == "with_cached_prep_code":
+        make_api_result = ir_pass.MakeAPIWithCachedPrepCode(stmt, name, arg_list[0], arg_list[1], 0, cfg.restricted_func, cfg.instrument_prep_code)
     elif cfg.prep_code_mode == "no_prep_code":
-        make_api_result = ir_pass.MakeAPINoPrepCode(stmt, name, arg_list[0], arg_list[1], 0, cfg.restricted_func)
+        make_api_result = ir_pass.MakeAPINoPrepCode(stmt, name, arg_list[0], arg_list[1], 0, cfg.restricted_func, cfg.instrument_prep_code)
     elif cfg.prep_code_mode == "only_prep_code":
-        make_api_result = ir_pass.MakeAPIOnlyPrepCode(stmt, name, arg_list[0], arg_list[1], 0, cfg.restricted_func)
+        make_api_result = ir_pass.MakeAPIOnlyPrepCode(stmt, name, arg_list[0], arg_list[1], 0, cfg.restricted_func, cfg.instrument_prep_code)
+    elif cfg.prep_code_mode == "external_prep_code":
+        make_api_result = ir_pass.MakeAPIExternalPrepCode(stmt, name, arg_list[0], arg_list[1], 0, cfg.restricted_func, cfg.instrument_prep_code)
+    elif cfg.prep_code_mode == "fused_prep_code":
+        make_api_result = ir_pass.MakeAPIFusedPrepCode(stmt, name, arg_list[0], arg_list[1], 0, cfg.restricted_func, cfg.instrument_prep_code)
     else:
         raise ValueError("No such prep_code_mode: " + prep_code_mode)
 
     return make_api_result
 
+def _branch_profile_map(profile):
+    """Convert a branch profile of one function to the Map of IntImm
+    to FloatImm BetterHoistIfThenElse takes. Python ints cannot be Map
+    keys as they are."""
+    return {tvm.tir.IntImm("int32", int(index)): tvm.tir.FloatImm("float64", float(prob))
+            for index, prob in profile.items()}
+
+
 def _build_for_device(flist, target, target_host, constraints=[],
                       cuda_syncs=None, substitute_after_hfuse=False,
-                      substitutes=None):
+                      substitutes=None, branch_profile=None):
     """Build the lowered functions for a device with the given compilation
     target.
 
@@ -306,6 +363,9 @@ def _build_for_device(flist, target, target_host, constraints=[],
     target_host : str or :any:`tvm.target.Target`
         The host compilation target.
 
+    branch_profile : dict of str to dict of int to float, optional
+        See build.
+
     Returns
     -------
     fhost : list of LoweredFunc
@@ -330,6 +390,13 @@ def _build_for_device(flist, target, target_host, constraints=[],
                 # print(func.body)
             func = ir_pass.ThreadSync(func, "shared", target.target_name)
             func = ir_pass.ThreadSync(func, "warp", target.target_name)
+            # These see the barriers ThreadSync inserts.
+            if BuildConfig.current().ragged_scan_early_exit:
+                func = ir_pass.RaggedScanEarlyExitFunc(func)
+            if BuildConfig.current().persistent_ragged_blocks > 0:
+                func = ir_pass.PersistentRaggedBlocksFunc(
+                    func, BuildConfig.current().persistent_ragged_blocks,
+                    BuildConfig.current().persistent_ragged_chunk)
             func = ir_pass.CreateEnvLoopsForFunc(func, target.target_name)
             func = ir_pass.InferFragment(func)
             warp_size = target.thread_warp_size
@@ -338,7 +405,13 @@ def _build_for_device(flist, target, target_host, constraints=[],
             cuda_syncs = "" if cuda_syncs == None else cuda_syncs
             ############################################################
             func = ir_pass.RemoveProducerConsumerNodes(func)
-            func = ir_pass.BetterHoistIfThenElse(func, target.target_name, constraints)
+            if BuildConfig.current().partition_ragged_loops:
+                func = ir_pass.RaggedLoopPartition(func, constraints)
+            if branch_profile and func.name in branch_profile:
+                func = ir_pass.BetterHoistIfThenElse(func, target.target_name, constraints,
+                                                     _branch_profile_map(branch_profile[func.name]))
+            else:
+                func = ir_pass.BetterHoistIfThenElse(func, target.target_name, constraints)
             # print(func.body)
             # exit(0)
             func = ir_pass.HorizontalFuse(func)
@@ -348,6 +421,9 @@ def _build_for_device(flist, target, target_host, constraints=[],
                 # print(func.body)
             # exit(0)
             ############################################################
+            if BuildConfig.current().instrument_block_cycles and \
+               target.target_name in ("cuda", "nvptx"):
+                func = ir_pass.InstrumentBlockCycles(func, device_type)
             fsplits = list(ir_pass.SplitHostDevice(func, cuda_syncs))
             fhost.append(fsplits[0])
             for x in fsplits[1:]:
@@ -368,6 +444,8 @@ def _build_for_device(flist, target, target_host, constraints=[],
             "Specified target %s, but cannot find device code, did you do "
             "bind?" % target)
 
+    if BuildConfig.current().fast_call_api:
+        fhost += [ir_pass.MakeFastCall(x) for x in fhost if x.is_packed_func]
     fhost = [ir_pass.BindDeviceType(x, device_type) for x in fhost]
     fhost = [ir_pass.LowerTVMBuiltin(x) for x in fhost]
 
@@ -396,7 +474,8 @@ def _build_for_device(flist, target, target_host, constraints=[],
     # print("# HOST ##############################\n", fhost[0].body)
     # print("# DEVICE ##############################\n", fdevice[0].body)
     # exit(0)
-    mdev = codegen.build_module(fdevice, str(target)) if fdevice else None
+    with span("codegen.device"):
+        mdev = codegen.build_module(fdevice, str(target)) if fdevice else None
 
     return fhost, mdev
 
@@ -410,7 +489,9 @@ def build(inputs,
           substitutes=None,
           substitute_after_hfuse=False,
           constraints=[],
-          cuda_syncs=None):
+          cuda_syncs=None,
+          branch_profile=None,
+          cache_dir=None):
     """Build a function with arguments as signature. Code will be generated
     for devices coupled with target information.
 
@@ -432,7 +513,10 @@ def build(inputs,
         setup the dimensions and parameters correctly.
         target_host is used to specify the host side codegen target.
         By default, llvm is used if it is enabled,
-        otherwise a stackvm intepreter is used.
+        otherwise a stackvm intepreter is used. On hosts without
+        llvm, "c" generates C for the host code, such as the ragged
+        prelude, which export_library compiles ahead of time and
+        which runs much faster than stackvm.
 
     name : str, optional
         The name of result function.
@@ -441,6 +525,23 @@ def build(inputs,
         Dictionary that maps the binding of symbolic buffer to Tensor.
         By default, a new buffer is created for each tensor in the argument.
 
+    branch_profile : dict of str to dict of int to float, optional
+        Observed probabilities, by function name, that the conditions
+        of the branches of the function are true, as collected by an
+        instrumented build. Branches are numbered in pre-order of the
+        function body as given to BetterHoistIfThenElse. The profile
+        decides the fall-through side of branches and marks rarely
+        taken ones, such as ragged tails, as cold. The branch numbers
+        and probabilities are plain Python ints and floats, which are
+        converted to IntImm and FloatImm before being passed on.
+
+    cache_dir : str, optional
+        A directory of modules built from schedules, see
+        tvm.driver.compile_cache. When inputs is a schedule built
+        before, with the same arguments, BuildConfig and targets, the
+        module is loaded from there, skipping lowering and code
+        generation. Otherwise the built module is saved there.
+
     Returns
     -------
     ret : tvm.module
@@ -481,6 +582,21 @@ def build(inputs,
     ----
     See the note on :any:`tvm.target` on target string format.
     """
+    if cache_dir is not None and isinstance(inputs, schedule.Schedule):
+        key = compile_cache.cache_key(inputs, target, target_host, args=args, name=name,
+                                      binds=binds, substitutes=substitutes,
+                                      substitute_after_hfuse=substitute_after_hfuse,
+                                      constraints=constraints, cuda_syncs=cuda_syncs,
+                                      branch_profile=branch_profile)
+        if key is not None:
+            cached = compile_cache.load(cache_dir, key)
+            if cached is not None:
+                return cached
+            ret = build(inputs, args, target, target_host, name, binds, substitutes,
+                        substitute_after_hfuse, constraints, cuda_syncs, branch_profile)
+            compile_cache.save(cache_dir, key, *ret)
+            return ret
+
     intermediate_buffers = None
     if isinstance(inputs, schedule.Schedule):
         if args is None:
@@ -547,16 +663,555 @@ def build(inputs,
                                         constraints=constraints,
                                         cuda_syncs=cuda_syncs,
                                         substitutes=substitutes,
-                                        substitute_after_hfuse=substitute_after_hfuse)
+                                        substitute_after_hfuse=substitute_after_hfuse,
+                                        branch_profile=branch_profile)
         # Save the current lowered functions of the host and the device module.
         fhost_all += fhost
         device_modules.append(mdev)
 
     # Generate a unified host module.
-    mhost = codegen.build_module(fhost_all, str(target_host))
+    with span("codegen.host"):
+        mhost = codegen.build_module(fhost_all, str(target_host))
 
     # Import all modules.
     for mdev in device_modules:
         if mdev:
             mhost.import_module(mdev)
     return mhost, intermediate_buffers
+
+
+def _length_stats(lengths):
+    """Max and mean of a length array given as a list, numpy array or
+    NDArray."""
+    if isinstance(lengths, ndarray.NDArray):
+        lengths = lengths.asnumpy()
+    lengths = [int(l) for l in lengths]
+    if not lengths:
+        return 0.0, 0.0
+    return float(max(lengths)), float(sum(lengths)) / len(lengths)
+
+
+# The fixed cost of a tile, in elements: the loop, index and
+# synchronization work every tile pays regardless of its size.
+_TILE_OVERHEAD = 32
+
+
+def _padding_cost(config, lengths):
+    """Default variant cost, in elements of work per actual element:
+    every length is padded up to the variant's tile multiple, and every
+    tile also pays a fixed overhead. Small tiles waste less on padding
+    but pay the overhead more often, so long lengths favor large tiles
+    and short ones small tiles."""
+    tile = int(config.get("tile", 1))
+    lengths = [int(l) for l in lengths]
+    total = sum(lengths)
+    num_tiles = sum((l + tile - 1) // tile for l in lengths)
+    return float(num_tiles * (tile + _TILE_OVERHEAD)) / max(total, 1)
+
+
+class MultiVersionedFunction(object):
+    """A set of variants of one ragged kernel along with a dispatcher
+    that picks a variant from the max and mean of a length array.
+
+    Each variant is represented by the (max, mean) length statistics of
+    the representative histograms it was selected for. At call time the
+    variant with the nearest statistics is run.
+    """
+    def __init__(self, name, variants):
+        self.name = name
+        # List of (config, module, intermediate_buffers, [(max, mean)])
+        self.variants = variants
+
+    def select(self, lengths):
+        """Return the index of the variant to run for lengths."""
+        lmax, lmean = _length_stats(lengths)
+        best, best_dist = 0, None
+        for i, (_, _, _, stats) in enumerate(self.variants):
+            for smax, smean in stats:
+                dist = (abs(lmax - smax) / max(smax, 1.0) +
+                        abs(lmean - smean) / max(smean, 1.0))
+                if best_dist is None or dist < best_dist:
+                    best, best_dist = i, dist
+        return best
+
+    def get_variant(self, lengths):
+        """Return the (config, module, intermediate_buffers) of the
+        variant selected for lengths."""
+        config, module, intermediate_buffers, _ = self.variants[self.select(lengths)]
+        return config, module, intermediate_buffers
+
+    def __call__(self, lengths, *args):
+        _, module, _ = self.get_variant(lengths)
+        return module[self.name](*args)
+
+
+def build_multiversioned(make_schedule,
+                         configs,
+                         histograms,
+                         target=None,
+                         target_host=None,
+                         name="default_function",
+                         cost=None,
+                         **kwargs):
+    """Build several variants of a ragged kernel, specialized for a few
+    representative length distributions, and a dispatcher choosing
+    between them at call time.
+
+    Parameters
+    ----------
+    make_schedule : function of config -> (Schedule, list of args)
+        Creates the schedule and argument list for one variant. A config
+        is a dict, typically holding the tile sizes and padding
+        decisions (e.g. the tile factors of a tiled storage layout) to
+        use for the ragged dimensions.
+
+    configs : list of dict
+        Candidate variant configurations.
+
+    histograms : list of list of int
+        Representative length arrays. For each one, the candidate of
+        minimum cost is selected, and only selected candidates are built.
+
+    cost : function of (config, lengths) -> float, optional
+        Cost of running a candidate on lengths. By default the padding
+        implied by the "tile" entry of the config is used, along with a
+        fixed overhead per tile.
+
+    The remaining arguments are passed on to :any:`build`.
+
+    Returns
+    -------
+    ret : MultiVersionedFunction
+        Callable as ret(lengths, *args).
+    """
+    if not configs:
+        raise ValueError("At least one variant configuration is needed")
+    if not histograms:
+        raise ValueError("At least one representative length histogram is needed")
+    cost = _padding_cost if cost is None else cost
+
+    selected = {}
+    for lengths in histograms:
+        idx = min(range(len(configs)), key=lambda i: cost(configs[i], lengths))
+        selected.setdefault(idx, []).append(_length_stats(lengths))
+
+    variants = []
+    for idx in sorted(selected):
+        sch, args = make_schedule(configs[idx])
+        module, intermediate_buffers = build(sch, args, target, target_host,
+                                             name=name, **kwargs)
+        variants.append((configs[idx], module, intermediate_buffers, selected[idx]))
+    return MultiVersionedFunction(name, variants)
+
+
+class DenseFastPathFunction(object):
+    """A ragged kernel along with a dense variant specialized for one
+    common length, run when all the lengths of a call are equal to it.
+    """
+    def __init__(self, name, dense_module, ragged_module, common_length,
+                 intermediate_buffers):
+        self.name = name
+        self.dense_module = dense_module
+        self.ragged_module = ragged_module
+        self.common_length = common_length
+        # The intermediate buffers of the ragged variant, as returned by build
+        self.intermediate_buffers = intermediate_buffers
+
+    def is_dense(self, lengths):
+        """Whether the dense variant runs for lengths."""
+        if isinstance(lengths, ndarray.NDArray):
+            lengths = lengths.asnumpy()
+        return all(int(l) == self.common_length for l in lengths)
+
+    def __call__(self, lengths, *args):
+        module = self.dense_module if self.is_dense(lengths) else self.ragged_module
+        return module[self.name](*args)
+
+
+def build_dense_fast_path(make_schedule, common_length, target=None, target_host=None,
+                          name="default_function", **kwargs):
+    """Build a ragged kernel and a dense variant of it specialized for a
+    common length, for traffic whose lengths are mostly the same, such
+    as fixed size classification inputs. The dense variant has neither
+    a prelude nor indirect accesses.
+
+    Parameters
+    ----------
+    make_schedule : function of int or None -> (Schedule, list of args)
+        Creates the schedule and argument list of the kernel, with all
+        lengths equal to the given length, or ragged for None. Both
+        variants must take the same arguments.
+
+    common_length : int
+        The length to specialize the dense variant for.
+
+    The remaining arguments are passed on to :any:`build`.
+
+    Returns
+    -------
+    ret : DenseFastPathFunction
+        Callable as ret(lengths, *args). lengths is checked on the host,
+        so it should be a list or a host array.
+    """
+    sch, args = make_schedule(int(common_length))
+    dense_module, _ = build(sch, args, target, target_host, name=name, **kwargs)
+    sch, args = make_schedule(None)
+    ragged_module, intermediate_buffers = build(sch, args, target, target_host, name=name,
+                                                **kwargs)
+    return DenseFastPathFunction(name, dense_module, ragged_module, int(common_length),
+                                 intermediate_buffers)
+
+
+class RespecializingFunction(object):
+    """A ragged kernel that recompiles itself, in the background, with
+    the max length of recent calls baked in as a constant, and runs the
+    specialized kernel while the lengths stay within that max.
+
+    The max lengths of the last window calls are observed. Once the
+    window is full, a variant for their max, rounded up to a multiple of
+    granularity, is built on a background thread, unless the current
+    variant already covers it and is not more than twice as large. Calls
+    run the generic kernel until the variant is ready, and whenever
+    their lengths exceed it.
+    """
+    def __init__(self, name, make_schedule, generic_module, intermediate_buffers,
+                 build_kwargs, window, granularity):
+        self.name = name
+        self.make_schedule = make_schedule
+        self.generic_module = generic_module
+        # The intermediate buffers of the generic variant, as returned by build
+        self.intermediate_buffers = intermediate_buffers
+        self.window = window
+        self.granularity = granularity
+        self._build_kwargs = build_kwargs
+        self._config = BuildConfig.current()
+        self._maxes = collections.deque(maxlen=window)
+        self._lock = threading.Lock()
+        self._pending = None
+        self._failed = set()
+        # Map of max length to the module specialized for it
+        self.modules = {}
+        # The max length of the variant in use, or None for the generic one
+        self.max_length = None
+
+    def _bound(self):
+        max_length = int(max(self._maxes))
+        return max(-(-max_length // self.granularity) * self.granularity, self.granularity)
+
+    def _build(self, bound):
+        try:
+            with self._config:
+                sch, args = self.make_schedule(bound)
+                module, _ = build(sch, args, name=self.name, **self._build_kwargs)
+        except Exception as err:  # pylint: disable=broad-except
+            warnings.warn("Specializing %s for max length %d failed: %s" %
+                          (self.name, bound, err))
+            with self._lock:
+                self._failed.add(bound)
+                self._pending = None
+            return
+        with self._lock:
+            self.modules[bound] = module
+            self.max_length = bound
+            self._pending = None
+
+    def observe(self, lengths):
+        """Record the max of lengths, and start specializing when the
+        recent maxes call for another variant."""
+        lmax, _ = _length_stats(lengths)
+        with self._lock:
+            self._maxes.append(lmax)
+            if len(self._maxes) < self.window or self._pending is not None:
+                return
+            bound = self._bound()
+            current = self.max_length
+            if current is not None and bound <= current < 2 * bound:
+                return
+            if bound in self.modules:
+                self.max_length = bound
+                return
+            if bound in self._failed:
+                return
+            self._pending = threading.Thread(target=self._build, args=(bound,))
+            self._pending.daemon = True
+            self._pending.start()
+
+    def wait(self):
+        """Wait for the specialization in progress, if any, to finish."""
+        pending = self._pending
+        if pending is not None:
+            pending.join()
+
+    def get_module(self, lengths):
+        """Return the module to run for lengths."""
+        lmax, _ = _length_stats(lengths)
+        with self._lock:
+            max_length = self.max_length
+            if max_length is not None and lmax <= max_length:
+                return self.modules[max_length]
+        return self.generic_module
+
+    def __call__(self, lengths, *args):
+        self.observe(lengths)
+        return self.get_module(lengths)[self.name](*args)
+
+
+def build_respecializing(make_schedule, target=None, target_host=None,
+                         name="default_function", window=32, granularity=8, **kwargs):
+    """Build a ragged kernel that specializes itself at run time for the
+    max length of the lengths it is called with.
+
+    Kernels compiled for a symbolic max length have to be conservative
+    with unrolling, shared memory sizing and register tiling. With the
+    max length a constant, the extents it bounds are constant too, so
+    the specialized kernel gets static shared memory allocations and
+    fully unrolled loops. See :any:`RespecializingFunction` for when a
+    specialization is built and run.
+
+    Parameters
+    ----------
+    make_schedule : function of int or None -> (Schedule, list of args)
+        Creates the schedule and argument list of the kernel, for lengths
+        of at most the given max length, or any lengths for None. All
+        variants must take the same arguments.
+
+    window : int, optional
+        The number of recent calls whose max length is specialized for.
+
+    granularity : int, optional
+        The max lengths specialized for are multiples of granularity,
+        which bounds the number of variants built.
+
+    The remaining arguments are passed on to :any:`build`.
+
+    Returns
+    -------
+    ret : RespecializingFunction
+        Callable as ret(lengths, *args). lengths is checked on the host,
+        so it should be a list or a host array.
+    """
+    if window < 1 or granularity < 1:
+        raise ValueError("window and granularity must be positive")
+    sch, args = make_schedule(None)
+    generic_module, intermediate_buffers = build(sch, args, target, target_host, name=name,
+                                                 **kwargs)
+    build_kwargs = dict(kwargs, target=target, target_host=target_host)
+    return RespecializingFunction(name, make_schedule, generic_module, intermediate_buffers,
+                                  build_kwargs, window, granularity)
+
+
+def _with_prep_code_mode(mode):
+    """A copy of the current build config with another prep_code_mode."""
+    # pylint: disable=protected-access
+    current = BuildConfig.current()
+    kwargs = {k: getattr(current, k) for k in BuildConfig._object_defaults}
+    kwargs["prep_code_mode"] = mode
+    if current.add_lower_pass:
+        kwargs["add_lower_pass"] = current.add_lower_pass
+    return _target.build_config(**kwargs)
+
+
+def _prelude_key(prelude):
+    """Preludes with equal keys compute the same auxiliary arrays into
+    aggregate buffers of the same layout, given the same lengths."""
+    return (tvm.ir.structural_hash(prelude.function.body),
+            tvm.ir.structural_hash(container.Array(list(prelude.aux_buffer_layout))),
+            tvm.ir.structural_hash(container.Array(list(prelude.host_intermediate_buffers))),
+            tvm.ir.structural_hash(container.Array(list(prelude.device_intermediate_buffers))))
+
+
+def _is_cpu_target(target):
+    target = _target.create(target)
+    return ndarray.context(target.target_name, 0).device_type == ndarray.cpu(0).device_type
+
+
+def build_shared_prelude(kernels, target=None, target_host=None, **kwargs):
+    """Build several ragged kernels that are run together, such as the
+    layers of a model, with their prep code hoisted into shared preludes.
+
+    Each kernel is built with prep_code_mode "external_prep_code", and
+    its prep code with "only_prep_code". Kernels whose prep code and
+    auxiliary buffer layouts are structurally equal share a single
+    prelude, built once, whose aggregate buffers they all read. On each
+    run, every prelude is run once instead of once per kernel.
+
+    Kernels may be placed on different targets, for instance to keep
+    cheap ragged bookkeeping on the CPU while the GPU computes. A
+    prelude is built for the target of the kernels that read it, so
+    that the auxiliary arrays of CPU kernels stay on the host and are
+    not copied to the device, and is only shared by kernels on the same
+    target.
+
+    Parameters
+    ----------
+    kernels : list of (Schedule, list of args, str) or (Schedule, list of args, str, target)
+        The schedule, the argument lists, the unique name and optionally
+        the target of each kernel, as passed to :any:`build`. Kernels
+        without a target are built for target.
+
+    The remaining arguments are passed on to :any:`lower`.
+
+    Returns
+    -------
+    ret : SharedPreludeGraph
+        The module along with the preludes of its kernels.
+    """
+    target_funcs = {}
+    kernel_preludes = {}
+    preludes = []
+    prelude_keys = {}
+    for kernel in kernels:
+        sch, args, name = kernel[:3]
+        ktarget = kernel[3] if len(kernel) > 3 and kernel[3] is not None else target
+        ktarget = _target.create(ktarget or _target.Target.current() or "llvm")
+        funcs = target_funcs.setdefault(str(ktarget), [])
+        with _with_prep_code_mode("external_prep_code"):
+            main = lower(sch, args, ktarget.target_name, name=name, **kwargs)
+        funcs.append(main.function)
+        if not main.host_intermediate_buffers and not main.device_intermediate_buffers:
+            kernel_preludes[name] = None
+            continue
+        with _with_prep_code_mode("only_prep_code"):
+            prelude = lower(sch, args, ktarget.target_name, name=name + "_prelude", **kwargs)
+        key = (str(ktarget),) + _prelude_key(prelude)
+        if key not in prelude_keys:
+            prelude_keys[key] = len(preludes)
+            preludes.append((prelude.function.name, name,
+                             list(prelude.host_intermediate_buffers),
+                             list(prelude.device_intermediate_buffers),
+                             _is_cpu_target(ktarget)))
+            funcs.append(prelude.function)
+        kernel_preludes[name] = prelude_keys[key]
+    module, _ = build(target_funcs, target_host=target_host)
+    return SharedPreludeGraph(module, kernel_preludes, preludes)
+
+
+class SharedPreludeGraph(object):
+    """Ragged kernels whose preludes are run once per run of the graph.
+
+    Kernels are called with their tensor and length arguments only. The
+    aggregate buffers of the preludes, which the kernels read their
+    auxiliary arrays from, are appended by :any:`run`.
+    """
+    def __init__(self, module, kernel_preludes, preludes):
+        self.module = module
+        # Kernel name -> index into preludes, or None without prep code
+        self.kernel_preludes = kernel_preludes
+        # List of (prelude name, name of the kernel it was built from,
+        # host aggregate buffers, device aggregate buffers, whether its
+        # kernels are on the CPU)
+        self.preludes = preludes
+        self.aux = None
+        # Indices of the preludes folded for constant lengths
+        self.folded = set()
+        # Prelude index -> event after the last kernel that read its
+        # auxiliary arrays, when run with a prelude stream
+        self._aux_free = {}
+
+    def allocate_aux(self, ctx):
+        """Allocate the aggregate buffers of every prelude once, with the
+        device buffers on ctx, or on the CPU for the preludes of CPU
+        kernels. Their shapes must be constant."""
+        def _empty(buf, buf_ctx):
+            shape = [int(s) for s in buf.get_dense_shape()]
+            return ndarray.empty(shape, buf.dtype, buf_ctx)
+
+        self.aux = []
+        for _, _, host_bufs, dev_bufs, on_cpu in self.preludes:
+            host = [_empty(buf, ndarray.cpu(0)) for buf in host_bufs]
+            dev = []
+            for i, buf in enumerate(dev_bufs):
+                # Without a distinct device, both are the same buffer.
+                same = i < len(host_bufs) and buf.same_as(host_bufs[i])
+                dev.append(host[i] if same else _empty(buf, ndarray.cpu(0) if on_cpu else ctx))
+            self.aux.append(host + dev)
+
+    def fold_constant_lengths(self, calls):
+        """Run the preludes once for lengths that are fixed for the
+        lifetime of the graph, such as those of static attention masks or
+        fixed vocabularies, and skip them in later runs.
+
+        Parameters
+        ----------
+        calls : list of (str, list of args)
+            The kernels whose preludes to fold, with their tensor and
+            length arguments. Only the lengths are read. Later runs must
+            pass the same lengths to these kernels.
+        """
+        if self.aux is None:
+            raise RuntimeError("allocate_aux must be called before fold_constant_lengths")
+        args_of = dict(calls)
+        for i, (prelude_name, kernel_name, _, _, _) in enumerate(self.preludes):
+            if kernel_name in args_of:
+                self.module[prelude_name](*(list(args_of[kernel_name]) + self.aux[i]))
+                self.folded.add(i)
+
+    def run(self, calls, prelude_stream=None):
+        """Run the preludes that are not folded, then the kernels.
+
+        Kernels on a GPU are launched asynchronously, so the CPU
+        kernels that follow them in calls overlap with them.
+
+        The prep code of a prelude waits for the stream it copies its
+        auxiliary arrays on. With a prelude_stream, each prelude is
+        instead run on that stream right before the first kernel that
+        reads it, so that its host computation and copies overlap the
+        kernels launched before, and the kernel waits for it through an
+        event rather than the host.
+
+        Parameters
+        ----------
+        calls : list of (str, list of args)
+            The kernels to run, in order, with their tensor and length
+            arguments. The kernel each prelude was built from must be
+            among them, as the prelude is run with its arguments.
+
+        prelude_stream : tvm.runtime.Stream, optional
+            The stream to pipeline the preludes on, which must not be
+            the current stream of the kernels.
+        """
+        if self.aux is None:
+            raise RuntimeError("allocate_aux must be called before run")
+        args_of = dict(calls)
+        for i, (prelude_name, kernel_name, _, _, _) in enumerate(self.preludes):
+            if i not in self.folded and kernel_name not in args_of:
+                raise ValueError("Prelude %s needs the arguments of kernel %s" %
+                                 (prelude_name, kernel_name))
+
+        def _run_prelude(i):
+            prelude_name, kernel_name = self.preludes[i][:2]
+            self.module[prelude_name](*(list(args_of[kernel_name]) + self.aux[i]))
+
+        if prelude_stream is None:
+            for i in range(len(self.preludes)):
+                if i not in self.folded:
+                    _run_prelude(i)
+            for name, args in calls:
+                idx = self.kernel_preludes[name]
+                aux = [] if idx is None else self.aux[idx]
+                self.module[name](*(list(args) + aux))
+            return
+
+        ctx = prelude_stream.ctx
+        main = Stream.current(ctx)
+        done = set()
+        last_reader = {}
+        for name, _ in calls:
+            if self.kernel_preludes[name] is not None:
+                last_reader[self.kernel_preludes[name]] = name
+        for name, args in calls:
+            idx = self.kernel_preludes[name]
+            if idx is not None and idx not in done and idx not in self.folded:
+                done.add(idx)
+                with prelude_stream:
+                    # The kernels of the previous run may still read the
+                    # auxiliary arrays.
+                    if idx in self._aux_free:
+                        prelude_stream.wait_event(self._aux_free[idx])
+                    _run_prelude(idx)
+                    ready = prelude_stream.record_event()
+                main.wait_event(ready)
+            aux = [] if idx is None else self.aux[idx]
+            self.module[name](*(list(args) + aux))
+            if idx is not None and last_reader[idx] == name:
+                self._aux_free[idx] = main.record_event()
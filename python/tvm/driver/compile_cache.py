@@ -0,0 +1,120 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""On-disk cache of modules built from schedules.
+
+Built modules are exported as shared libraries into a cache directory,
+keyed by a hash of the serialized schedule and build arguments, the
+current BuildConfig and the targets, along with the intermediate
+buffers of the build. A later build with the same key loads the
+library instead of lowering and generating code again.
+"""
+import hashlib
+import os
+import tempfile
+
+import tvm
+from tvm.ir import load_json, save_json
+from tvm.runtime import convert, load_module
+from tvm.target import BuildConfig
+
+
+def _serialize(value):
+    if value is None or isinstance(value, (bool, int, float, str)):
+        return repr(value)
+    if isinstance(value, dict):
+        return "{" + ",".join(_serialize(k) + ":" + _serialize(value[k])
+                              for k in sorted(value, key=_serialize)) + "}"
+    if isinstance(value, (list, tuple)):
+        return "[" + ",".join(_serialize(v) for v in value) + "]"
+    return save_json(convert(value))
+
+
+def cache_key(sch, target, target_host, **kwargs):
+    """The key of a build of sch, or None if the build cannot be cached.
+
+    Parameters
+    ----------
+    sch : Schedule
+        The schedule to build.
+
+    target : str or Target
+        The target of the build.
+
+    target_host : str or Target
+        The host target of the build.
+
+    kwargs : dict
+        The other arguments to the build, such as the args, binds and
+        constraints. Objects are keyed by their serialized form, so
+        the key is insensitive to when they were created.
+
+    Returns
+    -------
+    key : str or None
+        The key.
+    """
+    cfg = BuildConfig.current()
+    # Custom passes are arbitrary functions, which cannot be keyed.
+    if cfg.add_lower_pass:
+        return None
+    parts = [tvm.__version__, save_json(sch), save_json(cfg), str(target), str(target_host)]
+    try:
+        parts.append(_serialize(kwargs))
+    except (ValueError, tvm.error.TVMError):
+        return None
+    return hashlib.sha256("\n".join(parts).encode("utf-8")).hexdigest()
+
+
+def load(cache_dir, key):
+    """Load the module and intermediate buffers built for key.
+
+    Returns
+    -------
+    ret : tuple of (Module, tuple) or None
+        The module and the host and device intermediate buffers, or
+        None on a miss.
+    """
+    lib_path = os.path.join(cache_dir, key + ".so")
+    buffers_path = os.path.join(cache_dir, key + ".json")
+    if not os.path.exists(lib_path) or not os.path.exists(buffers_path):
+        return None
+    with open(buffers_path) as f:
+        buffers = load_json(f.read())
+    return load_module(lib_path), (buffers[0], buffers[1])
+
+
+def save(cache_dir, key, module, intermediate_buffers):
+    """Save the module and intermediate buffers built for key.
+
+    The files are written to temporaries first and renamed, so that
+    processes concurrently building the same key never load partially
+    written entries.
+    """
+    if not os.path.isdir(cache_dir):
+        os.makedirs(cache_dir, exist_ok=True)
+    lib_path = os.path.join(cache_dir, key + ".so")
+    buffers_path = os.path.join(cache_dir, key + ".json")
+
+    fd, tmp_lib = tempfile.mkstemp(suffix=".so", dir=cache_dir)
+    os.close(fd)
+    module.export_library(tmp_lib)
+    fd, tmp_buffers = tempfile.mkstemp(suffix=".json", dir=cache_dir)
+    with os.fdopen(fd, "w") as f:
+        f.write(save_json(convert(list(intermediate_buffers))))
+    # An entry is complete once its buffers exist, so they go in last.
+    os.replace(tmp_lib, lib_path)
+    os.replace(tmp_buffers, buffers_path)
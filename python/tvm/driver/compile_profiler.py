@@ -0,0 +1,72 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Compile time profiling of the lowering pipeline.
+
+Within a CompileProfiler, every pass run records a span with its wall
+time, the number of IR nodes it returned and the Z3 queries it made.
+The spans are reported as a chrome trace, which can be opened in
+chrome://tracing or Perfetto.
+
+.. code-block:: python
+
+    with tvm.driver.compile_profiler.CompileProfiler() as prof:
+        tvm.build(s, [A, B], "cuda")
+    prof.save("lowering.json")
+"""
+import contextlib
+
+from . import _ffi_api
+
+
+class CompileProfiler(object):
+    """Records the spans of the passes run within its scope.
+
+    Attributes
+    ----------
+    trace : str
+        The chrome trace of the recorded spans, set on exit.
+    """
+    def __init__(self):
+        self.trace = None
+
+    def __enter__(self):
+        _ffi_api.StartPassProfiling()
+        return self
+
+    def __exit__(self, ptype, value, trace):
+        self.trace = _ffi_api.StopPassProfiling()
+
+    def save(self, path):
+        """Save the chrome trace to path."""
+        with open(path, "w") as f:
+            f.write(self.trace)
+
+
+@contextlib.contextmanager
+def span(name):
+    """Record a span for the steps of the pipeline run in its scope.
+
+    The span is recorded only within a CompileProfiler. Its IR size
+    can be set by calling the yielded function with the result of the
+    steps.
+    """
+    result = []
+    _ffi_api.BeginPassSpan(name)
+    try:
+        yield result.append
+    finally:
+        _ffi_api.EndPassSpan(*result[-1:])
@@ -0,0 +1,138 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Estimates of the device memory a ragged kernel needs.
+
+The peak device memory of a ragged kernel depends on the lengths it is
+run with, through the sizes of its ragged intermediate tensors,
+workspaces and auxiliary arrays. The estimate is an expression of the
+inputs of the kernel, that can be evaluated for a length array before
+admitting a batch:
+
+.. code-block:: python
+
+  lowered = tvm.lower(sch, [x, lengths, out], "cuda")
+  footprint = tvm.driver.estimate_memory_footprint(lowered)
+  if footprint.evaluate(arrays={"lengths": batch_lengths}) <= budget:
+      ...
+
+The arguments of the kernel, which the caller allocates, are not
+counted.
+"""
+import numpy as np
+
+from tvm.runtime import ndarray
+from tvm.tir import ir_pass, IntImm
+from tvm.tir.stmt import LoweredFunc
+
+
+class MemoryFootprint(object):
+    """The peak bytes of device memory of a lowered kernel.
+
+    Attributes
+    ----------
+    intermediates : PrimExpr
+        The peak bytes of the global allocations of the kernel, that is
+        its intermediate tensors and workspaces.
+
+    aux : PrimExpr
+        The bytes of the device buffers of its auxiliary arrays.
+    """
+    def __init__(self, intermediates, aux):
+        self.intermediates = intermediates
+        self.aux = aux
+
+    @property
+    def expr(self):
+        """The total peak bytes, as an expression of the inputs."""
+        return ir_pass.Simplify(self.intermediates + self.aux)
+
+    def evaluate(self, scalars=None, arrays=None):
+        """Evaluate the footprint for given inputs.
+
+        Parameters
+        ----------
+        scalars : dict of str to int, optional
+            The values of the shape and scalar variables, by name.
+
+        arrays : dict of str to array_like, optional
+            The integer arrays the sizes read, such as the lengths, by the
+            name of their tensor.
+
+        Returns
+        -------
+        nbytes : int
+        """
+        return evaluate_expr(self.expr, scalars, arrays)
+
+
+def evaluate_expr(expr, scalars=None, arrays=None):
+    """Evaluate an integer expression of the inputs of a kernel.
+
+    Parameters
+    ----------
+    expr : PrimExpr
+        The expression.
+
+    scalars : dict of str to int, optional
+        The values of the shape and scalar variables, by name.
+
+    arrays : dict of str to array_like, optional
+        The integer arrays the expression reads, by the name of their
+        tensor or buffer.
+
+    Returns
+    -------
+    value : int
+    """
+    scalars = {k: IntImm("int64", int(v)) for k, v in (scalars or {}).items()}
+    host_arrays = {}
+    for name, value in (arrays or {}).items():
+        if not isinstance(value, ndarray.NDArray):
+            value = ndarray.array(np.asarray(value))
+        elif value.ctx.device_type != ndarray.cpu(0).device_type:
+            value = value.copyto(ndarray.cpu(0))
+        host_arrays[name] = value
+    ret = ir_pass.BindFootprintInputs(expr, scalars, host_arrays)
+    if not isinstance(ret, IntImm):
+        raise ValueError("The expression depends on inputs that are not given: %s" % ret)
+    return ret.value
+
+
+def estimate_memory_footprint(lowered):
+    """Estimate the peak device memory of a lowered kernel.
+
+    Parameters
+    ----------
+    lowered : LoweredFunc or the result of :any:`lower`
+        The kernel. Its auxiliary arrays are counted only when it is
+        given as returned by lower, along with its intermediate buffers.
+
+    Returns
+    -------
+    footprint : MemoryFootprint
+    """
+    aux = IntImm("int64", 0)
+    if isinstance(lowered, LoweredFunc):
+        func = lowered
+    else:
+        func = lowered.function
+        for buf in lowered.device_intermediate_buffers:
+            nbytes = IntImm("int64", (ndarray.DataType(buf.dtype).bits + 7) // 8)
+            for extent in buf.shape:
+                nbytes = nbytes * extent.astype("int64")
+            aux = aux + nbytes
+    return MemoryFootprint(ir_pass.EstimateMemoryFootprint(func.body), ir_pass.Simplify(aux))
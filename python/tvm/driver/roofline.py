@@ -0,0 +1,205 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Roofline analysis of ragged kernels.
+
+The floating point operations and memory traffic of a ragged kernel
+are counted statically, as expressions of its inputs: loops over the
+ragged dimensions contribute the sum of their lengths rather than the
+padded extent. Evaluated for the lengths of a batch and combined with
+a measured time, they give the fraction of the peak compute and
+bandwidth the kernel achieves:
+
+.. code-block:: python
+
+  lowered = tvm.lower(sch, [x, lengths, out], "cuda")
+  work = tvm.driver.count_work(lowered)
+  func = tvm.build(sch, [x, lengths, out], "cuda")
+  seconds = func.time_evaluator(func.entry_name, ctx)(*nd_args).mean
+  report = work.report(seconds, peak_gflops=15700, peak_gbps=900,
+                       arrays={"lengths": batch_lengths})
+  print(report)
+
+Accesses to the auxiliary arrays the prep code computes are counted
+apart from the other accesses, as are the prep code's own operations,
+which are not counted at all.
+"""
+from tvm.tir import ir_pass
+from tvm.tir.stmt import LoweredFunc
+from .memory_footprint import evaluate_expr
+
+
+class RooflineReport(object):
+    """The achieved throughput of a kernel run.
+
+    Attributes
+    ----------
+    flops : int
+        The floating point operations of the run.
+
+    bytes : int
+        The bytes of global memory the run accessed, other than those
+        of the auxiliary arrays.
+
+    aux_bytes : int
+        The bytes of auxiliary arrays the run read.
+
+    seconds : float
+        The measured time of the run.
+
+    peak_gflops, peak_gbps : float
+        The peak compute and bandwidth of the device.
+    """
+    def __init__(self, flops, bytes_, aux_bytes, seconds, peak_gflops, peak_gbps):
+        self.flops = flops
+        self.bytes = bytes_
+        self.aux_bytes = aux_bytes
+        self.seconds = seconds
+        self.peak_gflops = peak_gflops
+        self.peak_gbps = peak_gbps
+
+    @property
+    def gflops(self):
+        """The achieved compute throughput."""
+        return self.flops / self.seconds / 1e9
+
+    @property
+    def gbps(self):
+        """The achieved bandwidth, including the auxiliary arrays."""
+        return (self.bytes + self.aux_bytes) / self.seconds / 1e9
+
+    @property
+    def compute_fraction(self):
+        """The fraction of the peak compute achieved."""
+        return self.gflops / self.peak_gflops
+
+    @property
+    def bandwidth_fraction(self):
+        """The fraction of the peak bandwidth achieved."""
+        return self.gbps / self.peak_gbps
+
+    @property
+    def aux_fraction(self):
+        """The fraction of the traffic that is to the auxiliary arrays."""
+        total = self.bytes + self.aux_bytes
+        return float(self.aux_bytes) / total if total else 0.0
+
+    @property
+    def arithmetic_intensity(self):
+        """The flops per byte of traffic."""
+        total = self.bytes + self.aux_bytes
+        return float(self.flops) / total if total else float("inf")
+
+    @property
+    def bound(self):
+        """"compute" or "memory", whichever roof the kernel is under at
+        its arithmetic intensity."""
+        ridge = self.peak_gflops / self.peak_gbps
+        return "compute" if self.arithmetic_intensity >= ridge else "memory"
+
+    def __repr__(self):
+        return ("%.3f GFLOP/s (%.1f%% of peak), %.3f GB/s (%.1f%% of peak, %.1f%% aux), "
+                "%.2f flop/byte, %s bound" %
+                (self.gflops, 100 * self.compute_fraction, self.gbps,
+                 100 * self.bandwidth_fraction, 100 * self.aux_fraction,
+                 self.arithmetic_intensity, self.bound))
+
+
+class WorkCount(object):
+    """The work of a lowered kernel, as expressions of its inputs.
+
+    Attributes
+    ----------
+    flops : PrimExpr
+        The floating point operations.
+
+    bytes : PrimExpr
+        The bytes of global memory accesses, other than those of the
+        auxiliary arrays. Accesses are counted as the code issues them,
+        which is an upper bound on the traffic to device memory.
+
+    aux_bytes : PrimExpr
+        The bytes of auxiliary array accesses.
+    """
+    def __init__(self, flops, bytes_, aux_bytes):
+        self.flops = flops
+        self.bytes = bytes_
+        self.aux_bytes = aux_bytes
+
+    def evaluate(self, scalars=None, arrays=None):
+        """Evaluate the counts for given inputs.
+
+        Parameters
+        ----------
+        scalars : dict of str to int, optional
+            The values of the shape and scalar variables, by name.
+
+        arrays : dict of str to array_like, optional
+            The integer arrays the counts read, such as the lengths, by
+            the name of their tensor or buffer.
+
+        Returns
+        -------
+        flops, bytes, aux_bytes : int
+        """
+        return tuple(evaluate_expr(e, scalars, arrays)
+                     for e in (self.flops, self.bytes, self.aux_bytes))
+
+    def report(self, seconds, peak_gflops, peak_gbps, scalars=None, arrays=None):
+        """Compare a measured run to the peaks of the device.
+
+        Parameters
+        ----------
+        seconds : float
+            The measured time of a run, as from time_evaluator.
+
+        peak_gflops, peak_gbps : float
+            The peak compute and bandwidth of the device.
+
+        scalars, arrays : dict, optional
+            The inputs of the run, see evaluate.
+
+        Returns
+        -------
+        report : RooflineReport
+        """
+        flops, bytes_, aux_bytes = self.evaluate(scalars, arrays)
+        return RooflineReport(flops, bytes_, aux_bytes, seconds, peak_gflops, peak_gbps)
+
+
+def count_work(lowered):
+    """Count the work of a lowered kernel.
+
+    Parameters
+    ----------
+    lowered : LoweredFunc or the result of :any:`lower`
+        The kernel. The accesses to its auxiliary arrays are told apart
+        only when it is given as returned by lower, along with its
+        intermediate buffers.
+
+    Returns
+    -------
+    work : WorkCount
+    """
+    aux_vars = []
+    if isinstance(lowered, LoweredFunc):
+        func = lowered
+    else:
+        func = lowered.function
+        aux_vars = [buf.data for buf in lowered.host_intermediate_buffers] + \
+            [buf.data for buf in lowered.device_intermediate_buffers]
+    flops, bytes_, aux_bytes = ir_pass.CountWork(func.body, aux_vars)
+    return WorkCount(flops, bytes_, aux_bytes)
@@ -21,6 +21,7 @@ from tvm import target as _tgt
 from tvm.tir import expr as _expr
 from tvm.tir import ir_pass
 from tvm.tir import call_pure_intrin
+from tvm.tir.modes import Modes
 from tvm.tir.stmt import For
 
 from .. import api as _api
@@ -88,11 +89,15 @@ def _allocate_tensor(func_id, args):
     """Handling TVM tensor allocation.
     You may refer hybrid.intrin.allocate for more details."""
     n = args.__len__()
-    _internal_assert(isinstance(_api.convert(args[0]), Array), \
-                     "allocate's first argument should be a tuple of shape!")
     shape = args[0]
-    for i in shape:
-        _internal_assert(isinstance(i, _expr.PrimExpr), "The shape should be an expression")
+    if isinstance(shape, Modes):
+        # A ragged tensor, stored in the given storage layout.
+        _internal_assert(func_id == 'output_tensor', "Only outputs can have a ragged layout")
+    else:
+        _internal_assert(isinstance(_api.convert(shape), Array), \
+                         "allocate's first argument should be a tuple of shape!")
+        for i in shape:
+            _internal_assert(isinstance(i, _expr.PrimExpr), "The shape should be an expression")
     if n > 1:
         _internal_assert(isinstance(args[1], str),
                          "The data type should be an str")
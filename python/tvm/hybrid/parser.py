@@ -31,7 +31,9 @@ import tvm.te._ffi_api
 from tvm.tir import expr as _expr
 from tvm.tir import stmt as _stmt
 from tvm.tir import ir_pass as _ir_pass
+from tvm.tir.modes import Modes
 from tvm.te.tensor import Tensor, Operation
+from tvm.te.operation import indirect_placeholder_integrated
 from tvm.tir import all as _all
 from tvm.tir import any as _any
 
@@ -341,7 +343,13 @@ class HybridParser(ast.NodeVisitor):
                                  "This value should not be defined before this point!")
                 if isinstance(rhs, tuple):
                     shape, dtype, scope = rhs
-                    ph = _api.placeholder(shape, dtype=dtype, name=lhs)
+                    if isinstance(shape, Modes):
+                        dims = list(shape.dimensions)
+                        ph = indirect_placeholder_integrated(
+                            shape.dense_shape(), dims, list(zip(dims, shape.l_funs)),
+                            dtype, lhs, shape)
+                    else:
+                        ph = _api.placeholder(shape, dtype=dtype, name=lhs)
                     self.add_symbol(lhs, getattr(Symbol, scope.title() + "Buffer"), ph)
                     if scope == 'output':
                         self.outputs.append(lhs)
@@ -486,6 +494,10 @@ class HybridParser(ast.NodeVisitor):
         _internal_assert(func_id in self.symbols.keys(), \
                          "The function called (%s) is not in the context either!" % func_id)
         ty, entry = self.symbols[func_id]
+        if ty is Symbol.Input and isinstance(entry, _expr.UninterpFun):
+            # The length of a ragged dimension, or another function of
+            # the outer indices.
+            return util.inline_uf_call(entry, args)
         _internal_assert(ty is Symbol.Callable, \
                          "Are you sure what you call is a function?!")
         outs = entry(*args)
@@ -651,6 +663,13 @@ def source_to_op(src, args, symbols, closure_vars):
         elif isinstance(arg, Array):
             for i in arg:
                 get_input_tensors(i)
+        elif isinstance(arg, _expr.UninterpFun):
+            for i in util.uf_input_tensors(arg):
+                if not any(i.same_as(t) for t in input_tensors):
+                    input_tensors.append(i)
+        elif isinstance(arg, Modes):
+            for i in arg.l_funs:
+                get_input_tensors(i)
 
     for i in args:
         get_input_tensors(i)
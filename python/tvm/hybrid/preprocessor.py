@@ -62,7 +62,7 @@ class PyVariableUsage(ast.NodeVisitor):
         func_id = node.func.id
         _internal_assert(func_id in list(HYBRID_GLOBALS.keys()) + \
                          ['range', 'max', 'min', 'len'] + \
-                         list(self.symbols.keys()), \
+                         list(self.symbols.keys()) + list(self._args.keys()), \
                          "Function call id " + func_id + " not in intrinsics' list")
         for elem in node.args:
             self.visit(elem)
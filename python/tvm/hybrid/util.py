@@ -27,6 +27,8 @@ from tvm.ir.container import Array
 
 from tvm.tir import expr as _expr
 from tvm.tir import stmt as _stmt
+from tvm.tir import ir_pass as _ir_pass
+from tvm.tir.modes import Modes
 from tvm.te.tensor import Tensor
 
 from .. import api as _api
@@ -34,7 +36,7 @@ from .. import api as _api
 
 #pylint: disable=invalid-name
 np_arg_types = tuple(list(numeric_types) + [numpy.ndarray])
-tvm_arg_types = (Tensor, Array, _expr.Var, _expr.ConstExpr)
+tvm_arg_types = (Tensor, Array, _expr.Var, _expr.ConstExpr, _expr.UninterpFun, Modes)
 halide_imm_types = (_expr.IntImm, _expr.FloatImm)
 
 
@@ -88,13 +90,38 @@ def replace_io(body, rmap):
     return ir_pass.IRTransform(body, None, replace, ['Provide', 'Call'])
 
 
+def inline_uf_call(ufun, args):
+    """Inline a call to an uninterpreted function, such as the length
+    function of a ragged dimension, in terms of its arguments."""
+    params = ufun.paramters
+    _internal_assert(len(params) == len(args), \
+                     "%s expects %d arguments" % (ufun.fname, len(params)))
+    _internal_assert(ufun.body is not None, "%s has no body to inline" % ufun.fname)
+    return _ir_pass.Substitute(ufun.body, {p: a for p, a in zip(params, args)})
+
+
+def uf_input_tensors(ufun):
+    """The tensors an uninterpreted function reads, which become inputs
+    of the op that calls it."""
+    tensors = []
+    def visit(op):
+        if isinstance(op, _expr.Call) and op.call_type == _expr.Call.Halide:
+            tensor = op.func.output(op.value_index)
+            if not any(tensor.same_as(t) for t in tensors):
+                tensors.append(tensor)
+    if ufun.body is not None:
+        _ir_pass.PostOrderVisit(ufun.body, visit)
+    return tensors
+
+
 def _is_tvm_arg_types(args):
     """Determine a list of element is either a list of tvm arguments of a list of numpy arguments.
     If neither is true, raise a value error."""
     if isinstance(args[0], tvm_arg_types):
         for elem in args[1:]:
             _internal_assert(isinstance(elem, tvm_arg_types),
-                             "Expecting a Var, Tensor or ConstExpr instance but %s get!" \
+                             "Expecting a Var, Tensor, ConstExpr, UninterpFun or Modes "
+                             "instance but %s get!" \
                              % str(type(elem)))
         return True
 
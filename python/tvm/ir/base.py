@@ -149,3 +149,59 @@ def save_json(node):
         Saved json string.
     """
     return tvm.runtime._ffi_node_api.SaveJSON(node)
+
+
+def save_binary(node):
+    """Save tvm object in a compact binary format.
+
+    Structurally equal expressions, statements and containers are
+    saved once, which makes the format much smaller and faster than
+    json for lowered ragged modules.
+
+    Parameters
+    ----------
+    node : Object
+        A TVM object to be saved.
+
+    Returns
+    -------
+    data : bytearray
+        Saved binary data.
+    """
+    return tvm.runtime._ffi_node_api.SaveBinary(node)
+
+
+def load_binary(data):
+    """Load tvm object saved by save_binary.
+
+    Parameters
+    ----------
+    data : bytearray
+        The binary data.
+
+    Returns
+    -------
+    node : Object
+        The loaded tvm node.
+    """
+    return tvm.runtime._ffi_node_api.LoadBinary(bytearray(data))
+
+
+def structural_hash(node):
+    """Hash tvm object by its contents.
+
+    The hash is the same across processes, but does not tell apart
+    nodes that only differ by their identity, such as two variables
+    of the same name.
+
+    Parameters
+    ----------
+    node : Object
+        A TVM object to be hashed.
+
+    Returns
+    -------
+    hash : int
+        The hash, as a signed 64 bit integer.
+    """
+    return tvm.runtime._ffi_node_api.StructuralHash(node)
@@ -17,6 +17,6 @@
 """MicroTVM module for bare-metal backends"""
 
 from ..contrib import binutil
-from .base import Session, create_micro_mod, cross_compiler
+from .base import Session, create_micro_mod, cross_compiler, ragged_arena_size
 from .base import LibType, get_micro_host_driven_dir, get_micro_device_dir
 from . import device
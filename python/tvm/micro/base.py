@@ -18,6 +18,7 @@
 
 from __future__ import absolute_import
 
+import contextlib
 import os
 import sys
 from enum import Enum
@@ -112,6 +113,9 @@ class Session:
             server_port)
         self._enter = self.module["enter"]
         self._exit = self.module["exit"]
+        self._reserve_arena = self.module["reserve_arena"]
+        self._release_arena = self.module["release_arena"]
+        self._arena_used = self.module["arena_used"]
 
     def _check_system(self):
         """Check if the user's system is supported by MicroTVM.
@@ -125,6 +129,32 @@ class Session:
         if sys.maxsize <= 2**32:
             raise RuntimeError("MicroTVM is currently only supported on 64-bit host platforms")
 
+    @contextlib.contextmanager
+    def ragged_arena(self, size):
+        """Reserve a static arena on the device, from which the arrays
+        created on `tvm.micro_dev` are allocated while it is active.
+
+        Ragged kernels can then run with no allocation per call: the
+        ragged tensors and the auxiliary arrays of their preludes are
+        allocated once, at the size given by their `l_maxes` (see
+        `ragged_arena_size`), and reused for every input length. Arrays
+        allocated in the arena must not be used after it is released.
+
+        Parameters
+        ----------
+        size : int
+            size of the arena in bytes
+        """
+        self._reserve_arena(size)
+        try:
+            yield self
+        finally:
+            self._release_arena()
+
+    def arena_used(self):
+        """Number of bytes allocated in the active arena."""
+        return self._arena_used()
+
     def __enter__(self):
         self._enter()
         return self
@@ -136,6 +166,11 @@ class Session:
 def create_micro_mod(c_mod, dev_config):
     """Produces a micro module from a given module.
 
+    Ragged kernels are best built with the default prep_code_mode,
+    "with_prep_code". Their prelude then runs on the device in the same
+    task as the kernel, with no host round trip, and its copies of the
+    lengths and auxiliary arrays are done in place by the device runtime.
+
     Parameters
     ----------
     c_mod : tvm.runtime.Module
@@ -158,6 +193,48 @@ def create_micro_mod(c_mod, dev_config):
     return micro_mod
 
 
+def ragged_arena_size(buffers, bindings=None, word_size=8):
+    """Number of bytes of a `Session.ragged_arena` that holds the given
+    buffers at their maximum sizes.
+
+    Parameters
+    ----------
+    buffers : list of tvm.tir.Buffer or tvm.te.Tensor
+        the ragged tensors of a kernel, and the auxiliary buffers that
+        its prelude fills, as returned by `tvm.build`
+
+    bindings : Dict[tvm.tir.Var, int], optional
+        values of the variables left in the dense shapes, i.e. in the
+        `l_maxes` of the buffers
+
+    word_size : int
+        number of bytes in a word on the target device, the alignment
+        of the arrays in the arena
+
+    Return
+    ------
+    size : int
+        size of the arena in bytes
+    """
+    size = 0
+    for buf in buffers:
+        if isinstance(buf, tvm.tir.Buffer):
+            shape = buf.get_dense_shape()
+        else:
+            shape = buf.shape
+        nbytes = (tvm.runtime.DataType(buf.dtype).bits + 7) // 8
+        for extent in shape:
+            if bindings:
+                extent = tvm.tir.ir_pass.Substitute(extent, bindings)
+            extent = tvm.tir.ir_pass.Simplify(extent)
+            if not isinstance(extent, tvm.tir.IntImm):
+                raise ValueError("the dense shape of %s is not constant, bind %s" %
+                                 (buf.name, extent))
+            nbytes *= extent.value
+        size = (size + word_size - 1) // word_size * word_size + nbytes
+    return size
+
+
 def cross_compiler(dev_config, lib_type):
     """Create a cross-compile function that wraps `create_lib` for a `Binutil` instance.
 
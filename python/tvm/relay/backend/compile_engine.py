@@ -122,6 +122,23 @@ class CompileEngine(Object):
         key = _get_cache_key(source_func, target)
         return _backend._CompileEngineJIT(self, key)
 
+    def set_shape_buckets(self, max_granule):
+        """Bucket the shapes of functions with dynamic dimensions in jit.
+
+        A jitted dynamic function then dispatches each call on the largest
+        power of two granule, up to max_granule, dividing all its dynamic
+        dimensions. It runs a kernel specialized for dimensions that are
+        multiples of that granule, compiled on first use. A function is
+        compiled at most log2(max_granule) + 1 times.
+
+        Parameters
+        ----------
+        max_granule : int
+            The largest granule, a power of two. 1 disables bucketing,
+            which is the default.
+        """
+        _backend._CompileEngineSetShapeBuckets(self, max_granule)
+
     def clear(self):
         """clear the existing cached functions"""
         _backend._CompileEngineClear(self)
@@ -59,6 +59,33 @@ def alloc_tensor(storage, shape, dtype='float32', assert_shape=None):
     """
     return _make.alloc_tensor(storage, shape, dtype, assert_shape)
 
+def alloc_ragged_tensor(shape, lengths, dtype='float32', assert_shape=None):
+    """Allocate a ragged tensor with the provided dense shape, row lengths and dtype.
+
+    The rows are packed back to back, so only the sum of the lengths is
+    allocated. Packed functions receive the tensor as its packed data
+    followed by its int32 row offsets.
+
+    Parameters
+    ----------
+    shape : tvm.relay.Expr
+        The dense shape of the tensor, rows first and lengths second.
+
+    lengths : tvm.relay.Expr
+        The int32 lengths of the rows.
+
+    dtype: str
+        The dtype of the tensor.
+
+    assert_shape: Control the static shape when computed by dynamic shape expression.
+
+    Returns
+    -------
+    result : tvm.relay.Expr
+        The alloc_ragged_tensor expression.
+    """
+    return _make.alloc_ragged_tensor(shape, lengths, dtype, assert_shape)
+
 def alloc_storage(size, alignment, dtype_hint='float32'):
     """Allocate a piece of tensor storage.
 
@@ -19,7 +19,7 @@
 from __future__ import absolute_import
 
 import topi
-from topi.util import get_const_tuple
+from topi.util import get_const_tuple, get_const_int
 from .. import op as reg
 from ..op import OpPattern, schedule_injective
 from .._tensor import elemwise_shape_func
@@ -53,6 +53,113 @@ def schedule_log_softmax(_, outputs, target):
 reg.register_pattern("nn.log_softmax", OpPattern.OPAQUE)
 
 
+# ragged_softmax
+@reg.register_compute("nn.ragged_softmax")
+def compute_ragged_softmax(attrs, inputs, out_type, target):
+    """Compute definition of ragged_softmax"""
+    return [topi.nn.ragged_softmax(inputs[0], inputs[1], attrs.axis, attrs.batch_axis,
+                                   attrs.scale, attrs.mode, attrs.tile)]
+
+
+@reg.register_schedule("nn.ragged_softmax")
+def schedule_ragged_softmax(_, outputs, target):
+    """Schedule definition of ragged_softmax"""
+    with target:
+        return topi.generic.schedule_ragged_softmax(outputs)
+
+
+# Elementwise and injective producers fuse into the ragged reductions.
+reg.register_pattern("nn.ragged_softmax", OpPattern.COMM_REDUCE)
+
+
+def _choose_ragged_mode(attrs, lengths, extent, dtype):
+    """Choose the mode of a ragged op for the current target, or None
+    to keep the mode the op was created with."""
+    # pylint: disable=import-outside-toplevel
+    from ...expr import Constant
+    if attrs.mode != "ragged":
+        return None
+    if isinstance(lengths, Constant):
+        lengths = lengths.data.asnumpy()
+    else:
+        lengths = None
+    mode, tile = topi.nn.util.ragged_mode(lengths, extent, dtype)
+    if mode == "ragged":
+        return None
+    return mode, tile
+
+
+@reg.register_alter_op_layout("nn.ragged_softmax")
+def alter_op_layout_ragged_softmax(attrs, inputs, tinfos):
+    """Choose how ragged_softmax iterates its padded axis. The tensors
+    keep their dense layout, so no layout_transform is needed."""
+    # pylint: disable=import-outside-toplevel
+    from ... import op
+    data = tinfos[0]
+    axis = attrs.axis if attrs.axis >= 0 else attrs.axis + len(data.shape)
+    chosen = _choose_ragged_mode(attrs, inputs[1], get_const_int(data.shape[axis]),
+                                 data.dtype)
+    if chosen is None:
+        return None
+    return op.nn.ragged_softmax(inputs[0], inputs[1], attrs.axis, attrs.batch_axis,
+                                attrs.scale, *chosen)
+
+
+# ragged_layer_norm
+@reg.register_compute("nn.ragged_layer_norm")
+def compute_ragged_layer_norm(attrs, inputs, out_type, target):
+    """Compute definition of ragged_layer_norm"""
+    return [topi.nn.ragged_layer_norm(inputs[0], inputs[1], inputs[2], inputs[3],
+                                      attrs.epsilon, attrs.center, attrs.scale)]
+
+
+@reg.register_schedule("nn.ragged_layer_norm")
+def schedule_ragged_layer_norm(_, outputs, target):
+    """Schedule definition of ragged_layer_norm"""
+    with target:
+        return topi.generic.schedule_ragged_layer_norm(outputs)
+
+
+reg.register_pattern("nn.ragged_layer_norm", OpPattern.COMM_REDUCE)
+
+
+# ragged_attention
+@reg.register_compute("nn.ragged_attention")
+def compute_ragged_attention(attrs, inputs, out_type, target):
+    """Compute definition of ragged_attention"""
+    return [topi.nn.ragged_attention(inputs[0], inputs[1], inputs[2], inputs[3],
+                                     attrs.scale)]
+
+
+@reg.register_schedule("nn.ragged_attention")
+def schedule_ragged_attention(_, outputs, target):
+    """Schedule definition of ragged_attention"""
+    with target:
+        return topi.generic.schedule_ragged_attention(outputs)
+
+
+# The attention kernel keeps its probabilities in memory, so producers
+# are not inlined into it.
+reg.register_pattern("nn.ragged_attention", OpPattern.OPAQUE)
+
+
+# ragged_embedding_bag
+@reg.register_compute("nn.ragged_embedding_bag")
+def compute_ragged_embedding_bag(attrs, inputs, out_type, target):
+    """Compute definition of ragged_embedding_bag"""
+    return [topi.nn.ragged_embedding_bag(inputs[0], inputs[1], inputs[2], attrs.mode)]
+
+
+@reg.register_schedule("nn.ragged_embedding_bag")
+def schedule_ragged_embedding_bag(_, outputs, target):
+    """Schedule definition of ragged_embedding_bag"""
+    with target:
+        return topi.generic.schedule_ragged_embedding_bag(outputs)
+
+
+reg.register_pattern("nn.ragged_embedding_bag", OpPattern.OPAQUE)
+
+
 # dense
 @reg.register_compute("nn.dense")
 def compute_dense(attrs, inputs, out_type, target):
@@ -103,6 +210,39 @@ def schedule_batch_matmul(attrs, outputs, target):
 
 reg.register_pattern("nn.batch_matmul", reg.OpPattern.OUT_ELEMWISE_FUSABLE)
 
+
+# ragged_batch_matmul
+@reg.register_compute("nn.ragged_batch_matmul")
+def compute_ragged_batch_matmul(attrs, inputs, out_type, target):
+    """Compute definition of ragged_batch_matmul"""
+    out_dtype = attrs.out_dtype
+    out_dtype = inputs[0].dtype if out_dtype == "" else out_dtype
+    return [topi.nn.ragged_batch_matmul(inputs[0], inputs[1], inputs[2], out_dtype,
+                                        attrs.mode, attrs.tile)]
+
+
+@reg.register_schedule("nn.ragged_batch_matmul")
+def schedule_ragged_batch_matmul(attrs, outputs, target):
+    """Schedule definition of ragged_batch_matmul"""
+    with target:
+        return topi.generic.schedule_ragged_batch_matmul(outputs)
+
+
+reg.register_pattern("nn.ragged_batch_matmul", OpPattern.COMM_REDUCE)
+
+
+@reg.register_alter_op_layout("nn.ragged_batch_matmul")
+def alter_op_layout_ragged_batch_matmul(attrs, inputs, tinfos):
+    """Choose how ragged_batch_matmul iterates the rows of x"""
+    # pylint: disable=import-outside-toplevel
+    from ... import op
+    x = tinfos[0]
+    chosen = _choose_ragged_mode(attrs, inputs[2], get_const_int(x.shape[1]), x.dtype)
+    if chosen is None:
+        return None
+    return op.nn.ragged_batch_matmul(inputs[0], inputs[1], inputs[2], attrs.out_dtype,
+                                     *chosen)
+
 # sparse_dense
 @reg.register_compute("nn.sparse_dense")
 def compute_sparse_dense(attrs, inputs, out_type, target):
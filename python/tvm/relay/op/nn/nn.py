@@ -488,6 +488,50 @@ def log_softmax(data, axis=-1):
     return _make.log_softmax(data, axis)
 
 
+def ragged_softmax(data, lengths, axis=1, batch_axis=0, scale=1.0, mode="ragged", tile=1):
+    r"""Computes softmax over the valid prefix of a padded axis.
+
+    Along `axis`, only the first `lengths[b]` elements are valid, where
+    `b` is the index along `batch_axis`. The output is the softmax over
+    the valid elements and 0 at the padding. The reductions are lowered
+    to ragged loops, so the padding is never read.
+
+    Parameters
+    ----------
+    data: tvm.relay.Expr
+        The input data to the operator.
+
+    lengths: tvm.relay.Expr
+        The 1-D int32 valid lengths, one per index of `batch_axis`.
+
+    axis: int, optional
+        The padded axis to sum over when computing softmax.
+
+    batch_axis: int, optional
+        The axis that indexes `lengths`.
+
+    scale: float, optional
+        The scale of integer data, such as int8 quantized scores. It is
+        applied after the max of each sequence is subtracted, and the
+        result is float32.
+
+    mode: str, optional
+        How the kernel iterates `axis`: "ragged" visits the valid elements
+        only, "tiled" rounds the lengths up to a multiple of `tile` and
+        "dense" visits the whole padded axis. It does not change the
+        result, and AlterOpLayout picks it for the target.
+
+    tile: int, optional
+        The tile of the "tiled" mode.
+
+    Returns
+    -------
+    result : tvm.relay.Expr
+        The computed result.
+    """
+    return _make.ragged_softmax(data, lengths, axis, batch_axis, scale, mode, tile)
+
+
 def max_pool1d(data,
                pool_size=(1,),
                strides=(1,),
@@ -1615,6 +1659,49 @@ def layer_norm(data,
     return _make.layer_norm(data, gamma, beta, axis, epsilon, center, scale)
 
 
+def ragged_layer_norm(data, gamma, beta, lengths, axis=-1, epsilon=1e-5, center=True,
+                      scale=True):
+    r"""Layer normalization over the last axis of the valid rows of a
+    padded batch of sequences.
+
+    Only the first `lengths[b]` rows of `data[b, :, :]` are valid. They
+    are normalized as by :py:func:`layer_norm`, and the padded rows of
+    the result are 0.
+
+    Parameters
+    ----------
+    data : tvm.relay.Expr
+        The 3-D input data, padded along its second axis.
+
+    gamma : tvm.relay.Expr
+        The gamma scale factor.
+
+    beta : tvm.relay.Expr
+        The beta offset factor.
+
+    lengths : tvm.relay.Expr
+        The 1-D int32 valid rows of each sequence.
+
+    axis : int, optional, default=-1
+        The axis to normalize, which must be the last one.
+
+    epsilon : double, optional, default=1e-5
+        Small float added to variance to avoid dividing by zero.
+
+    center : boolean, optional, default=True
+        If True, add offset of beta to normalized tensor.
+
+    scale : boolean, optional, default=True
+        If True, multiply by gamma.
+
+    Returns
+    -------
+    result : tvm.relay.Expr
+        The normalized data.
+    """
+    return _make.ragged_layer_norm(data, gamma, beta, lengths, axis, epsilon, center, scale)
+
+
 def batch_matmul(x, y):
     r"""
     Computes batch matrix multiplication of `x` and `y` when `x` and `y` are data
@@ -1639,6 +1726,113 @@ def batch_matmul(x, y):
     """
     return _make.batch_matmul(x, y)
 
+
+def ragged_batch_matmul(x, y, lengths, out_dtype="", mode="ragged", tile=1):
+    r"""
+    Computes batch matrix multiplication of `x` and `y` when `x` and `y` are data
+    in batch, and only the first lengths[i] rows of x[i, :, :] are valid.
+
+    .. math::
+
+        \mbox{ragged_batch_matmul}(x, y, l)[i, :l_i, :] =
+            \mbox{matmul}(x[i, :l_i, :], y[i, :, :]^T)
+
+    The padded rows of the result are 0.
+
+    Parameters
+    ----------
+    x : tvm.relay.Expr
+        The first input, padded along its second axis.
+
+    y : tvm.relay.Expr
+        The second input.
+
+    lengths : tvm.relay.Expr
+        The 1-D int32 valid rows of each batch of x.
+
+    out_dtype : str, optional
+        Specifies the output data type, such as int32 to accumulate int8
+        inputs.
+
+    mode : str, optional
+        How the kernel iterates the rows of x, see ragged_softmax.
+
+    tile : int, optional
+        The tile of the "tiled" mode.
+
+    Returns
+    -------
+    result: tvm.relay.Expr
+        The computed result.
+    """
+    return _make.ragged_batch_matmul(x, y, lengths, out_dtype, mode, tile)
+
+
+def ragged_attention(q, k, v, lengths, scale=1.0):
+    r"""Scaled dot product attention over a padded batch of sequences, of
+    which only the first `lengths[b]` queries and keys are valid.
+
+    .. math::
+
+        \mbox{out}[b, h, :l_b, :] = \mbox{softmax}(s \, q[b, h, :l_b, :]
+            k[b, h, :l_b, :]^T) v[b, h, :l_b, :]
+
+    The padded queries of the result are 0.
+
+    Parameters
+    ----------
+    q : tvm.relay.Expr
+        The queries, with shape `(batch, heads, seq_len, head_dim)`.
+
+    k : tvm.relay.Expr
+        The keys, with the shape of q.
+
+    v : tvm.relay.Expr
+        The values, with shape `(batch, heads, seq_len, value_dim)`.
+
+    lengths : tvm.relay.Expr
+        The 1-D int32 valid length of each sequence.
+
+    scale : float, optional
+        The scale s of the scores, typically 1 / sqrt(head_dim).
+
+    Returns
+    -------
+    result: tvm.relay.Expr
+        The computed result.
+    """
+    return _make.ragged_attention(q, k, v, lengths, scale)
+
+
+def ragged_embedding_bag(weight, indices, offsets, mode="sum"):
+    r"""Gather rows of an embedding table and reduce them per bag.
+
+    Bag `b` holds the rows `indices[offsets[b]:offsets[b + 1]]` of
+    `weight`. Each bag is reduced by a single block, so the result is
+    deterministic, unlike a scatter_add over the gathered rows.
+
+    Parameters
+    ----------
+    weight : tvm.relay.Expr
+        The embedding table, with shape `(num_embeddings, dim)`.
+
+    indices : tvm.relay.Expr
+        The 1-D int32 rows of all bags, back to back.
+
+    offsets : tvm.relay.Expr
+        The 1-D int32 start of each bag in indices, followed by the
+        length of indices.
+
+    mode : str, optional
+        "sum", "mean" or "max". Empty bags are 0 in all modes.
+
+    Returns
+    -------
+    result: tvm.relay.Expr
+        The reduced bags, with shape `(num_bags, dim)`.
+    """
+    return _make.ragged_embedding_bag(weight, indices, offsets, mode)
+
 def sparse_dense(data, weight):
     r"""
     Computes the matrix multiplication of `data` and `weight`, where `data` is
@@ -19,9 +19,11 @@
 import tvm
 
 _save_param_dict = tvm.get_global_func("tvm.relay._save_param_dict")
+_save_param_dict_aligned = tvm.get_global_func("tvm.relay._save_param_dict_aligned")
 _load_param_dict = tvm.get_global_func("tvm.relay._load_param_dict")
+_load_param_dict_from_file = tvm.get_global_func("tvm.relay._load_param_dict_from_file")
 
-def save_param_dict(params):
+def save_param_dict(params, alignment=0):
     """Save parameter dictionary to binary bytes.
 
     The result binary bytes can be loaded by the
@@ -32,6 +34,13 @@ def save_param_dict(params):
     params : dict of str to NDArray
         The parameter dictionary.
 
+    alignment : int
+        If positive, the data of each parameter is aligned to this many
+        bytes from the start, so that the parameters of a file holding
+        the bytes can be memory mapped and used in place by
+        "load_params_from_file" and load_param_dict_from_file. Runtimes
+        older than the alignment cannot load such bytes.
+
     Returns
     -------
     param_bytes: bytearray
@@ -54,6 +63,8 @@ def save_param_dict(params):
     for k, v in params.items():
         args.append(k)
         args.append(tvm.nd.array(v))
+    if alignment > 0:
+        return _save_param_dict_aligned(alignment, *args)
     return _save_param_dict(*args)
 
 
@@ -74,3 +85,23 @@ def load_param_dict(param_bytes):
         param_bytes = bytearray(param_bytes)
     load_arr = _load_param_dict(param_bytes)
     return {v.name : v.array for v in load_arr}
+
+
+def load_param_dict_from_file(file_name):
+    """Load parameter dictionary from a file by mapping it into memory.
+
+    The parameters whose data is aligned in the file view the mapping in
+    place, without being read or copied.
+
+    Parameters
+    ----------
+    file_name: str
+        The file the serialized parameters were written to.
+
+    Returns
+    -------
+    params : dict of str to NDArray
+        The parameter dictionary.
+    """
+    load_arr = _load_param_dict_from_file(file_name)
+    return {v.name : v.array for v in load_arr}
@@ -392,6 +392,53 @@ def dense(data,
                        out_dtype)
 
 
+def ragged_batch_matmul(x,
+                        y,
+                        lengths,
+                        input_zero_point,
+                        kernel_zero_point,
+                        input_scale,
+                        kernel_scale,
+                        out_dtype="int32"):
+    """Qnn ragged_batch_matmul operator.
+    Multiplies quantized data in batch, where only the first lengths[i]
+    rows of x[i, :, :] are valid, accumulating in int32. The padded rows
+    of the result are 0.
+
+    Parameters
+    ----------
+    x : tvm.relay.Expr
+        The quantized first input, padded along its second axis.
+    y : tvm.relay.Expr
+        The quantized second input.
+    lengths : tvm.relay.Expr
+        The 1-D int32 valid rows of each batch of x.
+    input_zero_point: tvm.relay.Expr
+        The zero point of x, which must be 0.
+    kernel_zero_point: tvm.relay.Expr
+        The zero point of y, which must be 0.
+    input_scale: tvm.relay.Expr
+        The scale for x.
+    kernel_scale: tvm.relay.Expr
+        The scale for y.
+    out_dtype : str, optional
+        Specifies the output data type, int32.
+
+    Returns
+    -------
+    result : tvm.relay.Expr
+        The computed result.
+    """
+    return _make.ragged_batch_matmul(x,
+                                     y,
+                                     lengths,
+                                     input_zero_point,
+                                     kernel_zero_point,
+                                     input_scale,
+                                     kernel_scale,
+                                     out_dtype)
+
+
 def mul(lhs, rhs, lhs_scale, lhs_zero_point, rhs_scale, rhs_zero_point,
         output_scale, output_zero_point):
     """Quantized multiplication with numpy-style broadcasting.
@@ -198,6 +198,47 @@ def dense_rewrite(ref_call, new_args, ctx):
     return QAnnotateExpr(expr, QAnnotateKind.ACTIVATION)
 
 
+@register_annotate_function("nn.ragged_batch_matmul")
+def ragged_batch_matmul_rewrite(ref_call, new_args, ctx):
+    """Rewrite function for ragged_batch_matmul. Lhs will be quantized to input field,
+    and constant rhs, such as stacked expert weights, to weight field. The lengths are
+    kept as they are. Output would be in activation field."""
+    if quantize_context().check_to_skip(ref_call):
+        return None
+
+    lhs_expr, lhs_kind = _get_expr_kind(new_args[0])
+    rhs_expr, rhs_kind = _get_expr_kind(new_args[1])
+
+    if lhs_kind is None or lhs_kind == QAnnotateKind.ACTIVATION:
+        lhs_expr = attach_simulated_quantize(lhs_expr, QAnnotateKind.INPUT)
+
+    if rhs_kind is None and _analysis.check_constant(rhs_expr):
+        rhs_expr = attach_simulated_quantize(rhs_expr, QAnnotateKind.WEIGHT)
+    elif rhs_kind is None or rhs_kind == QAnnotateKind.ACTIVATION:
+        rhs_expr = attach_simulated_quantize(rhs_expr, QAnnotateKind.INPUT)
+
+    expr = _forward_op(ref_call, [lhs_expr, rhs_expr, new_args[2]])
+
+    return QAnnotateExpr(expr, QAnnotateKind.ACTIVATION)
+
+
+@register_annotate_function("nn.ragged_softmax")
+def ragged_softmax_rewrite(ref_call, new_args, ctx):
+    """Rewrite function for ragged_softmax. The scores will be quantized to input
+    field, and scaled per sequence after its max is subtracted. Output is real."""
+    if quantize_context().check_to_skip(ref_call):
+        return None
+
+    x_expr, x_kind = _get_expr_kind(new_args[0])
+    if x_kind is None:
+        return None
+
+    if x_kind == QAnnotateKind.ACTIVATION:
+        x_expr = attach_simulated_quantize(x_expr, QAnnotateKind.INPUT)
+
+    return _forward_op(ref_call, [x_expr, new_args[1]])
+
+
 @register_annotate_function("multiply")
 def multiply_rewrite(ref_call, new_args, ctx):
     """Rewrite function for multiply."""
@@ -56,6 +56,20 @@ def conv2d_partition_function(ref_call, new_args, ctx):
     return QPartitionExpr(ret)
 
 
+@register_partition_function("nn.ragged_batch_matmul")
+def ragged_batch_matmul_partition_function(ref_call, new_args, ctx):
+    """Rewrite function for ragged_batch_matmul for partition"""
+    data_cond, data = partition_expr_check(new_args[0])
+    weight_cond, weight = partition_expr_check(new_args[1])
+
+    if data_cond:
+        data = new_args[0].realize()
+    if weight_cond:
+        weight = new_args[1].realize()
+    ret = _forward_op(ref_call, [data, weight, new_args[2]])
+    return QPartitionExpr(ret)
+
+
 def identity_partition_function(ref_call, new_args, ctx):
     cond, expr = partition_expr_check(new_args[0])
     if cond:
@@ -192,6 +192,20 @@ def CanonicalizeOps():
     return _transform.CanonicalizeOps()
 
 
+def LowerToRagged():
+    """Rewrite softmaxes over length masked inputs into ragged softmaxes.
+    A softmax whose padded elements are first masked to a large negative
+    value, with sequence_mask or with a where over an arange compared to
+    the lengths, becomes nn.ragged_softmax, which skips the padding.
+
+    Returns
+    -------
+    ret: tvm.relay.Pass
+        The registered pass that lowers masked patterns to ragged ops.
+    """
+    return _transform.LowerToRagged()
+
+
 def DeadCodeElimination(inline_once=False):
     """Remove expressions that do not have any users (dead code).
 
@@ -268,6 +282,23 @@ def CombineParallelDense(min_num_branches=3):
               |
         batch_matmul+elemwise/bcast (2,2,2)
 
+    Dense operators on different fields of one tuple, such as the tokens
+    routed to each expert of a mixture of experts layer, are combined too
+    when their weights have the same shape:
+
+          split/tuple
+          /          \
+     dense (3,2)     dense (5,2)
+
+    Would become:
+
+          split/tuple
+               |
+     ragged_batch_matmul (2,5,2)
+
+    where the inputs are padded to the most rows and the padded rows are
+    skipped. Only the dense operators of such groups are combined.
+
     Parameters
     ----------
     min_num_branches : int
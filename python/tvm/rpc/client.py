@@ -76,6 +76,34 @@ class RPCSession(object):
         ctx._rpc_sess = self
         return ctx
 
+    def set_upload_options(self, pipeline_depth=0, cache_bytes=0, compress=False):
+        """Set how arrays are copied to the remote.
+
+        Parameters
+        ----------
+        pipeline_depth : int, optional
+            The number of copies sent without waiting for the remote to
+            acknowledge them. The acknowledgements are collected before
+            the next call that waits for the remote, which raises the
+            errors of the copies. 0 waits for each copy.
+
+        cache_bytes : int, optional
+            The bytes of copied arrays the remote keeps, keyed by the hash
+            of their content, so that arrays copied again, such as the
+            inputs and row lengths of each trial of a benchmark, are not
+            sent again. 0 disables the cache.
+
+        compress : bool, optional
+            Whether to run length encode the zero bytes of the copies,
+            which shrinks the padding of ragged data and arrays of small
+            integers.
+
+        Note
+        ----
+        The remote needs to support these options unless all are off.
+        """
+        base._SessSetUploadOptions(self._sess, pipeline_depth, cache_bytes, compress)
+
     def upload(self, data, target=None):
         """Upload file to remote runtime temp folder
 
@@ -17,14 +17,22 @@
 """TVM runtime namespace."""
 
 # class exposures
-from .packed_func import PackedFunc
-from .object import Object
+from .packed_func import PackedFunc, BoundCall
+from .object import Object, ObjectPool
 from .object_generic import ObjectGeneric, ObjectTypes
 from .ndarray import NDArray, DataType, TypeCode, TVMContext
 from .module import Module, set_cuda_grid_sync_on, get_max_mem_consumption
+from .module import clear_prep_code_cache, get_prep_code_cache_stats, patch_ragged_prefix_sum
+from .module import get_prep_code_profile, clear_prep_code_profile
+from .module import set_mem_prof, get_mem_profile
+from .module import create_thread_pool, bind_thread_pool
+from .stream import Stream, Event
+from .bin_packing import bucket_batch, BatchReordering
+from .chunked import chunk_batch, ChunkedFunction
+from .block_cycles import get_block_cycles, clear_block_cycles, block_cycles_report
 
 # function exposures
 from .object_generic import convert_to_object, convert, const
-from .ndarray import context, cpu, gpu, opencl, cl, vulkan, metal, mtl
+from .ndarray import context, cpu, gpu, cpu_pinned, opencl, cl, vulkan, metal, mtl
 from .ndarray import vpi, rocm, opengl, ext_dev, micro_dev
 from .module import load_module, enabled, system_lib
@@ -0,0 +1,151 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Runtime companion to Schedule.split_for_bin_packing.
+
+split_for_bin_packing splits a loop over a batch into sub-graphs at a
+split point. The helpers here sort an incoming batch by length, pick
+the split points that balance the work across the sub-graphs, and keep
+the permutation so that outputs can be put back in the original order.
+"""
+import numpy as np
+
+from .ndarray import NDArray
+
+
+def _as_numpy(lengths):
+    if isinstance(lengths, NDArray):
+        return lengths.asnumpy()
+    return np.asarray(lengths)
+
+
+def _partition(costs, num_buckets, block_size):
+    """Split costs, in order, into at most num_buckets contiguous
+    buckets minimizing the cost of the most expensive bucket. Bucket
+    boundaries are multiples of block_size. Returns the list of
+    num_buckets - 1 split points."""
+    n = len(costs)
+    num_blocks = (n + block_size - 1) // block_size
+    block_costs = [float(np.sum(costs[i * block_size:(i + 1) * block_size]))
+                   for i in range(num_blocks)]
+
+    def greedy(limit):
+        splits, current = [], 0.0
+        for i, c in enumerate(block_costs):
+            if current + c > limit and current > 0:
+                splits.append(i * block_size)
+                current = 0.0
+            current += c
+        return splits
+
+    lo = max(block_costs) if block_costs else 0.0
+    hi = sum(block_costs)
+    for _ in range(64):
+        if hi - lo <= 1e-6 * max(hi, 1.0):
+            break
+        mid = (lo + hi) / 2
+        if len(greedy(mid)) < num_buckets:
+            hi = mid
+        else:
+            lo = mid
+    splits = greedy(hi)
+    # Pad with empty trailing buckets so there is always one split
+    # point per split.
+    while len(splits) < num_buckets - 1:
+        splits.append(n)
+    return splits
+
+
+class BatchReordering(object):
+    """A length-sorted order of a batch and the split points among the
+    sub-graphs, along with the permutation to restore outputs.
+
+    Attributes
+    ----------
+    permutation : numpy.ndarray
+        permutation[i] is the original index of the i-th sorted row.
+
+    sorted_lengths : numpy.ndarray
+        The lengths in sorted order.
+
+    split_points : list of int
+        Sub-graph g processes the sorted rows
+        [split_points[g - 1], split_points[g]).
+    """
+    def __init__(self, permutation, sorted_lengths, split_points):
+        self.permutation = permutation
+        self.inverse = np.empty_like(permutation)
+        self.inverse[permutation] = np.arange(len(permutation))
+        self.sorted_lengths = sorted_lengths
+        self.split_points = split_points
+
+    def apply(self, arr):
+        """Reorder the rows (the first axis) of a dense array."""
+        return _as_numpy(arr)[self.permutation]
+
+    def restore(self, arr):
+        """Put the rows of a dense output back in the original order."""
+        return _as_numpy(arr)[self.inverse]
+
+    def apply_sequences(self, sequences):
+        """Reorder a list of per-row arrays."""
+        return [sequences[i] for i in self.permutation]
+
+    def restore_sequences(self, sequences):
+        """Put a list of per-row outputs back in the original order."""
+        return [sequences[i] for i in self.inverse]
+
+    def buckets(self):
+        """The [begin, end) sorted row ranges of each sub-graph."""
+        bounds = [0] + list(self.split_points) + [len(self.permutation)]
+        return [(bounds[i], bounds[i + 1]) for i in range(len(bounds) - 1)]
+
+
+def bucket_batch(lengths, num_graphs=2, cost=None, block_size=1, descending=True):
+    """Sort a batch by length and pick the split points that balance
+    the work across the sub-graphs created by split_for_bin_packing.
+
+    Parameters
+    ----------
+    lengths : list of int, numpy.ndarray or NDArray
+        The per-row lengths of the batch.
+
+    num_graphs : int, optional
+        The number of sub-graphs the batch loop was split into.
+
+    cost : function of numpy.ndarray -> numpy.ndarray, optional
+        The work of each row given its length. Defaults to the length
+        itself; use e.g. lambda l: l * l for attention-like operators.
+
+    block_size : int, optional
+        Split points are rounded to multiples of this, for example the
+        number of rows a thread block handles.
+
+    descending : bool, optional
+        Whether the longest rows come first.
+
+    Returns
+    -------
+    ret : BatchReordering
+        The order, split points and restoring permutation.
+    """
+    lengths = _as_numpy(lengths).astype("int64")
+    # A stable sort keeps rows of equal length in their original order.
+    permutation = np.argsort(-lengths if descending else lengths, kind="stable")
+    sorted_lengths = lengths[permutation]
+    costs = sorted_lengths if cost is None else np.asarray(cost(sorted_lengths))
+    split_points = _partition(costs, num_graphs, max(int(block_size), 1))
+    return BatchReordering(permutation, sorted_lengths, split_points)
@@ -0,0 +1,139 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Per-block durations of kernels built with instrument_block_cycles.
+
+Each block of an instrumented kernel records the cycle counter of its
+multiprocessor at its entry and exit. How skewed the durations are
+shows whether ragged loop fusion and bin packing balance the work:
+
+.. code-block:: python
+
+  with tvm.target.build_config(instrument_block_cycles=True):
+      func = tvm.build(s, args, "cuda")
+  func(*nd_args)
+  cycles = tvm.runtime.get_block_cycles()[(func.entry_name, 0)]
+  # For a fused loop of rows_per_block rows per block
+  report = tvm.runtime.block_cycles_report(cycles, fused_to_outer, rows_per_block)
+"""
+import numpy as np
+
+from . import _ffi_api
+
+
+def get_block_cycles():
+    """Get the cycles recorded by the blocks of the last launch of each
+    instrumented kernel.
+
+    Returns
+    -------
+    cycles : dict of (str, int) to numpy.ndarray
+        Maps the function name and the index of the kernel in it to a
+        (num_blocks, 2) int64 array of the entry and exit cycles of
+        each block, in linear block order.
+    """
+    cycles = {}
+    for key in _ffi_api.BlockCyclesKernels().splitlines():
+        name, kernel = key.rsplit(":", 1)
+        cycles[(name, int(kernel))] = _ffi_api.BlockCyclesGet(name, int(kernel)).asnumpy()
+    return cycles
+
+
+def clear_block_cycles():
+    """Forget all recorded cycles and free their device buffers."""
+    _ffi_api.BlockCyclesClear()
+
+
+class BlockCyclesReport(object):
+    """The distribution of the durations of the blocks of a kernel.
+
+    Attributes
+    ----------
+    durations : numpy.ndarray
+        The duration of each block, in cycles.
+
+    histogram : numpy.ndarray
+        The number of blocks in each bin.
+
+    bin_edges : numpy.ndarray
+        The num_bins + 1 edges of the bins, in cycles.
+
+    outer_cycles : numpy.ndarray or None
+        The total duration of the blocks of each outer ragged index.
+
+    outer_blocks : numpy.ndarray or None
+        The number of blocks of each outer ragged index.
+    """
+    def __init__(self, durations, histogram, bin_edges, outer_cycles, outer_blocks):
+        self.durations = durations
+        self.histogram = histogram
+        self.bin_edges = bin_edges
+        self.outer_cycles = outer_cycles
+        self.outer_blocks = outer_blocks
+
+    @property
+    def imbalance(self):
+        """The ratio of the longest to the mean block duration, which is
+        1 for perfectly balanced blocks."""
+        mean = self.durations.mean() if self.durations.size else 0
+        return float(self.durations.max() / mean) if mean > 0 else 1.0
+
+    def __repr__(self):
+        lines = ["%d blocks, mean %.0f cycles, max %.0f cycles, imbalance %.2f" %
+                 (self.durations.size, self.durations.mean() if self.durations.size else 0,
+                  self.durations.max() if self.durations.size else 0, self.imbalance)]
+        for count, low, high in zip(self.histogram, self.bin_edges[:-1], self.bin_edges[1:]):
+            lines.append("  [%10.0f, %10.0f) %d" % (low, high, count))
+        return "\n".join(lines)
+
+
+def block_cycles_report(cycles, fused_to_outer=None, rows_per_block=1, num_bins=20):
+    """Summarize the durations of the blocks of a kernel.
+
+    Parameters
+    ----------
+    cycles : numpy.ndarray
+        The (num_blocks, 2) records of a kernel, from get_block_cycles.
+
+    fused_to_outer : array_like of int, optional
+        The fused to outer map of the fused ragged loop bound to the
+        blocks, as computed by the prep code. Each block is attributed
+        to the outer index of its first fused iteration.
+
+    rows_per_block : int, optional
+        The number of fused iterations a block covers.
+
+    num_bins : int, optional
+        The number of bins of the histogram.
+
+    Returns
+    -------
+    report : BlockCyclesReport
+    """
+    cycles = np.asarray(cycles, dtype='int64').reshape(-1, 2)
+    durations = cycles[:, 1] - cycles[:, 0]
+    histogram, bin_edges = np.histogram(durations, bins=num_bins)
+    outer_cycles = outer_blocks = None
+    if fused_to_outer is not None:
+        fused_to_outer = np.asarray(fused_to_outer, dtype='int64')
+        first_rows = np.arange(durations.size, dtype='int64') * rows_per_block
+        # Blocks past the end of the fused loop only wait at the exit.
+        valid = first_rows < fused_to_outer.size
+        outer = fused_to_outer[first_rows[valid]]
+        num_outer = int(outer.max()) + 1 if outer.size else 0
+        outer_cycles = np.bincount(outer, weights=durations[valid], minlength=num_outer)
+        outer_blocks = np.bincount(outer, minlength=num_outer)
+    return BlockCyclesReport(durations, histogram, bin_edges, outer_cycles, outer_blocks)
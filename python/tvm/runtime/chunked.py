@@ -0,0 +1,237 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Out-of-core execution of ragged batches too large for the device.
+
+The batch stays on the host and is run in chunks of contiguous
+sequences, each within a token budget, by a function built for one
+chunk, e.g. one sub-graph of Schedule.split_for_bin_packing built for
+max_rows sequences. Each call runs the prelude of its own chunk.
+Chunks are double buffered: the upload of the next chunk and the
+download of the previous one run on their own streams while the
+current chunk computes:
+
+.. code-block:: python
+
+    f = tvm.runtime.ChunkedFunction(
+        mod.entry_func, tvm.gpu(0), max_rows=256, token_budget=65536,
+        arg_kinds=['batch', 'lengths', 'batch'], shapes=[...], dtypes=[...])
+    out_np = f(x_np, lengths_np, out_np)
+"""
+import numpy as np
+
+from tvm._ffi.base import _LIB, check_call
+
+from . import ndarray
+from .stream import Stream
+
+
+def chunk_batch(lengths, max_rows, token_budget):
+    """Split sequences, in order, into contiguous chunks of at most
+    max_rows sequences and token_budget tokens. A sequence longer than
+    the budget is a chunk on its own.
+
+    Parameters
+    ----------
+    lengths : array_like of int
+        The lengths of the sequences of the batch
+
+    max_rows : int
+        The largest number of sequences of a chunk
+
+    token_budget : int
+        The largest number of tokens of a chunk
+
+    Returns
+    -------
+    chunks : list of (int, int)
+        The [begin, end) sequence range of each chunk.
+    """
+    lengths = np.asarray(lengths, dtype='int64')
+    chunks = []
+    begin, tokens = 0, 0
+    for i, length in enumerate(lengths):
+        if i > begin and (i - begin >= max_rows or tokens + length > token_budget):
+            chunks.append((begin, i))
+            begin, tokens = i, 0
+        tokens += int(length)
+    if begin < len(lengths):
+        chunks.append((begin, len(lengths)))
+    return chunks
+
+
+def _copy(src, dst, stream):
+    check_call(_LIB.TVMArrayCopyFromTo(src.handle, dst.handle, stream.handle))
+
+
+class ChunkedFunction(object):
+    """A function run over the chunks of a ragged batch on one device.
+
+    Parameters
+    ----------
+    func : PackedFunc
+        The function, built for the shapes of one chunk, with outputs as
+        its last arguments.
+
+    ctx : TVMContext
+        The device
+
+    max_rows : int
+        The number of sequences the function is built for. Shorter
+        chunks are padded with sequences of length 0.
+
+    token_budget : int
+        The number of tokens the function is built for, that is the
+        first dimension of its 'tokens' arguments.
+
+    arg_kinds : list of str
+        How each argument is split, as for
+        tvm.contrib.ragged_shard.ShardedFunction: 'lengths', 'batch',
+        'tokens' or 'replicate'.
+
+    shapes : list of tuple of int
+        The shapes of the arguments of the function. The replicated
+        arguments are uploaded once, on the first call.
+
+    dtypes : list of str
+        The dtypes of the arguments.
+
+    num_outputs : int
+        The number of trailing arguments that are outputs.
+    """
+    def __init__(self, func, ctx, max_rows, token_budget, arg_kinds, shapes, dtypes,
+                 num_outputs=1):
+        if 'lengths' not in arg_kinds:
+            raise ValueError("One of the arguments should be the lengths")
+        self.func = func
+        self.ctx = ctx
+        self.max_rows = max_rows
+        self.token_budget = token_budget
+        self.arg_kinds = arg_kinds
+        self.shapes = [tuple(s) for s in shapes]
+        self.dtypes = dtypes
+        self.num_outputs = num_outputs
+        pinned = ndarray.cpu_pinned(ctx.device_id)
+        # Two device and pinned host buffers per argument, one for the
+        # chunk being computed and one for the chunk being copied.
+        self._device = [[ndarray.empty(s, d, ctx) for s, d in zip(shapes, dtypes)]
+                        for _ in range(2)]
+        self._host = [[ndarray.empty(s, d, pinned) for s, d in zip(shapes, dtypes)]
+                      for _ in range(2)]
+        self._replicated = [None] * len(arg_kinds)
+        self._upload = Stream(ctx)
+        self._compute = Stream(ctx)
+        self._download = Stream(ctx)
+
+    def _rows(self, idx, rows, tokens):
+        kind = self.arg_kinds[idx]
+        return rows if kind in ('batch', 'lengths') else tokens
+
+    def _view(self, arr, idx, count):
+        return arr.create_view((count,) + self.shapes[idx][1:], self.dtypes[idx])
+
+    def _stage(self, slot, args, begin, end, token_begin, token_end):
+        """Copy the inputs of a chunk into the pinned buffers of a slot
+        and upload them."""
+        num_inputs = len(args) - self.num_outputs
+        rows, tokens = end - begin, token_end - token_begin
+        for i in range(num_inputs):
+            kind = self.arg_kinds[i]
+            if kind == 'replicate':
+                if self._replicated[i] is not args[i]:
+                    for dev in self._device:
+                        dev[i].copyfrom(args[i])
+                    self._replicated[i] = args[i]
+                continue
+            count = self._rows(i, rows, tokens)
+            part = args[i][begin:end] if kind in ('batch', 'lengths') else \
+                args[i][token_begin:token_end]
+            host = self._host[slot][i]
+            if kind == 'lengths':
+                # The padding sequences are empty.
+                padded = np.zeros(self.shapes[i], dtype=self.dtypes[i])
+                padded[:rows] = part
+                host.copyfrom(padded)
+                count = self.max_rows
+            elif count > 0:
+                self._view(host, i, count).copyfrom(np.ascontiguousarray(part))
+            if count > 0:
+                _copy(self._view(host, i, count), self._view(self._device[slot][i], i, count),
+                      self._upload)
+
+    def __call__(self, *args):
+        """Run the function on the numpy arrays args, chunk by chunk, and
+        return the outputs."""
+        if len(args) != len(self.arg_kinds):
+            raise ValueError("Expected %d arguments" % len(self.arg_kinds))
+        lengths = np.asarray(args[self.arg_kinds.index('lengths')])
+        prefix = np.concatenate([[0], np.cumsum(lengths)]).astype('int64')
+        chunks = chunk_batch(lengths, self.max_rows, self.token_budget)
+        num_inputs = len(args) - self.num_outputs
+        outputs = [np.array(a, copy=True) for a in args[num_inputs:]]
+
+        def _bounds(c):
+            begin, end = chunks[c]
+            return begin, end, int(prefix[begin]), int(prefix[end])
+
+        def _finish(c, slot, event):
+            # Move the outputs of a downloaded chunk into the results.
+            event.synchronize()
+            begin, end, token_begin, token_end = _bounds(c)
+            for k in range(self.num_outputs):
+                i = num_inputs + k
+                count = self._rows(i, end - begin, token_end - token_begin)
+                start = begin if self.arg_kinds[i] == 'batch' else token_begin
+                outputs[k][start:start + count] = \
+                    self._view(self._host[slot][i], i, count).asnumpy()
+
+        uploaded = [None, None]
+        computed = [None, None]
+        downloaded = [None, None]
+        if chunks:
+            self._stage(0, args, *_bounds(0))
+            uploaded[0] = self._upload.record_event()
+        for c in range(len(chunks)):
+            slot = c % 2
+            if c + 1 < len(chunks):
+                # The other slot is free once the chunk before computed.
+                nslot = 1 - slot
+                if computed[nslot] is not None:
+                    self._upload.wait_event(computed[nslot])
+                if uploaded[nslot] is not None:
+                    uploaded[nslot].synchronize()
+                self._stage(nslot, args, *_bounds(c + 1))
+                uploaded[nslot] = self._upload.record_event()
+            # The outputs of the slot are free once downloaded.
+            if downloaded[slot] is not None:
+                _finish(c - 2, slot, downloaded[slot])
+                downloaded[slot] = None
+            self._compute.wait_event(uploaded[slot])
+            with self._compute:
+                self.func(*self._device[slot])
+                computed[slot] = self._compute.record_event()
+            self._download.wait_event(computed[slot])
+            begin, end, token_begin, token_end = _bounds(c)
+            for k in range(self.num_outputs):
+                i = num_inputs + k
+                count = self._rows(i, end - begin, token_end - token_begin)
+                if count > 0:
+                    _copy(self._view(self._device[slot][i], i, count),
+                          self._view(self._host[slot][i], i, count), self._download)
+            downloaded[slot] = self._download.record_event()
+        for c in range(max(len(chunks) - 2, 0), len(chunks)):
+            _finish(c, c % 2, downloaded[c % 2])
+        return outputs[0] if self.num_outputs == 1 else outputs
@@ -89,6 +89,30 @@ class ADT(Object):
         return _GetADTSize(self)
 
 
+@tvm._ffi.register_object("vm.RaggedTensor")
+class RaggedTensor(Object):
+    """A ragged tensor, as allocated by the Relay VM.
+
+    Parameters
+    ----------
+    data : tvm.nd.NDArray
+        The packed rows, viewed with the dense shape of the tensor.
+
+    offsets : tvm.nd.NDArray
+        The int32 row offsets into data, one more than the rows.
+    """
+    def __init__(self, data, offsets):
+        self.__init_handle_by_constructor__(_RaggedTensor, data, offsets)
+
+    @property
+    def data(self):
+        return _GetRaggedTensorData(self)
+
+    @property
+    def offsets(self):
+        return _GetRaggedTensorOffsets(self)
+
+
 def tuple_object(fields=None):
     """Create a ADT object from source tuple.
 
@@ -18,6 +18,7 @@
 # pylint: disable=invalid-name, unused-import, import-outside-toplevel
 """Runtime Module namespace."""
 import ctypes
+import json
 import struct
 from collections import namedtuple
 
@@ -34,8 +35,126 @@ def set_cuda_grid_sync_on(value):
 def get_max_mem_consumption():
     return _ffi_api.GetMaxMemConsumption()
 
-def set_mem_prof(value):
-    return _ffi_api.SetMemProfiling(value)
+def set_mem_prof(value, timeline=False):
+    """Start or stop profiling the memory the runtime allocates for
+    workspaces and NDArrays. Starting resets the profile.
+
+    Parameters
+    ----------
+    value : bool
+        Whether to profile.
+
+    timeline : bool
+        Whether to also record every allocation and free.
+    """
+    return _ffi_api.SetMemProfiling(value, timeline)
+
+def get_mem_profile():
+    """Get the memory profile recorded since set_mem_prof(True).
+
+    Returns
+    -------
+    profile : dict
+        The current and peak live bytes overall ("current", "peak"),
+        per device and allocation site ("devices", a list of dicts with
+        the "device", "id", "site", "current" and "peak" keys), and the
+        timeline of [microseconds, device, id, site, live bytes of the
+        device and site] entries if one is recorded ("timeline").
+    """
+    return json.loads(_ffi_api.GetMemProfile())
+
+def create_thread_pool(name, cpus, num_threads=0):
+    """Create a named thread pool, whose workers are bound to cpus.
+
+    Sessions running concurrently on pools with disjoint cpus do not
+    compete for workers or cores.
+
+    Parameters
+    ----------
+    name : str
+        The name of the pool.
+
+    cpus : list of int
+        The CPUs the workers are bound to.
+
+    num_threads : int
+        The number of workers, 0 for one per CPU.
+    """
+    _ffi_api.CreateThreadPool(name, num_threads, ",".join(str(cpu) for cpu in cpus))
+
+def bind_thread_pool(name):
+    """Run the parallel loops launched by the calling thread on a named
+    thread pool.
+
+    Parameters
+    ----------
+    name : str
+        The name of the pool, or "" for the default pool of the thread.
+
+    Returns
+    -------
+    prev : str
+        The name of the pool the thread was bound to.
+    """
+    return _ffi_api.BindThreadPool(name)
+
+def clear_prep_code_cache():
+    """Forget all prep code results cached by functions built with
+    prep_code_mode="with_cached_prep_code"."""
+    _ffi_api.PrepCodeCacheClear()
+
+def get_prep_code_cache_stats():
+    """Get the number of (hits, misses) of the prep code cache."""
+    return _ffi_api.PrepCodeCacheStats(True), _ffi_api.PrepCodeCacheStats(False)
+
+def get_prep_code_profile():
+    """Get the statistics recorded by prep code of functions built with
+    instrument_prep_code=True.
+
+    Returns
+    -------
+    profile : dict of str to dict
+        Maps function names to the number of calls, the total host wall
+        time in seconds, the number of auxiliary arrays and the total
+        number of bytes copied from the host to the device.
+    """
+    fields = ["calls", "seconds", "num_aux_arrays", "copied_bytes"]
+    profile = {}
+    for name in _ffi_api.PrepCodeProfileFunctions().splitlines():
+        profile[name] = {f: _ffi_api.PrepCodeProfileGet(name, f) for f in fields}
+    return profile
+
+def clear_prep_code_profile():
+    """Forget all recorded prep code statistics."""
+    _ffi_api.PrepCodeProfileClear()
+
+def patch_ragged_prefix_sum(aux, elem_offset, num_rows, rows, lengths):
+    """Incrementally update an A-function (prefix sum) array stored in
+    an auxiliary buffer after the lengths of a few rows changed,
+    instead of rerunning the whole prep code.
+
+    Parameters
+    ----------
+    aux : NDArray
+        The int32 auxiliary buffer holding the array, on the host or
+        the device.
+
+    elem_offset : int
+        The offset of the array in aux, in elements.
+
+    num_rows : int
+        The number of lengths the array was computed from. The array
+        itself holds num_rows + 1 elements.
+
+    rows : NDArray
+        The int32 indices of the changed rows, on the host.
+
+    lengths : NDArray
+        The int32 new lengths of all num_rows rows, on the host. Only
+        the entry before the first changed row is read from aux, the
+        later ones are rebuilt from these lengths.
+    """
+    _ffi_api.RaggedPrefixSumPatch(aux, elem_offset, num_rows, rows, lengths)
 
 # profile result of time evaluator
 ProfileResult = namedtuple("ProfileResult", ["mean", "results"])
@@ -117,6 +236,11 @@ class Module(object):
         # pylint: disable=not-callable
         return self.entry_func(*args)
 
+    def bind(self, *args):
+        """Bind the arguments of repeated calls of the entry function,
+        see PackedFunc.bind."""
+        return self.entry_func.bind(*args)
+
 
     def __repr__(self):
         return "Module(%s, %x)" % (self.type_key, self.handle.value)
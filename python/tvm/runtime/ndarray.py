@@ -121,6 +121,15 @@ class NDArray(NDArrayBase):
             source_array.copyto(self)
             return self
 
+        source_array = self._contiguous_source(source_array, is_dst_ragged)
+        data = source_array.ctypes.data_as(ctypes.c_void_p)
+        nbytes = ctypes.c_size_t(source_array.size * source_array.dtype.itemsize)
+        check_call(_LIB.TVMArrayCopyFromBytes(self.handle, data, nbytes, is_dst_ragged))
+        return self
+
+    def _contiguous_source(self, source_array, is_dst_ragged):
+        """The data of source_array as a contiguous numpy array of the
+        type of the array."""
         if not isinstance(source_array, np.ndarray):
             try:
                 source_array = np.array(source_array, dtype=self.dtype)
@@ -140,10 +149,7 @@ class NDArray(NDArrayBase):
                 source_array.shape, shape))
         source_array = np.ascontiguousarray(source_array, dtype=dtype)
         assert source_array.flags['C_CONTIGUOUS']
-        data = source_array.ctypes.data_as(ctypes.c_void_p)
-        nbytes = ctypes.c_size_t(source_array.size * source_array.dtype.itemsize)
-        check_call(_LIB.TVMArrayCopyFromBytes(self.handle, data, nbytes, is_dst_ragged))
-        return self
+        return source_array
 
     def create_view(self, shape_l, dtype="float32"):
         shape = c_array(tvm_shape_index_t, shape_l)
@@ -158,6 +164,30 @@ class NDArray(NDArrayBase):
             ctypes.byref(handle)))
         return _make_array(handle, True, False)
 
+    def create_offset_view(self, elem_offset, shape_l, elem_limit=-1):
+        """Create a view of this array starting elem_offset elements
+        into it, without copying. If elem_limit is given, the view
+        must end before it, e.g. at the end of its ragged row."""
+        shape = c_array(tvm_shape_index_t, shape_l)
+        ndim = ctypes.c_int(len(shape_l))
+        handle = TVMArrayHandle()
+        check_call(_LIB.TVMArrayCreateOffsetView(
+            self.handle, ctypes.c_int64(elem_offset), shape, ndim,
+            ctypes.c_int64(elem_limit), ctypes.byref(handle)))
+        return _make_array(handle, True, False)
+
+    def create_ragged_view(self, dense_shape, flat_size):
+        """Create a ragged array with the given dense shape that shares
+        the packed data held by this array, without copying. flat_size
+        is the number of elements in its rows, which must fit in this
+        array."""
+        shape = c_array(tvm_shape_index_t, dense_shape)
+        ndim = ctypes.c_int(len(dense_shape))
+        handle = TVMArrayHandle()
+        check_call(_LIB.TVMArrayCreateRaggedView(
+            self.handle, shape, ndim, ctypes.c_int64(flat_size), ctypes.byref(handle)))
+        return _make_array(handle, True, False)
+
     def __repr__(self):
         res = "<tvm.nd.NDArray shape={0}, {1}>\n".format(self.shape, self.context)
         res += self.asnumpy().__repr__()
@@ -333,6 +363,37 @@ def ragged_empty(shape, flatsize, dtype="float32", ctx=context(1, 0)):
     return _make_array(handle, False, False)
 
 
+def copyfrom_batch(arrays, source_arrays, is_dst_ragged=False):
+    """Copy numpy arrays into many arrays of the same context at once.
+
+    The sources are packed into one staging buffer and copied to the
+    device with a single transfer, instead of one transfer per array,
+    which saves round trips on the input path of requests with many
+    small ragged inputs (lengths, ids, masks).
+
+    Parameters
+    ----------
+    arrays : list of NDArray
+        The arrays to copy to.
+
+    source_arrays : list of array_like
+        The data to copy, one per array.
+
+    is_dst_ragged : bool, optional
+        Whether the arrays are ragged, in which case the sources may
+        be smaller than their dense shapes.
+    """
+    if len(arrays) != len(source_arrays):
+        raise ValueError("Need one source per array")
+    sources = [arr._contiguous_source(src, is_dst_ragged)
+               for arr, src in zip(arrays, source_arrays)]
+    num = len(arrays)
+    handles = (TVMArrayHandle * num)(*[arr.handle for arr in arrays])
+    data = (ctypes.c_void_p * num)(*[src.ctypes.data for src in sources])
+    nbytes = (ctypes.c_size_t * num)(*[src.size * src.dtype.itemsize for src in sources])
+    check_call(_LIB.TVMArrayCopyFromBytesBatch(handles, data, nbytes, ctypes.c_int(num)))
+
+
 def from_dlpack(dltensor):
     """Produce an array from a DLPack tensor without memory copy.
     Retreives the underlying DLPack tensor's pointer to create an array from the
@@ -383,6 +444,22 @@ def gpu(dev_id=0):
     """
     return TVMContext(2, dev_id)
 
+def cpu_pinned(dev_id=0):
+    """Construct a context for page-locked host memory, pinned for
+    transfers to the GPU
+
+    Parameters
+    ----------
+    dev_id : int, optional
+        The integer device id
+
+    Returns
+    -------
+    ctx : TVMContext
+        The created context
+    """
+    return TVMContext(3, dev_id)
+
 def rocm(dev_id=0):
     """Construct a ROCM device
 
@@ -540,5 +617,210 @@ def array(arr, ctx=cpu(0)):
         arr = np.array(arr)
     return empty(arr.shape, arr.dtype, ctx).copyfrom(arr)
 
+
+class RaggedNDArray(object):
+    """A packed ragged array: the rows of a ragged tensor stored back
+    to back in one flat allocation, together with their lengths.
+
+    Row i has shape (lengths[i],) + inner_shape and starts
+    offsets[i] elements into data.
+
+    Parameters
+    ----------
+    data : NDArray
+        The flat data, as created by ragged_empty.
+
+    lengths : NDArray
+        The int32 row lengths.
+
+    inner_shape : tuple of int
+        The dense trailing shape of every row element.
+    """
+    def __init__(self, data, lengths, inner_shape=()):
+        self.data = data
+        self.lengths = lengths
+        self.inner_shape = tuple(inner_shape)
+        self._host_lengths = lengths.asnumpy().astype("int64")
+        inner_size = int(np.prod(self.inner_shape)) if self.inner_shape else 1
+        self.offsets = np.concatenate(
+            [[0], np.cumsum(self._host_lengths * inner_size)]).astype("int64")
+
+    def __len__(self):
+        return len(self._host_lengths)
+
+    @property
+    def flat_size(self):
+        """The number of elements actually stored."""
+        return int(self.offsets[-1])
+
+    def sequence(self, i):
+        """A zero-copy view of row i."""
+        shape = (int(self._host_lengths[i]),) + self.inner_shape
+        return self.data.create_offset_view(int(self.offsets[i]), shape,
+                                            int(self.offsets[i + 1]))
+
+    def sequences(self):
+        """Zero-copy views of all the rows."""
+        return [self.sequence(i) for i in range(len(self))]
+
+    def to_dlpack(self):
+        """Export as a pair of DLPack tensors without copying: the
+        packed values, of shape (sum(lengths),) + inner_shape, and the
+        int64 row offsets, of shape (len(self) + 1,). This is the
+        values/offsets form used by jagged tensors in frameworks."""
+        total_rows = int(self._host_lengths.sum())
+        values = self.data.create_offset_view(0, (total_rows,) + self.inner_shape,
+                                              self.flat_size)
+        row_offsets = np.concatenate([[0], np.cumsum(self._host_lengths)]).astype("int64")
+        return values.to_dlpack(), array(row_offsets).to_dlpack()
+
+    def packed_args(self):
+        """The (lengths, data) arguments to pass to a generated function
+        for this array."""
+        return self.lengths, self.data
+
+
+def ragged_array(sequences, dtype=None, ctx=cpu(0), lengths_ctx=cpu(0)):
+    """Pack a list of arrays with equal trailing shapes into a
+    RaggedNDArray, with a single copy per array.
+
+    Parameters
+    ----------
+    sequences : list of numpy.ndarray
+        The rows of the ragged array.
+
+    dtype : str, optional
+        The data type. Defaults to the type of the first row.
+
+    ctx : TVMContext, optional
+        The context of the data.
+
+    lengths_ctx : TVMContext, optional
+        The context of the lengths.
+
+    Returns
+    -------
+    ret : RaggedNDArray
+        The packed array
+    """
+    sequences = [np.asarray(seq) for seq in sequences]
+    if not sequences:
+        raise ValueError("Cannot create a ragged array with no rows")
+    dtype = str(sequences[0].dtype) if dtype is None else dtype
+    inner_shape = sequences[0].shape[1:]
+    for seq in sequences:
+        if seq.shape[1:] != inner_shape:
+            raise ValueError("All rows of a ragged array need the same inner shape")
+    lengths = np.array([seq.shape[0] for seq in sequences], dtype="int32")
+    flat = np.concatenate([seq.reshape(-1) for seq in sequences]).astype(dtype)
+    dense_shape = (len(sequences), max(int(lengths.max()), 1)) + tuple(inner_shape)
+    data = ragged_empty(dense_shape, max(flat.size, 1), dtype, ctx)
+    data.copyfrom(flat, is_dst_ragged=True)
+    return RaggedNDArray(data, array(lengths, lengths_ctx), inner_shape)
+
+
+def ragged_from_dlpack(values, offsets, lengths_ctx=cpu(0)):
+    """Import a jagged tensor given as DLPack values and row offsets
+    tensors, as produced by RaggedNDArray.to_dlpack, without copying
+    the values.
+
+    Parameters
+    ----------
+    values : DLPack tensor
+        The packed values, of shape (total_rows,) + inner_shape.
+
+    offsets : DLPack tensor
+        The integer row offsets, of shape (num_rows + 1,).
+
+    lengths_ctx : TVMContext, optional
+        The context of the lengths of the result.
+
+    Returns
+    -------
+    ret : RaggedNDArray
+        The ragged array, sharing the memory of values.
+    """
+    values = from_dlpack(values)
+    row_offsets = from_dlpack(offsets).asnumpy().astype("int64")
+    lengths = np.diff(row_offsets).astype("int32")
+    if row_offsets[0] != 0:
+        raise ValueError("Row offsets of a jagged tensor must start at 0")
+    inner_shape = tuple(values.shape[1:])
+    max_len = max(int(lengths.max()), 1) if lengths.size > 0 else 1
+    inner_size = int(np.prod(inner_shape)) if inner_shape else 1
+    flat_size = int(row_offsets[-1]) * inner_size if row_offsets.size > 0 else 0
+    data = values.create_ragged_view((len(lengths), max_len) + inner_shape, flat_size)
+    return RaggedNDArray(data, array(lengths, lengths_ctx), inner_shape)
+
+
+def ragged_from_data(data, offsets, inner_shape=(), dtype="float32", ctx=cpu(0),
+                     lengths_ctx=cpu(0)):
+    """Bind packed ragged data owned by the caller, such as inputs
+    already resident on the device, as a RaggedNDArray without copying
+    it.
+
+    Parameters
+    ----------
+    data : int or ctypes.c_void_p
+        The address of the packed values, of shape
+        (total_rows,) + inner_shape, on ctx. It must stay alive, and is
+        never freed, while the result is in use.
+
+    offsets : numpy.ndarray or NDArray
+        The integer row offsets, of shape (num_rows + 1,).
+
+    inner_shape : tuple of int, optional
+        The dense trailing shape of every row element.
+
+    dtype : str, optional
+        The data type of the values.
+
+    ctx : TVMContext, optional
+        The context of the values.
+
+    lengths_ctx : TVMContext, optional
+        The context of the lengths of the result.
+
+    Returns
+    -------
+    ret : RaggedNDArray
+        The ragged array, sharing the memory of data.
+    """
+    if isinstance(offsets, NDArray):
+        offsets = offsets.asnumpy()
+    row_offsets = np.asarray(offsets).astype("int64")
+    if row_offsets.size == 0 or row_offsets[0] != 0:
+        raise ValueError("Row offsets of a ragged array must start at 0")
+    lengths = np.diff(row_offsets).astype("int32")
+    max_len = max(int(lengths.max()), 1) if lengths.size > 0 else 1
+    dense_shape = (len(lengths), max_len) + tuple(inner_shape)
+    shape = c_array(tvm_shape_index_t, dense_shape)
+    address = data.value if isinstance(data, ctypes.c_void_p) else data
+    handle = TVMArrayHandle()
+    dtype = DataType(dtype)
+    check_call(_LIB.TVMRaggedArrayFromData(
+        ctypes.c_void_p(address), shape, ctypes.c_int(len(dense_shape)),
+        ctypes.c_int(dtype.type_code),
+        ctypes.c_int(dtype.bits),
+        ctypes.c_int(dtype.lanes),
+        ctx.device_type,
+        ctx.device_id,
+        ctypes.byref(handle)))
+    return RaggedNDArray(_make_array(handle, False, False), array(lengths, lengths_ctx),
+                         inner_shape)
+
+
+def expand_ragged_args(*args):
+    """Replace every RaggedNDArray in args by its lengths and data, so
+    that the result can be passed to a generated function."""
+    ret = []
+    for arg in args:
+        if isinstance(arg, RaggedNDArray):
+            ret.extend(arg.packed_args())
+        else:
+            ret.append(arg)
+    return ret
+
+
 # Register back to FFI
 _set_class_ndarray(NDArray)
@@ -86,4 +86,22 @@ class Object(ObjectBase):
             self.handle = None
 
 
+class ObjectPool(object):
+    """Scope in which the objects, such as IR nodes, that the current
+    thread frees recycle their memory for the ones it allocates next.
+    The memory is released in bulk when the outermost scope exits.
+
+    .. code-block:: python
+
+      with tvm.runtime.ObjectPool():
+          func = tvm.lower(s, args, "cuda")
+    """
+    def __enter__(self):
+        _ffi_api.ObjectPoolEnter()
+        return self
+
+    def __exit__(self, ptype, value, trace):
+        _ffi_api.ObjectPoolExit()
+
+
 _set_class_object(Object)
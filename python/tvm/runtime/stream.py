@@ -0,0 +1,158 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Streams and events of a device.
+
+Generated functions launch their kernels, and the copies of their prep
+code, on the stream set for the calling thread. Running independent
+requests under different streams lets them overlap on one GPU:
+
+.. code-block:: python
+
+    s0, s1 = tvm.runtime.Stream(ctx), tvm.runtime.Stream(ctx)
+    with s0:
+        f(*args0)
+        done0 = s0.record_event()
+    with s1:
+        f(*args1)
+        done1 = s1.record_event()
+    done0.synchronize()
+    done1.synchronize()
+
+On devices that run their operations synchronously, such as the CPU,
+events are always complete.
+"""
+import ctypes
+
+from tvm._ffi.base import _LIB, check_call
+
+from . import _ffi_api
+
+
+class Event(object):
+    """An event, marking a point in a stream that the host or other
+    streams can wait for.
+
+    Parameters
+    ----------
+    ctx : TVMContext
+        The context of the event.
+    """
+    def __init__(self, ctx):
+        self.ctx = ctx
+        self.handle = _ffi_api.TVMEventCreate(ctx.device_type, ctx.device_id)
+
+    def __del__(self):
+        if _ffi_api is not None and self.handle is not None:
+            _ffi_api.TVMEventFree(self.ctx.device_type, self.ctx.device_id, self.handle)
+
+    def record(self, stream=None):
+        """Record the event at the current end of stream.
+
+        Parameters
+        ----------
+        stream : Stream, optional
+            The stream, by default the one set for the calling thread.
+        """
+        handle = stream.handle if stream is not None else _current(self.ctx)
+        _ffi_api.TVMEventRecord(self.ctx.device_type, self.ctx.device_id, self.handle, handle)
+
+    def synchronize(self):
+        """Wait until the operations before the event have completed."""
+        _ffi_api.TVMEventSynchronize(self.ctx.device_type, self.ctx.device_id, self.handle)
+
+    def query(self):
+        """Whether the operations before the event have completed,
+        without waiting for them."""
+        return bool(_ffi_api.TVMEventQuery(self.ctx.device_type, self.ctx.device_id,
+                                           self.handle))
+
+
+class Stream(object):
+    """A stream of execution of a device. Used as a context manager, it
+    is the stream the functions called in its scope run on.
+
+    Parameters
+    ----------
+    ctx : TVMContext
+        The context of the stream.
+    """
+    def __init__(self, ctx):
+        self.ctx = ctx
+        self.handle = ctypes.c_void_p()
+        check_call(_LIB.TVMStreamCreate(ctx.device_type, ctx.device_id,
+                                        ctypes.byref(self.handle)))
+        self._prev = []
+        self._owned = True
+
+    @classmethod
+    def current(cls, ctx):
+        """The stream set for the calling thread, which is not freed along
+        with the returned object.
+
+        Parameters
+        ----------
+        ctx : TVMContext
+            The context of the stream.
+        """
+        stream = cls.__new__(cls)
+        stream.ctx = ctx
+        stream.handle = _current(ctx)
+        stream._prev = []
+        stream._owned = False
+        return stream
+
+    def __del__(self):
+        if _LIB is not None and self.handle is not None and self._owned:
+            check_call(_LIB.TVMStreamFree(self.ctx.device_type, self.ctx.device_id, self.handle))
+
+    def __enter__(self):
+        self._prev.append(_current(self.ctx))
+        self._set(self.handle)
+        return self
+
+    def __exit__(self, ptype, value, trace):
+        self._set(self._prev.pop())
+
+    def _set(self, handle):
+        check_call(_LIB.TVMSetStream(self.ctx.device_type, self.ctx.device_id, handle))
+
+    def synchronize(self):
+        """Wait until all the operations enqueued on the stream have
+        completed."""
+        check_call(_LIB.TVMSynchronize(self.ctx.device_type, self.ctx.device_id, self.handle))
+
+    def record_event(self):
+        """Record an event at the current end of the stream.
+
+        Returns
+        -------
+        event : Event
+            The event, complete once the operations enqueued so far are.
+        """
+        event = Event(self.ctx)
+        event.record(self)
+        return event
+
+    def wait_event(self, event):
+        """Make the operations enqueued on the stream from now on wait
+        for event, without blocking the host."""
+        _ffi_api.TVMStreamWaitEvent(self.ctx.device_type, self.ctx.device_id, self.handle,
+                                    event.handle)
+
+
+def _current(ctx):
+    return _ffi_api.TVMGetStream(ctx.device_type, ctx.device_id)
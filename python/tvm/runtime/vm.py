@@ -164,6 +164,31 @@ class Executable(object):
 
         return Executable(_ffi_api.Load_Executable(bytecode, lib))
 
+    @staticmethod
+    def load_exec_from_file(file_name, lib):
+        """Construct an executable from bytecode saved to a file, mapping
+        the file into memory so that the constants are used in place
+        rather than read and copied.
+
+        Parameters
+        ----------
+        file_name : str
+            The file the bytecode returned by save was written to.
+
+        lib : :py:class:`~tvm.runtime.Module`
+            The runtime module that contains the generated code.
+
+        Returns
+        -------
+        exec: Executable
+            An executable constructed using the provided artifacts.
+        """
+        if lib is not None and not isinstance(lib, tvm.runtime.Module):
+            raise TypeError("lib is expected to be the type of tvm.runtime.Module" +
+                            ", but received {}".format(type(lib)))
+
+        return Executable(_ffi_api.Load_Executable_From_File(file_name, lib))
+
     @property
     def lib(self):
         """Get the library that contains hardware dependent code.
@@ -281,6 +306,7 @@ class VirtualMachine(object):
         self._init = self.mod["init"]
         self._invoke = self.mod["invoke"]
         self._set_input = self.mod["set_input"]
+        self._set_allocator = self.mod["set_allocator"]
 
     def init(self, ctx):
         """Initialize the context in the VM.
@@ -293,6 +319,36 @@ class VirtualMachine(object):
         args = [ctx.device_type, ctx.device_id]
         self._init(*args)
 
+    def set_allocator(self, ctx, kind, reserve_bytes=None):
+        """Set the allocator of the storage the VM allocates on a
+        context. It must be set before anything is allocated on the
+        context.
+
+        Parameters
+        ----------
+        ctx : :py:class:`TVMContext`
+            The context.
+
+        kind : str
+            "naive", "pooled", or "arena". An arena allocator carves
+            the storage of an invocation out of one device allocation,
+            which it rewinds at the start of the next invocation and
+            grows to what the previous ones needed. This suits ragged
+            intermediates whose sizes vary between invocations.
+
+        reserve_bytes : int, optional
+            For an arena, the bytes to allocate it with upfront, such
+            as the sum of the allocation sizes of the intermediates
+            computed by the prelude for the largest expected input.
+        """
+        kinds = {"naive": 1, "pooled": 2, "arena": 3}
+        if kind not in kinds:
+            raise ValueError("Unknown allocator kind {}".format(kind))
+        args = [ctx.device_type, ctx.device_id, kinds[kind]]
+        if reserve_bytes is not None:
+            args.append(reserve_bytes)
+        self._set_allocator(*args)
+
     def set_input(self, func_name, *args, **kwargs):
         """Set the input to a function.
 
@@ -122,6 +122,7 @@ class BuildConfig(Object):
         "auto_unroll_max_step": 0,
         "auto_unroll_max_depth": 8,
         "auto_unroll_max_extent": 0,
+        "auto_unroll_max_ragged_extent": 0,
         "unroll_explicit": True,
         "detect_global_barrier": False,
         "partition_const_loop": False,
@@ -129,6 +130,7 @@ class BuildConfig(Object):
         "data_alignment": -1,
         "restricted_func": True,
         "double_buffer_split_loop": 1,
+        "double_buffer_async_copy": False,
         "dump_pass_ir": False,
         "instrument_bound_checkers": False,
         "disable_select_rewriting": False,
@@ -138,7 +140,29 @@ class BuildConfig(Object):
         # Ragged options
         "prep_code_mode": "with_prep_code",
         "fill_in_function_bodies": True,
-        "hoist_loads": False
+        "hoist_loads": False,
+        "prep_code_on_device": False,
+        "fused_maps_on_the_fly": False,
+        "instrument_prep_code": False,
+        "instrument_block_cycles": False,
+        "ragged_arena_allocation": False,
+        "ragged_scan_early_exit": False,
+        "persistent_ragged_blocks": 0,
+        "persistent_ragged_chunk": 1,
+        "indirect_prefetch_distance": 0,
+        "partition_ragged_loops": False,
+        "schedule_ops_threads": 1,
+        "intern_exprs": False,
+        "eliminate_common_subexpr": False,
+        "pool_ir_nodes": False,
+        "aux_constant_memory": False,
+        "llvm_codegen_threads": 1,
+        "cuda_max_registers": 0,
+        "cuda_compile_threads": 1,
+        "parallel_schedule": "static",
+        "parallel_min_chunk": 1,
+        "fast_call_api": False,
+        "diagnose_ragged_bounds": False
     }
     _dump_ir = DumpIR()
 
@@ -207,6 +231,11 @@ def build_config(**kwargs):
     auto_unroll_max_depth: int, default=8
         The maximum nested level of loops that can be automatically unrolled.
 
+    auto_unroll_max_ragged_extent: int, default=0
+        The maximum upper bound of the extent of innermost ragged loops
+        that are unrolled into copies of their body guarded by the
+        length. 0 disables the unrolling of such loops.
+
     unroll_explicit: bool, default=True
         Whether explicitly unroll the loop, if set false, the unroll hint will
         be passed to the CodeGen phase, which may generate pragma unroll hint.
@@ -238,6 +267,11 @@ def build_config(**kwargs):
         It it is bigger than one, the logic will do a split with factor equals the integer
         and unroll the inner loop. This allows the buffer fetching won't contain condition.
 
+    double_buffer_async_copy: bool, default=False
+        Whether stores of global loads into double buffered shared memory are turned
+        into asynchronous copies (cp.async), overlapping the fetches of the following
+        stages with computation. Requires a CUDA device of compute capability 8.0.
+
     add_lower_pass: list of tuple (phase, function(Stmt->Stmt)), default=None
         phase contains an integer on which optimization pass we apply the pass.
         Additional lowering passes to be applied before make_api.
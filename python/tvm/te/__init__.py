@@ -23,7 +23,11 @@ from tvm.tir import trunc, abs, round, nearbyint, isnan, power, popcount, fmod,
 from tvm.tir import div, indexdiv, indexmod, truncdiv, truncmod, floordiv, floormod
 from tvm.tir import comm_reducer, min, max, sum
 
-from .schedule import Schedule, create_schedule, fuse_ragged_axis
+from .schedule import Schedule, create_schedule, fuse_ragged_axis, fuse_ragged_axes
+from .layout_planner import choose_storage_layouts, fold_layout_conversions
+from .wavefront import compute_levels, LevelBatches
+from .paged import PagePool
+from .block_sparse import BlockSparsePattern
 from .tensor import Tensor
 from .tensor_intrin import decl_tensor_intrin
 from .tag import tag_scope
@@ -0,0 +1,130 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Block sparse attention patterns.
+
+A block sparse pattern splits the queries and keys of a sequence into
+blocks, and lists for each query block the key blocks it attends to,
+in the BSR form of an indptr and an indices array. Local windows,
+global blocks and the random blocks of BigBird are built here on the
+host, and combined by union:
+
+.. code-block:: python
+
+  pattern = tvm.te.BlockSparsePattern.bigbird(num_blocks, window=1, num_global=1,
+                                              num_random=2)
+  # pattern.indptr and pattern.indices are passed as the inputs of
+  # topi.nn.block_sparse_attention, whose loops over the key blocks of
+  # a query block only visit the listed ones.
+
+The key blocks of a query block are a ragged dimension of length
+indptr[qb + 1] - indptr[qb], see tvm.tir.Modes.block_sparse_storage_layout,
+so the work and the storage of the scores are those of the nonzero
+blocks only.
+"""
+import numpy as np
+
+
+class BlockSparsePattern(object):
+    """The key blocks each query block attends to.
+
+    Attributes
+    ----------
+    indptr : numpy.ndarray
+        A (num_blocks + 1,) int32 array. The key blocks of query block
+        qb are indices[indptr[qb]:indptr[qb + 1]].
+
+    indices : numpy.ndarray
+        The int32 key blocks of all the query blocks, sorted for each.
+    """
+    def __init__(self, indptr, indices):
+        self.indptr = np.asarray(indptr, dtype='int32')
+        self.indices = np.asarray(indices, dtype='int32')
+
+    @property
+    def num_blocks(self):
+        """The number of query blocks."""
+        return self.indptr.size - 1
+
+    @property
+    def max_blocks_per_row(self):
+        """The largest number of key blocks of a query block."""
+        return int(np.diff(self.indptr).max()) if self.num_blocks > 0 else 0
+
+    @property
+    def density(self):
+        """The fraction of the blocks of the dense pattern present."""
+        return float(self.indices.size) / max(self.num_blocks * self.num_blocks, 1)
+
+    def to_mask(self):
+        """The (num_blocks, num_blocks) boolean mask of the pattern."""
+        mask = np.zeros((self.num_blocks, self.num_blocks), dtype='bool')
+        for qb in range(self.num_blocks):
+            mask[qb, self.indices[self.indptr[qb]:self.indptr[qb + 1]]] = True
+        return mask
+
+    @staticmethod
+    def from_mask(mask):
+        """The pattern of a (num_blocks, num_blocks) boolean mask."""
+        mask = np.asarray(mask, dtype='bool')
+        indptr = np.concatenate([[0], np.cumsum(mask.sum(axis=1))])
+        indices = np.concatenate([np.nonzero(row)[0] for row in mask]) if mask.size else []
+        return BlockSparsePattern(indptr, indices)
+
+    @staticmethod
+    def union(*patterns):
+        """The blocks present in any of patterns."""
+        mask = patterns[0].to_mask()
+        for pattern in patterns[1:]:
+            mask |= pattern.to_mask()
+        return BlockSparsePattern.from_mask(mask)
+
+    @staticmethod
+    def sliding_window(num_blocks, window):
+        """Each query block attends to the key blocks at most window
+        blocks away from it."""
+        qb = np.arange(num_blocks)[:, None]
+        kb = np.arange(num_blocks)[None, :]
+        return BlockSparsePattern.from_mask(np.abs(qb - kb) <= window)
+
+    @staticmethod
+    def global_blocks(num_blocks, num_global):
+        """The first num_global blocks attend to and are attended by all
+        the blocks."""
+        mask = np.zeros((num_blocks, num_blocks), dtype='bool')
+        mask[:num_global, :] = True
+        mask[:, :num_global] = True
+        return BlockSparsePattern.from_mask(mask)
+
+    @staticmethod
+    def random_blocks(num_blocks, num_random, seed=0):
+        """Each query block attends to num_random key blocks drawn at
+        random."""
+        rng = np.random.RandomState(seed)
+        mask = np.zeros((num_blocks, num_blocks), dtype='bool')
+        num_random = min(num_random, num_blocks)
+        for qb in range(num_blocks):
+            mask[qb, rng.choice(num_blocks, num_random, replace=False)] = True
+        return BlockSparsePattern.from_mask(mask)
+
+    @staticmethod
+    def bigbird(num_blocks, window, num_global, num_random, seed=0):
+        """The union of a sliding window, global blocks and random blocks,
+        as in BigBird."""
+        return BlockSparsePattern.union(
+            BlockSparsePattern.sliding_window(num_blocks, window),
+            BlockSparsePattern.global_blocks(num_blocks, num_global),
+            BlockSparsePattern.random_blocks(num_blocks, num_random, seed))
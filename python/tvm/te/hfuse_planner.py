@@ -0,0 +1,217 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Automatic selection of horizontal fusion groups.
+
+Schedule.hfuse fuses the outermost block loops of independent GPU
+stages into a single kernel by concatenating their grids. The planner
+here picks the groups: stages whose grids are too small to fill the
+device are packed together into grids that do, as long as they do not
+depend on each other and launch blocks of the same shape.
+"""
+from tvm.tir import IntImm
+
+from . import schedule as _schedule
+
+# AttachType::kGroupRoot
+_GROUP_ROOT = 1
+
+
+class HFuseCandidate(object):
+    """A root stage whose outermost leaf loop is bound to blockIdx.x.
+
+    Attributes
+    ----------
+    op : Operation
+        The operation of the stage.
+
+    iv : IterVar
+        The outermost leaf itervar, which would be hfused.
+
+    blocks : int
+        The number of thread blocks the stage launches.
+
+    threads : tuple of (str, int)
+        The extents of the threadIdx axes the stage is bound to.
+
+    work : float
+        The estimated work of the stage.
+    """
+    def __init__(self, op, iv, blocks, threads, work):
+        self.op = op
+        self.iv = iv
+        self.blocks = blocks
+        self.threads = threads
+        self.work = work
+
+
+class _Group(object):
+    def __init__(self, candidate):
+        self.members = [candidate]
+        self.blocks = candidate.blocks
+        self.work = candidate.work
+        self.threads = candidate.threads
+
+    def add(self, candidate):
+        self.members.append(candidate)
+        self.blocks += candidate.blocks
+        self.work += candidate.work
+
+
+def _const_extent(bounds, iv):
+    """The constant extent of iv, or None if it is not known."""
+    rng = bounds[iv] if iv in bounds else iv.dom
+    if rng is not None and isinstance(rng.extent, IntImm):
+        return rng.extent.value
+    return None
+
+
+def _candidates(sch, bounds, work):
+    ret = []
+    for stage in sch.stages:
+        if stage.attach_type != _GROUP_ROOT or stage.group is not None:
+            continue
+        leaf_ivs = list(stage.leaf_iter_vars)
+        if not leaf_ivs or leaf_ivs[0] not in stage.iter_var_attrs:
+            continue
+        attr = stage.iter_var_attrs[leaf_ivs[0]]
+        if (attr.bind_thread is None or attr.bind_thread.thread_tag != "blockIdx.x" or
+                attr.hfuse_group_id >= 0):
+            continue
+        blocks = _const_extent(bounds, leaf_ivs[0])
+        if blocks is None:
+            blocks = _const_extent(bounds, attr.bind_thread)
+        if blocks is None:
+            continue
+
+        threads = []
+        per_block_work = 1
+        for iv in leaf_ivs[1:]:
+            extent = _const_extent(bounds, iv)
+            if extent is None:
+                # Loops with a ragged extent are bounded by their
+                # maximum in the inferred bounds, so this is rare.
+                continue
+            per_block_work *= extent
+            iv_attr = stage.iter_var_attrs[iv] if iv in stage.iter_var_attrs else None
+            if (iv_attr is not None and iv_attr.bind_thread is not None and
+                    iv_attr.bind_thread.thread_tag.startswith("threadIdx")):
+                threads.append((iv_attr.bind_thread.thread_tag, extent))
+
+        if work is not None and stage.op in work:
+            stage_work = float(work[stage.op])
+        else:
+            stage_work = float(blocks * per_block_work)
+        ret.append(HFuseCandidate(stage.op, leaf_ivs[0], blocks, tuple(sorted(threads)),
+                                  stage_work))
+    return ret
+
+
+class _Dependences(object):
+    """Transitive producers of operations in a schedule."""
+    def __init__(self):
+        self.producers = {}
+
+    def get(self, op):
+        if op not in self.producers:
+            ret = set()
+            for t in op.input_tensors:
+                ret.add(t.op)
+                ret |= self.get(t.op)
+            self.producers[op] = ret
+        return self.producers[op]
+
+    def independent(self, op1, op2):
+        return op1 not in self.get(op2) and op2 not in self.get(op1)
+
+
+def plan_hfuse(sch, num_sms, blocks_per_sm=1, work=None, max_group_size=8,
+               match_threads=True, weighted=False, apply=True):
+    """Pick groups of independent GPU stages to horizontally fuse.
+
+    Stages whose grids already fill the device are left alone. The
+    others are considered from the most to the least work, and each is
+    added to the group whose fused grid it fills best (without
+    exceeding the device), preferring the group with the least work so
+    far on ties. Stages that fit in no group start a new one.
+
+    Parameters
+    ----------
+    sch : Schedule
+        The schedule. Candidates are stages attached at the root whose
+        outermost leaf itervar is bound to blockIdx.x.
+
+    num_sms : int
+        The number of streaming multiprocessors of the device.
+
+    blocks_per_sm : int, optional
+        The number of thread blocks that can be resident on one SM.
+
+    work : dict of Operation to float, optional
+        Estimated work of stages. By default, the product of the
+        constant leaf loop extents of the stage is used.
+
+    max_group_size : int, optional
+        The maximum number of stages fused into one kernel.
+
+    match_threads : bool, optional
+        Whether only stages with the same thread block shape are fused,
+        so that no threads of the fused kernel idle.
+
+    weighted : bool, optional
+        Whether the blocks of fused stages are interleaved by their
+        per-block work instead of being concatenated.
+
+    apply : bool, optional
+        Whether to call Schedule.hfuse on the chosen groups.
+
+    Returns
+    -------
+    groups : list of list of Operation
+        The chosen groups.
+    """
+    capacity = num_sms * blocks_per_sm
+    bounds = _schedule.InferBound(sch.normalize())
+    candidates = [c for c in _candidates(sch, bounds, work) if c.blocks < capacity]
+    candidates.sort(key=lambda c: c.work, reverse=True)
+
+    deps = _Dependences()
+    groups = []
+    for candidate in candidates:
+        best = None
+        for group in groups:
+            if len(group.members) >= max_group_size:
+                continue
+            if match_threads and group.threads != candidate.threads:
+                continue
+            if group.blocks + candidate.blocks > capacity:
+                continue
+            if not all(deps.independent(candidate.op, m.op) for m in group.members):
+                continue
+            if (best is None or group.blocks > best.blocks or
+                    (group.blocks == best.blocks and group.work < best.work)):
+                best = group
+        if best is None:
+            groups.append(_Group(candidate))
+        else:
+            best.add(candidate)
+
+    groups = [g for g in groups if len(g.members) > 1]
+    if apply:
+        for group in groups:
+            weights = [m.work / max(m.blocks, 1) for m in group.members] if weighted else None
+            sch.hfuse([(m.op, m.iv) for m in group.members], weights)
+    return [[m.op for m in group.members] for group in groups]
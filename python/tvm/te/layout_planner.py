@@ -0,0 +1,258 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Cost based choice between ragged and padded intermediate storage.
+
+A ragged storage layout saves the memory traffic and compute of the
+padding, but every access then goes through the prelude computed
+offsets, and the ragged loops over it need predicates. When lengths
+are close to their maximum, the padded layout is cheaper. Given the
+distribution of the lengths of the ragged dimensions, the planner here
+estimates both costs and makes the storage of intermediate tensors
+dense where raggedness does not pay off.
+
+Where a ragged tensor meets a dense one, explicit conversions, which
+copy a tensor into the other layout with zero fill, each cost a pass
+over global memory. fold_layout_conversions folds them into the
+neighboring operations instead.
+"""
+import numpy as np
+
+from tvm.tir import IntImm, FloatImm, Select, Call
+from tvm.tir.modes import Modes
+
+from .tensor import BaseComputeOp, ComputeOp
+
+
+class LayoutDecision(object):
+    """The layout chosen for one output of an operation.
+
+    Attributes
+    ----------
+    op : Operation
+        The operation.
+
+    value_index : int
+        The output of the operation.
+
+    dense : bool
+        Whether the padded layout was chosen.
+
+    saved : float
+        The estimated elements of work the ragged layout saves.
+
+    overhead : float
+        The estimated cost, in the same unit, of the ragged layout.
+    """
+    def __init__(self, op, value_index, dense, saved, overhead):
+        self.op = op
+        self.value_index = value_index
+        self.dense = dense
+        self.saved = saved
+        self.overhead = overhead
+
+
+def _intermediate_ops(outputs):
+    """Compute operations reachable from, but excluding, the outputs."""
+    output_ops = set(t.op for t in outputs)
+    visited = set()
+    ret = []
+
+    def visit(op):
+        if op in visited:
+            return
+        visited.add(op)
+        for t in op.input_tensors:
+            visit(t.op)
+        if op not in output_ops and isinstance(op, BaseComputeOp):
+            ret.append(op)
+
+    for t in outputs:
+        visit(t.op)
+    return ret
+
+
+def _fill_fraction(lengths):
+    """Mean over max of a sample of lengths, and the sample size."""
+    lengths = np.asarray(lengths, dtype="float64")
+    if lengths.size == 0 or lengths.max() <= 0:
+        return 1.0, 0
+    return float(lengths.mean() / lengths.max()), lengths.size
+
+
+def choose_storage_layouts(outputs, lengths, indirection_cost=0.1, predication_cost=0.05,
+                           prelude_cost=4.0, apply=True):
+    """Choose between the ragged and padded storage of intermediates.
+
+    For a ragged storage layout, the padding saved is estimated as the
+    dense size times one minus the fill fraction, the product over the
+    ragged dimensions of mean over maximum length. Its overhead is the
+    per element cost of indirection and predication over the elements
+    actually stored, plus the prelude, which computes offsets once per
+    row of each ragged dimension. The padded layout is chosen when the
+    overhead exceeds the savings.
+
+    Parameters
+    ----------
+    outputs : list of Tensor
+        The outputs of the computation. Their layouts, as well as those
+        of placeholders, are part of the interface and left as is.
+
+    lengths : dict of Dimension to list of int
+        A sample, e.g. from a representative batch, of the lengths of
+        each ragged dimension. Ragged dimensions with no sample are
+        assumed to be full.
+
+    indirection_cost : float, optional
+        The cost per stored element of computing ragged offsets,
+        relative to the work on an element.
+
+    predication_cost : float, optional
+        The cost per stored element of the predicates of ragged loops.
+
+    prelude_cost : float, optional
+        The cost per row of computing the offsets in the prelude.
+
+    apply : bool, optional
+        Whether to set the chosen dense layouts on the operations.
+
+    Returns
+    -------
+    decisions : list of LayoutDecision
+        The decisions for all ragged outputs of intermediate operations
+        with a constant padded size.
+    """
+    ret = []
+    for op in _intermediate_ops(outputs):
+        for i in range(op.num_outputs):
+            layout = op.output_layout(i)
+            if layout is None or not layout.is_ragged():
+                continue
+            dense_shape = layout.dense_shape()
+            if not all(isinstance(e, IntImm) for e in dense_shape):
+                continue
+            n_dense = float(np.prod([e.value for e in dense_shape]))
+
+            fill, rows = 1.0, 0
+            for j, dim in enumerate(layout.dimensions):
+                if not layout.is_ragged_dim(j) or dim not in lengths:
+                    continue
+                dim_fill, dim_rows = _fill_fraction(lengths[dim])
+                fill *= dim_fill
+                rows += dim_rows
+
+            saved = n_dense * (1.0 - fill)
+            overhead = (n_dense * fill * (indirection_cost + predication_cost) +
+                        prelude_cost * rows)
+            dense = overhead > saved
+            if dense and apply:
+                op.set_storage_layout(
+                    i, Modes(layout.dimensions, dense_shape, [], {}))
+            ret.append(LayoutDecision(op, i, dense, saved, overhead))
+    return ret
+
+
+def _is_zero(expr):
+    return isinstance(expr, (IntImm, FloatImm)) and expr.value == 0
+
+
+def _converted_tensor(op):
+    """The tensor op converts to another storage layout, or None.
+
+    A conversion copies a tensor of the same rank at the same indices,
+    optionally guarded by a condition outside of which it is zero, and
+    is ragged in its output when the tensor is dense or vice versa.
+    """
+    if not isinstance(op, ComputeOp) or op.num_outputs != 1 or op.reduce_axis:
+        return None
+    body = op.body[0]
+    if isinstance(body, Select) and _is_zero(body.false_value):
+        body = body.true_value
+    elif (isinstance(body, Call) and body.name == "tvm_if_then_else" and
+          _is_zero(body.args[2])):
+        body = body.args[1]
+    if not isinstance(body, Call) or body.call_type != Call.Halide:
+        return None
+    axis = [iv.var for iv in op.axis]
+    if len(body.args) != len(axis) or not all(a.same_as(v) for a, v in zip(body.args, axis)):
+        return None
+    tensor = body.func.output(body.value_index)
+
+    def is_ragged(layout):
+        return layout is not None and layout.is_ragged()
+
+    if is_ragged(op.output_layout(0)) == is_ragged(tensor.op.output_layout(tensor.value_index)):
+        return None
+    return tensor
+
+
+def fold_layout_conversions(sch, outputs):
+    """Fold the conversions between ragged and dense storage into the
+    operations next to them, saving a pass over memory per conversion.
+
+    A conversion that is not an output is inlined into its consumers,
+    which then read the converted tensor through its own layout, under
+    the guard of the conversion. A conversion that is an output absorbs
+    its producer instead, when the producer is an elementwise compute
+    read by nothing else, so that the values are written directly into
+    the converted layout, zero filled by the guard.
+
+    Parameters
+    ----------
+    sch : Schedule
+        The schedule, whose stages of the folded operations are inlined.
+
+    outputs : list of Tensor
+        The outputs of the computation.
+
+    Returns
+    -------
+    folded : list of Operation
+        The operations inlined.
+    """
+    output_ops = set(t.op for t in outputs)
+    consumers = {}
+    ops = []
+    visited = set()
+
+    def visit(op):
+        if op in visited:
+            return
+        visited.add(op)
+        for t in op.input_tensors:
+            consumers.setdefault(t.op, set()).add(op)
+            visit(t.op)
+        ops.append(op)
+
+    for t in outputs:
+        visit(t.op)
+
+    folded = []
+    for op in ops:
+        tensor = _converted_tensor(op)
+        if tensor is None:
+            continue
+        if op not in output_ops:
+            sch[op].compute_inline()
+            folded.append(op)
+            continue
+        producer = tensor.op
+        if (isinstance(producer, ComputeOp) and producer.num_outputs == 1 and
+                not producer.reduce_axis and producer not in output_ops and
+                producer not in folded and consumers.get(producer) == {op}):
+            sch[producer].compute_inline()
+            folded.append(producer)
+    return folded
@@ -544,7 +544,24 @@ def indirect_scan(range_min_uf, range_max_uf, scan_dim, init, update, state_plac
     return res[0] if len(res) == 1 else res
 
 def conditional(condition_uf, from_then, then_case, from_else,
-                else_case, explicit_dim_ufs = [], name="scan", tag="", attrs=None):
+                else_case, explicit_dim_ufs = [], name="scan", tag="", attrs=None,
+                lowering="branch"):
+    """Construct new tensors by choosing between two cases per element.
+
+    Parameters
+    ----------
+    lowering: str, optional
+        How the condition is lowered. 'branch' guards each case by an
+        if-then-else. 'predicated' computes both cases for all elements
+        and selects between them, which avoids divergence when the
+        cases are cheap; both cases must be safe to evaluate for every
+        element. 'partitioned' iterates over the elements, of the
+        single explicit dimension, reordered in the prep code such
+        that the ones taking the then case come first, so that
+        branches only diverge at one boundary. The condition must then
+        be computable from the auxiliary data available to the prep
+        code.
+    """
     if _tag.TagScope.get_current() is not None:
         if tag != "":
             raise ValueError("nested tag is not allowed for now")
@@ -568,17 +585,28 @@ def conditional(condition_uf, from_then, then_case, from_else,
             exp_min_ufs.append(dim_uf[1])
             exp_max_ufs.append(dim_uf[2])
 
+    if lowering != "branch":
+        attrs = dict(attrs) if attrs else {}
+        attrs["lowering"] = lowering
+
     op = _ffi_api.ConditionalOp(name, tag, attrs,
                                 condition_uf, from_then, then_case, from_else,
                                 else_case, exp_dims, exp_min_ufs, exp_max_ufs)
     res = [op.output(i) for i in range(len(then_case))]
     return res[0] if len(res) == 1 else res
 
-def specialization_envelope(scans, inputs=None, name="scan", tag="", attrs=None):
+def specialization_envelope(scans, inputs=None, name="scan", tag="", attrs=None,
+                            dispatch_conditions=None):
     """Construct new tensors by scanning over axis.
 
     Parameters
     ----------
+    dispatch_conditions: list of Expr, optional
+        If given, only one of the specializations runs, and computes
+        the whole output: the first one whose condition holds, with the
+        last specialization, which has no condition, as the fallback.
+        The choice is made once per call.
+
     name: str, optional
         The name hint of the tensor
 
@@ -593,6 +621,10 @@ def specialization_envelope(scans, inputs=None, name="scan", tag="", attrs=None)
     tensor: Tensor or list of Tensors
         The created tensor or tuple of tensors it it contains multiple outputs.
     """
+    if dispatch_conditions is not None:
+        attrs = dict(attrs) if attrs else {}
+        attrs["dispatch_conditions"] = dispatch_conditions
+
     op = _ffi_api.SpecializationEnvelopeOp(name, tag, attrs,
                                  scans)
     res = [op.output(i) for i in range(len(scans[0]))]
@@ -607,7 +639,8 @@ def extern(shape,
            in_buffers=None,
            out_buffers=None,
            tag="",
-           attrs=None):
+           attrs=None,
+           aux=None):
     """Compute several tensor via extern function.
 
     Parameters
@@ -652,6 +685,18 @@ def extern(shape,
     attrs: dict, optional
         The additional auxiliary attributes about the compute.
 
+    aux: list of tuple of int, optional
+        The offset arrays of ragged inputs and outputs to pass to
+        fcompute, as (index, dim) pairs. index is the position of the
+        tensor among the inputs followed by the outputs, and dim the
+        dimension of its storage layout whose offsets, i.e. A-function,
+        are passed. When aux is given, fcompute is called with a third
+        list of int32 Buffers, one per pair. Their extent is not known
+        when fcompute is called, so they are declared with shape (1,)
+        and are meant to be passed by pointer, e.g. through
+        access_ptr. Outputs are ragged when
+        declared through out_buffers with a ragged Modes shape.
+
     Returns
     -------
     tensor: Tensor or list of Tensors
@@ -710,13 +755,24 @@ def extern(shape,
     if out_buffers is None:
         for shp, dt in zip(shape, dtype):
             output_placeholders.append(tvm.tir.decl_buffer(shp, dt, name))
-    body = fcompute(input_placeholders, output_placeholders)
+    if aux is None:
+        body = fcompute(input_placeholders, output_placeholders)
+    else:
+        aux_placeholders = [tvm.tir.decl_buffer((1,), 'int32', '%s_aux%d' % (name, i))
+                            for i in range(len(aux))]
+        body = fcompute(input_placeholders, output_placeholders, aux_placeholders)
     if isinstance(body, tvm.tir.PrimExpr):
         body = tvm.tir.Evaluate(body)
 
-    op = _ffi_api.ExternOp(name, tag, attrs,
-                           inputs, input_placeholders,
-                           output_placeholders, body)
+    if aux is None:
+        op = _ffi_api.ExternOp(name, tag, attrs,
+                               inputs, input_placeholders,
+                               output_placeholders, body)
+    else:
+        op = _ffi_api.ExternOpWithAux(name, tag, attrs,
+                                      inputs, input_placeholders, output_placeholders,
+                                      aux_placeholders, [idx for idx, _ in aux],
+                                      [dim for _, dim in aux], body)
     res = [op.output(i) for i in range(len(output_placeholders))]
     return res[0] if len(res) == 1 else res
 
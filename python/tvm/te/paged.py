@@ -0,0 +1,152 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Page allocation for paged ragged storage layouts.
+
+A tensor with a paged layout, see tvm.tir.Modes.paged_storage_layout,
+stores the rows of each sequence in fixed size pages of a pool. The
+pool is allocated once, and a sequence that grows takes free pages
+from it, without moving the pages of any other sequence, as for the
+KV caches of decoding:
+
+.. code-block:: python
+
+  pool = tvm.te.PagePool(num_pages, page_size, batch_size, max_len)
+  pool.resize(seq, new_len)
+  # pool.block_table is passed as the input the page table uf of the
+  # layout loads from, as block_table[seq, page].
+
+The pages are managed here on the host, as part of the data
+preparation that the prelude does for other ragged structures.
+"""
+import numpy as np
+
+
+class PagePool(object):
+    """The pages of a pool assigned to the rows of a batch of sequences.
+
+    Attributes
+    ----------
+    block_table : numpy.ndarray
+        A (num_seqs, max_pages_per_seq) int32 array of the pool page of
+        each page of each sequence, or -1 for pages not allocated.
+
+    lengths : numpy.ndarray
+        The number of rows of each sequence.
+    """
+    def __init__(self, num_pages, page_size, num_seqs, max_len):
+        self.num_pages = num_pages
+        self.page_size = page_size
+        max_pages = (max_len + page_size - 1) // page_size
+        self.block_table = np.full((num_seqs, max_pages), -1, dtype='int32')
+        self.lengths = np.zeros(num_seqs, dtype='int32')
+        # A stack of the free pages, with the lowest ones on top at first.
+        self._free = list(range(num_pages - 1, -1, -1))
+        # The number of sequences each page is assigned to. Sequences
+        # share pages after a reorder.
+        self._refs = np.zeros(num_pages, dtype='int32')
+
+    @property
+    def num_free_pages(self):
+        """The number of pages not assigned to any sequence."""
+        return len(self._free)
+
+    def resize(self, seq, length):
+        """Set the number of rows of a sequence, allocating pages from the
+        pool or returning them to it.
+
+        Parameters
+        ----------
+        seq : int
+            The sequence
+
+        length : int
+            Its new number of rows
+        """
+        old_pages = (int(self.lengths[seq]) + self.page_size - 1) // self.page_size
+        new_pages = (length + self.page_size - 1) // self.page_size
+        if new_pages > self.block_table.shape[1]:
+            raise ValueError("length %d exceeds the maximum length" % length)
+        if new_pages - old_pages > len(self._free):
+            raise MemoryError("page pool exhausted")
+        for page in range(old_pages, new_pages):
+            self.block_table[seq, page] = self._alloc()
+        for page in range(new_pages, old_pages):
+            self._unref(int(self.block_table[seq, page]))
+            self.block_table[seq, page] = -1
+        self.lengths[seq] = length
+
+    def release(self, seq):
+        """Return all the pages of a sequence to the pool."""
+        self.resize(seq, 0)
+
+    def reorder(self, beam_indices):
+        """Reorder the sequences in place for the beams of a search step,
+        so that sequence i continues the sequence beam_indices[i].
+
+        No row is moved for full pages, which the sequences that continue
+        the same sequence share. The last page of a sequence that is
+        continued more than once is not full and is written to by the
+        next step, so each further beam gets a copy of it.
+
+        Parameters
+        ----------
+        beam_indices : array_like of int
+            The sequence each sequence continues, one per sequence
+
+        Returns
+        -------
+        copies : list of (int, int)
+            The pages to copy, as (source page, destination page), before
+            the next step writes to the pool.
+        """
+        beam_indices = np.asarray(beam_indices, dtype='int32')
+        if beam_indices.shape != self.lengths.shape:
+            raise ValueError("expect one beam index per sequence")
+        old_table = self.block_table
+        self.block_table = old_table[beam_indices]
+        self.lengths = self.lengths[beam_indices]
+        for page in self.block_table[self.block_table >= 0]:
+            self._refs[page] += 1
+        for page in old_table[old_table >= 0]:
+            self._unref(int(page))
+
+        copies = []
+        seen = set()
+        for seq, src in enumerate(beam_indices):
+            length = int(self.lengths[seq])
+            if length % self.page_size == 0 or int(src) not in seen:
+                seen.add(int(src))
+                continue
+            last = (length - 1) // self.page_size
+            page = int(self.block_table[seq, last])
+            new_page = self._alloc()
+            self._unref(page)
+            self.block_table[seq, last] = new_page
+            copies.append((page, new_page))
+        return copies
+
+    def _alloc(self):
+        if not self._free:
+            raise MemoryError("page pool exhausted")
+        page = self._free.pop()
+        self._refs[page] = 1
+        return page
+
+    def _unref(self, page):
+        self._refs[page] -= 1
+        if self._refs[page] == 0:
+            self._free.append(page)
@@ -19,7 +19,7 @@
 import tvm._ffi
 from tvm._ffi.base import string_types
 
-from tvm.runtime import Object, convert
+from tvm.runtime import Object, convert, DataType
 from tvm.ir import container as _container
 from tvm.tir import IterVar, Buffer, UninterpFun, Modes
 
@@ -46,6 +46,37 @@ def fuse_ragged_axis(input_tensors, output_tensor, outer_dim, inner_dim, fused_d
     # output_tensor = output_tensor.op
     return _ffi_api.FuseRaggedAxis(input_tensors, output_tensor, outer_dim, inner_dim, fused_dim, fused_extent)
 
+def fuse_ragged_axes(input_tensors, output_tensor, dims, fused_dim, fused_extent):
+    """Fuse several dimensions, such as batch, head and a ragged sequence
+    dimension, into one in a single step.
+
+    Unlike chained calls to fuse_ragged_axis, which create a fused
+    dimension per pair, this creates only the single fused dimension.
+
+    Parameters
+    ----------
+    input_tensors : list of Tensor
+        The inputs of the graph to rewrite.
+
+    output_tensor : Tensor
+        The output of the graph to rewrite.
+
+    dims : list of Dimension
+        The dimensions to fuse, outermost first.
+
+    fused_dim : Dimension
+        The fused dimension, which replaces the outermost of dims.
+
+    fused_extent : PrimExpr
+        The extent of the fused dimension.
+
+    Returns
+    -------
+    rmap : Map of Operation to Operation
+        The rewritten operation of each operation of the graph.
+    """
+    return _ffi_api.FuseRaggedAxes(input_tensors, output_tensor, dims, fused_dim, fused_extent)
+
 def create_schedule(ops):
     """Create a schedule for list of ops
 
@@ -247,6 +278,11 @@ class Schedule(Object):
         A new cache stage will be created for the tensor.
         Call this before doing any split/fuse schedule.
 
+        A shared memory cache that a reader accesses across its rows
+        gets its rows padded to avoid bank conflicts. Call
+        storage_align_dim on the cache stage with a factor of 0 to
+        disable the padding.
+
         Parameters
         ----------
         tensor : Tensor
@@ -403,10 +439,53 @@ class Schedule(Object):
         return factored[0] if len(factored) == 1 else factored
 
 
-    def hfuse(self, fuse_tuples):
+    def hfuse(self, fuse_tuples, weights=None):
+        """Horizontally fuse the outermost loops of independent stages.
+
+        Parameters
+        ----------
+        fuse_tuples : list of (Operation, IterVar)
+            The ops to fuse and their outermost leaf itervars.
+
+        weights : list of Expr, optional
+            The cost of one iteration of each itervar. If given, the
+            fused blocks are interleaved instead of being concatenated.
+            Every body gets a share of each round of blocks proportional
+            to its cost, so that heavy and light bodies share SMs and
+            the heavy ones do not form a tail.
+        """
         ops, ivs = list(zip(*fuse_tuples))
         print(ops, ivs)
-        _ffi_api.ScheduleHFuse(self, list(ops), list(ivs))
+        _ffi_api.ScheduleHFuse(self, list(ops), list(ivs), list(weights) if weights else [])
+
+    def plan_hfuse(self, num_sms, blocks_per_sm=1, work=None, max_group_size=8,
+                   match_threads=True, weighted=False):
+        """Automatically hfuse independent GPU stages whose grids are
+        too small to fill the device. See hfuse_planner.plan_hfuse.
+
+        Returns
+        -------
+        groups : list of list of Operation
+            The fused groups.
+        """
+        from .hfuse_planner import plan_hfuse
+        return plan_hfuse(self, num_sms, blocks_per_sm, work, max_group_size, match_threads,
+                          weighted)
+
+    def promote_single_kernel_intermediates(self, envelope, max_shared_bytes=48 * 1024,
+                                            max_local_bytes=256):
+        """Give the intermediates of a single kernel envelope the shared
+        or local scope where they fit. See
+        single_kernel_planner.promote_single_kernel_intermediates.
+
+        Returns
+        -------
+        promotions : list of Promotion
+            The promoted intermediates and their scopes.
+        """
+        from .single_kernel_planner import promote_single_kernel_intermediates
+        return promote_single_kernel_intermediates(self, envelope, max_shared_bytes,
+                                                   max_local_bytes)
 
 @tvm._ffi.register_object
 class Stage(Object):
@@ -684,6 +763,62 @@ class Stage(Object):
         """
         _ffi_api.StagePeel(self, var)
 
+    def ragged_tile(self, parent, factor):
+        """Split a loop over a ragged dimension into tiles such that the
+        tiles within each row's bound carry no predicates, and the
+        partial last tile of the row is generated after them.
+
+        Parameters
+        ----------
+        parent : IterVar
+             The parent iter var.
+
+        factor : int
+             The tile size.
+
+        Returns
+        -------
+        outer : IterVar
+            The outer variable of iteration, over the tiles.
+
+        inner : IterVar
+            The inner variable of iteration, within a tile.
+        """
+        outer, inner = _ffi_api.StageRaggedTile(self, parent, factor)
+        return outer, inner
+
+    def vectorized_fetch(self, parent, lanes=None, thread=None):
+        """Schedule a copy loop over a ragged row, such as that of a
+        cache_read_opaque stage, as a coalesced fetch of vectors by
+        consecutive threads. Full tiles of the row are fetched without
+        predicates, and its partial last tile is left scalar.
+
+        Parameters
+        ----------
+        parent : IterVar
+             The loop over the row.
+
+        lanes : int, optional
+             The number of elements a thread fetches at once. Defaults
+             to 128 bits worth of the stage's output.
+
+        thread : IterVar, optional
+             The thread axis, with a constant extent, to distribute
+             the fetch over.
+
+        Returns
+        -------
+        tile : IterVar
+            The loop over the tiles of the row.
+
+        lane : IterVar
+            The vectorized loop.
+        """
+        if lanes is None:
+            lanes = max(128 // DataType(self.op.output(0).dtype).bits, 1)
+        tile, lane = _ffi_api.StageVectorizedFetch(self, parent, lanes, thread)
+        return tile, lane
+
     def split_loop(self, var):
         """Split the loop iteration.
 
@@ -751,6 +886,28 @@ class Stage(Object):
           Hint parallel loop to execute in strided pattern.
           :code:`for (int i = task_id; i < end; i += num_task)`
 
+        - **parallel_schedule**
+
+          Override the parallel_schedule of the BuildConfig for the
+          parallel loop of the axis: "static", "dynamic" or "guided".
+          Dynamic and guided loops hand out their iterations in chunks
+          the tasks claim as they become idle, which balances loops
+          whose iterations do ragged amounts of work.
+
+        - **launch_min_blocks**
+
+          On an axis bound to a thread, the minimum number of blocks of
+          the CUDA kernel to keep resident on a multiprocessor. The
+          kernel is declared :code:`__launch_bounds__(threads, value)`,
+          which caps its registers to reach that occupancy.
+
+        - **fast_math**
+
+          With a non-zero value, the float32 exp, tanh and erf in the
+          region are lowered to polynomial approximations, which run
+          on the FMA units of GPUs and are vectorized on CPUs, and the
+          LLVM backends use fast math flags for its arithmetic.
+
         """
         if isinstance(pragma_value, string_types):
             pragma_value = convert(pragma_value)
@@ -810,14 +967,21 @@ class Stage(Object):
         """
         _ffi_api.StageStorageAlignDim(self, dim_idx, factor, offset)
 
-    def double_buffer(self):
+    def double_buffer(self, num_stages=2):
         """Compute the current stage via double buffering.
 
         This can only be applied to intermediate stage.
         This will double the storage cost of the current stage.
         Can be useful to hide load latency.
+
+        Parameters
+        ----------
+        num_stages : int, optional
+            The number of buffers. With more than two, the stage is
+            fetched num_stages - 1 iterations ahead, multiplying its
+            storage cost by num_stages.
         """
-        _ffi_api.StageDoubleBuffer(self)
+        _ffi_api.StageDoubleBuffer(self, num_stages)
 
     def opengl(self):
         """The special OpenGL schedule
@@ -827,4 +991,65 @@ class Stage(Object):
         _ffi_api.StageOpenGL(self)
 
 
+class RaggedBoundDiagnostic(object):
+    """A ragged extent that bound inference over-approximated.
+
+    Attributes
+    ----------
+    op : Operation
+        The op of the stage.
+
+    iter_var : IterVar
+        The root iter var of the op.
+
+    declared : Range
+        The ragged range of the iter var.
+
+    inferred : Range
+        The inferred range, that of the loops over the iter var and of
+        the allocation of the stage.
+
+    proof : PrimExpr
+        The condition that could not be proven for the inferred range
+        to be within the ragged one.
+    """
+    def __init__(self, op, iter_var, declared, inferred, proof):
+        self.op = op
+        self.iter_var = iter_var
+        self.declared = declared
+        self.inferred = inferred
+        self.proof = proof
+
+    def __repr__(self):
+        return ("stage %s, dimension %s: inferred extent %s over-approximates the ragged "
+                "extent %s, as %s could not be proven" %
+                (self.op.name, self.iter_var.var, self.inferred.extent, self.declared.extent,
+                 self.proof))
+
+
+def diagnose_ragged_bounds(sch, bounds=None):
+    """Find where bound inference over-approximated ragged extents, as
+    when a stage is attached outside of the loops its extent depends
+    on, which makes its loops and allocation dense.
+
+    Parameters
+    ----------
+    sch : Schedule
+        The schedule.
+
+    bounds : InferBoundsResult, optional
+        The bounds inferred for sch, which is then normalized already.
+        Inferred for the normalized sch by default.
+
+    Returns
+    -------
+    diagnostics : list of RaggedBoundDiagnostic
+    """
+    if bounds is None:
+        sch = sch.normalize()
+        bounds = tvm._ffi.get_global_func("schedule.InferBound")(sch)
+    diagnose = tvm._ffi.get_global_func("schedule.DiagnoseRaggedBounds")
+    return [RaggedBoundDiagnostic(*d) for d in diagnose(sch, bounds)]
+
+
 tvm._ffi._init_api("schedule", __name__)
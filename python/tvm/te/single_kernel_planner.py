@@ -0,0 +1,189 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Promotion of intermediates of single kernel envelopes.
+
+Schedule.single_kernel merges stages into one launch, but the tensors
+passed between the merged stages stay in global memory unless they
+are explicitly given another scope. The helper here gives such
+intermediates the shared or local scope when their footprint per
+thread block or thread fits. Barriers between the stages that write
+and read a shared intermediate are then inserted by ThreadSync.
+"""
+from tvm.runtime import DataType
+from tvm.tir import IntImm, IterVar
+
+from . import schedule as _schedule
+from . import tensor as _tensor
+
+
+class Promotion(object):
+    """The scope chosen for an intermediate of an envelope.
+
+    Attributes
+    ----------
+    op : Operation
+        The operation computing the intermediate.
+
+    scope : str
+        "shared" or "local".
+
+    num_bytes : int
+        The estimated footprint in the chosen scope, per thread block
+        for shared and per thread for local intermediates.
+    """
+    def __init__(self, op, scope, num_bytes):
+        self.op = op
+        self.scope = scope
+        self.num_bytes = num_bytes
+
+
+def _in_group(stage, group):
+    while stage is not None:
+        if stage.group is not None and stage.group.same_as(group):
+            return True
+        stage = stage.group
+    return False
+
+
+def _footprint(stage, bounds):
+    """The bytes of all outputs of stage in one tile, from the inferred
+    extents of its scheduled leaf axes.
+
+    Returns
+    -------
+    thread_bytes : int
+        The part of the tile each thread computes, over the leaf axes
+        not bound to threads.
+
+    block_bytes : int
+        The tile a thread block computes together, which also spans the
+        leaf axes bound to threadIdx.
+
+    cooperative : bool
+        Whether any leaf axis is bound to threadIdx.
+
+    Returns None if an extent is not constant.
+    """
+    thread_elems = 1
+    block_elems = 1
+    cooperative = False
+    for iv in stage.leaf_iter_vars:
+        if iv.iter_type == IterVar.CommReduce:
+            continue
+        thread = None
+        if iv in stage.iter_var_attrs:
+            thread = stage.iter_var_attrs[iv].bind_thread
+        if thread is not None and thread.thread_tag.startswith("blockIdx"):
+            continue
+        rng = bounds[iv] if iv in bounds else iv.dom
+        if rng is None or not isinstance(rng.extent, IntImm):
+            return None
+        if thread is not None and thread.thread_tag.startswith("threadIdx"):
+            cooperative = True
+        else:
+            thread_elems *= rng.extent.value
+        block_elems *= rng.extent.value
+    elem_bytes = 0
+    for i in range(stage.op.num_outputs):
+        dtype = DataType(stage.op.output(i).dtype)
+        elem_bytes += dtype.bits * dtype.lanes // 8
+    return thread_elems * elem_bytes, block_elems * elem_bytes, cooperative
+
+
+def promote_single_kernel_intermediates(sch, envelope, max_shared_bytes=48 * 1024,
+                                        max_local_bytes=256, apply=True):
+    """Move the intermediates of a single kernel envelope out of global
+    memory where their footprint allows it.
+
+    An intermediate is a compute stage in the group of the envelope
+    that is read only by other stages of the group, and whose scope has
+    not been set. Stages bound to threadIdx axes compute their output
+    cooperatively, and are made shared if it fits in max_shared_bytes
+    per thread block. Other stages are computed redundantly by every
+    thread that needs them, and are made local if the part a thread
+    needs fits in max_local_bytes.
+
+    Parameters
+    ----------
+    sch : Schedule
+        The schedule.
+
+    envelope : Operation or Tensor
+        The envelope, as returned by Schedule.single_kernel.
+
+    max_shared_bytes : int, optional
+        The shared memory available to the intermediates of a block.
+        Shared intermediates are accounted for together.
+
+    max_local_bytes : int, optional
+        The per thread footprint up to which an intermediate is kept in
+        registers.
+
+    apply : bool, optional
+        Whether to set the chosen scopes.
+
+    Returns
+    -------
+    promotions : list of Promotion
+        The promoted intermediates.
+    """
+    if isinstance(envelope, _tensor.Tensor):
+        envelope = envelope.op
+    env_stage = sch[envelope]
+    group = None
+    for stage in sch.stages:
+        if stage.attach_stage is not None and stage.attach_stage.same_as(env_stage):
+            group = stage
+            break
+    if group is None:
+        return []
+
+    bounds = _schedule.InferBound(sch.normalize())
+    members = [s for s in sch.stages if _in_group(s, group)]
+    member_ops = set(s.op for s in members)
+    readers = {}
+    for stage in sch.stages:
+        for t in stage.op.input_tensors:
+            readers.setdefault(t.op, set()).add(stage.op)
+
+    ret = []
+    shared_bytes = 0
+    candidates = []
+    for stage in members:
+        if not isinstance(stage.op, _tensor.BaseComputeOp) or stage.is_output or stage.scope:
+            continue
+        if not readers.get(stage.op) or not readers[stage.op] <= member_ops:
+            continue
+        footprint = _footprint(stage, bounds)
+        if footprint is not None:
+            candidates.append(footprint + (stage,))
+
+    # Smaller intermediates first, so that more of them fit.
+    candidates.sort(key=lambda c: c[1])
+    for thread_bytes, block_bytes, cooperative, stage in candidates:
+        if cooperative:
+            if shared_bytes + block_bytes > max_shared_bytes:
+                continue
+            shared_bytes += block_bytes
+            ret.append(Promotion(stage.op, "shared", block_bytes))
+        elif thread_bytes <= max_local_bytes:
+            ret.append(Promotion(stage.op, "local", thread_bytes))
+
+    if apply:
+        for promotion in ret:
+            sch[promotion.op].set_scope(promotion.scope)
+    return ret
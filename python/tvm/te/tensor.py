@@ -181,6 +181,10 @@ class BaseComputeOp(Operation):
     def get_root_index_dimensions(self, index):
         return _ffi_api.BaseComputeOpGetRootIndexDimensions(self, index)
 
+    def set_storage_layout(self, index, layout):
+        """Replace the storage layout of the index-th output."""
+        _ffi_api.BaseComputeOpSetStorageLayout(self, index, layout)
+
 @tvm._ffi.register_object
 class ComputeOp(BaseComputeOp):
     """Scalar operation."""
@@ -0,0 +1,132 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Dependency levels of recursive data structures.
+
+A recursive computation over a tree or a DAG, such as a TreeLSTM, can
+process all nodes whose children are done at once. Grouping the nodes
+by their height gives a sequence of levels, each of which is a batch
+of independent nodes of ragged size. The recursion then becomes a
+scan over the levels whose update is a ragged computation over the
+nodes of a level:
+
+.. code-block:: python
+
+  batches = tvm.te.compute_levels(children)
+  # batches.node_order, batch_begin and batch_length are passed as
+  # inputs, and a scan over num_levels iterates over the nodes
+  # node_order[batch_begin[l] + i] for i < batch_length[l].
+
+The levels are computed here on the host, as part of the data
+preparation that the prelude does for other ragged structures.
+"""
+import numpy as np
+
+
+class LevelBatches(object):
+    """The nodes of a data structure, batched by dependency level.
+
+    Attributes
+    ----------
+    node_order : numpy.ndarray
+        The nodes, ordered by level. Nodes within a level are sorted.
+
+    batch_begin : numpy.ndarray
+        The position in node_order of the first node of each level.
+
+    batch_length : numpy.ndarray
+        The number of nodes in each level.
+
+    node_level : numpy.ndarray
+        The level of each node. Leaves are at level 0, and other nodes
+        one level above their highest child.
+    """
+    def __init__(self, node_order, batch_begin, batch_length, node_level):
+        self.node_order = node_order
+        self.batch_begin = batch_begin
+        self.batch_length = batch_length
+        self.node_level = node_level
+
+    @property
+    def num_levels(self):
+        """The number of levels, i.e. sequential steps."""
+        return len(self.batch_length)
+
+    @property
+    def max_batch_len(self):
+        """The size of the largest level."""
+        return int(self.batch_length.max()) if self.num_levels > 0 else 0
+
+
+def compute_levels(children):
+    """Batch the nodes of a tree or DAG by dependency level.
+
+    Parameters
+    ----------
+    children : array_like of int
+        A (num_nodes, max_child_num) array of the children of each
+        node, padded with -1.
+
+    Returns
+    -------
+    batches : LevelBatches
+    """
+    children = np.asarray(children, dtype='int32')
+    if children.ndim == 1:
+        children = children.reshape(-1, 1)
+    num_nodes = children.shape[0]
+    if num_nodes == 0:
+        empty = np.zeros(0, dtype='int32')
+        return LevelBatches(empty, empty, empty, empty)
+    valid = children >= 0
+    if np.any(children >= num_nodes):
+        raise ValueError("child index out of range")
+
+    # The edges, from children to parents, grouped by child.
+    edge_parent = np.nonzero(valid)[0]
+    edge_child = children[valid]
+    order = np.argsort(edge_child, kind='stable')
+    edge_parent = edge_parent[order]
+    edge_offsets = np.concatenate(
+        [[0], np.cumsum(np.bincount(edge_child, minlength=num_nodes))]).astype('int64')
+
+    pending = valid.sum(axis=1)
+    node_level = np.zeros(num_nodes, dtype='int32')
+    levels = []
+    frontier = np.nonzero(pending == 0)[0]
+    while frontier.size > 0:
+        node_level[frontier] = len(levels)
+        levels.append(frontier)
+        starts = edge_offsets[frontier]
+        counts = edge_offsets[frontier + 1] - starts
+        if counts.sum() == 0:
+            break
+        # The edges out of the frontier
+        idx = np.repeat(starts - np.cumsum(counts) + counts, counts) + np.arange(counts.sum())
+        parents = edge_parent[idx]
+        np.subtract.at(pending, parents, 1)
+        # A parent is ready once its last child is done, which is in
+        # the level of its highest child.
+        frontier = np.unique(parents[pending[parents] == 0])
+
+    num_done = sum(len(l) for l in levels)
+    if num_done != num_nodes:
+        raise ValueError("the data structure has a cycle")
+
+    batch_length = np.array([len(l) for l in levels], dtype='int32')
+    batch_begin = np.concatenate([[0], np.cumsum(batch_length)[:-1]]).astype('int32')
+    node_order = np.concatenate(levels).astype('int32')
+    return LevelBatches(node_order, batch_begin, batch_length, node_level)
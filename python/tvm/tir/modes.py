@@ -61,9 +61,62 @@ class Modes(tvm.runtime.Object):
         if isinstance(width_ufs, LFunsWrapper): width_ufs = width_ufs.get_ufs()
         return _ffi_api.StorageModes(dims, dense_shape, width_ufs, position_ufs)
 
+    def tiled_storage_layout(dims, dense_shape, width_ufs, position_ufs, tile_factors):
+        """Storage layout where each dimension's width is padded up to a
+        multiple of the corresponding entry of tile_factors (1 for no
+        padding), so that ragged rows start at tile aligned offsets."""
+        if isinstance(width_ufs, LFunsWrapper): width_ufs = width_ufs.get_ufs()
+        if isinstance(tile_factors, int): tile_factors = [tile_factors] * len(dims)
+        return _ffi_api.TiledStorageModes(dims, dense_shape, width_ufs, position_ufs, tile_factors)
+
+    def paged_storage_layout(dims, dense_shape, width_ufs, paged_dim, page_size, page_table,
+                             num_pages):
+        """Storage layout where the rows of dimension paged_dim are stored
+        in pages of page_size rows from a pool of num_pages pages. The
+        page_table uf maps the coordinates of the outer dimensions and
+        the index of a page in a row to its page in the pool, such as a
+        load from the block table kept by tvm.te.PagePool. The
+        dimensions inner to paged_dim must be dense."""
+        if isinstance(width_ufs, LFunsWrapper): width_ufs = width_ufs.get_ufs()
+        return _ffi_api.PagedStorageModes(dims, dense_shape, width_ufs, paged_dim, page_size,
+                                          page_table, num_pages)
+
     def loop_layout(dims, dense_shape, min_ufs, max_ufs):
         return _ffi_api.LoopModes(dims, dense_shape, min_ufs, max_ufs)
 
+    def block_sparse_slot_uf(name, block_dim, indptr, max_blocks_per_row):
+        """The width uf of the key block slots of a block sparse layout,
+        the number of key blocks of a query block of block_dim, from the
+        indptr tensor of a tvm.te.BlockSparsePattern."""
+        return UninterpFun(name, 'l', (0, max_blocks_per_row), [block_dim],
+                           lambda qb: indptr[qb + 1] - indptr[qb])
+
+    def block_sparse_storage_layout(dims, dense_shape, width_ufs, block_dim, slot_dim, indptr):
+        """Storage layout of a block sparse tensor, such as attention
+        scores, with a dimension of query blocks, block_dim, and an inner
+        dimension of the slots of their key blocks, slot_dim, of which only
+        the nonzero blocks listed by indptr are stored. The extent of
+        slot_dim in dense_shape is the max number of blocks per row, and
+        its entry in width_ufs is replaced."""
+        if isinstance(width_ufs, LFunsWrapper): width_ufs = width_ufs.get_ufs()
+        block_idx, slot_idx = list(dims).index(block_dim), list(dims).index(slot_dim)
+        assert block_idx < slot_idx, "The slots should be inner to the query blocks"
+        width_ufs = list(width_ufs)
+        width_ufs[slot_idx] = Modes.block_sparse_slot_uf(
+            slot_dim.name + '_slots', block_dim, indptr, dense_shape[slot_idx])
+        return Modes.storage_layout(dims, dense_shape, width_ufs, {})
+
+    def block_sparse_loop_layout(dims, dense_shape, max_ufs, block_dim, slot_dim, indptr):
+        """Loop layout matching block_sparse_storage_layout, which only
+        iterates over the nonzero key blocks of each query block."""
+        if isinstance(max_ufs, LFunsWrapper): max_ufs = max_ufs.get_ufs()
+        slot_idx = list(dims).index(slot_dim)
+        max_ufs = list(max_ufs)
+        max_ufs[slot_idx] = Modes.block_sparse_slot_uf(
+            slot_dim.name + '_slots', block_dim, indptr, dense_shape[slot_idx])
+        min_ufs = [UninterpFun.from_constant('zero', 0, 'l') for _ in dims]
+        return Modes.loop_layout(dims, dense_shape, min_ufs, max_ufs)
+
     def __init__(self, dims, shape):
         self.__init_handle_by_constructor__(_ffi_api.Modes, dims, shape, [], [])
 
@@ -76,3 +129,10 @@ class Modes(tvm.runtime.Object):
 
     def is_ragged(self):
         return _ffi_api.ModesIsRagged(self)
+
+    def is_ragged_dim(self, i):
+        return _ffi_api.ModesIsRaggedDim(self, i)
+
+    def compute_position(self, coords):
+        """The offset of the element at coords in this layout."""
+        return _ffi_api.ModesComputePosition(self, coords)
@@ -201,10 +201,40 @@ impl NDArray {
         check_call!(ffi::TVMArrayCopyFromBytes(
             self.handle,
             data.as_ptr() as *mut _,
-            data.len() * mem::size_of::<T>()
+            data.len() * mem::size_of::<T>(),
+            false
         ));
     }
 
+    /// Copies the packed data of a ragged NDArray, the valid entries of
+    /// its rows one after the other, from a buffer in cpu. The buffer
+    /// may be shorter than the dense shape of the NDArray implies.
+    pub fn copy_from_ragged_buffer<T: Num32>(&mut self, data: &[T]) {
+        check_call!(ffi::TVMArrayCopyFromBytes(
+            self.handle,
+            data.as_ptr() as *mut _,
+            data.len() * mem::size_of::<T>(),
+            true
+        ));
+    }
+
+    /// Copies the first `flat_size` packed entries of a ragged NDArray
+    /// to a `Vec` in cpu.
+    pub fn to_ragged_vec<T: Num32 + Copy>(&self, flat_size: usize) -> Result<Vec<T>, Error> {
+        ensure!(self.shape().is_some(), errors::EmptyArrayError);
+        let mut v: Vec<T> = Vec::with_capacity(flat_size);
+        check_call!(ffi::TVMArrayCopyToBytes(
+            self.handle,
+            v.as_mut_ptr() as *mut _,
+            flat_size * mem::size_of::<T>(),
+            true
+        ));
+        unsafe {
+            v.set_len(flat_size);
+        }
+        Ok(v)
+    }
+
     /// Copies the NDArray to another target NDArray.
     pub fn copy_to_ndarray(&self, target: NDArray) -> Result<NDArray, Error> {
         if self.dtype() != target.dtype() {
@@ -269,6 +299,76 @@ impl NDArray {
             is_view: false,
         }
     }
+
+    /// Allocates a ragged NDArray of the given dense shape, with room for
+    /// `flat_size` packed entries.
+    pub fn ragged_empty(
+        dense_shape: &[usize],
+        flat_size: usize,
+        ctx: TVMContext,
+        dtype: TVMType,
+    ) -> NDArray {
+        let mut handle = ptr::null_mut() as ffi::TVMArrayHandle;
+        check_call!(ffi::TVMRaggedArrayAlloc(
+            dense_shape.as_ptr() as *const i64,
+            flat_size as i64,
+            dense_shape.len() as c_int,
+            dtype.code as c_int,
+            dtype.bits as c_int,
+            dtype.lanes as c_int,
+            ctx.device_type.0 as c_int,
+            ctx.device_id as c_int,
+            &mut handle as *mut _,
+        ));
+        NDArray {
+            handle,
+            is_view: false,
+        }
+    }
+
+    /// Creates a ragged NDArray in cpu over the packed data of a slice,
+    /// without copying it, such as the tokens of a batch of requests
+    /// laid out one after the other.
+    ///
+    /// # Safety
+    ///
+    /// The NDArray does not own the data, which must outlive it.
+    pub unsafe fn ragged_from_slice<T: Num32>(
+        data: &mut [T],
+        dense_shape: &[usize],
+        dtype: TVMType,
+    ) -> Result<NDArray, Error> {
+        ensure!(
+            data.len() <= dense_shape.iter().product(),
+            "ragged data of {} entries exceeds the dense shape {:?}",
+            data.len(),
+            dense_shape
+        );
+        let ctx = TVMContext::cpu(0);
+        let mut handle = ptr::null_mut() as ffi::TVMArrayHandle;
+        check_call!(ffi::TVMRaggedArrayFromData(
+            data.as_mut_ptr() as *mut _,
+            dense_shape.as_ptr() as *const i64,
+            dense_shape.len() as c_int,
+            dtype.code as c_int,
+            dtype.bits as c_int,
+            dtype.lanes as c_int,
+            ctx.device_type.0 as c_int,
+            ctx.device_id as c_int,
+            &mut handle as *mut _,
+        ));
+        Ok(NDArray {
+            handle,
+            is_view: false,
+        })
+    }
+}
+
+/// Returns the lengths of the rows of a packed ragged buffer from the
+/// offsets of its rows, of which there is one more than rows, the last
+/// being the end of the buffer.
+pub fn lengths_from_offsets(offsets: &[usize]) -> Vec<i32> {
+    offsets.windows(2).map(|w| (w[1] - w[0]) as i32).collect()
 }
 
 macro_rules! impl_from_ndarray_rustndarray {
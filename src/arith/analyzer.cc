@@ -111,8 +111,40 @@ bool Analyzer::CanProveGreaterEqual(const PrimExpr& expr, int64_t lower_bound) {
   auto rewritten = this->rewrite_simplify(expr);
   // std::cout << "[CPGE]  Rewritten: " << rewritten << std::endl;
   auto bd = this->const_int_bound(rewritten);
-  if (bd->min_value >= lower_bound) return true;
-  return z3_analyzer.CanProve(expr >= IntImm(DataType::Int(64), lower_bound));
+  if (bd->min_value >= lower_bound) {
+    proof_stats.const_int_bound++;
+    return true;
+  }
+  if (z3_analyzer.CanProve(expr >= IntImm(DataType::Int(64), lower_bound))) {
+    proof_stats.z3++;
+    return true;
+  }
+  proof_stats.unproven++;
+  return false;
+}
+
+// Tries to prove comparisons, and conjunctions thereof, with the
+// constant integer bounds of the difference of the compared values.
+static bool CanProveByConstIntBound(Analyzer* analyzer, const PrimExpr& cond) {
+  if (auto op = cond.as<tir::AndNode>()) {
+    return CanProveByConstIntBound(analyzer, op->a) && CanProveByConstIntBound(analyzer, op->b);
+  }
+  auto bound = [analyzer](const PrimExpr& a, const PrimExpr& b) {
+    return analyzer->const_int_bound(analyzer->rewrite_simplify(a - b));
+  };
+  auto is_scalar_int = [](const PrimExpr& a, const PrimExpr& b) {
+    return a.dtype().is_int() && a.dtype().lanes() == 1 && a.dtype() == b.dtype();
+  };
+  if (auto op = cond.as<tir::LTNode>()) {
+    return is_scalar_int(op->a, op->b) && bound(op->a, op->b)->max_value < 0;
+  } else if (auto op = cond.as<tir::LENode>()) {
+    return is_scalar_int(op->a, op->b) && bound(op->a, op->b)->max_value <= 0;
+  } else if (auto op = cond.as<tir::GTNode>()) {
+    return is_scalar_int(op->a, op->b) && bound(op->a, op->b)->min_value > 0;
+  } else if (auto op = cond.as<tir::GENode>()) {
+    return is_scalar_int(op->a, op->b) && bound(op->a, op->b)->min_value >= 0;
+  }
+  return false;
 }
 
 bool Analyzer::CanProve(const PrimExpr& expr) {
@@ -123,16 +155,35 @@ bool Analyzer::CanProve(const PrimExpr& expr) {
   auto res = this->rewrite_simplify(expr);
   // std::cout << "[ANA] TPT1: " << res << std::endl;
   if (const auto* ptr = res.as<IntImmNode>()) {
+    if (ptr->value != 0) {
+      proof_stats.rewrite_simplify++;
+    } else {
+      proof_stats.unproven++;
+    }
     return ptr->value != 0;
   }
+  if (CanProveByConstIntBound(this, res)) {
+    proof_stats.const_int_bound++;
+    return true;
+  }
   // std::cout << "[ANA] TPT2: " << std::endl;
   res = this->canonical_simplify(expr);
   // std::cout << "[ANA] TPT3: " << res << std::endl;
   if (const auto* ptr = res.as<IntImmNode>()) {
+    if (ptr->value != 0) {
+      proof_stats.canonical_simplify++;
+    } else {
+      proof_stats.unproven++;
+    }
     return ptr->value != 0;
   }
   // std::cout << "[ANA] TPT4: " << std::endl;
-  return z3_analyzer.CanProve(expr);
+  if (z3_analyzer.CanProve(expr)) {
+    proof_stats.z3++;
+    return true;
+  }
+  proof_stats.unproven++;
+  return false;
 }
 
 PrimExpr Analyzer::Simplify(const PrimExpr& expr) {
@@ -161,6 +212,20 @@ TVM_REGISTER_GLOBAL("arith.CreateAnalyzer").set_body([](TVMArgs args, TVMRetValu
       return PackedFunc([self](TVMArgs args, TVMRetValue* ret) {
         self->const_int_bound.Update(args[0], args[1], args[2]);
       });
+    } else if (name == "can_prove") {
+      return PackedFunc([self](TVMArgs args, TVMRetValue* ret) { *ret = self->CanProve(args[0]); });
+    } else if (name == "proof_stats") {
+      return PackedFunc([self](TVMArgs args, TVMRetValue* ret) {
+        const ProofTierStats& stats = self->proof_stats;
+        Map<std::string, PrimExpr> ret_stats;
+        ret_stats.Set("rewrite_simplify", make_const(DataType::Int(64), stats.rewrite_simplify));
+        ret_stats.Set("const_int_bound", make_const(DataType::Int(64), stats.const_int_bound));
+        ret_stats.Set("canonical_simplify",
+                      make_const(DataType::Int(64), stats.canonical_simplify));
+        ret_stats.Set("z3", make_const(DataType::Int(64), stats.z3));
+        ret_stats.Set("unproven", make_const(DataType::Int(64), stats.unproven));
+        *ret = ret_stats;
+      });
     } else if (name == "Simplify") {
       return PackedFunc([self](TVMArgs args, TVMRetValue* ret) { *ret = self->Simplify(args[0]); });
     } else if (name == "rewrite_simplify") {
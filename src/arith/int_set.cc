@@ -647,7 +647,7 @@ class IntSetEvaluator : public ExprFunctor<IntSet(const PrimExpr&)> {
           return IntSet::interval(min, max_inclusive);
         }
       } else {
-        return IntervalSet::SinglePoint(GetRef<PrimExpr>(op));
+        return EvalUninterpFunCall(op, func_node);
       }
       // // if (func_node->is_complex()) {
       // if (true) {
@@ -819,6 +819,37 @@ class IntSetEvaluator : public ExprFunctor<IntSet(const PrimExpr&)> {
   }
 
  private:
+  // Calls to A-functions, L-functions and the like. Interval
+  // arguments are propagated through A-functions, which, as prefix
+  // sums of widths, are non-decreasing. Otherwise, the declared range
+  // of the function bounds the call.
+  IntSet EvalUninterpFunCall(const CallNode* op, const UninterpFunNode* ufun) {
+    auto make_call = [op](Array<PrimExpr> args) {
+      return CallNode::make(op->dtype, op->name, args, op->call_type, op->arg_dims, op->func,
+                            op->value_index, op->custom_realize_bounds);
+    };
+    Array<PrimExpr> points;
+    std::vector<IntSet> arg_sets;
+    for (auto arg : op->args) {
+      IntSet set = this->Eval(arg);
+      if (set.is_single_point()) points.push_back(set.point_value());
+      arg_sets.push_back(set);
+    }
+    if (points.size() == op->args.size()) {
+      return IntervalSet::SinglePoint(make_call(points));
+    }
+    if (ufun->type == UninterpFunNode::kAFun && op->args.size() == 1) {
+      auto iset = arg_sets[0].as<IntervalSetNode>();
+      if (iset && iset->HasLowerBound() && iset->HasUpperBound()) {
+        return IntSet::interval(make_call({iset->min_value}), make_call({iset->max_value}));
+      }
+    }
+    if (ufun->range.defined()) {
+      return IntSet::interval(ufun->range->min, ufun->range->max_inclusive());
+    }
+    return IntervalSet::SinglePoint(GetRef<PrimExpr>(op));
+  }
+
   // whether set is exactly single point that equals value.
   bool MatchPoint(const IntSet& set, const PrimExpr& value) const {
     return set.min().same_as(value) && set.max().same_as(value);
@@ -26,7 +26,9 @@
 
 #include <tvm/arith/analyzer.h>
 #include <tvm/tir/expr_equality.h>
+#include <tvm/tir/ir_pass.h>
 #include <tvm/tir/op.h>
+#include <tvm/tir/uninterp_fun.h>
 
 #include <algorithm>
 
@@ -230,6 +232,50 @@ std::function<void()> RewriteSimplifier::Impl::EnterConstraint(const PrimExpr& c
   return frecover;
 }
 
+// The single argument of a call to an A-function, a prefix sum over
+// the widths of the dimensions that depend on the function's.
+static const UninterpFunNode* AsAFunCall(const PrimExpr& e, PrimExpr* arg) {
+  auto call = e.as<CallNode>();
+  if (!call || call->call_type != CallNode::UninterpFunCall || call->args.size() != 1) {
+    return nullptr;
+  }
+  auto ufun = call->func.as<UninterpFunNode>();
+  if (!ufun || ufun->type != UninterpFunNode::kAFun || ufun->arity() != 1) return nullptr;
+  *arg = call->args[0];
+  return ufun;
+}
+
+PrimExpr RewriteSimplifier::Impl::TryRewriteAFunDifference(const PrimExpr& a,
+                                                           const PrimExpr& b) {
+  PrimExpr a_arg, b_arg;
+  const UninterpFunNode* fa = AsAFunCall(a, &a_arg);
+  const UninterpFunNode* fb = AsAFunCall(b, &b_arg);
+  if (!fa || fa != fb || !fa->summand.defined()) return NullValue<PrimExpr>();
+  PrimExpr diff = this->VisitExpr(a_arg - b_arg);
+  auto imm = diff.as<IntImmNode>();
+  if (!imm) return NullValue<PrimExpr>();
+  auto summand_at = [fa](const PrimExpr& arg) {
+    return Substitute(fa->summand, {{fa->parameters[0], arg}});
+  };
+  if (imm->value == 0) return make_zero(a.dtype());
+  if (imm->value == 1) return cast(a.dtype(), summand_at(b_arg));
+  if (imm->value == -1) return make_zero(a.dtype()) - cast(a.dtype(), summand_at(a_arg));
+  return NullValue<PrimExpr>();
+}
+
+RewriteSimplifier::Impl::CompareResult RewriteSimplifier::Impl::TryCompareAFunCalls(
+    const PrimExpr& a, const PrimExpr& b) {
+  PrimExpr a_arg, b_arg;
+  const UninterpFunNode* fa = AsAFunCall(a, &a_arg);
+  const UninterpFunNode* fb = AsAFunCall(b, &b_arg);
+  if (!fa || fa != fb) return kUnknown;
+  PrimExpr diff = this->VisitExpr(a_arg - b_arg);
+  if (is_zero(diff)) return kEQ;
+  if (CanProveGreaterEqual(diff, 0)) return kGE;
+  if (CanProveGreaterEqual(0 - diff, 0)) return kLE;
+  return kUnknown;
+}
+
 PrimExpr RewriteSimplifier::Impl::VisitExpr_(const SubNode* op) {
   PrimExpr ret = IRMutatorWithAnalyzer::VisitExpr_(op);
   op = ret.as<SubNode>();
@@ -250,6 +296,10 @@ PrimExpr RewriteSimplifier::Impl::VisitExpr_(const SubNode* op) {
   }
 
   if (IsIndexType(op->dtype)) {
+    // A-function rules
+    PrimExpr afun_diff = TryRewriteAFunDifference(op->a, op->b);
+    if (afun_diff.defined()) return afun_diff;
+
     // Index rules
     // cancelation rules
     TVM_TRY_REWRITE((x + y) - y, x);
@@ -1368,6 +1418,10 @@ PrimExpr RewriteSimplifier::Impl::VisitExpr_(const LTNode* op) {
       // std::cout << "[RSLT3] " << GetRef<PrimExpr>(op) << " " << ret << std::endl;
       return make_const(op->dtype, false);
     }
+    CompareResult afun_result = TryCompareAFunCalls(op->a, op->b);
+    if (afun_result == kEQ || afun_result == kGE) {
+      return make_const(op->dtype, false);
+    }
 
     TVM_TRY_REWRITE(x + y < x + z, y < z);
     TVM_TRY_REWRITE(x + y < z + x, y < z);
@@ -1579,9 +1633,9 @@ PrimExpr RewriteSimplifier::Impl::VisitExpr_(const SelectNode* op) {
   PVar<PrimExpr> pe;
   TVM_TRY_REWRITE(select(x, y, y, pf, pe), y);
 
-  Z3Analyzer analyzer;
-  // analyzer.AddConstraint(op->condition);
-  if (analyzer.CanProve(EQNode::make(ret, op->false_value))) {
+  // The select is its false value if the values are equal whenever
+  // the condition holds. The cheaper analyzers are tried before z3.
+  if (analyzer_->CanProve(!op->condition || op->true_value == op->false_value)) {
     return op->false_value;
   }
 
@@ -1602,9 +1656,7 @@ PrimExpr RewriteSimplifier::Impl::VisitExpr_(const FuseSelectNode* op) {
   PVar<PrimExpr> x, y;
   TVM_TRY_REWRITE(select(x, y, y, pf, pe), y);
 
-  Z3Analyzer analyzer;
-  // analyzer.AddConstraint(op->condition);
-  if (analyzer.CanProve(EQNode::make(ret, op->false_value))) {
+  if (analyzer_->CanProve(!op->condition || op->true_value == op->false_value)) {
     return op->false_value;
   }
 
@@ -99,6 +99,20 @@ class RewriteSimplifier::Impl : public IRMutatorWithAnalyzer {
    */
   CompareResult TryCompare(const PrimExpr& x, int64_t val);
 
+  /*!
+   * \brief try to simplify the difference a - b of two calls to the
+   *  same A-function, f(x + 1) - f(x) being the summand of f at x.
+   * \return The simplified difference, or an undefined expression.
+   */
+  PrimExpr TryRewriteAFunDifference(const PrimExpr& a, const PrimExpr& b);
+
+  /*!
+   * \brief try to compare two calls to the same A-function, which, as
+   *  prefix sums of widths, are non-decreasing.
+   * \return kEQ, kGE or kLE as implied by the arguments, or kUnknown.
+   */
+  CompareResult TryCompareAFunCalls(const PrimExpr& a, const PrimExpr& b);
+
  private:
   // Whether x >= val
   bool CanProveGreaterEqual(const PrimExpr& x, int64_t val) {
@@ -1,6 +1,8 @@
 #include <tvm/arith/z3_analyzer.h>
 #include <tvm/tir/op.h>
 
+#include <atomic>
+#include <chrono>
 #include <stdexcept>
 #include <utility>
 
@@ -220,11 +222,23 @@ void Z3Analyzer::Update(const Var& var, const PrimExpr& min, const PrimExpr& max
     z3::expr z3max = ConvertToZ3(max);
     z3::expr z3var = ConvertToZ3(var);
 
+    bool replaced = false;
     if (!var_constraints.count(var.get()) || overwrite) {
+      replaced = var_constraints.count(var.get());
       var_constraints[var.get()] = std::make_shared<z3::expr_vector>(ctx);
     }
     var_constraints.at(var.get())->push_back(z3var >= z3min);
     var_constraints.at(var.get())->push_back(z3var < z3max);
+
+    // New var constraints go to the base level of the solver, which
+    // is only reachable when no general constraint is in scope.
+    if (replaced || general_constraints->size() > 0) {
+      solver_stale = true;
+    } else if (!solver_stale) {
+      solver->add(z3var >= z3min);
+      solver->add(z3var < z3max);
+    }
+    ConstraintsChanged_();
   } catch (const std::invalid_argument& e) {
     return;
   } catch (const z3::exception& e) {
@@ -237,20 +251,20 @@ void Z3Analyzer::AddConstraint(const PrimExpr& constraint) {
     std::cout << "[Z3]  Adding constraint " << constraint << std::endl;
   }
   if (auto imm = constraint.as<IntImmNode>()) {
-    this->general_constraints->push_back(ctx.bool_val(imm != 0));
+    PushGeneralConstraint_(ctx.bool_val(imm != 0));
   } else if (constraint.dtype().is_bool()) {
     z3::expr z3constraint = ConvertToZ3(constraint);
     // std::cout << "[Z3]   Constraint " << z3constraint << std::endl;
-    this->general_constraints->push_back(z3constraint);
+    PushGeneralConstraint_(z3constraint);
   } else {
-    this->general_constraints->push_back(ctx.bool_val(true));
+    PushGeneralConstraint_(ctx.bool_val(true));
   }
 }
 
 void Z3Analyzer::AddForallConstraint(const Array<Var>& forall_vars,
                                      const PrimExpr& constraint_body) {
   if (constraint_body.as<IntImmNode>()) {
-    this->general_constraints->push_back(ctx.bool_val(true));
+    PushGeneralConstraint_(ctx.bool_val(true));
   } else {
     z3::expr z3constraint_body = ConvertToZ3(constraint_body);
     z3::expr_vector z3forall_vars(ctx);
@@ -264,82 +278,119 @@ void Z3Analyzer::AddForallConstraint(const Array<Var>& forall_vars,
       std::cout << "[Z3]  ForallConstraint: " << constraint_body << std::endl;
       // std::cout << "[Z3]                  : " << z3constraint << std::endl;
     }
-    this->general_constraints->push_back(z3constraint);
+    PushGeneralConstraint_(z3constraint);
   }
 }
 
-void Z3Analyzer::RemoveLastConstraint() { this->general_constraints->pop_back(); }
+void Z3Analyzer::PushGeneralConstraint_(const z3::expr& constraint) {
+  this->general_constraints->push_back(constraint);
+  if (!solver_stale) {
+    solver->push();
+    solver->add(constraint);
+  }
+  state_id_stack.push_back(state_id);
+  state_id = ++next_state_id;
+  consistency_checked = false;
+}
 
-bool Z3Analyzer::CanProveInternal_(z3::expr& antecedent, z3::expr& consequent, bool print) {
-  z3::solver solver(ctx);
+void Z3Analyzer::RemoveLastConstraint() {
+  CHECK_GT(this->general_constraints->size(), 0U);
+  this->general_constraints->pop_back();
+  if (!solver_stale) solver->pop();
+  // The constraints are back to what they were before the last one
+  // was added. Proofs under the removed one are not needed anymore.
+  proof_cache.erase(state_id);
+  state_id = state_id_stack.back();
+  state_id_stack.pop_back();
+}
 
-  try {
-    z3::params p(ctx);
-    p.set(":timeout", 500u);
-    // p.set(":produce-proofs", true);
-    // p.set(":produce-models", true);
-    solver.set(p);
-
-    z3::expr to_prove = z3::implies(antecedent, consequent).simplify();
-
-    solver.add(!to_prove);
-    if (solver.check() == z3::unsat) {
-      // std::cout << "[Z3] Proof " << solver.proof() << std::endl;
-      return true;
-    } else {
-      if (print) {
-        // std::cout << "[Z3] " << antecedent << std::endl;
-        // std::cout << "[Z3] " << consequent << std::endl;
-        // std::cout << "[Z3] " << to_prove << std::endl;
-      }
-      // if (print) std::cout << "[Z3] Cannot prove. Have model.\n" << solver.get_model() <<
-      // std::endl;
-      // std::cout << "[Z3]  Return0.1" << std::endl;
-      return false;
-    }
-  } catch (const std::invalid_argument& e) {
-    // std::cout << "[Z3]  Return0.2" << std::endl;
-    return false;
-  } catch (const z3::exception& e) {
-    // std::cout << "[Z3]  Return0.3" << std::endl;
-    return false;
+void Z3Analyzer::ConstraintsChanged_() {
+  // The constraint sets the stacked ids stand for have changed as
+  // well, so none of the ids, or their proofs, can be reused.
+  proof_cache.clear();
+  for (auto& id : state_id_stack) {
+    id = ++next_state_id;
   }
+  state_id = ++next_state_id;
+  consistency_checked = false;
 }
 
-void Z3Analyzer::InitCall_() {
-  // std::cout << "[Z3] Z3 Analyzer created" << std::endl;
+void Z3Analyzer::SetTimeout(unsigned timeout_ms) {
+  this->timeout_ms = timeout_ms;
+  if (!solver_stale) {
+    z3::params p(ctx);
+    p.set(":timeout", timeout_ms);
+    solver->set(p);
+  }
+  // Proofs that timed out may succeed with more time.
+  proof_cache.clear();
 }
 
-bool Z3Analyzer::CanProve(const PrimExpr& cond) {
-  z3::expr antecedent = ctx.bool_val(true);
+void Z3Analyzer::EnsureSolver_() {
+  if (!solver_stale) return;
+  solver = std::unique_ptr<z3::solver>(new z3::solver(ctx));
+  z3::params p(ctx);
+  p.set(":timeout", timeout_ms);
+  solver->set(p);
   for (auto it : var_constraints) {
     for (auto expr : *it.second) {
-      antecedent = antecedent && expr;
+      solver->add(expr);
     }
   }
-
   for (auto expr : *this->general_constraints) {
-    antecedent = antecedent && expr;
+    solver->push();
+    solver->add(expr);
   }
+  solver_stale = false;
+}
 
-  z3::expr false_expr = ctx.bool_val(false);
-  if (CanProveInternal_(antecedent, false_expr, false)) {
-    std::cout << "[Z3] Antecedent\n" << antecedent << std::endl;
-    CHECK(false) << "Invalid constraints added to the solver";
-  }
+static std::atomic<int64_t> num_z3_queries{0};
+static std::atomic<int64_t> z3_query_us{0};
+
+Z3Analyzer::Stats Z3Analyzer::GlobalStats() { return {num_z3_queries, z3_query_us}; }
+
+void Z3Analyzer::InitCall_() {
+  // std::cout << "[Z3] Z3 Analyzer created" << std::endl;
+}
+
+bool Z3Analyzer::CanProve(const PrimExpr& cond) {
+  auto& cache = proof_cache[state_id];
+  auto it = cache.find(cond);
+  if (it != cache.end()) return it->second;
 
+  bool proven = false;
   try {
+    EnsureSolver_();
+    if (!consistency_checked) {
+      if (solver->check() == z3::unsat) {
+        std::cout << "[Z3] Constraints\n" << solver->assertions() << std::endl;
+        CHECK(false) << "Invalid constraints added to the solver";
+      }
+      consistency_checked = true;
+    }
+
     z3::expr consequent = ConvertToZ3(cond);
     // std::cout << "[Z3] TPT: " << cond << std::endl;
-    return CanProveInternal_(antecedent, consequent, true);
+    solver->push();
+    solver->add(!consequent);
+    auto start = std::chrono::steady_clock::now();
+    proven = solver->check() == z3::unsat;
+    num_z3_queries++;
+    z3_query_us += std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+    solver->pop();
   } catch (const std::invalid_argument& e) {
     // std::cout << "[Z3]  Return1" << std::endl;
-    return false;
+    proven = false;
   } catch (const z3::exception& e) {
     // std::cout << "[Z3]  Return2" << std::endl;
-    return false;
+    // The solver may have been left in a query scope.
+    solver_stale = true;
+    proven = false;
   }
-  return false;
+  cache[cond] = proven;
+  return proven;
 }
 }  // namespace arith
 }  // namespace tvm
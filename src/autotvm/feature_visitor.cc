@@ -25,15 +25,147 @@
 
 #include "feature_visitor.h"
 
+#include <tvm/arith/analyzer.h>
+#include <tvm/tir/ir_pass.h>
+#include <tvm/tir/op.h>
+#include <tvm/tir/uninterp_fun.h>
+
+#include <algorithm>
+#include <map>
+
 namespace tvm {
 namespace autotvm {
 
+LengthDistribution::LengthDistribution(const std::vector<int64_t>& lengths,
+                                       const std::vector<double>& weights) {
+  CHECK_EQ(lengths.size(), weights.size());
+  std::map<int64_t, double> merged;
+  double total = 0;
+  for (size_t i = 0; i < lengths.size(); ++i) {
+    merged[lengths[i]] += weights[i];
+    total += weights[i];
+  }
+  for (auto kv : merged) {
+    samples_.push_back({kv.first, total > 0 ? kv.second / total : 0});
+  }
+}
+
+int64_t LengthDistribution::Quantile(double q) const {
+  CHECK(!samples_.empty());
+  double cumulative = 0;
+  for (auto kv : samples_) {
+    cumulative += kv.second;
+    if (cumulative >= q - 1e-9) return kv.first;
+  }
+  return samples_.back().first;
+}
+
+// Replaces the ragged lengths in an extent by a sampled length. Calls
+// to prefix sum functions A(x) become x * length, so that differences
+// A(x + 1) - A(x) evaluate to the length, as do differences of loads
+// from the same prefix sum array.
+class LengthSubstituter : public ExprMutator {
+ public:
+  explicit LengthSubstituter(int64_t length) : length_(length) {}
+
+  PrimExpr VisitExpr_(const CallNode* op) final {
+    if (auto ufun = op->func.as<UninterpFunNode>()) {
+      PrimExpr length = IntImm(op->dtype, length_);
+      if (ufun->type == UninterpFunNode::kAFun && op->args.size() == 1) {
+        return cast(op->dtype, this->VisitExpr(op->args[0])) * length;
+      }
+      if (ufun->range.defined()) {
+        return max(min(length, cast(op->dtype, ufun->range->max_inclusive())),
+                   cast(op->dtype, ufun->range->min));
+      }
+      return length;
+    }
+    return ExprMutator::VisitExpr_(op);
+  }
+
+  PrimExpr VisitExpr_(const LoadNode* op) final {
+    if (op->dtype.is_int()) return IntImm(op->dtype, length_);
+    return ExprMutator::VisitExpr_(op);
+  }
+
+  PrimExpr VisitExpr_(const SubNode* op) final {
+    auto la = op->a.as<LoadNode>();
+    auto lb = op->b.as<LoadNode>();
+    if (la && lb && la->buffer_var.same_as(lb->buffer_var)) {
+      return IntImm(op->dtype, length_);
+    }
+    return ExprMutator::VisitExpr_(op);
+  }
+
+ private:
+  int64_t length_;
+};
+
+// Whether an extent depends on the ragged lengths.
+static bool IsRagged(const PrimExpr& extent) {
+  bool ragged = false;
+  PostOrderVisit(extent, [&ragged](const ObjectRef& node) {
+    if (auto call = node.as<CallNode>()) {
+      if (auto ufun = call->func.as<UninterpFunNode>()) ragged |= !ufun->is_constant();
+    } else if (node.as<LoadNode>()) {
+      ragged = true;
+    }
+  });
+  return ragged;
+}
+
+// The extent of a loop, or an upper bound on it for loops over ragged
+// dimensions, along with its statistics over the length distribution.
+// Bounds of -1 mean the extent is not bounded.
+LoopExtent FeatureVisitor::EstimateExtent(const PrimExpr& extent) const {
+  LoopExtent ret;
+  if (auto imm = extent.as<IntImmNode>()) {
+    ret.bound = ret.p50 = ret.p99 = imm->value;
+    ret.expected = static_cast<double>(imm->value);
+    return ret;
+  }
+  arith::Analyzer analyzer;
+  PrimExpr relaxed = Simplify(UninterpFun::InlineUninterpFunCalls(
+      UninterpFun::RelaxUninterpCallsMaxInclusive(extent, false)));
+  auto bound = analyzer.const_int_bound(relaxed);
+  if (bound->max_value != arith::ConstIntBound::kPosInf) ret.bound = bound->max_value;
+  ret.expected = static_cast<double>(ret.bound);
+  ret.p50 = ret.p99 = ret.bound;
+
+  PrimExpr inlined = UninterpFun::InlineUninterpFunCalls(extent, true);
+  ret.ragged = IsRagged(inlined);
+  if (!ret.ragged || lengths_.empty()) return ret;
+
+  auto evaluate = [&](int64_t length) {
+    PrimExpr value = Simplify(LengthSubstituter(length)(inlined));
+    auto value_bound = analyzer.const_int_bound(value);
+    int64_t v = value_bound->max_value;
+    if (v == arith::ConstIntBound::kPosInf) return ret.bound;
+    if (ret.bound >= 0) v = std::min(v, ret.bound);
+    return std::max<int64_t>(v, 0);
+  };
+  ret.expected = 0;
+  for (auto kv : lengths_.samples()) {
+    ret.expected += kv.second * static_cast<double>(evaluate(kv.first));
+  }
+  // Extents grow with the lengths, so their quantiles are the extents at
+  // the length quantiles.
+  ret.p50 = evaluate(lengths_.Quantile(0.5));
+  ret.p99 = evaluate(lengths_.Quantile(0.99));
+  return ret;
+}
+
+// Loads and ragged length calls in indices and loop bounds are reads of
+// auxiliary arrays.
+void FeatureVisitor::VisitAux(const PrimExpr& e) {
+  ++aux_depth_;
+  this->VisitExpr(e);
+  --aux_depth_;
+}
+
 // for loop
 void FeatureVisitor::VisitStmt_(const ForNode* op) {
-  const auto *extent = op->extent.as<IntImmNode>();
-  int64_t loop_extent = -1;
-  if (extent != nullptr)
-    loop_extent = extent->value;
+  LoopExtent loop_extent = EstimateExtent(op->extent);
   AnnotationType ann = kSerial;
   switch (op->for_type) {
     case ForType ::Parallel:
@@ -47,13 +179,17 @@ void FeatureVisitor::VisitStmt_(const ForNode* op) {
       break;
     case ForType::Serial:
       ann = kSerial;
+      break;
     case ForType::Peeled:
       LOG(FATAL) << "Peeled loops not supported yet";
       break;
   }
 
+  // the bounds are evaluated once per iteration of the enclosing loop
+  VisitAux(op->min);
+  VisitAux(op->extent);
   if (EnterItervar_(op->loop_var, loop_extent, ann)) {
-    StmtExprVisitor::VisitStmt_(op);
+    this->VisitStmt(op->body);
     ExitItervar_();
   }
 }
@@ -63,8 +199,7 @@ void FeatureVisitor::VisitStmt_(const AttrStmtNode* op) {
   if (op->attr_key == attr::thread_extent ||
       op->attr_key == attr::virtual_thread) {
     Var var = op->node.as<tir::IterVarNode>()->var;
-    const auto *extent = op->value.as<IntImmNode>();
-    CHECK(extent);
+    LoopExtent extent = EstimateExtent(op->value);
 
     std::string name = var.get()->name_hint;
     AnnotationType ann = kParallel;
@@ -87,8 +222,9 @@ void FeatureVisitor::VisitStmt_(const AttrStmtNode* op) {
       ann = kVirtualThread;
     }
 
-    if (EnterItervar_(var, extent->value, ann)) {
-      StmtExprVisitor::VisitStmt_(op);
+    VisitAux(op->value);
+    if (EnterItervar_(var, extent, ann)) {
+      this->VisitStmt(op->body);
       ExitItervar_();
     }
   } else {
@@ -98,16 +234,27 @@ void FeatureVisitor::VisitStmt_(const AttrStmtNode* op) {
 
 // memory access
 void FeatureVisitor::VisitExpr_(const LoadNode* op) {
+  if (aux_depth_ > 0) EnterAuxLoad_();
   EnterMem_(op->buffer_var, op->index);
-  StmtExprVisitor::VisitExpr_(op);
+  VisitAux(op->index);
+  VisitAux(op->predicate);
   ExitMem_();
 }
 
 void FeatureVisitor::VisitStmt_(const StoreNode* op) {
   EnterMem_(op->buffer_var, op->index);
-  StmtExprVisitor::VisitStmt_(op);
+  this->VisitExpr(op->value);
+  VisitAux(op->index);
+  VisitAux(op->predicate);
   ExitMem_();
 }
 
+void FeatureVisitor::VisitExpr_(const CallNode* op) {
+  if (auto ufun = op->func.as<UninterpFunNode>()) {
+    if (ufun->is_complex()) EnterAuxLoad_();
+  }
+  StmtExprVisitor::VisitExpr_(op);
+}
+
 }  // namespace autotvm
 }  // namespace tvm
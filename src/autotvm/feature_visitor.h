@@ -30,6 +30,8 @@
 #include <tvm/tir/stmt.h>
 #include <tvm/tir/stmt_functor.h>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace tvm {
 namespace autotvm {
@@ -45,12 +47,48 @@ enum AnnotationType {
   kNum,
 };
 
+/*!
+ * \brief A distribution of the lengths of ragged dimensions, as
+ *  weighted samples of a single length.
+ */
+class LengthDistribution {
+ public:
+  LengthDistribution() {}
+  LengthDistribution(const std::vector<int64_t>& lengths, const std::vector<double>& weights);
+
+  /*! \brief Whether no samples were given */
+  bool empty() const { return samples_.empty(); }
+  /*! \brief The smallest sampled length with cumulative weight at least q */
+  int64_t Quantile(double q) const;
+  /*! \brief The distinct lengths with their probabilities, in increasing order */
+  const std::vector<std::pair<int64_t, double> >& samples() const { return samples_; }
+
+ private:
+  std::vector<std::pair<int64_t, double> > samples_;
+};
+
+/*!
+ * \brief The extent of a loop. Ragged extents, which depend on calls to
+ *  uninterpreted functions, are evaluated against a length distribution.
+ *  Without one, all statistics equal the upper bound.
+ */
+struct LoopExtent {
+  int64_t bound{-1};    // upper bound, -1 if unbounded
+  double expected{-1};  // expected extent over the distribution
+  int64_t p50{-1};      // extent at the median length
+  int64_t p99{-1};      // extent at the 99th percentile length
+  bool ragged{false};
+};
+
 /*!
  * \brief A base class for feature extractor, used for processing
  * for loop and memory access in the IR
  */
 class FeatureVisitor : public StmtExprVisitor {
  public:
+  explicit FeatureVisitor(LengthDistribution lengths = LengthDistribution())
+      : lengths_(std::move(lengths)) {}
+
   // for loop
   void VisitStmt_(const ForNode* op) final;
   void VisitStmt_(const AttrStmtNode* op) final;
@@ -58,6 +96,7 @@ class FeatureVisitor : public StmtExprVisitor {
   // memory access
   void VisitExpr_(const LoadNode* op) final;
   void VisitStmt_(const StoreNode* op) final;
+  void VisitExpr_(const CallNode* op) final;
 
   using StmtExprVisitor::VisitStmt_;
   using StmtExprVisitor::VisitExpr_;
@@ -66,11 +105,11 @@ class FeatureVisitor : public StmtExprVisitor {
   /*!
  * \brief Enter a for loop node
  * \param var The expression to be printed.
- * \param length The output stream
+ * \param extent The extent of the loop
  * \param ann_type The type for the for loop
  * \return skip Whether skip this node
  */
-  virtual bool EnterItervar_(tir::Var var, int64_t length, AnnotationType ann_type) = 0;
+  virtual bool EnterItervar_(tir::Var var, const LoopExtent& extent, AnnotationType ann_type) = 0;
   /*! \brief Exit a for loop subtree */
   virtual void ExitItervar_() = 0;
   /*!
@@ -81,6 +120,21 @@ class FeatureVisitor : public StmtExprVisitor {
   virtual void EnterMem_(tir::Var buffer_var, tvm::PrimExpr index) = 0;
   /*! \brief Exit a memory access node */
   virtual void ExitMem_() = 0;
+  /*!
+   * \brief Visit a load of an auxiliary array, i.e. a load that computes
+   *  an index or a loop extent, or a call to a ragged length function.
+   */
+  virtual void EnterAuxLoad_() {}
+
+  /*! \brief The distribution ragged extents are evaluated against */
+  LengthDistribution lengths_;
+
+ private:
+  LoopExtent EstimateExtent(const PrimExpr& extent) const;
+  void VisitAux(const PrimExpr& e);
+
+  // > 0 while visiting indices and loop bounds
+  int aux_depth_{0};
 };
 
 }  // namespace autotvm
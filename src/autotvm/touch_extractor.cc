@@ -76,14 +76,15 @@ class IndexParser: public ExprVisitor {
 };
 
 // extract iter vars and their touch pattern from ir
-bool TouchExtractor::EnterItervar_(Var var, int64_t length, AnnotationType ann_type) {
+bool TouchExtractor::EnterItervar_(Var var, const LoopExtent& extent, AnnotationType ann_type) {
   // do not insert duplicated occurrences of virtual thread
   if (ann_type == kVirtualThread && itervar_map.count(var) != 0) {
     skip_stack_size_.push_back(itervar_stack_.size());
     return true;
   } else {
     itervar_stack_.push_back(var);
-    topdown_product_ *= length;
+    topdown_product_ *= static_cast<int64_t>(std::llround(extent.expected));
+    topdown_bound_product_ *= extent.bound;
 
     if (itervar_map.count(var) != 0) {
       // find two duplicated axes
@@ -95,10 +96,11 @@ bool TouchExtractor::EnterItervar_(Var var, int64_t length, AnnotationType ann_t
       itervar_map.erase(var);
     }
 
-    itervar_map.insert({var, ItervarFeature(var, length,
+    itervar_map.insert({var, ItervarFeature(var, extent,
                                             static_cast<int>(itervar_stack_.size()),
                                             ann_type,
                                             topdown_product_,
+                                            topdown_bound_product_,
                                             static_cast<int>(itervar_counter_++))});
   }
 
@@ -133,6 +135,8 @@ void TouchExtractor::ExitItervar_() {
   int64_t length = itervar_map[var].length;
   if (length != 0)
       topdown_product_ /= length;
+  if (itervar_map[var].length_bound != 0)
+      topdown_bound_product_ /= itervar_map[var].length_bound;
   int64_t bottomup_product = -1;
   for (auto kv : itervar_map[var].touch_feature) {
     bottomup_product = std::max(bottomup_product, kv.second.count * kv.second.reuse);
@@ -191,10 +195,17 @@ void TouchExtractor::EnterMem_(Var buffer_var, PrimExpr index) {
 void TouchExtractor::ExitMem_() {
 }
 
+void TouchExtractor::EnterAuxLoad_() {
+  if (!itervar_stack_.empty()) {
+    itervar_map[itervar_stack_.back()].aux_ct++;
+  }
+}
+
 /*!
  * \brief Get axis-based feature for all axes
  * \param stmt The statement to be extracted
  * \param bool Whether take log for numerical feature
+ * \param lengths The length distribution to evaluate ragged extents against
  * \param ret_feature The buffer where the return value is stored
  *
  * \note The format of return value is
@@ -202,6 +213,7 @@ void TouchExtractor::ExitMem_() {
  *   ('_itervar_',  var),
  *   ('_attr_',     length, nest_level, topdown, bottomup, one_hot_annotation),
  *   ('_arith_',    add_ct, mul_ct, div_ct),
+ *   ('_ragged_',   length_p50, length_p99, length_bound, aux_ct),
  *   ('data_vec_0', stride, mod, count, reuse, thread_count, thread_reuse),
  *   ('conv_0',     stride, mod, count, reuse, thread_count, thread_reuse),
  * ),
@@ -209,19 +221,23 @@ void TouchExtractor::ExitMem_() {
  *   ('_itervar_',    var2),
  *   ('_attr_',       length, nest_level, one_hot_annotation),
  *   ('_arith_',      add_ct, mul_ct, div_ct),
+ *   ('_ragged_',     length_p50, length_p99, length_bound, aux_ct),
  *   ('kernel_vec_0', stride, mod, count, reuse, thread_count, thread_reuse),
  *   ('conv_1',       stride, mod, count, reuse, thread_count, thread_reuse),
  * ))
  *
+ * The length of an axis over a ragged dimension is its expected length
+ * over the length distribution, or its upper bound without one.
  * Itervars are sorted according to their first occurrence position in IR.
  * Buffers touched by an itervar are sorted by their unique names.
  *
  * \note If you want to flatten these features as the input of your model,
  * You can use the faster one GetItervarFeatureFlatten below.
  */
-void GetItervarFeature(Stmt stmt, bool take_log, Array<Array<Array<PrimExpr> > > *ret_feature) {
+void GetItervarFeature(Stmt stmt, bool take_log, const LengthDistribution& lengths,
+                       Array<Array<Array<PrimExpr> > > *ret_feature) {
   // extract
-  TouchExtractor touch_analyzer;
+  TouchExtractor touch_analyzer(lengths);
   touch_analyzer.Analyze(stmt);
 
   // sort according to order
@@ -273,6 +289,14 @@ void GetItervarFeature(Stmt stmt, bool take_log, Array<Array<Array<PrimExpr> > >
             FloatImm(DataType::Float(32), trans(fea.div_ct)),
     });
 
+    // ragged extents and auxiliary loads
+    feature_row.push_back(Array<PrimExpr>{std::string("_ragged_"),
+            FloatImm(DataType::Float(32), trans(fea.length_p50)),
+            FloatImm(DataType::Float(32), trans(fea.length_p99)),
+            FloatImm(DataType::Float(32), trans(fea.length_bound)),
+            FloatImm(DataType::Float(32), trans(fea.aux_ct)),
+    });
+
     // touch map
     std::vector<TouchedBuffer> bufs;
     for (auto kv : fea.touch_feature) {
@@ -300,14 +324,16 @@ void GetItervarFeature(Stmt stmt, bool take_log, Array<Array<Array<PrimExpr> > >
  * \brief Get axis-based feature for all axes and flatten them into a one-dimensional vector.
  * \param stmt The statement to be extracted
  * \param bool Whether take log for numerical feature
+ * \param lengths The length distribution to evaluate ragged extents against
  * \param ret_feature The buffer where the return value is stored
  *
  * \note See GetItervarFeature for more details about the return value.
  *       This is an optimized version of GetItervarFeature + Flatten. This runs much faster.
  */
-void GetItervarFeatureFlatten(Stmt stmt, bool take_log, std::vector<float> *ret_feature) {
+void GetItervarFeatureFlatten(Stmt stmt, bool take_log, const LengthDistribution& lengths,
+                              std::vector<float> *ret_feature) {
   // extract touch feature
-  TouchExtractor touch_analyzer;
+  TouchExtractor touch_analyzer(lengths);
   touch_analyzer.Analyze(stmt);
 
   // sort according to order
@@ -353,6 +379,12 @@ void GetItervarFeatureFlatten(Stmt stmt, bool take_log, std::vector<float> *ret_
     ret_feature->push_back(trans(fea.mul_ct));
     ret_feature->push_back(trans(fea.div_ct));
 
+    // ragged extents and auxiliary loads
+    ret_feature->push_back(trans(fea.length_p50));
+    ret_feature->push_back(trans(fea.length_p99));
+    ret_feature->push_back(trans(fea.length_bound));
+    ret_feature->push_back(trans(fea.aux_ct));
+
     // touch map
     std::vector<TouchedBuffer> bufs;
     for (auto kv : fea.touch_feature) {
@@ -375,11 +407,17 @@ void GetItervarFeatureFlatten(Stmt stmt, bool take_log, std::vector<float> *ret_
  * \brief Get curve sample feature (relation feature) and flatten them into a one-dimensional vector.
  * \param stmt The statement to be extracted
  * \param sample_n The number of points used for sampling a curve (along one dimension)
+ * \param lengths The length distribution to evaluate ragged extents against
  * \param ret_feature The buffer where the return value is stored
+ *
+ * \note Two loop structure invariant features follow the curves: the
+ *  number of auxiliary array loads executed, and the ratio of the
+ *  expected iteration space to its upper bound, both in log scale.
  */
-void GetCurveSampleFeatureFlatten(Stmt stmt, int sample_n, std::vector<float> *ret_feature) {
+void GetCurveSampleFeatureFlatten(Stmt stmt, int sample_n, const LengthDistribution& lengths,
+                                  std::vector<float> *ret_feature) {
   // extract touch feature
-  TouchExtractor touch_ext;
+  TouchExtractor touch_ext(lengths);
   touch_ext.Analyze(stmt);
 
   // sort according to order
@@ -482,6 +520,38 @@ void GetCurveSampleFeatureFlatten(Stmt stmt, int sample_n, std::vector<float> *r
     sample_curve(count, top_down, 1);
     sample_curve(top_down, count, 1);
   }
+
+  // ragged iteration space and auxiliary loads
+  double aux_loads = 0;
+  int64_t iterations = 1, bound_iterations = 1;
+  for (auto var : vars) {
+    ItervarFeature &fea = touch_ext.itervar_map[var];
+    aux_loads += static_cast<double>(fea.aux_ct) * std::max<int64_t>(fea.topdown_product, 1);
+    iterations = std::max(iterations, fea.topdown_product);
+    bound_iterations = std::max(bound_iterations, fea.topdown_bound_product);
+  }
+  double ratio = 1;
+  if (iterations > 0 && bound_iterations > 0) {
+    ratio = static_cast<double>(iterations) / bound_iterations;
+  }
+  ret_feature->emplace_back(std::log(aux_loads + 1) / std::log(2));
+  ret_feature->emplace_back(std::log(ratio) / std::log(2));
+}
+
+// length distribution of the front end, as lengths and their weights
+static LengthDistribution GetLengthDistribution(TVMArgs args, int begin) {
+  if (args.size() <= begin + 1) return LengthDistribution();
+  Array<PrimExpr> lengths = args[begin];
+  Array<PrimExpr> weights = args[begin + 1];
+  std::vector<int64_t> length_values;
+  std::vector<double> weight_values;
+  for (auto length : lengths) {
+    length_values.push_back(Downcast<IntImm>(length)->value);
+  }
+  for (auto weight : weights) {
+    weight_values.push_back(Downcast<FloatImm>(weight)->value);
+  }
+  return LengthDistribution(length_values, weight_values);
 }
 
 
@@ -492,7 +562,7 @@ TVM_REGISTER_GLOBAL("autotvm.feature.GetItervarFeature")
   bool take_log = args[1];
   Array<Array<Array<PrimExpr > > > ret_feature;
 
-  GetItervarFeature(stmt, take_log, &ret_feature);
+  GetItervarFeature(stmt, take_log, GetLengthDistribution(args, 2), &ret_feature);
 
   *ret = ret_feature;
 });
@@ -504,7 +574,7 @@ TVM_REGISTER_GLOBAL("autotvm.feature.GetItervarFeatureFlatten")
   bool take_log = args[1];
   std::vector<float> ret_feature;
 
-  GetItervarFeatureFlatten(stmt, take_log, &ret_feature);
+  GetItervarFeatureFlatten(stmt, take_log, GetLengthDistribution(args, 2), &ret_feature);
 
   TVMByteArray arr;
   arr.size = sizeof(float) * ret_feature.size();
@@ -519,7 +589,7 @@ TVM_REGISTER_GLOBAL("autotvm.feature.GetCurveSampleFeatureFlatten")
   int sample_n = args[1];
   std::vector<float> ret_feature;
 
-  GetCurveSampleFeatureFlatten(stmt, sample_n, &ret_feature);
+  GetCurveSampleFeatureFlatten(stmt, sample_n, GetLengthDistribution(args, 2), &ret_feature);
 
   TVMByteArray arr;
   arr.size = sizeof(float) * ret_feature.size();
@@ -29,7 +29,9 @@
 #include <tvm/tir/expr_functor.h>
 #include <tvm/runtime/registry.h>
 
+#include <cmath>
 #include <stack>
+#include <utility>
 #include <vector>
 #include <map>
 #include <string>
@@ -56,19 +58,27 @@ struct TouchPattern {
 // all the feature of an iter var
 struct ItervarFeature {
   ItervarFeature(Var var,
-                 int64_t extent,
+                 const LoopExtent& extent,
                  int nest,
                  AnnotationType ann_type,
                  int64_t topdown,
+                 int64_t topdown_bound,
                  int counter)
-      : length(extent), nest_level(nest), ann(ann_type), topdown_product(topdown), order(counter) {}
+      : length(static_cast<int64_t>(std::llround(extent.expected))),
+        length_bound(extent.bound), length_p50(extent.p50), length_p99(extent.p99),
+        nest_level(nest), ann(ann_type), topdown_product(topdown),
+        topdown_bound_product(topdown_bound), order(counter) {}
   ItervarFeature() {}
 
   // Axis Attributes
-  int64_t length;
+  int64_t length;             // expected length over the length distribution
+  int64_t length_bound;       // upper bound of length
+  int64_t length_p50;         // median and 99th percentile length, for ragged axes
+  int64_t length_p99;
   int nest_level;
   AnnotationType ann;         // one-hot axis type
   int64_t topdown_product;    // accumulative product of axis length, in top-down order
+  int64_t topdown_bound_product;  // accumulative product of axis upper bounds, top-down
   int64_t bottomup_product;   // accumulative product of axis length, in bottom-up order
   // bottomup_product = reuse * count for any touched buffer
 
@@ -79,6 +89,10 @@ struct ItervarFeature {
   int mul_ct{0};
   int div_ct{0};
 
+  // Auxiliary array loads, e.g. of the lengths and prefix sums of ragged
+  // dimensions
+  int aux_ct{0};
+
   // Memory Touch Feature
   std::unordered_map<TouchedBuffer, TouchPattern> touch_feature;
 };
@@ -86,6 +100,9 @@ struct ItervarFeature {
 // extract iter vars and their touch pattern from ir
 class TouchExtractor : public FeatureVisitor {
  public:
+  explicit TouchExtractor(LengthDistribution lengths = LengthDistribution())
+      : FeatureVisitor(std::move(lengths)) {}
+
   void Analyze(const Stmt& stmt) {
     operator()(stmt);
   }
@@ -124,12 +141,14 @@ class TouchExtractor : public FeatureVisitor {
   std::unordered_map<Var, ItervarFeature, tvm::ObjectHash, tvm::ObjectEqual> itervar_map;
 
  private:
-  bool EnterItervar_(Var var, int64_t length, AnnotationType ann_type);
+  bool EnterItervar_(Var var, const LoopExtent& extent, AnnotationType ann_type);
   void ExitItervar_();
   void EnterMem_(Var buffer_var, PrimExpr index);
   void ExitMem_();
+  void EnterAuxLoad_();
 
   int64_t topdown_product_{1};
+  int64_t topdown_bound_product_{1};
   std::map<std::string, size_t> buffer_counter_;
   size_t itervar_counter_{0};
   std::deque<Var> itervar_stack_;  // use deque instead of stack for indexing
@@ -23,6 +23,8 @@
  */
 #include <dmlc/thread_local.h>
 #include <tvm/driver/driver_api.h>
+#include <tvm/driver/pass_profiler.h>
+#include <tvm/runtime/memory.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/target/codegen.h>
 #include <tvm/te/operation.h>
@@ -116,34 +118,60 @@ tir::Stmt BuildStmt(te::Schedule sch, const Array<te::Tensor>& args,
   sch = sch.normalize();
 
   // Phase 0
-  auto bounds = te::InferBound(sch);
-  auto stmt = te::ScheduleOps(sch, bounds, false, true, true, {});
-  stmt = tir::InjectPrefetch(stmt);
+  auto bounds = ProfilePass("InferBound", [&] { return te::InferBound(sch); });
+  if (config->diagnose_ragged_bounds) {
+    for (const auto& d : te::DiagnoseRaggedBounds(sch, bounds)) {
+      LOG(WARNING) << "Dense bound: stage " << Downcast<te::Operation>(d[0])->name
+                   << ", dimension " << Downcast<tir::IterVar>(d[1])->var << ": inferred extent "
+                   << Downcast<Range>(d[3])->extent << " over-approximates the ragged extent "
+                   << Downcast<Range>(d[2])->extent << ", as " << d[4]
+                   << " could not be proven";
+    }
+  }
+  auto stmt = ProfilePass("ScheduleOps",
+                          [&] { return te::ScheduleOps(sch, bounds, false, true, true, {}); });
+  stmt = ProfilePass("InjectPrefetch", [&] { return tir::InjectPrefetch(stmt); });
 
   bool compact = tir::VerifyCompactBuffer(stmt);
   Map<te::Tensor, tir::Buffer> out_binds;
   GetBinds(args, compact, binds, &out_binds, out_arg_list, config);
 
   // Phase 1
-  stmt = tir::StorageFlatten(stmt, out_binds, 64, config->instrument_bound_checkers);
-  stmt = tir::CanonicalSimplify(stmt);
+  stmt = ProfilePass("StorageFlatten", [&] {
+    return tir::StorageFlatten(stmt, out_binds, 64, config->instrument_bound_checkers);
+  });
+  stmt = ProfilePass("CanonicalSimplify", [&] { return tir::CanonicalSimplify(stmt); });
   if (loop_partition) {
-    stmt = tir::LoopPartition(stmt, config->partition_const_loop);
+    stmt = ProfilePass("LoopPartition",
+                       [&] { return tir::LoopPartition(stmt, config->partition_const_loop); });
   }
   if (config->disable_vectorize) {
     stmt = tir::SkipVectorize(stmt);
   } else {
-    stmt = tir::VectorizeLoop(stmt);
+    stmt = ProfilePass("VectorizeLoop", [&] { return tir::VectorizeLoop(stmt); });
   }
-  stmt = tir::InjectVirtualThread(stmt);
-  stmt = tir::InjectDoubleBuffer(stmt, config->double_buffer_split_loop);
-  stmt = tir::StorageRewrite(stmt);
-  stmt = tir::UnrollLoop(stmt, config->auto_unroll_max_step, config->auto_unroll_max_depth,
-                         config->auto_unroll_max_extent, config->unroll_explicit);
+  stmt = ProfilePass("InjectVirtualThread", [&] { return tir::InjectVirtualThread(stmt); });
+  stmt = ProfilePass("InjectDoubleBuffer", [&] {
+    return tir::InjectDoubleBuffer(stmt, config->double_buffer_split_loop,
+                                   config->double_buffer_async_copy);
+  });
+  stmt = ProfilePass("StorageRewrite", [&] { return tir::StorageRewrite(stmt); });
+  if (config->auto_unroll_max_ragged_extent > 0) {
+    stmt = ProfilePass("UnrollRaggedLoop", [&] {
+      return tir::UnrollRaggedLoop(stmt, config->auto_unroll_max_ragged_extent);
+    });
+  }
+  stmt = ProfilePass("UnrollLoop", [&] {
+    return tir::UnrollLoop(stmt, config->auto_unroll_max_step, config->auto_unroll_max_depth,
+                           config->auto_unroll_max_extent, config->unroll_explicit);
+  });
 
   // Phase 2
-  stmt = tir::Simplify(stmt);
-  stmt = tir::RemoveNoOp(stmt);
+  stmt = ProfilePass("Simplify", [&] { return tir::Simplify(stmt); });
+  stmt = ProfilePass("RemoveNoOp", [&] { return tir::RemoveNoOp(stmt); });
+  if (config->eliminate_common_subexpr) {
+    stmt = ProfilePass("EliminateCommonSubexpr", [&] { return tir::EliminateCommonSubexpr(stmt); });
+  }
 
   if (!(config->disable_select_rewriting)) stmt = tir::RewriteUnsafeSelect(stmt);
 
@@ -155,6 +183,7 @@ tir::Stmt BuildStmt(te::Schedule sch, const Array<te::Tensor>& args,
 Array<LoweredFunc> lower(te::Schedule sch, const Array<te::Tensor>& args, const std::string& name,
                          const std::unordered_map<te::Tensor, tir::Buffer>& binds,
                          const BuildConfig& config) {
+  runtime::ObjectPoolScope pool_scope(config->pool_ir_nodes);
   Array<ObjectRef> out_arg_list;
   auto stmt = BuildStmt(sch, args, binds, true, &out_arg_list, config);
   return Array<LoweredFunc>({tir::MakeAPI(stmt, name, out_arg_list, {}, 0, config->restricted_func,
@@ -188,6 +217,10 @@ Array<Array<LoweredFunc>> split_dev_host_funcs(const Array<LoweredFunc>& funcs,
       func = tir::ThreadSync(func, "shared", target->target_name);
       func = tir::ThreadSync(func, "warp", target->target_name);
       func = tir::LowerThreadAllreduce(func, target->thread_warp_size, target->target_name);
+      if (config->instrument_block_cycles &&
+          (target->target_name == "cuda" || target->target_name == "nvptx")) {
+        func = tir::InstrumentBlockCycles(func, target->device_type);
+      }
       auto fsplits = tir::SplitHostDevice(func);
       fhost.push_back(fsplits[0]);
       for (auto f = fsplits.begin() + 1; f != fsplits.end(); ++f) {
@@ -228,6 +261,13 @@ Array<Array<LoweredFunc>> split_dev_host_funcs(const Array<LoweredFunc>& funcs,
                            << "\n";
   }
 
+  if (config->fast_call_api) {
+    size_t num_packed = fhost.size();
+    for (size_t i = 0; i < num_packed; ++i) {
+      if (fhost[i]->is_packed_func) fhost.push_back(tir::MakeFastCall(fhost[i]));
+    }
+  }
+
   for (size_t i = 0; i < fhost.size(); ++i) {
     auto func = fhost[i];
     func = tir::BindDeviceType(func, target->device_type);
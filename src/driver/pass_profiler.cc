@@ -0,0 +1,176 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file pass_profiler.cc
+ * \brief Compile time profiling of the lowering passes.
+ */
+#include <tvm/arith/z3_analyzer.h>
+#include <tvm/driver/pass_profiler.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/lowered_func.h>
+#include <tvm/tir/stmt_functor.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace tvm {
+
+namespace {
+
+struct SpanRecord {
+  std::string name;
+  int64_t start_us;
+  int64_t dur_us;
+  int64_t num_nodes;
+  int64_t z3_queries;
+  int64_t z3_us;
+  std::thread::id tid;
+};
+
+struct Profile {
+  std::atomic<bool> enabled{false};
+  std::chrono::steady_clock::time_point origin;
+  std::mutex mutex;
+  std::vector<SpanRecord> spans;
+};
+
+Profile* GetProfile() {
+  static Profile profile;
+  return &profile;
+}
+
+int64_t CountNodes(const ObjectRef& node) {
+  if (!node.defined()) return 0;
+  if (auto arr = node.as<ArrayNode>()) {
+    int64_t ret = 0;
+    for (const auto& elem : arr->data) ret += CountNodes(elem);
+    return ret;
+  }
+  if (auto func = node.as<tir::LoweredFuncNode>()) return CountNodes(func->body);
+  if (!node->IsInstance<tir::StmtNode>() && !node->IsInstance<PrimExprNode>()) return -1;
+  int64_t ret = 0;
+  tir::PostOrderVisit(node, [&ret](const ObjectRef& n) { ++ret; });
+  return ret;
+}
+
+void EscapeJSON(std::ostream& os, const std::string& str) {
+  for (char c : str) {
+    if (c == '"' || c == '\\') os << '\\';
+    os << c;
+  }
+}
+
+}  // namespace
+
+bool PassProfilingEnabled() { return GetProfile()->enabled; }
+
+void StartPassProfiling() {
+  Profile* profile = GetProfile();
+  std::lock_guard<std::mutex> lock(profile->mutex);
+  profile->spans.clear();
+  profile->origin = std::chrono::steady_clock::now();
+  profile->enabled = true;
+}
+
+std::string StopPassProfiling() {
+  Profile* profile = GetProfile();
+  std::lock_guard<std::mutex> lock(profile->mutex);
+  profile->enabled = false;
+
+  std::unordered_map<std::thread::id, int> tids;
+  std::ostringstream os;
+  os << "{\"traceEvents\": [";
+  for (size_t i = 0; i < profile->spans.size(); ++i) {
+    const SpanRecord& span = profile->spans[i];
+    auto it = tids.insert({span.tid, static_cast<int>(tids.size())}).first;
+    os << (i == 0 ? "\n" : ",\n") << "  {\"name\": \"";
+    EscapeJSON(os, span.name);
+    os << "\", \"cat\": \"pass\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << it->second
+       << ", \"ts\": " << span.start_us << ", \"dur\": " << span.dur_us << ", \"args\": {";
+    if (span.num_nodes >= 0) os << "\"nodes\": " << span.num_nodes << ", ";
+    os << "\"z3_queries\": " << span.z3_queries << ", \"z3_us\": " << span.z3_us << "}}";
+  }
+  os << "\n], \"displayTimeUnit\": \"ms\"}\n";
+  return os.str();
+}
+
+PassSpan::PassSpan(std::string name)
+    : enabled_(PassProfilingEnabled()), name_(std::move(name)) {
+  if (!enabled_) return;
+  arith::Z3Analyzer::Stats stats = arith::Z3Analyzer::GlobalStats();
+  z3_queries_ = stats.num_queries;
+  z3_us_ = stats.query_us;
+  start_ = std::chrono::steady_clock::now();
+}
+
+void PassSpan::SetResult(const ObjectRef& result) {
+  if (enabled_) num_nodes_ = CountNodes(result);
+}
+
+PassSpan::~PassSpan() {
+  Profile* profile = GetProfile();
+  if (!enabled_ || !profile->enabled) return;
+  auto end = std::chrono::steady_clock::now();
+  arith::Z3Analyzer::Stats stats = arith::Z3Analyzer::GlobalStats();
+  using std::chrono::duration_cast;
+  using std::chrono::microseconds;
+  std::lock_guard<std::mutex> lock(profile->mutex);
+  profile->spans.push_back({name_, duration_cast<microseconds>(start_ - profile->origin).count(),
+                            duration_cast<microseconds>(end - start_).count(), num_nodes_,
+                            stats.num_queries - z3_queries_, stats.query_us - z3_us_,
+                            std::this_thread::get_id()});
+}
+
+runtime::PackedFunc ProfiledPackedFunc(const char* name, runtime::PackedFunc body) {
+  return runtime::PackedFunc([name, body](runtime::TVMArgs args, runtime::TVMRetValue* rv) {
+    if (!PassProfilingEnabled()) return body.CallPacked(args, rv);
+    PassSpan span(name);
+    body.CallPacked(args, rv);
+    if (rv->type_code() == kTVMObjectHandle) span.SetResult(rv->operator ObjectRef());
+  });
+}
+
+// Python passes and the other steps of the pipeline that are not
+// packed functions record their spans through a stack.
+static thread_local std::vector<std::unique_ptr<PassSpan>> python_spans;
+
+TVM_REGISTER_GLOBAL("driver.StartPassProfiling").set_body_typed(StartPassProfiling);
+
+TVM_REGISTER_GLOBAL("driver.StopPassProfiling").set_body_typed(StopPassProfiling);
+
+TVM_REGISTER_GLOBAL("driver.BeginPassSpan").set_body_typed([](std::string name) {
+  python_spans.emplace_back(new PassSpan(name));
+});
+
+TVM_REGISTER_GLOBAL("driver.EndPassSpan").set_body([](runtime::TVMArgs args,
+                                                      runtime::TVMRetValue* rv) {
+  CHECK(!python_spans.empty()) << "No pass span to end";
+  if (args.size() > 0 && args[0].type_code() == kTVMObjectHandle) {
+    python_spans.back()->SetResult(args[0].operator ObjectRef());
+  }
+  python_spans.pop_back();
+});
+
+}  // namespace tvm
@@ -30,9 +30,15 @@
 #include <tvm/node/reflection.h>
 #include <tvm/node/serialization.h>
 #include <tvm/ir/attrs.h>
+#include <tvm/tir/expr.h>
+#include <tvm/tir/stmt.h>
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <map>
+#include <tuple>
+#include <unordered_set>
 
 #include "../support/base64.h"
 
@@ -456,9 +462,666 @@ ObjectRef LoadJSON(std::string json_str) {
   return ObjectRef(nodes.at(jgraph.root));
 }
 
+// Hashing that only depends on the contents of the nodes, so that it
+// is the same across processes.
+inline uint64_t HashCombine(uint64_t seed, uint64_t value) {
+  return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+inline uint64_t HashBytes(const void* data, size_t size) {
+  // FNV-1a
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+inline uint64_t HashString(const std::string& str) {
+  return HashBytes(str.data(), str.size());
+}
+
+// Hashes nodes bottom up, memoizing the hash of every node so that
+// shared subgraphs are only hashed once.
+class StructuralHasher : public AttrVisitor {
+ public:
+  void Visit(const char* key, double* value) final {
+    hash_ = HashCombine(hash_, HashBytes(value, sizeof(double)));
+  }
+  void Visit(const char* key, int64_t* value) final {
+    hash_ = HashCombine(hash_, static_cast<uint64_t>(*value));
+  }
+  void Visit(const char* key, uint64_t* value) final {
+    hash_ = HashCombine(hash_, *value);
+  }
+  void Visit(const char* key, int* value) final {
+    hash_ = HashCombine(hash_, static_cast<uint64_t>(*value));
+  }
+  void Visit(const char* key, bool* value) final {
+    hash_ = HashCombine(hash_, *value);
+  }
+  void Visit(const char* key, std::string* value) final {
+    hash_ = HashCombine(hash_, HashString(*value));
+  }
+  void Visit(const char* key, void** value) final {}
+  void Visit(const char* key, DataType* value) final {
+    hash_ = HashCombine(hash_, value->code());
+    hash_ = HashCombine(hash_, value->bits());
+    hash_ = HashCombine(hash_, value->lanes());
+  }
+  void Visit(const char* key, runtime::NDArray* value) final {
+    if (!value->defined()) {
+      hash_ = HashCombine(hash_, 0);
+      return;
+    }
+    const DLTensor* tensor = (*value).operator->();
+    for (int i = 0; i < tensor->ndim; ++i) {
+      hash_ = HashCombine(hash_, static_cast<uint64_t>(tensor->shape[i]));
+    }
+    hash_ = HashCombine(hash_, HashString(runtime::DLDataType2String(tensor->dtype)));
+    if (tensor->ctx.device_type == kDLCPU && tensor->strides == nullptr) {
+      size_t size = runtime::GetDataSize(*tensor);
+      hash_ = HashCombine(
+          hash_, HashBytes(static_cast<const char*>(tensor->data) + tensor->byte_offset, size));
+    }
+  }
+  void Visit(const char* key, ObjectRef* value) final {
+    hash_ = HashCombine(hash_, Hash(value->get()));
+  }
+
+  uint64_t Hash(const Object* node) {
+    if (node == nullptr) return 0;
+    auto it = memo_.find(node);
+    if (it != memo_.end()) return it->second;
+    uint64_t type_hash = HashString(node->GetTypeKey());
+    // A back edge of a cyclic graph.
+    if (visiting_.count(node)) return type_hash;
+    visiting_.insert(node);
+
+    uint64_t outer = hash_;
+    hash_ = type_hash;
+    std::string global_key = reflection_->GetGlobalKey(const_cast<Object*>(node));
+    if (global_key.length() != 0) {
+      hash_ = HashCombine(hash_, HashString(global_key));
+    } else if (node->IsInstance<ArrayNode>()) {
+      const ArrayNode* n = static_cast<const ArrayNode*>(node);
+      for (const auto& elem : n->data) {
+        hash_ = HashCombine(hash_, Hash(elem.get()));
+      }
+    } else if (node->IsInstance<MapNode>()) {
+      // The entries are unordered, and so is their combination.
+      const MapNode* n = static_cast<const MapNode*>(node);
+      uint64_t entries = 0;
+      for (const auto& kv : n->data) {
+        entries += HashCombine(Hash(kv.first.get()), Hash(kv.second.get()));
+      }
+      hash_ = HashCombine(hash_, entries);
+    } else if (node->IsInstance<StrMapNode>()) {
+      const StrMapNode* n = static_cast<const StrMapNode*>(node);
+      uint64_t entries = 0;
+      for (const auto& kv : n->data) {
+        entries += HashCombine(HashString(kv.first), Hash(kv.second.get()));
+      }
+      hash_ = HashCombine(hash_, entries);
+    } else {
+      reflection_->VisitAttrs(const_cast<Object*>(node), this);
+    }
+    uint64_t ret = hash_;
+    hash_ = outer;
+
+    visiting_.erase(node);
+    memo_[node] = ret;
+    return ret;
+  }
+
+ private:
+  uint64_t hash_{0};
+  std::unordered_map<const Object*, uint64_t> memo_;
+  std::unordered_set<const Object*> visiting_;
+  ReflectionVTable* reflection_ = ReflectionVTable::Global();
+};
+
+uint64_t StructuralHash(const ObjectRef& node) {
+  return StructuralHasher().Hash(node.get());
+}
+
+// The fields of a node, with the nodes it refers to replaced by their
+// representatives. Two nodes with equal keys are structurally equal
+// once their children have been merged.
+struct ShallowKey {
+  std::vector<uint64_t> words;
+  std::vector<std::string> strings;
+
+  bool operator==(const ShallowKey& other) const {
+    return words == other.words && strings == other.strings;
+  }
+};
+
+struct ShallowKeyHash {
+  size_t operator()(const ShallowKey& key) const {
+    uint64_t hash = 0;
+    for (uint64_t word : key.words) hash = HashCombine(hash, word);
+    for (const auto& str : key.strings) hash = HashCombine(hash, HashString(str));
+    return static_cast<size_t>(hash);
+  }
+};
+
+// Merges structurally equal nodes of a graph into a single
+// representative. Only immutable nodes without an identity of their
+// own are merged: expressions other than variables, statements and
+// containers. Variables, iteration variables, operations, buffers and
+// the like keep their identity, as do map keys and the nodes reachable
+// from them, since maps compare keys by address.
+class NodeMerger : public AttrVisitor {
+ public:
+  // Keep the map keys of the graph rooted at root, and the nodes
+  // reachable from them, from being merged.
+  void PinMapKeys(const Object* root) {
+    NodeIndexer graph;
+    graph.MakeIndex(const_cast<Object*>(root));
+    NodeIndexer keys;
+    for (Object* node : graph.node_list_) {
+      if (node == nullptr || !node->IsInstance<MapNode>()) continue;
+      for (const auto& kv : static_cast<MapNode*>(node)->data) {
+        keys.MakeIndex(const_cast<Object*>(kv.first.get()));
+      }
+    }
+    pinned_.insert(keys.node_list_.begin(), keys.node_list_.end());
+  }
+
+  void Visit(const char* key, double* value) final {
+    uint64_t bits;
+    std::memcpy(&bits, value, sizeof(bits));
+    key_->words.push_back(bits);
+  }
+  void Visit(const char* key, int64_t* value) final {
+    key_->words.push_back(static_cast<uint64_t>(*value));
+  }
+  void Visit(const char* key, uint64_t* value) final { key_->words.push_back(*value); }
+  void Visit(const char* key, int* value) final {
+    key_->words.push_back(static_cast<uint64_t>(*value));
+  }
+  void Visit(const char* key, bool* value) final { key_->words.push_back(*value); }
+  void Visit(const char* key, std::string* value) final { key_->strings.push_back(*value); }
+  void Visit(const char* key, void** value) final {
+    key_->words.push_back(reinterpret_cast<uint64_t>(*value));
+  }
+  void Visit(const char* key, DataType* value) final {
+    key_->words.push_back((static_cast<uint64_t>(value->code()) << 48) |
+                          (static_cast<uint64_t>(value->bits()) << 32) |
+                          static_cast<uint64_t>(value->lanes()));
+  }
+  void Visit(const char* key, runtime::NDArray* value) final {
+    key_->words.push_back(reinterpret_cast<uint64_t>((*value).operator->()));
+  }
+  void Visit(const char* key, ObjectRef* value) final {
+    key_->words.push_back(reinterpret_cast<uint64_t>(Merge(value->get())));
+  }
+
+  // The representative of node.
+  Object* Merge(const Object* node) {
+    Object* mnode = const_cast<Object*>(node);
+    if (node == nullptr) return nullptr;
+    auto it = repr_.find(node);
+    if (it != repr_.end()) return it->second;
+    if (visiting_.count(node)) return mnode;
+
+    bool mergeable = IsMergeable(node);
+    // Nodes that are not merged are their own representatives, which
+    // also ends the cycles of a graph going through them.
+    if (!mergeable) repr_[node] = mnode;
+    visiting_.insert(node);
+
+    ShallowKey key;
+    ShallowKey* outer = key_;
+    key_ = &key;
+    key.words.push_back(node->type_index());
+    if (node->IsInstance<ArrayNode>()) {
+      const ArrayNode* n = static_cast<const ArrayNode*>(node);
+      key.words.push_back(n->data.size());
+      for (const auto& elem : n->data) {
+        key.words.push_back(reinterpret_cast<uint64_t>(Merge(elem.get())));
+      }
+    } else if (node->IsInstance<MapNode>()) {
+      const MapNode* n = static_cast<const MapNode*>(node);
+      std::vector<std::pair<uint64_t, uint64_t> > entries;
+      for (const auto& kv : n->data) {
+        entries.emplace_back(reinterpret_cast<uint64_t>(Merge(kv.first.get())),
+                             reinterpret_cast<uint64_t>(Merge(kv.second.get())));
+      }
+      std::sort(entries.begin(), entries.end());
+      for (const auto& kv : entries) {
+        key.words.push_back(kv.first);
+        key.words.push_back(kv.second);
+      }
+    } else if (node->IsInstance<StrMapNode>()) {
+      const StrMapNode* n = static_cast<const StrMapNode*>(node);
+      std::map<std::string, uint64_t> entries;
+      for (const auto& kv : n->data) {
+        entries[kv.first] = reinterpret_cast<uint64_t>(Merge(kv.second.get()));
+      }
+      for (const auto& kv : entries) {
+        key.strings.push_back(kv.first);
+        key.words.push_back(kv.second);
+      }
+    } else if (reflection_->GetGlobalKey(mnode).length() == 0) {
+      reflection_->VisitAttrs(mnode, this);
+    }
+    key_ = outer;
+    visiting_.erase(node);
+
+    if (!mergeable) return mnode;
+    Object* repr = table_.insert({std::move(key), mnode}).first->second;
+    repr_[node] = repr;
+    return repr;
+  }
+
+ private:
+  bool IsMergeable(const Object* node) const {
+    if (pinned_.count(node)) return false;
+    if (node->IsInstance<PrimExprNode>()) return !node->IsInstance<tir::VarNode>();
+    return node->IsInstance<tir::StmtNode>() || node->IsInstance<ArrayNode>() ||
+           node->IsInstance<MapNode>() || node->IsInstance<StrMapNode>();
+  }
+
+  ShallowKey* key_{nullptr};
+  std::unordered_map<const Object*, Object*> repr_;
+  std::unordered_set<const Object*> visiting_;
+  std::unordered_set<const Object*> pinned_;
+  std::unordered_map<ShallowKey, Object*, ShallowKeyHash> table_;
+  ReflectionVTable* reflection_ = ReflectionVTable::Global();
+};
+
+// The binary format is laid out as
+//
+//   magic, reserved, tvm version,
+//   type keys,
+//   number of nodes, root, (type, global key) of every node,
+//   tensors,
+//   fields of every node.
+//
+// Nodes are numbered in the order they are first reached from the
+// root, with 0 for null. Integers are written as LEB128 varints,
+// zigzag encoded when signed. Map entries are written in the order
+// of the structural hashes of their keys and values, and string map
+// entries in the order of their keys, so that the same graph
+// always serializes to the same bytes.
+constexpr uint64_t kTVMBinaryNodeMagic = 0xDD5E40F096B4A13F;
+
+class BinaryOutStream {
+ public:
+  explicit BinaryOutStream(std::string* out) : out_(out) {}
+
+  void WriteUInt(uint64_t value) {
+    while (value >= 0x80) {
+      out_->push_back(static_cast<char>((value & 0x7f) | 0x80));
+      value >>= 7;
+    }
+    out_->push_back(static_cast<char>(value));
+  }
+  void WriteInt(int64_t value) {
+    WriteUInt((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+  }
+  void WriteBytes(const void* data, size_t size) {
+    out_->append(static_cast<const char*>(data), size);
+  }
+  void WriteString(const std::string& str) {
+    WriteUInt(str.size());
+    WriteBytes(str.data(), str.size());
+  }
+
+ private:
+  std::string* out_;
+};
+
+class BinaryInStream {
+ public:
+  BinaryInStream(const char* data, size_t size) : data_(data), end_(data + size) {}
+
+  uint64_t ReadUInt() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      CHECK(data_ < end_) << "Binary node graph is truncated";
+      uint8_t byte = static_cast<uint8_t>(*data_++);
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) return value;
+    }
+    LOG(FATAL) << "Malformed varint in binary node graph";
+    return 0;
+  }
+  int64_t ReadInt() {
+    uint64_t value = ReadUInt();
+    return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+  }
+  const char* ReadBytes(size_t size) {
+    CHECK_LE(size, static_cast<size_t>(end_ - data_)) << "Binary node graph is truncated";
+    const char* ret = data_;
+    data_ += size;
+    return ret;
+  }
+  std::string ReadString() {
+    size_t size = ReadUInt();
+    return std::string(ReadBytes(size), size);
+  }
+
+ private:
+  const char* data_;
+  const char* end_;
+};
+
+// Indexes and writes the representatives of the nodes of a graph.
+class BinaryWriter : public AttrVisitor {
+ public:
+  explicit BinaryWriter(std::string* out) : strm_(out) {}
+
+  void Visit(const char* key, double* value) final { strm_.WriteBytes(value, sizeof(double)); }
+  void Visit(const char* key, int64_t* value) final { strm_.WriteInt(*value); }
+  void Visit(const char* key, uint64_t* value) final { strm_.WriteUInt(*value); }
+  void Visit(const char* key, int* value) final { strm_.WriteInt(*value); }
+  void Visit(const char* key, bool* value) final { strm_.WriteUInt(*value); }
+  void Visit(const char* key, std::string* value) final { strm_.WriteString(*value); }
+  void Visit(const char* key, void** value) final {
+    LOG(FATAL) << "not allowed to serialize a pointer";
+  }
+  void Visit(const char* key, DataType* value) final {
+    strm_.WriteUInt(value->code());
+    strm_.WriteUInt(value->bits());
+    strm_.WriteUInt(value->lanes());
+  }
+  void Visit(const char* key, runtime::NDArray* value) final {
+    strm_.WriteUInt(tensor_index_.at(const_cast<DLTensor*>((*value).operator->())));
+  }
+  void Visit(const char* key, ObjectRef* value) final {
+    strm_.WriteUInt(node_index_.at(merger_.Merge(value->get())));
+  }
+
+  void Write(const ObjectRef& root) {
+    merger_.PinMapKeys(root.get());
+    Object* mroot = merger_.Merge(root.get());
+    Index(mroot);
+
+    strm_.WriteUInt(kTVMBinaryNodeMagic);
+    strm_.WriteUInt(0);
+    strm_.WriteString(TVM_VERSION);
+
+    std::unordered_map<uint32_t, size_t> type_index;
+    std::vector<size_t> node_types;
+    std::vector<std::string> type_keys;
+    for (size_t i = 1; i < node_list_.size(); ++i) {
+      uint32_t tindex = node_list_[i]->type_index();
+      auto it = type_index.insert({tindex, type_keys.size()}).first;
+      if (it->second == type_keys.size()) type_keys.push_back(node_list_[i]->GetTypeKey());
+      node_types.push_back(it->second);
+    }
+    strm_.WriteUInt(type_keys.size());
+    for (const auto& type_key : type_keys) strm_.WriteString(type_key);
+
+    strm_.WriteUInt(node_list_.size());
+    strm_.WriteUInt(node_index_.at(mroot));
+    for (size_t i = 1; i < node_list_.size(); ++i) {
+      strm_.WriteUInt(node_types[i - 1]);
+      strm_.WriteString(reflection_->GetGlobalKey(node_list_[i]));
+    }
+
+    strm_.WriteUInt(tensor_list_.size());
+    for (DLTensor* tensor : tensor_list_) {
+      std::string blob;
+      dmlc::MemoryStringStream mstrm(&blob);
+      runtime::SaveDLTensor(&mstrm, tensor);
+      strm_.WriteString(blob);
+    }
+
+    for (size_t i = 1; i < node_list_.size(); ++i) {
+      Object* node = node_list_[i];
+      // No need to write the fields of global singletons, they are
+      // registered via the environment.
+      if (reflection_->GetGlobalKey(node).length() != 0) continue;
+      WriteFields(node);
+    }
+  }
+
+ private:
+  // The entries of a map, in a stable order.
+  const std::vector<std::pair<Object*, Object*> >& MapEntries(const MapNode* n) {
+    auto it = map_entries_.find(n);
+    if (it != map_entries_.end()) return it->second;
+    std::vector<std::tuple<uint64_t, uint64_t, Object*, Object*> > hashed;
+    for (const auto& kv : n->data) {
+      Object* k = merger_.Merge(kv.first.get());
+      Object* v = merger_.Merge(kv.second.get());
+      hashed.emplace_back(hasher_.Hash(k), hasher_.Hash(v), k, v);
+    }
+    std::stable_sort(hashed.begin(), hashed.end(), [](const auto& a, const auto& b) {
+      return std::make_pair(std::get<0>(a), std::get<1>(a)) <
+             std::make_pair(std::get<0>(b), std::get<1>(b));
+    });
+    std::vector<std::pair<Object*, Object*> >& entries = map_entries_[n];
+    for (const auto& e : hashed) entries.emplace_back(std::get<2>(e), std::get<3>(e));
+    return entries;
+  }
+
+  // Index node and the nodes it refers to, through their
+  // representatives.
+  void Index(Object* node) {
+    if (node == nullptr || node_index_.count(node)) return;
+    node_index_[node] = node_list_.size();
+    node_list_.push_back(node);
+    if (reflection_->GetGlobalKey(node).length() != 0) return;
+
+    if (node->IsInstance<ArrayNode>()) {
+      for (const auto& elem : static_cast<ArrayNode*>(node)->data) {
+        Index(merger_.Merge(elem.get()));
+      }
+    } else if (node->IsInstance<MapNode>()) {
+      for (const auto& kv : MapEntries(static_cast<MapNode*>(node))) {
+        Index(kv.first);
+        Index(kv.second);
+      }
+    } else if (node->IsInstance<StrMapNode>()) {
+      std::map<std::string, ObjectRef> entries(static_cast<StrMapNode*>(node)->data.begin(),
+                                               static_cast<StrMapNode*>(node)->data.end());
+      for (const auto& kv : entries) Index(merger_.Merge(kv.second.get()));
+    } else {
+      reflection_->VisitAttrs(node, &indexer_);
+    }
+  }
+
+  void WriteFields(Object* node) {
+    if (node->IsInstance<ArrayNode>()) {
+      ArrayNode* n = static_cast<ArrayNode*>(node);
+      strm_.WriteUInt(n->data.size());
+      for (const auto& elem : n->data) {
+        strm_.WriteUInt(node_index_.at(merger_.Merge(elem.get())));
+      }
+    } else if (node->IsInstance<MapNode>()) {
+      const auto& entries = MapEntries(static_cast<MapNode*>(node));
+      strm_.WriteUInt(entries.size());
+      for (const auto& kv : entries) {
+        strm_.WriteUInt(node_index_.at(kv.first));
+        strm_.WriteUInt(node_index_.at(kv.second));
+      }
+    } else if (node->IsInstance<StrMapNode>()) {
+      std::map<std::string, ObjectRef> entries(static_cast<StrMapNode*>(node)->data.begin(),
+                                               static_cast<StrMapNode*>(node)->data.end());
+      strm_.WriteUInt(entries.size());
+      for (const auto& kv : entries) {
+        strm_.WriteString(kv.first);
+        strm_.WriteUInt(node_index_.at(merger_.Merge(kv.second.get())));
+      }
+    } else {
+      reflection_->VisitAttrs(node, this);
+    }
+  }
+
+  // Indexes the nodes and tensors the fields of a node refer to.
+  class FieldIndexer : public AttrVisitor {
+   public:
+    explicit FieldIndexer(BinaryWriter* writer) : writer_(writer) {}
+
+    void Visit(const char* key, double* value) final {}
+    void Visit(const char* key, int64_t* value) final {}
+    void Visit(const char* key, uint64_t* value) final {}
+    void Visit(const char* key, int* value) final {}
+    void Visit(const char* key, bool* value) final {}
+    void Visit(const char* key, std::string* value) final {}
+    void Visit(const char* key, void** value) final {}
+    void Visit(const char* key, DataType* value) final {}
+    void Visit(const char* key, runtime::NDArray* value) final {
+      DLTensor* ptr = const_cast<DLTensor*>((*value).operator->());
+      if (writer_->tensor_index_.count(ptr)) return;
+      writer_->tensor_index_[ptr] = writer_->tensor_list_.size();
+      writer_->tensor_list_.push_back(ptr);
+    }
+    void Visit(const char* key, ObjectRef* value) final {
+      writer_->Index(writer_->merger_.Merge(value->get()));
+    }
+
+   private:
+    BinaryWriter* writer_;
+  };
+
+  BinaryOutStream strm_;
+  NodeMerger merger_;
+  StructuralHasher hasher_;
+  FieldIndexer indexer_{this};
+  std::unordered_map<Object*, size_t> node_index_{{nullptr, 0}};
+  std::vector<Object*> node_list_{nullptr};
+  std::unordered_map<DLTensor*, size_t> tensor_index_;
+  std::vector<DLTensor*> tensor_list_;
+  std::unordered_map<const MapNode*, std::vector<std::pair<Object*, Object*> > > map_entries_;
+  ReflectionVTable* reflection_ = ReflectionVTable::Global();
+};
+
+// Sets the fields of the nodes of a graph read in.
+class BinaryAttrSetter : public AttrVisitor {
+ public:
+  BinaryAttrSetter(BinaryInStream* strm, const std::vector<ObjectPtr<Object> >* node_list,
+                   const std::vector<runtime::NDArray>* tensor_list)
+      : strm_(strm), node_list_(node_list), tensor_list_(tensor_list) {}
+
+  void Visit(const char* key, double* value) final {
+    std::memcpy(value, strm_->ReadBytes(sizeof(double)), sizeof(double));
+  }
+  void Visit(const char* key, int64_t* value) final { *value = strm_->ReadInt(); }
+  void Visit(const char* key, uint64_t* value) final { *value = strm_->ReadUInt(); }
+  void Visit(const char* key, int* value) final { *value = static_cast<int>(strm_->ReadInt()); }
+  void Visit(const char* key, bool* value) final { *value = strm_->ReadUInt() != 0; }
+  void Visit(const char* key, std::string* value) final { *value = strm_->ReadString(); }
+  void Visit(const char* key, void** value) final {
+    LOG(FATAL) << "not allowed to deserialize a pointer";
+  }
+  void Visit(const char* key, DataType* value) final {
+    int code = static_cast<int>(strm_->ReadUInt());
+    int bits = static_cast<int>(strm_->ReadUInt());
+    int lanes = static_cast<int>(strm_->ReadUInt());
+    *value = DataType(code, bits, lanes);
+  }
+  void Visit(const char* key, runtime::NDArray* value) final {
+    *value = tensor_list_->at(strm_->ReadUInt());
+  }
+  void Visit(const char* key, ObjectRef* value) final { *value = ObjectRef(ReadNode()); }
+
+  void Set(Object* node) {
+    if (node->IsInstance<ArrayNode>()) {
+      ArrayNode* n = static_cast<ArrayNode*>(node);
+      n->data.clear();
+      size_t size = strm_->ReadUInt();
+      for (size_t i = 0; i < size; ++i) {
+        n->data.push_back(ObjectRef(ReadNode()));
+      }
+    } else if (node->IsInstance<MapNode>()) {
+      MapNode* n = static_cast<MapNode*>(node);
+      size_t size = strm_->ReadUInt();
+      for (size_t i = 0; i < size; ++i) {
+        ObjectRef k(ReadNode());
+        n->data[k] = ObjectRef(ReadNode());
+      }
+    } else if (node->IsInstance<StrMapNode>()) {
+      StrMapNode* n = static_cast<StrMapNode*>(node);
+      size_t size = strm_->ReadUInt();
+      for (size_t i = 0; i < size; ++i) {
+        std::string k = strm_->ReadString();
+        n->data[k] = ObjectRef(ReadNode());
+      }
+    } else {
+      reflection_->VisitAttrs(node, this);
+    }
+  }
+
+ private:
+  ObjectPtr<Object> ReadNode() { return node_list_->at(strm_->ReadUInt()); }
+
+  BinaryInStream* strm_;
+  const std::vector<ObjectPtr<Object> >* node_list_;
+  const std::vector<runtime::NDArray>* tensor_list_;
+  ReflectionVTable* reflection_ = ReflectionVTable::Global();
+};
+
+std::string SaveBinary(const ObjectRef& n) {
+  std::string out;
+  BinaryWriter(&out).Write(n);
+  return out;
+}
+
+ObjectRef LoadBinary(const std::string& data) {
+  BinaryInStream strm(data.data(), data.size());
+  CHECK_EQ(strm.ReadUInt(), kTVMBinaryNodeMagic) << "Not a binary node graph";
+  strm.ReadUInt();
+  strm.ReadString();
+
+  std::vector<std::string> type_keys(strm.ReadUInt());
+  for (auto& type_key : type_keys) type_key = strm.ReadString();
+
+  ReflectionVTable* reflection = ReflectionVTable::Global();
+  size_t num_nodes = strm.ReadUInt();
+  size_t root = strm.ReadUInt();
+  CHECK_LT(root, num_nodes);
+  // node 0 is always null
+  std::vector<ObjectPtr<Object> > nodes(1);
+  std::vector<bool> is_global(1, false);
+  nodes.reserve(num_nodes);
+  for (size_t i = 1; i < num_nodes; ++i) {
+    const std::string& type_key = type_keys.at(strm.ReadUInt());
+    std::string global_key = strm.ReadString();
+    nodes.emplace_back(reflection->CreateInitObject(type_key, global_key));
+    is_global.push_back(global_key.length() != 0);
+  }
+
+  std::vector<runtime::NDArray> tensors(strm.ReadUInt());
+  for (auto& tensor : tensors) {
+    size_t size = strm.ReadUInt();
+    dmlc::MemoryFixedSizeStream mstrm(const_cast<char*>(strm.ReadBytes(size)), size);
+    CHECK(tensor.Load(&mstrm));
+  }
+
+  BinaryAttrSetter setter(&strm, &nodes, &tensors);
+  for (size_t i = 1; i < num_nodes; ++i) {
+    if (!is_global[i]) setter.Set(nodes[i].get());
+  }
+  return ObjectRef(nodes[root]);
+}
+
 TVM_REGISTER_GLOBAL("node.SaveJSON")
 .set_body_typed(SaveJSON);
 
 TVM_REGISTER_GLOBAL("node.LoadJSON")
 .set_body_typed(LoadJSON);
+
+TVM_REGISTER_GLOBAL("node.SaveBinary")
+.set_body([](TVMArgs args, TVMRetValue* rv) {
+  std::string data = SaveBinary(args[0]);
+  TVMByteArray arr;
+  arr.data = data.data();
+  arr.size = data.size();
+  *rv = arr;
+});
+
+TVM_REGISTER_GLOBAL("node.LoadBinary")
+.set_body_typed(LoadBinary);
+
+TVM_REGISTER_GLOBAL("node.StructuralHash")
+.set_body_typed([](ObjectRef node) {
+  return static_cast<int64_t>(StructuralHash(node));
+});
 }  // namespace tvm
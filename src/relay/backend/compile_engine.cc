@@ -38,6 +38,7 @@
 #include <utility>
 #include <limits>
 #include <mutex>
+#include <string>
 #include <functional>
 #include <vector>
 #include <unordered_map>
@@ -81,7 +82,7 @@ bool IsDynamic(const Type& ty) {
 TVM_REGISTER_GLOBAL("relay._make.IsDynamic")
 .set_body_typed(IsDynamic);
 
-Array<IndexExpr> GetShape(const Array<IndexExpr>& shape) {
+Array<IndexExpr> GetShape(const Array<IndexExpr>& shape, int64_t dyn_granule = 1) {
   // for now, we always use int32 shape when possible
   // even if the result of shape inference becomes int64.
   Array<IndexExpr> res;
@@ -92,7 +93,14 @@ Array<IndexExpr> GetShape(const Array<IndexExpr>& shape) {
       CHECK_GE(pval[0], std::numeric_limits<int32_t>::min());
       res.push_back(IntImm(DataType::Int(32), *pval));
     } else if (val->IsInstance<tir::AnyNode>()) {
-      res.push_back(val.as<tir::AnyNode>()->ToVar());
+      // In a kernel specialized for dynamic dimensions that are multiples
+      // of dyn_granule, the dimension is declared as such.
+      tir::Var var = val.as<tir::AnyNode>()->ToVar();
+      if (dyn_granule > 1) {
+        res.push_back(var * IntImm(DataType::Int(32), dyn_granule));
+      } else {
+        res.push_back(var);
+      }
     } else {
       res.push_back(val);
     }
@@ -105,8 +113,8 @@ Array<IndexExpr> GetShape(const Array<IndexExpr>& shape) {
 class ScheduleGetter :
       public ExprFunctor<Array<te::Tensor>(const Expr&)> {
  public:
-  explicit ScheduleGetter(Target target)
-      : target_(target), device_copy_op_(Op::Get("device_copy")) {}
+  explicit ScheduleGetter(Target target, int64_t dyn_granule = 1)
+      : target_(target), dyn_granule_(dyn_granule), device_copy_op_(Op::Get("device_copy")) {}
 
   std::pair<te::Schedule, CachedFunc> Create(const Function& prim_func) {
     static auto fschedule =
@@ -117,7 +125,7 @@ class ScheduleGetter :
       Array<tvm::te::Tensor> inputs;
       if (const auto* ttype = param->checked_type().as<TensorTypeNode>()) {
         tvm::te::Tensor tensor = tvm::te::placeholder(
-            GetShape(ttype->shape), ttype->dtype);
+            GetShape(ttype->shape, dyn_granule_), ttype->dtype);
         cache_node->inputs.push_back(tensor);
         inputs.push_back(tensor);
       } else {
@@ -128,7 +136,7 @@ class ScheduleGetter :
           // TODO(@icemelon): Allow recursive tuple
           CHECK(ttype != nullptr);
           tvm::te::Tensor tensor = tvm::te::placeholder(
-              GetShape(ttype->shape), ttype->dtype);
+              GetShape(ttype->shape, dyn_granule_), ttype->dtype);
           cache_node->inputs.push_back(tensor);
           inputs.push_back(tensor);
         }
@@ -239,12 +247,12 @@ class ScheduleGetter :
     // TODO(@icemelon): Support recursive tuple
     Type call_node_type = call_node->checked_type();
     if (const auto* tt = call_node->checked_type().as<TensorTypeNode>()) {
-      call_node_type = TensorType(GetShape(tt->shape), tt->dtype);
+      call_node_type = TensorType(GetShape(tt->shape, dyn_granule_), tt->dtype);
     } else if (const auto* tuple_t = call_node->checked_type().as<TupleTypeNode>()) {
       std::vector<Type> new_fields;
       for (auto field : tuple_t->fields) {
         if (const auto* tt = field.as<TensorTypeNode>()) {
-          new_fields.push_back(TensorType(GetShape(tt->shape), tt->dtype));
+          new_fields.push_back(TensorType(GetShape(tt->shape, dyn_granule_), tt->dtype));
         } else {
           new_fields.push_back(field);
         }
@@ -329,6 +337,7 @@ class ScheduleGetter :
 
  private:
   tvm::Target target_;
+  int64_t dyn_granule_;
   Op master_op_;
   Attrs master_attrs_;
   int master_op_pattern_{0};
@@ -600,17 +609,23 @@ class CompileEngineImpl : public CompileEngineNode {
 
   // For now, build one module per function.
   PackedFunc JIT(const CCacheKey& key) final {
-    CCacheValue value = LowerInternal(key);
-    if (value->packed_func != nullptr) return value->packed_func;
-    // build the function.
-    tvm::runtime::Module m;
-    if (const auto* f = runtime::Registry::Get("relay.backend.build")) {
-      m = (*f)(value->cached_func->funcs, key->target);
-    } else {
-      m = build(value->cached_func->funcs, key->target, Target(nullptr), BuildConfig::Current());
+    if (max_dyn_granule_ > 1 && key->source_func->UseDefaultCompiler() &&
+        IsDynamic(key->source_func->checked_type())) {
+      return BucketedJIT(key);
     }
-    value->packed_func = m.GetFunction(value->cached_func->func_name);
-    return value->packed_func;
+    return JITInternal(key, 1);
+  }
+
+  /*!
+   * \brief Enable shape bucketing of dynamic functions in JIT.
+   * \param max_granule The largest granule to specialize for, a power of
+   *  two. 1 disables bucketing.
+   */
+  void SetShapeBuckets(int64_t max_granule) {
+    CHECK(max_granule >= 1 && (max_granule & (max_granule - 1)) == 0)
+        << "The shape bucket granule must be a power of two, got " << max_granule;
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_dyn_granule_ = max_granule;
   }
 
   CachedFunc LowerShapeFunc(const CCacheKey& key) final {
@@ -659,6 +674,7 @@ class CompileEngineImpl : public CompileEngineNode {
 
   void Clear() final {
     cache_.clear();
+    bucket_cache_.clear();
   }
   // List all items in the cache.
   Array<ObjectRef> ListItems() {
@@ -678,24 +694,86 @@ class CompileEngineImpl : public CompileEngineNode {
    *  The funcs field in cache is not yet populated.
    */
   std::pair<te::Schedule, CachedFunc> CreateSchedule(
-      const Function& source_func, const Target& target) {
-    return ScheduleGetter(target).Create(source_func);
+      const Function& source_func, const Target& target, int64_t dyn_granule = 1) {
+    return ScheduleGetter(target, dyn_granule).Create(source_func);
   }
 
  private:
+  // Build the function, specialized for dynamic dimensions that are
+  // multiples of dyn_granule.
+  PackedFunc JITInternal(const CCacheKey& key, int64_t dyn_granule) {
+    CCacheValue value = LowerInternal(key, dyn_granule);
+    if (value->packed_func != nullptr) return value->packed_func;
+    // build the function.
+    tvm::runtime::Module m;
+    if (const auto* f = runtime::Registry::Get("relay.backend.build")) {
+      m = (*f)(value->cached_func->funcs, key->target);
+    } else {
+      m = build(value->cached_func->funcs, key->target, Target(nullptr), BuildConfig::Current());
+    }
+    value->packed_func = m.GetFunction(value->cached_func->func_name);
+    return value->packed_func;
+  }
+  /*!
+   * \brief Get a function dispatching on the dynamic dimensions of its
+   *  arguments. Calls run the kernel specialized for the largest power of
+   *  two granule, up to max_dyn_granule_, that divides all of them, and
+   *  compile it on first use. The granules bound the number of kernels
+   *  per function, while each kernel knows its extents are multiples of
+   *  the granule and drops the tail guards.
+   */
+  PackedFunc BucketedJIT(const CCacheKey& key) {
+    // The (argument, dimension) pairs that are dynamic, over the flattened
+    // inputs and then the outputs.
+    std::vector<std::pair<int, int>> dyn_dims;
+    int index = 0;
+    auto collect = [&dyn_dims, &index](const Type& type) {
+      std::vector<Type> fields;
+      if (const auto* tuple_type = type.as<TupleTypeNode>()) {
+        for (const Type& field : tuple_type->fields) {
+          fields.push_back(field);
+        }
+      } else {
+        fields.push_back(type);
+      }
+      for (const Type& field : fields) {
+        const auto* ttype = field.as<TensorTypeNode>();
+        CHECK(ttype != nullptr);
+        for (size_t i = 0; i < ttype->shape.size(); ++i) {
+          if (ttype->shape[i].as<Any>()) dyn_dims.emplace_back(index, static_cast<int>(i));
+        }
+        ++index;
+      }
+    };
+    for (Var param : key->source_func->params) collect(param->checked_type());
+    collect(key->source_func->body->checked_type());
+
+    int64_t max_granule = max_dyn_granule_;
+    ObjectRef self_ref = GetRef<ObjectRef>(this);
+    return PackedFunc([this, self_ref, key, dyn_dims, max_granule](TVMArgs args,
+                                                                     TVMRetValue* rv) {
+      int64_t granule = max_granule;
+      for (const auto& dim : dyn_dims) {
+        DLTensor* arr = args[dim.first];
+        while (granule > 1 && arr->shape[dim.second] % granule != 0) granule /= 2;
+      }
+      this->JITInternal(key, granule).CallPacked(args, rv);
+    });
+  }
   // implement lowered func
-  CCacheValue LowerInternal(const CCacheKey& key)  {
+  CCacheValue LowerInternal(const CCacheKey& key, int64_t dyn_granule = 1)  {
     std::lock_guard<std::mutex> lock(mutex_);
+    auto& cache = dyn_granule == 1 ? cache_ : bucket_cache_[dyn_granule];
     CCacheValue value;
-    auto it = cache_.find(key);
-    if (it != cache_.end()) {
+    auto it = cache.find(key);
+    if (it != cache.end()) {
       it->second->use_count += 1;
       if (it->second->cached_func.defined()) return it->second;
       value = it->second;
     } else {
       value = CCacheValue(make_object<CCacheValueNode>());
       value->use_count = 0;
-      cache_[key] = value;
+      cache[key] = value;
     }
     // No need to lower external functions for now. We will invoke the external
     // codegen tool once and lower all functions together.
@@ -713,7 +791,7 @@ class CompileEngineImpl : public CompileEngineNode {
     With<Target> target_scope(key->target);
 
     CHECK(!value->cached_func.defined());
-    auto spair = CreateSchedule(key->source_func, key->target);
+    auto spair = CreateSchedule(key->source_func, key->target, dyn_granule);
     auto cache_node = make_object<CachedFuncNode>(
         *(spair.second.operator->()));
 
@@ -726,6 +804,9 @@ class CompileEngineImpl : public CompileEngineNode {
       }
     }
 
+    if (dyn_granule > 1) {
+      cache_node->func_name += "_x" + std::to_string(dyn_granule);
+    }
     cache_node->func_name = GetUniqueName(cache_node->func_name);
     // NOTE: array will copy on write.
     Array<te::Tensor> all_args = cache_node->inputs;
@@ -809,6 +890,10 @@ class CompileEngineImpl : public CompileEngineNode {
   std::unordered_map<CCacheKey, CCacheValue> cache_;
   /*! \brief internal compiler cache for shape funcs */
   std::unordered_map<CCacheKey, CCacheValue> shape_func_cache_;
+  /*! \brief internal compiler cache of the kernels specialized per granule */
+  std::unordered_map<int64_t, std::unordered_map<CCacheKey, CCacheValue> > bucket_cache_;
+  /*! \brief largest granule JIT specializes dynamic functions for */
+  int64_t max_dyn_granule_{1};
 };
 
 /*! \brief The global compile engine */
@@ -856,6 +941,12 @@ TVM_REGISTER_GLOBAL("relay.backend._CompileEngineJIT")
   return self->JIT(key);
 });
 
+TVM_REGISTER_GLOBAL("relay.backend._CompileEngineSetShapeBuckets")
+.set_body_typed(
+    [](CompileEngine self, int64_t max_granule) {
+  static_cast<CompileEngineImpl*>(self.operator->())->SetShapeBuckets(max_granule);
+});
+
 TVM_REGISTER_GLOBAL("relay.backend._CompileEngineListItems")
 .set_body_typed(
     [](CompileEngine self){
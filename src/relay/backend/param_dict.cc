@@ -25,10 +25,12 @@
 #include <tvm/runtime/registry.h>
 #include <dmlc/memory_io.h>
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <utility>
 
+#include "../../runtime/mapped_file.h"
 #include "param_dict.h"
 
 
@@ -38,37 +40,53 @@ namespace relay {
 
 using namespace runtime;
 
+// Save the name, array pairs of args starting at begin, aligning the
+// data of the arrays if alignment is above 1.
+static TVMByteArray SaveParamDict(TVMArgs args, int begin, size_t alignment, std::string* bytes) {
+  CHECK_EQ((args.size() - begin) % 2, 0);
+  // `args` is in the form "key, value, key, value, ..."
+  size_t num_params = (args.size() - begin) / 2;
+  std::vector<std::string> names;
+  names.reserve(num_params);
+  std::vector<DLTensor*> arrays;
+  arrays.reserve(num_params);
+  for (size_t i = begin; i < begin + num_params * 2; i += 2) {
+    names.emplace_back(args[i].operator std::string());
+    arrays.emplace_back(args[i + 1].operator DLTensor*());
+  }
+  dmlc::MemoryStringStream strm(bytes);
+  dmlc::SeekStream* fo = &strm;
+  uint64_t header = kTVMNDArrayListMagic, reserved = 0;
+  fo->Write(header);
+  fo->Write(reserved);
+  fo->Write(names);
+  {
+    uint64_t sz = static_cast<uint64_t>(arrays.size());
+    fo->Write(sz);
+    for (size_t i = 0; i < sz; ++i) {
+      tvm::runtime::SaveDLTensor(fo, arrays[i],
+                                 DLTensorDataPadding(fo->Tell(), arrays[i], alignment));
+    }
+  }
+  TVMByteArray arr;
+  arr.data = bytes->c_str();
+  arr.size = bytes->length();
+  return arr;
+}
+
 TVM_REGISTER_GLOBAL("tvm.relay._save_param_dict")
 .set_body([](TVMArgs args, TVMRetValue *rv) {
-    CHECK_EQ(args.size() % 2, 0u);
-    // `args` is in the form "key, value, key, value, ..."
-    size_t num_params = args.size() / 2;
-    std::vector<std::string> names;
-    names.reserve(num_params);
-    std::vector<DLTensor*> arrays;
-    arrays.reserve(num_params);
-    for (size_t i = 0; i < num_params * 2; i += 2) {
-      names.emplace_back(args[i].operator std::string());
-      arrays.emplace_back(args[i + 1].operator DLTensor*());
-    }
     std::string bytes;
-    dmlc::MemoryStringStream strm(&bytes);
-    dmlc::Stream* fo = &strm;
-    uint64_t header = kTVMNDArrayListMagic, reserved = 0;
-    fo->Write(header);
-    fo->Write(reserved);
-    fo->Write(names);
-    {
-      uint64_t sz = static_cast<uint64_t>(arrays.size());
-      fo->Write(sz);
-      for (size_t i = 0; i < sz; ++i) {
-        tvm::runtime::SaveDLTensor(fo, arrays[i]);
-      }
-    }
-    TVMByteArray arr;
-    arr.data = bytes.c_str();
-    arr.size = bytes.length();
-    *rv = arr;
+    *rv = SaveParamDict(args, 0, 0, &bytes);
+  });
+
+TVM_REGISTER_GLOBAL("tvm.relay._save_param_dict_aligned")
+.set_body([](TVMArgs args, TVMRetValue *rv) {
+    // `args` is in the form "alignment, key, value, key, value, ..."
+    int64_t alignment = args[0];
+    CHECK_GT(alignment, 0);
+    std::string bytes;
+    *rv = SaveParamDict(args, 1, static_cast<size_t>(alignment), &bytes);
   });
 
 TVM_REGISTER_GLOBAL("tvm.relay._load_param_dict")
@@ -103,6 +121,36 @@ TVM_REGISTER_GLOBAL("tvm.relay._load_param_dict")
     *rv = ret;
   });
 
+TVM_REGISTER_GLOBAL("tvm.relay._load_param_dict_from_file")
+.set_body([](TVMArgs args, TVMRetValue *rv) {
+    std::string file_name = args[0];
+    std::shared_ptr<MappedFile> file = MappedFile::Open(file_name);
+    std::unique_ptr<dmlc::SeekStream> strm = file->Stream();
+    uint64_t header, reserved;
+    CHECK(strm->Read(&header))
+        << "Invalid parameters file format";
+    CHECK(header == kTVMNDArrayListMagic)
+        << "Invalid parameters file format";
+    CHECK(strm->Read(&reserved))
+        << "Invalid parameters file format";
+    std::vector<std::string> names;
+    CHECK(strm->Read(&names))
+        << "Invalid parameters file format";
+    uint64_t sz;
+    strm->Read(&sz, sizeof(sz));
+    size_t size = static_cast<size_t>(sz);
+    CHECK(size == names.size())
+        << "Invalid parameters file format";
+    tvm::Array<NamedNDArray> ret;
+    for (size_t i = 0; i < size; ++i) {
+      auto n = tvm::make_object<NamedNDArrayNode>();
+      n->name = std::move(names[i]);
+      n->array = LoadMappedNDArray(strm.get(), file);
+      ret.push_back(NamedNDArray(n));
+    }
+    *rv = ret;
+  });
+
 TVM_REGISTER_NODE_TYPE(NamedNDArrayNode);
 
 }  // namespace relay
@@ -282,6 +282,7 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
       case Opcode::Invoke:
       case Opcode::AllocClosure:
       case Opcode::AllocStorage:
+      case Opcode::AllocRaggedTensor:
       case Opcode::Move:
       case Opcode::InvokeClosure:
         last_register_ = instr.dst;
@@ -562,6 +563,25 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
               dtype,
               NewRegister()));
           }
+      }).Match("memory.alloc_ragged_tensor",
+        [this](const Array<Expr>& args, const Attrs& attrs, const Array<Type>& type_arg) {
+          CHECK_EQ(args.size(), 2);
+
+          auto alloc_attrs = attrs.as<AllocTensorAttrs>();
+          CHECK(alloc_attrs != nullptr)
+              << "must be the alloc tensor attrs";
+          auto dtype = alloc_attrs->dtype;
+
+          // The ragged tensor owns its storage, sized at run time by the
+          // sum of the row lengths.
+          this->VisitExpr(args[0]);
+          auto shape_register = last_register_;
+
+          this->VisitExpr(args[1]);
+          auto lengths_register = last_register_;
+
+          Emit(Instruction::AllocRaggedTensor(shape_register, lengths_register, dtype,
+                                              NewRegister()));
       }).Match("memory.alloc_storage",
         [this](const Array<Expr>& args, const Attrs& attrs, const Array<Type>& type_arg) {
           CHECK_EQ(args.size(), 2);
@@ -183,6 +183,75 @@ RELAY_REGISTER_OP("memory.alloc_tensor")
                              return {topi::identity(inputs[0])};
                            });
 
+TVM_REGISTER_GLOBAL("relay.op.memory._make.alloc_ragged_tensor")
+    .set_body_typed(
+        [](Expr shape, Expr lengths, DataType dtype, Array<IndexExpr> assert_shape) {
+          auto attrs = make_object<AllocTensorAttrs>();
+          attrs->dtype = dtype;
+          if (assert_shape.defined()) {
+            attrs->assert_shape = assert_shape;
+          } else {
+            attrs->const_shape = Downcast<Constant>(shape);
+          }
+          static const Op& op = Op::Get("memory.alloc_ragged_tensor");
+          return CallNode::make(op, {shape, lengths}, Attrs(attrs), {});
+        });
+
+bool AllocRaggedTensorRel(const Array<Type>& types, int num_inputs, const Attrs& attrs,
+                          const TypeReporter& reporter) {
+  CHECK_EQ(types.size(), 3u);
+  auto alloc_attrs = attrs.as<AllocTensorAttrs>();
+  CHECK(alloc_attrs != nullptr) << "must be alloc_tensor attributes";
+  // The first argument is the dense shape, the second the row lengths.
+  auto tt = types[0].as<TensorTypeNode>();
+  CHECK(tt != nullptr) << "must be tensor type";
+  auto rank = tt->shape[0].as<tvm::IntImmNode>();
+  CHECK(rank != nullptr);
+  CHECK_GE(rank->value, 2) << "a ragged tensor needs a row and a length axis";
+  auto lt = types[1].as<TensorTypeNode>();
+  if (lt == nullptr) return false;
+  CHECK_EQ(lt->shape.size(), 1U) << "the row lengths must be 1-D";
+  CHECK_EQ(lt->dtype, DataType::Int(32)) << "the row lengths must be int32";
+
+  // The ragged tensor is typed by its dense shape.
+  Type alloc_type;
+  if (alloc_attrs->const_shape.defined()) {
+    auto sh = FromConstShape(alloc_attrs->const_shape);
+    Array<IndexExpr> out_shape;
+    for (auto i = 0u; i < rank->value; i++) {
+      out_shape.push_back(tvm::Integer(sh[i]));
+    }
+    alloc_type = TensorType(out_shape, alloc_attrs->dtype);
+  } else {
+    CHECK(alloc_attrs->assert_shape.defined())
+        << "the assert_shape must be set when const_shape is not";
+    alloc_type = TensorType(alloc_attrs->assert_shape, alloc_attrs->dtype);
+  }
+  reporter->Assign(types[2], alloc_type);
+  return true;
+}
+
+RELAY_REGISTER_OP("memory.alloc_ragged_tensor")
+    .describe(R"code(Explicitly allocate a ragged tensor, packing its rows.
+
+The storage holds the sum of the row lengths rather than the dense shape;
+kernels receive the packed data followed by the int32 row offsets.
+)code" TVM_ADD_FILELINE)
+    .set_num_inputs(2)
+    .add_argument("shape", "Tensor", "The dense shape of the tensor to allocate.")
+    .add_argument("lengths", "Tensor", "The int32 lengths of the rows.")
+    .add_type_rel("AllocRaggedTensor", AllocRaggedTensorRel)
+    .set_support_level(10)
+    .set_attr<TOpPattern>("TOpPattern", kOpaque)
+    .set_attr<TOpIsStateful>("TOpIsStateful", false)
+    .set_attr<TNonComputational>("TNonComputational", true)
+    .set_attr<FInferCorrectLayout>("FInferCorrectLayout", ElemwiseArbitraryLayout)
+    .set_attr<FTVMCompute>("FTVMCompute",
+                           [](const Attrs& attrs, const Array<te::Tensor>& inputs,
+                              const Type& out_dtype, const Target& target) -> Array<te::Tensor> {
+                             return {topi::identity(inputs[0])};
+                           });
+
 bool InvokeTVMOPRel(const Array<Type>& types, int num_inputs, const Attrs& attrs,
                     const TypeReporter& reporter) {
   CHECK_EQ(types.size(), 4u);
@@ -24,6 +24,7 @@
 
 #include <tvm/tir/data_layout.h>
 #include <tvm/relay/op.h>
+#include <tvm/relay/op_attr_types.h>
 #include <tvm/relay/attrs/nn.h>
 #include <tvm/relay/attrs/image.h>
 #include <topi/nn.h>
@@ -359,6 +360,104 @@ RELAY_REGISTER_OP("nn.softmax")
 });
 
 
+// relay.nn.ragged_softmax
+TVM_REGISTER_NODE_TYPE(RaggedSoftmaxAttrs);
+
+// Check the iteration mode of a ragged op.
+static void CheckRaggedMode(const std::string& op_name, const std::string& mode, int tile) {
+  CHECK(mode == "ragged" || mode == "tiled" || mode == "dense")
+      << op_name << ": mode must be one of ragged, tiled or dense, got " << mode;
+  CHECK_GE(tile, 1) << op_name << ": tile must be positive, got " << tile;
+}
+
+/*
+ * The axes of a ragged op refer to the layout it was created in. Its
+ * inputs are brought back to that layout, and its output keeps it, so
+ * that a layout chosen for the ops around it ends at its inputs.
+ */
+Array<Array<Layout> > RaggedInferCorrectLayout(const Attrs& attrs,
+                                               const Array<Layout>& new_in_layouts,
+                                               const Array<Layout>& old_in_layouts,
+                                               const Array<Array<IndexExpr>>& old_in_shapes) {
+  CHECK_GE(old_in_layouts.size(), 1);
+  return Array<Array<Layout> >{old_in_layouts, {old_in_layouts[0]}};
+}
+
+bool RaggedSoftmaxRel(const Array<Type>& types,
+                      int num_inputs,
+                      const Attrs& attrs,
+                      const TypeReporter& reporter) {
+  CHECK_EQ(types.size(), 3);
+  const auto* data = types[0].as<TensorTypeNode>();
+  const auto* lengths = types[1].as<TensorTypeNode>();
+  if (data == nullptr || lengths == nullptr) return false;
+  const auto* param = attrs.as<RaggedSoftmaxAttrs>();
+  CHECK(param != nullptr);
+  int ndim = static_cast<int>(data->shape.size());
+  int axis = param->axis < 0 ? param->axis + ndim : param->axis;
+  int batch_axis = param->batch_axis < 0 ? param->batch_axis + ndim : param->batch_axis;
+  CHECK(axis >= 0 && axis < ndim && batch_axis >= 0 && batch_axis < ndim && axis != batch_axis)
+      << "ragged_softmax: invalid axis " << param->axis << " or batch_axis "
+      << param->batch_axis << " for data of rank " << ndim;
+  CHECK_EQ(lengths->shape.size(), 1) << "ragged_softmax: lengths must be 1-D";
+  CHECK(lengths->dtype == DataType::Int(32)) << "ragged_softmax: lengths must be int32";
+  CheckRaggedMode("ragged_softmax", param->mode, param->tile);
+  reporter->AssertEQ(lengths->shape[0], data->shape[batch_axis]);
+  // Integer inputs, such as quantized scores, produce float32 probabilities.
+  DataType out_dtype = data->dtype.is_float() ? data->dtype : DataType::Float(32);
+  reporter->Assign(types[2], TensorType(data->shape, out_dtype));
+  return true;
+}
+
+Expr MakeRaggedSoftmax(Expr data,
+                       Expr lengths,
+                       int axis,
+                       int batch_axis,
+                       double scale,
+                       std::string mode,
+                       int tile) {
+  auto attrs = make_object<RaggedSoftmaxAttrs>();
+  attrs->axis = axis;
+  attrs->batch_axis = batch_axis;
+  attrs->scale = scale;
+  attrs->mode = std::move(mode);
+  attrs->tile = tile;
+  static const Op& op = Op::Get("nn.ragged_softmax");
+  return CallNode::make(op, {data, lengths}, Attrs(attrs), {});
+}
+
+TVM_REGISTER_GLOBAL("relay.op.nn._make.ragged_softmax")
+.set_body_typed(MakeRaggedSoftmax);
+
+
+RELAY_REGISTER_OP("nn.ragged_softmax")
+    .describe(R"code(Softmax over the valid prefix of a padded axis.
+
+Along ``axis``, only the first lengths[b] elements are valid, where b is
+the index along ``batch_axis``. The result is the softmax of the valid
+elements, and 0 at the padded ones. It is computed with ragged loops that
+skip the padding.
+
+Integer data, such as int8 quantized scores, is dequantized with ``scale``
+after the max of its sequence is subtracted, and produces float32.
+
+``mode`` selects how the kernel iterates the padded axis, see
+RaggedSoftmaxAttrs. It does not change the result, and AlterOpLayout
+picks it from the lengths and the target.
+
+- **data**: The input data
+- **lengths**: The 1-D int32 valid lengths
+)code" TVM_ADD_FILELINE)
+.set_attrs_type<RaggedSoftmaxAttrs>()
+.set_num_inputs(2)
+.add_argument("data", "Tensor", "The input tensor.")
+.add_argument("lengths", "Tensor", "The valid lengths of axis.")
+.set_support_level(10)
+.add_type_rel("RaggedSoftmax", RaggedSoftmaxRel)
+.set_attr<FInferCorrectLayout>("FInferCorrectLayout", RaggedInferCorrectLayout)
+.set_attr<TRaggedOp>("TRaggedOp", true);
+
+
 // relay.nn.log_softmax
 TVM_REGISTER_GLOBAL("relay.op.nn._make.log_softmax")
 .set_body_typed([](Expr data, int axis) {
@@ -858,6 +957,200 @@ RELAY_REGISTER_OP("nn.layer_norm")
 .set_support_level(1)
 .add_type_rel("LayerNorm", LayerNormRel);
 
+// relay.nn.ragged_layer_norm
+bool RaggedLayerNormRel(const Array<Type>& types,
+                        int num_inputs,
+                        const Attrs& attrs,
+                        const TypeReporter& reporter) {
+  CHECK_EQ(types.size(), 5);
+  const auto* data = types[0].as<TensorTypeNode>();
+  const auto* lengths = types[3].as<TensorTypeNode>();
+  if (data == nullptr || lengths == nullptr) return false;
+  const LayerNormAttrs* param = attrs.as<LayerNormAttrs>();
+  CHECK_EQ(data->shape.size(), 3) << "ragged_layer_norm: data must be 3-D";
+  CHECK(param->axis == -1 || param->axis == 2)
+      << "ragged_layer_norm: only the last axis can be normalized, got axis " << param->axis;
+  CHECK_EQ(lengths->shape.size(), 1) << "ragged_layer_norm: lengths must be 1-D";
+  CHECK(lengths->dtype == DataType::Int(32)) << "ragged_layer_norm: lengths must be int32";
+  reporter->AssertEQ(lengths->shape[0], data->shape[0]);
+  reporter->Assign(types[1], TensorType({data->shape[2]}, data->dtype));
+  reporter->Assign(types[2], TensorType({data->shape[2]}, data->dtype));
+  reporter->Assign(types[4], TensorType(data->shape, data->dtype));
+  return true;
+}
+
+Expr MakeRaggedLayerNorm(Expr data, Expr gamma, Expr beta, Expr lengths, int axis,
+                         double epsilon, bool center, bool scale) {
+  auto attrs = make_object<LayerNormAttrs>();
+  attrs->axis = axis;
+  attrs->epsilon = epsilon;
+  attrs->center = center;
+  attrs->scale = scale;
+  static const Op& op = Op::Get("nn.ragged_layer_norm");
+  return CallNode::make(op, {data, gamma, beta, lengths}, Attrs(attrs), {});
+}
+
+TVM_REGISTER_GLOBAL("relay.op.nn._make.ragged_layer_norm")
+.set_body([](const TVMArgs& args, TVMRetValue* rv) {
+    runtime::detail::unpack_call<Expr, 8>(MakeRaggedLayerNorm, args, rv);
+  });
+
+RELAY_REGISTER_OP("nn.ragged_layer_norm")
+.describe(R"code(Layer normalization over the last axis of the valid rows of a
+padded batch of sequences.
+
+Only the first lengths[b] rows of data[b, :, :] are valid. They are
+normalized as by nn.layer_norm over the last axis, and the padded rows of
+the output are 0. The reductions skip the padded rows.
+
+- **data**: `(batch, seq_len, hidden)`
+- **gamma**: `(hidden,)`
+- **beta**: `(hidden,)`
+- **lengths**: `(batch,)`
+)code" TVM_ADD_FILELINE)
+.set_attrs_type<LayerNormAttrs>()
+.set_num_inputs(4)
+.add_argument("data", "Tensor", "Input to which layer_norm will be applied.")
+.add_argument("gamma", "Tensor", "The gamma scale factor.")
+.add_argument("beta", "Tensor", "The beta offset factor.")
+.add_argument("lengths", "Tensor", "The valid rows of each sequence.")
+.set_support_level(10)
+.add_type_rel("RaggedLayerNorm", RaggedLayerNormRel)
+.set_attr<FInferCorrectLayout>("FInferCorrectLayout", RaggedInferCorrectLayout)
+.set_attr<TRaggedOp>("TRaggedOp", true);
+
+
+// relay.nn.ragged_attention
+TVM_REGISTER_NODE_TYPE(RaggedAttentionAttrs);
+
+bool RaggedAttentionRel(const Array<Type>& types,
+                        int num_inputs,
+                        const Attrs& attrs,
+                        const TypeReporter& reporter) {
+  CHECK_EQ(types.size(), 5);
+  const auto* q = types[0].as<TensorTypeNode>();
+  const auto* k = types[1].as<TensorTypeNode>();
+  const auto* v = types[2].as<TensorTypeNode>();
+  const auto* lengths = types[3].as<TensorTypeNode>();
+  if (q == nullptr || k == nullptr || v == nullptr || lengths == nullptr) return false;
+  CHECK(q->shape.size() == 4 && k->shape.size() == 4 && v->shape.size() == 4)
+      << "ragged_attention: q, k and v must be 4-D";
+  for (int i = 0; i < 4; ++i) {
+    CHECK(reporter->AssertEQ(q->shape[i], k->shape[i]))
+        << "ragged_attention: shapes of q and k are inconsistent, "
+        << " q shape=" << q->shape
+        << ", k shape=" << k->shape;
+  }
+  for (int i = 0; i < 3; ++i) {
+    CHECK(reporter->AssertEQ(q->shape[i], v->shape[i]))
+        << "ragged_attention: shapes of q and v are inconsistent, "
+        << " q shape=" << q->shape
+        << ", v shape=" << v->shape;
+  }
+  CHECK_EQ(lengths->shape.size(), 1) << "ragged_attention: lengths must be 1-D";
+  CHECK(lengths->dtype == DataType::Int(32)) << "ragged_attention: lengths must be int32";
+  reporter->AssertEQ(lengths->shape[0], q->shape[0]);
+  Array<IndexExpr> oshape = q->shape;
+  oshape.Set(3, v->shape[3]);
+  reporter->Assign(types[4], TensorType(oshape, q->dtype));
+  return true;
+}
+
+Expr MakeRaggedAttention(Expr q, Expr k, Expr v, Expr lengths, double scale) {
+  auto attrs = make_object<RaggedAttentionAttrs>();
+  attrs->scale = scale;
+  static const Op& op = Op::Get("nn.ragged_attention");
+  return CallNode::make(op, {q, k, v, lengths}, Attrs(attrs), {});
+}
+
+TVM_REGISTER_GLOBAL("relay.op.nn._make.ragged_attention")
+.set_body_typed(MakeRaggedAttention);
+
+RELAY_REGISTER_OP("nn.ragged_attention")
+.describe(R"code(Scaled dot product attention over a padded batch of sequences,
+of which only the first lengths[b] queries and keys are valid.
+
+.. math::
+
+  out[b, h, :l_b, :] = softmax(scale * q[b, h, :l_b, :] k[b, h, :l_b, :]^T) v[b, h, :l_b, :]
+
+The padded queries of the output are 0. Only valid query and key pairs
+are visited.
+
+- **q**: `(batch, heads, seq_len, head_dim)`
+- **k**: `(batch, heads, seq_len, head_dim)`
+- **v**: `(batch, heads, seq_len, value_dim)`
+- **lengths**: `(batch,)`
+- **out**: `(batch, heads, seq_len, value_dim)`
+)code" TVM_ADD_FILELINE)
+.set_attrs_type<RaggedAttentionAttrs>()
+.set_num_inputs(4)
+.add_argument("q", "4D Tensor", "The queries.")
+.add_argument("k", "4D Tensor", "The keys.")
+.add_argument("v", "4D Tensor", "The values.")
+.add_argument("lengths", "1D Tensor", "The valid length of each sequence.")
+.set_support_level(10)
+.add_type_rel("RaggedAttention", RaggedAttentionRel)
+.set_attr<FInferCorrectLayout>("FInferCorrectLayout", RaggedInferCorrectLayout)
+.set_attr<TRaggedOp>("TRaggedOp", true);
+
+// relay.nn.ragged_embedding_bag
+TVM_REGISTER_NODE_TYPE(RaggedEmbeddingBagAttrs);
+
+bool RaggedEmbeddingBagRel(const Array<Type>& types,
+                           int num_inputs,
+                           const Attrs& attrs,
+                           const TypeReporter& reporter) {
+  CHECK_EQ(types.size(), 4);
+  const auto* weight = types[0].as<TensorTypeNode>();
+  const auto* indices = types[1].as<TensorTypeNode>();
+  const auto* offsets = types[2].as<TensorTypeNode>();
+  if (weight == nullptr || indices == nullptr || offsets == nullptr) return false;
+  const auto* param = attrs.as<RaggedEmbeddingBagAttrs>();
+  CHECK(param->mode == "sum" || param->mode == "mean" || param->mode == "max")
+      << "ragged_embedding_bag: mode must be sum, mean or max, got " << param->mode;
+  CHECK_EQ(weight->shape.size(), 2) << "ragged_embedding_bag: weight must be 2-D";
+  CHECK_EQ(indices->shape.size(), 1) << "ragged_embedding_bag: indices must be 1-D";
+  CHECK_EQ(offsets->shape.size(), 1) << "ragged_embedding_bag: offsets must be 1-D";
+  CHECK(indices->dtype == DataType::Int(32) && offsets->dtype == DataType::Int(32))
+      << "ragged_embedding_bag: indices and offsets must be int32";
+  Array<IndexExpr> oshape({offsets->shape[0] - 1, weight->shape[1]});
+  reporter->Assign(types[3], TensorType(oshape, weight->dtype));
+  return true;
+}
+
+Expr MakeRaggedEmbeddingBag(Expr weight, Expr indices, Expr offsets, std::string mode) {
+  auto attrs = make_object<RaggedEmbeddingBagAttrs>();
+  attrs->mode = std::move(mode);
+  static const Op& op = Op::Get("nn.ragged_embedding_bag");
+  return CallNode::make(op, {weight, indices, offsets}, Attrs(attrs), {});
+}
+
+TVM_REGISTER_GLOBAL("relay.op.nn._make.ragged_embedding_bag")
+.set_body_typed(MakeRaggedEmbeddingBag);
+
+RELAY_REGISTER_OP("nn.ragged_embedding_bag")
+.describe(R"code(Gather rows of an embedding table and reduce them per bag.
+
+Bag b holds the rows indices[offsets[b]:offsets[b + 1]] of weight, which
+are reduced by sum, mean or max. Empty bags are 0. The reduction of a bag
+is ragged and deterministic, without atomics.
+
+- **weight**: `(num_embeddings, dim)`
+- **indices**: `(nnz,)`
+- **offsets**: `(num_bags + 1,)`
+- **out**: `(num_bags, dim)`
+)code" TVM_ADD_FILELINE)
+.set_attrs_type<RaggedEmbeddingBagAttrs>()
+.set_num_inputs(3)
+.add_argument("weight", "2D Tensor", "The embedding table.")
+.add_argument("indices", "1D Tensor", "The rows of all bags, back to back.")
+.add_argument("offsets", "1D Tensor", "The start of each bag in indices, followed by nnz.")
+.set_support_level(10)
+.add_type_rel("RaggedEmbeddingBag", RaggedEmbeddingBagRel)
+.set_attr<FInferCorrectLayout>("FInferCorrectLayout", RaggedInferCorrectLayout)
+.set_attr<TRaggedOp>("TRaggedOp", true);
+
 // relay.nn.batch_matmul
 bool BatchMatmulRel(const Array<Type>& types,
                     int num_inputs,
@@ -918,6 +1211,96 @@ are data in batch.
 .add_type_rel("BatchMatmul", BatchMatmulRel);
 
 
+// relay.nn.ragged_batch_matmul
+TVM_REGISTER_NODE_TYPE(RaggedBatchMatmulAttrs);
+
+bool RaggedBatchMatmulRel(const Array<Type>& types,
+                          int num_inputs,
+                          const Attrs& attrs,
+                          const TypeReporter& reporter) {
+  CHECK_EQ(types.size(), 4);
+  const auto* lengths = types[2].as<TensorTypeNode>();
+  if (lengths == nullptr) return false;
+  CHECK_EQ(lengths->shape.size(), 1) << "ragged_batch_matmul: lengths must be 1-D";
+  CHECK(lengths->dtype == DataType::Int(32)) << "ragged_batch_matmul: lengths must be int32";
+  const auto* x = types[0].as<TensorTypeNode>();
+  const auto* y = types[1].as<TensorTypeNode>();
+  if (x == nullptr || y == nullptr) return false;
+  const auto* param = attrs.as<RaggedBatchMatmulAttrs>();
+  CHECK(param != nullptr);
+  CheckRaggedMode("ragged_batch_matmul", param->mode, param->tile);
+  CHECK(x->shape.size() == 3 && y->shape.size() == 3);
+  CHECK(reporter->AssertEQ(x->shape[0], y->shape[0]))
+      << "ragged_batch_matmul: batch dimension doesn't match, "
+      << " x shape=" << x->shape
+      << ", y shape=" << y->shape;
+  CHECK(reporter->AssertEQ(x->shape[2], y->shape[2]))
+      << "ragged_batch_matmul: shapes of x and y is inconsistent, "
+      << " x shape=" << x->shape
+      << ", y shape=" << y->shape;
+  CHECK(reporter->AssertEQ(x->shape[0], lengths->shape[0]))
+      << "ragged_batch_matmul: lengths must have one entry per batch, "
+      << " x shape=" << x->shape
+      << ", lengths shape=" << lengths->shape;
+
+  Array<tvm::PrimExpr> oshape = x->shape;
+  oshape.Set(2, y->shape[1]);
+  DataType out_dtype = param->out_dtype.bits() == 0 ? x->dtype : param->out_dtype;
+  reporter->Assign(types[3], TensorType(oshape, out_dtype));
+  return true;
+}
+
+
+Expr MakeRaggedBatchMatmul(Expr x,
+                           Expr y,
+                           Expr lengths,
+                           DataType out_dtype,
+                           std::string mode,
+                           int tile) {
+  auto attrs = make_object<RaggedBatchMatmulAttrs>();
+  attrs->out_dtype = out_dtype;
+  attrs->mode = std::move(mode);
+  attrs->tile = tile;
+  static const Op& op = Op::Get("nn.ragged_batch_matmul");
+  return CallNode::make(op, {x, y, lengths}, Attrs(attrs), {});
+}
+
+
+TVM_REGISTER_GLOBAL("relay.op.nn._make.ragged_batch_matmul")
+.set_body_typed(MakeRaggedBatchMatmul);
+
+
+RELAY_REGISTER_OP("nn.ragged_batch_matmul")
+.describe(R"code(Computes matrix multiplication of `x` and `y` when `x` and `y`
+are data in batch, and only the first lengths[i] rows of x[i, :, :] are valid.
+
+.. math::
+
+  ragged\_batch\_matmul(x, y)[i, :l_i, :] = matmul(x[i, :l_i, :], y[i, :, :]^T)
+
+The padded rows of the output are 0. They are skipped by the ragged
+reduction, so that one kernel serves groups of different sizes, such as
+the experts of a mixture of experts layer. With int8 inputs and an int32
+``out_dtype``, the products are accumulated in int32. ``mode`` selects
+how the kernel iterates the rows, as for nn.ragged_softmax.
+
+- **x**: `(b, m, k)`
+- **y**: `(b, n, k)`
+- **lengths**: `(b,)`
+- **out**: `(b, m, n)`.
+
+)code" TVM_ADD_FILELINE)
+.set_attrs_type<RaggedBatchMatmulAttrs>()
+.set_num_inputs(3)
+.add_argument("x", "3D Tensor", "First input, padded along m.")
+.add_argument("y", "3D Tensor", "Second input.")
+.add_argument("lengths", "1D Tensor", "The valid rows of each batch of x.")
+.set_support_level(10)
+.add_type_rel("RaggedBatchMatmul", RaggedBatchMatmulRel)
+.set_attr<FInferCorrectLayout>("FInferCorrectLayout", RaggedInferCorrectLayout)
+.set_attr<TRaggedOp>("TRaggedOp", true);
+
+
 // relay.nn.cross_entropy
 bool CrossEntropyRel(const Array<Type>& types,
                     int num_inputs,
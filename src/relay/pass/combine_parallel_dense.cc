@@ -29,6 +29,13 @@
  *
  * This prevents launching multiple kernels in networks with multiple
  * dense branches, such as BERT.
+ *
+ * Dense ops whose inputs are different fields of the same tuple, such as
+ * the tokens dispatched to each expert of a mixture of experts layer, are
+ * also combined when their weights have the same shape. Their inputs may
+ * have different numbers of rows; they are then padded to the largest,
+ * and the group becomes a single ragged_batch_matmul that skips the
+ * padded rows.
  */
 
 #include <tvm/relay/analysis.h>
@@ -37,8 +44,10 @@
 #include <tvm/relay/attrs/transform.h>
 #include <tvm/relay/op_attr_types.h>
 #include <tvm/relay/transform.h>
+#include <algorithm>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 #include "./expr_subst.h"
 #include "./pattern_util.h"
 #include "./combine_parallel_op_batch.h"
@@ -68,11 +77,147 @@ class ParallelDenseCombiner : public ParallelOpBatchCombiner {
   }
 };
 
+/*
+ * Combines dense ops that read different fields of the same tuple into a
+ * batch_matmul, or a ragged_batch_matmul when the fields have different
+ * numbers of rows. Only the dense ops are combined; the ops that follow
+ * them are left in their branches.
+ */
+class ParallelRaggedDenseCombiner : private ExprVisitor {
+ public:
+  explicit ParallelRaggedDenseCombiner(uint64_t min_num_branches)
+    : dense_op_(Op::Get("nn.dense")),
+      min_num_branches_(min_num_branches) {
+  }
+
+  Expr Combine(const Expr& expr) {
+    this->VisitExpr(expr);
+    for (const auto& group : groups_) {
+      if (group.size() < min_num_branches_) continue;
+      CombineGroup(group);
+    }
+    return ExprSubst(expr, std::move(subst_map_));
+  }
+
+ private:
+  using DenseGroup = std::vector<const CallNode*>;
+
+  void VisitExpr_(const CallNode* n) final {
+    ExprVisitor::VisitExpr_(n);
+    if (n->op != dense_op_ || !IsSupportedOp(n)) return;
+    const auto* field = n->args[0].as<TupleGetItemNode>();
+    if (field == nullptr) return;
+    // add the op to a group of the same tuple, or create a new group
+    auto& group_ids = tuple_groups_[field->tuple];
+    auto it = std::find_if(group_ids.begin(), group_ids.end(), [&](size_t id) {
+      return CanOpsBeCombined(n, groups_[id][0]);
+    });
+    if (it != group_ids.end()) {
+      groups_[*it].push_back(n);
+    } else {
+      group_ids.push_back(groups_.size());
+      groups_.push_back({n});
+    }
+  }
+
+  bool IsSupportedOp(const CallNode* n) {
+    const auto* attrs = n->attrs.as<DenseAttrs>();
+    const auto* data = n->args[0]->type_as<TensorTypeNode>();
+    const auto* weight = n->args[1]->type_as<TensorTypeNode>();
+    // batch_matmul computes in the input dtype.
+    if (attrs->out_dtype.bits() != 0 && attrs->out_dtype != data->dtype) return false;
+    if (data->shape.size() != 2 || weight->shape.size() != 2) return false;
+    return data->shape[0].as<IntImmNode>() != nullptr;
+  }
+
+  bool CanOpsBeCombined(const CallNode* a, const CallNode* b) {
+    AttrsEqual eq;
+    const auto* data_a = a->args[0]->type_as<TensorTypeNode>();
+    const auto* data_b = b->args[0]->type_as<TensorTypeNode>();
+    const auto* weight_a = a->args[1]->type_as<TensorTypeNode>();
+    const auto* weight_b = b->args[1]->type_as<TensorTypeNode>();
+    return eq(data_a->dtype, data_b->dtype) &&
+           eq(weight_a->dtype, weight_b->dtype) &&
+           eq(weight_a->shape[0], weight_b->shape[0]) &&
+           eq(weight_a->shape[1], weight_b->shape[1]);
+  }
+
+  void CombineGroup(const DenseGroup& group) {
+    std::vector<int64_t> rows;
+    for (const CallNode* dense : group) {
+      rows.push_back(dense->args[0]->type_as<TensorTypeNode>()->shape[0].as<IntImmNode>()->value);
+    }
+    int64_t max_rows = *std::max_element(rows.begin(), rows.end());
+    bool ragged = false;
+
+    Array<Expr> data, weight;
+    for (size_t i = 0; i < group.size(); i++) {
+      Expr x = group[i]->args[0];
+      if (rows[i] < max_rows) {
+        ragged = true;
+        Array<Array<IndexExpr>> pad_width{{Integer(0), Integer(max_rows - rows[i])},
+                                          {Integer(0), Integer(0)}};
+        x = Pad(x, pad_width, 0, "constant");
+      }
+      data.push_back(x);
+      weight.push_back(group[i]->args[1]);
+    }
+    Expr stacked_data = MakeStack(TupleNode::make(data), 0);
+    Expr stacked_weight = MakeStack(TupleNode::make(weight), 0);
+
+    Expr combined;
+    if (ragged) {
+      static const Op& op = Op::Get("nn.ragged_batch_matmul");
+      Constant lengths = MakeConstantTensor(DataType::Int(32),
+                                            {static_cast<int64_t>(group.size())}, rows);
+      auto attrs = make_object<RaggedBatchMatmulAttrs>();
+      attrs->out_dtype = NullValue<DataType>();
+      attrs->mode = "ragged";
+      attrs->tile = 1;
+      combined = CallNode::make(op, {stacked_data, stacked_weight, lengths}, Attrs(attrs), {});
+    } else {
+      static const Op& op = Op::Get("nn.batch_matmul");
+      combined = CallNode::make(op, {stacked_data, stacked_weight}, Attrs(), {});
+    }
+
+    auto split = MakeSplit(combined, Integer(group.size()), 0);
+    const auto* weight_type = group[0]->args[1]->type_as<TensorTypeNode>();
+    for (size_t i = 0; i < group.size(); i++) {
+      Expr out = MakeSqueeze(TupleGetItemNode::make(split, i), {0});
+      if (rows[i] < max_rows) {
+        int64_t units = weight_type->shape[0].as<IntImmNode>()->value;
+        out = MakeStridedSlice(out, {0, 0}, {Integer(rows[i]), Integer(units)}, {1, 1});
+      }
+      subst_map_.insert({GetRef<Expr>(group[i]), out});
+    }
+  }
+
+  /* \brief Cache the dense op */
+  const Op& dense_op_;
+
+  /* \brief minimum number of parallel dense ops to combine */
+  uint64_t min_num_branches_;
+
+  /* \brief groups of dense ops that can be combined, in visiting order */
+  std::vector<DenseGroup> groups_;
+
+  /* \brief map of tuple to the groups of dense ops that read its fields */
+  std::unordered_map<Expr, std::vector<size_t>, ObjectHash, ObjectEqual> tuple_groups_;
+
+  /* \brief map of Expr to Expr to substitute it with after running pass */
+  ExprSubstMap subst_map_;
+};
+
 /*! \brief Combine parallel dense if number of branches >= min_num_branches */
 Expr CombineParallelDense(const Expr& expr, uint64_t min_num_branches) {
   return ParallelDenseCombiner(min_num_branches).Combine(expr);
 }
 
+/*! \brief Combine dense on fields of a tuple if number of branches >= min_num_branches */
+Expr CombineParallelRaggedDense(const Expr& expr, uint64_t min_num_branches) {
+  return ParallelRaggedDenseCombiner(min_num_branches).Combine(expr);
+}
+
 namespace transform {
 
 Pass CombineParallelDense(uint64_t min_num_branches) {
@@ -80,8 +225,19 @@ Pass CombineParallelDense(uint64_t min_num_branches) {
     [=](Function f, IRModule m, PassContext pc) {
       return Downcast<Function>(CombineParallelDense(f, min_num_branches));
   };
-  return CreateFunctionPass(pass_func, 4, "CombineParallelDense",
-                            {tir::StringImmNode::make("InferType")});
+  runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> ragged_func =
+    [=](Function f, IRModule m, PassContext pc) {
+      return Downcast<Function>(CombineParallelRaggedDense(f, min_num_branches));
+  };
+  // The ragged combiner reads the types of the dense ops, so the types of
+  // the ops rewritten by the first combiner are inferred again in between.
+  return Sequential(
+      {CreateFunctionPass(pass_func, 4, "CombineParallelDense",
+                          {tir::StringImmNode::make("InferType")}),
+       InferType(),
+       CreateFunctionPass(ragged_func, 4, "CombineParallelRaggedDense",
+                          {tir::StringImmNode::make("InferType")})},
+      "CombineParallelDense");
 }
 
 TVM_REGISTER_GLOBAL("relay._transform.CombineParallelDense")
@@ -684,6 +684,15 @@ class GraphPartitioner {
     }
   }
 
+  // Whether the node is a call to an op marked TRaggedOp.
+  static bool IsRaggedOp(const tvm::Object* ref) {
+    static auto fragged = Op::GetAttr<TRaggedOp>("TRaggedOp");
+    if (ref == nullptr || !ref->IsInstance<CallNode>()) return false;
+    const auto* call = static_cast<const CallNode*>(ref);
+    const OpNode* op = call->op.as<OpNode>();
+    return op != nullptr && fragged.get(GetRef<Op>(op), false);
+  }
+
   // execute the fusion algorithm.
   void RunFuse(const IndexedForwardGraph& graph,
                const DominatorTree& post_dom_tree,
@@ -775,8 +784,13 @@ class GraphPartitioner {
         // defer injective fusion to second phase.
         // so conv2d always finishes fusing.
         if (phase != 1) continue;
-        // Check if all path are injective.
-        auto fcond = [](OpPatternKind kind, bool is_sink) {
+        // Check if all path are injective. A ragged reduction also accepts
+        // injective producers, which then run over its valid elements only.
+        bool ragged_sink = group_node->pattern == kInjective &&
+            dom_node->pattern == kCommReduce &&
+            IsRaggedOp(dom_node->parent->gnode->ref);
+        auto fcond = [ragged_sink](OpPatternKind kind, bool is_sink) {
+          if (is_sink && ragged_sink) return kind == kCommReduce;
           return kind <= kInjective;
         };
         if (CheckPath(graph_node, dom_node->parent->gnode, fcond)) {
@@ -0,0 +1,248 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file lower_to_ragged.cc
+ * \brief Rewrite dense operators over length masked inputs into ragged
+ *  operators that only visit the valid elements.
+ *
+ *  Frontends express variable sequence lengths by padding to the
+ *  maximum length and masking the padding, e.g. before the softmax of
+ *  an attention layer. Two mask forms are recognized:
+ *
+ *    softmax(sequence_mask(x, len, -big, axis=a), axis=a)
+ *    softmax(where(less(iota, len), x, -big), axis)
+ *
+ *  where iota is an arange along the softmax axis, len is a 1-D length
+ *  tensor broadcast along a single batch axis, and -big is small enough
+ *  that exp() of it underflows. Both become nn.ragged_softmax.
+ */
+#include <tvm/tir/op.h>
+#include <tvm/relay/analysis.h>
+#include <tvm/relay/expr_functor.h>
+#include <tvm/relay/op.h>
+#include <tvm/relay/attrs/nn.h>
+#include <tvm/relay/attrs/transform.h>
+#include <tvm/relay/transform.h>
+#include "pattern_util.h"
+
+namespace tvm {
+namespace relay {
+
+// Mask values at or below this are treated as excluding the element.
+static constexpr double kMaskThreshold = -1e4;
+
+// A matched masked softmax.
+struct RaggedSoftmaxMatch {
+  Expr data;
+  Expr lengths;
+  int axis;
+  int batch_axis;
+};
+
+class RaggedLowerer : public ExprMutator {
+ public:
+  RaggedLowerer()
+      : softmax_op_(Op::Get("nn.softmax")),
+        sequence_mask_op_(Op::Get("sequence_mask")),
+        where_op_(Op::Get("where")),
+        less_op_(Op::Get("less")),
+        greater_op_(Op::Get("greater")),
+        arange_op_(Op::Get("arange")),
+        reshape_op_(Op::Get("reshape")),
+        expand_dims_op_(Op::Get("expand_dims")),
+        cast_op_(Op::Get("cast")) {}
+
+  Expr VisitExpr_(const CallNode* n) final {
+    RaggedSoftmaxMatch match;
+    if (n->op == softmax_op_ && MatchMaskedSoftmax(n, &match)) {
+      Expr data = this->Mutate(match.data);
+      Expr lengths = this->Mutate(match.lengths);
+      if (match.lengths->type_as<TensorTypeNode>()->dtype != DataType::Int(32)) {
+        lengths = Cast(lengths, DataType::Int(32));
+      }
+      static const Op& op = Op::Get("nn.ragged_softmax");
+      auto attrs = make_object<RaggedSoftmaxAttrs>();
+      attrs->axis = match.axis;
+      attrs->batch_axis = match.batch_axis;
+      attrs->scale = 1.0;
+      attrs->mode = "ragged";
+      attrs->tile = 1;
+      return CallNode::make(op, {data, lengths}, Attrs(attrs), {});
+    }
+    return ExprMutator::VisitExpr_(n);
+  }
+
+ private:
+  bool MatchMaskedSoftmax(const CallNode* softmax, RaggedSoftmaxMatch* match) {
+    const auto* ttype = softmax->args[0]->type_as<TensorTypeNode>();
+    int ndim = static_cast<int>(ttype->shape.size());
+    if (ndim < 2) return false;
+    int axis = softmax->attrs.as<SoftmaxAttrs>()->axis;
+    if (axis < 0) axis += ndim;
+
+    const CallNode* mask = softmax->args[0].as<CallNode>();
+    if (mask == nullptr) return false;
+    if (mask->op == sequence_mask_op_) {
+      return MatchSequenceMask(mask, ndim, axis, match);
+    }
+    if (mask->op == where_op_) {
+      return MatchWhere(mask, ttype, axis, match);
+    }
+    return false;
+  }
+
+  // sequence_mask puts the lengths on axis 1 - axis, over axes 0 and 1.
+  bool MatchSequenceMask(const CallNode* mask, int ndim, int axis,
+                         RaggedSoftmaxMatch* match) {
+    const auto* param = mask->attrs.as<SequenceMaskAttrs>();
+    if (param->axis != axis || axis > 1) return false;
+    if (param->mask_value > kMaskThreshold) return false;
+    match->data = mask->args[0];
+    match->lengths = mask->args[1];
+    match->axis = axis;
+    match->batch_axis = 1 - axis;
+    return true;
+  }
+
+  bool MatchWhere(const CallNode* mask, const TensorTypeNode* ttype, int axis,
+                  RaggedSoftmaxMatch* match) {
+    if (!IsMaskConstant(mask->args[2])) return false;
+    if (!AlphaEqual(mask->args[1]->checked_type(), GetRef<Type>(ttype))) {
+      return false;
+    }
+    const CallNode* cond = mask->args[0].as<CallNode>();
+    if (cond == nullptr) return false;
+    Expr iota, lengths;
+    if (cond->op == less_op_) {
+      iota = cond->args[0];
+      lengths = cond->args[1];
+    } else if (cond->op == greater_op_) {
+      iota = cond->args[1];
+      lengths = cond->args[0];
+    } else {
+      return false;
+    }
+
+    int ndim = static_cast<int>(ttype->shape.size());
+    // The iota must vary along the softmax axis only.
+    if (!IsIota(StripShapeOps(iota))) return false;
+    const auto* itype = iota->type_as<TensorTypeNode>();
+    if (static_cast<int>(itype->shape.size()) != ndim) return false;
+    for (int i = 0; i < ndim; ++i) {
+      if (i != axis && !tir::is_one(itype->shape[i])) return false;
+    }
+
+    // The lengths must vary along a single batch axis.
+    Expr lengths_1d = StripShapeOps(lengths);
+    const auto* l1type = lengths_1d->type_as<TensorTypeNode>();
+    const auto* ltype = lengths->type_as<TensorTypeNode>();
+    if (l1type->shape.size() != 1 || !l1type->dtype.is_int()) return false;
+    if (static_cast<int>(ltype->shape.size()) != ndim) return false;
+    int batch_axis = -1;
+    for (int i = 0; i < ndim; ++i) {
+      if (tir::is_one(ltype->shape[i])) continue;
+      if (batch_axis != -1) return false;
+      batch_axis = i;
+    }
+    if (batch_axis == -1) batch_axis = axis == 0 ? 1 : 0;
+    if (batch_axis == axis) return false;
+
+    match->data = mask->args[1];
+    match->lengths = lengths_1d;
+    match->axis = axis;
+    match->batch_axis = batch_axis;
+    return true;
+  }
+
+  bool IsMaskConstant(const Expr& e) {
+    const auto* n = e.as<ConstantNode>();
+    if (n == nullptr || !n->is_scalar()) return false;
+    DataType dtype = n->tensor_type()->dtype;
+    double value;
+    if (dtype == DataType::Float(32)) {
+      value = GetScalarFromConstant<float>(e);
+    } else if (dtype == DataType::Float(64)) {
+      value = GetScalarFromConstant<double>(e);
+    } else {
+      return false;
+    }
+    return value <= kMaskThreshold;
+  }
+
+  bool IsIota(const Expr& e) {
+    const CallNode* n = e.as<CallNode>();
+    if (n == nullptr || n->op != arange_op_) return false;
+    const auto* param = n->attrs.as<ArangeAttrs>();
+    return IsConstInt(param->start, 0) && IsConstInt(param->step, 1);
+  }
+
+  bool IsConstInt(const Expr& e, int64_t value) {
+    const auto* n = e.as<ConstantNode>();
+    if (n == nullptr || !n->is_scalar()) return false;
+    DataType dtype = n->tensor_type()->dtype;
+    if (dtype == DataType::Int(32)) return GetScalarFromConstant<int32_t>(e) == value;
+    if (dtype == DataType::Int(64)) return GetScalarFromConstant<int64_t>(e) == value;
+    if (dtype == DataType::Float(32)) return GetScalarFromConstant<float>(e) == value;
+    return false;
+  }
+
+  // Look through the ops frontends insert to broadcast a 1-D tensor.
+  Expr StripShapeOps(Expr e) {
+    while (const CallNode* n = e.as<CallNode>()) {
+      if (n->op != reshape_op_ && n->op != expand_dims_op_ && n->op != cast_op_) break;
+      e = n->args[0];
+    }
+    return e;
+  }
+
+  // Cache the ops for equivalence checking.
+  const Op& softmax_op_;
+  const Op& sequence_mask_op_;
+  const Op& where_op_;
+  const Op& less_op_;
+  const Op& greater_op_;
+  const Op& arange_op_;
+  const Op& reshape_op_;
+  const Op& expand_dims_op_;
+  const Op& cast_op_;
+};
+
+Expr LowerToRagged(const Expr& e) {
+  return RaggedLowerer().Mutate(e);
+}
+
+namespace transform {
+
+Pass LowerToRagged() {
+  runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
+    [=](Function f, IRModule m, PassContext pc) {
+    return Downcast<Function>(LowerToRagged(f));
+  };
+  return CreateFunctionPass(pass_func, 3, "LowerToRagged",
+                            {tir::StringImmNode::make("InferType")});
+}
+
+TVM_REGISTER_GLOBAL("relay._transform.LowerToRagged")
+.set_body_typed(LowerToRagged);
+
+}  // namespace transform
+
+}  // namespace relay
+}  // namespace tvm
@@ -270,6 +270,69 @@ RELAY_REGISTER_OP("nn.dense")
 .set_attr<FForwardRewrite>("FQRealizeRewrite", DenseRealize);
 
 
+Expr RaggedBatchMatmulRealize(const Call& ref_call,
+                              const Array<Expr>& new_args,
+                              const ObjectRef& ctx) {
+  const QConfig& cfg = QConfig::Current();
+  CHECK_EQ(new_args.size(), 3);
+  if (!new_args[0]->IsInstance<TempExprNode>() || !new_args[1]->IsInstance<TempExprNode>()) {
+    return Expr(nullptr);
+  }
+  const auto* lhs = new_args[0].as<QRealizeIntExprNode>();
+  const auto* rhs = new_args[1].as<QRealizeIntExprNode>();
+  CHECK(!new_args[2]->IsInstance<TempExprNode>());
+
+  Expr ldata = lhs->data;
+  if (lhs->dtype != cfg->dtype_input) {
+    ldata = Cast(ldata, cfg->dtype_input);
+  }
+  Expr rdata = Cast(rhs->data, cfg->dtype_weight);
+
+  // The ragged kernel accumulates the int8 products in the activation type.
+  const auto ref_attrs = ref_call->attrs.as<RaggedBatchMatmulAttrs>();
+  auto attrs = make_object<RaggedBatchMatmulAttrs>();
+  *attrs = *ref_attrs;
+  DataType out_dtype = cfg->dtype_activation;
+  attrs->out_dtype = out_dtype;
+
+  Expr ret = CallNode::make(ref_call->op,
+          {ldata, rdata, new_args[2]}, Attrs(attrs), ref_call->type_args);
+  Expr mul = Multiply(lhs->dom_scale, rhs->dom_scale);
+  Expr dom_scale = FoldConstantOpt(mul);
+  return QRealizeIntExprNode::make(ret, dom_scale, out_dtype);
+}
+
+RELAY_REGISTER_OP("nn.ragged_batch_matmul")
+.set_attr<FForwardRewrite>("FQRealizeRewrite", RaggedBatchMatmulRealize);
+
+
+/* \brief ragged softmax on int8 input, scaled per sequence after the max is subtracted */
+Expr RaggedSoftmaxRealize(const Call& ref_call,
+                          const Array<Expr>& new_args,
+                          const ObjectRef& ctx) {
+  const QConfig& cfg = QConfig::Current();
+  CHECK_EQ(new_args.size(), 2);
+  CHECK(!new_args[1]->IsInstance<TempExprNode>());
+  if (const auto* n = new_args[0].as<QRealizeIntExprNode>()) {
+    Expr data = n->data;
+    if (n->dtype != cfg->dtype_input) {
+      data = Cast(data, cfg->dtype_input);
+    }
+    const auto ref_attrs = ref_call->attrs.as<RaggedSoftmaxAttrs>();
+    auto attrs = make_object<RaggedSoftmaxAttrs>();
+    *attrs = *ref_attrs;
+    attrs->scale = ref_attrs->scale * GetScalarFromConstant<float>(n->dom_scale);
+    // The probabilities are real; the following ops quantize them as needed.
+    return CallNode::make(ref_call->op, {data, new_args[1]}, Attrs(attrs), ref_call->type_args);
+  }
+  CHECK(!new_args[0]->IsInstance<TempExprNode>());
+  return Expr(nullptr);
+}
+
+RELAY_REGISTER_OP("nn.ragged_softmax")
+.set_attr<FForwardRewrite>("FQRealizeRewrite", RaggedSoftmaxRealize);
+
+
 Expr MulRealize(const Call& ref_call,
                 const Array<Expr>& new_args,
                 const ObjectRef& ctx) {
@@ -0,0 +1,136 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/relay/qnn/op/ragged_batch_matmul.cc
+ * \brief Property def of qnn ragged_batch_matmul operator.
+ */
+
+#include <tvm/relay/base.h>
+#include <tvm/relay/op.h>
+#include <tvm/relay/op_attr_types.h>
+#include <tvm/relay/qnn/attrs.h>
+#include "../../op/nn/nn.h"
+#include "../../pass/pattern_util.h"
+#include "../util.h"
+
+namespace tvm {
+namespace relay {
+namespace qnn {
+
+// relay.op.qnn.ragged_batch_matmul
+
+bool QnnRaggedBatchMatmulRel(const Array<Type>& types, int num_inputs, const Attrs& attrs,
+                             const TypeReporter& reporter) {
+  CHECK_EQ(types.size(), 8);
+  const auto* x = types[0].as<TensorTypeNode>();
+  const auto* y = types[1].as<TensorTypeNode>();
+  if (x == nullptr || y == nullptr) return false;
+  const auto* param = attrs.as<RaggedBatchMatmulAttrs>();
+  CHECK(param != nullptr) << "RaggedBatchMatmulAttrs cannot be nullptr.";
+  CHECK(x->dtype == DataType::Int(8) || x->dtype == DataType::UInt(8))
+      << "Expected quantized ragged_batch_matmul type(int8, uint8) for x but was " << x->dtype;
+  CHECK(y->dtype == DataType::Int(8) || y->dtype == DataType::UInt(8))
+      << "Expected quantized ragged_batch_matmul type(int8, uint8) for y but was " << y->dtype;
+  CHECK(param->out_dtype == DataType::Int(32))
+      << "Expected quantized ragged_batch_matmul type(int32) for output but was "
+      << param->out_dtype;
+
+  // Check the types of scale and zero points.
+  CHECK(IsScalarType(types[3], DataType::Int(32)));    // input_zero_point
+  CHECK(IsScalarType(types[4], DataType::Int(32)));    // kernel_zero_point
+  CHECK(IsScalarType(types[5], DataType::Float(32)));  // input_scale
+  CHECK(IsScalarType(types[6], DataType::Float(32)));  // kernel_scale
+
+  // Collect the input tensors and output tensor devoid of scale and zero points to reuse
+  // the Relay ragged_batch_matmul infer type function.
+  Array<Type> tensor_types = {types[0], types[1], types[2], types[7]};
+  return RaggedBatchMatmulRel(tensor_types, 3, attrs, reporter);
+}
+
+// Positional relay function to create quantized ragged_batch_matmul operator used by
+// frontend FFI.
+Expr MakeQuantizedRaggedBatchMatmul(Expr x, Expr y, Expr lengths, Expr input_zero_point,
+                                    Expr kernel_zero_point, Expr input_scale,
+                                    Expr kernel_scale, DataType out_dtype) {
+  auto attrs = make_object<RaggedBatchMatmulAttrs>();
+  attrs->out_dtype = out_dtype;
+  attrs->mode = "ragged";
+  attrs->tile = 1;
+  static const Op& op = Op::Get("qnn.ragged_batch_matmul");
+  return CallNode::make(
+      op, {x, y, lengths, input_zero_point, kernel_zero_point, input_scale, kernel_scale},
+      Attrs(attrs), {});
+}
+
+/*
+ * \brief Forward rewrite the qnn ragged_batch_matmul op.
+ * \param attrs The ragged_batch_matmul attrs.
+ * \param new_args The new mutated args to the call node.
+ * \param arg_types The types of input and output.
+ * \return The sequence of Relay ops for qnn ragged_batch_matmul op.
+ * \note Only symmetric quantization is supported. With zero points of
+ *       zero, the quantized product is the int32 accumulation of the int8
+ *       products, which the ragged kernel computes over the valid rows
+ *       only. The zero point terms of qnn.dense would have to be masked
+ *       to keep the padded rows at zero.
+ */
+Expr QnnRaggedBatchMatmulCanonicalize(const Attrs& attrs, const Array<Expr>& new_args,
+                                      const Array<tvm::relay::Type>& arg_types) {
+  CHECK_EQ(new_args.size(), 7);
+  auto input_zero_point_int = GetScalarFromConstant<int>(new_args[3]);
+  auto kernel_zero_point_int = GetScalarFromConstant<int>(new_args[4]);
+  CHECK(input_zero_point_int == 0 && kernel_zero_point_int == 0)
+      << "qnn.ragged_batch_matmul only supports symmetric quantization, but got zero points "
+      << input_zero_point_int << " and " << kernel_zero_point_int;
+
+  const auto* param = attrs.as<RaggedBatchMatmulAttrs>();
+  static const Op& op = Op::Get("nn.ragged_batch_matmul");
+  auto new_attrs = make_object<RaggedBatchMatmulAttrs>();
+  *new_attrs = *param;
+  return CallNode::make(op, {new_args[0], new_args[1], new_args[2]}, Attrs(new_attrs), {});
+}
+
+RELAY_REGISTER_OP("qnn.ragged_batch_matmul")
+.describe(R"code(Quantized batch matrix multiplication where only the first
+lengths[i] rows of x[i, :, :] are valid.
+- **x**: quantized(int8, unit8) `(b, m, k)`
+- **y**: quantized(int8, unit8) `(b, n, k)`
+- **lengths**: int32 `(b,)`
+- **out**: quantized(int32) `(b, m, n)`.
+)code" TVM_ADD_FILELINE)
+.set_attrs_type<RaggedBatchMatmulAttrs>()
+.set_num_inputs(7)
+.add_argument("x", "quantized 3D Tensor", "First input, padded along m.")
+.add_argument("y", "quantized 3D Tensor", "Second input.")
+.add_argument("lengths", "1D Tensor", "The valid rows of each batch of x.")
+.add_argument("input_zero_point", "Tensor", "The quantization zero_point of x.")
+.add_argument("kernel_zero_point", "Tensor", "The quantization zero_point of y.")
+.add_argument("input_scale", "Tensor", "The quantization scale of x.")
+.add_argument("kernel_scale", "Tensor", "The quantization scale of y.")
+.set_support_level(11)
+.add_type_rel("QRaggedBatchMatmul", QnnRaggedBatchMatmulRel)
+.set_attr<FTVMLegalize>("FTVMQnnCanonicalize", QnnRaggedBatchMatmulCanonicalize);
+
+TVM_REGISTER_GLOBAL("relay.qnn.op._make.ragged_batch_matmul")
+.set_body_typed(MakeQuantizedRaggedBatchMatmul);
+
+}  // namespace qnn
+}  // namespace relay
+}  // namespace tvm
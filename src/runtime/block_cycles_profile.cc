@@ -0,0 +1,140 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file block_cycles_profile.cc
+ * \brief Device buffers the blocks of instrumented kernels record the
+ *  cycle counter at their entry and exit in.
+ */
+#include <dmlc/logging.h>
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/module.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/registry.h>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+
+namespace tvm {
+namespace runtime {
+
+/*! \brief The records of the last launch of one kernel. */
+struct BlockCyclesEntry {
+  /*! \brief The context of the buffer */
+  TVMContext ctx;
+  /*! \brief The buffer, of two int64 per block */
+  void* data{nullptr};
+  /*! \brief The number of blocks the buffer has room for */
+  int64_t capacity{0};
+  /*! \brief The number of blocks of the last launch */
+  int64_t num_blocks{0};
+};
+
+class BlockCyclesProfiler {
+ public:
+  static BlockCyclesProfiler* Global() {
+    static BlockCyclesProfiler* inst = new BlockCyclesProfiler();
+    return inst;
+  }
+
+  void* Buffer(const std::string& name, int kernel, int64_t num_blocks, TVMContext ctx) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    BlockCyclesEntry& entry = entries_[{name, kernel}];
+    if (entry.data && (entry.capacity < num_blocks || entry.ctx.device_type != ctx.device_type ||
+                       entry.ctx.device_id != ctx.device_id)) {
+      DeviceAPI::Get(entry.ctx)->FreeDataSpace(entry.ctx, entry.data);
+      entry.data = nullptr;
+    }
+    if (!entry.data) {
+      // Grids change with the lengths, so leave room for growth.
+      entry.capacity = std::max<int64_t>(num_blocks * 2, 64);
+      entry.ctx = ctx;
+      entry.data = DeviceAPI::Get(ctx)->AllocDataSpace(ctx, entry.capacity * 2 * sizeof(int64_t),
+                                                        kAllocAlignment, {kDLInt, 64, 1});
+    }
+    entry.num_blocks = num_blocks;
+    return entry.data;
+  }
+
+  /*! \brief The profiled kernels, one "name:kernel" per line. */
+  std::string Kernels() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ostringstream os;
+    for (const auto& it : entries_) {
+      os << it.first.first << ":" << it.first.second << "\n";
+    }
+    return os.str();
+  }
+
+  /*! \brief Copy the records of the last launch of a kernel to the host. */
+  NDArray Get(const std::string& name, int kernel) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find({name, kernel});
+    CHECK(it != entries_.end()) << "No block cycles recorded for kernel " << kernel << " of "
+                                << name;
+    const BlockCyclesEntry& entry = it->second;
+    TVMContext cpu_ctx{kDLCPU, 0};
+    NDArray ret = NDArray::Empty({entry.num_blocks, 2}, {kDLInt, 64, 1}, cpu_ctx);
+    DeviceAPI* api = DeviceAPI::Get(entry.ctx);
+    // The kernels run on the default stream.
+    api->StreamSync(entry.ctx, nullptr);
+    api->CopyDataFromTo(entry.data, 0, ret->data, 0, entry.num_blocks * 2 * sizeof(int64_t),
+                        entry.ctx, cpu_ctx, {kDLInt, 64, 1}, nullptr);
+    api->StreamSync(entry.ctx, nullptr);
+    return ret;
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& it : entries_) {
+      DeviceAPI::Get(it.second.ctx)->FreeDataSpace(it.second.ctx, it.second.data);
+    }
+    entries_.clear();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::map<std::pair<std::string, int>, BlockCyclesEntry> entries_;
+};
+
+TVM_REGISTER_GLOBAL(symbol::tvm_block_cycles_buffer).set_body([](TVMArgs args, TVMRetValue* ret) {
+  TVMContext ctx;
+  ctx.device_type = static_cast<DLDeviceType>(args[3].operator int());
+  ctx.device_id = args[4];
+  *ret = BlockCyclesProfiler::Global()->Buffer(args[0], args[1], args[2], ctx);
+});
+
+TVM_REGISTER_GLOBAL("runtime.BlockCyclesKernels").set_body_typed([]() {
+  return BlockCyclesProfiler::Global()->Kernels();
+});
+
+TVM_REGISTER_GLOBAL("runtime.BlockCyclesGet").set_body_typed([](std::string name, int kernel) {
+  return BlockCyclesProfiler::Global()->Get(name, kernel);
+});
+
+TVM_REGISTER_GLOBAL("runtime.BlockCyclesClear").set_body_typed([]() {
+  BlockCyclesProfiler::Global()->Clear();
+});
+
+}  // namespace runtime
+}  // namespace tvm
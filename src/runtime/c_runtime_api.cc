@@ -150,6 +150,16 @@ void* DeviceAPI::AllocWorkspace(TVMContext ctx, size_t size, DLDataType type_hin
 
 void DeviceAPI::FreeWorkspace(TVMContext ctx, void* ptr) { FreeDataSpace(ctx, ptr); }
 
+void DeviceAPI::CopyDataToDeviceStreamOrdered(const void* from, size_t from_offset, void* to,
+                                              size_t to_offset, size_t num_bytes,
+                                              TVMContext ctx_to, DLDataType type_hint) {
+  TVMContext ctx_from;
+  ctx_from.device_type = kDLCPU;
+  ctx_from.device_id = 0;
+  CopyDataFromTo(from, from_offset, to, to_offset, num_bytes, ctx_from, ctx_to, type_hint,
+                 nullptr);
+}
+
 TVMStreamHandle DeviceAPI::CreateStream(TVMContext ctx) {
   LOG(FATAL) << "Device does not support stream api.";
   return 0;
@@ -432,14 +442,46 @@ void TVMBackendCopyMemory(const void* from, size_t from_offset, void* to, size_t
   type_hint.bits = static_cast<decltype(type_hint.bits)>(dtype_bits_hint);
   type_hint.lanes = 1;
 
-  DeviceAPIManager::Get(to_ctx)->CopyDataFromTo(from, from_offset, to, to_offset, num_bytes,
-                                                from_ctx, to_ctx, type_hint, nullptr);
+  // Copy on the stream set for the calling thread, so that the copies
+  // of functions launched on a stream do not serialize with the other
+  // streams of the device through the default stream.
+  TVMContext ctx = from_ctx.device_type != kDLCPU ? from_ctx : to_ctx;
+  DeviceAPI* api = DeviceAPIManager::Get(ctx);
+  TVMStreamHandle stream = api->GetStream(ctx);
+  api->CopyDataFromTo(from, from_offset, to, to_offset, num_bytes, from_ctx, to_ctx, type_hint,
+                      stream);
+  if (stream != nullptr) api->StreamSync(ctx, stream);
 
   // for (int i = 0; i < num_bytes / sizeof(int); ++i) {
     // std::cout << " " << ((int*)from)[i] << " " << ((int*)to)[i] << std::endl;
   // }
 }
 
+void TVMBackendCopyMemoryAsync(const void* from, size_t from_offset, void* to, size_t to_offset,
+                               size_t num_bytes, int from_device_type, int from_device_id,
+                               int to_device_type, int to_device_id, int dtype_code_hint,
+                               int dtype_bits_hint) {
+  if ((from_device_type != kDLCPU && from_device_type != kDLCPUPinned) ||
+      to_device_type == kDLCPU || to_device_type == kDLCPUPinned) {
+    TVMBackendCopyMemory(from, from_offset, to, to_offset, num_bytes, from_device_type,
+                         from_device_id, to_device_type, to_device_id, dtype_code_hint,
+                         dtype_bits_hint);
+    return;
+  }
+
+  TVMContext to_ctx;
+  to_ctx.device_type = static_cast<DLDeviceType>(to_device_type);
+  to_ctx.device_id = to_device_id;
+
+  DLDataType type_hint;
+  type_hint.code = static_cast<decltype(type_hint.code)>(dtype_code_hint);
+  type_hint.bits = static_cast<decltype(type_hint.bits)>(dtype_bits_hint);
+  type_hint.lanes = 1;
+
+  DeviceAPIManager::Get(to_ctx)->CopyDataToDeviceStreamOrdered(from, from_offset, to, to_offset,
+                                                               num_bytes, to_ctx, type_hint);
+}
+
 int TVMBackendFreeWorkspace(int device_type, int device_id, void* ptr) {
   TVMContext ctx;
   ctx.device_type = static_cast<DLDeviceType>(device_type);
@@ -609,3 +651,50 @@ TVM_REGISTER_GLOBAL("runtime.GetDeviceAttr").set_body([](TVMArgs args, TVMRetVal
 });
 
 TVM_REGISTER_GLOBAL("runtime.TVMSetStream").set_body_typed(TVMSetStream);
+
+inline TVMContext MakeContext(int device_type, int device_id) {
+  TVMContext ctx;
+  ctx.device_type = static_cast<DLDeviceType>(device_type);
+  ctx.device_id = device_id;
+  return ctx;
+}
+
+TVM_REGISTER_GLOBAL("runtime.TVMGetStream").set_body_typed([](int device_type, int device_id) {
+  TVMContext ctx = MakeContext(device_type, device_id);
+  return DeviceAPIManager::Get(ctx)->GetStream(ctx);
+});
+
+TVM_REGISTER_GLOBAL("runtime.TVMEventCreate").set_body_typed([](int device_type, int device_id) {
+  TVMContext ctx = MakeContext(device_type, device_id);
+  return DeviceAPIManager::Get(ctx)->CreateEvent(ctx);
+});
+
+TVM_REGISTER_GLOBAL("runtime.TVMEventFree")
+    .set_body_typed([](int device_type, int device_id, void* event) {
+      TVMContext ctx = MakeContext(device_type, device_id);
+      DeviceAPIManager::Get(ctx)->FreeEvent(ctx, event);
+    });
+
+TVM_REGISTER_GLOBAL("runtime.TVMEventRecord")
+    .set_body_typed([](int device_type, int device_id, void* event, void* stream) {
+      TVMContext ctx = MakeContext(device_type, device_id);
+      DeviceAPIManager::Get(ctx)->RecordEvent(ctx, event, stream);
+    });
+
+TVM_REGISTER_GLOBAL("runtime.TVMEventSynchronize")
+    .set_body_typed([](int device_type, int device_id, void* event) {
+      TVMContext ctx = MakeContext(device_type, device_id);
+      DeviceAPIManager::Get(ctx)->EventSync(ctx, event);
+    });
+
+TVM_REGISTER_GLOBAL("runtime.TVMEventQuery")
+    .set_body_typed([](int device_type, int device_id, void* event) {
+      TVMContext ctx = MakeContext(device_type, device_id);
+      return DeviceAPIManager::Get(ctx)->EventQuery(ctx, event);
+    });
+
+TVM_REGISTER_GLOBAL("runtime.TVMStreamWaitEvent")
+    .set_body_typed([](int device_type, int device_id, void* stream, void* event) {
+      TVMContext ctx = MakeContext(device_type, device_id);
+      DeviceAPIManager::Get(ctx)->StreamWaitEvent(ctx, stream, event);
+    });
@@ -76,8 +76,24 @@ TVM_REGISTER_GLOBAL("runtime.container._ADT")
   *rv = ADT(tag, fields);
 });
 
+TVM_REGISTER_GLOBAL("runtime.container._RaggedTensor")
+.set_body_typed([](NDArray data, NDArray offsets) {
+  return RaggedTensor(data, offsets);
+});
+
+TVM_REGISTER_GLOBAL("runtime.container._GetRaggedTensorData")
+.set_body_typed([](RaggedTensor tensor) {
+  return tensor->data;
+});
+
+TVM_REGISTER_GLOBAL("runtime.container._GetRaggedTensorOffsets")
+.set_body_typed([](RaggedTensor tensor) {
+  return tensor->offsets;
+});
+
 TVM_REGISTER_OBJECT_TYPE(ADTObj);
 TVM_REGISTER_OBJECT_TYPE(ClosureObj);
+TVM_REGISTER_OBJECT_TYPE(RaggedTensorObj);
 
 }  // namespace runtime
 }  // namespace tvm
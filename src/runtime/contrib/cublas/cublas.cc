@@ -22,8 +22,13 @@
  */
 #include <tvm/runtime/registry.h>
 #include <tvm/runtime/data_type.h>
+#include <tvm/runtime/device_api.h>
 #include <dmlc/logging.h>
+#include <map>
+#include <tuple>
+#include <vector>
 #include "../cblas/gemm_common.h"
+#include "../../cuda/cuda_common.h"
 #include "cublas_utils.h"
 
 
@@ -408,6 +413,145 @@ inline void CallBatchGemmEx(TVMArgs args, TVMRetValue *ret, cublasHandle_t hdl)
                                   batch_size, cuda_out_type, algo));
 }
 
+// Read a 1-D int32 array of problem sizes, on the host or the device.
+inline std::vector<int32_t> ReadGroupSizes(DLTensor* sizes) {
+  CHECK_EQ(sizes->ndim, 1);
+  CHECK(TypeMatch(sizes->dtype, kDLInt, 32)) << "Problem sizes must be int32";
+  std::vector<int32_t> ret(sizes->shape[0]);
+  const char* data = static_cast<const char*>(sizes->data) + sizes->byte_offset;
+  if (sizes->ctx.device_type == kDLCPU) {
+    std::copy(reinterpret_cast<const int32_t*>(data),
+              reinterpret_cast<const int32_t*>(data) + ret.size(), ret.begin());
+  } else {
+    auto stream = static_cast<cudaStream_t>(runtime::CUDAThreadEntry::ThreadLocal()->stream);
+    CUDA_CALL(cudaMemcpyAsync(ret.data(), data, ret.size() * sizeof(int32_t),
+                              cudaMemcpyDeviceToHost, stream));
+    CUDA_CALL(cudaStreamSynchronize(stream));
+  }
+  return ret;
+}
+
+// Grouped matrix multiplication of row major problems C_i = A_i B_i of
+// sizes M_i x N_i x K_i, such as the sequences of a ragged batch. The
+// operand matrices of the problems are stored back to back in A, B and C.
+// Problems of the same sizes are run by one cublasGemmBatchedEx over
+// pointer arrays, the others by cublasGemmEx.
+inline void CallGroupedGemmEx(TVMArgs args, TVMRetValue *ret, cublasHandle_t hdl) {
+  DLTensor *A = args[0];
+  DLTensor *B = args[1];
+  DLTensor *C = args[2];
+  std::vector<int32_t> ms = ReadGroupSizes(args[3]);
+  std::vector<int32_t> ns = ReadGroupSizes(args[4]);
+  std::vector<int32_t> ks = ReadGroupSizes(args[5]);
+  bool transa = args[6];
+  bool transb = args[7];
+  double alpha = args.size() > 8 ? args[8] : 1.0;
+  double beta = args.size() > 9 ? args[9] : 0.0;
+  CHECK_EQ(ns.size(), ms.size());
+  CHECK_EQ(ks.size(), ms.size());
+  CHECK(TypeEqual(A->dtype, B->dtype));
+  CHECK(TypeEqual(A->dtype, C->dtype) || CheckMixPrecisionType(A->dtype, C->dtype, false))
+      << "Unsupported data type";
+
+  cudaDataType_t cuda_in_type = GetCudaDataType(A->dtype);
+  cudaDataType_t cuda_out_type = GetCudaDataType(C->dtype);
+  cublasGemmAlgo_t algo = CUBLAS_GEMM_DEFAULT;
+  void *alpha_ptr = nullptr, *beta_ptr = nullptr;
+  auto alpha_float = static_cast<float>(alpha);
+  auto beta_float = static_cast<float>(beta);
+  if (TypeMatch(C->dtype, kDLFloat, 64)) {
+    alpha_ptr = &alpha;
+    beta_ptr = &beta;
+  } else {
+    alpha_ptr = &alpha_float;
+    beta_ptr = &beta_float;
+  }
+
+  int64_t A_elems = 1, B_elems = 1, C_elems = 1;
+  for (int i = 0; i < A->ndim; ++i) A_elems *= A->shape[i];
+  for (int i = 0; i < B->ndim; ++i) B_elems *= B->shape[i];
+  for (int i = 0; i < C->ndim; ++i) C_elems *= C->shape[i];
+  char* A_data = static_cast<char *>(A->data) + A->byte_offset;
+  char* B_data = static_cast<char *>(B->data) + B->byte_offset;
+  char* C_data = static_cast<char *>(C->data) + C->byte_offset;
+  size_t in_bytes = (A->dtype.bits * A->dtype.lanes + 7) / 8;
+  size_t out_bytes = (C->dtype.bits * C->dtype.lanes + 7) / 8;
+
+  // The operand pointers of the problems, grouped by size.
+  std::map<std::tuple<int32_t, int32_t, int32_t>, std::vector<size_t>> groups;
+  std::vector<const void*> A_ptrs(ms.size()), B_ptrs(ms.size());
+  std::vector<void*> C_ptrs(ms.size());
+  int64_t A_off = 0, B_off = 0, C_off = 0;
+  for (size_t i = 0; i < ms.size(); ++i) {
+    A_ptrs[i] = A_data + A_off * in_bytes;
+    B_ptrs[i] = B_data + B_off * in_bytes;
+    C_ptrs[i] = C_data + C_off * out_bytes;
+    A_off += static_cast<int64_t>(ms[i]) * ks[i];
+    B_off += static_cast<int64_t>(ks[i]) * ns[i];
+    C_off += static_cast<int64_t>(ms[i]) * ns[i];
+    if (ms[i] != 0 && ns[i] != 0) {
+      groups[std::make_tuple(ms[i], ns[i], ks[i])].push_back(i);
+    }
+  }
+  CHECK_LE(A_off, A_elems) << "The problems overrun A";
+  CHECK_LE(B_off, B_elems) << "The problems overrun B";
+  CHECK_LE(C_off, C_elems) << "The problems overrun C";
+
+  // Row major C = A B is computed as column major C^T = B^T A^T.
+  std::vector<const void*> batch_ptrs;
+  std::vector<std::pair<std::tuple<int32_t, int32_t, int32_t>, size_t>> batches;
+  for (const auto& group : groups) {
+    int32_t M, N, K;
+    std::tie(M, N, K) = group.first;
+    const std::vector<size_t>& probs = group.second;
+    if (probs.size() == 1) {
+      size_t i = probs[0];
+      CHECK_CUBLAS_ERROR(cublasGemmEx(hdl,
+                                      BooleanToTranspose(transb),
+                                      BooleanToTranspose(transa),
+                                      N, M, K,
+                                      alpha_ptr,
+                                      B_ptrs[i], cuda_in_type, transb ? K : N,
+                                      A_ptrs[i], cuda_in_type, transa ? M : K,
+                                      beta_ptr,
+                                      C_ptrs[i], cuda_out_type, N,
+                                      cuda_out_type, algo));
+      continue;
+    }
+    batches.emplace_back(group.first, batch_ptrs.size());
+    for (size_t i : probs) batch_ptrs.push_back(B_ptrs[i]);
+    for (size_t i : probs) batch_ptrs.push_back(A_ptrs[i]);
+    for (size_t i : probs) batch_ptrs.push_back(C_ptrs[i]);
+  }
+  if (batches.empty()) return;
+
+  // The pointer arrays of all batches go to the device in one copy.
+  TVMContext ctx = C->ctx;
+  size_t ptr_bytes = batch_ptrs.size() * sizeof(void*);
+  auto stream = static_cast<cudaStream_t>(runtime::CUDAThreadEntry::ThreadLocal()->stream);
+  void** dev_ptrs = static_cast<void**>(
+      runtime::DeviceAPI::Get(ctx)->AllocWorkspace(ctx, ptr_bytes));
+  CUDA_CALL(cudaMemcpyAsync(dev_ptrs, batch_ptrs.data(), ptr_bytes,
+                            cudaMemcpyHostToDevice, stream));
+  for (const auto& batch : batches) {
+    int32_t M, N, K;
+    std::tie(M, N, K) = batch.first;
+    int count = static_cast<int>(groups[batch.first].size());
+    void** ptrs = dev_ptrs + batch.second;
+    CHECK_CUBLAS_ERROR(cublasGemmBatchedEx(hdl,
+                                           BooleanToTranspose(transb),
+                                           BooleanToTranspose(transa),
+                                           N, M, K,
+                                           alpha_ptr,
+                                           ptrs, cuda_in_type, transb ? K : N,
+                                           ptrs + count, cuda_in_type, transa ? M : K,
+                                           beta_ptr,
+                                           ptrs + 2 * count, cuda_out_type, N,
+                                           count, cuda_out_type, algo));
+  }
+  runtime::DeviceAPI::Get(ctx)->FreeWorkspace(ctx, dev_ptrs);
+}
+
 // matrix multiplication for row major
 TVM_REGISTER_GLOBAL("tvm.contrib.cublas.matmul")
 .set_body([](TVMArgs args, TVMRetValue *ret) {
@@ -475,5 +619,14 @@ TVM_REGISTER_GLOBAL("tvm.contrib.cublas.batch_matmul")
     }
 });
 
+// grouped matrix multiplication of problems of varying sizes, for row major
+TVM_REGISTER_GLOBAL("tvm.contrib.cublas.grouped_matmul")
+.set_body([](TVMArgs args, TVMRetValue* ret) {
+    CuBlasThreadEntry* entry_ptr = CuBlasThreadEntry::ThreadLocal();
+
+    TryEnableTensorCore(entry_ptr->handle);
+    CallGroupedGemmEx(args, ret, entry_ptr->handle);
+});
+
 }  // namespace contrib
 }  // namespace tvm
@@ -23,6 +23,7 @@
 #include "cudnn_utils.h"
 #include <dmlc/thread_local.h>
 #include <tvm/runtime/registry.h>
+#include <algorithm>
 
 
 namespace tvm {
@@ -86,6 +87,24 @@ const void* CuDNNDataType::GetConst<1>(cudnnDataType_t type) {
   return nullptr;
 }
 
+std::vector<int> ReadSeqLengths(DLTensor* lengths) {
+  CHECK_EQ(lengths->ndim, 1) << "Sequence lengths must be 1-D";
+  CHECK(lengths->dtype.code == kDLInt && lengths->dtype.bits == 32 && lengths->dtype.lanes == 1)
+      << "Sequence lengths must be int32";
+  std::vector<int> ret(lengths->shape[0]);
+  const char* data = static_cast<const char*>(lengths->data) + lengths->byte_offset;
+  if (lengths->ctx.device_type == kDLCPU) {
+    std::copy(reinterpret_cast<const int*>(data),
+              reinterpret_cast<const int*>(data) + ret.size(), ret.begin());
+  } else {
+    auto stream = static_cast<cudaStream_t>(runtime::CUDAThreadEntry::ThreadLocal()->stream);
+    CUDA_CALL(cudaMemcpyAsync(ret.data(), data, ret.size() * sizeof(int),
+                              cudaMemcpyDeviceToHost, stream));
+    CUDA_CALL(cudaStreamSynchronize(stream));
+  }
+  return ret;
+}
+
 // CuDNNThreadEntry
 
 CuDNNThreadEntry::CuDNNThreadEntry() {
@@ -27,6 +27,7 @@
 #include <dmlc/logging.h>
 #include <cudnn.h>
 #include <tvm/runtime/device_api.h>
+#include <vector>
 #include "../../cuda/cuda_common.h"
 
 
@@ -64,6 +65,12 @@ inline void GetCudnnStride(int nbdim,
   }
 }
 
+/*!
+ * \brief Read a 1-D int32 array of sequence lengths, such as the lengths
+ *  of a ragged dimension, on the host or the device.
+ */
+std::vector<int> ReadSeqLengths(DLTensor* lengths);
+
 struct ConvEntry {
   cudnnConvolutionDescriptor_t conv_desc;
   cudnnConvolutionMode_t mode;
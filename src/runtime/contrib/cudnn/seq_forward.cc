@@ -0,0 +1,371 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file Use external cudnn variable sequence length RNN and multi-head
+ *  attention functions
+ *
+ *  The sequences are stored padded and batch major, i.e. as
+ *  (batch, max_seq_len, vector) tensors, and their lengths are given by a
+ *  1-D int32 array, such as the lengths of a ragged dimension. Only the
+ *  first length[i] steps of sequence i are read and written.
+ */
+#include <tvm/runtime/registry.h>
+#include <tvm/runtime/data_type.h>
+#include <tvm/runtime/device_api.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "cudnn_utils.h"
+
+namespace tvm {
+namespace contrib {
+
+using namespace runtime;
+
+// RNN
+
+struct RNNDescs {
+  cudnnDropoutDescriptor_t dropout_desc;
+  cudnnRNNDescriptor_t rnn_desc;
+  cudnnTensorDescriptor_t step_desc;
+  cudnnTensorDescriptor_t state_desc;
+  cudnnDataType_t data_type;
+
+  RNNDescs(cudnnHandle_t handle, DLDataType dtype, int batch, int input_size, int hidden_size,
+           int num_layers, int mode, bool bidirectional) {
+    data_type = CuDNNDataType::DLTypeToCuDNNType(dtype);
+    CUDNN_CALL(cudnnCreateDropoutDescriptor(&dropout_desc));
+    CUDNN_CALL(cudnnCreateRNNDescriptor(&rnn_desc));
+    CUDNN_CALL(cudnnCreateTensorDescriptor(&step_desc));
+    CUDNN_CALL(cudnnCreateTensorDescriptor(&state_desc));
+    CUDNN_CALL(cudnnSetDropoutDescriptor(dropout_desc, handle, 0.f, nullptr, 0, 0));
+    CUDNN_CALL(cudnnSetRNNDescriptor_v6(handle, rnn_desc, hidden_size, num_layers, dropout_desc,
+                                        CUDNN_LINEAR_INPUT,
+                                        bidirectional ? CUDNN_BIDIRECTIONAL : CUDNN_UNIDIRECTIONAL,
+                                        static_cast<cudnnRNNMode_t>(mode),
+                                        CUDNN_RNN_ALGO_STANDARD, data_type));
+    CUDNN_CALL(cudnnSetRNNPaddingMode(rnn_desc, CUDNN_RNN_PADDED_IO_ENABLED));
+    int step_dim[3] = {batch, input_size, 1};
+    int step_stride[3];
+    GetCudnnStride(3, step_dim, step_stride);
+    CUDNN_CALL(cudnnSetTensorNdDescriptor(step_desc, data_type, 3, step_dim, step_stride));
+    int state_dim[3] = {num_layers * (bidirectional ? 2 : 1), batch, hidden_size};
+    int state_stride[3];
+    GetCudnnStride(3, state_dim, state_stride);
+    CUDNN_CALL(cudnnSetTensorNdDescriptor(state_desc, data_type, 3, state_dim, state_stride));
+  }
+
+  ~RNNDescs() {
+    CUDNN_CALL(cudnnDestroyTensorDescriptor(state_desc));
+    CUDNN_CALL(cudnnDestroyTensorDescriptor(step_desc));
+    CUDNN_CALL(cudnnDestroyRNNDescriptor(rnn_desc));
+    CUDNN_CALL(cudnnDestroyDropoutDescriptor(dropout_desc));
+  }
+
+  size_t ParamsSize(cudnnHandle_t handle) {
+    size_t size;
+    CUDNN_CALL(cudnnGetRNNParamsSize(handle, rnn_desc, step_desc, &size, data_type));
+    return size;
+  }
+};
+
+void RNNForward(DLTensor* x, DLTensor* w, DLTensor* lengths, DLTensor* y,
+                int hidden_size, int num_layers, int mode, bool bidirectional) {
+  CuDNNThreadEntry* entry_ptr = CuDNNThreadEntry::ThreadLocal();
+  cudnnHandle_t handle = entry_ptr->handle;
+  CHECK_EQ(x->ndim, 3) << "x must be (batch, max_seq_len, input_size)";
+  CHECK_EQ(y->ndim, 3) << "y must be (batch, max_seq_len, hidden_size * num_directions)";
+  int batch = static_cast<int>(x->shape[0]);
+  int max_len = static_cast<int>(x->shape[1]);
+  int input_size = static_cast<int>(x->shape[2]);
+  int out_size = hidden_size * (bidirectional ? 2 : 1);
+  CHECK_EQ(y->shape[0], batch);
+  CHECK_EQ(y->shape[1], max_len);
+  CHECK_EQ(y->shape[2], out_size);
+  std::vector<int> seq_lengths = ReadSeqLengths(lengths);
+  CHECK_EQ(seq_lengths.size(), static_cast<size_t>(batch))
+      << "One sequence length is needed per batch element";
+  for (int len : seq_lengths) {
+    CHECK(len >= 0 && len <= max_len) << "Sequence length " << len << " out of range";
+  }
+
+  RNNDescs descs(handle, x->dtype, batch, input_size, hidden_size, num_layers, mode,
+                 bidirectional);
+  size_t params_size = descs.ParamsSize(handle);
+  int64_t w_elems = 1;
+  for (int i = 0; i < w->ndim; ++i) w_elems *= w->shape[i];
+  CHECK_EQ(static_cast<size_t>(w_elems * ((w->dtype.bits + 7) / 8)), params_size)
+      << "The weights do not match the RNN, see rnn_params_size";
+
+  cudnnFilterDescriptor_t w_desc;
+  cudnnRNNDataDescriptor_t x_desc, y_desc;
+  CUDNN_CALL(cudnnCreateFilterDescriptor(&w_desc));
+  CUDNN_CALL(cudnnCreateRNNDataDescriptor(&x_desc));
+  CUDNN_CALL(cudnnCreateRNNDataDescriptor(&y_desc));
+  int w_dim[3] = {static_cast<int>(w_elems), 1, 1};
+  CUDNN_CALL(cudnnSetFilterNdDescriptor(w_desc, descs.data_type, CUDNN_TENSOR_NCHW, 3, w_dim));
+  // The padding of the output is zeroed.
+  void* padding_fill = const_cast<void*>(CuDNNDataType::GetConst<0>(descs.data_type));
+  CUDNN_CALL(cudnnSetRNNDataDescriptor(x_desc, descs.data_type,
+                                       CUDNN_RNN_DATA_LAYOUT_BATCH_MAJOR_UNPACKED,
+                                       max_len, batch, input_size, seq_lengths.data(),
+                                       padding_fill));
+  CUDNN_CALL(cudnnSetRNNDataDescriptor(y_desc, descs.data_type,
+                                       CUDNN_RNN_DATA_LAYOUT_BATCH_MAJOR_UNPACKED,
+                                       max_len, batch, out_size, seq_lengths.data(),
+                                       padding_fill));
+
+  // The workspace size query still takes one descriptor per time step.
+  std::vector<cudnnTensorDescriptor_t> step_descs(max_len, descs.step_desc);
+  size_t workspace_size;
+  CUDNN_CALL(cudnnGetRNNWorkspaceSize(handle, descs.rnn_desc, max_len, step_descs.data(),
+                                      &workspace_size));
+  void* workspace = nullptr;
+  if (workspace_size > 0) {
+    workspace = entry_ptr->cuda_api->AllocWorkspace(x->ctx, workspace_size);
+  }
+
+  // The initial states are zero and the final states are not returned.
+  CUDNN_CALL(cudnnRNNForwardInferenceEx(handle, descs.rnn_desc,
+                                        x_desc, x->data,
+                                        descs.state_desc, nullptr,
+                                        descs.state_desc, nullptr,
+                                        w_desc, w->data,
+                                        y_desc, y->data,
+                                        descs.state_desc, nullptr,
+                                        descs.state_desc, nullptr,
+                                        nullptr, nullptr, nullptr, nullptr,
+                                        nullptr, nullptr, nullptr, nullptr,
+                                        workspace, workspace_size));
+
+  if (workspace != nullptr) entry_ptr->cuda_api->FreeWorkspace(x->ctx, workspace);
+  CUDNN_CALL(cudnnDestroyRNNDataDescriptor(y_desc));
+  CUDNN_CALL(cudnnDestroyRNNDataDescriptor(x_desc));
+  CUDNN_CALL(cudnnDestroyFilterDescriptor(w_desc));
+}
+
+// Multi-head attention
+
+struct AttnDescs {
+  cudnnAttnDescriptor_t attn_desc;
+  cudnnDataType_t data_type;
+
+  AttnDescs(DLDataType dtype, int num_heads, double sm_scaler,
+            int q_size, int k_size, int v_size,
+            int q_proj_size, int k_proj_size, int v_proj_size, int o_proj_size,
+            int max_qo_len, int max_kv_len, int batch) {
+    data_type = CuDNNDataType::DLTypeToCuDNNType(dtype);
+    cudnnDataType_t comp_prec = data_type == CUDNN_DATA_DOUBLE ? CUDNN_DATA_DOUBLE
+                                                               : CUDNN_DATA_FLOAT;
+    CUDNN_CALL(cudnnCreateAttnDescriptor(&attn_desc));
+    CUDNN_CALL(cudnnSetAttnDescriptor(attn_desc,
+                                      CUDNN_ATTN_QUERYMAP_ALL_TO_ONE |
+                                      CUDNN_ATTN_DISABLE_PROJ_BIASES,
+                                      num_heads, sm_scaler, data_type, comp_prec,
+                                      CUDNN_DEFAULT_MATH, nullptr, nullptr,
+                                      q_size, k_size, v_size,
+                                      q_proj_size, k_proj_size, v_proj_size, o_proj_size,
+                                      max_qo_len, max_kv_len, batch, 1));
+  }
+
+  ~AttnDescs() {
+    CUDNN_CALL(cudnnDestroyAttnDescriptor(attn_desc));
+  }
+
+  void BufferSizes(cudnnHandle_t handle, size_t* weights_size, size_t* workspace_size) {
+    CUDNN_CALL(cudnnGetMultiHeadAttnBuffers(handle, attn_desc, weights_size, workspace_size,
+                                            nullptr));
+  }
+};
+
+// Describe a padded, batch major (batch, max_seq_len, vector) sequence tensor.
+void SetSeqDataDescriptor(cudnnSeqDataDescriptor_t desc, cudnnDataType_t data_type,
+                          DLTensor* t, const std::vector<int>& seq_lengths) {
+  CHECK_EQ(t->ndim, 3) << "Sequence data must be (batch, max_seq_len, vector)";
+  int dim[CUDNN_SEQDATA_DIM_COUNT];
+  dim[CUDNN_SEQDATA_TIME_DIM] = static_cast<int>(t->shape[1]);
+  dim[CUDNN_SEQDATA_BATCH_DIM] = static_cast<int>(t->shape[0]);
+  dim[CUDNN_SEQDATA_BEAM_DIM] = 1;
+  dim[CUDNN_SEQDATA_VECT_DIM] = static_cast<int>(t->shape[2]);
+  cudnnSeqDataAxis_t axes[CUDNN_SEQDATA_DIM_COUNT] = {
+    CUDNN_SEQDATA_BATCH_DIM, CUDNN_SEQDATA_BEAM_DIM, CUDNN_SEQDATA_TIME_DIM,
+    CUDNN_SEQDATA_VECT_DIM};
+  CHECK_EQ(static_cast<int64_t>(seq_lengths.size()), t->shape[0])
+      << "One sequence length is needed per batch element";
+  for (int len : seq_lengths) {
+    CHECK(len >= 0 && len <= t->shape[1]) << "Sequence length " << len << " out of range";
+  }
+  CUDNN_CALL(cudnnSetSeqDataDescriptor(desc, data_type, CUDNN_SEQDATA_DIM_COUNT, dim, axes,
+                                       static_cast<size_t>(seq_lengths.size()),
+                                       seq_lengths.data(), nullptr));
+}
+
+void MultiHeadAttnForward(DLTensor* q, DLTensor* k, DLTensor* v, DLTensor* w,
+                          DLTensor* qo_lengths, DLTensor* kv_lengths, DLTensor* out,
+                          int num_heads, int q_proj_size, int k_proj_size, int v_proj_size,
+                          int o_proj_size, double sm_scaler, bool causal) {
+  CuDNNThreadEntry* entry_ptr = CuDNNThreadEntry::ThreadLocal();
+  cudnnHandle_t handle = entry_ptr->handle;
+  int batch = static_cast<int>(q->shape[0]);
+  int max_qo_len = static_cast<int>(q->shape[1]);
+  int max_kv_len = static_cast<int>(k->shape[1]);
+  CHECK_EQ(k->shape[0], batch);
+  CHECK_EQ(v->shape[0], batch);
+  CHECK_EQ(v->shape[1], max_kv_len);
+
+  AttnDescs descs(q->dtype, num_heads, sm_scaler,
+                  static_cast<int>(q->shape[2]), static_cast<int>(k->shape[2]),
+                  static_cast<int>(v->shape[2]),
+                  q_proj_size, k_proj_size, v_proj_size, o_proj_size,
+                  max_qo_len, max_kv_len, batch);
+  size_t weights_size, workspace_size;
+  descs.BufferSizes(handle, &weights_size, &workspace_size);
+  int64_t w_elems = 1;
+  for (int i = 0; i < w->ndim; ++i) w_elems *= w->shape[i];
+  CHECK_EQ(static_cast<size_t>(w_elems * ((w->dtype.bits + 7) / 8)), weights_size)
+      << "The weights do not match the attention, see multi_head_attn_weights_size";
+
+  std::vector<int> qo_lens = ReadSeqLengths(qo_lengths);
+  std::vector<int> kv_lens = ReadSeqLengths(kv_lengths);
+  cudnnSeqDataDescriptor_t q_desc, k_desc, v_desc, o_desc;
+  CUDNN_CALL(cudnnCreateSeqDataDescriptor(&q_desc));
+  CUDNN_CALL(cudnnCreateSeqDataDescriptor(&k_desc));
+  CUDNN_CALL(cudnnCreateSeqDataDescriptor(&v_desc));
+  CUDNN_CALL(cudnnCreateSeqDataDescriptor(&o_desc));
+  SetSeqDataDescriptor(q_desc, descs.data_type, q, qo_lens);
+  SetSeqDataDescriptor(k_desc, descs.data_type, k, kv_lens);
+  SetSeqDataDescriptor(v_desc, descs.data_type, v, kv_lens);
+  SetSeqDataDescriptor(o_desc, descs.data_type, out, qo_lens);
+
+  // Query i attends to the keys [lo_win[i], hi_win[i]).
+  std::vector<int> lo_win(max_qo_len, 0);
+  std::vector<int> hi_win(max_qo_len, max_kv_len);
+  if (causal) {
+    for (int i = 0; i < max_qo_len; ++i) hi_win[i] = std::min(i + 1, max_kv_len);
+  }
+
+  // The lengths are also needed on the device. They go there in one copy,
+  // after the workspace.
+  size_t aligned_ws = (workspace_size + 255) / 256 * 256;
+  size_t lens_bytes = (qo_lens.size() + kv_lens.size()) * sizeof(int);
+  char* workspace = static_cast<char*>(
+      entry_ptr->cuda_api->AllocWorkspace(q->ctx, aligned_ws + lens_bytes));
+  int* dev_qo_lens = reinterpret_cast<int*>(workspace + aligned_ws);
+  int* dev_kv_lens = dev_qo_lens + qo_lens.size();
+  std::vector<int> all_lens(qo_lens);
+  all_lens.insert(all_lens.end(), kv_lens.begin(), kv_lens.end());
+  auto stream = static_cast<cudaStream_t>(CUDAThreadEntry::ThreadLocal()->stream);
+  CUDA_CALL(cudaMemcpyAsync(dev_qo_lens, all_lens.data(), lens_bytes,
+                            cudaMemcpyHostToDevice, stream));
+
+  CUDNN_CALL(cudnnMultiHeadAttnForward(handle, descs.attn_desc, -1,
+                                       lo_win.data(), hi_win.data(),
+                                       dev_qo_lens, dev_kv_lens,
+                                       q_desc, q->data, nullptr,
+                                       k_desc, k->data,
+                                       v_desc, v->data,
+                                       o_desc, out->data,
+                                       weights_size, w->data,
+                                       workspace_size, workspace_size > 0 ? workspace : nullptr,
+                                       0, nullptr));
+
+  entry_ptr->cuda_api->FreeWorkspace(q->ctx, workspace);
+  CUDNN_CALL(cudnnDestroySeqDataDescriptor(o_desc));
+  CUDNN_CALL(cudnnDestroySeqDataDescriptor(v_desc));
+  CUDNN_CALL(cudnnDestroySeqDataDescriptor(k_desc));
+  CUDNN_CALL(cudnnDestroySeqDataDescriptor(q_desc));
+}
+
+
+TVM_REGISTER_GLOBAL("tvm.contrib.cudnn.rnn.forward")
+.set_body([](TVMArgs args, TVMRetValue *ret) {
+  DLTensor* x = args[0];
+  DLTensor* w = args[1];
+  DLTensor* lengths = args[2];
+  DLTensor* y = args[3];
+  int hidden_size = args[4];
+  int num_layers = args[5];
+  int mode = args[6];
+  bool bidirectional = args[7];
+
+  RNNForward(x, w, lengths, y, hidden_size, num_layers, mode, bidirectional);
+});
+
+
+TVM_REGISTER_GLOBAL("tvm.contrib.cudnn.rnn.params_size")
+.set_body([](TVMArgs args, TVMRetValue *ret) {
+  int input_size = args[0];
+  int hidden_size = args[1];
+  int num_layers = args[2];
+  int mode = args[3];
+  bool bidirectional = args[4];
+  std::string dtype = args[5];
+
+  CuDNNThreadEntry* entry_ptr = CuDNNThreadEntry::ThreadLocal();
+  RNNDescs descs(entry_ptr->handle, String2DLDataType(dtype), 1, input_size, hidden_size,
+                 num_layers, mode, bidirectional);
+  *ret = static_cast<int64_t>(descs.ParamsSize(entry_ptr->handle));
+});
+
+
+TVM_REGISTER_GLOBAL("tvm.contrib.cudnn.multi_head_attn.forward")
+.set_body([](TVMArgs args, TVMRetValue *ret) {
+  DLTensor* q = args[0];
+  DLTensor* k = args[1];
+  DLTensor* v = args[2];
+  DLTensor* w = args[3];
+  DLTensor* qo_lengths = args[4];
+  DLTensor* kv_lengths = args[5];
+  DLTensor* out = args[6];
+  int num_heads = args[7];
+  int q_proj_size = args[8];
+  int k_proj_size = args[9];
+  int v_proj_size = args[10];
+  int o_proj_size = args[11];
+  double sm_scaler = args[12];
+  bool causal = args[13];
+
+  MultiHeadAttnForward(q, k, v, w, qo_lengths, kv_lengths, out, num_heads,
+                       q_proj_size, k_proj_size, v_proj_size, o_proj_size, sm_scaler, causal);
+});
+
+
+TVM_REGISTER_GLOBAL("tvm.contrib.cudnn.multi_head_attn.weights_size")
+.set_body([](TVMArgs args, TVMRetValue *ret) {
+  int q_size = args[0];
+  int k_size = args[1];
+  int v_size = args[2];
+  int num_heads = args[3];
+  int q_proj_size = args[4];
+  int k_proj_size = args[5];
+  int v_proj_size = args[6];
+  int o_proj_size = args[7];
+  std::string dtype = args[8];
+
+  CuDNNThreadEntry* entry_ptr = CuDNNThreadEntry::ThreadLocal();
+  AttnDescs descs(String2DLDataType(dtype), num_heads, 1.0, q_size, k_size, v_size,
+                  q_proj_size, k_proj_size, v_proj_size, o_proj_size, 1, 1, 1);
+  size_t weights_size, workspace_size;
+  descs.BufferSizes(entry_ptr->handle, &weights_size, &workspace_size);
+  *ret = static_cast<int64_t>(weights_size);
+});
+
+}  // namespace contrib
+}  // namespace tvm
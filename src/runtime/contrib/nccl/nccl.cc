@@ -0,0 +1,281 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file Use external nccl library call.
+ */
+#include <tvm/runtime/registry.h>
+#include <tvm/runtime/data_type.h>
+#include <tvm/runtime/device_api.h>
+#include <dmlc/logging.h>
+#include <nccl.h>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../../cuda/cuda_common.h"
+
+#define CHECK_NCCL_ERROR(fn)                                          \
+  do {                                                                \
+    ncclResult_t error = (fn);                                        \
+    CHECK_EQ(error, ncclSuccess) << "NCCL: " << ncclGetErrorString(error); \
+  } while (0)
+
+namespace tvm {
+namespace contrib {
+
+using namespace runtime;
+
+/*!
+ * \brief The communicators of this process, by communicator id and
+ *  device. A process may drive one rank, or one rank per device.
+ */
+class NCCLCommRegistry {
+ public:
+  static NCCLCommRegistry* Global() {
+    static NCCLCommRegistry* inst = new NCCLCommRegistry();
+    return inst;
+  }
+
+  void Add(int comm_id, int device_id, ncclComm_t comm) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto key = std::make_pair(comm_id, device_id);
+    CHECK(!comms_.count(key)) << "NCCL communicator " << comm_id
+                              << " is already initialized on device " << device_id;
+    comms_[key] = comm;
+  }
+
+  ncclComm_t Get(int comm_id, int device_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = comms_.find(std::make_pair(comm_id, device_id));
+    CHECK(it != comms_.end()) << "NCCL communicator " << comm_id
+                              << " is not initialized on device " << device_id;
+    return it->second;
+  }
+
+  void Destroy(int comm_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = comms_.begin(); it != comms_.end();) {
+      if (it->first.first == comm_id) {
+        CHECK_NCCL_ERROR(ncclCommDestroy(it->second));
+        it = comms_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+ private:
+  std::mutex mutex_;
+  std::map<std::pair<int, int>, ncclComm_t> comms_;
+};
+
+inline ncclDataType_t NCCLDataType(DLDataType dtype) {
+  CHECK_EQ(dtype.lanes, 1) << "NCCL collectives expect scalar types";
+  if (dtype.code == kDLFloat) {
+    if (dtype.bits == 16) return ncclFloat16;
+    if (dtype.bits == 32) return ncclFloat32;
+    if (dtype.bits == 64) return ncclFloat64;
+  } else if (dtype.code == kDLInt) {
+    if (dtype.bits == 8) return ncclInt8;
+    if (dtype.bits == 32) return ncclInt32;
+    if (dtype.bits == 64) return ncclInt64;
+  } else if (dtype.code == kDLUInt) {
+    if (dtype.bits == 8) return ncclUint8;
+    if (dtype.bits == 32) return ncclUint32;
+    if (dtype.bits == 64) return ncclUint64;
+  }
+  LOG(FATAL) << "Unsupported NCCL data type " << DLDataType2String(dtype);
+  return ncclFloat32;
+}
+
+inline ncclRedOp_t NCCLRedOp(const std::string& op) {
+  if (op == "sum") return ncclSum;
+  if (op == "prod") return ncclProd;
+  if (op == "max") return ncclMax;
+  if (op == "min") return ncclMin;
+  LOG(FATAL) << "Unsupported NCCL reduction " << op;
+  return ncclSum;
+}
+
+inline size_t NumElements(const DLTensor* t, int begin_dim) {
+  size_t size = 1;
+  for (int i = begin_dim; i < t->ndim; ++i) size *= static_cast<size_t>(t->shape[i]);
+  return size;
+}
+
+/*!
+ * \brief The per rank row counts of a ragged collective. The counts
+ *  are usually the prefix of the lengths the kernels already read from
+ *  the device, in which case they are copied back on the stream, which
+ *  waits for the kernels that produce them.
+ */
+std::vector<int64_t> ReadCounts(const DLTensor* counts, int nranks, cudaStream_t stream) {
+  CHECK_EQ(counts->ndim, 1);
+  CHECK_EQ(counts->shape[0], nranks) << "Expect one count per rank";
+  CHECK(counts->dtype.code == kDLInt && (counts->dtype.bits == 32 || counts->dtype.bits == 64));
+  size_t nbytes = nranks * (counts->dtype.bits / 8);
+  std::vector<char> host(nbytes);
+  const char* src = static_cast<const char*>(counts->data) + counts->byte_offset;
+  if (counts->ctx.device_type == kDLCPU) {
+    std::memcpy(host.data(), src, nbytes);
+  } else {
+    CUDA_CALL(cudaSetDevice(counts->ctx.device_id));
+    CUDA_CALL(cudaMemcpyAsync(host.data(), src, nbytes, cudaMemcpyDeviceToHost, stream));
+    CUDA_CALL(cudaStreamSynchronize(stream));
+  }
+  std::vector<int64_t> ret(nranks);
+  for (int i = 0; i < nranks; ++i) {
+    ret[i] = counts->dtype.bits == 32 ? reinterpret_cast<int32_t*>(host.data())[i]
+                                      : reinterpret_cast<int64_t*>(host.data())[i];
+  }
+  return ret;
+}
+
+// A ragged collective: rank r owns counts[r] rows of the full tensor,
+// starting at the prefix sum of the counts before it.
+struct RaggedCollective {
+  ncclComm_t comm;
+  cudaStream_t stream;
+  int rank;
+  int nranks;
+  std::vector<int64_t> counts;
+  std::vector<int64_t> offsets;
+
+  RaggedCollective(int comm_id, const DLTensor* data, const DLTensor* counts_arr) {
+    CHECK_EQ(data->ctx.device_type, kDLGPU) << "NCCL collectives expect GPU tensors";
+    comm = NCCLCommRegistry::Global()->Get(comm_id, data->ctx.device_id);
+    stream = static_cast<cudaStream_t>(CUDAThreadEntry::ThreadLocal()->stream);
+    CHECK_NCCL_ERROR(ncclCommUserRank(comm, &rank));
+    CHECK_NCCL_ERROR(ncclCommCount(comm, &nranks));
+    counts = ReadCounts(counts_arr, nranks, stream);
+    offsets.resize(nranks + 1, 0);
+    for (int i = 0; i < nranks; ++i) offsets[i + 1] = offsets[i] + counts[i];
+    CUDA_CALL(cudaSetDevice(data->ctx.device_id));
+  }
+};
+
+TVM_REGISTER_GLOBAL("tvm.contrib.nccl.get_unique_id")
+.set_body([](TVMArgs args, TVMRetValue* ret) {
+    ncclUniqueId id;
+    CHECK_NCCL_ERROR(ncclGetUniqueId(&id));
+    TVMByteArray arr;
+    arr.data = id.internal;
+    arr.size = sizeof(id.internal);
+    *ret = arr;
+});
+
+// One rank of a communicator that spans processes.
+TVM_REGISTER_GLOBAL("tvm.contrib.nccl.init_rank")
+.set_body([](TVMArgs args, TVMRetValue* ret) {
+    int comm_id = args[0];
+    int device_id = args[1];
+    int nranks = args[2];
+    int rank = args[3];
+    std::string id_bytes = args[4];
+    ncclUniqueId id;
+    CHECK_EQ(id_bytes.size(), sizeof(id.internal)) << "Invalid NCCL unique id";
+    std::memcpy(id.internal, id_bytes.data(), sizeof(id.internal));
+    CUDA_CALL(cudaSetDevice(device_id));
+    ncclComm_t comm;
+    CHECK_NCCL_ERROR(ncclCommInitRank(&comm, nranks, id, rank));
+    NCCLCommRegistry::Global()->Add(comm_id, device_id, comm);
+});
+
+// All the ranks of a communicator, one per device of this process.
+TVM_REGISTER_GLOBAL("tvm.contrib.nccl.init_all")
+.set_body([](TVMArgs args, TVMRetValue* ret) {
+    int comm_id = args[0];
+    std::vector<int> devices;
+    for (int i = 1; i < args.num_args; ++i) devices.push_back(args[i]);
+    std::vector<ncclComm_t> comms(devices.size());
+    CHECK_NCCL_ERROR(ncclCommInitAll(comms.data(), static_cast<int>(devices.size()),
+                                     devices.data()));
+    for (size_t i = 0; i < devices.size(); ++i) {
+      NCCLCommRegistry::Global()->Add(comm_id, devices[i], comms[i]);
+    }
+});
+
+TVM_REGISTER_GLOBAL("tvm.contrib.nccl.destroy")
+.set_body([](TVMArgs args, TVMRetValue* ret) {
+    NCCLCommRegistry::Global()->Destroy(args[0]);
+});
+
+// Gathers counts[r] rows from every rank r into the output of every
+// rank. NCCL has no all-gather with per rank counts, so it is a group
+// of broadcasts, one rooted at each rank.
+TVM_REGISTER_GLOBAL("tvm.contrib.nccl.all_gatherv")
+.set_body([](TVMArgs args, TVMRetValue* ret) {
+    DLTensor* input = args[0];
+    DLTensor* counts = args[1];
+    DLTensor* output = args[2];
+    int comm_id = args[3];
+    CHECK(TypeEqual(input->dtype, output->dtype));
+    RaggedCollective coll(comm_id, output, counts);
+    size_t row = NumElements(output, 1);
+    size_t elem_bytes = output->dtype.bits / 8;
+    CHECK_EQ(NumElements(input, 1), row) << "Expect rows of the same size";
+    CHECK_EQ(input->shape[0], coll.counts[coll.rank]) << "Expect counts[rank] input rows";
+    CHECK_GE(output->shape[0], coll.offsets[coll.nranks]) << "Output has too few rows";
+    char* in_ptr = static_cast<char*>(input->data) + input->byte_offset;
+    char* out_ptr = static_cast<char*>(output->data) + output->byte_offset;
+    ncclDataType_t dtype = NCCLDataType(output->dtype);
+    CHECK_NCCL_ERROR(ncclGroupStart());
+    for (int r = 0; r < coll.nranks; ++r) {
+      if (coll.counts[r] == 0) continue;
+      CHECK_NCCL_ERROR(ncclBroadcast(in_ptr, out_ptr + coll.offsets[r] * row * elem_bytes,
+                                     coll.counts[r] * row, dtype, r, coll.comm, coll.stream));
+    }
+    CHECK_NCCL_ERROR(ncclGroupEnd());
+});
+
+// Reduces the rows of the input over all ranks, and leaves rank r with
+// the counts[r] rows of the result that it owns, as a group of
+// reductions, one rooted at each rank.
+TVM_REGISTER_GLOBAL("tvm.contrib.nccl.reduce_scatterv")
+.set_body([](TVMArgs args, TVMRetValue* ret) {
+    DLTensor* input = args[0];
+    DLTensor* counts = args[1];
+    DLTensor* output = args[2];
+    int comm_id = args[3];
+    std::string op = args.num_args > 4 ? args[4].operator std::string() : "sum";
+    CHECK(TypeEqual(input->dtype, output->dtype));
+    RaggedCollective coll(comm_id, input, counts);
+    size_t row = NumElements(input, 1);
+    size_t elem_bytes = input->dtype.bits / 8;
+    CHECK_EQ(NumElements(output, 1), row) << "Expect rows of the same size";
+    CHECK_GE(input->shape[0], coll.offsets[coll.nranks]) << "Input has too few rows";
+    CHECK_GE(output->shape[0], coll.counts[coll.rank]) << "Output has too few rows";
+    char* in_ptr = static_cast<char*>(input->data) + input->byte_offset;
+    char* out_ptr = static_cast<char*>(output->data) + output->byte_offset;
+    ncclDataType_t dtype = NCCLDataType(input->dtype);
+    ncclRedOp_t red = NCCLRedOp(op);
+    CHECK_NCCL_ERROR(ncclGroupStart());
+    for (int r = 0; r < coll.nranks; ++r) {
+      if (coll.counts[r] == 0) continue;
+      CHECK_NCCL_ERROR(ncclReduce(in_ptr + coll.offsets[r] * row * elem_bytes, out_ptr,
+                                  coll.counts[r] * row, dtype, red, r, coll.comm, coll.stream));
+    }
+    CHECK_NCCL_ERROR(ncclGroupEnd());
+});
+
+}  // namespace contrib
+}  // namespace tvm
@@ -24,6 +24,7 @@
 #include <tvm/runtime/registry.h>
 #include <dlpack/dlpack.h>
 #include <algorithm>
+#include <string>
 #include <vector>
 
 namespace tvm {
@@ -388,5 +389,226 @@ TVM_REGISTER_GLOBAL("tvm.contrib.sort.topk")
   }
 });
 
+// The segments of a segmented sort are the ranges
+// [offsets[i], offsets[i + 1]) of the flattened data, as laid out by the
+// position functions of a ragged storage layout. offsets has one more
+// element than there are segments.
+template<typename OffsetType>
+void GetSegments(DLTensor* offsets, std::vector<int64_t>* bounds) {
+  auto offsets_ptr = static_cast<OffsetType *>(offsets->data);
+  bounds->resize(offsets->shape[0]);
+  for (int64_t i = 0; i < offsets->shape[0]; ++i) {
+    (*bounds)[i] = static_cast<int64_t>(offsets_ptr[i]);
+    if (i > 0) {
+      CHECK_LE((*bounds)[i - 1], (*bounds)[i]) << "Segment offsets must be non decreasing";
+    }
+  }
+}
+
+std::vector<int64_t> GetSegments(DLTensor* data, DLTensor* offsets) {
+  CHECK_EQ(offsets->ndim, 1) << "Segment offsets must be 1-D";
+  CHECK_GE(offsets->shape[0], 1) << "Segment offsets must have at least one element";
+  std::vector<int64_t> bounds;
+  auto offsets_dtype = DLDataType2String(offsets->dtype);
+  if (offsets_dtype == "int32") {
+    GetSegments<int32_t>(offsets, &bounds);
+  } else if (offsets_dtype == "int64") {
+    GetSegments<int64_t>(offsets, &bounds);
+  } else {
+    LOG(FATAL) << "Unsupported offsets dtype: " << offsets_dtype;
+  }
+  int64_t size = 1;
+  for (int i = 0; i < data->ndim; ++i) {
+    size *= data->shape[i];
+  }
+  CHECK(bounds.front() >= 0 && bounds.back() <= size)
+      << "Segments [" << bounds.front() << ", " << bounds.back()
+      << ") out of boundary for data of " << size << " elements";
+  return bounds;
+}
+
+// Sorts the indices, local to the segment, of the elements of the segment
+// [begin, end) of data. Ties keep their order.
+template<typename DataType>
+void SortSegment(const DataType* data_ptr, int64_t begin, int64_t end, bool is_ascend,
+                 int64_t k, std::vector<int64_t>* sorter) {
+  sorter->resize(end - begin);
+  for (int64_t i = 0; i < end - begin; ++i) {
+    (*sorter)[i] = i;
+  }
+  const DataType* seg = data_ptr + begin;
+  auto cmp = [seg, is_ascend](int64_t lhs, int64_t rhs) {
+    if (seg[lhs] == seg[rhs]) return lhs < rhs;
+    return is_ascend ? seg[lhs] < seg[rhs] : seg[lhs] > seg[rhs];
+  };
+  if (k < end - begin) {
+    std::partial_sort(sorter->begin(), sorter->begin() + k, sorter->end(), cmp);
+  } else {
+    std::sort(sorter->begin(), sorter->end(), cmp);
+  }
+}
+
+template<typename DataType, typename OutType>
+void segmented_argsort(DLTensor* input, const std::vector<int64_t>& bounds,
+                       DLTensor* output, bool is_ascend) {
+  auto data_ptr = static_cast<DataType *>(input->data);
+  auto out_ptr = static_cast<OutType *>(output->data);
+  std::vector<int64_t> sorter;
+  for (size_t i = 0; i + 1 < bounds.size(); ++i) {
+    int64_t begin = bounds[i], end = bounds[i + 1];
+    SortSegment(data_ptr, begin, end, is_ascend, end - begin, &sorter);
+    for (int64_t j = 0; j < end - begin; ++j) {
+      out_ptr[begin + j] = static_cast<OutType>(sorter[j]);
+    }
+  }
+}
+
+// Segmented argsort.
+// Sorts each segment [offsets[i], offsets[i + 1]) of the flattened input,
+// such as the rows of a ragged tensor, and returns, at the positions of
+// the segment, the indices local to the segment of its elements in sorted
+// order. Positions outside of all segments are left untouched.
+TVM_REGISTER_GLOBAL("tvm.contrib.sort.segmented_argsort")
+.set_body([](TVMArgs args, TVMRetValue *ret) {
+  DLTensor *input = args[0];
+  DLTensor *offsets = args[1];
+  DLTensor *output = args[2];
+  bool is_ascend = args[3];
+  std::vector<int64_t> bounds = GetSegments(input, offsets);
+
+  auto data_dtype = DLDataType2String(input->dtype);
+  auto out_dtype = DLDataType2String(output->dtype);
+  if (data_dtype == "float32") {
+    if (out_dtype == "int32") {
+      segmented_argsort<float, int32_t>(input, bounds, output, is_ascend);
+    } else if (out_dtype == "int64") {
+      segmented_argsort<float, int64_t>(input, bounds, output, is_ascend);
+    } else {
+      LOG(FATAL) << "Unsupported output dtype: " << out_dtype;
+    }
+  } else if (data_dtype == "float64") {
+    if (out_dtype == "int32") {
+      segmented_argsort<double, int32_t>(input, bounds, output, is_ascend);
+    } else if (out_dtype == "int64") {
+      segmented_argsort<double, int64_t>(input, bounds, output, is_ascend);
+    } else {
+      LOG(FATAL) << "Unsupported output dtype: " << out_dtype;
+    }
+  } else if (data_dtype == "int32") {
+    if (out_dtype == "int32") {
+      segmented_argsort<int32_t, int32_t>(input, bounds, output, is_ascend);
+    } else if (out_dtype == "int64") {
+      segmented_argsort<int32_t, int64_t>(input, bounds, output, is_ascend);
+    } else {
+      LOG(FATAL) << "Unsupported output dtype: " << out_dtype;
+    }
+  } else if (data_dtype == "int64") {
+    if (out_dtype == "int32") {
+      segmented_argsort<int64_t, int32_t>(input, bounds, output, is_ascend);
+    } else if (out_dtype == "int64") {
+      segmented_argsort<int64_t, int64_t>(input, bounds, output, is_ascend);
+    } else {
+      LOG(FATAL) << "Unsupported output dtype: " << out_dtype;
+    }
+  } else {
+    LOG(FATAL) << "Unsupported input dtype: " << data_dtype;
+  }
+});
+
+template<typename DataType, typename IndicesType>
+void segmented_topk(DLTensor* input,
+                    const std::vector<int64_t>& bounds,
+                    DLTensor* out_values,
+                    DLTensor* out_indices,
+                    int64_t k,
+                    bool is_ascend) {
+  DataType* data_ptr = static_cast<DataType *>(input->data);
+  DataType* values_ptr = (out_values == nullptr) ? nullptr :
+          static_cast<DataType *>(out_values->data);
+  IndicesType* indices_ptr = (out_indices == nullptr) ? nullptr :
+          static_cast<IndicesType *>(out_indices->data);
+  std::vector<int64_t> sorter;
+  for (size_t i = 0; i + 1 < bounds.size(); ++i) {
+    int64_t begin = bounds[i], end = bounds[i + 1];
+    int64_t cnt = std::min(k, end - begin);
+    SortSegment(data_ptr, begin, end, is_ascend, cnt, &sorter);
+    for (int64_t kk = 0; kk < k; ++kk) {
+      int64_t dst_idx = static_cast<int64_t>(i) * k + kk;
+      if (indices_ptr != nullptr) {
+        indices_ptr[dst_idx] = static_cast<IndicesType>(kk < cnt ? sorter[kk] : -1);
+      }
+      if (values_ptr != nullptr) {
+        values_ptr[dst_idx] = kk < cnt ? data_ptr[begin + sorter[kk]] : DataType(0);
+      }
+    }
+  }
+}
+
+// Segmented topk.
+// Returns the top k elements of each segment [offsets[i], offsets[i + 1])
+// of the flattened input, and their indices local to the segment, as
+// (num_segments, k) arrays. Segments of fewer than k elements are padded
+// with index -1 and value 0.
+TVM_REGISTER_GLOBAL("tvm.contrib.sort.segmented_topk")
+.set_body([](TVMArgs args, TVMRetValue* ret) {
+  DLTensor* input = args[0];
+  DLTensor* offsets = args[1];
+  DLTensor* values_out = nullptr;
+  DLTensor* indices_out = nullptr;
+  int k = args[args.num_args - 3];
+  std::string ret_type = args[args.num_args - 2];
+  bool is_ascend = args[args.num_args - 1];
+  if (ret_type == "both") {
+    values_out = args[2];
+    indices_out = args[3];
+  } else if (ret_type == "values") {
+    values_out = args[2];
+  } else if (ret_type == "indices") {
+    indices_out = args[2];
+  } else {
+    LOG(FATAL) << "Unsupported ret type: " << ret_type;
+  }
+  CHECK_GE(k, 1) << "Segmented topk needs k >= 1";
+  std::vector<int64_t> bounds = GetSegments(input, offsets);
+
+  auto data_dtype = DLDataType2String(input->dtype);
+  auto out_dtype = (indices_out == nullptr) ? "int64" : DLDataType2String(indices_out->dtype);
+  if (data_dtype == "float32") {
+    if (out_dtype == "int32") {
+      segmented_topk<float, int32_t>(input, bounds, values_out, indices_out, k, is_ascend);
+    } else if (out_dtype == "int64") {
+      segmented_topk<float, int64_t>(input, bounds, values_out, indices_out, k, is_ascend);
+    } else {
+      LOG(FATAL) << "Unsupported output dtype: " << out_dtype;
+    }
+  } else if (data_dtype == "float64") {
+    if (out_dtype == "int32") {
+      segmented_topk<double, int32_t>(input, bounds, values_out, indices_out, k, is_ascend);
+    } else if (out_dtype == "int64") {
+      segmented_topk<double, int64_t>(input, bounds, values_out, indices_out, k, is_ascend);
+    } else {
+      LOG(FATAL) << "Unsupported output dtype: " << out_dtype;
+    }
+  } else if (data_dtype == "int32") {
+    if (out_dtype == "int32") {
+      segmented_topk<int32_t, int32_t>(input, bounds, values_out, indices_out, k, is_ascend);
+    } else if (out_dtype == "int64") {
+      segmented_topk<int32_t, int64_t>(input, bounds, values_out, indices_out, k, is_ascend);
+    } else {
+      LOG(FATAL) << "Unsupported output dtype: " << out_dtype;
+    }
+  } else if (data_dtype == "int64") {
+    if (out_dtype == "int32") {
+      segmented_topk<int64_t, int32_t>(input, bounds, values_out, indices_out, k, is_ascend);
+    } else if (out_dtype == "int64") {
+      segmented_topk<int64_t, int64_t>(input, bounds, values_out, indices_out, k, is_ascend);
+    } else {
+      LOG(FATAL) << "Unsupported output dtype: " << out_dtype;
+    }
+  } else {
+    LOG(FATAL) << "Unsupported input dtype: " << data_dtype;
+  }
+});
+
 }  // namespace contrib
 }  // namespace tvm
@@ -24,16 +24,152 @@
 #include <dmlc/thread_local.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/runtime/device_api.h>
+#include <tvm/runtime/c_backend_api.h>
+#include <tvm/runtime/threading_backend.h>
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "workspace_pool.h"
 
 #ifdef __ANDROID__
 #include <android/api-level.h>
 #endif
+#if defined(__linux__) && !defined(_LIBCPP_SGX_CONFIG)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(SYS_mbind)
+#define TVM_CPU_NUMA_ALLOC 1
+#endif
+#endif
 
 namespace tvm {
 namespace runtime {
+
+#if TVM_CPU_NUMA_ALLOC
+/*!
+ * \brief The NUMA placement of the large CPU allocations, set by the
+ *  TVM_NUMA_ALLOC environment variable:
+ *
+ *  - "interleave" spreads their pages round robin over the nodes.
+ *  - "bind" places them on the node of the thread pool (TVM_NUMA_NODE).
+ *  - "first_touch" faults their pages in from the workers of the
+ *    thread pool, each its static share, so that pages land on the
+ *    node of the worker whose share of a parallel loop likely uses them.
+ *
+ *  The allocations of at least TVM_NUMA_MIN_BYTES bytes (1MB by
+ *  default) are mapped pages of their own, so that their placement
+ *  does not affect other allocations.
+ */
+class NumaAllocator {
+ public:
+  enum Policy { kDefault, kInterleave, kBind, kFirstTouch };
+
+  static NumaAllocator* Global() {
+    static NumaAllocator* inst = new NumaAllocator();
+    return inst;
+  }
+
+  bool Handles(size_t nbytes, size_t alignment) const {
+    return policy_ != kDefault && nbytes >= min_bytes_ &&
+           alignment <= static_cast<size_t>(page_size_);
+  }
+
+  void* Alloc(size_t nbytes) {
+    void* ptr = mmap(nullptr, nbytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) throw std::bad_alloc();
+    if (policy_ == kInterleave || policy_ == kBind) {
+      // The modes of mbind, as in numaif.h.
+      const int mode = policy_ == kInterleave ? 3 /* MPOL_INTERLEAVE */ : 2 /* MPOL_BIND */;
+      int num_nodes = threading::NumNumaNodes();
+      const int bits = 8 * sizeof(unsigned long);  // NOLINT(*)
+      std::vector<unsigned long> nodemask(num_nodes / bits + 1, 0);  // NOLINT(*)
+      for (int node = 0; node < num_nodes; ++node) {
+        if (policy_ == kInterleave || node == threading::BoundNumaNode()) {
+          nodemask[node / bits] |= 1UL << (node % bits);
+        }
+      }
+      if (syscall(SYS_mbind, ptr, nbytes, mode, nodemask.data(), num_nodes + 1, 0) != 0) {
+        LOG(WARNING) << "mbind failed, the allocation uses the default NUMA placement";
+      }
+    } else if (policy_ == kFirstTouch && !threading::InParallelLaunch()) {
+      FirstTouch(ptr, nbytes);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    sizes_[ptr] = nbytes;
+    return ptr;
+  }
+
+  // Whether ptr was allocated by the allocator, in which case it is freed.
+  bool Free(void* ptr) {
+    if (policy_ == kDefault) return false;
+    size_t nbytes;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = sizes_.find(ptr);
+      if (it == sizes_.end()) return false;
+      nbytes = it->second;
+      sizes_.erase(it);
+    }
+    munmap(ptr, nbytes);
+    return true;
+  }
+
+ private:
+  NumaAllocator() {
+    page_size_ = sysconf(_SC_PAGESIZE);
+    const char* val = getenv("TVM_NUMA_ALLOC");
+    std::string policy = val == nullptr ? "" : val;
+    if (policy == "interleave") {
+      policy_ = kInterleave;
+    } else if (policy == "bind") {
+      if (threading::BoundNumaNode() >= 0) {
+        policy_ = kBind;
+      } else {
+        LOG(WARNING) << "TVM_NUMA_ALLOC=bind needs the thread pool bound with TVM_NUMA_NODE";
+      }
+    } else if (policy == "first_touch") {
+      policy_ = kFirstTouch;
+    } else if (!policy.empty() && policy != "default") {
+      LOG(WARNING) << "Unknown TVM_NUMA_ALLOC policy " << policy;
+    }
+    const char* min_bytes = getenv("TVM_NUMA_MIN_BYTES");
+    if (min_bytes != nullptr) min_bytes_ = static_cast<size_t>(atoll(min_bytes));
+  }
+
+  struct TouchRange {
+    char* data;
+    size_t nbytes;
+    size_t page_size;
+  };
+
+  static int TouchLambda(int task_id, TVMParallelGroupEnv* penv, void* cdata) {
+    TouchRange* range = static_cast<TouchRange*>(cdata);
+    size_t num_pages = (range->nbytes + range->page_size - 1) / range->page_size;
+    size_t step = (num_pages + penv->num_task - 1) / penv->num_task;
+    size_t end = std::min(num_pages, (task_id + 1) * step);
+    for (size_t page = task_id * step; page < end; ++page) {
+      range->data[page * range->page_size] = 0;
+    }
+    return 0;
+  }
+
+  void FirstTouch(void* ptr, size_t nbytes) {
+    TouchRange range{static_cast<char*>(ptr), nbytes, static_cast<size_t>(page_size_)};
+    TVMBackendParallelLaunch(TouchLambda, &range, 0);
+  }
+
+  Policy policy_{kDefault};
+  size_t min_bytes_{1 << 20};
+  long page_size_;  // NOLINT(*)
+  std::mutex mutex_;
+  std::unordered_map<void*, size_t> sizes_;
+};
+#endif
 class CPUDeviceAPI final : public DeviceAPI {
  public:
   void SetDevice(TVMContext ctx) final {}
@@ -47,6 +183,11 @@ class CPUDeviceAPI final : public DeviceAPI {
                        size_t alignment,
                        DLDataType type_hint) final {
     void* ptr;
+#if TVM_CPU_NUMA_ALLOC
+    if (NumaAllocator::Global()->Handles(nbytes, alignment)) {
+      return NumaAllocator::Global()->Alloc(nbytes);
+    }
+#endif
 #if _MSC_VER
     ptr = _aligned_malloc(nbytes, alignment);
     if (ptr == nullptr) throw std::bad_alloc();
@@ -63,6 +204,9 @@ class CPUDeviceAPI final : public DeviceAPI {
   }
 
   void FreeDataSpace(TVMContext ctx, void* ptr) final {
+#if TVM_CPU_NUMA_ALLOC
+    if (NumaAllocator::Global()->Free(ptr)) return;
+#endif
 #if _MSC_VER
     _aligned_free(ptr);
 #else
@@ -50,6 +50,35 @@ namespace runtime {
         << "CUDA: " << cudaGetErrorString(e);                      \
   }
 
+/*! \brief Pinned host buffer used to stage host to device copies */
+struct CUDAStagingBuffer {
+  /*! \brief The pinned host memory */
+  void* data{nullptr};
+  /*! \brief The size of data in bytes */
+  size_t size{0};
+  /*! \brief The device the last copy from this buffer went to */
+  int device_id{-1};
+  /*! \brief Event recorded after the last copy from this buffer */
+  cudaEvent_t event{nullptr};
+  CUDAStagingBuffer() = default;
+  CUDAStagingBuffer(const CUDAStagingBuffer&) = delete;
+  CUDAStagingBuffer& operator=(const CUDAStagingBuffer&) = delete;
+  /*! \brief Release the pinned memory and the event when the thread exits */
+  ~CUDAStagingBuffer() {
+    // Errors are ignored here, the driver may already be unloading.
+    if (event != nullptr) {
+      cudaEventSynchronize(event);
+      cudaEventDestroy(event);
+    }
+    if (data != nullptr) {
+      cudaFreeHost(data);
+    }
+  }
+};
+
+/*! \brief Number of staging buffers used round robin per thread */
+constexpr int kNumCUDAStagingBuffers = 4;
+
 /*! \brief Thread local workspace */
 class CUDAThreadEntry {
  public:
@@ -57,6 +86,10 @@ class CUDAThreadEntry {
   cudaStream_t stream{nullptr};
   /*! \brief thread local pool*/
   WorkspacePool pool;
+  /*! \brief staging buffers for stream ordered host to device copies */
+  CUDAStagingBuffer staging[kNumCUDAStagingBuffers];
+  /*! \brief the staging buffer to use next */
+  int next_staging{0};
   /*! \brief constructor */
   CUDAThreadEntry();
   // get the threadlocal workspace
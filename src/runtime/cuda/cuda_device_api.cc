@@ -113,17 +113,27 @@ class CUDADeviceAPI final : public DeviceAPI {
                        size_t alignment,
                        DLDataType type_hint) final {
     // std::cout << "CUDAMALLOC " << nbytes << std::endl;
-    CUDA_CALL(cudaSetDevice(ctx.device_id));
     CHECK_EQ(256 % alignment, 0U)
         << "CUDA space is aligned at 256 bytes";
     void *ret;
-    CUDA_CALL(cudaMalloc(&ret, nbytes));
+    if (ctx.device_type == kDLCPUPinned) {
+      // Page-locked host memory, which the device can access with DMA
+      // without going through a driver staging buffer.
+      CUDA_CALL(cudaMallocHost(&ret, nbytes));
+    } else {
+      CUDA_CALL(cudaSetDevice(ctx.device_id));
+      CUDA_CALL(cudaMalloc(&ret, nbytes));
+    }
     return ret;
   }
 
   void FreeDataSpace(TVMContext ctx, void* ptr) final {
-    CUDA_CALL(cudaSetDevice(ctx.device_id));
-    CUDA_CALL(cudaFree(ptr));
+    if (ctx.device_type == kDLCPUPinned) {
+      CUDA_CALL(cudaFreeHost(ptr));
+    } else {
+      CUDA_CALL(cudaSetDevice(ctx.device_id));
+      CUDA_CALL(cudaFree(ptr));
+    }
   }
 
   void CopyDataFromTo(const void* from,
@@ -138,7 +148,17 @@ class CUDADeviceAPI final : public DeviceAPI {
     cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
     from = static_cast<const char*>(from) + from_offset;
     to = static_cast<char*>(to) + to_offset;
-    if (ctx_from.device_type == kDLGPU && ctx_to.device_type == kDLGPU) {
+    // Pinned host memory is copied just like pageable host memory, the
+    // driver simply skips its staging copy.
+    if (ctx_from.device_type == kDLCPUPinned) {
+      ctx_from.device_type = kDLCPU;
+    }
+    if (ctx_to.device_type == kDLCPUPinned) {
+      ctx_to.device_type = kDLCPU;
+    }
+    if (ctx_from.device_type == kDLCPU && ctx_to.device_type == kDLCPU) {
+      memcpy(to, from, size);
+    } else if (ctx_from.device_type == kDLGPU && ctx_to.device_type == kDLGPU) {
       CUDA_CALL(cudaSetDevice(ctx_from.device_id));
       if (ctx_from.device_id == ctx_to.device_id) {
         GPUCopy(from, to, size, cudaMemcpyDeviceToDevice, cu_stream);
@@ -158,6 +178,49 @@ class CUDADeviceAPI final : public DeviceAPI {
     }
   }
 
+  void CopyDataToDeviceStreamOrdered(const void* from,
+                                     size_t from_offset,
+                                     void* to,
+                                     size_t to_offset,
+                                     size_t size,
+                                     TVMContext ctx_to,
+                                     DLDataType type_hint) final {
+    CUDA_CALL(cudaSetDevice(ctx_to.device_id));
+    CUDAThreadEntry* entry = CUDAThreadEntry::ThreadLocal();
+    // The staging buffers are used round robin, so that the host can
+    // fill in the next one while copies from the previous ones are
+    // still in flight. We only wait when a buffer comes around again.
+    CUDAStagingBuffer& staging = entry->staging[entry->next_staging];
+    entry->next_staging = (entry->next_staging + 1) % kNumCUDAStagingBuffers;
+    if (staging.event != nullptr) {
+      CUDA_CALL(cudaEventSynchronize(staging.event));
+      if (staging.device_id != ctx_to.device_id) {
+        CUDA_CALL(cudaEventDestroy(staging.event));
+        staging.event = nullptr;
+      }
+    }
+    if (staging.event == nullptr) {
+      CUDA_CALL(cudaEventCreateWithFlags(&staging.event, cudaEventDisableTiming));
+      staging.device_id = ctx_to.device_id;
+    }
+    if (staging.size < size) {
+      // Reset the buffer before allocating, so that a failed allocation
+      // leaves no dangling pointer for the destructor to free again.
+      void* old_data = staging.data;
+      staging.data = nullptr;
+      staging.size = 0;
+      if (old_data != nullptr) {
+        CUDA_CALL(cudaFreeHost(old_data));
+      }
+      CUDA_CALL(cudaMallocHost(&staging.data, size));
+      staging.size = size;
+    }
+    memcpy(staging.data, static_cast<const char*>(from) + from_offset, size);
+    CUDA_CALL(cudaMemcpyAsync(static_cast<char*>(to) + to_offset, staging.data, size,
+                              cudaMemcpyHostToDevice, entry->stream));
+    CUDA_CALL(cudaEventRecord(staging.event, entry->stream));
+  }
+
   TVMStreamHandle CreateStream(TVMContext ctx) {
     CUDA_CALL(cudaSetDevice(ctx.device_id));
     cudaStream_t retval;
@@ -182,6 +245,57 @@ class CUDADeviceAPI final : public DeviceAPI {
     CUDA_CALL(cudaEventDestroy(evt));
   }
 
+  void* CreateEvent(TVMContext ctx) final {
+    CUDA_CALL(cudaSetDevice(ctx.device_id));
+    cudaEvent_t evt;
+    CUDA_CALL(cudaEventCreateWithFlags(&evt, cudaEventDisableTiming));
+    return static_cast<void*>(evt);
+  }
+
+  void FreeEvent(TVMContext ctx, void* event) final {
+    CUDA_CALL(cudaSetDevice(ctx.device_id));
+    CUDA_CALL(cudaEventDestroy(static_cast<cudaEvent_t>(event)));
+  }
+
+  void RecordEvent(TVMContext ctx, void* event, TVMStreamHandle stream) final {
+    CUDA_CALL(cudaSetDevice(ctx.device_id));
+    CUDA_CALL(cudaEventRecord(static_cast<cudaEvent_t>(event), static_cast<cudaStream_t>(stream)));
+  }
+
+  void EventSync(TVMContext ctx, void* event) final {
+    CUDA_CALL(cudaSetDevice(ctx.device_id));
+    CUDA_CALL(cudaEventSynchronize(static_cast<cudaEvent_t>(event)));
+  }
+
+  bool EventQuery(TVMContext ctx, void* event) final {
+    CUDA_CALL(cudaSetDevice(ctx.device_id));
+    cudaError_t e = cudaEventQuery(static_cast<cudaEvent_t>(event));
+    if (e == cudaErrorNotReady) return false;
+    CUDA_CALL(e);
+    return true;
+  }
+
+  void StreamWaitEvent(TVMContext ctx, TVMStreamHandle stream, void* event) final {
+    CUDA_CALL(cudaSetDevice(ctx.device_id));
+    CUDA_CALL(cudaStreamWaitEvent(static_cast<cudaStream_t>(stream),
+                                  static_cast<cudaEvent_t>(event), 0));
+  }
+
+  void* CreateTimingEvent(TVMContext ctx) final {
+    CUDA_CALL(cudaSetDevice(ctx.device_id));
+    cudaEvent_t evt;
+    CUDA_CALL(cudaEventCreate(&evt));
+    return static_cast<void*>(evt);
+  }
+
+  double EventElapsed(TVMContext ctx, void* start, void* end) final {
+    CUDA_CALL(cudaSetDevice(ctx.device_id));
+    float ms;
+    CUDA_CALL(cudaEventElapsedTime(&ms, static_cast<cudaEvent_t>(start),
+                                   static_cast<cudaEvent_t>(end)));
+    return ms;
+  }
+
   void StreamSync(TVMContext ctx, TVMStreamHandle stream) final {
     CUDA_CALL(cudaSetDevice(ctx.device_id));
     CUDA_CALL(cudaStreamSynchronize(static_cast<cudaStream_t>(stream)));
@@ -192,11 +306,23 @@ class CUDADeviceAPI final : public DeviceAPI {
         ->stream = static_cast<cudaStream_t>(stream);
   }
 
+  TVMStreamHandle GetStream(TVMContext ctx) final {
+    return CUDAThreadEntry::ThreadLocal()->stream;
+  }
+
   void* AllocWorkspace(TVMContext ctx, size_t size, DLDataType type_hint) final {
+    // The thread local pool only holds device memory
+    if (ctx.device_type == kDLCPUPinned) {
+      return AllocDataSpace(ctx, size, kTempAllocaAlignment, type_hint);
+    }
     return CUDAThreadEntry::ThreadLocal()->pool.AllocWorkspace(ctx, size);
   }
 
   void FreeWorkspace(TVMContext ctx, void* data) final {
+    if (ctx.device_type == kDLCPUPinned) {
+      FreeDataSpace(ctx, data);
+      return;
+    }
     CUDAThreadEntry::ThreadLocal()->pool.FreeWorkspace(ctx, data);
   }
 
@@ -237,5 +363,11 @@ TVM_REGISTER_GLOBAL("device_api.gpu")
     *rv = static_cast<void*>(ptr);
   });
 
+TVM_REGISTER_GLOBAL("device_api.cpu_pinned")
+.set_body([](TVMArgs args, TVMRetValue* rv) {
+    DeviceAPI* ptr = CUDADeviceAPI::Global().get();
+    *rv = static_cast<void*>(ptr);
+  });
+
 }  // namespace runtime
 }  // namespace tvm
@@ -0,0 +1,177 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file cuda_graph.cc
+ * \brief Capture of the kernel launches of a function into a CUDA
+ *  graph, which is replayed on later calls.
+ */
+#include <cuda_runtime.h>
+#include <tvm/runtime/packed_func.h>
+#include <tvm/runtime/registry.h>
+
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "cuda_common.h"
+
+namespace tvm {
+namespace runtime {
+
+/*!
+ * \brief A function whose device work is captured into a CUDA graph
+ *  on its first call, and replayed by later calls.
+ *
+ *  Only the work issued on the stream of the thread is captured: host
+ *  computations of the function, such as the prep code of a ragged
+ *  operator, are not replayed, and should be run in a separate
+ *  function. The graph reads its buffers when it is replayed, so the
+ *  contents of the buffers may change between calls. When the
+ *  arguments change, the function is captured again, and the new
+ *  graph patched into the instantiated one, which updates the kernel
+ *  parameters, when its topology is the same.
+ */
+class CUDAGraphFunc {
+ public:
+  explicit CUDAGraphFunc(PackedFunc func) : func_(func) {}
+
+  ~CUDAGraphFunc() {
+    if (exec_ != nullptr) cudaGraphExecDestroy(exec_);
+    if (capture_stream_ != nullptr) cudaStreamDestroy(capture_stream_);
+  }
+
+  void Call(TVMArgs args, TVMRetValue* rv) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int device_id;
+    CUDA_CALL(cudaGetDevice(&device_id));
+    std::string key = ArgsKey(args);
+    if (exec_ == nullptr || device_id != device_id_ || key != key_) {
+      Capture(args, rv, device_id);
+      key_ = key;
+    }
+    CUDA_CALL(cudaGraphLaunch(exec_, CUDAThreadEntry::ThreadLocal()->stream));
+  }
+
+ private:
+  // The values the captured launches may depend on: the scalars, and
+  // the addresses and shapes of the tensors.
+  static std::string ArgsKey(const TVMArgs& args) {
+    std::string key;
+    auto append = [&key](const void* data, size_t size) {
+      key.append(static_cast<const char*>(data), size);
+    };
+    for (int i = 0; i < args.num_args; ++i) {
+      int type_code = args.type_codes[i];
+      const TVMValue& value = args.values[i];
+      append(&type_code, sizeof(type_code));
+      if (type_code == kTVMDLTensorHandle || type_code == kTVMNDArrayHandle) {
+        DLTensor* tensor = args[i];
+        append(&tensor->data, sizeof(tensor->data));
+        append(&tensor->byte_offset, sizeof(tensor->byte_offset));
+        append(&tensor->ndim, sizeof(tensor->ndim));
+        append(tensor->shape, sizeof(int64_t) * tensor->ndim);
+      } else if (type_code == kTVMStr || type_code == kTVMBytes) {
+        std::string str = args[i];
+        key += str;
+        key.push_back('\0');
+      } else {
+        append(&value, sizeof(value));
+      }
+    }
+    return key;
+  }
+
+  void Capture(TVMArgs args, TVMRetValue* rv, int device_id) {
+    if (device_id != device_id_) {
+      if (exec_ != nullptr) CUDA_CALL(cudaGraphExecDestroy(exec_));
+      if (capture_stream_ != nullptr) CUDA_CALL(cudaStreamDestroy(capture_stream_));
+      exec_ = nullptr;
+      CUDA_CALL(cudaStreamCreateWithFlags(&capture_stream_, cudaStreamNonBlocking));
+      device_id_ = device_id;
+    }
+
+    CUDAThreadEntry* entry = CUDAThreadEntry::ThreadLocal();
+    cudaStream_t stream = entry->stream;
+    entry->stream = capture_stream_;
+    CUDA_CALL(cudaStreamBeginCapture(capture_stream_, cudaStreamCaptureModeRelaxed));
+    cudaGraph_t graph = nullptr;
+    try {
+      func_.CallPacked(args, rv);
+    } catch (...) {
+      entry->stream = stream;
+      cudaStreamEndCapture(capture_stream_, &graph);
+      if (graph != nullptr) cudaGraphDestroy(graph);
+      throw;
+    }
+    entry->stream = stream;
+    cudaError_t e = cudaStreamEndCapture(capture_stream_, &graph);
+    CHECK(e == cudaSuccess) << "CUDA graph capture failed: " << cudaGetErrorString(e)
+                            << ". Functions replayed as CUDA graphs may not synchronize.";
+
+    if (exec_ != nullptr && !Update(graph)) {
+      CUDA_CALL(cudaGraphExecDestroy(exec_));
+      exec_ = nullptr;
+    }
+    if (exec_ == nullptr) {
+#if CUDART_VERSION >= 12000
+      CUDA_CALL(cudaGraphInstantiate(&exec_, graph, 0));
+#else
+      CUDA_CALL(cudaGraphInstantiate(&exec_, graph, nullptr, nullptr, 0));
+#endif
+    }
+    CUDA_CALL(cudaGraphDestroy(graph));
+  }
+
+  // Patch the kernel parameters of the instantiated graph with those
+  // of graph, if the two have the same topology.
+  bool Update(cudaGraph_t graph) {
+#if CUDART_VERSION >= 12000
+    cudaGraphExecUpdateResultInfo info;
+    bool updated = cudaGraphExecUpdate(exec_, graph, &info) == cudaSuccess;
+#elif CUDART_VERSION >= 10020
+    cudaGraphNode_t error_node;
+    cudaGraphExecUpdateResult result;
+    bool updated = cudaGraphExecUpdate(exec_, graph, &error_node, &result) == cudaSuccess;
+#else
+    bool updated = false;
+#endif
+    // Clear the error of a failed update.
+    if (!updated) cudaGetLastError();
+    return updated;
+  }
+
+  PackedFunc func_;
+  std::mutex mutex_;
+  int device_id_{-1};
+  std::string key_;
+  cudaStream_t capture_stream_{nullptr};
+  cudaGraphExec_t exec_{nullptr};
+};
+
+TVM_REGISTER_GLOBAL("runtime.CUDAGraphWrap").set_body_typed([](PackedFunc func) {
+  auto graph_func = std::make_shared<CUDAGraphFunc>(func);
+  return PackedFunc(
+      [graph_func](TVMArgs args, TVMRetValue* rv) { graph_func->Call(args, rv); });
+});
+
+}  // namespace runtime
+}  // namespace tvm
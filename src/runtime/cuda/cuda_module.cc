@@ -24,10 +24,19 @@
 
 #include <cuda.h>
 #include <cuda_runtime.h>
+#include <sys/stat.h>
 #include <tvm/runtime/registry.h>
+#include <unistd.h>
 
 #include <array>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
 #include <mutex>
+#include <sstream>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -41,10 +50,89 @@
 namespace tvm {
 namespace runtime {
 
+// Split PTX into one module per kernel, each of the declarations
+// outside of the entries followed by one entry, so that the driver
+// only JIT-compiles the kernels that are called. Returns an empty map
+// if an entry is unterminated or defined twice.
+static std::unordered_map<std::string, std::string> SplitPTXByEntry(const std::string& ptx) {
+  std::unordered_map<std::string, std::string> entries;
+  std::string common;
+  std::istringstream is(ptx);
+  std::string line, name, body;
+  int depth = 0;
+  bool in_entry = false, opened = false;
+  while (std::getline(is, line)) {
+    if (!in_entry) {
+      size_t pos = line.find(".entry ");
+      size_t comment = line.find("//");
+      if (pos != std::string::npos && (comment == std::string::npos || comment > pos)) {
+        size_t begin = line.find_first_not_of(' ', pos + 7);
+        size_t paren = line.find('(', begin);
+        name = line.substr(begin, paren == std::string::npos ? std::string::npos : paren - begin);
+        while (!name.empty() && isspace(name.back())) name.pop_back();
+        in_entry = true;
+        opened = false;
+        depth = 0;
+        body.clear();
+      }
+    }
+    if (!in_entry) {
+      common += line + "\n";
+      continue;
+    }
+    body += line + "\n";
+    // Braces also group the operands of vector instructions, but
+    // those are balanced within a line.
+    for (char c : line.substr(0, line.find("//"))) {
+      if (c == '{') {
+        ++depth;
+        opened = true;
+      } else if (c == '}') {
+        --depth;
+      }
+    }
+    if (opened && depth == 0) {
+      if (entries.count(name)) return {};
+      entries[name] = body;
+      in_entry = false;
+    }
+  }
+  if (in_entry) return {};
+  for (auto& it : entries) it.second = common + it.second;
+  return entries;
+}
+
+// The units of PTX of a module. Kernels compiled separately, see
+// codegen::BuildCUDA, are kept as units separated by null characters,
+// which PTX text does not contain otherwise.
+static std::vector<std::string> SplitPTXUnits(const std::string& data) {
+  std::vector<std::string> units;
+  size_t begin = 0;
+  while (begin < data.size()) {
+    size_t end = data.find('\0', begin);
+    if (end == std::string::npos) end = data.size();
+    std::string unit = data.substr(begin, end - begin);
+    if (unit.find_first_not_of(" \t\r\n") != std::string::npos) units.push_back(unit);
+    begin = end + 1;
+  }
+  return units;
+}
+
+std::string CUDAKernelCacheDir(const std::string& subdir) {
+  const char* val = getenv("TVM_CUDA_KERNEL_CACHE");
+  if (val == nullptr || std::string(val) != "1") return "";
+  std::string dir = GetCacheDir();
+  mkdir(dir.c_str(), 0755);
+  dir += "/" + subdir;
+  mkdir(dir.c_str(), 0755);
+  return dir;
+}
+
 // Module to support thread-safe multi-GPU execution.
 // cuModule is a per-GPU module
 // The runtime will contain a per-device module table
-// The modules will be lazily loaded
+// The modules will be lazily loaded. PTX modules of several kernels
+// are loaded one kernel at a time, as the kernels are first called.
 class CUDAModuleNode : public runtime::ModuleNode {
  public:
   static bool use_grid_sync;
@@ -57,10 +145,15 @@ class CUDAModuleNode : public runtime::ModuleNode {
   // destructor
   ~CUDAModuleNode() {
     for (size_t i = 0; i < module_.size(); ++i) {
-      if (module_[i] != nullptr) {
+      if (module_[i] != nullptr || !func_module_[i].empty()) {
         CUDA_CALL(cudaSetDevice(static_cast<int>(i)));
+      }
+      if (module_[i] != nullptr) {
         CUDA_DRIVER_CALL(cuModuleUnload(module_[i]));
       }
+      for (const auto& it : func_module_[i]) {
+        CUDA_DRIVER_CALL(cuModuleUnload(it.second));
+      }
     }
   }
 
@@ -101,37 +194,8 @@ class CUDAModuleNode : public runtime::ModuleNode {
   // get a CUfunction from primary context in device_id
   CUfunction GetFunc(int device_id, const std::string& func_name) {
     std::lock_guard<std::mutex> lock(mutex_);
-    // must recheck under the lock scope
-    if (module_[device_id] == nullptr) {
-      CUDA_DRIVER_CALL(cuInit(0));
-      CUdevice device;
-      CUDA_DRIVER_CALL(cuDeviceGet(&device, 0));
-
-      int major;
-      CUDA_DRIVER_CALL(
-          cuDeviceGetAttribute(&major, CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MAJOR, device));
-      if (major >= 7 && use_grid_sync) {
-        CUlinkState stateOut;
-        CUjit_option* options;
-        void** optionValues;
-        CUDA_DRIVER_CALL(cuLinkCreate(0, options, optionValues, &stateOut));
-        CUDA_DRIVER_CALL(cuLinkAddData(stateOut, CU_JIT_INPUT_PTX, const_cast<char*>(data_.c_str()),
-                                       data_.size(), "cuda_module", 0, options, optionValues));
-        std::string rt_path = "/usr/local/cuda/targets/x86_64-linux/lib/libcudadevrt.a";
-        CUDA_DRIVER_CALL(cuLinkAddFile(stateOut, CU_JIT_INPUT_LIBRARY, rt_path.c_str(), 0, options,
-                                       optionValues));
-
-        void* cubinOut;
-        size_t size;
-        CUDA_DRIVER_CALL(cuLinkComplete(stateOut, &cubinOut, &size));
-
-        CUDA_DRIVER_CALL(cuModuleLoadData(&(module_[device_id]), cubinOut));
-      } else {
-        CUDA_DRIVER_CALL(cuModuleLoadData(&(module_[device_id]), data_.c_str()));
-      }
-    }
     CUfunction func;
-    CUresult result = cuModuleGetFunction(&func, module_[device_id], func_name.c_str());
+    CUresult result = cuModuleGetFunction(&func, GetModule(device_id, func_name), func_name.c_str());
     if (result != CUDA_SUCCESS) {
       const char* msg;
       cuGetErrorName(result, &msg);
@@ -142,39 +206,11 @@ class CUDAModuleNode : public runtime::ModuleNode {
   // get a global var from primary context in device_id
   CUdeviceptr GetGlobal(int device_id, const std::string& global_name, size_t expect_nbytes) {
     std::lock_guard<std::mutex> lock(mutex_);
-    // must recheck under the lock scope
-    if (module_[device_id] == nullptr) {
-      CUDA_DRIVER_CALL(cuInit(0));
-      CUdevice device;
-      CUDA_DRIVER_CALL(cuDeviceGet(&device, 0));
-
-      int major;
-      CUDA_DRIVER_CALL(
-          cuDeviceGetAttribute(&major, CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MAJOR, device));
-      if (major >= 7 && use_grid_sync) {
-        CUlinkState stateOut;
-        CUjit_option* options;
-        void** optionValues;
-        CUDA_DRIVER_CALL(cuLinkCreate(0, options, optionValues, &stateOut));
-        CUDA_DRIVER_CALL(cuLinkAddData(stateOut, CU_JIT_INPUT_PTX, const_cast<char*>(data_.c_str()),
-                                       data_.size(), "cuda_module", 0, options, optionValues));
-        std::string rt_path = "/usr/local/cuda/targets/x86_64-linux/lib/libcudadevrt.a";
-        CUDA_DRIVER_CALL(cuLinkAddFile(stateOut, CU_JIT_INPUT_LIBRARY, rt_path.c_str(), 0, options,
-                                       optionValues));
-
-        void* cubinOut;
-        size_t size;
-        CUDA_DRIVER_CALL(cuLinkComplete(stateOut, &cubinOut, &size));
-
-        CUDA_DRIVER_CALL(cuModuleLoadData(&(module_[device_id]), cubinOut));
-      } else {
-        CUDA_DRIVER_CALL(cuModuleLoadData(&(module_[device_id]), data_.c_str()));
-      }
-    }
     CUdeviceptr global;
     size_t nbytes;
 
-    CUresult result = cuModuleGetGlobal(&global, &nbytes, module_[device_id], global_name.c_str());
+    CUresult result =
+        cuModuleGetGlobal(&global, &nbytes, GetWholeModule(device_id), global_name.c_str());
     CHECK_EQ(nbytes, expect_nbytes);
     if (result != CUDA_SUCCESS) {
       const char* msg;
@@ -184,7 +220,132 @@ class CUDAModuleNode : public runtime::ModuleNode {
     return global;
   }
 
+  // find a global var of a function in the module of the function
+  // loaded in device_id, if it has one
+  bool FindGlobal(int device_id, const std::string& func_name, const std::string& global_name,
+                  CUdeviceptr* global, size_t* nbytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cuModuleGetGlobal(global, nbytes, GetModule(device_id, func_name),
+                             global_name.c_str()) == CUDA_SUCCESS;
+  }
+
  private:
+  // split the PTX of the module into units and kernels, once.
+  // must be called under the lock.
+  void SplitPTX() {
+    if (ptx_split_) return;
+    ptx_split_ = true;
+    if (fmt_ != "ptx") {
+      units_ = {data_};
+      return;
+    }
+    units_ = SplitPTXUnits(data_);
+    const char* val = getenv("TVM_CUDA_LAZY_LOADING");
+    bool lazy = val == nullptr || std::string(val) != "0";
+    // Separately compiled kernels are always loaded separately.
+    if (!lazy && units_.size() < 2) return;
+    for (const auto& unit : units_) {
+      for (auto& it : SplitPTXByEntry(unit)) func_ptx_[it.first] = std::move(it.second);
+    }
+    if (units_.size() < 2 && func_ptx_.size() < 2) func_ptx_.clear();
+  }
+
+  // get the module of all the kernels in device_id, loading it if
+  // needed. must be called under the lock.
+  CUmodule GetWholeModule(int device_id) {
+    SplitPTX();
+    if (module_[device_id] == nullptr) {
+      module_[device_id] = LoadModule(device_id, units_);
+    }
+    return module_[device_id];
+  }
+
+  // get the module of a function in device_id, loading it if needed.
+  // must be called under the lock.
+  CUmodule GetModule(int device_id, const std::string& func_name) {
+    SplitPTX();
+    auto it = func_ptx_.find(func_name);
+    if (it == func_ptx_.end()) return GetWholeModule(device_id);
+    CUmodule& module = func_module_[device_id][func_name];
+    if (module == nullptr) module = LoadModule(device_id, {it->second});
+    return module;
+  }
+
+  // load a module image, or link PTX units into one, in the primary
+  // context of device_id. PTX is JIT-compiled, through the kernel
+  // cache if it is enabled.
+  CUmodule LoadModule(int device_id, const std::vector<std::string>& units) {
+    CHECK(!units.empty()) << "Empty CUDA module";
+    CUDA_DRIVER_CALL(cuInit(0));
+    CUdevice device;
+    CUDA_DRIVER_CALL(cuDeviceGet(&device, device_id));
+    int major, minor;
+    CUDA_DRIVER_CALL(
+        cuDeviceGetAttribute(&major, CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MAJOR, device));
+    CUDA_DRIVER_CALL(
+        cuDeviceGetAttribute(&minor, CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MINOR, device));
+    bool link_devrt = major >= 7 && use_grid_sync;
+    std::string cache_dir = CUDAKernelCacheDir("cuda_kernels");
+    CUmodule module;
+    if (fmt_ != "ptx" || (units.size() == 1 && cache_dir.empty() && !link_devrt)) {
+      CUDA_DRIVER_CALL(cuModuleLoadData(&module, units[0].c_str()));
+      return module;
+    }
+
+    std::string cache_file;
+    if (!cache_dir.empty()) {
+      uint64_t hash = 0;
+      size_t size = 0;
+      for (const auto& unit : units) {
+        hash = hash * 31 + StableHash(unit);
+        size += unit.size();
+      }
+      std::ostringstream os;
+      os << cache_dir << "/" << std::hex << hash << std::dec << "_" << size << "_sm" << major
+         << minor << (link_devrt ? "_devrt" : "") << ".cubin";
+      cache_file = os.str();
+      std::ifstream fs(cache_file, std::ios::in | std::ios::binary);
+      if (!fs.fail()) {
+        std::string cubin((std::istreambuf_iterator<char>(fs)), std::istreambuf_iterator<char>());
+        if (!cubin.empty() && cuModuleLoadData(&module, cubin.data()) == CUDA_SUCCESS) {
+          return module;
+        }
+      }
+    }
+
+    // Link the PTX to get the cubin, which loading it directly would
+    // not give.
+    CUlinkState state;
+    CUDA_DRIVER_CALL(cuLinkCreate(0, nullptr, nullptr, &state));
+    for (const auto& unit : units) {
+      CUDA_DRIVER_CALL(cuLinkAddData(state, CU_JIT_INPUT_PTX, const_cast<char*>(unit.c_str()),
+                                     unit.size() + 1, "cuda_module", 0, nullptr, nullptr));
+    }
+    if (link_devrt) {
+      std::string rt_path = "/usr/local/cuda/targets/x86_64-linux/lib/libcudadevrt.a";
+      CUDA_DRIVER_CALL(
+          cuLinkAddFile(state, CU_JIT_INPUT_LIBRARY, rt_path.c_str(), 0, nullptr, nullptr));
+    }
+    void* cubin;
+    size_t size;
+    CUDA_DRIVER_CALL(cuLinkComplete(state, &cubin, &size));
+    CUDA_DRIVER_CALL(cuModuleLoadData(&module, cubin));
+    if (!cache_file.empty()) {
+      // Written to a temporary file first, so that concurrent processes
+      // never read a partial cubin.
+      std::string tmp_file = cache_file + ".tmp" + std::to_string(getpid());
+      std::ofstream fs(tmp_file, std::ios::out | std::ios::binary);
+      fs.write(static_cast<const char*>(cubin), size);
+      fs.close();
+      if (fs.fail() || rename(tmp_file.c_str(), cache_file.c_str()) != 0) {
+        remove(tmp_file.c_str());
+      }
+    }
+    // The cubin is owned by the link state.
+    CUDA_DRIVER_CALL(cuLinkDestroy(state));
+    return module;
+  }
+
   // the binary data
   std::string data_;
   // The format
@@ -195,6 +356,14 @@ class CUDAModuleNode : public runtime::ModuleNode {
   std::string cuda_source_;
   // the internal modules per GPU, to be lazily initialized.
   std::array<CUmodule, kMaxNumGPUs> module_;
+  // Whether the PTX has been split into units_ and func_ptx_.
+  bool ptx_split_{false};
+  // The units of the module, see SplitPTXUnits.
+  std::vector<std::string> units_;
+  // The PTX of each kernel, when the module is loaded per kernel.
+  std::unordered_map<std::string, std::string> func_ptx_;
+  // The modules of the kernels per GPU, to be lazily initialized.
+  std::array<std::unordered_map<std::string, CUmodule>, kMaxNumGPUs> func_module_;
   // internal mutex when updating the module
   std::mutex mutex_;
 };
@@ -204,17 +373,28 @@ TVM_REGISTER_GLOBAL("runtime.SetCudaGridSyncOn").set_body_typed([](bool value) {
   CUDAModuleNode::use_grid_sync = value;
 });
 
+// Kernels with at least this many arguments get them packed into a
+// single parameter buffer at launch.
+static constexpr const size_t kMinPackedKernelArgs = 8;
+
 // a wrapped function class to get packed func.
 class CUDAWrappedFunc {
  public:
   // initialize the CUDA function.
   void Init(CUDAModuleNode* m, ObjectPtr<Object> sptr, const std::string& func_name,
-            size_t num_void_args, const std::vector<std::string>& thread_axis_tags) {
+            const std::vector<DLDataType>& arg_types,
+            const std::vector<std::string>& thread_axis_tags) {
+    size_t num_void_args = arg_types.size();
     m_ = m;
     sptr_ = sptr;
     func_name_ = func_name;
+    num_void_args_ = num_void_args;
     std::fill(fcache_.begin(), fcache_.end(), nullptr);
     thread_axis_cfg_.Init(num_void_args, thread_axis_tags);
+    const char* val = getenv("TVM_CUDA_PACK_KERNEL_ARGS");
+    if ((val == nullptr || std::string(val) != "0") && num_void_args >= kMinPackedKernelArgs) {
+      InitParamLayout(arg_types);
+    }
   }
   // invoke the function with void arguments
   void operator()(TVMArgs args, TVMRetValue* rv, void** void_args) const {
@@ -222,15 +402,42 @@ class CUDAWrappedFunc {
     CUDA_CALL(cudaGetDevice(&device_id));
     if (fcache_[device_id] == nullptr) {
       fcache_[device_id] = m_->GetFunc(device_id, func_name_);
+      InitAuxConstants(device_id);
     }
     CHECK(fcache_[device_id]);
     CUstream strm = static_cast<CUstream>(CUDAThreadEntry::ThreadLocal()->stream);
     ThreadWorkLoad wl = thread_axis_cfg_.Extract(args);
+    std::vector<void*> const_void_args;
+    if (aux_constants_[device_id].size() > 0) {
+      const_void_args.assign(void_args, void_args + num_void_args_);
+      CopyAuxConstants(device_id, strm, &const_void_args);
+      void_args = const_void_args.data();
+    }
     CUresult result = CUDA_SUCCESS;
     if (wl.grid_dim(0) * wl.grid_dim(1) * wl.grid_dim(2) > 0) {
-      result =
-        cuLaunchKernel(fcache_[device_id], wl.grid_dim(0), wl.grid_dim(1), wl.grid_dim(2),
-                       wl.block_dim(0), wl.block_dim(1), wl.block_dim(2), 0, strm, void_args, 0);
+      if (param_size_ > 0) {
+        // Hand the driver all the arguments as one buffer, laid out as
+        // the parameters of the kernel, rather than one by one.
+        size_t words = (param_size_ + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+        uint64_t stack_buffer[64];
+        std::vector<uint64_t> heap_buffer;
+        if (words > 64) heap_buffer.resize(words);
+        char* buffer = reinterpret_cast<char*>(words > 64 ? heap_buffer.data() : stack_buffer);
+        for (size_t i = 0; i < num_void_args_; ++i) {
+          std::memcpy(buffer + param_offsets_[i], void_args[i], param_sizes_[i]);
+        }
+        size_t size = param_size_;
+        void* extra[] = {CU_LAUNCH_PARAM_BUFFER_POINTER, buffer, CU_LAUNCH_PARAM_BUFFER_SIZE,
+                         &size, CU_LAUNCH_PARAM_END};
+        result =
+          cuLaunchKernel(fcache_[device_id], wl.grid_dim(0), wl.grid_dim(1), wl.grid_dim(2),
+                         wl.block_dim(0), wl.block_dim(1), wl.block_dim(2), 0, strm, nullptr,
+                         extra);
+      } else {
+        result =
+          cuLaunchKernel(fcache_[device_id], wl.grid_dim(0), wl.grid_dim(1), wl.grid_dim(2),
+                         wl.block_dim(0), wl.block_dim(1), wl.block_dim(2), 0, strm, void_args, 0);
+      }
     }
     if (result != CUDA_SUCCESS && result != CUDA_ERROR_DEINITIALIZED) {
       const char* msg;
@@ -252,12 +459,71 @@ class CUDAWrappedFunc {
   }
 
  private:
+  // The constant memory copy of an aux argument of the kernel.
+  struct AuxConstant {
+    size_t arg_index;
+    CUdeviceptr symbol;
+    size_t nbytes;
+  };
+
+  // Lay the arguments out as the kernel parameters are, each at the
+  // next offset aligned to its size.
+  void InitParamLayout(const std::vector<DLDataType>& arg_types) {
+    size_t offset = 0;
+    for (const auto& t : arg_types) {
+      size_t nbytes = t.code == kTVMOpaqueHandle ? sizeof(void*) : (t.bits / 8) * t.lanes;
+      offset = (offset + nbytes - 1) / nbytes * nbytes;
+      param_offsets_.push_back(offset);
+      param_sizes_.push_back(nbytes);
+      offset += nbytes;
+    }
+    param_size_ = offset;
+  }
+
+  void InitAuxConstants(int device_id) const {
+    for (size_t i = 0; i < num_void_args_; ++i) {
+      AuxConstant aux{i, 0, 0};
+      std::string name = func_name_ + symbol::tvm_aux_constant_suffix + std::to_string(i);
+      if (m_->FindGlobal(device_id, func_name_, name, &aux.symbol, &aux.nbytes)) {
+        aux_constants_[device_id].push_back(aux);
+      }
+    }
+  }
+
+  // Copy the aux arguments that fit to constant memory, and pass
+  // null pointers for them so that the kernel reads the copies. The
+  // rest of the allocation of an argument is copied along, as the
+  // size of the argument itself is unknown here.
+  void CopyAuxConstants(int device_id, CUstream strm, std::vector<void*>* void_args) const {
+    static void* null_ptr = nullptr;
+    for (const auto& aux : aux_constants_[device_id]) {
+      void* arg = *static_cast<void**>((*void_args)[aux.arg_index]);
+      CUdeviceptr ptr = reinterpret_cast<CUdeviceptr>(arg);
+      CUdeviceptr base;
+      size_t size;
+      if (ptr == 0 || cuMemGetAddressRange(&base, &size, ptr) != CUDA_SUCCESS) continue;
+      size_t nbytes = base + size - ptr;
+      if (nbytes > aux.nbytes) continue;
+      CUDA_DRIVER_CALL(cuMemcpyDtoDAsync(aux.symbol, ptr, nbytes, strm));
+      (*void_args)[aux.arg_index] = &null_ptr;
+    }
+  }
+
   // internal module
   CUDAModuleNode* m_;
   // the resource holder
   ObjectPtr<Object> sptr_;
   // The name of the function.
   std::string func_name_;
+  // The number of arguments of the kernel.
+  size_t num_void_args_;
+  // The offsets and sizes of the arguments in the parameter buffer,
+  // and its size, which is 0 when the arguments are passed one by one.
+  std::vector<size_t> param_offsets_;
+  std::vector<size_t> param_sizes_;
+  size_t param_size_{0};
+  // The constant memory copies of aux arguments per device.
+  mutable std::array<std::vector<AuxConstant>, kMaxNumGPUs> aux_constants_;
   // Device function cache per device.
   // mark as mutable, to enable lazy initialization
   mutable std::array<CUfunction, kMaxNumGPUs> fcache_;
@@ -301,7 +567,7 @@ PackedFunc CUDAModuleNode::GetFunction(const std::string& name,
   if (it == fmap_.end()) return PackedFunc();
   const FunctionInfo& info = it->second;
   CUDAWrappedFunc f;
-  f.Init(this, sptr_to_self, name, info.arg_types.size(), info.thread_axis_tags);
+  f.Init(this, sptr_to_self, name, info.arg_types, info.thread_axis_tags);
   return PackFuncVoidAddr(f, info.arg_types);
 }
 
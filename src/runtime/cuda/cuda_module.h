@@ -40,6 +40,16 @@ static constexpr const int kMaxNumGPUs = 32;
 /*!
  * \brief create a cuda module from data.
  *
+ *  The kernels of ptx modules are JIT-compiled as they are first
+ *  called, unless TVM_CUDA_LAZY_LOADING is set to 0. With
+ *  TVM_CUDA_KERNEL_CACHE set to 1, the compiled cubins are kept in the
+ *  cuda_kernels directory of the TVM cache directory, keyed by the
+ *  hash of the ptx and the compute capability of the device.
+ *
+ *  The ptx of kernels compiled separately is kept as units separated
+ *  by null characters, which are JIT-linked into one module when the
+ *  whole module is needed.
+ *
  * \param data The module data, can be ptx, cubin
  * \param fmt The format of the data, can be "ptx", "cubin"
  * \param fmap The map function information map of each function.
@@ -50,6 +60,16 @@ Module CUDAModuleCreate(
     std::string fmt,
     std::unordered_map<std::string, FunctionInfo> fmap,
     std::string cuda_source);
+
+/*!
+ * \brief Get a directory of the on-disk cache of compiled CUDA code,
+ *  creating it if needed.
+ *
+ * \param subdir The name of the directory in the TVM cache directory.
+ * \return The path of the directory, or empty if TVM_CUDA_KERNEL_CACHE
+ *  is not set to 1.
+ */
+std::string CUDAKernelCacheDir(const std::string& subdir);
 }  // namespace runtime
 }  // namespace tvm
 #endif  // TVM_RUNTIME_CUDA_CUDA_MODULE_H_
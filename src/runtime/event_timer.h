@@ -0,0 +1,98 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file event_timer.h
+ * \brief Timing of the operations run on a device, with device events
+ *  where the device has them and host timers otherwise.
+ */
+#ifndef TVM_RUNTIME_EVENT_TIMER_H_
+#define TVM_RUNTIME_EVENT_TIMER_H_
+
+#include <tvm/runtime/device_api.h>
+
+#include <chrono>
+
+namespace tvm {
+namespace runtime {
+
+/*!
+ * \brief Times the operations enqueued on the current stream of a
+ *  device between Start and Stop.
+ *
+ *  Timing events measure the time the device spends between the two
+ *  points, without the launch overheads and host synchronization that
+ *  host timers include. Devices without them are timed on the host,
+ *  synchronizing their stream before and after.
+ */
+class EventTimer {
+ public:
+  explicit EventTimer(TVMContext ctx) : ctx_(ctx), api_(DeviceAPI::Get(ctx)) {
+    start_ = api_->CreateTimingEvent(ctx);
+    if (start_ != nullptr) end_ = api_->CreateTimingEvent(ctx);
+  }
+  ~EventTimer() {
+    if (start_ != nullptr) {
+      api_->FreeEvent(ctx_, start_);
+      api_->FreeEvent(ctx_, end_);
+    }
+  }
+  EventTimer(const EventTimer&) = delete;
+  EventTimer& operator=(const EventTimer&) = delete;
+
+  /*! \brief Whether the operations are timed with device events. */
+  bool on_device() const { return start_ != nullptr; }
+  /*! \brief Mark the start of the timed operations. */
+  void Start() {
+    TVMStreamHandle stream = api_->GetStream(ctx_);
+    if (on_device()) {
+      api_->RecordEvent(ctx_, start_, stream);
+    } else {
+      api_->StreamSync(ctx_, stream);
+      host_start_ = std::chrono::high_resolution_clock::now();
+    }
+  }
+  /*!
+   * \brief Mark the end of the timed operations, waiting for them.
+   * \return The time they took in microseconds.
+   */
+  double Stop() {
+    TVMStreamHandle stream = api_->GetStream(ctx_);
+    if (on_device()) {
+      api_->RecordEvent(ctx_, end_, stream);
+      api_->EventSync(ctx_, end_);
+      return api_->EventElapsed(ctx_, start_, end_) * 1e3;
+    }
+    api_->StreamSync(ctx_, stream);
+    auto host_end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::micro>(host_end - host_start_).count();
+  }
+
+ private:
+  TVMContext ctx_;
+  DeviceAPI* api_;
+  void* start_{nullptr};
+  void* end_{nullptr};
+  std::chrono::high_resolution_clock::time_point host_start_;
+};
+
+}  // namespace runtime
+}  // namespace tvm
+#endif  // TVM_RUNTIME_EVENT_TIMER_H_
@@ -97,6 +97,15 @@ std::string GetCacheDir() {
   return ".";
 }
 
+uint64_t StableHash(const std::string& data) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (char c : data) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
 std::string GetFileBasename(const std::string& file_name) {
   size_t last_slash = file_name.find_last_of("/");
   if (last_slash == std::string::npos) return file_name;
@@ -24,6 +24,7 @@
 #ifndef TVM_RUNTIME_FILE_UTIL_H_
 #define TVM_RUNTIME_FILE_UTIL_H_
 
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include "meta_data.h"
@@ -44,6 +45,14 @@ std::string GetFileFormat(const std::string& file_name,
  */
 std::string GetCacheDir();
 
+/*!
+ * \brief Hash data stably across runs and platforms, as the names of
+ *  cached files must be.
+ * \param data The data to hash.
+ * \return The FNV-1a hash of the data.
+ */
+uint64_t StableHash(const std::string& data);
+
 /*!
  * \brief Get meta file path given file name and format.
  * \param file_name The name of the file.
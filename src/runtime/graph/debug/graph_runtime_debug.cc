@@ -25,7 +25,12 @@
 #include <tvm/runtime/ndarray.h>
 
 #include <chrono>
+#include <functional>
+#include <memory>
+#include <numeric>
 #include <sstream>
+#include <unordered_map>
+#include "../../event_timer.h"
 #include "../graph_runtime.h"
 
 namespace tvm {
@@ -58,6 +63,7 @@ class GraphRuntimeDebug : public GraphRuntime {
     GraphRuntime::Run();
     std::ostringstream os;
     std::vector<double> time_per_op(op_execs_.size(), 0);
+    std::vector<std::unique_ptr<EventTimer>> timers = MakeOpTimers();
     for (int i = 0; i < repeat; ++i) {
       std::chrono::time_point<
         std::chrono::high_resolution_clock, std::chrono::nanoseconds> tbegin, tend;
@@ -73,14 +79,9 @@ class GraphRuntimeDebug : public GraphRuntime {
         for (int k = 0; k < number; k++) {
           for (size_t index = 0; index < op_execs_.size(); ++index) {
             if (op_execs_[index]) {
-              const TVMContext& ctx = data_entry_[entry_id(index, 0)]->ctx;
-              auto op_tbegin = std::chrono::high_resolution_clock::now();
+              timers[index]->Start();
               op_execs_[index]();
-              TVMSynchronize(ctx.device_type, ctx.device_id, nullptr);
-              auto op_tend = std::chrono::high_resolution_clock::now();
-              double op_duration = std::chrono::duration_cast<
-                  std::chrono::duration<double> >(op_tend - op_tbegin).count();
-              time_per_op[index] += op_duration * 1e6;  // us
+              time_per_op[index] += timers[index]->Stop();  // us
             }
           }
         }
@@ -105,6 +106,68 @@ class GraphRuntimeDebug : public GraphRuntime {
     return os.str();
   }
 
+  /*!
+   * \brief Run each operation in the graph, and get its time along with the
+   *  work it does, to tell how much of the time ragged ops spend on padding.
+   *
+   *  The work of an op is counted in the elements of its outputs. Ragged
+   *  outputs hold fewer useful elements than their padded dense shape, as
+   *  given by the row lengths of the run, and ops whose kernels iterate over
+   *  the ragged extents only spend time on the useful ones.
+   * \param number The number of times to run each op for taking average.
+   * \return A JSON list with, for each op, its name, the mean time of a run
+   *  in microseconds, whether it was timed with device events, the padded
+   *  and useful elements of its outputs, the fraction of the padded
+   *  elements that are padding and the useful elements computed per second.
+   */
+  std::string ProfileOps(int number) {
+    GraphRuntime::Run();
+    std::vector<std::unique_ptr<EventTimer>> timers = MakeOpTimers();
+    // The sum of the row lengths of each lengths entry.
+    std::unordered_map<uint32_t, int64_t> row_sums;
+    std::ostringstream os;
+    os << "[";
+    bool first = true;
+    for (size_t nid = 0; nid < op_execs_.size(); ++nid) {
+      if (!op_execs_[nid]) continue;
+      double time_us = 0;
+      for (int k = 0; k < number; ++k) {
+        timers[nid]->Start();
+        op_execs_[nid]();
+        time_us += timers[nid]->Stop();
+      }
+      time_us /= number;
+
+      int64_t padded = 0, useful = 0;
+      for (uint32_t eid = node_row_ptr_[nid]; eid < node_row_ptr_[nid + 1]; ++eid) {
+        const std::vector<int64_t>& shape = attrs_.shape[eid];
+        int64_t dense = std::accumulate(shape.begin(), shape.end(), int64_t(1),
+                                        std::multiplies<int64_t>());
+        padded += dense;
+        if (attrs_.ragged_lengths.empty() || attrs_.ragged_lengths[eid] < 0) {
+          useful += dense;
+          continue;
+        }
+        uint32_t len_eid = static_cast<uint32_t>(attrs_.ragged_lengths[eid]);
+        if (!row_sums.count(len_eid)) row_sums[len_eid] = SumRowLengths(len_eid).second;
+        useful += row_sums[len_eid] * std::accumulate(shape.begin() + 2, shape.end(),
+                                                      int64_t(1), std::multiplies<int64_t>());
+      }
+      double padding = padded > 0 ? 1.0 - static_cast<double>(useful) / padded : 0.0;
+      double useful_per_sec = time_us > 0 ? useful / (time_us * 1e-6) : 0.0;
+
+      os << (first ? "\n" : ",\n") << "  {\"name\": \"" << GetNodeName(nid)
+         << "\", \"time_us\": " << time_us
+         << ", \"device_timer\": " << (timers[nid]->on_device() ? "true" : "false")
+         << ", \"padded_elems\": " << padded << ", \"useful_elems\": " << useful
+         << ", \"padding\": " << padding << ", \"useful_elems_per_sec\": " << useful_per_sec
+         << "}";
+      first = false;
+    }
+    os << "\n]\n";
+    return os.str();
+  }
+
   /*!
    * \brief Run each operation and get the output.
    * \param index The index of op which needs to be returned.
@@ -158,6 +221,18 @@ void DebugGetNodeOutput(int index, DLTensor* data_out) {
 
   data_entry_[eid].CopyTo(data_out);
 }
+
+ private:
+  // Make a timer on the context of each op.
+  std::vector<std::unique_ptr<EventTimer>> MakeOpTimers() {
+    std::vector<std::unique_ptr<EventTimer>> timers(op_execs_.size());
+    for (size_t index = 0; index < op_execs_.size(); ++index) {
+      if (op_execs_[index]) {
+        timers[index].reset(new EventTimer(data_entry_[entry_id(index, 0)]->ctx));
+      }
+    }
+    return timers;
+  }
 };
 
 
@@ -192,6 +267,12 @@ PackedFunc GraphRuntimeDebug::GetFunction(
       CHECK_GE(min_repeat_ms, 0);
       *rv = this->RunIndividual(number, repeat, min_repeat_ms);
     });
+  } else if (name == "profile_ops") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      int number = args[0];
+      CHECK_GT(number, 0);
+      *rv = this->ProfileOps(number);
+    });
   } else {
     return GraphRuntime::GetFunction(name, sptr_to_self);
   }
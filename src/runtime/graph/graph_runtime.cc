@@ -25,6 +25,7 @@
 #include <tvm/runtime/packed_func.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/runtime/serializer.h>
+#include <tvm/runtime/threading_backend.h>
 
 #include <algorithm>
 #include <functional>
@@ -35,6 +36,7 @@
 #include <utility>
 #include <vector>
 
+#include "../mapped_file.h"
 #include "graph_runtime.h"
 
 namespace tvm {
@@ -45,12 +47,38 @@ inline size_t GetDataAlignment(const DLTensor& arr) {
   if (align < kAllocAlignment) return kAllocAlignment;
   return align;
 }
+// Whether the data pointers of the device can be offset into, so that
+// entries can be placed inside a larger buffer.
+inline bool SupportsDataOffsets(int device_type) {
+  return device_type == kDLCPU || device_type == kDLGPU || device_type == kDLCPUPinned ||
+         device_type == kDLROCM;
+}
 }  // namespace details
 
 /*!
  * \brief Run all the operations one by one.
  */
 void GraphRuntime::Run() {
+  std::string prev_pool;
+  if (!thread_pool_.empty()) prev_pool = threading::BindThreadPool(thread_pool_);
+  struct PoolGuard {
+    bool bound;
+    const std::string& prev;
+    ~PoolGuard() { if (bound) threading::BindThreadPool(prev); }
+  } guard{!thread_pool_.empty(), prev_pool};
+  if (!storage_dense_bytes_.empty()) this->PlanRaggedStorage();
+  if (parallel_workers_ > 1) {
+    if (!parallel_) {
+      TVMContext device = ctxs_[0];
+      for (const auto& ctx : ctxs_) {
+        if (ctx.device_type != kDLCPU) device = ctx;
+      }
+      parallel_.reset(new ParallelExecutor(&op_execs_, OpDependencies(), parallel_workers_,
+                                           device, thread_pool_));
+    }
+    parallel_->Run();
+    return;
+  }
   // setup the array and requirements.
   for (size_t i = 0; i < op_execs_.size(); ++i) {
     if (op_execs_[i]) op_execs_[i]();
@@ -132,6 +160,27 @@ void GraphRuntime::SetInputZeroCopy(int index, DLTensor* data_ref) {
     t->data = data_ref->data;
   }
 }
+/*!
+ * \brief set a ragged input and its row lengths without copying them.
+ * \param index The input index of the packed ragged data.
+ * \param data_ref The packed ragged data that is referred.
+ * \param lengths_index The input index of the row lengths.
+ * \param lengths_ref The row lengths that are referred.
+ */
+void GraphRuntime::SetRaggedInputZeroCopy(int index, DLTensor* data_ref, int lengths_index,
+                                          DLTensor* lengths_ref) {
+  CHECK_NE(index, lengths_index);
+  CHECK_GE(data_ref->ndim, 1);
+  CHECK_EQ(lengths_ref->ndim, 1) << "The row lengths of a ragged input must be 1-D";
+  CHECK(lengths_ref->dtype.code == kDLInt && lengths_ref->dtype.lanes == 1)
+      << "The row lengths of a ragged input must be integers";
+  CHECK_EQ(lengths_ref->shape[0], data_ref->shape[0])
+      << "A ragged input needs one length per row";
+  // The packed data is smaller than its dense shape, which is all the
+  // dense checks of SetInputZeroCopy look at.
+  this->SetInputZeroCopy(index, data_ref);
+  this->SetInputZeroCopy(lengths_index, lengths_ref);
+}
 /*!
  * \brief Get the number of outputs
  *
@@ -220,6 +269,52 @@ void GraphRuntime::LoadParams(dmlc::Stream* strm) {
   }
 }
 
+void GraphRuntime::LoadParamsFromFile(const std::string& file_name) {
+  std::shared_ptr<MappedFile> file = MappedFile::Open(file_name);
+  std::unique_ptr<dmlc::SeekStream> strm = file->Stream();
+  uint64_t header, reserved;
+  CHECK(strm->Read(&header))
+      << "Invalid parameters file format";
+  CHECK(header == kTVMNDArrayListMagic)
+      << "Invalid parameters file format";
+  CHECK(strm->Read(&reserved))
+      << "Invalid parameters file format";
+
+  std::vector<std::string> names;
+  CHECK(strm->Read(&names))
+      << "Invalid parameters file format";
+  uint64_t sz;
+  strm->Read(&sz);
+  size_t size = static_cast<size_t>(sz);
+  CHECK(size == names.size())
+      << "Invalid parameters file format";
+  for (size_t i = 0; i < size; ++i) {
+    int in_idx = GetInputIndex(names[i]);
+    CHECK_GE(in_idx, 0) << "Found param for non-existent input: " << names[i];
+    uint32_t eid = this->entry_id(input_nodes_[in_idx], 0);
+    CHECK_LT(eid, data_entry_.size());
+
+    NDArray param = LoadMappedNDArray(strm.get(), file);
+    const DLTensor* old_t = data_entry_[eid].operator->();
+    const char* data = static_cast<const char*>(param->data);
+    bool mapped = data >= file->data() && data < file->data() + file->size();
+    bool in_place = mapped && old_t->ctx.device_type == kDLCPU && old_t->ndim == param->ndim &&
+                    old_t->dtype.code == param->dtype.code &&
+                    old_t->dtype.bits == param->dtype.bits &&
+                    old_t->dtype.lanes == param->dtype.lanes &&
+                    std::equal(old_t->shape, old_t->shape + old_t->ndim, param->shape);
+    if (!in_place) {
+      data_entry_[eid].CopyFrom(param);
+      continue;
+    }
+    // Use the mapping as the parameter, repointing the ops reading it.
+    data_entry_[eid] = param;
+    for (DLTensor* t : input_dltensors_[eid]) {
+      t->data = param->data;
+    }
+  }
+}
+
 void GraphRuntime::ShareParams(const GraphRuntime& other, dmlc::Stream* strm) {
     uint64_t header, reserved;
     CHECK(strm->Read(&header))
@@ -255,6 +350,24 @@ void GraphRuntime::SetupStorage() {
     vtype.push_back(tvm::runtime::String2DLDataType(s_type));
   }
 
+  // Ragged entries other than inputs, which are given packed, take no
+  // space until their row lengths are known, see PlanRaggedStorage.
+  std::unordered_set<uint32_t> input_eids;
+  for (uint32_t nid : input_nodes_) input_eids.insert(this->entry_id(nid, 0));
+  ragged_entry_.assign(attrs_.shape.size(), false);
+  std::vector<bool> ragged_storage;
+  bool has_ragged = false;
+  if (!attrs_.ragged_lengths.empty()) {
+    CHECK_EQ(attrs_.ragged_lengths.size(), attrs_.shape.size());
+    for (size_t i = 0; i < attrs_.shape.size(); ++i) {
+      if (attrs_.ragged_lengths[i] >= 0 && !input_eids.count(i)) {
+        CHECK_GE(attrs_.shape[i].size(), 2U) << "Ragged entries need a row and a length dimension";
+        ragged_entry_[i] = true;
+        has_ragged = true;
+      }
+    }
+  }
+
   // Size and device type of each storage pool entry.
   std::vector<PoolEntry> pool_entry;
   // Find the maximum space size.
@@ -273,11 +386,12 @@ void GraphRuntime::SetupStorage() {
     DLDataType t = vtype[i];
     size_t bits = t.bits * t.lanes;
     CHECK(bits % 8U ==  0U || bits ==1U);
-    size_t bytes = ((bits + 7U) / 8U) * size;
+    size_t bytes = ragged_entry_[i] ? 0 : ((bits + 7U) / 8U) * size;
 
     uint32_t sid = static_cast<uint32_t>(storage_id);
     if (sid >= pool_entry.size()) {
       pool_entry.resize(sid + 1, {0, -1});
+      ragged_storage.resize(sid + 1, false);
     } else {
       CHECK(pool_entry[sid].device_type == -1 ||
             pool_entry[sid].device_type == device_type)
@@ -285,6 +399,21 @@ void GraphRuntime::SetupStorage() {
     }
     pool_entry[sid].size = std::max(pool_entry[sid].size, bytes);
     pool_entry[sid].device_type = device_type;
+    if (ragged_entry_[i]) ragged_storage[sid] = true;
+  }
+
+  // With ragged entries, the pool entries holding no inputs are not
+  // allocated. Their entries are placed one by one in an arena per device
+  // before each run instead, see PlaceArenaEntries.
+  arena_storage_.assign(pool_entry.size(), false);
+  if (has_ragged) {
+    for (size_t sid = 0; sid < pool_entry.size(); ++sid) {
+      arena_storage_[sid] = details::SupportsDataOffsets(pool_entry[sid].device_type);
+    }
+    for (uint32_t eid : input_eids) arena_storage_[attrs_.storage_id[eid]] = false;
+    for (size_t sid = 0; sid < pool_entry.size(); ++sid) {
+      if (arena_storage_[sid]) pool_entry[sid].size = 0;
+    }
   }
 
   // Allocate the space.
@@ -297,10 +426,17 @@ void GraphRuntime::SetupStorage() {
           return pit.device_type == static_cast<int>(c.device_type);
         });
     TVMContext ctx = cit == ctxs_.end() ? ctxs_[0] : *cit;
-    shape.push_back(static_cast<int64_t>(pit.size + 3) / 4);
+    shape.push_back(std::max<int64_t>(static_cast<int64_t>(pit.size + 3) / 4, 1));
     storage_pool_.push_back(
         NDArray::Empty(shape, DLDataType{kDLFloat, 32, 1}, ctx));
   }
+  storage_dense_bytes_.clear();
+  if (has_ragged) {
+    for (size_t sid = 0; sid < pool_entry.size(); ++sid) {
+      // Pool entries without ragged entries never grow.
+      storage_dense_bytes_.push_back(ragged_storage[sid] ? pool_entry[sid].size : 0);
+    }
+  }
 
   // Assign the pooled entries. A unified memory pool is used to simplifiy
   // memory assignment for each node entry. The allocated memory on each device
@@ -310,16 +446,224 @@ void GraphRuntime::SetupStorage() {
   for (size_t i = 0; i < data_entry_.size(); ++i) {
     int storage_id = attrs_.storage_id[i];
     CHECK_LT(static_cast<size_t>(storage_id), storage_pool_.size());
-    data_entry_[i] =
-        storage_pool_[storage_id].CreateView(attrs_.shape[i], vtype[i]);
+    if (ragged_entry_[i] || arena_storage_[storage_id]) {
+      const NDArray& storage = storage_pool_[storage_id];
+      data_entry_[i] = NDArray::RaggedFromData(storage->data, attrs_.shape[i], vtype[i],
+                                               storage->ctx);
+    } else {
+      data_entry_[i] = storage_pool_[storage_id].CreateView(attrs_.shape[i], vtype[i]);
+    }
     const DLTensor* tmp = data_entry_[i].operator->();
     data_alignment_[i] = details::GetDataAlignment(*tmp);
   }
+
+  // The arena entries, their dense sizes, and the range of ops from the
+  // one writing them to the last one reading them. Outputs stay live.
+  arena_entries_.clear();
+  arena_.clear();
+  entry_dense_bytes_.assign(data_entry_.size(), 0);
+  entry_live_.assign(data_entry_.size(), {0, 0});
+  for (size_t i = 0; i < data_entry_.size(); ++i) {
+    if (!arena_storage_[attrs_.storage_id[i]]) continue;
+    arena_entries_.push_back(static_cast<uint32_t>(i));
+    if (!ragged_entry_[i]) entry_dense_bytes_[i] = GetDataSize(*data_entry_[i].operator->());
+  }
+  for (uint32_t nid = 0; nid < nodes_.size(); ++nid) {
+    for (uint32_t eid = node_row_ptr_[nid]; eid < node_row_ptr_[nid + 1]; ++eid) {
+      entry_live_[eid] = {nid, nid};
+    }
+    for (const auto& e : nodes_[nid].inputs) {
+      auto& live = entry_live_[this->entry_id(e)];
+      live.second = std::max(live.second, nid);
+    }
+  }
+  for (const auto& e : outputs_) {
+    entry_live_[this->entry_id(e)].second = static_cast<uint32_t>(nodes_.size());
+  }
+}
+
+std::pair<int64_t, int64_t> GraphRuntime::SumRowLengths(uint32_t eid) {
+  // The row lengths, as bound for this run if they are an input.
+  const DLTensor* lengths =
+      input_dltensors_[eid].empty() ? data_entry_[eid].operator->() : input_dltensors_[eid][0];
+  NDArray host_lengths;
+  if (lengths->ctx.device_type != kDLCPU) {
+    host_lengths = NDArray::Empty(std::vector<int64_t>(lengths->shape,
+                                                       lengths->shape + lengths->ndim),
+                                  lengths->dtype, {kDLCPU, 0});
+    host_lengths.CopyFrom(lengths);
+    lengths = host_lengths.operator->();
+  }
+  CHECK(lengths->dtype.code == kDLInt && lengths->dtype.lanes == 1)
+      << "The row lengths of a ragged entry must be integers";
+  int64_t num_rows = std::accumulate(lengths->shape, lengths->shape + lengths->ndim,
+                                     int64_t(1), std::multiplies<int64_t>());
+  const char* base = static_cast<const char*>(lengths->data) + lengths->byte_offset;
+  int64_t total = 0;
+  for (int64_t r = 0; r < num_rows; ++r) {
+    total += lengths->dtype.bits == 64 ? reinterpret_cast<const int64_t*>(base)[r]
+                                       : reinterpret_cast<const int32_t*>(base)[r];
+  }
+  return {num_rows, total};
+}
+
+void GraphRuntime::PlanRaggedStorage() {
+  std::vector<size_t> bytes = storage_dense_bytes_;
+  std::vector<size_t> entry_bytes = entry_dense_bytes_;
+  // The number of rows and the sum of the row lengths of each lengths entry.
+  std::unordered_map<uint32_t, std::pair<int64_t, int64_t>> sums;
+  for (size_t eid = 0; eid < ragged_entry_.size(); ++eid) {
+    if (!ragged_entry_[eid]) continue;
+    uint32_t len_eid = static_cast<uint32_t>(attrs_.ragged_lengths[eid]);
+    CHECK_LT(len_eid, data_entry_.size());
+    if (!sums.count(len_eid)) sums[len_eid] = SumRowLengths(len_eid);
+    int64_t num_rows = sums[len_eid].first, total = sums[len_eid].second;
+    const std::vector<int64_t>& shape = attrs_.shape[eid];
+    CHECK_EQ(num_rows, shape[0]) << "A ragged entry needs one length per row";
+    size_t inner = std::accumulate(shape.begin() + 2, shape.end(), size_t(1),
+                                   std::multiplies<size_t>());
+    DLDataType t = data_entry_[eid]->dtype;
+    size_t packed = ((t.bits * t.lanes + 7U) / 8U) * inner * static_cast<size_t>(total);
+    size_t sid = static_cast<size_t>(attrs_.storage_id[eid]);
+    if (arena_storage_[sid]) {
+      entry_bytes[eid] = packed;
+    } else {
+      bytes[sid] = std::max(bytes[sid], packed);
+    }
+  }
+  if (!arena_entries_.empty()) this->PlaceArenaEntries(entry_bytes);
+
+  for (size_t sid = 0; sid < bytes.size(); ++sid) {
+    NDArray old_storage = storage_pool_[sid];
+    if (bytes[sid] <= static_cast<size_t>(old_storage->shape[0]) * 4) continue;
+    // Grow the pool entry, and repoint the entries and the op arguments
+    // still viewing it; inputs bound without copying keep their data.
+    std::vector<int64_t> shape{static_cast<int64_t>(bytes[sid] + 3) / 4};
+    storage_pool_[sid] = NDArray::Empty(shape, DLDataType{kDLFloat, 32, 1}, old_storage->ctx);
+    void* data = storage_pool_[sid]->data;
+    for (size_t eid = 0; eid < data_entry_.size(); ++eid) {
+      if (static_cast<size_t>(attrs_.storage_id[eid]) != sid ||
+          data_entry_[eid]->data != old_storage->data) {
+        continue;
+      }
+      std::vector<int64_t> eshape = attrs_.shape[eid];
+      if (ragged_entry_[eid]) {
+        data_entry_[eid] = NDArray::RaggedFromData(data, eshape, data_entry_[eid]->dtype,
+                                                   old_storage->ctx);
+      } else {
+        data_entry_[eid] = storage_pool_[sid].CreateView(eshape, data_entry_[eid]->dtype);
+      }
+    }
+    for (DLTensor* t : storage_dltensors_[sid]) {
+      if (t->data == old_storage->data) t->data = data;
+    }
+  }
+}
+
+void GraphRuntime::PlaceArenaEntries(const std::vector<size_t>& entry_bytes) {
+  auto aligned = [&entry_bytes](uint32_t eid) {
+    return (entry_bytes[eid] + kAllocAlignment - 1) / kAllocAlignment * kAllocAlignment;
+  };
+  // Entries live at the same time must not overlap. Ops running
+  // concurrently follow the dependencies of the static plan, not these
+  // live ranges, so then no entries share space.
+  bool reuse = parallel_workers_ <= 1;
+  auto overlap = [this, reuse](uint32_t a, uint32_t b) {
+    return !reuse || !(entry_live_[a].second < entry_live_[b].first ||
+                       entry_live_[b].second < entry_live_[a].first);
+  };
+  // Place the largest entries first, each at the lowest offset clear of
+  // the placed entries it overlaps with on its device.
+  std::vector<uint32_t> order = arena_entries_;
+  std::stable_sort(order.begin(), order.end(), [&aligned](uint32_t a, uint32_t b) {
+    return aligned(a) > aligned(b);
+  });
+  std::vector<size_t> offset(data_entry_.size(), 0);
+  std::unordered_map<int, size_t> total;
+  std::vector<uint32_t> placed;
+  for (uint32_t eid : order) {
+    int device_type = data_entry_[eid]->ctx.device_type;
+    std::vector<std::pair<size_t, size_t>> busy;
+    for (uint32_t other : placed) {
+      if (data_entry_[other]->ctx.device_type != device_type || !overlap(eid, other)) continue;
+      busy.emplace_back(offset[other], offset[other] + aligned(other));
+    }
+    std::sort(busy.begin(), busy.end());
+    size_t off = 0;
+    for (const auto& range : busy) {
+      if (off + aligned(eid) <= range.first) break;
+      off = std::max(off, range.second);
+    }
+    offset[eid] = off;
+    total[device_type] = std::max(total[device_type], off + aligned(eid));
+    placed.push_back(eid);
+  }
+
+  // Arenas only ever grow, so steady state runs do not allocate.
+  for (const auto& kv : total) {
+    auto it = arena_.find(kv.first);
+    if (it != arena_.end() && kv.second <= static_cast<size_t>(it->second->shape[0]) * 4) {
+      continue;
+    }
+    const auto& cit = std::find_if(ctxs_.begin(), ctxs_.end(), [&kv](const TVMContext& c) {
+      return kv.first == static_cast<int>(c.device_type);
+    });
+    TVMContext ctx = cit == ctxs_.end() ? ctxs_[0] : *cit;
+    std::vector<int64_t> shape{std::max<int64_t>(static_cast<int64_t>(kv.second + 3) / 4, 1)};
+    arena_[kv.first] = NDArray::Empty(shape, DLDataType{kDLFloat, 32, 1}, ctx);
+  }
+
+  // Repoint the entries and the op arguments viewing them.
+  for (uint32_t eid : arena_entries_) {
+    const NDArray& arena = arena_.at(data_entry_[eid]->ctx.device_type);
+    void* data = static_cast<char*>(arena->data) + offset[eid];
+    if (data_entry_[eid]->data == data) continue;
+    data_entry_[eid] = NDArray::RaggedFromData(data, attrs_.shape[eid], data_entry_[eid]->dtype,
+                                               arena->ctx);
+    for (DLTensor* t : entry_dltensors_[eid]) t->data = data;
+  }
+}
+
+std::vector<std::vector<uint32_t>> GraphRuntime::OpDependencies() const {
+  std::vector<std::vector<uint32_t>> deps(nodes_.size());
+  // The last op writing each storage pool entry, and the ops reading it
+  // since.
+  std::vector<int> writer(storage_pool_.size(), -1);
+  std::vector<std::vector<uint32_t>> readers(storage_pool_.size());
+  for (uint32_t nid = 0; nid < nodes_.size(); ++nid) {
+    const auto& inode = nodes_[nid];
+    if (inode.op_type == "null") continue;
+    std::unordered_set<uint32_t> dep_set;
+    for (const auto& e : inode.inputs) {
+      if (nodes_[e.node_id].op_type != "null") dep_set.insert(e.node_id);
+      int sid = attrs_.storage_id[this->entry_id(e)];
+      if (writer[sid] >= 0) dep_set.insert(writer[sid]);
+    }
+    for (uint32_t index = 0; index < inode.param.num_outputs; ++index) {
+      int sid = attrs_.storage_id[this->entry_id(nid, index)];
+      if (writer[sid] >= 0) dep_set.insert(writer[sid]);
+      for (uint32_t reader : readers[sid]) dep_set.insert(reader);
+    }
+    dep_set.erase(nid);
+    for (const auto& e : inode.inputs) {
+      readers[attrs_.storage_id[this->entry_id(e)]].push_back(nid);
+    }
+    for (uint32_t index = 0; index < inode.param.num_outputs; ++index) {
+      int sid = attrs_.storage_id[this->entry_id(nid, index)];
+      writer[sid] = nid;
+      readers[sid].clear();
+    }
+    deps[nid].assign(dep_set.begin(), dep_set.end());
+  }
+  return deps;
 }
 
 void GraphRuntime::SetupOpExecs() {
+  parallel_.reset();
   op_execs_.resize(this->GetNumOfNodes());
   input_dltensors_.resize(num_node_entries());
+  storage_dltensors_.assign(storage_dense_bytes_.size(), {});
+  entry_dltensors_.assign(num_node_entries(), {});
   std::unordered_set<uint32_t> input_node_eids;
   for (size_t i = 0; i < input_nodes_.size(); i++) {
     uint32_t nid = input_nodes_[i];
@@ -345,6 +689,19 @@ void GraphRuntime::SetupOpExecs() {
     std::tie(op_execs_[nid], op_args) =
         CreateTVMOp(inode.param, args, inode.inputs.size());
 
+    if (!storage_dense_bytes_.empty()) {
+      for (size_t i = 0; i < args.size(); ++i) {
+        uint32_t eid = i < inode.inputs.size() ? this->entry_id(inode.inputs[i])
+                                               : this->entry_id(nid, i - inode.inputs.size());
+        DLTensor* t = static_cast<DLTensor*>(op_args->arg_values[i].v_handle);
+        if (arena_storage_[attrs_.storage_id[eid]]) {
+          entry_dltensors_[eid].push_back(t);
+        } else {
+          storage_dltensors_[attrs_.storage_id[eid]].push_back(t);
+        }
+      }
+    }
+
     for (size_t i = 0; i < inode.inputs.size(); i++) {
       uint32_t eid = this->entry_id(inode.inputs[i]);
       // check if op input is model input
@@ -430,6 +787,14 @@ PackedFunc GraphRuntime::GetFunction(
         this->SetInputZeroCopy(args[0], args[1]);
       }
     });
+  } else if (name == "set_ragged_input_zero_copy") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      int in_idx = args[0].type_code() == kTVMStr ? this->GetInputIndex(args[0]) : args[0];
+      int len_idx = args[2].type_code() == kTVMStr ? this->GetInputIndex(args[2]) : args[2];
+      if (in_idx >= 0 && len_idx >= 0) {
+        this->SetRaggedInputZeroCopy(in_idx, args[1], len_idx, args[3]);
+      }
+    });
   } else if (name == "get_output") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       if (args.num_args == 2) {
@@ -457,10 +822,22 @@ PackedFunc GraphRuntime::GetFunction(
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
         this->Run();
       });
+  } else if (name == "set_parallelism") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        this->SetParallelism(args[0]);
+      });
+  } else if (name == "set_thread_pool") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        this->SetThreadPool(args[0]);
+      });
   } else if (name == "load_params") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
         this->LoadParams(args[0].operator std::string());
       });
+  } else if (name == "load_params_from_file") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        this->LoadParamsFromFile(args[0]);
+      });
   } else if (name == "share_params") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
         const auto& module = args[0].operator Module();
@@ -37,6 +37,8 @@
 #include <vector>
 #include <string>
 
+#include "parallel_executor.h"
+
 namespace tvm {
 namespace runtime {
 
@@ -90,6 +92,27 @@ class GraphRuntime : public ModuleNode {
     return "GraphRuntime";
   }
   void Run();
+  /*!
+   * \brief Run the graph on a named thread pool, so that runtimes running
+   *  concurrently on disjoint cores do not share workers.
+   * \param name The name of the pool, empty for the default pool of the
+   *  thread calling Run.
+   */
+  void SetThreadPool(const std::string& name) {
+    thread_pool_ = name;
+    parallel_.reset();
+  }
+  /*!
+   * \brief Run the independent ops of the graph concurrently.
+   * \param num_workers The number of threads running ops, 1 to run them
+   *  one by one in topological order. On a graph with GPU ops, each
+   *  thread launches them on a stream of its own.
+   */
+  void SetParallelism(int num_workers) {
+    CHECK_GE(num_workers, 1);
+    parallel_workers_ = num_workers;
+    parallel_.reset();
+  }
 
   /*!
    * \brief Initialize the graph executor with graph and context.
@@ -123,6 +146,17 @@ class GraphRuntime : public ModuleNode {
    * \param data_ref The input data that is referred.
    */
   void SetInputZeroCopy(int index, DLTensor* data_ref);
+  /*!
+   * \brief set a ragged input to the graph, along with the input holding
+   *  its row lengths, without copying either of them.
+   * \param index The input index of the packed ragged data.
+   * \param data_ref The packed ragged data that is referred, whose shape is
+   *  the dense shape of the input.
+   * \param lengths_index The input index of the row lengths.
+   * \param lengths_ref The row lengths that are referred.
+   */
+  void SetRaggedInputZeroCopy(int index, DLTensor* data_ref, int lengths_index,
+                              DLTensor* lengths_ref);
   /*!
    * \brief Get the number of outputs
    *
@@ -159,6 +193,15 @@ class GraphRuntime : public ModuleNode {
    * \param param_blob A binary blob of parameter.
    */
   void LoadParams(const std::string& param_blob);
+  /*!
+   * \brief Load parameters from a parameter file by mapping it into memory.
+   *
+   *  Parameters on devices are copied from the mapping directly. Those on
+   *  the CPU whose data is aligned in the file, as saved by
+   *  save_param_dict with an alignment, are used in place.
+   * \param file_name The name of the parameter file.
+   */
+  void LoadParamsFromFile(const std::string& file_name);
 
   /*!
    * \brief Share parameters from pre-existing GraphRuntime instance.
@@ -275,6 +318,9 @@ class GraphRuntime : public ModuleNode {
     std::vector<int> device_index;
     std::vector<std::string> dltype;
     std::vector<std::vector<int64_t> > shape;
+    // The entry holding the row lengths of each ragged entry, -1 for
+    // dense entries.
+    std::vector<int> ragged_lengths;
     // The graph attribute fields.
     void Load(dmlc::JSONReader *reader) {
       reader->BeginObject();
@@ -316,6 +362,14 @@ class GraphRuntime : public ModuleNode {
           CHECK(reader->NextArrayItem());
           reader->Read(&device_index);
           CHECK(!reader->NextArrayItem());
+        } else if (key == "ragged_lengths") {
+          reader->BeginArray();
+          CHECK(reader->NextArrayItem());
+          reader->Read(&type);
+          CHECK_EQ(type, "list_int");
+          CHECK(reader->NextArrayItem());
+          reader->Read(&ragged_lengths);
+          CHECK(!reader->NextArrayItem());
         } else {
           reader->BeginArray();
           CHECK(reader->NextArrayItem());
@@ -368,6 +422,30 @@ class GraphRuntime : public ModuleNode {
   }
   /*! \brief Setup the temporal storage */
   void SetupStorage();
+  /*!
+   * \brief Grow the storage pool entries holding ragged entries to the
+   *  size of their packed data for the current row lengths.
+   */
+  void PlanRaggedStorage();
+  /*!
+   * \brief Get the number of rows and the sum of the lengths of the row
+   *  lengths held by an entry.
+   */
+  std::pair<int64_t, int64_t> SumRowLengths(uint32_t eid);
+  /*!
+   * \brief Place the arena entries in one arena per device, by their
+   *  sizes for the current row lengths and their live ranges, and
+   *  repoint them.
+   * \param entry_bytes The bytes each arena entry needs for this run.
+   */
+  void PlaceArenaEntries(const std::vector<size_t>& entry_bytes);
+  /*!
+   * \brief Get the ops each op has to run after: those producing its
+   *  inputs, and those using its output storage before it in
+   *  topological order, as storage is planned for running the ops one
+   *  by one.
+   */
+  std::vector<std::vector<uint32_t>> OpDependencies() const;
   /*! \brief Setup the executors. */
   void SetupOpExecs();
   /*!
@@ -398,6 +476,8 @@ class GraphRuntime : public ModuleNode {
   std::vector<uint32_t> input_nodes_;
   /*! \brief Map of input names to input indices. */
   std::unordered_map<std::string, uint32_t> input_map_;
+  /*! \brief The thread pool the graph runs on. */
+  std::string thread_pool_;
   /*! \brief Used for quick node input DLTensor* lookup given an input eid. */
   std::vector<std::vector<DLTensor*>> input_dltensors_;
   /*! \brief Used for quick entry indexing. */
@@ -416,8 +496,33 @@ class GraphRuntime : public ModuleNode {
   std::vector<NDArray> data_entry_;
   /*! \brief Data alignment of each node. */
   std::vector<size_t> data_alignment_;
+  /*! \brief Whether the storage of each entry is sized for its ragged data
+   *  at run time. */
+  std::vector<bool> ragged_entry_;
+  /*! \brief The bytes each storage pool entry needs for its dense entries. */
+  std::vector<size_t> storage_dense_bytes_;
+  /*! \brief The op arguments viewing each storage pool entry that holds
+   *  ragged entries, to repoint when it grows. */
+  std::vector<std::vector<DLTensor*>> storage_dltensors_;
+  /*! \brief Whether the entries of each storage pool entry are placed in
+   *  the arena rather than in the pool entry. */
+  std::vector<bool> arena_storage_;
+  /*! \brief The entries placed in the arena. */
+  std::vector<uint32_t> arena_entries_;
+  /*! \brief The bytes each dense arena entry needs. */
+  std::vector<size_t> entry_dense_bytes_;
+  /*! \brief The first and last op using each entry. */
+  std::vector<std::pair<uint32_t, uint32_t>> entry_live_;
+  /*! \brief The op arguments viewing each arena entry. */
+  std::vector<std::vector<DLTensor*>> entry_dltensors_;
+  /*! \brief The arena of each device type. */
+  std::unordered_map<int, NDArray> arena_;
   /*! \brief Operator on each node. */
   std::vector<std::function<void()> > op_execs_;
+  /*! \brief The number of threads running ops. */
+  int parallel_workers_{1};
+  /*! \brief The executor running ops concurrently, made on the next run. */
+  std::unique_ptr<ParallelExecutor> parallel_;
 };
 
 std::vector<TVMContext> GetAllContext(const TVMArgs& args);
@@ -0,0 +1,173 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file parallel_executor.cc
+ */
+#include "parallel_executor.h"
+
+#include <dmlc/logging.h>
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/threading_backend.h>
+
+#include <utility>
+
+namespace tvm {
+namespace runtime {
+
+ParallelExecutor::ParallelExecutor(const std::vector<std::function<void()>>* ops,
+                                   std::vector<std::vector<uint32_t>> deps, int num_workers,
+                                   TVMContext device, std::string thread_pool)
+    : ops_(ops), deps_(std::move(deps)), device_(device),
+      use_streams_(device.device_type != kDLCPU), thread_pool_(std::move(thread_pool)) {
+  CHECK_EQ(ops_->size(), deps_.size());
+  CHECK_GE(num_workers, 1);
+  consumers_.resize(ops_->size());
+  for (uint32_t nid = 0; nid < ops_->size(); ++nid) {
+    if (!(*ops_)[nid]) continue;
+    ++num_ops_;
+    if (deps_[nid].empty()) roots_.push_back(nid);
+    for (uint32_t dep : deps_[nid]) consumers_[dep].push_back(nid);
+  }
+  op_worker_.resize(ops_->size(), -1);
+  pending_.resize(ops_->size(), 0);
+  if (use_streams_) {
+    DeviceAPI* api = DeviceAPI::Get(device_);
+    for (int i = 0; i < num_workers; ++i) streams_.push_back(api->CreateStream(device_));
+    for (size_t nid = 0; nid < ops_->size(); ++nid) {
+      events_.push_back((*ops_)[nid] ? api->CreateEvent(device_) : nullptr);
+    }
+  }
+  for (int i = 1; i < num_workers; ++i) {
+    threads_.emplace_back([this, i]() { this->RunWorker(i); });
+  }
+}
+
+ParallelExecutor::~ParallelExecutor() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    exit_ = true;
+  }
+  cv_.notify_all();
+  for (auto& t : threads_) t.join();
+  if (use_streams_) {
+    DeviceAPI* api = DeviceAPI::Get(device_);
+    for (void* event : events_) {
+      if (event != nullptr) api->FreeEvent(device_, event);
+    }
+    for (TVMStreamHandle stream : streams_) api->FreeStream(device_, stream);
+  }
+}
+
+void ParallelExecutor::Run() {
+  DeviceAPI* api = use_streams_ ? DeviceAPI::Get(device_) : nullptr;
+  TVMStreamHandle prev_stream = nullptr;
+  if (use_streams_) {
+    prev_stream = api->GetStream(device_);
+    // The ops launched on the stream of the caller so far come first.
+    void* event = api->CreateEvent(device_);
+    api->RecordEvent(device_, event, prev_stream);
+    for (TVMStreamHandle stream : streams_) api->StreamWaitEvent(device_, stream, event);
+    api->FreeEvent(device_, event);
+    api->SetStream(device_, streams_[0]);
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t nid = 0; nid < deps_.size(); ++nid) {
+      pending_[nid] = static_cast<int>(deps_[nid].size());
+    }
+    ready_.assign(roots_.begin(), roots_.end());
+    num_done_ = 0;
+    error_ = nullptr;
+  }
+  cv_.notify_all();
+  while (true) {
+    uint32_t nid;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() { return !ready_.empty() || num_done_ == num_ops_; });
+      if (ready_.empty()) break;
+      nid = ready_.front();
+      ready_.pop_front();
+    }
+    RunOp(0, nid);
+  }
+  if (use_streams_) {
+    for (TVMStreamHandle stream : streams_) api->StreamSync(device_, stream);
+    api->SetStream(device_, prev_stream);
+  }
+  if (error_) std::rethrow_exception(error_);
+}
+
+void ParallelExecutor::RunWorker(int worker_id) {
+  if (use_streams_) DeviceAPI::Get(device_)->SetStream(device_, streams_[worker_id]);
+  if (!thread_pool_.empty()) threading::BindThreadPool(thread_pool_);
+  while (true) {
+    uint32_t nid;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() { return !ready_.empty() || exit_; });
+      if (exit_) return;
+      nid = ready_.front();
+      ready_.pop_front();
+    }
+    RunOp(worker_id, nid);
+  }
+}
+
+void ParallelExecutor::RunOp(int worker_id, uint32_t nid) {
+  bool failed;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    failed = error_ != nullptr;
+  }
+  // Once an op failed, the remaining ones are only counted as done.
+  if (!failed) {
+    try {
+      if (use_streams_) {
+        DeviceAPI* api = DeviceAPI::Get(device_);
+        for (uint32_t dep : deps_[nid]) {
+          if (op_worker_[dep] != worker_id) {
+            api->StreamWaitEvent(device_, streams_[worker_id], events_[dep]);
+          }
+        }
+        (*ops_)[nid]();
+        api->RecordEvent(device_, events_[nid], streams_[worker_id]);
+      } else {
+        (*ops_)[nid]();
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!error_) error_ = std::current_exception();
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    op_worker_[nid] = worker_id;
+    for (uint32_t consumer : consumers_[nid]) {
+      if (--pending_[consumer] == 0) ready_.push_back(consumer);
+    }
+    ++num_done_;
+  }
+  cv_.notify_all();
+}
+
+}  // namespace runtime
+}  // namespace tvm
@@ -0,0 +1,109 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file parallel_executor.h
+ * \brief Runs the ops of a graph on several threads, each with its own
+ *  stream, following the dependencies between them.
+ */
+#ifndef TVM_RUNTIME_GRAPH_PARALLEL_EXECUTOR_H_
+#define TVM_RUNTIME_GRAPH_PARALLEL_EXECUTOR_H_
+
+#include <tvm/runtime/c_runtime_api.h>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+
+/*!
+ * \brief Runs the ops of a graph concurrently: an op becomes ready once
+ *  the ops producing its inputs have run, and ready ops are run by the
+ *  first idle worker.
+ *
+ *  If a device context is given, every worker launches its ops on a
+ *  stream of its own, and an op waits, through an event, for the ops it
+ *  depends on that were launched on the streams of other workers, so
+ *  that independent branches of the graph overlap on the device.
+ */
+class ParallelExecutor {
+ public:
+  /*!
+   * \param ops The executors of the ops, empty for nodes that are not ops.
+   * \param deps The ops each op depends on.
+   * \param num_workers The number of workers, including the thread
+   *  calling Run.
+   * \param device The device whose streams the workers launch on, of
+   *  type kDLCPU for none.
+   * \param thread_pool The thread pool the workers bind to, see
+   *  threading::BindThreadPool.
+   */
+  ParallelExecutor(const std::vector<std::function<void()>>* ops,
+                   std::vector<std::vector<uint32_t>> deps, int num_workers, TVMContext device,
+                   std::string thread_pool);
+  ~ParallelExecutor();
+  /*!
+   * \brief Run all ops, returning once they have. Rethrows the first
+   *  error an op raised, after the ops already started have finished.
+   */
+  void Run();
+
+ private:
+  // The body of the workers; worker 0 is the thread calling Run.
+  void RunWorker(int worker_id);
+  // Run an op on a worker, then make the ops depending on it ready.
+  void RunOp(int worker_id, uint32_t nid);
+
+  const std::vector<std::function<void()>>* ops_;
+  std::vector<std::vector<uint32_t>> deps_;
+  std::vector<std::vector<uint32_t>> consumers_;
+  std::vector<uint32_t> roots_;
+  int num_ops_{0};
+  TVMContext device_;
+  bool use_streams_;
+  std::string thread_pool_;
+  // The stream of each worker, and the event recorded after each op.
+  std::vector<TVMStreamHandle> streams_;
+  std::vector<void*> events_;
+  // The worker each op ran on in the current run.
+  std::vector<int> op_worker_;
+  // The number of ops each op still waits for in the current run.
+  std::vector<int> pending_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<uint32_t> ready_;
+  int num_done_{0};
+  bool exit_{false};
+  std::exception_ptr error_;
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_GRAPH_PARALLEL_EXECUTOR_H_
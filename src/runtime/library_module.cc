@@ -49,6 +49,12 @@ class LibraryModuleNode final : public ModuleNode {
       const std::string& name,
       const ObjectPtr<Object>& sptr_to_self) final {
     TVMBackendPackedCFunc faddr;
+    if (name == runtime::symbol::tvm_get_fast_call) {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        std::string fname = args[0].operator std::string() + runtime::symbol::tvm_fast_call_suffix;
+        *rv = lib_->GetSymbol(fname.c_str());
+      });
+    }
     if (name == runtime::symbol::tvm_module_main) {
       const char* entry_name = reinterpret_cast<const char*>(
           lib_->GetSymbol(runtime::symbol::tvm_module_main));
@@ -109,6 +115,7 @@ void InitContextFunctions(std::function<void*(const char*)> fgetsymbol) {
   TVM_INIT_CONTEXT_FUNC(TVMBackendFreeWorkspace);
   TVM_INIT_CONTEXT_FUNC(TVMBackendParallelLaunch);
   TVM_INIT_CONTEXT_FUNC(TVMBackendParallelBarrier);
+  TVM_INIT_CONTEXT_FUNC(TVMBackendParallelNextChunk);
 
   #undef TVM_INIT_CONTEXT_FUNC
 }
@@ -0,0 +1,155 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file mapped_file.cc
+ * \brief Memory mapped files, and the loading of NDArrays that view them.
+ */
+#include <dmlc/logging.h>
+#include <dmlc/memory_io.h>
+#include <tvm/runtime/device_api.h>
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+#include "mapped_file.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tvm {
+namespace runtime {
+
+std::shared_ptr<MappedFile> MappedFile::Open(const std::string& file_name) {
+  std::shared_ptr<MappedFile> file(new MappedFile());
+#if !defined(_WIN32)
+  int fd = open(file_name.c_str(), O_RDONLY);
+  CHECK_GE(fd, 0) << "Cannot open " << file_name;
+  struct stat st;
+  CHECK_EQ(fstat(fd, &st), 0) << "Cannot stat " << file_name;
+  file->size_ = static_cast<size_t>(st.st_size);
+  if (file->size_ != 0) {
+    void* ptr = mmap(nullptr, file->size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (ptr != MAP_FAILED) {
+      file->data_ = static_cast<char*>(ptr);
+      file->mapped_ = true;
+    }
+  }
+  close(fd);
+  if (file->mapped_ || file->size_ == 0) return file;
+  LOG(WARNING) << "Cannot map " << file_name << ", reading it instead";
+#endif
+  std::ifstream fs(file_name, std::ios::in | std::ios::binary);
+  CHECK(!fs.fail()) << "Cannot open " << file_name;
+  fs.seekg(0, std::ios::end);
+  file->size_ = static_cast<size_t>(fs.tellg());
+  fs.seekg(0, std::ios::beg);
+  // Allocated like NDArrays, so that the arrays viewing it are aligned.
+  file->data_ = static_cast<char*>(DeviceAPI::Get({kDLCPU, 0})->AllocDataSpace(
+      {kDLCPU, 0}, std::max<size_t>(file->size_, 1), kAllocAlignment, DLDataType{kDLUInt, 8, 1}));
+  fs.read(file->data_, file->size_);
+  return file;
+}
+
+MappedFile::~MappedFile() {
+  if (data_ == nullptr) return;
+#if !defined(_WIN32)
+  if (mapped_) {
+    munmap(data_, size_);
+    return;
+  }
+#endif
+  DeviceAPI::Get({kDLCPU, 0})->FreeDataSpace({kDLCPU, 0}, data_);
+}
+
+std::unique_ptr<dmlc::SeekStream> MappedFile::Stream() const {
+  return std::unique_ptr<dmlc::SeekStream>(new dmlc::MemoryFixedSizeStream(data_, size_));
+}
+
+namespace {
+
+// The DLPack tensor of an array viewing a mapped file, which holds the
+// mapping until the array is freed.
+struct MappedTensor {
+  DLManagedTensor managed;
+  std::vector<int64_t> shape;
+  std::shared_ptr<MappedFile> file;
+};
+
+void MappedTensorDeleter(DLManagedTensor* tensor) {
+  delete static_cast<MappedTensor*>(tensor->manager_ctx);
+}
+
+}  // namespace
+
+NDArray LoadMappedNDArray(dmlc::SeekStream* strm, const std::shared_ptr<MappedFile>& file) {
+  size_t start = strm->Tell();
+  uint64_t header, reserved;
+  DLContext ctx;
+  int ndim;
+  DLDataType dtype;
+  CHECK(strm->Read(&header)) << "Invalid DLTensor file format";
+  CHECK(strm->Read(&reserved)) << "Invalid DLTensor file format";
+  CHECK(header == kTVMNDArrayMagic) << "Invalid DLTensor file format";
+  CHECK(strm->Read(&ctx)) << "Invalid DLTensor file format";
+  CHECK(strm->Read(&ndim)) << "Invalid DLTensor file format";
+  CHECK(strm->Read(&dtype)) << "Invalid DLTensor file format";
+  CHECK_EQ(ctx.device_type, kDLCPU) << "Invalid DLTensor context: can only save as CPU tensor";
+  std::vector<int64_t> shape(ndim);
+  if (ndim != 0) {
+    CHECK(strm->ReadArray(&shape[0], ndim)) << "Invalid DLTensor file format";
+  }
+  int64_t data_byte_size;
+  CHECK(strm->Read(&data_byte_size)) << "Invalid DLTensor file format";
+  size_t offset = strm->Tell() + static_cast<size_t>(reserved);
+  CHECK_LE(offset + static_cast<size_t>(data_byte_size), file->size())
+      << "Invalid DLTensor file format";
+  char* data = file->data() + offset;
+
+  if (!DMLC_IO_NO_ENDIAN_SWAP || reinterpret_cast<size_t>(data) % kAllocAlignment != 0) {
+    strm->Seek(start);
+    NDArray ret;
+    ret.Load(strm);
+    return ret;
+  }
+  strm->Seek(offset + static_cast<size_t>(data_byte_size));
+  MappedTensor* tensor = new MappedTensor();
+  tensor->shape = std::move(shape);
+  tensor->file = file;
+  DLTensor& dl_tensor = tensor->managed.dl_tensor;
+  dl_tensor.data = data;
+  dl_tensor.ctx = ctx;
+  dl_tensor.ndim = ndim;
+  dl_tensor.dtype = dtype;
+  dl_tensor.shape = tensor->shape.data();
+  dl_tensor.strides = nullptr;
+  dl_tensor.byte_offset = 0;
+  tensor->managed.manager_ctx = tensor;
+  tensor->managed.deleter = MappedTensorDeleter;
+  return NDArray::FromDLPack(&tensor->managed);
+}
+
+}  // namespace runtime
+}  // namespace tvm
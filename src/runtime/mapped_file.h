@@ -0,0 +1,84 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file mapped_file.h
+ * \brief Memory mapped files, and the loading of NDArrays that view them.
+ */
+#ifndef TVM_RUNTIME_MAPPED_FILE_H_
+#define TVM_RUNTIME_MAPPED_FILE_H_
+
+#include <dmlc/io.h>
+#include <tvm/runtime/ndarray.h>
+
+#include <memory>
+#include <string>
+
+namespace tvm {
+namespace runtime {
+
+/*!
+ * \brief A file mapped into memory, copy on write, so that arrays viewing
+ *  it can be written without changing the file.
+ *
+ *  The mapping is shared by the arrays viewing it and unmapped when the
+ *  last of them is freed. Where files cannot be mapped, they are read.
+ */
+class MappedFile {
+ public:
+  /*!
+   * \brief Map a file.
+   * \param file_name The name of the file.
+   * \return The mapping.
+   */
+  static std::shared_ptr<MappedFile> Open(const std::string& file_name);
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /*! \brief The contents of the file. */
+  char* data() const { return data_; }
+  /*! \brief The size of the file. */
+  size_t size() const { return size_; }
+  /*! \brief A stream over the contents of the file. */
+  std::unique_ptr<dmlc::SeekStream> Stream() const;
+
+ private:
+  MappedFile() = default;
+
+  char* data_{nullptr};
+  size_t size_{0};
+  /*! \brief Whether data_ is mapped rather than read. */
+  bool mapped_{false};
+};
+
+/*!
+ * \brief Load an NDArray saved by SaveDLTensor from a stream over a mapped
+ *  file. The array views the mapping in place if its data is aligned for
+ *  NDArrays, and is loaded like NDArray::Load otherwise.
+ * \param strm The stream, at the position the array was saved at.
+ * \param file The mapped file the stream is over.
+ * \return The array, on the CPU.
+ */
+NDArray LoadMappedNDArray(dmlc::SeekStream* strm, const std::shared_ptr<MappedFile>& file);
+
+}  // namespace runtime
+}  // namespace tvm
+#endif  // TVM_RUNTIME_MAPPED_FILE_H_
@@ -0,0 +1,178 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file memory_profile.cc
+ * \brief Profiling of the memory the runtime allocates.
+ */
+#include "memory_profile.h"
+
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/registry.h>
+
+#include <chrono>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <type_traits>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace {
+
+constexpr int kMaxProfiledDeviceTypes = 32;
+constexpr int kMaxProfiledDeviceIds = 8;
+
+const char* SiteName(int site) { return site == kMemSiteWorkspace ? "workspace" : "ndarray"; }
+
+// Live and peak bytes, on a cache line of their own.
+struct alignas(64) MemoryCounter {
+  std::atomic<int64_t> current{0};
+  std::atomic<int64_t> peak{0};
+
+  void Add(int64_t nbytes) {
+    int64_t value = current.fetch_add(nbytes, std::memory_order_relaxed) + nbytes;
+    int64_t old_peak = peak.load(std::memory_order_relaxed);
+    while (old_peak < value &&
+           !peak.compare_exchange_weak(old_peak, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  void Reset() {
+    current.store(0, std::memory_order_relaxed);
+    peak.store(0, std::memory_order_relaxed);
+  }
+};
+
+struct TimelineEntry {
+  int64_t us;
+  int device_type;
+  int device_id;
+  int site;
+  int64_t live;
+};
+
+struct MemoryProfile {
+  MemoryCounter total;
+  MemoryCounter devices[kMaxProfiledDeviceTypes][kMaxProfiledDeviceIds][kNumMemSites];
+  std::atomic<bool> timeline{false};
+  std::chrono::steady_clock::time_point origin;
+  std::mutex mutex;
+  std::vector<TimelineEntry> entries;
+};
+
+MemoryProfile* GetMemoryProfile() {
+  // Constructed in static storage, which unlike plain new honors the
+  // alignment of the counters, and never destroyed, so that arrays
+  // freed at exit can still be recorded.
+  static std::aligned_storage<sizeof(MemoryProfile), alignof(MemoryProfile)>::type storage;
+  static MemoryProfile* profile = new (&storage) MemoryProfile();
+  return profile;
+}
+
+}  // namespace
+
+std::atomic<bool> MemoryProfiler::enabled_{false};
+
+void MemoryProfiler::SetEnabled(bool enabled, bool timeline) {
+  MemoryProfile* profile = GetMemoryProfile();
+  if (enabled) {
+    std::lock_guard<std::mutex> lock(profile->mutex);
+    profile->total.Reset();
+    for (auto& ids : profile->devices) {
+      for (auto& sites : ids) {
+        for (auto& counter : sites) counter.Reset();
+      }
+    }
+    profile->entries.clear();
+    profile->origin = std::chrono::steady_clock::now();
+    profile->timeline.store(timeline);
+  }
+  enabled_.store(enabled);
+}
+
+void MemoryProfiler::Record(TVMContext ctx, MemorySite site, int64_t nbytes) {
+  MemoryProfile* profile = GetMemoryProfile();
+  profile->total.Add(nbytes);
+  int device_type = static_cast<int>(ctx.device_type);
+  if (device_type < 0 || device_type >= kMaxProfiledDeviceTypes || ctx.device_id < 0 ||
+      ctx.device_id >= kMaxProfiledDeviceIds) {
+    return;
+  }
+  MemoryCounter& counter = profile->devices[device_type][ctx.device_id][site];
+  counter.Add(nbytes);
+  if (profile->timeline.load(std::memory_order_relaxed)) {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(profile->mutex);
+    int64_t us =
+        std::chrono::duration_cast<std::chrono::microseconds>(now - profile->origin).count();
+    profile->entries.push_back({us, device_type, ctx.device_id, site,
+                                counter.current.load(std::memory_order_relaxed)});
+  }
+}
+
+int64_t MemoryProfiler::Peak() { return GetMemoryProfile()->total.peak.load(); }
+
+std::string MemoryProfiler::ToJSON() {
+  MemoryProfile* profile = GetMemoryProfile();
+  std::lock_guard<std::mutex> lock(profile->mutex);
+  std::ostringstream os;
+  os << "{\"current\": " << profile->total.current.load()
+     << ", \"peak\": " << profile->total.peak.load() << ", \"devices\": [";
+  bool first = true;
+  for (int type = 0; type < kMaxProfiledDeviceTypes; ++type) {
+    for (int id = 0; id < kMaxProfiledDeviceIds; ++id) {
+      for (int site = 0; site < kNumMemSites; ++site) {
+        const MemoryCounter& counter = profile->devices[type][id][site];
+        if (counter.peak.load() == 0) continue;
+        os << (first ? "" : ", ") << "{\"device\": \"" << DeviceName(type) << "\", \"id\": " << id
+           << ", \"site\": \"" << SiteName(site) << "\", \"current\": " << counter.current.load()
+           << ", \"peak\": " << counter.peak.load() << "}";
+        first = false;
+      }
+    }
+  }
+  os << "], \"timeline\": [";
+  for (size_t i = 0; i < profile->entries.size(); ++i) {
+    const TimelineEntry& entry = profile->entries[i];
+    os << (i == 0 ? "" : ", ") << "[" << entry.us << ", \"" << DeviceName(entry.device_type)
+       << "\", " << entry.device_id << ", \"" << SiteName(entry.site) << "\", " << entry.live
+       << "]";
+  }
+  os << "]}";
+  return os.str();
+}
+
+TVM_REGISTER_GLOBAL("runtime.GetMaxMemConsumption").set_body_typed([]() {
+  // In kilobytes.
+  return MemoryProfiler::Peak() / 1024;
+});
+
+TVM_REGISTER_GLOBAL("runtime.SetMemProfiling").set_body([](TVMArgs args, TVMRetValue* rv) {
+  bool timeline = args.size() > 1 ? static_cast<bool>(args[1]) : false;
+  MemoryProfiler::SetEnabled(args[0], timeline);
+});
+
+TVM_REGISTER_GLOBAL("runtime.GetMemProfile").set_body_typed([]() {
+  return MemoryProfiler::ToJSON();
+});
+
+}  // namespace runtime
+}  // namespace tvm
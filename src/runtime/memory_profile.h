@@ -0,0 +1,87 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file memory_profile.h
+ * \brief Profiling of the memory the runtime allocates for workspaces
+ *  and NDArrays.
+ */
+#ifndef TVM_RUNTIME_MEMORY_PROFILE_H_
+#define TVM_RUNTIME_MEMORY_PROFILE_H_
+
+#include <tvm/runtime/c_runtime_api.h>
+
+#include <atomic>
+#include <string>
+
+namespace tvm {
+namespace runtime {
+
+/*! \brief The kind of allocation a profiled allocation is made by. */
+enum MemorySite : int {
+  kMemSiteWorkspace = 0,
+  kMemSiteNDArray = 1,
+  kNumMemSites = 2
+};
+
+/*!
+ * \brief Live and peak bytes allocated by the runtime, overall and per
+ *  device and allocation site, with an optional timeline of the
+ *  allocations.
+ *
+ *  The counters are only updated while profiling is enabled. Each
+ *  device and site has counters of its own, on a cache line of its own,
+ *  so that threads allocating on different devices do not contend, and
+ *  peaks are raised with compare-and-swap, so that concurrent
+ *  allocations never lower them.
+ */
+class MemoryProfiler {
+ public:
+  /*! \brief Whether allocations are being profiled. */
+  static bool Enabled() { return enabled_.load(std::memory_order_relaxed); }
+  /*!
+   * \brief Start or stop profiling. Starting resets the counters.
+   * \param enabled Whether to profile.
+   * \param timeline Whether to also record every allocation and free.
+   */
+  static void SetEnabled(bool enabled, bool timeline);
+  /*!
+   * \brief Record an allocation, or a free if nbytes is negative.
+   * \param ctx The context of the allocation.
+   * \param site The kind of allocation.
+   * \param nbytes The number of bytes allocated.
+   */
+  static void Record(TVMContext ctx, MemorySite site, int64_t nbytes);
+  /*! \brief The overall peak of live bytes since profiling started. */
+  static int64_t Peak();
+  /*!
+   * \brief The profile as a JSON document, with the current and peak
+   *  bytes overall and per device and site, and the timeline of
+   *  (microseconds since profiling started, device, site, live bytes
+   *  on the device) entries if one is recorded.
+   */
+  static std::string ToJSON();
+
+ private:
+  static std::atomic<bool> enabled_;
+};
+
+}  // namespace runtime
+}  // namespace tvm
+#endif  // TVM_RUNTIME_MEMORY_PROFILE_H_
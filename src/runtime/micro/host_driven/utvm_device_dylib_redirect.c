@@ -36,6 +36,12 @@ void *(*TVMBackendAllocWorkspace_)(int, int, uint64_t, int, int) =
     (void *(*)(int, int, uint64_t, int, int)) NULL;
 int (*TVMBackendFreeWorkspace_)(int, int, void*) = (int (*)(int, int, void*)) NULL;
 void (*TVMAPISetLastError_)(const char*) = (void (*)(const char*)) NULL;
+void (*TVMBackendCopyMemory_)(const void*, size_t, void*, size_t, size_t, int, int, int, int,
+                              int, int) =
+    (void (*)(const void*, size_t, void*, size_t, size_t, int, int, int, int, int, int)) NULL;
+void (*TVMBackendCopyMemoryAsync_)(const void*, size_t, void*, size_t, size_t, int, int, int,
+                                   int, int, int) =
+    (void (*)(const void*, size_t, void*, size_t, size_t, int, int, int, int, int, int)) NULL;
 
 void* TVMBackendAllocWorkspace(int device_type, int device_id, uint64_t size,
     int dtype_code_hint, int dtype_bits_hint) {
@@ -51,6 +57,22 @@ void TVMAPISetLastError(const char* msg) {
   (*TVMAPISetLastError_)(msg);
 }
 
+void TVMBackendCopyMemory(const void* from, size_t from_offset, void* to, size_t to_offset,
+    size_t num_bytes, int from_device_type, int from_device_id, int to_device_type,
+    int to_device_id, int dtype_code_hint, int dtype_bits_hint) {
+  (*TVMBackendCopyMemory_)(from, from_offset, to, to_offset, num_bytes, from_device_type,
+                           from_device_id, to_device_type, to_device_id, dtype_code_hint,
+                           dtype_bits_hint);
+}
+
+void TVMBackendCopyMemoryAsync(const void* from, size_t from_offset, void* to, size_t to_offset,
+    size_t num_bytes, int from_device_type, int from_device_id, int to_device_type,
+    int to_device_id, int dtype_code_hint, int dtype_bits_hint) {
+  (*TVMBackendCopyMemoryAsync_)(from, from_offset, to, to_offset, num_bytes, from_device_type,
+                                from_device_id, to_device_type, to_device_id, dtype_code_hint,
+                                dtype_bits_hint);
+}
+
 #ifdef __cplusplus
 }  // TVM_EXTERN_C
 #endif
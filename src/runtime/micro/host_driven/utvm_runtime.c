@@ -114,6 +114,29 @@ int TVMBackendFreeWorkspace(int device_type, int device_id, void* ptr) {
   }
 }
 
+// On the device, the host and device buffers of a ragged kernel, such as
+// the lengths and the auxiliary arrays written by its prelude, are in the
+// same memory, so the prelude copies them in place.
+void TVMBackendCopyMemory(const void* from, size_t from_offset, void* to, size_t to_offset,
+                          size_t num_bytes, int from_device_type, int from_device_id,
+                          int to_device_type, int to_device_id, int dtype_code_hint,
+                          int dtype_bits_hint) {
+  const char* src = (const char*) from + from_offset;  // NOLINT(*)
+  char* dst = (char*) to + to_offset;  // NOLINT(*)
+  for (size_t i = 0; i < num_bytes; i++) {
+    dst[i] = src[i];
+  }
+}
+
+void TVMBackendCopyMemoryAsync(const void* from, size_t from_offset, void* to,
+                               size_t to_offset, size_t num_bytes, int from_device_type,
+                               int from_device_id, int to_device_type, int to_device_id,
+                               int dtype_code_hint, int dtype_bits_hint) {
+  TVMBackendCopyMemory(from, from_offset, to, to_offset, num_bytes, from_device_type,
+                       from_device_id, to_device_type, to_device_id, dtype_code_hint,
+                       dtype_bits_hint);
+}
+
 void TVMAPISetLastError(const char* msg) {
   utvm_last_error = msg;
 }
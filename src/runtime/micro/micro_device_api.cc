@@ -50,7 +50,10 @@ class MicroDeviceAPI final : public DeviceAPI {
                        size_t alignment,
                        DLDataType type_hint) final {
     ObjectPtr<MicroSession>& session = MicroSession::Current();
-    void* data = session->AllocateInSection(SectionKind::kHeap, nbytes).cast_to<void*>();
+    void* data = session->AllocateInArena(nbytes).cast_to<void*>();
+    if (data == nullptr) {
+      data = session->AllocateInSection(SectionKind::kHeap, nbytes).cast_to<void*>();
+    }
     CHECK(data != nullptr) << "unable to allocate " << nbytes << " bytes on device heap";
     MicroDevSpace* dev_space = new MicroDevSpace();
     dev_space->data = data;
@@ -60,8 +63,11 @@ class MicroDeviceAPI final : public DeviceAPI {
 
   void FreeDataSpace(TVMContext ctx, void* ptr) final {
     MicroDevSpace* dev_space = static_cast<MicroDevSpace*>(ptr);
-    dev_space->session->FreeInSection(
-      SectionKind::kHeap, DevPtr(reinterpret_cast<std::uintptr_t>(dev_space->data)));
+    DevPtr addr(reinterpret_cast<std::uintptr_t>(dev_space->data));
+    // Arrays in the arena are released with it.
+    if (!dev_space->session->InArena(addr)) {
+      dev_space->session->FreeInSection(SectionKind::kHeap, addr);
+    }
     delete dev_space;
   }
 
@@ -312,6 +312,8 @@ BinaryInfo MicroSession::LoadBinary(const std::string& binary_path, bool patch_d
     PatchImplHole(symbol_map, "TVMBackendAllocWorkspace");
     PatchImplHole(symbol_map, "TVMBackendFreeWorkspace");
     PatchImplHole(symbol_map, "TVMAPISetLastError");
+    PatchImplHole(symbol_map, "TVMBackendCopyMemory");
+    PatchImplHole(symbol_map, "TVMBackendCopyMemoryAsync");
   }
 
   return BinaryInfo {
@@ -462,6 +464,35 @@ void MicroSession::FreeInSection(SectionKind type, DevPtr addr) {
   return GetAllocator(type)->Free(addr);
 }
 
+void MicroSession::ReserveArena(size_t size) {
+  CHECK(arena_size_ == 0) << "a micro arena is already reserved";
+  CHECK(size > 0) << "cannot reserve an empty micro arena";
+  size = UpperAlignValue(size, word_size_);
+  arena_start_ = AllocateInSection(SectionKind::kHeap, size);
+  arena_size_ = size;
+  arena_used_ = 0;
+}
+
+void MicroSession::ReleaseArena() {
+  CHECK(arena_size_ > 0) << "no micro arena is reserved";
+  FreeInSection(SectionKind::kHeap, arena_start_);
+  arena_start_ = DevPtr(nullptr);
+  arena_size_ = 0;
+  arena_used_ = 0;
+}
+
+DevPtr MicroSession::AllocateInArena(size_t size) {
+  if (arena_size_ == 0) {
+    return DevPtr(nullptr);
+  }
+  size_t offset = UpperAlignValue(arena_used_, word_size_);
+  CHECK_LE(offset + size, arena_size_)
+      << "cannot alloc " << size << " bytes in micro arena of " << arena_size_ << " bytes, "
+      << "with " << offset << " bytes in use";
+  arena_used_ = offset + size;
+  return arena_start_ + offset;
+}
+
 template <typename T>
 T MicroSession::DevSymbolRead(const SymbolMap& symbol_map, const std::string& symbol) {
   DevPtr sym_addr = symbol_map[symbol];
@@ -489,6 +520,19 @@ PackedFunc MicroSession::GetFunction(
     return PackedFunc([sptr_to_self](TVMArgs args, TVMRetValue* rv) {
       MicroSession::ExitWithScope();
     });
+  } else if (name == "reserve_arena") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      int64_t size = args[0];
+      ReserveArena(static_cast<size_t>(size));
+    });
+  } else if (name == "release_arena") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      ReleaseArena();
+    });
+  } else if (name == "arena_used") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      *rv = static_cast<int64_t>(arena_used_);
+    });
   } else {
     return PackedFunc();
   }
@@ -162,6 +162,38 @@ class MicroSession : public ModuleNode {
    */
   void FreeInSection(SectionKind type, DevPtr addr);
 
+  /*!
+   * \brief reserve a static arena in the heap section, from which device arrays are
+   *  allocated until the arena is released
+   * \param size size of the arena in bytes, e.g. from the `l_maxes` of the ragged
+   *  tensors and auxiliary arrays of a model
+   * \note allocations in the arena are never freed individually, so arrays allocated
+   *  once at their maximum size can be reused by every call without touching the
+   *  session allocators
+   */
+  void ReserveArena(size_t size);
+
+  /*!
+   * \brief release the arena, after which arrays allocated in it must not be used
+   */
+  void ReleaseArena();
+
+  /*!
+   * \brief allocate memory in the arena
+   * \param size size of allocated memory in bytes
+   * \return pointer to allocated memory, nullptr if no arena is reserved
+   */
+  DevPtr AllocateInArena(size_t size);
+
+  /*!
+   * \brief whether `addr` was allocated in the arena
+   */
+  bool InArena(DevPtr addr) const {
+    uint64_t val = addr.value().val64;
+    return arena_size_ > 0 && val >= arena_start_.value().val64 &&
+           val < arena_start_.value().val64 + arena_size_;
+  }
+
   /*!
    * \brief read string from device to host
    * \param str_addr device address of first character of string
@@ -215,6 +247,12 @@ class MicroSession : public ModuleNode {
   bool thumb_mode_;
   /*! \brief symbol map for the device runtime */
   SymbolMap runtime_symbol_map_;
+  /*! \brief start of the static arena in the heap section */
+  DevPtr arena_start_{nullptr};
+  /*! \brief size of the static arena, 0 if none is reserved */
+  size_t arena_size_{0};
+  /*! \brief number of bytes allocated in the static arena */
+  size_t arena_used_{0};
 
   /*!
    * \brief patches a function pointer in this module to an implementation
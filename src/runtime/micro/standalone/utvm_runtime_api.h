@@ -38,6 +38,7 @@ TVM_MICRO_RUNTIME_API_BACKEND_API void* TVMBackendAllocWorkspace(int device_type
 typedef struct {
   void* sync_handle;
   int32_t num_task;
+  void* chunk_handle;
 } TVMParallelGroupEnv;
 
 typedef int (*FTVMParallelLambda)(int task_id, TVMParallelGroupEnv* penv, void* cdata);
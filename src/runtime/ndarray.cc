@@ -26,8 +26,12 @@
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/ndarray.h>
 
+#include <cstring>
+#include <vector>
+
+#include "memory_profile.h"
+#include "prep_code_cache.h"
 #include "runtime_base.h"
-#include "workspace_pool.h"
 
 extern "C" {
 // C-mangled dlpack deleter.
@@ -67,9 +71,10 @@ struct NDArray::Internal {
       static_cast<NDArray::Container*>(ptr->manager_ctx)->DecRef();
     } else if (ptr->dl_tensor.data != nullptr) {
       size_t size = GetDataSize(ptr->dl_tensor);
-      if (WorkspacePool::mem_prof_on_) {
-        WorkspacePool::current_memory_usage_ -= size;
+      if (MemoryProfiler::Enabled()) {
+        MemoryProfiler::Record(ptr->dl_tensor.ctx, kMemSiteNDArray, -static_cast<int64_t>(size));
       }
+      PrepCodeCache::Global()->Forget(ptr->dl_tensor.data);
       tvm::runtime::DeviceAPI::Get(ptr->dl_tensor.ctx)
           ->FreeDataSpace(ptr->dl_tensor.ctx, ptr->dl_tensor.data);
     }
@@ -88,6 +93,10 @@ struct NDArray::Internal {
     }
     delete ptr;
   }
+  // Deleter for NDArray over data owned by the caller
+  static void ExternalDeleter(Object* ptr_obj) {
+    delete static_cast<NDArray::Container*>(ptr_obj);
+  }
   // Local create function which allocates tensor metadata
   // but does not allocate space for the data.
   static NDArray Create(std::vector<int64_t> shape, DLDataType dtype, DLContext ctx) {
@@ -155,6 +164,53 @@ NDArray NDArray::CreateView(std::vector<int64_t> shape, DLDataType dtype) {
   return ret;
 }
 
+NDArray NDArray::CreateOffsetView(int64_t elem_offset, std::vector<int64_t> shape,
+                                  int64_t elem_limit) {
+  CHECK(data_ != nullptr);
+  CHECK(get_mutable()->dl_tensor.strides == nullptr) << "Can only create view for compact tensor";
+  CHECK_GE(elem_offset, 0);
+  DLDataType dtype = get_mutable()->dl_tensor.dtype;
+  NDArray ret = Internal::Create(shape, dtype, get_mutable()->dl_tensor.ctx);
+  size_t offset_size = static_cast<size_t>(elem_offset * GetDLDataTypeBytes(dtype));
+  ret.get_mutable()->dl_tensor.byte_offset =
+      this->get_mutable()->dl_tensor.byte_offset + offset_size;
+  size_t curr_size = GetDataSize(this->get_mutable()->dl_tensor);
+  size_t view_size = GetDataSize(ret.get_mutable()->dl_tensor);
+  CHECK_LE(offset_size + view_size, curr_size)
+      << "Tries to create a view that extends past the end of the current one";
+  if (elem_limit >= 0) {
+    // The dense size of a ragged array overestimates its data, so
+    // check against the end of the row instead.
+    size_t limit_size = static_cast<size_t>(elem_limit * GetDLDataTypeBytes(dtype));
+    CHECK_LE(offset_size + view_size, limit_size)
+        << "Tries to create a view that extends past the end of its ragged row";
+  }
+  // increase ref count
+  get_mutable()->IncRef();
+  ret.get_mutable()->manager_ctx = get_mutable();
+  ret.get_mutable()->dl_tensor.data = get_mutable()->dl_tensor.data;
+  return ret;
+}
+
+NDArray NDArray::CreateRaggedView(std::vector<int64_t> dense_shape, int64_t flat_size) {
+  CHECK(data_ != nullptr);
+  CHECK(get_mutable()->dl_tensor.strides == nullptr) << "Can only create view for compact tensor";
+  CHECK_GE(flat_size, 0);
+  size_t curr_size = GetDataSize(this->get_mutable()->dl_tensor);
+  size_t flat_bytes =
+      static_cast<size_t>(flat_size * GetDLDataTypeBytes(get_mutable()->dl_tensor.dtype));
+  CHECK_LE(flat_bytes, curr_size)
+      << "Tries to create a ragged view whose rows extend past the end of the current array";
+  NDArray ret =
+      Internal::Create(dense_shape, get_mutable()->dl_tensor.dtype, get_mutable()->dl_tensor.ctx);
+  ret.get_mutable()->dl_tensor.byte_offset = this->get_mutable()->dl_tensor.byte_offset;
+  // increase ref count
+  get_mutable()->IncRef();
+  ret.get_mutable()->manager_ctx = get_mutable();
+  ret.get_mutable()->dl_tensor.data = get_mutable()->dl_tensor.data;
+  return ret;
+}
+
 DLManagedTensor* NDArray::ToDLPack() const { return Internal::ToDLPack(get_mutable()); }
 
 NDArray NDArray::Empty(std::vector<int64_t> shape, DLDataType dtype, DLContext ctx) {
@@ -165,10 +221,8 @@ NDArray NDArray::Empty(std::vector<int64_t> shape, DLDataType dtype, DLContext c
   ret.get_mutable()->dl_tensor.data =
       DeviceAPI::Get(ret->ctx)->AllocDataSpace(ret->ctx, size, alignment, ret->dtype);
 
-  if (WorkspacePool::mem_prof_on_) {
-    WorkspacePool::current_memory_usage_ += size;
-    if (WorkspacePool::current_memory_usage_ > WorkspacePool::max_memory_usage_)
-      WorkspacePool::max_memory_usage_.exchange(WorkspacePool::current_memory_usage_);
+  if (MemoryProfiler::Enabled()) {
+    MemoryProfiler::Record(ret->ctx, kMemSiteNDArray, static_cast<int64_t>(size));
   }
 
   return ret;
@@ -183,15 +237,22 @@ NDArray NDArray::RaggedEmpty(std::vector<int64_t> shape, int64_t flat_size, DLDa
   ret.get_mutable()->dl_tensor.data =
       DeviceAPI::Get(ret->ctx)->AllocDataSpace(ret->ctx, size, alignment, ret->dtype);
 
-  if (WorkspacePool::mem_prof_on_) {
-    WorkspacePool::current_memory_usage_ += size;
-    if (WorkspacePool::current_memory_usage_ > WorkspacePool::max_memory_usage_)
-      WorkspacePool::max_memory_usage_.exchange(WorkspacePool::current_memory_usage_);
+  if (MemoryProfiler::Enabled()) {
+    MemoryProfiler::Record(ret->ctx, kMemSiteNDArray, static_cast<int64_t>(size));
   }
 
   return ret;
 }
 
+NDArray NDArray::RaggedFromData(void* data, std::vector<int64_t> dense_shape, DLDataType dtype,
+                                DLContext ctx) {
+  CHECK(data != nullptr);
+  NDArray ret = Internal::Create(dense_shape, dtype, ctx);
+  ret.get_mutable()->SetDeleter(Internal::ExternalDeleter);
+  ret.get_mutable()->dl_tensor.data = data;
+  return ret;
+}
+
 NDArray NDArray::FromDLPack(DLManagedTensor* tensor) {
   NDArray::Container* data = new NDArray::Container();
   // construct header
@@ -208,11 +269,13 @@ void NDArray::CopyFromTo(const DLTensor* from, DLTensor* to, TVMStreamHandle str
   CHECK_EQ(from_size, to_size) << "TVMArrayCopyFromTo: The size must exactly match";
 
   CHECK(from->ctx.device_type == to->ctx.device_type || from->ctx.device_type == kDLCPU ||
-        to->ctx.device_type == kDLCPU)
+        to->ctx.device_type == kDLCPU || from->ctx.device_type == kDLCPUPinned ||
+        to->ctx.device_type == kDLCPUPinned)
       << "Can not copy across different ctx types directly";
 
   // Use the context that is *not* a cpu context to get the correct device
-  // api manager.
+  // api manager. Pinned host memory is managed by the device api of the
+  // device it is pinned for.
   TVMContext ctx = from->ctx.device_type != kDLCPU ? from->ctx : to->ctx;
 
   DeviceAPI::Get(ctx)->CopyDataFromTo(from->data, static_cast<size_t>(from->byte_offset), to->data,
@@ -270,6 +333,22 @@ int TVMRaggedArrayAlloc(const tvm_index_t* shape, const tvm_index_t flat_size, i
   API_END();
 }
 
+int TVMRaggedArrayFromData(void* data, const tvm_index_t* dense_shape, int ndim, int dtype_code,
+                           int dtype_bits, int dtype_lanes, int device_type, int device_id,
+                           TVMArrayHandle* out) {
+  API_BEGIN();
+  DLDataType dtype;
+  dtype.code = static_cast<uint8_t>(dtype_code);
+  dtype.bits = static_cast<uint8_t>(dtype_bits);
+  dtype.lanes = static_cast<uint16_t>(dtype_lanes);
+  DLContext ctx;
+  ctx.device_type = static_cast<DLDeviceType>(device_type);
+  ctx.device_id = device_id;
+  *out = NDArray::Internal::MoveToFFIHandle(NDArray::RaggedFromData(
+      data, std::vector<int64_t>(dense_shape, dense_shape + ndim), dtype, ctx));
+  API_END();
+}
+
 int TVMArrayCreateView(TVMArrayHandle array, const tvm_index_t* new_shape, int ndim, int dtype_code,
                        int dtype_bits, int dtype_lanes, TVMArrayHandle* out) {
   API_BEGIN();
@@ -283,6 +362,26 @@ int TVMArrayCreateView(TVMArrayHandle array, const tvm_index_t* new_shape, int n
   API_END();
 }
 
+int TVMArrayCreateOffsetView(TVMArrayHandle array, int64_t elem_offset,
+                             const tvm_index_t* new_shape, int ndim, int64_t elem_limit,
+                             TVMArrayHandle* out) {
+  API_BEGIN();
+  *out = NDArray::Internal::MoveToFFIHandle(
+      NDArray::FromDLPack(NDArray::Internal::ToDLPack(array))
+          .CreateOffsetView(elem_offset, std::vector<int64_t>(new_shape, new_shape + ndim),
+                            elem_limit));
+  API_END();
+}
+
+int TVMArrayCreateRaggedView(TVMArrayHandle array, const tvm_index_t* dense_shape, int ndim,
+                             int64_t flat_size, TVMArrayHandle* out) {
+  API_BEGIN();
+  *out = NDArray::Internal::MoveToFFIHandle(
+      NDArray::FromDLPack(NDArray::Internal::ToDLPack(array))
+          .CreateRaggedView(std::vector<int64_t>(dense_shape, dense_shape + ndim), flat_size));
+  API_END();
+}
+
 int TVMArrayFree(TVMArrayHandle handle) {
   API_BEGIN();
   NDArray::Internal::FFIDecRef(handle);
@@ -326,6 +425,51 @@ int TVMArrayCopyFromBytes(TVMArrayHandle handle, void* data, size_t nbytes, bool
   API_END();
 }
 
+int TVMArrayCopyFromBytesBatch(TVMArrayHandle* handles, void** data, size_t* nbytes, int num) {
+  API_BEGIN();
+  TVMContext cpu_ctx;
+  cpu_ctx.device_type = kDLCPU;
+  cpu_ctx.device_id = 0;
+  if (num == 0) return 0;
+  TVMContext ctx = handles[0]->ctx;
+  std::vector<size_t> offsets(num);
+  size_t total = 0;
+  for (int i = 0; i < num; ++i) {
+    CHECK(handles[i]->ctx.device_type == ctx.device_type &&
+          handles[i]->ctx.device_id == ctx.device_id)
+        << "TVMArrayCopyFromBytesBatch: arrays on different contexts";
+    CHECK_LE(nbytes[i], GetDataSize(*handles[i])) << "TVMArrayCopyFromBytesBatch: size mismatch";
+    offsets[i] = total;
+    total += (nbytes[i] + kAllocAlignment - 1) / kAllocAlignment * kAllocAlignment;
+  }
+  DeviceAPI* device = DeviceAPI::Get(ctx);
+  if (ctx.device_type == kDLCPU || num == 1) {
+    for (int i = 0; i < num; ++i) {
+      device->CopyDataFromTo(data[i], 0, handles[i]->data,
+                             static_cast<size_t>(handles[i]->byte_offset), nbytes[i], cpu_ctx,
+                             ctx, handles[i]->dtype, nullptr);
+    }
+    return 0;
+  }
+  std::vector<char> host_staging(total);
+  for (int i = 0; i < num; ++i) {
+    std::memcpy(host_staging.data() + offsets[i], data[i], nbytes[i]);
+  }
+  DLDataType type_hint{kDLUInt, 8, 1};
+  void* staging = device->AllocWorkspace(ctx, total, type_hint);
+  device->CopyDataFromTo(host_staging.data(), 0, staging, 0, total, cpu_ctx, ctx, type_hint,
+                         nullptr);
+  for (int i = 0; i < num; ++i) {
+    device->CopyDataFromTo(staging, offsets[i], handles[i]->data,
+                           static_cast<size_t>(handles[i]->byte_offset), nbytes[i], ctx, ctx,
+                           handles[i]->dtype, nullptr);
+  }
+  // The scatter is ordered before later uses of the workspace on the
+  // stream, so the staging buffer can be freed right away.
+  device->FreeWorkspace(ctx, staging);
+  API_END();
+}
+
 int TVMArrayCopyToBytes(TVMArrayHandle handle, void* data, size_t nbytes, bool is_src_ragged) {
   API_BEGIN();
   TVMContext cpu_ctx;
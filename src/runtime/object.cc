@@ -23,6 +23,8 @@
 #include <dmlc/logging.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/runtime/object.h>
+#include <tvm/runtime/memory.h>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -204,6 +206,23 @@ uint32_t Object::TypeKey2Index(const std::string& key) {
 }
 
 
+ObjectPool*& ObjectPool::ThreadLocal() {
+  static thread_local ObjectPool* pool = nullptr;
+  return pool;
+}
+
+// The pools of the python driver, which can not scope them.
+static thread_local std::vector<std::unique_ptr<ObjectPoolScope>> python_pool_scopes;
+
+TVM_REGISTER_GLOBAL("runtime.ObjectPoolEnter").set_body_typed([]() {
+  python_pool_scopes.emplace_back(new ObjectPoolScope());
+});
+
+TVM_REGISTER_GLOBAL("runtime.ObjectPoolExit").set_body_typed([]() {
+  CHECK(!python_pool_scopes.empty()) << "ObjectPoolExit without ObjectPoolEnter";
+  python_pool_scopes.pop_back();
+});
+
 TVM_REGISTER_GLOBAL("runtime.ObjectHash")
 .set_body_typed([](ObjectRef obj) {
   return static_cast<int64_t>(ObjectHash()(obj));
@@ -0,0 +1,139 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file prep_code_cache.cc
+ * \brief Cache of prep code results keyed on the length arrays they
+ *  were computed from.
+ */
+#include "prep_code_cache.h"
+
+#include <dmlc/logging.h>
+#include <tvm/runtime/module.h>
+#include <tvm/runtime/registry.h>
+
+#include <algorithm>
+#include <sstream>
+
+namespace tvm {
+namespace runtime {
+
+// 64 bit FNV-1a
+constexpr uint64_t kFNVOffsetBasis = 14695981039346656037ULL;
+constexpr uint64_t kFNVPrime = 1099511628211ULL;
+
+inline uint64_t HashBytes(const void* data, size_t nbytes, uint64_t hash) {
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < nbytes; ++i) {
+    hash ^= bytes[i];
+    hash *= kFNVPrime;
+  }
+  return hash;
+}
+
+PrepCodeCache* PrepCodeCache::Global() {
+  static PrepCodeCache* inst = new PrepCodeCache();
+  return inst;
+}
+
+bool PrepCodeCache::Lookup(TVMArgs args) {
+  CHECK_GE(args.size(), 2);
+  std::string func_name = args[0];
+  int num_aux_buffers = args[1];
+  CHECK_GE(args.size(), 2 + num_aux_buffers);
+
+  std::ostringstream key;
+  key << func_name;
+  std::vector<const void*> buffers;
+  for (int i = 2; i < 2 + num_aux_buffers; ++i) {
+    void* data = args[i];
+    key << ":" << data;
+    buffers.push_back(data);
+  }
+
+  uint64_t hash = kFNVOffsetBasis;
+  for (int i = 2 + num_aux_buffers; i < args.size(); ++i) {
+    if (args.type_codes[i] == kDLInt) {
+      int64_t value = args[i];
+      hash = HashBytes(&value, sizeof(value), hash);
+    } else {
+      CHECK(args.type_codes[i] == kTVMOpaqueHandle || args.type_codes[i] == kTVMNullptr)
+          << "Prep code cache can only be keyed on integers and host buffers";
+      CHECK_LT(i + 1, args.size()) << "Missing size for length buffer";
+      void* data = args[i];
+      int64_t nbytes = args[++i];
+      if (data != nullptr) {
+        hash = HashBytes(data, static_cast<size_t>(nbytes), hash);
+      }
+      hash = HashBytes(&nbytes, sizeof(nbytes), hash);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(key.str());
+  if (it != entries_.end() && it->second.hash == hash) {
+    hits_++;
+    return true;
+  }
+  entries_[key.str()] = Entry{hash, std::move(buffers)};
+  num_entries_ = entries_.size();
+  misses_++;
+  return false;
+}
+
+void PrepCodeCache::Forget(const void* data) {
+  // Called for every freed NDArray, so avoid the lock when no
+  // function uses the cache.
+  if (num_entries_.load(std::memory_order_relaxed) == 0) return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    const auto& buffers = it->second.buffers;
+    if (std::find(buffers.begin(), buffers.end(), data) != buffers.end()) {
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  num_entries_ = entries_.size();
+}
+
+void PrepCodeCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  num_entries_ = 0;
+  hits_ = 0;
+  misses_ = 0;
+}
+
+TVM_REGISTER_GLOBAL(symbol::tvm_prep_code_cache_lookup)
+    .set_body([](TVMArgs args, TVMRetValue* ret) {
+      *ret = static_cast<int>(PrepCodeCache::Global()->Lookup(args));
+    });
+
+TVM_REGISTER_GLOBAL("runtime.PrepCodeCacheClear").set_body_typed([]() {
+  PrepCodeCache::Global()->Clear();
+});
+
+TVM_REGISTER_GLOBAL("runtime.PrepCodeCacheStats").set_body_typed([](bool hits) {
+  PrepCodeCache* cache = PrepCodeCache::Global();
+  return hits ? cache->hits() : cache->misses();
+});
+
+}  // namespace runtime
+}  // namespace tvm
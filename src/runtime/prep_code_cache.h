@@ -0,0 +1,101 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file prep_code_cache.h
+ * \brief Cache of prep code results keyed on the length arrays they
+ *  were computed from.
+ */
+#ifndef TVM_RUNTIME_PREP_CODE_CACHE_H_
+#define TVM_RUNTIME_PREP_CODE_CACHE_H_
+
+#include <tvm/runtime/packed_func.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+/*!
+ * \brief Remembers, for every set of auxiliary buffers a generated
+ *  function has filled in its prep code, a hash of the lengths the
+ *  contents were computed from.
+ *
+ *  The prep code of a function built with the
+ *  "with_cached_prep_code" mode calls into this cache before
+ *  computing the auxiliary arrays. If the same function is called
+ *  again with the same auxiliary buffers and length arrays with
+ *  identical contents, the host computation and the host to device
+ *  copy are skipped and the previously uploaded buffers are reused.
+ */
+class PrepCodeCache {
+ public:
+  /*! \return The global cache. */
+  static PrepCodeCache* Global();
+  /*!
+   * \brief Check whether the auxiliary buffers currently hold prep
+   *  code results for the given lengths, recording the lengths on a
+   *  miss.
+   * \param args The arguments to the cache lookup builtin. See
+   *  symbol::tvm_prep_code_cache_lookup for the calling convention.
+   * \return true if the prep code need not be run.
+   */
+  bool Lookup(TVMArgs args);
+  /*!
+   * \brief Forget the entries of an auxiliary buffer that is being
+   *  freed, so that a buffer later allocated at the same address does
+   *  not hit them.
+   * \param data The data of the buffer.
+   */
+  void Forget(const void* data);
+  /*! \brief Forget all entries. */
+  void Clear();
+  /*! \return The number of lookups that hit. */
+  int64_t hits() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+  }
+  /*! \return The number of lookups that missed. */
+  int64_t misses() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+  }
+
+ private:
+  /*! \brief The lengths an entry was filled for, and its buffers */
+  struct Entry {
+    uint64_t hash;
+    std::vector<const void*> buffers;
+  };
+  mutable std::mutex mutex_;
+  /*! \brief Map from the function name and auxiliary buffer addresses
+   *  to the hash of the lengths last used to fill the buffers */
+  std::unordered_map<std::string, Entry> entries_;
+  /*! \brief The size of entries_, read without the lock when buffers are freed */
+  std::atomic<size_t> num_entries_{0};
+  int64_t hits_{0};
+  int64_t misses_{0};
+};
+
+}  // namespace runtime
+}  // namespace tvm
+#endif  // TVM_RUNTIME_PREP_CODE_CACHE_H_
@@ -0,0 +1,149 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file prep_code_profile.cc
+ * \brief Per function statistics of the time spent in, and data moved
+ *  by, instrumented prep code.
+ */
+#include <dmlc/logging.h>
+#include <dmlc/thread_local.h>
+#include <tvm/runtime/module.h>
+#include <tvm/runtime/registry.h>
+
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+namespace tvm {
+namespace runtime {
+
+/*! \brief Accumulated statistics of the prep code of one function. */
+struct PrepCodeProfileEntry {
+  /*! \brief Number of times the prep code ran */
+  int64_t calls{0};
+  /*! \brief Total host wall time spent in the prep code, in seconds */
+  double seconds{0};
+  /*! \brief Number of auxiliary arrays computed by the prep code */
+  int64_t num_aux_arrays{0};
+  /*! \brief Total bytes copied from the host to the device */
+  int64_t copied_bytes{0};
+};
+
+class PrepCodeProfiler {
+ public:
+  static PrepCodeProfiler* Global() {
+    static PrepCodeProfiler* inst = new PrepCodeProfiler();
+    return inst;
+  }
+
+  void Begin(const std::string& name) { StartTimes()[name] = Clock::now(); }
+
+  void End(const std::string& name, int64_t num_aux_arrays, int64_t copied_bytes) {
+    auto& start_times = StartTimes();
+    auto it = start_times.find(name);
+    CHECK(it != start_times.end()) << "Prep code profile end without begin for " << name;
+    double seconds = std::chrono::duration<double>(Clock::now() - it->second).count();
+    start_times.erase(it);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    PrepCodeProfileEntry& entry = entries_[name];
+    entry.calls++;
+    entry.seconds += seconds;
+    entry.num_aux_arrays = num_aux_arrays;
+    entry.copied_bytes += copied_bytes;
+  }
+
+  /*! \brief The names of all profiled functions, one per line. */
+  std::string Functions() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ostringstream os;
+    for (auto it : entries_) {
+      os << it.first << "\n";
+    }
+    return os.str();
+  }
+
+  PrepCodeProfileEntry Get(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(name);
+    CHECK(it != entries_.end()) << "No prep code profile for " << name;
+    return it->second;
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+  }
+
+ private:
+  using Clock = std::chrono::high_resolution_clock;
+  using StartTimeMap = std::unordered_map<std::string, Clock::time_point>;
+
+  // Start times are per thread so that concurrent calls of the same
+  // function do not interfere.
+  static StartTimeMap& StartTimes() {
+    return *dmlc::ThreadLocalStore<StartTimeMap>::Get();
+  }
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, PrepCodeProfileEntry> entries_;
+};
+
+TVM_REGISTER_GLOBAL(symbol::tvm_prep_code_profile_begin)
+    .set_body([](TVMArgs args, TVMRetValue* ret) {
+      PrepCodeProfiler::Global()->Begin(args[0]);
+      *ret = 0;
+    });
+
+TVM_REGISTER_GLOBAL(symbol::tvm_prep_code_profile_end)
+    .set_body([](TVMArgs args, TVMRetValue* ret) {
+      PrepCodeProfiler::Global()->End(args[0], args[1], args[2]);
+      *ret = 0;
+    });
+
+TVM_REGISTER_GLOBAL("runtime.PrepCodeProfileFunctions").set_body_typed([]() {
+  return PrepCodeProfiler::Global()->Functions();
+});
+
+TVM_REGISTER_GLOBAL("runtime.PrepCodeProfileGet")
+    .set_body_typed([](std::string name, std::string field) {
+      PrepCodeProfileEntry entry = PrepCodeProfiler::Global()->Get(name);
+      if (field == "calls") {
+        return static_cast<double>(entry.calls);
+      } else if (field == "seconds") {
+        return entry.seconds;
+      } else if (field == "num_aux_arrays") {
+        return static_cast<double>(entry.num_aux_arrays);
+      } else if (field == "copied_bytes") {
+        return static_cast<double>(entry.copied_bytes);
+      }
+      LOG(FATAL) << "Unknown prep code profile field " << field;
+      return 0.0;
+    });
+
+TVM_REGISTER_GLOBAL("runtime.PrepCodeProfileClear").set_body_typed([]() {
+  PrepCodeProfiler::Global()->Clear();
+});
+
+}  // namespace runtime
+}  // namespace tvm
@@ -0,0 +1,111 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file prep_code_update.cc
+ * \brief Incremental updates of prep code results when only a few
+ *  lengths change between calls.
+ */
+#include <dmlc/logging.h>
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/registry.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+
+/*!
+ * \brief Patch an A-function (prefix sum) array in place after some of
+ *  the lengths it was computed from change.
+ *
+ *  The array occupies num_rows + 1 int32 elements of aux starting at
+ *  elem_offset, with entry p holding the sum of the first p
+ *  lengths. Entries up to the first changed row r stay valid, so only
+ *  entry r is read, and the entries after it are rebuilt from the new
+ *  lengths on the host and written back. For arrays on a device this
+ *  moves a single scalar to the host instead of the whole suffix.
+ */
+void RaggedPrefixSumPatch(DLTensor* aux, int64_t elem_offset, int64_t num_rows, DLTensor* rows,
+                          DLTensor* lengths) {
+  CHECK(aux->dtype.code == kDLInt && aux->dtype.bits == 32) << "Aux buffers are int32";
+  CHECK(rows->ctx.device_type == kDLCPU && lengths->ctx.device_type == kDLCPU)
+      << "Changed rows and lengths should be on the host";
+  CHECK(rows->dtype.code == kDLInt && rows->dtype.bits == 32);
+  CHECK(lengths->dtype.code == kDLInt && lengths->dtype.bits == 32);
+  CHECK_EQ(rows->ndim, 1);
+  CHECK_EQ(lengths->ndim, 1);
+  CHECK_EQ(lengths->shape[0], num_rows);
+
+  const int32_t* rows_data = reinterpret_cast<const int32_t*>(
+      static_cast<const char*>(rows->data) + rows->byte_offset);
+  const int32_t* lengths_data = reinterpret_cast<const int32_t*>(
+      static_cast<const char*>(lengths->data) + lengths->byte_offset);
+  if (rows->shape[0] == 0) return;
+  int64_t first = num_rows;
+  for (int64_t i = 0; i < rows->shape[0]; ++i) {
+    CHECK(rows_data[i] >= 0 && rows_data[i] < num_rows) << "Row out of range " << rows_data[i];
+    first = std::min<int64_t>(first, rows_data[i]);
+  }
+
+  // Entry first is unchanged, entries in [first + 1, num_rows] are rebuilt
+  size_t count = static_cast<size_t>(num_rows - first);
+  size_t byte_offset = aux->byte_offset + static_cast<size_t>(elem_offset + first) * sizeof(int32_t);
+
+  bool on_host = aux->ctx.device_type == kDLCPU || aux->ctx.device_type == kDLCPUPinned;
+  TVMContext cpu_ctx;
+  cpu_ctx.device_type = kDLCPU;
+  cpu_ctx.device_id = 0;
+  int32_t base;
+  if (on_host) {
+    base = *reinterpret_cast<int32_t*>(static_cast<char*>(aux->data) + byte_offset);
+  } else {
+    DeviceAPI::Get(aux->ctx)->CopyDataFromTo(aux->data, byte_offset, &base, 0, sizeof(int32_t),
+                                             aux->ctx, cpu_ctx, aux->dtype, nullptr);
+  }
+
+  std::vector<int32_t> suffix(count);
+  for (size_t i = 0; i < count; ++i) {
+    base += lengths_data[first + i];
+    suffix[i] = base;
+  }
+
+  if (on_host) {
+    std::copy(suffix.begin(), suffix.end(),
+              reinterpret_cast<int32_t*>(static_cast<char*>(aux->data) + byte_offset) + 1);
+  } else {
+    DeviceAPI::Get(aux->ctx)->CopyDataFromTo(suffix.data(), 0, aux->data,
+                                             byte_offset + sizeof(int32_t),
+                                             count * sizeof(int32_t), cpu_ctx, aux->ctx,
+                                             aux->dtype, nullptr);
+  }
+}
+
+TVM_REGISTER_GLOBAL("runtime.RaggedPrefixSumPatch")
+    .set_body_typed([](NDArray aux, int64_t elem_offset, int64_t num_rows, NDArray rows,
+                       NDArray lengths) {
+      RaggedPrefixSumPatch(const_cast<DLTensor*>(aux.operator->()), elem_offset, num_rows,
+                           const_cast<DLTensor*>(rows.operator->()),
+                           const_cast<DLTensor*>(lengths.operator->()));
+    });
+
+}  // namespace runtime
+}  // namespace tvm
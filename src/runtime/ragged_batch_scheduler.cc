@@ -0,0 +1,257 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file ragged_batch_scheduler.cc
+ * \brief Continuous batching of sequence requests into the ragged
+ *  batches that CORA kernels take.
+ */
+#include <dmlc/logging.h>
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/module.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/registry.h>
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+
+/*!
+ * \brief Forms ragged batches from individual sequence requests and
+ *  runs a step function over them until every sequence is done.
+ *
+ *  A batch has a fixed number of slots, and a sequence keeps its slot
+ *  from the step it is admitted in until the step it is retired in.
+ *  The length of a sequence is its prompt length in its first step,
+ *  and grows by one token in every later step. Free slots have length
+ *  0. As the batch shape never changes, only the rows whose lengths
+ *  changed are reported to the step function, and the prefix sum
+ *  arrays of the prelude that are registered with the scheduler are
+ *  patched in place rather than recomputed.
+ *
+ *  Waiting requests are admitted in arrival order, as long as there is
+ *  a free slot and the sum of the lengths of the batch stays within
+ *  the token budget. Running sequences are never preempted, so the
+ *  batch may grow past the budget as they decode.
+ */
+class RaggedBatchScheduler : public ModuleNode {
+ public:
+  RaggedBatchScheduler(int max_batch_size, int64_t token_budget, PackedFunc step_fn,
+                       TVMContext ctx)
+      : max_batch_size_(max_batch_size),
+        token_budget_(token_budget),
+        step_fn_(step_fn),
+        slots_(max_batch_size),
+        prev_lengths_(max_batch_size, 0) {
+    CHECK_GT(max_batch_size, 0);
+    TVMContext cpu_ctx{kDLCPU, 0};
+    lengths_ = NDArray::Empty({max_batch_size}, DLDataType{kDLInt, 32, 1}, cpu_ctx);
+    std::fill_n(static_cast<int32_t*>(lengths_->data), max_batch_size, 0);
+    if (ctx.device_type != kDLCPU) {
+      device_lengths_ = NDArray::Empty({max_batch_size}, DLDataType{kDLInt, 32, 1}, ctx);
+      device_lengths_.CopyFrom(lengths_);
+    }
+  }
+
+  const char* type_key() const final { return "RaggedBatchScheduler"; }
+
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final;
+
+  /*! \brief Queue a request with prompt_len tokens that generates max_new_tokens. */
+  void AddRequest(int64_t id, int prompt_len, int max_new_tokens) {
+    CHECK_GT(prompt_len, 0) << "Empty prompt for request " << id;
+    CHECK_GT(max_new_tokens, 0) << "Request " << id << " generates no token";
+    waiting_.push_back(Sequence{id, prompt_len, max_new_tokens, 0});
+  }
+
+  /*! \brief Retire a request before its last token, for instance at an end of sequence token. */
+  void Finish(int64_t id) { finished_.insert(id); }
+
+  /*!
+   * \brief Retire the sequences that are done, admit waiting requests
+   *  and run the step function on the batch.
+   * \return The number of sequences in the batch. 0 once all requests
+   *  are done, in which case the step function is not called.
+   */
+  int Step() {
+    int32_t* lengths = static_cast<int32_t*>(lengths_->data);
+    // Retire
+    for (int s = 0; s < max_batch_size_; ++s) {
+      Sequence& seq = slots_[s];
+      if (seq.id < 0) continue;
+      if (seq.generated >= seq.max_new_tokens || finished_.count(seq.id)) {
+        finished_.erase(seq.id);
+        retired_.push_back(seq.id);
+        seq = Sequence();
+      }
+    }
+    // Admit
+    int64_t tokens = 0;
+    for (int s = 0; s < max_batch_size_; ++s) tokens += slots_[s].length();
+    for (int s = 0; s < max_batch_size_ && !waiting_.empty(); ++s) {
+      if (slots_[s].id >= 0) continue;
+      Sequence& next = waiting_.front();
+      if (finished_.count(next.id)) {
+        finished_.erase(next.id);
+        retired_.push_back(next.id);
+        waiting_.pop_front();
+        --s;
+        continue;
+      }
+      // A request larger than the budget is run alone.
+      if (tokens > 0 && tokens + next.length() > token_budget_) break;
+      tokens += next.length();
+      slots_[s] = next;
+      waiting_.pop_front();
+    }
+    // The rows whose lengths changed since the last step
+    std::vector<int32_t> rows, deltas;
+    int num_active = 0;
+    for (int s = 0; s < max_batch_size_; ++s) {
+      lengths[s] = slots_[s].length();
+      if (slots_[s].id >= 0) ++num_active;
+      if (lengths[s] != prev_lengths_[s]) {
+        rows.push_back(s);
+        deltas.push_back(lengths[s] - prev_lengths_[s]);
+        prev_lengths_[s] = lengths[s];
+      }
+    }
+    if (num_active == 0) return 0;
+
+    NDArray rows_arr = ToNDArray(rows), deltas_arr = ToNDArray(deltas);
+    if (!rows.empty()) {
+      if (device_lengths_.defined()) device_lengths_.CopyFrom(lengths_);
+      const PackedFunc* patch = Registry::Get("runtime.RaggedPrefixSumPatch");
+      CHECK(patch != nullptr);
+      for (const auto& it : prefix_sums_) {
+        (*patch)(it.first, it.second, max_batch_size_, rows_arr, lengths_);
+      }
+    }
+    step_fn_(device_lengths_.defined() ? device_lengths_ : lengths_, rows_arr, deltas_arr);
+    for (int s = 0; s < max_batch_size_; ++s) {
+      if (slots_[s].id >= 0) slots_[s].generated++;
+    }
+    return num_active;
+  }
+
+ private:
+  struct Sequence {
+    int64_t id{-1};
+    int prompt_len{0};
+    int max_new_tokens{0};
+    int generated{0};
+    // The length in the next step
+    int length() const { return id < 0 ? 0 : prompt_len + generated; }
+  };
+
+  static NDArray ToNDArray(const std::vector<int32_t>& values) {
+    NDArray ret = NDArray::Empty({static_cast<int64_t>(values.size())},
+                                 DLDataType{kDLInt, 32, 1}, TVMContext{kDLCPU, 0});
+    std::copy(values.begin(), values.end(), static_cast<int32_t*>(ret->data));
+    return ret;
+  }
+
+  NDArray SlotIds() const {
+    NDArray ret = NDArray::Empty({max_batch_size_}, DLDataType{kDLInt, 64, 1},
+                                 TVMContext{kDLCPU, 0});
+    for (int s = 0; s < max_batch_size_; ++s) {
+      static_cast<int64_t*>(ret->data)[s] = slots_[s].id;
+    }
+    return ret;
+  }
+
+  NDArray PopRetired() {
+    NDArray ret = NDArray::Empty({static_cast<int64_t>(retired_.size())},
+                                 DLDataType{kDLInt, 64, 1}, TVMContext{kDLCPU, 0});
+    std::copy(retired_.begin(), retired_.end(), static_cast<int64_t*>(ret->data));
+    retired_.clear();
+    return ret;
+  }
+
+  int max_batch_size_;
+  int64_t token_budget_;
+  PackedFunc step_fn_;
+  std::vector<Sequence> slots_;
+  std::deque<Sequence> waiting_;
+  std::unordered_set<int64_t> finished_;
+  std::vector<int64_t> retired_;
+  std::vector<int32_t> prev_lengths_;
+  NDArray lengths_;
+  NDArray device_lengths_;
+  // The prefix sum arrays over the lengths to patch, with their offsets
+  std::vector<std::pair<NDArray, int64_t>> prefix_sums_;
+};
+
+PackedFunc RaggedBatchScheduler::GetFunction(const std::string& name,
+                                             const ObjectPtr<Object>& sptr_to_self) {
+  if (name == "add_request") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->AddRequest(args[0], args[1], args[2]);
+    });
+  } else if (name == "finish") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->Finish(args[0]);
+    });
+  } else if (name == "step") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      *rv = this->Step();
+    });
+  } else if (name == "register_prefix_sum") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      NDArray aux = args[0];
+      int64_t elem_offset = args[1];
+      this->prefix_sums_.emplace_back(aux, elem_offset);
+    });
+  } else if (name == "get_slot_ids") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      *rv = this->SlotIds();
+    });
+  } else if (name == "pop_retired") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      *rv = this->PopRetired();
+    });
+  } else if (name == "num_waiting") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      *rv = static_cast<int64_t>(this->waiting_.size());
+    });
+  } else {
+    return PackedFunc();
+  }
+}
+
+TVM_REGISTER_GLOBAL("tvm.ragged_batch_scheduler.create")
+    .set_body([](TVMArgs args, TVMRetValue* rv) {
+      CHECK_GE(args.num_args, 3) << "Expect max_batch_size, token_budget and step_fn";
+      TVMContext ctx{kDLCPU, 0};
+      if (args.num_args >= 5) {
+        ctx.device_type = static_cast<DLDeviceType>(args[3].operator int());
+        ctx.device_id = args[4];
+      }
+      *rv = Module(make_object<RaggedBatchScheduler>(args[0], args[1], args[2], ctx));
+    });
+
+}  // namespace runtime
+}  // namespace tvm
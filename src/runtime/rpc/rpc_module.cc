@@ -292,5 +292,14 @@ TVM_REGISTER_GLOBAL("rpc._SessTableIndex")
     *rv = static_cast<RPCModuleNode*>(m.operator->())->sess()->table_index();
   });
 
+TVM_REGISTER_GLOBAL("rpc._SessSetUploadOptions")
+.set_body([](TVMArgs args, TVMRetValue* rv) {
+    Module m = args[0];
+    std::string tkey = m->type_key();
+    CHECK_EQ(tkey, "rpc");
+    static_cast<RPCModuleNode*>(m.operator->())->sess()->SetUploadOptions(
+        args[1], args[2], args[3]);
+  });
+
 }  // namespace runtime
 }  // namespace tvm
@@ -30,6 +30,8 @@
 #include <array>
 #include <string>
 #include <chrono>
+#include <cstring>
+#include <map>
 #include <vector>
 #include <utility>
 #include <cmath>
@@ -70,6 +72,75 @@ struct RPCArgBuffer {
   }
 };
 
+// The flags of a kCopyToRemoteCached upload.
+enum RPCUploadFlag : int {
+  // The content of the array is sent, otherwise the remote has it cached.
+  kUploadPayload = 1,
+  // The content is compressed by CompressZeroRuns.
+  kUploadCompressed = 2,
+  // The remote caches the content.
+  kUploadCache = 4
+};
+
+// The 64 bit FNV-1a hash of data, taken a word at a time.
+uint64_t HashUploadBytes(const char* data, size_t size) {
+  const uint64_t prime = 0x100000001b3ULL;
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, data + i, sizeof(word));
+    hash = (hash ^ word) * prime;
+  }
+  for (; i < size; ++i) {
+    hash = (hash ^ static_cast<uint8_t>(data[i])) * prime;
+  }
+  return hash;
+}
+
+// Run length encode the zero bytes of data: a run of n zeros is written as
+// a zero followed by n - 1 as a base 128 varint, other bytes as themselves.
+// Returns false if the encoding is not smaller than the data.
+bool CompressZeroRuns(const char* data, size_t size, std::string* out) {
+  out->clear();
+  for (size_t i = 0; i < size && out->size() < size;) {
+    if (data[i] != 0) {
+      out->push_back(data[i++]);
+      continue;
+    }
+    size_t begin = i;
+    while (i < size && data[i] == 0) ++i;
+    out->push_back(0);
+    uint64_t n = i - begin - 1;
+    for (; n >= 128; n >>= 7) out->push_back(static_cast<char>((n & 127) | 128));
+    out->push_back(static_cast<char>(n));
+  }
+  return out->size() < size;
+}
+
+// Decode the output of CompressZeroRuns, of nbytes bytes.
+void DecompressZeroRuns(const char* data, size_t size, size_t nbytes, std::string* out) {
+  out->clear();
+  out->reserve(nbytes);
+  for (size_t i = 0; i < size;) {
+    char c = data[i++];
+    if (c != 0) {
+      out->push_back(c);
+      continue;
+    }
+    uint64_t n = 0;
+    for (int shift = 0;; shift += 7) {
+      CHECK_LT(i, size) << "Truncated compressed upload";
+      uint8_t b = static_cast<uint8_t>(data[i++]);
+      n |= static_cast<uint64_t>(b & 127) << shift;
+      if ((b & 128) == 0) break;
+    }
+    CHECK_LE(out->size() + n + 1, nbytes) << "Compressed upload exceeds its size";
+    out->append(n + 1, '\0');
+  }
+  CHECK_EQ(out->size(), nbytes) << "Compressed upload does not match its size";
+}
+
 // Event handler for RPC events.
 class RPCSession::EventHandler : public dmlc::Stream {
  public:
@@ -384,6 +455,10 @@ class RPCSession::EventHandler : public dmlc::Stream {
   std::unique_ptr<RPCDataArrayBuffer> temp_array_;
   // Internal temporal data space.
   std::string temp_data_;
+  // The arrays uploaded to be cached, by content hash and size, and the
+  // order they were cached in.
+  std::map<std::pair<uint64_t, uint64_t>, std::string> ndarray_cache_;
+  std::deque<std::pair<uint64_t, uint64_t>> ndarray_cache_order_;
   // Temp variables for copy request state.
   TVMContext copy_ctx_;
   DLDataType copy_dtype_;
@@ -743,6 +818,61 @@ class RPCSession::EventHandler : public dmlc::Stream {
       this->SwitchToState(kRecvCode);
     }
   }
+  // Handle an upload of kCopyToRemoteCached, whose arguments are the target
+  // handle, offset, context and type hint, the hash and size of the content,
+  // the RPCUploadFlag, the number of cached arrays to evict first, oldest
+  // first, and the content.
+  void HandleCopyToRemoteCached(TVMArgs args, TVMRetValue* rv) {
+    void* to = args[0];
+    uint64_t to_offset = static_cast<uint64_t>(args[1].operator int64_t());
+    TVMContext ctx = args[2];
+    DLDataType dtype = args[3];
+    std::pair<uint64_t, uint64_t> key(static_cast<uint64_t>(args[4].operator int64_t()),
+                                      static_cast<uint64_t>(args[5].operator int64_t()));
+    int flags = args[6];
+    int64_t evictions = args[7];
+    for (int64_t i = 0; i < evictions; ++i) {
+      CHECK(!ndarray_cache_order_.empty()) << "Eviction of an array that is not cached";
+      ndarray_cache_.erase(ndarray_cache_order_.front());
+      ndarray_cache_order_.pop_front();
+    }
+
+    const std::string* content;
+    if ((flags & kUploadPayload) != 0) {
+      const TVMByteArray* payload = args[8].ptr<TVMByteArray>();
+      if ((flags & kUploadCompressed) != 0) {
+        DecompressZeroRuns(payload->data, payload->size, key.second, &temp_data_);
+      } else {
+        CHECK_EQ(payload->size, key.second);
+        temp_data_.assign(payload->data, payload->size);
+      }
+      if (!DMLC_IO_NO_ENDIAN_SWAP) {
+        size_t elem_bytes = (dtype.bits * dtype.lanes + 7) / 8;
+        dmlc::ByteSwap(dmlc::BeginPtr(temp_data_), elem_bytes, key.second / elem_bytes);
+      }
+      content = &temp_data_;
+      if ((flags & kUploadCache) != 0) {
+        std::string& entry = ndarray_cache_[key];
+        entry.swap(temp_data_);
+        ndarray_cache_order_.push_back(key);
+        content = &entry;
+      }
+    } else {
+      auto it = ndarray_cache_.find(key);
+      CHECK(it != ndarray_cache_.end()) << "Upload of an array that is not cached";
+      content = &it->second;
+    }
+
+    if (ctx.device_type == kDLCPU) {
+      std::memcpy(static_cast<char*>(to) + to_offset, content->data(), content->size());
+    } else {
+      TVMContext cpu_ctx;
+      cpu_ctx.device_type = kDLCPU;
+      cpu_ctx.device_id = 0;
+      DeviceAPI::Get(ctx)->CopyDataFromTo(
+          content->data(), 0, to, to_offset, content->size(), cpu_ctx, ctx, dtype, nullptr);
+    }
+  }
   // Handle for packed call.
   void HandlePackedCall();
 
@@ -982,6 +1112,7 @@ void RPCSession::CallFunc(void* h,
                           FUnwrapRemoteObject funwrap,
                           const PackedFunc* fwrap) {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
+  DrainPendingReturns();
 
   RPCCode code = RPCCode::kCallFunc;
   handler_->Write(code);
@@ -1001,20 +1132,116 @@ void RPCSession::CopyToRemote(void* from,
                               TVMContext ctx_to,
                               DLDataType type_hint) {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
-  ctx_to = handler_->StripSessMask(ctx_to);
-  RPCCode code = RPCCode::kCopyToRemote;
+  const char* data = reinterpret_cast<char*>(from) + from_offset;
+  if (cache_bytes_ == 0 && !compress_) {
+    ctx_to = handler_->StripSessMask(ctx_to);
+    RPCCode code = RPCCode::kCopyToRemote;
+    handler_->Write(code);
+    uint64_t handle = reinterpret_cast<uint64_t>(to);
+    handler_->Write(handle);
+    uint64_t offset = static_cast<uint64_t>(to_offset);
+    handler_->Write(offset);
+    uint64_t size = static_cast<uint64_t>(data_size);
+    handler_->Write(size);
+    handler_->Write(ctx_to);
+    handler_->Write(type_hint);
+    handler_->WriteArray(data, data_size);
+    FinishUpload();
+    return;
+  }
+
+  int flags = kUploadPayload;
+  std::pair<uint64_t, uint64_t> key(0, data_size);
+  if (cache_bytes_ != 0) {
+    key.first = HashUploadBytes(data, data_size);
+    if (cached_arrays_.count(key)) {
+      flags = 0;
+    } else if (data_size <= cache_bytes_) {
+      while (cached_bytes_ + data_size > cache_bytes_) {
+        cached_bytes_ -= cached_order_.front().second;
+        cached_arrays_.erase(cached_order_.front());
+        cached_order_.pop_front();
+        ++pending_evictions_;
+      }
+      cached_arrays_.insert(key);
+      cached_order_.push_back(key);
+      cached_bytes_ += data_size;
+      flags |= kUploadCache;
+    }
+  }
+  std::string compressed;
+  TVMByteArray payload{data, 0};
+  if ((flags & kUploadPayload) != 0) {
+    payload.size = data_size;
+    if (compress_ && CompressZeroRuns(data, data_size, &compressed)) {
+      payload.data = compressed.data();
+      payload.size = compressed.size();
+      flags |= kUploadCompressed;
+    }
+  }
+  TVMValue values[9];
+  int type_codes[9];
+  TVMArgsSetter setter(values, type_codes);
+  setter(0, to);
+  setter(1, static_cast<int64_t>(to_offset));
+  setter(2, ctx_to);
+  setter(3, type_hint);
+  setter(4, static_cast<int64_t>(key.first));
+  setter(5, static_cast<int64_t>(key.second));
+  setter(6, flags);
+  setter(7, pending_evictions_);
+  setter(8, payload);
+  pending_evictions_ = 0;
+  RPCCode code = RPCCode::kCopyToRemoteCached;
   handler_->Write(code);
-  uint64_t handle = reinterpret_cast<uint64_t>(to);
-  handler_->Write(handle);
-  uint64_t offset = static_cast<uint64_t>(to_offset);
-  handler_->Write(offset);
-  uint64_t size = static_cast<uint64_t>(data_size);
-  handler_->Write(size);
-  handler_->Write(ctx_to);
-  handler_->Write(type_hint);
-  handler_->WriteArray(reinterpret_cast<char*>(from) + from_offset, data_size);
-  TVMRetValue rv;
-  CHECK(HandleUntilReturnEvent(&rv, true, nullptr) == RPCCode::kReturn);
+  handler_->SendPackedSeq(values, type_codes, 9, true);
+  FinishUpload();
+}
+
+void RPCSession::FinishUpload() {
+  if (pipeline_depth_ == 0) {
+    TVMRetValue rv;
+    CHECK(HandleUntilReturnEvent(&rv, true, nullptr) == RPCCode::kReturn);
+    return;
+  }
+  while (writer_.bytes_available() != 0) {
+    writer_.ReadWithCallback([this](const void *data, size_t size) {
+        return channel_->Send(data, size);
+      }, writer_.bytes_available());
+  }
+  if (++num_pending_returns_ >= pipeline_depth_) DrainPendingReturns();
+}
+
+void RPCSession::DrainPendingReturns() {
+  // Handle all the returns even if some fail, to keep the session in sync.
+  std::string error;
+  for (; num_pending_returns_ != 0; --num_pending_returns_) {
+    TVMRetValue rv;
+    try {
+      CHECK(HandleUntilReturnEvent(&rv, true, nullptr) == RPCCode::kReturn);
+    } catch (const dmlc::Error& e) {
+      if (error.empty()) error = e.what();
+    }
+  }
+  CHECK(error.empty()) << "A pipelined upload to the remote failed: " << error;
+}
+
+void RPCSession::SetUploadOptions(int pipeline_depth, int64_t cache_bytes, bool compress) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  CHECK_GE(pipeline_depth, 0);
+  CHECK_GE(cache_bytes, 0);
+  DrainPendingReturns();
+  pipeline_depth_ = pipeline_depth;
+  compress_ = compress;
+  cache_bytes_ = static_cast<uint64_t>(cache_bytes);
+  // The remote evicts the arrays beyond the new size along with the next
+  // cached upload.
+  while (cached_bytes_ > cache_bytes_) {
+    cached_bytes_ -= cached_order_.front().second;
+    cached_arrays_.erase(cached_order_.front());
+    cached_order_.pop_front();
+    ++pending_evictions_;
+  }
 }
 
 void RPCSession::CopyFromRemote(void* from,
@@ -1025,6 +1252,7 @@ void RPCSession::CopyFromRemote(void* from,
                                 TVMContext ctx_from,
                                 DLDataType type_hint) {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
+  DrainPendingReturns();
   ctx_from = handler_->StripSessMask(ctx_from);
   RPCCode code = RPCCode::kCopyFromRemote;
   handler_->Write(code);
@@ -1241,6 +1469,12 @@ void RPCSession::EventHandler::HandlePackedCall() {
     case RPCCode::kModuleGetFunc: CallHandler(RPCModuleGetFunc); break;
     case RPCCode::kModuleGetSource: CallHandler(RPCModuleGetSource); break;
     case RPCCode::kNDArrayFree: CallHandler(RPCNDArrayFree); break;
+    case RPCCode::kCopyToRemoteCached: {
+      CallHandler([this](TVMArgs args, TVMRetValue* rv) {
+          this->HandleCopyToRemoteCached(args, rv);
+        });
+      break;
+    }
     default: LOG(FATAL) << "Unknown event " << static_cast<int>(code_);
   }
   CHECK_EQ(state_, kRecvCode);
@@ -26,7 +26,9 @@
 
 #include <tvm/runtime/packed_func.h>
 #include <tvm/runtime/device_api.h>
+#include <deque>
 #include <mutex>
+#include <set>
 #include <string>
 #include <memory>
 #include <utility>
@@ -87,7 +89,8 @@ enum class RPCCode : int {
   kModuleFree,
   kModuleGetFunc,
   kModuleGetSource,
-  kNDArrayFree
+  kNDArrayFree,
+  kCopyToRemoteCached
 };
 
 /*!
@@ -230,6 +233,20 @@ class RPCSession {
    */
   template<typename... Args>
   inline TVMRetValue CallRemote(RPCCode fcode, Args&& ...args);
+  /*!
+   * \brief Set how CopyToRemote uploads arrays.
+   * \param pipeline_depth The number of uploads sent without waiting for
+   *  their acknowledgements, which are collected before the next call that
+   *  waits for the remote. Errors of such uploads are raised there. 0 waits
+   *  for each upload.
+   * \param cache_bytes The bytes of uploaded arrays the remote keeps, keyed
+   *  by the hash of their content, so that arrays uploaded again, such as
+   *  the inputs and row lengths of every trial of a benchmark, are not sent
+   *  again. 0 disables the cache.
+   * \param compress Whether to run length encode the zero bytes of uploads,
+   *  which shrinks the padding of ragged data and arrays of small integers.
+   */
+  void SetUploadOptions(int pipeline_depth, int64_t cache_bytes, bool compress);
   /*!
    * \return The session table index of the session.
    */
@@ -261,6 +278,10 @@ class RPCSession {
   // Also flushes channels so that the function advances.
   RPCCode HandleUntilReturnEvent(
       TVMRetValue* rv, bool client_mode, const PackedFunc* fwrap);
+  // Handle the returns of the uploads sent without waiting.
+  void DrainPendingReturns();
+  // Send the upload written to the writer, waiting for its return unless pipelined.
+  void FinishUpload();
   // Initalization
   void Init();
   // Shutdown
@@ -281,6 +302,19 @@ class RPCSession {
   std::string name_;
   // The remote key
   std::string remote_key_;
+  // The options of uploads, see SetUploadOptions.
+  int pipeline_depth_{0};
+  uint64_t cache_bytes_{0};
+  bool compress_{false};
+  // The number of uploads whose returns are not yet handled.
+  int num_pending_returns_{0};
+  // The arrays kept by the remote, by content hash and size, and the order
+  // they were kept in, which the remote evicts them in.
+  std::set<std::pair<uint64_t, uint64_t>> cached_arrays_;
+  std::deque<std::pair<uint64_t, uint64_t>> cached_order_;
+  uint64_t cached_bytes_{0};
+  // The number of evictions not yet sent to the remote.
+  int64_t pending_evictions_{0};
 };
 
 /*!
@@ -356,6 +390,7 @@ struct RemoteSpace {
 template<typename... Args>
 inline TVMRetValue RPCSession::CallRemote(RPCCode code, Args&& ...args) {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
+  DrainPendingReturns();
   writer_.Write(&code, sizeof(code));
   return call_remote_(std::forward<Args>(args)...);
 }
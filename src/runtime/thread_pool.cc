@@ -78,6 +78,8 @@ class ParallelLauncher {
     this->flambda = flambda;
     this->env.num_task = num_task;
     has_error_.store(false);
+    next_chunk_.store(0, std::memory_order_relaxed);
+    this->env.chunk_handle = &next_chunk_;
     // reshape
     if (static_cast<size_t>(num_task) > par_errors_.size()) {
       par_errors_.resize(num_task + 1);
@@ -140,6 +142,8 @@ class ParallelLauncher {
   // Whether this thread is worker of the pool.
   // used to prevent recursive launch.
   bool is_worker{false};
+  // Whether this thread is running a launch, whose task 0 it runs.
+  bool in_launch{false};
 
  private:
   // The pending jobs.
@@ -148,6 +152,8 @@ class ParallelLauncher {
   std::atomic<bool> has_error_;
   // The counter page.
   std::atomic<int32_t>* sync_counter_{nullptr};
+  // The first unclaimed iteration of the dynamically scheduled loop.
+  std::atomic<int64_t> next_chunk_{0};
   // The error message
   std::vector<std::string> par_errors_;
 };
@@ -277,19 +283,24 @@ class SpscTaskQueue {
 // The thread pool
 class ThreadPool {
  public:
-  ThreadPool(): num_workers_(tvm::runtime::threading::MaxConcurrency()) {
+  ThreadPool(): ThreadPool(tvm::runtime::threading::MaxConcurrency(), {}) {}
+  // A pool of num_workers workers bound to cpus, or to the cores of the
+  // system if cpus is empty. The threads launching on a pool bound to
+  // cpus do not run task 0 themselves, so that the pool never runs on
+  // other cores.
+  ThreadPool(int num_workers, std::vector<unsigned int> cpus): num_workers_(num_workers) {
     for (int i = 0; i < num_workers_; ++i) {
       // The SpscTaskQueue only hosts ONE item at a time
       queues_.emplace_back(std::unique_ptr<SpscTaskQueue>(new SpscTaskQueue()));
     }
     const char* exclude_worker0 = getenv("TVM_EXCLUDE_WORKER0");
-    if (exclude_worker0 && atoi(exclude_worker0) == 0) {
+    if ((exclude_worker0 && atoi(exclude_worker0) == 0) || !cpus.empty()) {
       exclude_worker0_ = false;
     }
     threads_ = std::unique_ptr<tvm::runtime::threading::ThreadGroup>(
         new tvm::runtime::threading::ThreadGroup(
           num_workers_, [this](int worker_id) { this->RunWorker(worker_id); },
-          exclude_worker0_ /* include_main_thread */));
+          exclude_worker0_ /* include_main_thread */, cpus));
     num_workers_used_ = threads_->Configure(threading::ThreadGroup::kBig, 0, exclude_worker0_);
   }
   ~ThreadPool() {
@@ -314,6 +325,7 @@ class ThreadPool {
           << " workers=" << num_workers_used_ << " request=" << num_task;
     }
     launcher->Init(flambda, cdata, num_task, need_sync != 0);
+    launcher->in_launch = true;
     SpscTaskQueue::Task tsk;
     tsk.launcher = launcher;
     // if worker0 is taken by the master, queues_[0] is abandoned
@@ -331,6 +343,7 @@ class ThreadPool {
       }
     }
     int res = launcher->WaitForJobs();
+    launcher->in_launch = false;
     return res;
   }
 
@@ -382,6 +395,80 @@ class ThreadPool {
   std::unique_ptr<tvm::runtime::threading::ThreadGroup> threads_;
 };
 
+// A named thread pool. The threads bound to it launch on it one at a
+// time, as the queues of a pool have a single producer.
+struct NamedThreadPool {
+  NamedThreadPool(int num_workers, std::vector<unsigned int> cpus) : pool(num_workers, cpus) {}
+  std::mutex mutex;
+  ThreadPool pool;
+};
+
+class NamedThreadPools {
+ public:
+  static NamedThreadPools* Global() {
+    static NamedThreadPools* inst = new NamedThreadPools();
+    return inst;
+  }
+
+  void Create(const std::string& name, int num_workers, const std::vector<unsigned int>& cpus) {
+    CHECK(!name.empty()) << "Thread pools need a name";
+    CHECK(!cpus.empty()) << "Thread pool " << name << " needs the CPUs it runs on";
+    if (num_workers == 0) num_workers = static_cast<int>(cpus.size());
+    CHECK_LE(num_workers, static_cast<int>(cpus.size()))
+        << "Thread pool " << name << " has more workers than CPUs";
+    std::lock_guard<std::mutex> lock(mutex_);
+    CHECK(!pools_.count(name)) << "Thread pool " << name << " already exists";
+    pools_[name].reset(new NamedThreadPool(num_workers, cpus));
+  }
+
+  NamedThreadPool* Get(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = pools_.find(name);
+    CHECK(it != pools_.end()) << "Cannot find thread pool " << name;
+    return it->second.get();
+  }
+
+  // The pool the calling thread is bound to, nullptr for its own.
+  static NamedThreadPool*& Bound() {
+    static thread_local NamedThreadPool* bound = nullptr;
+    return bound;
+  }
+  static std::string& BoundName() {
+    static thread_local std::string name;
+    return name;
+  }
+
+ private:
+  std::mutex mutex_;
+  // Pools live as long as the process, as threads may be bound to them.
+  std::unordered_map<std::string, std::unique_ptr<NamedThreadPool>> pools_;
+};
+
+void threading::CreateThreadPool(const std::string& name, int num_workers,
+                                 const std::vector<unsigned int>& cpus) {
+  NamedThreadPools::Global()->Create(name, num_workers, cpus);
+}
+
+std::string threading::BindThreadPool(const std::string& name) {
+  std::string prev = NamedThreadPools::BoundName();
+  NamedThreadPools::Bound() = name.empty() ? nullptr : NamedThreadPools::Global()->Get(name);
+  NamedThreadPools::BoundName() = name;
+  return prev;
+}
+
+TVM_REGISTER_GLOBAL("runtime.CreateThreadPool")
+.set_body_typed([](std::string name, int num_workers, std::string cpus) {
+  std::vector<unsigned int> cpu_ids;
+  std::istringstream is(cpus);
+  std::string cpu;
+  while (std::getline(is, cpu, ',')) {
+    if (!cpu.empty()) cpu_ids.push_back(static_cast<unsigned int>(std::stoul(cpu)));
+  }
+  threading::CreateThreadPool(name, num_workers, cpu_ids);
+});
+
+TVM_REGISTER_GLOBAL("runtime.BindThreadPool").set_body_typed(threading::BindThreadPool);
+
 TVM_REGISTER_GLOBAL("runtime.config_threadpool")
 .set_body([](TVMArgs args, TVMRetValue* rv) {
     threading::ThreadGroup::AffinityMode mode =\
@@ -391,6 +478,14 @@ TVM_REGISTER_GLOBAL("runtime.config_threadpool")
     ThreadPool::ThreadLocal()->UpdateWorkerConfiguration(mode, nthreads);
 });
 
+bool threading::InParallelLaunch() {
+#if TVM_THREADPOOL_USE_OPENMP
+  return omp_in_parallel();
+#else
+  ParallelLauncher* launcher = ParallelLauncher::ThreadLocal();
+  return launcher->is_worker || launcher->in_launch;
+#endif
+}
 
 }  // namespace runtime
 }  // namespace tvm
@@ -404,6 +499,11 @@ int TVMBackendParallelLaunch(
     void* cdata,
     int num_task) {
 #if !TVM_THREADPOOL_USE_OPENMP
+  tvm::runtime::NamedThreadPool* bound = tvm::runtime::NamedThreadPools::Bound();
+  if (bound != nullptr) {
+    std::lock_guard<std::mutex> lock(bound->mutex);
+    return bound->pool.Launch(flambda, cdata, num_task, 1);
+  }
   int res = tvm::runtime::ThreadPool::ThreadLocal()->Launch(
       flambda, cdata, num_task, 1);
   return res;
@@ -417,12 +517,14 @@ int TVMBackendParallelLaunch(
   int num_workers = tvm::runtime::threading::MaxConcurrency();
   if (num_task == 0) num_task = num_workers;
   omp_set_num_threads(num_workers);
+  std::atomic<int64_t> next_chunk(0);
   #pragma omp parallel num_threads(num_workers)
   {
     int tid = omp_get_thread_num();
     // start_time[tid] = omp_get_wtime();
     TVMParallelGroupEnv env;
     env.num_task = num_task;
+    env.chunk_handle = &next_chunk;
     (*flambda)(tid, &env, cdata);
     // work_time[tid] += omp_get_wtime() - start_time[tid];
   }
@@ -464,3 +566,30 @@ int TVMBackendParallelBarrier(int task_id, TVMParallelGroupEnv* penv) {
 #endif
   return 0;
 }
+
+int TVMBackendParallelNextChunk(TVMParallelGroupEnv* penv, int64_t extent, int64_t min_chunk,
+                                int guided, int64_t* begin, int64_t* end) {
+  // The claimed chunks only partition the iterations, the launch
+  // itself orders the accesses they make.
+  std::atomic<int64_t>* next_chunk = reinterpret_cast<std::atomic<int64_t>*>(penv->chunk_handle);
+  int64_t chunk = std::max<int64_t>(min_chunk, 1);
+  int64_t start;
+  if (guided) {
+    // Like the guided schedule of OpenMP, claim half of the fair share
+    // of the remaining iterations, so that the last chunks are small
+    // enough to even out the imbalance of the earlier ones.
+    int64_t num_task = std::max<int64_t>(penv->num_task, 1);
+    start = next_chunk->load(std::memory_order_relaxed);
+    do {
+      if (start >= extent) return 0;
+      chunk = std::max(chunk, (extent - start) / (2 * num_task));
+    } while (!next_chunk->compare_exchange_weak(start, start + chunk,
+                                                std::memory_order_relaxed));
+  } else {
+    start = next_chunk->fetch_add(chunk, std::memory_order_relaxed);
+    if (start >= extent) return 0;
+  }
+  *begin = start;
+  *end = std::min(start + chunk, extent);
+  return 1;
+}
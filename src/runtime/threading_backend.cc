@@ -25,6 +25,7 @@
 #include <dmlc/logging.h>
 #include <thread>
 #include <algorithm>
+#include <string>
 #if defined(__linux__) || defined(__ANDROID__)
 #include <fstream>
 #include <sstream>
@@ -42,14 +43,20 @@ class ThreadGroup::Impl {
  public:
   Impl(int num_workers,
        std::function<void(int)> worker_callback,
-       bool exclude_worker0)
+       bool exclude_worker0,
+       std::vector<unsigned int> cpus)
       : num_workers_(num_workers) {
     CHECK_GE(num_workers, 1)
       << "Requested a non-positive number of worker threads.";
     for (int i = exclude_worker0; i < num_workers_; ++i) {
       threads_.emplace_back([worker_callback, i] { worker_callback(i); });
     }
-    InitSortedOrder();
+    if (cpus.empty()) {
+      InitSortedOrder();
+    } else {
+      sorted_order_ = cpus;
+      big_count_ = static_cast<int>(cpus.size());
+    }
   }
   ~Impl() { Join(); }
 
@@ -181,10 +188,18 @@ class ThreadGroup::Impl {
   }
 
   void InitSortedOrder() {
-    unsigned int threads = std::thread::hardware_concurrency();
+    // A thread pool bound to a NUMA node only uses the cores of the node.
+    std::vector<unsigned int> cpus;
+    if (BoundNumaNode() >= 0) {
+      cpus = NumaNodeCpus(BoundNumaNode());
+    } else {
+      for (unsigned int i = 0; i < std::thread::hardware_concurrency(); ++i) {
+        cpus.push_back(i);
+      }
+    }
     std::vector<std::pair <unsigned int, int64_t> > max_freqs;
 
-    for (unsigned int i = 0; i < threads; ++i) {
+    for (unsigned int i : cpus) {
       int64_t cur_freq = 0;
       #if defined(__linux__) || defined(__ANDROID__)
         std::ostringstream filepath;
@@ -230,8 +245,9 @@ class ThreadGroup::Impl {
 
 ThreadGroup::ThreadGroup(int num_workers,
                          std::function<void(int)> worker_callback,
-                         bool exclude_worker0)
-  : impl_(new ThreadGroup::Impl(num_workers, worker_callback, exclude_worker0)) {}
+                         bool exclude_worker0,
+                         std::vector<unsigned int> cpus)
+  : impl_(new ThreadGroup::Impl(num_workers, worker_callback, exclude_worker0, cpus)) {}
 ThreadGroup::~ThreadGroup() { delete impl_; }
 void ThreadGroup::Join() { impl_->Join(); }
 
@@ -253,6 +269,9 @@ int MaxConcurrency() {
     max_concurrency = atoi(val);
   } else {
     max_concurrency = std::thread::hardware_concurrency();
+    if (BoundNumaNode() >= 0) {
+      max_concurrency = static_cast<int>(NumaNodeCpus(BoundNumaNode()).size());
+    }
 #if defined(_M_X64) || defined(__x86_64__)
     max_concurrency /= 2;  // ignore hyper-threading
 #endif
@@ -260,6 +279,61 @@ int MaxConcurrency() {
   return std::max(max_concurrency, 1);
 }
 
+#if defined(__linux__) || defined(__ANDROID__)
+// Parse a sysfs list of ids, such as "0-15,32-47".
+static std::vector<unsigned int> ReadIdList(const std::string& path) {
+  std::vector<unsigned int> ids;
+  std::ifstream ifs(path);
+  std::string range;
+  while (std::getline(ifs, range, ',')) {
+    std::istringstream is(range);
+    unsigned int first, last;
+    char dash;
+    if (!(is >> first)) continue;
+    if (!(is >> dash >> last)) last = first;
+    for (unsigned int id = first; id <= last; ++id) ids.push_back(id);
+  }
+  return ids;
+}
+#endif
+
+std::vector<unsigned int> NumaNodeCpus(int node) {
+#if defined(__linux__) || defined(__ANDROID__)
+  std::ostringstream path;
+  path << "/sys/devices/system/node/node" << node << "/cpulist";
+  return ReadIdList(path.str());
+#else
+  return {};
+#endif
+}
+
+int NumNumaNodes() {
+#if defined(__linux__) || defined(__ANDROID__)
+  static int num_nodes = [] {
+    std::vector<unsigned int> nodes = ReadIdList("/sys/devices/system/node/online");
+    return nodes.empty() ? 1 : static_cast<int>(nodes.back()) + 1;
+  }();
+  return num_nodes;
+#else
+  return 1;
+#endif
+}
+
+int BoundNumaNode() {
+  static int node = [] {
+    const char* val = getenv("TVM_NUMA_NODE");
+    if (val == nullptr) return -1;
+    int node = atoi(val);
+    if (NumaNodeCpus(node).empty()) {
+      LOG(WARNING) << "Cannot find the CPUs of NUMA node " << node
+                   << ", the thread pool is not bound to it.";
+      return -1;
+    }
+    return node;
+  }();
+  return node;
+}
+
 
 }  // namespace threading
 }  // namespace runtime
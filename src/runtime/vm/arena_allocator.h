@@ -0,0 +1,214 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file runtime/arena_allocator.h
+ */
+#ifndef TVM_RUNTIME_VM_ARENA_ALLOCATOR_H_
+#define TVM_RUNTIME_VM_ARENA_ALLOCATOR_H_
+
+#include <tvm/runtime/device_api.h>
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+#include "memory_manager.h"
+
+namespace tvm {
+namespace runtime {
+namespace vm {
+
+/*!
+ * \brief A bump pointer allocator, reset at the start of every VM
+ *  invocation.
+ *
+ *  Buffers are carved out of a single device allocation, the arena.
+ *  Those that do not fit are allocated separately, and the arena is
+ *  grown on the next reset to what the invocation needed in total, so
+ *  that from then on an invocation makes a single device allocation
+ *  however its data dependent ragged sizes vary. A reset that finds
+ *  buffers of the arena still live, such as the outputs the caller
+ *  holds on to, retires the arena instead of rewinding it and starts
+ *  a fresh one. Retired arenas are freed as their last buffer is, but
+ *  the largest idle one is kept for the next reset to reuse, so the
+ *  usual loop of invocations alternates between two arenas.
+ */
+class ArenaAllocator final : public Allocator {
+ public:
+  static constexpr size_t kDefaultPageSize = 4096;
+
+  explicit ArenaAllocator(TVMContext ctx) : Allocator(kArena), ctx_(ctx) {}
+
+  ~ArenaAllocator() {
+    for (auto const& buf : overflow_) {
+      DeviceAPI::Get(ctx_)->FreeDataSpace(ctx_, buf.data);
+    }
+    FreeArena(&arena_);
+    FreeArena(&spare_);
+    for (auto& arena : retired_) FreeArena(&arena);
+  }
+
+  Buffer Alloc(size_t nbytes, size_t alignment, DLDataType type_hint) override {
+    std::lock_guard<std::mutex> lock(mu_);
+    alignment = std::max<size_t>(alignment, 1);
+    max_alignment_ = std::max(max_alignment_, alignment);
+    demand_ = RoundUp(demand_, alignment) + nbytes;
+    Buffer buf;
+    buf.ctx = ctx_;
+    buf.size = nbytes;
+    size_t offset = RoundUp(offset_, alignment);
+    if (arena_.buf.data != nullptr && alignment <= arena_.alignment &&
+        offset + nbytes <= arena_.buf.size) {
+      buf.data = static_cast<char*>(arena_.buf.data) + offset;
+      offset_ = offset + nbytes;
+      ++arena_.num_live;
+    } else {
+      buf.data = DeviceAPI::Get(ctx_)->AllocDataSpace(ctx_, nbytes, alignment, type_hint);
+      overflow_.push_back(buf);
+      DLOG(INFO) << "arena overflow, allocate " << nbytes << " B";
+    }
+    used_memory_ += nbytes;
+    return buf;
+  }
+
+  void Free(const Buffer& buffer) override {
+    std::lock_guard<std::mutex> lock(mu_);
+    used_memory_ -= buffer.size;
+    if (arena_.Contains(buffer.data)) {
+      --arena_.num_live;
+      return;
+    }
+    for (auto it = retired_.begin(); it != retired_.end(); ++it) {
+      if (it->Contains(buffer.data)) {
+        if (--it->num_live == 0) {
+          Arena idle = *it;
+          retired_.erase(it);
+          KeepSpare(idle);
+        }
+        return;
+      }
+    }
+    for (auto it = overflow_.begin(); it != overflow_.end(); ++it) {
+      if (it->data == buffer.data) {
+        DeviceAPI::Get(ctx_)->FreeDataSpace(ctx_, buffer.data);
+        overflow_.erase(it);
+        break;
+      }
+    }
+  }
+
+  size_t UsedMemory() const override {
+    std::lock_guard<std::mutex> lock(mu_);
+    return used_memory_;
+  }
+
+  void Reset() override {
+    std::lock_guard<std::mutex> lock(mu_);
+    size_t needed = std::max(demand_, arena_.buf.size);
+    if (arena_.num_live != 0) {
+      retired_.push_back(arena_);
+      arena_ = Arena();
+      if (spare_.buf.size >= needed && spare_.alignment >= max_alignment_) {
+        std::swap(arena_, spare_);
+      } else {
+        AllocArena(&arena_, needed);
+      }
+    } else if (demand_ > arena_.buf.size || max_alignment_ > arena_.alignment) {
+      AllocArena(&arena_, needed);
+    }
+    offset_ = 0;
+    demand_ = 0;
+  }
+
+  void Reserve(size_t nbytes) override {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (arena_.num_live == 0 && nbytes > arena_.buf.size) {
+      AllocArena(&arena_, nbytes);
+      offset_ = 0;
+    }
+  }
+
+ private:
+  /*! \brief An arena, with the alignment it was allocated with and the
+   *  number of its buffers that are live. */
+  struct Arena {
+    Buffer buf;
+    size_t alignment{0};
+    size_t num_live{0};
+
+    bool Contains(void* data) const {
+      char* begin = static_cast<char*>(buf.data);
+      char* ptr = static_cast<char*>(data);
+      return begin != nullptr && ptr >= begin && ptr < begin + buf.size;
+    }
+  };
+
+  static size_t RoundUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+  }
+
+  void FreeArena(Arena* arena) {
+    if (arena->buf.data != nullptr) {
+      DeviceAPI::Get(ctx_)->FreeDataSpace(ctx_, arena->buf.data);
+    }
+    *arena = Arena();
+  }
+
+  void AllocArena(Arena* arena, size_t nbytes) {
+    FreeArena(arena);
+    arena->buf.ctx = ctx_;
+    arena->buf.size = RoundUp(std::max<size_t>(nbytes, 1), kDefaultPageSize);
+    arena->alignment = std::max(max_alignment_, static_cast<size_t>(kAllocAlignment));
+    DLDataType type_hint{kDLUInt, 8, 1};
+    arena->buf.data =
+        DeviceAPI::Get(ctx_)->AllocDataSpace(ctx_, arena->buf.size, arena->alignment, type_hint);
+    DLOG(INFO) << "allocate arena of " << arena->buf.size << " B";
+  }
+
+  /*! \brief Keep an arena whose buffers are all freed for reuse, if it
+   *  is larger than the one kept so far. */
+  void KeepSpare(Arena idle) {
+    if (idle.buf.size > spare_.buf.size) std::swap(idle, spare_);
+    FreeArena(&idle);
+  }
+
+  TVMContext ctx_;
+  /*! \brief The arena buffers are carved out of. */
+  Arena arena_;
+  /*! \brief Arenas with buffers live since a reset. */
+  std::vector<Arena> retired_;
+  /*! \brief An idle arena for the next reset to reuse. */
+  Arena spare_;
+  /*! \brief The first free byte of the arena. */
+  size_t offset_{0};
+  /*! \brief The bytes the allocations since the last reset need in one arena. */
+  size_t demand_{0};
+  size_t max_alignment_{1};
+  /*! \brief The live buffers that did not fit in the arena. */
+  std::vector<Buffer> overflow_;
+  size_t used_memory_{0};
+  mutable std::mutex mu_;
+};
+
+}  // namespace vm
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_VM_ARENA_ALLOCATOR_H_
@@ -24,6 +24,7 @@
 
 #include <dmlc/memory_io.h>
 #include <tvm/runtime/c_runtime_api.h>
+#include <tvm/runtime/device_api.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/runtime/vm.h>
 
@@ -35,6 +36,7 @@
 #include <utility>
 #include <vector>
 
+#include "../mapped_file.h"
 #include "serialize_util.h"
 
 namespace tvm {
@@ -245,7 +247,7 @@ void Executable::SaveGlobalSection(dmlc::Stream* strm) {
   strm->Write(glbs);
 }
 
-void Executable::SaveConstantSection(dmlc::Stream* strm) {
+void Executable::SaveConstantSection(dmlc::SeekStream* strm) {
   std::vector<DLTensor*> arrays;
   for (const auto& obj : this->constants) {
     const auto cell = Downcast<runtime::NDArray>(obj);
@@ -253,7 +255,7 @@ void Executable::SaveConstantSection(dmlc::Stream* strm) {
   }
   strm->Write(static_cast<uint64_t>(this->constants.size()));
   for (const auto& it : arrays) {
-    runtime::SaveDLTensor(strm, it);
+    runtime::SaveDLTensor(strm, it, DLTensorDataPadding(strm->Tell(), it, kAllocAlignment));
   }
 }
 
@@ -359,6 +361,18 @@ VMInstructionSerializer SerializeInstruction(const Instruction& instr) {
       fields.push_back(instr.dst);
       break;
     }
+    case Opcode::AllocRaggedTensor: {
+      // Number of fields = 6
+      fields.push_back(instr.alloc_ragged_tensor.shape_register);
+      fields.push_back(instr.alloc_ragged_tensor.lengths);
+      // Save `DLDataType` and the dst register.
+      const auto& dtype = instr.alloc_ragged_tensor.dtype;
+      fields.push_back(dtype.code);
+      fields.push_back(dtype.bits);
+      fields.push_back(dtype.lanes);
+      fields.push_back(instr.dst);
+      break;
+    }
     case Opcode::AllocADT: {
       // Number of fields = 3 + instr.num_fields
       fields.assign({instr.constructor_tag, instr.num_fields, instr.dst});
@@ -491,6 +505,22 @@ runtime::Module Executable::Load(const std::string& code, const runtime::Module
   return runtime::Module(exec);
 }
 
+runtime::Module Executable::LoadFromFile(const std::string& file_name,
+                                         const runtime::Module lib) {
+  auto exec = make_object<Executable>();
+  exec->lib = lib;
+  std::shared_ptr<MappedFile> file = MappedFile::Open(file_name);
+  std::unique_ptr<dmlc::SeekStream> strm = file->Stream();
+
+  LoadHeader(strm.get());
+  exec->LoadGlobalSection(strm.get());
+  exec->LoadConstantSection(strm.get(), file);
+  exec->LoadPrimitiveOpNames(strm.get());
+  exec->LoadCodeSection(strm.get());
+
+  return runtime::Module(exec);
+}
+
 void Executable::LoadGlobalSection(dmlc::Stream* strm) {
   std::vector<std::string> globals;
   STREAM_CHECK(strm->Read(&globals), "global");
@@ -499,7 +529,8 @@ void Executable::LoadGlobalSection(dmlc::Stream* strm) {
   }
 }
 
-void Executable::LoadConstantSection(dmlc::Stream* strm) {
+void Executable::LoadConstantSection(dmlc::SeekStream* strm,
+                                     const std::shared_ptr<MappedFile>& file) {
   uint64_t sz;
   // Load the number of constants.
   STREAM_CHECK(strm->Read(&sz, sizeof(sz)), "constant");
@@ -508,7 +539,11 @@ void Executable::LoadConstantSection(dmlc::Stream* strm) {
   // Load each of the constants.
   for (size_t i = 0; i < size; i++) {
     runtime::NDArray constant;
-    STREAM_CHECK(constant.Load(strm), "constant");
+    if (file != nullptr) {
+      constant = LoadMappedNDArray(strm, file);
+    } else {
+      STREAM_CHECK(constant.Load(strm), "constant");
+    }
     this->constants.push_back(constant);
   }
 }
@@ -640,6 +675,21 @@ Instruction DeserializeInstruction(const VMInstructionSerializer& instr) {
         dtype,
         dst);
     }
+    case Opcode::AllocRaggedTensor: {
+      // Number of fields = 6
+      DCHECK_EQ(instr.fields.size(), 6U);
+      RegName shape_register = instr.fields[0];
+      RegName lengths = instr.fields[1];
+
+      DLDataType dtype;
+      dtype.code = instr.fields[2];
+      dtype.bits = instr.fields[3];
+      dtype.lanes = instr.fields[4];
+
+      RegName dst = instr.fields[5];
+
+      return Instruction::AllocRaggedTensor(shape_register, lengths, dtype, dst);
+    }
     case Opcode::If: {
       // Number of fields = 4
       DCHECK_EQ(instr.fields.size(), 4U);
@@ -796,6 +846,13 @@ TVM_REGISTER_GLOBAL("runtime.Load_Executable")
   return Executable::Load(code, lib);
 });
 
+TVM_REGISTER_GLOBAL("runtime.Load_Executable_From_File")
+.set_body_typed([](
+    std::string file_name,
+    runtime::Module lib) {
+  return Executable::LoadFromFile(file_name, lib);
+});
+
 }  // namespace vm
 }  // namespace runtime
 }  // namespace tvm
@@ -24,6 +24,7 @@
 #include <utility>
 #include <memory>
 #include "memory_manager.h"
+#include "arena_allocator.h"
 #include "naive_allocator.h"
 #include "pooled_allocator.h"
 
@@ -98,6 +99,21 @@ NDArray StorageObj::AllocNDArray(size_t offset, std::vector<int64_t> shape, DLDa
   return ret;
 }
 
+NDArray StorageObj::AllocRaggedNDArray(size_t offset, std::vector<int64_t> dense_shape,
+                                       DLDataType dtype) {
+  CHECK_EQ(offset, 0u);
+  VerifyDataType(dtype);
+
+  NDArray::Container* container =
+      new NDArray::Container(nullptr, dense_shape, dtype, this->buffer.ctx);
+  container->SetDeleter(StorageObj::Deleter);
+  this->IncRef();
+  container->manager_ctx = reinterpret_cast<void*>(this);
+  container->dl_tensor.data = this->buffer.data;
+  // The packed size depends on the row lengths, which the caller checked.
+  return NDArray(GetObjectPtr<Object>(container));
+}
+
 MemoryManager* MemoryManager::Global() {
   static MemoryManager memory_manager;
   return &memory_manager;
@@ -114,6 +130,37 @@ Allocator* MemoryManager::GetAllocator(TVMContext ctx) {
   return allocators_.at(ctx).get();
 }
 
+Allocator* MemoryManager::GetAllocator(TVMContext ctx, AllocatorType type) {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (type == kArena && ctx.device_type != kDLCPU && ctx.device_type != kDLCPUPinned &&
+      ctx.device_type != kDLGPU && ctx.device_type != kDLROCM) {
+    // The buffers of an arena are offsets into one allocation, which
+    // needs device pointers that support arithmetic.
+    LOG(WARNING) << "Arena allocation is not supported on " << DeviceName(ctx.device_type)
+                 << ", using a pooled allocator";
+    type = kPooled;
+  }
+  auto it = allocators_.find(ctx);
+  if (it == allocators_.end()) {
+    DLOG(INFO) << "New allocator for " << DeviceName(ctx.device_type) << "("
+               << ctx.device_id << ")";
+    std::unique_ptr<Allocator> alloc;
+    switch (type) {
+      case kNaive: alloc.reset(new NaiveAllocator(ctx)); break;
+      case kPooled: alloc.reset(new PooledAllocator(ctx)); break;
+      case kArena: alloc.reset(new ArenaAllocator(ctx)); break;
+      default: LOG(FATAL) << "Unknown allocator type " << type;
+    }
+    it = allocators_.emplace(ctx, std::move(alloc)).first;
+  }
+  // Buffers are freed through the allocator of their context, so the
+  // allocator of a context cannot change once it allocated.
+  CHECK_EQ(it->second->type(), type)
+      << "The allocator of " << DeviceName(ctx.device_type) << "(" << ctx.device_id
+      << ") was already created with another type";
+  return it->second.get();
+}
+
 NDArray Allocator::Empty(std::vector<int64_t> shape, DLDataType dtype, DLContext ctx) {
   VerifyDataType(dtype);
   NDArray::Container* container = new NDArray::Container(nullptr, shape, dtype, ctx);
@@ -54,6 +54,13 @@ namespace tvm {
 namespace runtime {
 namespace vm {
 
+/*! \brief The kinds of allocators. */
+enum AllocatorType {
+  kNaive = 1,
+  kPooled,
+  kArena,
+};
+
 struct Buffer {
   /*! \brief The pointer to the allocated block of memory. */
   void* data{nullptr};
@@ -65,7 +72,7 @@ struct Buffer {
 
 class Allocator {
  public:
-  Allocator() {}
+  explicit Allocator(AllocatorType type) : type_(type) {}
 
   /*! \brief Allocate an empty NDArray using from the allocator.
    *  \param shape The shape of the NDArray.
@@ -91,14 +98,31 @@ class Allocator {
    *  \return The amount of memory currently allocated.
    */
   virtual size_t UsedMemory() const = 0;
+  /*! \brief Called at the start of every VM invocation. */
+  virtual void Reset() {}
+  /*! \brief Reserve memory for the buffers an invocation allocates.
+   *  \param nbytes The total size of the buffers.
+   */
+  virtual void Reserve(size_t nbytes) {}
+  /*! \brief The kind of the allocator. */
+  AllocatorType type() const { return type_; }
   virtual ~Allocator() = default;
+
+ private:
+  AllocatorType type_;
 };
 
 class MemoryManager {
  public:
   static MemoryManager* Global();
 
+  /*! \brief Get the allocator of a context, creating a naive one if
+   *  it has none. */
   Allocator* GetAllocator(TVMContext ctx);
+  /*! \brief Get the allocator of a context, creating one of the given
+   *  kind if it has none.
+   */
+  Allocator* GetAllocator(TVMContext ctx, AllocatorType type);
 
  private:
   MemoryManager() {}
@@ -119,6 +143,14 @@ class StorageObj : public Object {
                        std::vector<int64_t> shape,
                        DLDataType dtype);
 
+  /*!
+   * \brief Allocate a ragged NDArray from a given piece of storage. The
+   *  storage holds the packed rows, which may be smaller than the dense shape.
+   */
+  NDArray AllocRaggedNDArray(size_t offset,
+                             std::vector<int64_t> dense_shape,
+                             DLDataType dtype);
+
   /*! \brief The deleter for an NDArray when allocated from underlying storage. */
   static void Deleter(Object* ptr);
 
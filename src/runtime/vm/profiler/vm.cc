@@ -26,7 +26,7 @@
 #include <tvm/runtime/vm.h>
 
 #include <algorithm>
-#include <chrono>
+#include <functional>
 #include <iomanip>
 #include <memory>
 #include <numeric>
@@ -34,6 +34,7 @@
 #include <utility>
 #include <vector>
 
+#include "../../event_timer.h"
 #include "vm.h"
 
 namespace tvm {
@@ -65,7 +66,8 @@ PackedFunc VirtualMachineDebug::GetFunction(
       os << std::setw(30) << std::left << "#OpName"
          << "\t" << std::setw(10) << std::left << "#InvokeCount"
          << "\t"
-         << "#Duration(us): Sum/Mean/Min/Max" << std::endl;
+         << "#Duration(us): Sum/Mean/Min/Max"
+         << "\t#OutputElems/s" << std::endl;
 
       for (auto kv : op_acc_time) {
         auto vals = op_durations_[kv.first];
@@ -76,7 +78,9 @@ PackedFunc VirtualMachineDebug::GetFunction(
 
         os << std::setw(30) << std::left << packed_index_map_[kv.first] << "\t"
            << std::setw(10) << std::left << op_invokes_[kv.first] << "\t"
-           <<  sum << "/" << mean << "/" << min_value << "/" << max_value << std::endl;
+           <<  sum << "/" << mean << "/" << min_value << "/" << max_value << "\t"
+           << (sum > 0 ? op_elems_[kv.first] / (sum * 1e-6) : 0.0)
+           << (op_device_timed_[kv.first] ? "" : " (host timer)") << std::endl;
 
         total_duration += sum;
         total_packed_funcs += op_invokes_[kv.first];
@@ -89,6 +93,7 @@ PackedFunc VirtualMachineDebug::GetFunction(
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       op_durations_.clear();
       op_invokes_.clear();
+      op_elems_.clear();
     });
   } else {
     return VirtualMachine::GetFunction(name, sptr_to_self);
@@ -114,17 +119,24 @@ void VirtualMachineDebug::InvokePacked(Index packed_index,
   VirtualMachine::InvokePacked(packed_index, func, arg_count, output_size, args);
   TVMSynchronize(ctx.device_type, ctx.device_id, nullptr);
 
-  auto op_begin = std::chrono::high_resolution_clock::now();
+  EventTimer timer(ctx);
+  timer.Start();
   VirtualMachine::InvokePacked(packed_index, func, arg_count, output_size, args);
-  TVMSynchronize(ctx.device_type, ctx.device_id, nullptr);
-  auto op_end = std::chrono::high_resolution_clock::now();
-  double op_duration =
-      std::chrono::duration_cast<std::chrono::duration<double> >(op_end -
-                                                                 op_begin)
-          .count();
+  double op_duration = timer.Stop();
+
+  // The work of the op, in the elements of its outputs.
+  int64_t elems = 0;
+  for (Index i = arg_count - output_size; i < arg_count; ++i) {
+    if (const auto* arr = args[i].as<NDArray::ContainerType>()) {
+      const DLTensor& t = arr->dl_tensor;
+      elems += std::accumulate(t.shape, t.shape + t.ndim, int64_t(1), std::multiplies<int64_t>());
+    }
+  }
 
-  op_durations_[packed_index].push_back(op_duration * 1e6);
+  op_durations_[packed_index].push_back(op_duration);
   op_invokes_[packed_index] += 1;
+  op_elems_[packed_index] += elems;
+  op_device_timed_[packed_index] = timer.on_device();
 }
 
 runtime::Module CreateVirtualMachineDebug(const Executable* exec) {
@@ -54,6 +54,8 @@ class VirtualMachineDebug : public VirtualMachine {
   std::unordered_map<Index, std::string> packed_index_map_;
   std::unordered_map<Index, std::vector<double>> op_durations_;
   std::unordered_map<Index, int> op_invokes_;
+  std::unordered_map<Index, int64_t> op_elems_;
+  std::unordered_map<Index, bool> op_device_timed_;
 };
 
 }  // namespace vm
@@ -52,6 +52,13 @@ VMClosure::VMClosure(size_t func_index, std::vector<ObjectRef> free_vars) {
   data_ = std::move(ptr);
 }
 
+RaggedTensor::RaggedTensor(NDArray data, NDArray offsets) {
+  auto ptr = make_object<RaggedTensorObj>();
+  ptr->data = std::move(data);
+  ptr->offsets = std::move(offsets);
+  data_ = std::move(ptr);
+}
+
 inline Storage make_storage(size_t size, size_t alignment, DLDataType dtype_hint, TVMContext ctx) {
   // We could put cache in here, from ctx to storage allocator.
   auto storage_obj = SimpleObjAllocator().make_object<StorageObj>();
@@ -144,6 +151,9 @@ Instruction::Instruction(const Instruction& instr) {
     case Opcode::AllocStorage:
       this->alloc_storage = instr.alloc_storage;
       return;
+    case Opcode::AllocRaggedTensor:
+      this->alloc_ragged_tensor = instr.alloc_ragged_tensor;
+      return;
     default:
       std::ostringstream out;
       out << "Invalid instruction " << static_cast<int>(instr.op);
@@ -236,6 +246,9 @@ Instruction& Instruction::operator=(const Instruction& instr) {
     case Opcode::AllocStorage:
       this->alloc_storage = instr.alloc_storage;
       return *this;
+    case Opcode::AllocRaggedTensor:
+      this->alloc_ragged_tensor = instr.alloc_ragged_tensor;
+      return *this;
     default:
       std::ostringstream out;
       out << "Invalid instruction " << static_cast<int>(instr.op);
@@ -255,6 +268,7 @@ Instruction::~Instruction() {
     case Opcode::Goto:
     case Opcode::LoadConsti:
     case Opcode::AllocStorage:
+    case Opcode::AllocRaggedTensor:
     case Opcode::Fatal:
       return;
     case Opcode::AllocTensor:
@@ -353,6 +367,19 @@ Instruction Instruction::AllocStorage(RegName size,
   return instr;
 }
 
+Instruction Instruction::AllocRaggedTensor(RegName shape_register,
+                                           RegName lengths,
+                                           DLDataType dtype,
+                                           Index dst) {
+  Instruction instr;
+  instr.op = Opcode::AllocRaggedTensor;
+  instr.dst = dst;
+  instr.alloc_ragged_tensor.shape_register = shape_register;
+  instr.alloc_ragged_tensor.lengths = lengths;
+  instr.alloc_ragged_tensor.dtype = dtype;
+  return instr;
+}
+
 Instruction Instruction::AllocADT(Index tag, Index num_fields,
                                        const std::vector<RegName>& datatype_fields, Index dst) {
   Instruction instr;
@@ -596,6 +623,13 @@ void InstructionPrint(std::ostream& os, const Instruction& instr) {
         DLDataType2String(instr.alloc_storage.dtype_hint);
       break;
     }
+    case Opcode::AllocRaggedTensor: {
+      os << "alloc_ragged_tensor $" << instr.dst << " $"
+         << instr.alloc_ragged_tensor.shape_register << " $"
+         << instr.alloc_ragged_tensor.lengths << " ";
+      DLDatatypePrint(os, instr.alloc_ragged_tensor.dtype);
+      break;
+    }
     default:
       LOG(FATAL) << "should never hit this case" << static_cast<int>(instr.op);
       break;
@@ -638,7 +672,7 @@ PackedFunc VirtualMachine::GetFunction(const std::string& name,
       auto git = exec_->global_map.find(func_name);
       CHECK(git != exec_->global_map.end())
         << "Cannot find function " << func_name << " in the executable";
-      auto func = exec_->functions[git->second];
+      const auto& func = exec_->functions[git->second];
       if (func.params.empty()) {
         *rv = Invoke(func, {});
       } else {
@@ -661,6 +695,21 @@ PackedFunc VirtualMachine::GetFunction(const std::string& name,
       }
       this->Init(contexts);
     });
+  } else if (name == "set_allocator") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      CHECK(args.size() == 3 || args.size() == 4);
+      TVMContext ctx;
+      int device_type = args[0];
+      ctx.device_type = DLDeviceType(device_type);
+      ctx.device_id = args[1];
+      int type = args[2];
+      Allocator* alloc =
+          MemoryManager::Global()->GetAllocator(ctx, static_cast<AllocatorType>(type));
+      if (args.size() == 4) {
+        int64_t reserve_bytes = args[3];
+        alloc->Reserve(static_cast<size_t>(reserve_bytes));
+      }
+    });
   } else if (name == "set_input") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       CHECK(exec_) << "The executable is not created yet.";
@@ -703,8 +752,15 @@ TVMContext VirtualMachine::GetParamsContext() const {
 }
 
 void VirtualMachine::PushFrame(Index arg_count, Index ret_pc, const VMFunction& vm_func) {
-  auto frame = VMFrame(ret_pc, func_index_, arg_count, code_, vm_func.register_file_size);
-  frames_.push_back(frame);
+  frames_.emplace_back(ret_pc, func_index_, arg_count, code_, 0);
+  // Take the register file of a popped frame, so that calls do not
+  // allocate once the call stack has been as deep before.
+  std::vector<ObjectRef>& register_file = frames_.back().register_file;
+  if (!free_register_files_.empty()) {
+    register_file.swap(free_register_files_.back());
+    free_register_files_.pop_back();
+  }
+  register_file.resize(vm_func.register_file_size);
 }
 
 Index VirtualMachine::PopFrame() {
@@ -714,14 +770,19 @@ Index VirtualMachine::PopFrame() {
   code_ = fr.code;
   pc_ = fr.pc;
   auto call_stack_size = frames_.size();
+  std::vector<ObjectRef>& register_file = frames_.back().register_file;
+  register_file.clear();
+  free_register_files_.push_back(std::move(register_file));
   frames_.pop_back();
   return call_stack_size;
 }
 
-void VirtualMachine::InvokeGlobal(const VMFunction& func, const std::vector<ObjectRef>& args) {
+void VirtualMachine::InvokeGlobal(Index func_index, const std::vector<ObjectRef>& args) {
+  const VMFunction& func = exec_->functions[func_index];
   DLOG(INFO) << "Invoking global " << func.name << " " << args.size();
 
   PushFrame(func.params.size(), this->pc_ + 1, func);
+  func_index_ = func_index;
   for (size_t i = 0; i < args.size(); ++i) {
     WriteRegister(i, args[i]);
   }
@@ -734,7 +795,13 @@ void VirtualMachine::InvokeGlobal(const VMFunction& func, const std::vector<Obje
 ObjectRef VirtualMachine::Invoke(const VMFunction& func, const std::vector<ObjectRef>& args) {
   DLOG(INFO) << "Executing Function: " << std::endl << func;
 
-  InvokeGlobal(func, args);
+  for (const auto& ctx : ctxs_) {
+    MemoryManager::Global()->GetAllocator(ctx)->Reset();
+  }
+  auto it = exec_->global_map.find(func.name);
+  CHECK(it != exec_->global_map.end())
+    << "Cannot find function " << func.name << " in the executable";
+  InvokeGlobal(it->second, args);
   RunLoop();
   // TODO(wweic) ctx could be obtained from the ctxs list.
   auto alloc = MemoryManager::Global()->GetAllocator(ctxs_[0]);
@@ -759,30 +826,40 @@ void VirtualMachine::InvokePacked(Index packed_index, const PackedFunc& func,
   for (Index i = 0; i < arg_count; i++) {
     if (const auto* obj = args[i].as<ADTObj>()) {
       arity += obj->size;
+    } else if (args[i]->IsInstance<RaggedTensorObj>()) {
+      arity += 2;
     } else {
       ++arity;
     }
   }
 
-  std::vector<TVMValue> values(arity);
-  std::vector<int> codes(arity);
-  runtime::TVMArgsSetter setter(values.data(), codes.data());
+  packed_values_.resize(arity);
+  packed_codes_.resize(arity);
+  runtime::TVMArgsSetter setter(packed_values_.data(), packed_codes_.data());
   int idx = 0;
+  // The arrays are passed by handle, without taking references to them.
+  auto set_arg = [&setter, &idx](const ObjectRef& obj) {
+    CHECK(obj->IsInstance<NDArray::ContainerType>())
+        << "Packed functions take NDArrays, but got " << obj->GetTypeKey();
+    setter(idx++, obj);
+  };
   for (Index i = 0; i < arg_count; i++) {
     if (const auto* dt_cell = args[i].as<ADTObj>()) {
       for (size_t fi = 0; fi < dt_cell->size; ++fi) {
-        auto obj = (*dt_cell)[fi];
-        auto nd_array = Downcast<NDArray>(obj);
-        setter(idx++, nd_array);
+        set_arg((*dt_cell)[fi]);
       }
+    } else if (const auto* ragged = args[i].as<RaggedTensorObj>()) {
+      // Ragged kernels take the packed data followed by its row offsets.
+      set_arg(ragged->data);
+      set_arg(ragged->offsets);
     } else {
-      auto nd_array = Downcast<NDArray>(args[i]);
-      setter(idx++, nd_array);
+      set_arg(args[i]);
     }
   }
 
   TVMRetValue rv;
-  func.CallPacked(TVMArgs(values.data(), codes.data(), arity), &rv);
+  func.CallPacked(TVMArgs(packed_values_.data(), packed_codes_.data(), static_cast<int>(arity)),
+                  &rv);
 }
 
 void VirtualMachine::LoadExecutable(const Executable* exec) {
@@ -804,6 +881,10 @@ void VirtualMachine::LoadExecutable(const Executable* exec) {
     CHECK(pf != nullptr) << "Cannot find function in module: " << packed_name;
     packed_funcs_[packed_index] = pf;
   }
+  consti_pool_.clear();
+  for (const auto& func : exec_->functions) {
+    consti_pool_.emplace_back(func.instructions.size());
+  }
 }
 
 
@@ -815,22 +896,31 @@ inline void VirtualMachine::WriteRegister(Index r, const ObjectRef& val) {
   frames_.back().register_file[r] = val;
 }
 
-inline ObjectRef VirtualMachine::ReadRegister(Index r) const {
+inline const ObjectRef& VirtualMachine::ReadRegister(Index r) const {
   return frames_.back().register_file[r];
 }
 
 inline int32_t VirtualMachine::LoadScalarInt(Index r) const {
   int32_t result;
   const auto& obj = ReadRegister(r);
-  auto nd_array = Downcast<NDArray>(obj);
-  NDArray array = nd_array.CopyTo({kDLCPU, 0});
+  const auto* container = obj.as<NDArray::ContainerType>();
+  CHECK(container) << "Expect a scalar NDArray, but got " << obj->GetTypeKey();
+  // Scalars on the host, such as shapes and the conditions of branches,
+  // are read in place.
+  const DLTensor* array = &container->dl_tensor;
+  NDArray host_array;
+  if (array->ctx.device_type != kDLCPU) {
+    host_array = Downcast<NDArray>(obj).CopyTo({kDLCPU, 0});
+    array = host_array.operator->();
+  }
+  const char* data = static_cast<const char*>(array->data) + array->byte_offset;
 
   if (array->dtype.bits <= 8) {
-    result = reinterpret_cast<int8_t*>(array->data)[0];
+    result = reinterpret_cast<const int8_t*>(data)[0];
   } else if (array->dtype.bits <= 16) {
-    result = reinterpret_cast<int16_t*>(array->data)[0];
+    result = reinterpret_cast<const int16_t*>(data)[0];
   } else {
-    result = reinterpret_cast<int32_t*>(array->data)[0];
+    result = reinterpret_cast<const int32_t*>(data)[0];
   }
   return result;
 }
@@ -850,9 +940,7 @@ void VirtualMachine::RunLoop() {
 
     switch (instr.op) {
       case Opcode::Move: {
-        ObjectRef from_obj;
-        from_obj = ReadRegister(instr.from);
-        WriteRegister(instr.dst, from_obj);
+        WriteRegister(instr.dst, ReadRegister(instr.from));
         pc_++;
         goto main_loop;
       }
@@ -877,8 +965,13 @@ void VirtualMachine::RunLoop() {
         goto main_loop;
       }
       case Opcode::LoadConsti: {
-        auto tensor = NDArray::Empty({1}, {kDLInt, 64, 1}, {kDLCPU, 0});
-        reinterpret_cast<int64_t*>(tensor->data)[0] = instr.load_consti.val;
+        // The scalar of each instruction is made once, like constants.
+        ObjectRef& tensor = consti_pool_[func_index_][pc_];
+        if (!tensor.defined()) {
+          auto scalar = NDArray::Empty({1}, {kDLInt, 64, 1}, {kDLCPU, 0});
+          reinterpret_cast<int64_t*>(scalar->data)[0] = instr.load_consti.val;
+          tensor = scalar;
+        }
         WriteRegister(instr.dst, tensor);
         pc_++;
         goto main_loop;
@@ -888,7 +981,7 @@ void VirtualMachine::RunLoop() {
         for (Index i = 0; i < instr.num_args; ++i) {
           args.push_back(ReadRegister(instr.invoke_args_registers[i]));
         }
-        InvokeGlobal(exec_->functions[instr.func_index], args);
+        InvokeGlobal(instr.func_index, args);
         frames_.back().caller_return_register = instr.dst;
         goto main_loop;
       }
@@ -896,17 +989,18 @@ void VirtualMachine::RunLoop() {
         DLOG(INFO) << "InvokedPacked " << "arity=" << instr.arity;
         const auto& func = packed_funcs_[instr.packed_index];
         const auto& arity = instr.arity;
-        std::vector<ObjectRef> args;
+        packed_args_.clear();
         for (Index i = 0; i < arity; ++i) {
           DLOG(INFO) <<
             "arg" << i << " $" << instr.packed_args[i];
-          auto arg = ReadRegister(instr.packed_args[i]);
-          args.push_back(arg);
+          packed_args_.push_back(ReadRegister(instr.packed_args[i]));
         }
 
         // We no longer need to write the registers back, we write directly
         // through the registers mutably.
-        InvokePacked(instr.packed_index, func, arity, instr.output_size, args);
+        InvokePacked(instr.packed_index, func, arity, instr.output_size, packed_args_);
+        // Release the arguments, so that they die with their registers.
+        packed_args_.clear();
         pc_++;
         goto main_loop;
       }
@@ -921,22 +1015,23 @@ void VirtualMachine::RunLoop() {
         for (Index i = 0; i < instr.num_closure_args; ++i) {
           args.push_back(ReadRegister(instr.closure_args[i]));
         }
-        InvokeGlobal(exec_->functions[closure->func_index], args);
+        InvokeGlobal(closure->func_index, args);
         frames_.back().caller_return_register = instr.dst;
         goto main_loop;
       }
       case Opcode::GetField: {
-        auto object = ReadRegister(instr.object);
-        const auto& tuple = Downcast<ADT>(object);
-        auto field = tuple[instr.field_index];
+        const auto* tuple = ReadRegister(instr.object).as<ADTObj>();
+        CHECK(tuple) << "GetField expects a tuple";
+        // Copy the field out before the write may release the tuple.
+        ObjectRef field = (*tuple)[instr.field_index];
         WriteRegister(instr.dst, field);
         pc_++;
         goto main_loop;
       }
       case Opcode::GetTag: {
-        auto object = ReadRegister(instr.get_tag.object);
-        const auto& adt = Downcast<ADT>(object);
-        auto tag = adt.tag();
+        const auto* adt = ReadRegister(instr.get_tag.object).as<ADTObj>();
+        CHECK(adt) << "GetTag expects an ADT";
+        auto tag = adt->tag;
         auto tag_tensor = NDArray::Empty({1}, {kDLInt, 32, 1}, {kDLCPU, 0});
         reinterpret_cast<int32_t*>(tag_tensor->data)[0] = tag;
         WriteRegister(instr.dst, tag_tensor);
@@ -1032,6 +1127,50 @@ void VirtualMachine::RunLoop() {
         pc_++;
         goto main_loop;
       }
+      case Opcode::AllocRaggedTensor: {
+        DLContext cpu_ctx;
+        cpu_ctx.device_type = kDLCPU;
+        cpu_ctx.device_id = 0;
+        auto shape_arr = Downcast<NDArray>(ReadRegister(instr.alloc_ragged_tensor.shape_register));
+        NDArray shape_tensor = shape_arr.CopyTo(cpu_ctx);
+        CHECK_EQ(shape_tensor->dtype.code, 0u);
+        CHECK_EQ(shape_tensor->dtype.bits, 64);
+        int64_t* dims = reinterpret_cast<int64_t*>(shape_tensor->data);
+        std::vector<int64_t> shape(dims, dims + shape_tensor->shape[0]);
+        CHECK_GE(shape.size(), 2U) << "a ragged tensor needs a row and a length axis";
+
+        auto lengths_arr = Downcast<NDArray>(ReadRegister(instr.alloc_ragged_tensor.lengths));
+        NDArray lengths = lengths_arr.CopyTo(cpu_ctx);
+        CHECK(lengths->ndim == 1 && lengths->dtype.code == kDLInt && lengths->dtype.bits == 32)
+            << "the row lengths of a ragged tensor must be a 1-D int32 tensor";
+        CHECK_EQ(lengths->shape[0], shape[0]);
+
+        // Rows are packed back to back, so the allocation holds the sum
+        // of the row lengths rather than the dense bound.
+        const int32_t* len = static_cast<const int32_t*>(lengths->data);
+        NDArray offsets = NDArray::Empty({shape[0] + 1}, lengths->dtype, cpu_ctx);
+        int32_t* off = static_cast<int32_t*>(offsets->data);
+        off[0] = 0;
+        for (int64_t i = 0; i < shape[0]; ++i) {
+          CHECK(len[i] >= 0 && len[i] <= shape[1])
+              << "row " << i << " has length " << len[i] << ", bound " << shape[1];
+          off[i + 1] = off[i] + len[i];
+        }
+        DLDataType dtype = instr.alloc_ragged_tensor.dtype;
+        size_t size = static_cast<size_t>(off[shape[0]]) * ((dtype.bits * dtype.lanes + 7) / 8);
+        for (size_t i = 2; i < shape.size(); ++i) {
+          size *= static_cast<size_t>(shape[i]);
+        }
+
+        auto storage = make_storage(size, kAllocAlignment, dtype, ctxs_[0]);
+        auto data = storage->AllocRaggedNDArray(0, shape, dtype);
+        if (ctxs_[0].device_type != kDLCPU) {
+          offsets = offsets.CopyTo(ctxs_[0]);
+        }
+        WriteRegister(instr.dst, RaggedTensor(data, offsets));
+        pc_++;
+        goto main_loop;
+      }
       case Opcode::Ret: {
         // If we have hit the point from which we started
         // running, we should return to the caller breaking
@@ -100,6 +100,9 @@ struct VulkanPipeline {
   VkPipelineLayout pipeline_layout{VK_NULL_HANDLE};
   VkPipeline pipeline{VK_NULL_HANDLE};
   VkDescriptorUpdateTemplateKHR descriptor_update_template{VK_NULL_HANDLE};
+  // The buffer the POD arguments are read from, when they do not fit
+  // in the push constants.
+  VulkanBuffer* pod_buffer{nullptr};
 };
 
 typedef dmlc::ThreadLocalStore<VulkanThreadEntry> VulkanThreadStore;
@@ -742,6 +745,10 @@ class VulkanModuleNode final : public runtime::ModuleNode {
         vkDestroyDescriptorPool(vctx.device, pe->descriptor_pool, nullptr);
         vkDestroyDescriptorSetLayout(vctx.device, pe->descriptor_set_layout, nullptr);
         vkDestroyShaderModule(vctx.device, pe->shader, nullptr);
+        if (pe->pod_buffer != nullptr) {
+          TVMContext ctx{static_cast<DLDeviceType>(kDLVulkan), static_cast<int>(device_id)};
+          VulkanDeviceAPI::Global()->FreeDataSpace(ctx, pe->pod_buffer);
+        }
       }
     }
   }
@@ -756,10 +763,11 @@ class VulkanModuleNode final : public runtime::ModuleNode {
     }
     // Create new pipeline
     auto pe = std::shared_ptr<VulkanPipeline>(new VulkanPipeline());
+    auto sit = smap_.find(func_name);
+    CHECK(sit != smap_.end());
+    bool pod_args_in_buffer = (sit->second.flag & kVulkanShaderPODArgsInBuffer) != 0;
     {
       // create shader
-      auto sit = smap_.find(func_name);
-      CHECK(sit != smap_.end());
       const std::vector<uint32_t>& data = sit->second.data;
       VkShaderModuleCreateInfo shader_cinfo;
       shader_cinfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
@@ -802,6 +810,27 @@ class VulkanModuleNode final : public runtime::ModuleNode {
         }
       }
     }
+    if (pod_args_in_buffer && num_pack_args != 0) {
+      // The POD arguments are bound after the buffer arguments.
+      VkDescriptorSetLayoutBinding bd;
+      bd.binding = num_buffer;
+      bd.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+      bd.descriptorCount = 1;
+      bd.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+      bd.pImmutableSamplers = nullptr;
+      arg_binding.push_back(bd);
+      VkDescriptorUpdateTemplateEntryKHR tpl;
+      tpl.dstBinding = num_buffer;
+      tpl.dstArrayElement = 0;
+      tpl.descriptorCount = 1;
+      tpl.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+      tpl.offset = num_buffer * sizeof(VkDescriptorBufferInfo);
+      tpl.stride = sizeof(VkDescriptorBufferInfo);
+      arg_template.push_back(tpl);
+      TVMContext ctx{static_cast<DLDeviceType>(kDLVulkan), static_cast<int>(device_id)};
+      pe->pod_buffer = static_cast<VulkanBuffer*>(VulkanDeviceAPI::Global()->AllocDataSpace(
+          ctx, sizeof(ArgUnion) * num_pack_args, 0, DLDataType{kDLInt, 32, 1}));
+    }
 
     {
       VkDescriptorSetLayoutCreateInfo descrip_cinfo;
@@ -854,7 +883,7 @@ class VulkanModuleNode final : public runtime::ModuleNode {
     playout_cinfo.setLayoutCount = 1;
     playout_cinfo.pSetLayouts = &(pe->descriptor_set_layout);
 
-    if (num_pack_args != 0) {
+    if (num_pack_args != 0 && pe->pod_buffer == nullptr) {
       playout_cinfo.pushConstantRangeCount = 1;
       playout_cinfo.pPushConstantRanges = &crange;
       CHECK_LE(crange.size, vctx.phy_device_prop.limits.maxPushConstantsSize);
@@ -1017,6 +1046,24 @@ VulkanStream* VulkanThreadEntry::Stream(size_t device_id) {
   return streams_[device_id].get();
 }
 
+// Write the POD arguments of a launch to the buffer of the pipeline
+// and make them visible to the shader.
+static void UpdatePODBuffer(VkCommandBuffer cmd_buffer, const VulkanPipeline& pipeline,
+                            const ArgUnion* pack_args, size_t num_pack_args) {
+  // The barrier following the previous dispatch orders the update
+  // after the reads of the previous launch.
+  vkCmdUpdateBuffer(cmd_buffer, pipeline.pod_buffer->buffer, 0, num_pack_args * sizeof(ArgUnion),
+                    pack_args);
+  VkMemoryBarrier barrier_info;
+  barrier_info.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+  barrier_info.pNext = nullptr;
+  barrier_info.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier_info.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  vkCmdPipelineBarrier(cmd_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier_info, 0, nullptr, 0,
+                       nullptr);
+}
+
 void VulkanWrappedFunc::operator()(TVMArgs args, TVMRetValue* rv,
                                     const ArgUnion* pack_args) const {
   int device_id = VulkanThreadEntry::ThreadLocal()->ctx.device_id;
@@ -1037,6 +1084,13 @@ void VulkanWrappedFunc::operator()(TVMArgs args, TVMRetValue* rv,
     binfo.range = VK_WHOLE_SIZE;
     descriptor_buffers[i] = binfo;
   }
+  if (pipeline->pod_buffer != nullptr) {
+    VkDescriptorBufferInfo binfo;
+    binfo.buffer = pipeline->pod_buffer->buffer;
+    binfo.offset = 0;
+    binfo.range = VK_WHOLE_SIZE;
+    descriptor_buffers.push_back(binfo);
+  }
   if (vctx.UseImmediate()) {
     // Can safely capture by reference as this lambda is immediately executed on the calling thread.
     VulkanThreadEntry::ThreadLocal()->Stream(device_id)->Launch([&](VulkanStreamState* state) {
@@ -1045,7 +1099,9 @@ void VulkanWrappedFunc::operator()(TVMArgs args, TVMRetValue* rv,
       vctx.descriptor_template_khr_functions->vkCmdPushDescriptorSetWithTemplateKHR(
           state->cmd_buffer_, pipeline->descriptor_update_template, pipeline->pipeline_layout, 0,
           descriptor_buffers.data());
-      if (num_pack_args_ != 0) {
+      if (pipeline->pod_buffer != nullptr) {
+        UpdatePODBuffer(state->cmd_buffer_, *pipeline, pack_args, num_pack_args_);
+      } else if (num_pack_args_ != 0) {
         vkCmdPushConstants(state->cmd_buffer_, pipeline->pipeline_layout,
                            VK_SHADER_STAGE_COMPUTE_BIT, 0, num_pack_args_ * sizeof(ArgUnion),
                            pack_args);
@@ -1089,7 +1145,10 @@ void VulkanWrappedFunc::operator()(TVMArgs args, TVMRetValue* rv,
     vkCmdBindDescriptorSets(state->cmd_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE,
                             pipeline->pipeline_layout, 0, 1, &(pipeline->descriptor_set), 0,
                             nullptr);
-    if (pack_args_storage.size() != 0) {
+    if (pipeline->pod_buffer != nullptr) {
+      UpdatePODBuffer(state->cmd_buffer_, *pipeline, pack_args_storage.data(),
+                      pack_args_storage.size());
+    } else if (pack_args_storage.size() != 0) {
       vkCmdPushConstants(state->cmd_buffer_, pipeline->pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT,
                          0, pack_args_storage.size() * sizeof(ArgUnion), pack_args_storage.data());
     }
@@ -30,6 +30,16 @@ namespace tvm {
 namespace runtime {
 namespace vulkan {
 
+/*! \brief The bits of the header flag of a shader. */
+enum VulkanShaderFlag : uint32_t {
+  /*!
+   * \brief The POD arguments of the shader are read from a storage
+   *  buffer bound after the buffer arguments, rather than from push
+   *  constants, as they do not fit in the push constant space.
+   */
+  kVulkanShaderPODArgsInBuffer = 1
+};
+
 struct VulkanShader {
   /*! \brief header flag */
   uint32_t flag{0};
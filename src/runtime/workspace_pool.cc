@@ -23,120 +23,100 @@
  */
 #include "workspace_pool.h"
 
-#include <tvm/runtime/registry.h>
-
+#include <algorithm>
+#include <map>
 #include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "memory_profile.h"
 
 namespace tvm {
 namespace runtime {
 
 // page size.
 constexpr size_t kWorkspacePageSize = 4 << 10;
+// Number of size classes between consecutive powers of two.
+constexpr int kSizeClassesPerDoubling = 4;
 
+/*!
+ * \brief A caching allocator of workspaces.
+ *
+ *  Workspaces are rounded up to size classes, a few per power of two so
+ *  that at most a quarter of a workspace is wasted, and freed ones are
+ *  cached in bins per size class and stream rather than returned to the
+ *  device. A workspace is only reused on the stream it was freed on, by
+ *  when the stream orders the reuse after its previous uses, so reuse
+ *  does not synchronize. Ragged workloads request workspaces of
+ *  varying sizes on every call, which the bins serve without searching
+ *  or reallocating.
+ */
 class WorkspacePool::Pool {
  public:
-  // constructor
-  Pool() {
-    // safe guard header on each list.
-    Entry e;
-    e.data = nullptr;
-    e.size = 0;
-    free_list_.push_back(e);
-    allocated_.push_back(e);
-  }
   // allocate from pool
   void* Alloc(TVMContext ctx, DeviceAPI* device, size_t nbytes) {
-    // Allocate align to page.
-    nbytes = (nbytes + (kWorkspacePageSize - 1)) / kWorkspacePageSize * kWorkspacePageSize;
-    if (nbytes == 0) nbytes = kWorkspacePageSize;
+    nbytes = SizeClass(nbytes);
+    TVMStreamHandle stream = device->GetStream(ctx);
     Entry e;
-    DLDataType type;
-    type.code = kDLUInt;
-    type.bits = 8;
-    type.lanes = 1;
-    if (free_list_.size() == 2) {
-      e = free_list_.back();
-      free_list_.pop_back();
-      if (e.size < nbytes) {
-        // resize the page
-        device->FreeDataSpace(ctx, e.data);
-        e.data = device->AllocDataSpace(ctx, nbytes, kTempAllocaAlignment, type);
-        e.size = nbytes;
-      }
-    } else if (free_list_.size() == 1) {
-      e.data = device->AllocDataSpace(ctx, nbytes, kTempAllocaAlignment, type);
-      e.size = nbytes;
+    e.stream = stream;
+    // Take the smallest cached workspace of the stream that fits, as
+    // long as it is less than twice as large.
+    auto it = free_bins_.lower_bound(BinKey(stream, nbytes));
+    if (it != free_bins_.end() && it->first.first == stream && it->first.second < 2 * nbytes) {
+      e.data = it->second.back();
+      e.size = it->first.second;
+      it->second.pop_back();
+      if (it->second.empty()) free_bins_.erase(it);
+      cached_bytes_ -= e.size;
     } else {
-      if (free_list_.back().size >= nbytes) {
-        // find smallest fit
-        auto it = free_list_.end() - 2;
-        for (; it->size >= nbytes; --it) {
-        }
-        e = *(it + 1);
-        free_list_.erase(it + 1);
-      } else {
-        // resize the page
-        e = free_list_.back();
-        free_list_.pop_back();
-        device->FreeDataSpace(ctx, e.data);
+      DLDataType type;
+      type.code = kDLUInt;
+      type.bits = 8;
+      type.lanes = 1;
+      try {
+        e.data = device->AllocDataSpace(ctx, nbytes, kTempAllocaAlignment, type);
+      } catch (const dmlc::Error&) {
+        // Out of memory, return the cached workspaces to the device
+        // and retry.
+        if (cached_bytes_ == 0) throw;
+        ReleaseCached(ctx, device);
         e.data = device->AllocDataSpace(ctx, nbytes, kTempAllocaAlignment, type);
-        e.size = nbytes;
       }
+      e.size = nbytes;
     }
-    // std::cout << "[ALLOC] " << e.size << " " << mem_prof_on_ << std::endl;
-    allocated_.push_back(e);
-    if (mem_prof_on_) {
-      current_memory_usage_ += e.size;
-      if (current_memory_usage_ > max_memory_usage_)
-	max_memory_usage_.exchange(current_memory_usage_);
-      // std::cout << "[ALLOC]   " << current_memory_usage_ << " " << max_memory_usage_ << std::endl;
+    allocated_[e.data] = e;
+    if (MemoryProfiler::Enabled()) {
+      MemoryProfiler::Record(ctx, kMemSiteWorkspace, static_cast<int64_t>(e.size));
     }
-    // std::cout << "Allocating " << nbytes << " on " << ctx.device_type << " " << e.data << std::endl;
     return e.data;
   }
   // free resource back to pool
-  void Free(void* data) {
-    Entry e;
-    if (allocated_.back().data == data) {
-      // quick path, last allocated.
-      e = allocated_.back();
-      allocated_.pop_back();
-    } else {
-      int index = static_cast<int>(allocated_.size()) - 2;
-      for (; index > 0 && allocated_[index].data != data; --index) {
-      }
-      CHECK_GT(index, 0) << "trying to free things that has not been allocated";
-      e = allocated_[index];
-      allocated_.erase(allocated_.begin() + index);
-    }
-    if (free_list_.back().size < e.size) {
-      free_list_.push_back(e);
-    } else if (free_list_.size() == 2) {
-      free_list_.push_back(free_list_.back());
-      free_list_[1] = e;
-    } else {
-      size_t i = free_list_.size() - 1;
-      free_list_.resize(free_list_.size() + 1);
-      for (; e.size < free_list_[i].size; --i) {
-        free_list_[i + 1] = free_list_[i];
-      }
-      free_list_[i + 1] = e;
+  void Free(TVMContext ctx, void* data) {
+    auto it = allocated_.find(data);
+    CHECK(it != allocated_.end()) << "trying to free things that has not been allocated";
+    Entry e = it->second;
+    allocated_.erase(it);
+    free_bins_[BinKey(e.stream, e.size)].push_back(e.data);
+    cached_bytes_ += e.size;
+    if (MemoryProfiler::Enabled()) {
+      MemoryProfiler::Record(ctx, kMemSiteWorkspace, -static_cast<int64_t>(e.size));
     }
-    if (mem_prof_on_) {
-      current_memory_usage_ -= e.size;
-    }
-    // std::cout << "Freed " << e.size << " " << data << std::endl;
   }
   // Release all resources
   void Release(TVMContext ctx, DeviceAPI* device) {
-    CHECK_EQ(allocated_.size(), 1);
-    for (size_t i = 1; i < free_list_.size(); ++i) {
-      device->FreeDataSpace(ctx, free_list_[i].data);
-    }
-    free_list_.clear();
-    if (mem_prof_on_) {
-      current_memory_usage_ = 0;
+    CHECK_EQ(allocated_.size(), 0);
+    ReleaseCached(ctx, device);
+  }
+  // Return the cached workspaces to the device.
+  void ReleaseCached(TVMContext ctx, DeviceAPI* device) {
+    for (auto& bin : free_bins_) {
+      for (void* data : bin.second) {
+        device->FreeDataSpace(ctx, data);
+      }
     }
+    free_bins_.clear();
+    cached_bytes_ = 0;
   }
 
  private:
@@ -144,11 +124,25 @@ class WorkspacePool::Pool {
   struct Entry {
     void* data;
     size_t size;
+    TVMStreamHandle stream;
   };
-  /*! \brief List of free items, sorted from small to big size */
-  std::vector<Entry> free_list_;
-  /*! \brief List of allocated items */
-  std::vector<Entry> allocated_;
+  using BinKey = std::pair<TVMStreamHandle, size_t>;
+
+  // The size class of a workspace of nbytes.
+  static size_t SizeClass(size_t nbytes) {
+    if (nbytes <= kWorkspacePageSize) return kWorkspacePageSize;
+    size_t pow2 = kWorkspacePageSize;
+    while (pow2 < nbytes) pow2 <<= 1;
+    size_t step = std::max(pow2 / (2 * kSizeClassesPerDoubling), kWorkspacePageSize);
+    return (nbytes + step - 1) / step * step;
+  }
+
+  /*! \brief The cached workspaces, by stream and size. */
+  std::map<BinKey, std::vector<void*>> free_bins_;
+  /*! \brief The allocated workspaces. */
+  std::unordered_map<void*, Entry> allocated_;
+  /*! \brief The number of bytes of the cached workspaces. */
+  size_t cached_bytes_{0};
 };
 
 WorkspacePool::WorkspacePool(DLDeviceType device_type, std::shared_ptr<DeviceAPI> device)
@@ -178,23 +172,8 @@ void* WorkspacePool::AllocWorkspace(TVMContext ctx, size_t size) {
 
 void WorkspacePool::FreeWorkspace(TVMContext ctx, void* ptr) {
   CHECK(static_cast<size_t>(ctx.device_id) < array_.size() && array_[ctx.device_id] != nullptr);
-  array_[ctx.device_id]->Free(ptr);
+  array_[ctx.device_id]->Free(ctx, ptr);
 }
 
-std::atomic<long> WorkspacePool::current_memory_usage_{0};
-std::atomic<long> WorkspacePool::max_memory_usage_{0};
-  bool WorkspacePool::mem_prof_on_(false);
-
-TVM_REGISTER_GLOBAL("runtime.GetMaxMemConsumption").set_body_typed([]() {
-    long nbytes = WorkspacePool::max_memory_usage_.load();
-    long kbytes = ((float) nbytes) / 1024.0;
-    return kbytes;
-});
-
-TVM_REGISTER_GLOBAL("runtime.SetMemProfiling").set_body_typed([](bool value) {
-    // std::cout << "[MEMPROF] " << value << std::endl;
-    WorkspacePool::mem_prof_on_ = value;
-});
-
 }  // namespace runtime
 }  // namespace tvm
@@ -41,6 +41,10 @@ namespace runtime {
  *  - Only a few allocation will happen, and space will be released after use.
  *  - The release order is usually in reverse order of allocate
  *  - Repeative pattern of same allocations over different runs.
+ *
+ *  Freed workspaces are cached per size class and per stream of the
+ *  device (DeviceAPI::GetStream), and returned to the device when an
+ *  allocation runs out of memory or the pool is destroyed.
  */
 class TVM_DLL WorkspacePool {
  public:
@@ -74,12 +78,6 @@ class TVM_DLL WorkspacePool {
   DLDeviceType device_type_;
   /*! \brief The device API */
   std::shared_ptr<DeviceAPI> device_;
-
- public:
-  /*! \brief Profile memory usage */
-  static std::atomic<long> current_memory_usage_;
-  static std::atomic<long> max_memory_usage_;
-  static bool mem_prof_on_;
 };
 
 }  // namespace runtime
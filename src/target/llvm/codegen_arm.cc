@@ -130,12 +130,28 @@ PrimExpr CodeGenARM::ARMPopcount(const CallNode *call) {
     call->dtype,  "llvm_intrin", vcnt64_args, CallNode::PureIntrinsic);
 }
 
+// AArch64 code generator, which gathers with SVE.
+class CodeGenAArch64 final : public CodeGenCPU {
+ protected:
+  bool UseVectorGather(const DataType& t) const final {
+    // ld1w/ld1d gathers, used for fixed length vectors when the SVE
+    // registers are known to be wide enough to hold them.
+    return (t.bits() == 32 || t.bits() == 64) && TargetHasFeature(*target_machine_, "sve");
+  }
+};
+
 TVM_REGISTER_GLOBAL("tvm.codegen.llvm.target_arm")
 .set_body([](const TVMArgs& targs, TVMRetValue* rv) {
     CodeGenLLVM* cg = new CodeGenARM();
     *rv = static_cast<void*>(cg);
   });
 
+TVM_REGISTER_GLOBAL("tvm.codegen.llvm.target_aarch64")
+.set_body([](const TVMArgs& targs, TVMRetValue* rv) {
+    CodeGenLLVM* cg = new CodeGenAArch64();
+    *rv = static_cast<void*>(cg);
+  });
+
 }  // namespace codegen
 }  // namespace tvm
 #endif  // TVM_LLVM_VERSION
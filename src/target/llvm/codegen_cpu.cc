@@ -25,8 +25,10 @@
 #include "codegen_cpu.h"
 
 #include <tvm/runtime/c_runtime_api.h>
+#include <tvm/target/target.h>
 #include <tvm/tir/ir_pass.h>
 
+#include <algorithm>
 #include <memory>
 #include <unordered_map>
 
@@ -49,7 +51,8 @@ void CodeGenCPU::Init(const std::string& module_name, llvm::TargetMachine* tm,
                                            t_tvm_shape_index_->getPointerTo(),
                                            t_tvm_shape_index_->getPointerTo(), t_int64_});
   t_tvm_value_ = llvm::StructType::create({t_float64_});
-  t_tvm_parallel_group_env_ = llvm::StructType::create({t_int32_->getPointerTo(), t_int32_});
+  t_tvm_parallel_group_env_ =
+      llvm::StructType::create({t_int32_->getPointerTo(), t_int32_, t_void_p_});
   ftype_tvm_parallel_lambda_ = llvm::FunctionType::get(
       t_int_, {t_int_, t_tvm_parallel_group_env_->getPointerTo(), t_void_p_}, false);
   md_tbaa_ctx_ptr_ = md_builder_->createTBAAScalarTypeNode("ctx_ptr", md_tbaa_root_);
@@ -67,6 +70,11 @@ void CodeGenCPU::Init(const std::string& module_name, llvm::TargetMachine* tm,
       t_int_, {ftype_tvm_parallel_lambda_->getPointerTo(), t_void_p_, t_int_}, false);
   ftype_tvm_parallel_barrier_ =
       llvm::FunctionType::get(t_int_, {t_int_, t_tvm_parallel_group_env_->getPointerTo()}, false);
+  ftype_tvm_parallel_next_chunk_ = llvm::FunctionType::get(
+      t_int_,
+      {t_tvm_parallel_group_env_->getPointerTo(), t_int64_, t_int64_, t_int_,
+       t_int64_->getPointerTo(), t_int64_->getPointerTo()},
+      false);
   ftype_tvm_static_init_callback_ = llvm::FunctionType::get(t_int_, {t_void_p_}, false);
   ftype_tvm_static_init_ =
       llvm::FunctionType::get(t_int_,
@@ -97,6 +105,9 @@ void CodeGenCPU::Init(const std::string& module_name, llvm::TargetMachine* tm,
     f_tvm_parallel_barrier_ =
         llvm::Function::Create(ftype_tvm_parallel_barrier_, llvm::Function::ExternalLinkage,
                                "TVMBackendParallelBarrier", module_.get());
+    f_tvm_parallel_next_chunk_ =
+        llvm::Function::Create(ftype_tvm_parallel_next_chunk_, llvm::Function::ExternalLinkage,
+                               "TVMBackendParallelNextChunk", module_.get());
   }
   this->InitGlobalContext(dynamic_lookup);
 }
@@ -350,6 +361,8 @@ void CodeGenCPU::InitGlobalContext(bool dynamic_lookup) {
           InitContextPtr(ftype_tvm_parallel_launch_->getPointerTo(), "__TVMBackendParallelLaunch");
       gv_tvm_parallel_barrier_ = InitContextPtr(ftype_tvm_parallel_barrier_->getPointerTo(),
                                                 "__TVMBackendParallelBarrier");
+      gv_tvm_parallel_next_chunk_ = InitContextPtr(
+          ftype_tvm_parallel_next_chunk_->getPointerTo(), "__TVMBackendParallelNextChunk");
       // Mark as context functions
       gv_func_map_["TVMBackendAllocWorkspace"] = nullptr;
       gv_func_map_["TVMBackendFreeWorkspace"] = nullptr;
@@ -495,6 +508,31 @@ void CodeGenCPU::CreateParallelLaunch(const Stmt& body, int num_task) {
   builder_->SetInsertPoint(par_launch_end);
 }
 
+void CodeGenCPU::CreateDynamicParallelFor(const ForNode* op, bool guided) {
+  using llvm::BasicBlock;
+  llvm::Value* begin_ptr = WithFunctionEntry([&]() { return builder_->CreateAlloca(t_int64_); });
+  llvm::Value* end_ptr = WithFunctionEntry([&]() { return builder_->CreateAlloca(t_int64_); });
+  DataType t = op->extent.dtype();
+  llvm::Value* extent = CreateCast(t, DataType::Int(64), MakeValue(op->extent));
+  int min_chunk = std::max(BuildConfig::Current()->parallel_min_chunk, 1);
+  BasicBlock* claim_block = BasicBlock::Create(*ctx_, "parallel_claim", function_);
+  BasicBlock* chunk_block = BasicBlock::Create(*ctx_, "parallel_chunk", function_);
+  BasicBlock* end_block = BasicBlock::Create(*ctx_, "parallel_end", function_);
+  builder_->CreateBr(claim_block);
+  builder_->SetInsertPoint(claim_block);
+  llvm::Value* claimed = builder_->CreateCall(
+      RuntimeTVMParallelNextChunk(),
+      {parallel_env_.penv, extent, llvm::ConstantInt::getSigned(t_int64_, min_chunk),
+       ConstInt32(guided ? 1 : 0), begin_ptr, end_ptr});
+  builder_->CreateCondBr(builder_->CreateICmpNE(claimed, ConstInt32(0)), chunk_block, end_block);
+  builder_->SetInsertPoint(chunk_block);
+  llvm::Value* begin = CreateCast(DataType::Int(64), t, builder_->CreateLoad(begin_ptr));
+  llvm::Value* end = CreateCast(DataType::Int(64), t, builder_->CreateLoad(end_ptr));
+  CreateSerialFor(begin, end, MakeValue(make_const(t, 1)), op->loop_var, op->body);
+  builder_->CreateBr(claim_block);
+  builder_->SetInsertPoint(end_block);
+}
+
 llvm::Value* CodeGenCPU::CreateStaticHandle() {
   llvm::GlobalVariable* gv = new llvm::GlobalVariable(
       *module_, t_void_p_, false, llvm::GlobalValue::PrivateLinkage, 0, "__tvm_static_handle");
@@ -688,6 +726,11 @@ llvm::Value* CodeGenCPU::RuntimeTVMParallelBarrier() {
   return GetContextPtr(gv_tvm_parallel_barrier_);
 }
 
+llvm::Value* CodeGenCPU::RuntimeTVMParallelNextChunk() {
+  if (f_tvm_parallel_next_chunk_ != nullptr) return f_tvm_parallel_next_chunk_;
+  return GetContextPtr(gv_tvm_parallel_next_chunk_);
+}
+
 void CodeGenCPU::AddStartupFunction() {
   if (export_system_symbols_.size() != 0) {
     llvm::FunctionType* ftype = llvm::FunctionType::get(t_void_, {}, false);
@@ -794,6 +837,13 @@ void CodeGenCPU::VisitStmt_(const AttrStmtNode* op) {
           << "Pragma parallel_stride_pattern only valid in parallel launch";
       parallel_env_.stride_pattern = true;
       this->VisitStmt(op->body);
+    } else if (op->attr_key == "pragma_parallel_schedule") {
+      const StringImmNode* value = op->value.as<StringImmNode>();
+      CHECK(value != nullptr) << "Pragma parallel_schedule takes a string";
+      std::string parallel_schedule = value->value;
+      std::swap(parallel_schedule_pragma_, parallel_schedule);
+      this->VisitStmt(op->body);
+      std::swap(parallel_schedule_pragma_, parallel_schedule);
     } else if (op->attr_key == "pragma_parallel_launch_point") {
       CreateParallelLaunch(op->body, 0);
     } else if (op->attr_key == "pragma_parallel_barrier_when_finish") {
@@ -839,9 +889,22 @@ void CodeGenCPU::VisitStmt_(const ForNode* op) {
       CHECK(!parallel_env_.in_parallel_loop)
           << "Nested parallel loop is not supported by threadpool, try fuse them instead";
       parallel_env_.in_parallel_loop = true;
+      std::string schedule = parallel_schedule_pragma_.empty()
+                                 ? BuildConfig::Current()->parallel_schedule
+                                 : parallel_schedule_pragma_;
+      CHECK(schedule == "static" || schedule == "dynamic" || schedule == "guided")
+          << "Unknown parallel schedule " << schedule;
+      if (schedule != "static" && parallel_env_.parallel_loop_count != 0) {
+        // The chunks are claimed from a single counter per launch.
+        LOG(WARNING) << "Only the first parallel loop of a launch can be scheduled "
+                     << schedule << ", scheduling " << op->loop_var << " static";
+        schedule = "static";
+      }
       if (parallel_env_.stride_pattern) {
         CreateSerialFor(MakeValue(task_id), MakeValue(op->extent), MakeValue(num_task),
                         op->loop_var, op->body);
+      } else if (schedule != "static") {
+        CreateDynamicParallelFor(op, schedule == "guided");
       } else {
         PrimExpr step = (op->extent + num_task - make_const(t, 1)) / num_task;
         PrimExpr begin = MinNode::make(task_id * step, op->extent);
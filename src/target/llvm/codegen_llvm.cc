@@ -92,6 +92,30 @@ void CodeGenLLVM::InitTarget(llvm::TargetMachine* tm) {
   }
 }
 
+// The flags of fast math arithmetic, which match the unsafe fp math
+// of the target options: NaNs and infinities are still honored.
+static llvm::FastMathFlags GetFastMathFlags(bool fast_math) {
+  llvm::FastMathFlags fmf;
+  if (!fast_math) return fmf;
+#if TVM_LLVM_VERSION >= 60
+  fmf.setAllowReassoc();
+  fmf.setAllowContract(true);
+  fmf.setApproxFunc();
+#else
+  fmf.setUnsafeAlgebra();
+#endif
+  fmf.setAllowReciprocal();
+  fmf.setNoSignedZeros();
+  return fmf;
+}
+
+void CodeGenLLVM::SetOptOptions(int opt_level, bool fast_math) {
+  CHECK(opt_level >= 0 && opt_level <= 3) << "invalid optimization level " << opt_level;
+  opt_level_ = opt_level;
+  fast_math_ = fast_math;
+  builder_->setFastMathFlags(GetFastMathFlags(fast_math));
+}
+
 void CodeGenLLVM::AddFunction(const LoweredFunc& f) { this->AddFunctionInternal(f, false); }
 
 void CodeGenLLVM::InitFuncState() {
@@ -246,15 +270,15 @@ void CodeGenLLVM::Optimize() {
 
   // place optimization pass
   llvm::PassManagerBuilder builder;
-  builder.OptLevel = 3;
+  builder.OptLevel = opt_level_;
 
 #if TVM_LLVM_VERSION >= 50
   builder.Inliner = llvm::createFunctionInliningPass(builder.OptLevel, 0, false);
 #else
   builder.Inliner = llvm::createFunctionInliningPass(builder.OptLevel, 0);
 #endif
-  builder.LoopVectorize = true;
-  builder.SLPVectorize = true;
+  builder.LoopVectorize = opt_level_ > 1;
+  builder.SLPVectorize = opt_level_ > 1;
   this->InitPassManagerBuilder(&builder);
 
 #if TVM_LLVM_VERSION >= 50
@@ -670,6 +694,10 @@ llvm::Value* CodeGenLLVM::CreateIntrinsic(const CallNode* op) {
     return llvm::Constant::getNullValue(t_void_p_);
   } else if (op->is_intrinsic(intrinsic::tvm_handle_is_null)) {
     return builder_->CreateIsNull(MakeValue(op->args[0]));
+  } else if (op->is_intrinsic(intrinsic::tvm_cycle_counter)) {
+    llvm::Function* f =
+        llvm::Intrinsic::getDeclaration(module_.get(), llvm::Intrinsic::readcyclecounter);
+    return builder_->CreateCall(f, {});
   } else if (op->is_intrinsic(intrinsic::tvm_large_uint_imm)) {
     CHECK_EQ(op->args.size(), 2U);
     uint64_t low = static_cast<uint64_t>(Downcast<IntImm>(op->args[0])->value);
@@ -878,6 +906,10 @@ llvm::Value* CodeGenLLVM::VisitExpr_(const SelectNode* op) {
                                 MakeValue(op->false_value));
 }
 
+llvm::Value* CodeGenLLVM::VisitExpr_(const FuseSelectNode* op) {
+  return VisitExpr_(static_cast<const SelectNode*>(op));
+}
+
 llvm::Value* CodeGenLLVM::VisitExpr_(const LetNode* op) {
   CHECK(!var_map_.count(op->var.get()));
   var_map_[op->var.get()] = MakeValue(op->value);
@@ -885,6 +917,24 @@ llvm::Value* CodeGenLLVM::VisitExpr_(const LetNode* op) {
   return MakeValue(op->body);
 }
 
+// The index as a ramp if it is the sum of a ramp and a broadcast, as
+// the vectorized indices of ragged accesses such as a_fun[o] + i are
+// when they are not folded into one ramp.
+static PrimExpr AsRamp(const PrimExpr& index) {
+  if (const AddNode* add = index.as<AddNode>()) {
+    const RampNode* ramp = add->a.as<RampNode>();
+    const BroadcastNode* broadcast = add->b.as<BroadcastNode>();
+    if (ramp == nullptr) {
+      ramp = add->b.as<RampNode>();
+      broadcast = add->a.as<BroadcastNode>();
+    }
+    if (ramp != nullptr && broadcast != nullptr) {
+      return RampNode::make(broadcast->value + ramp->base, ramp->stride, ramp->lanes);
+    }
+  }
+  return index;
+}
+
 llvm::Value* CodeGenLLVM::VisitExpr_(const LoadNode* op) {
   DataType t = op->dtype;
   bool is_volatile = volatile_buf_.count(op->buffer_var.get());
@@ -901,7 +951,8 @@ llvm::Value* CodeGenLLVM::VisitExpr_(const LoadNode* op) {
   } else {
     // vector load
     unsigned addrspace = llvm::dyn_cast<llvm::PointerType>(buffer->getType())->getAddressSpace();
-    if (const RampNode* ramp = op->index.as<RampNode>()) {
+    PrimExpr vindex = AsRamp(op->index);
+    if (const RampNode* ramp = vindex.as<RampNode>()) {
       if (is_one(ramp->stride)) {
         int alignment, native_bits;
         GetAlignment(t, op->buffer_var.get(), ramp->base, &alignment, &native_bits);
@@ -913,6 +964,18 @@ llvm::Value* CodeGenLLVM::VisitExpr_(const LoadNode* op) {
         return load;
       }
     }
+    if (!is_volatile && UseVectorGather(t)) {
+      // gather load, whose masked off lanes are not read.
+      llvm::Value* ptrs = CreateBufferPtr(t.element_of(), buffer, index);
+      llvm::Value* mask = is_one(op->predicate) ? nullptr : MakeValue(op->predicate);
+#if TVM_LLVM_VERSION >= 100
+      llvm::CallInst* load = builder_->CreateMaskedGather(ptrs, llvm::Align(t.bits() / 8), mask);
+#else
+      llvm::CallInst* load = builder_->CreateMaskedGather(ptrs, t.bits() / 8, mask);
+#endif
+      AddAliasInfo(load, op->buffer_var.get(), PrimExpr(), t);
+      return load;
+    }
   }
   // scalarized load.
   int basic_align = t.bits() / 8;
@@ -991,7 +1054,8 @@ void CodeGenLLVM::VisitStmt_(const StoreNode* op) {
   } else {
     // vector store
     unsigned addrspace = llvm::dyn_cast<llvm::PointerType>(buffer->getType())->getAddressSpace();
-    if (const RampNode* ramp = op->index.as<RampNode>()) {
+    PrimExpr vindex = AsRamp(op->index);
+    if (const RampNode* ramp = vindex.as<RampNode>()) {
       if (is_one(ramp->stride)) {
         int alignment, native_bits;
         GetAlignment(t, op->buffer_var.get(), ramp->base, &alignment, &native_bits);
@@ -1033,9 +1097,15 @@ void CodeGenLLVM::VisitStmt_(const IfThenElseNode* op) {
   llvm::Value* cond = MakeValue(op->condition);
   BasicBlock* then_block = BasicBlock::Create(*ctx_, "if_then", function_);
   BasicBlock* end_block = BasicBlock::Create(*ctx_, "if_end", function_);
+  llvm::MDNode* branch_weights = nullptr;
+  auto it = branch_probability_.find(op);
+  if (it != branch_probability_.end()) {
+    uint32_t taken = static_cast<uint32_t>(it->second * (1 << 20));
+    branch_weights = md_builder_->createBranchWeights(taken, (1 << 20) - taken);
+  }
   if (op->else_case.defined()) {
     BasicBlock* else_block = BasicBlock::Create(*ctx_, "if_else", function_);
-    builder_->CreateCondBr(cond, then_block, else_block);
+    builder_->CreateCondBr(cond, then_block, else_block, branch_weights);
     builder_->SetInsertPoint(then_block);
     this->VisitStmt(op->then_case);
     builder_->CreateBr(end_block);
@@ -1043,7 +1113,8 @@ void CodeGenLLVM::VisitStmt_(const IfThenElseNode* op) {
     this->VisitStmt(op->else_case);
     builder_->CreateBr(end_block);
   } else {
-    builder_->CreateCondBr(cond, then_block, end_block, md_very_likely_branch_);
+    builder_->CreateCondBr(cond, then_block, end_block,
+                           branch_weights ? branch_weights : md_very_likely_branch_);
     builder_->SetInsertPoint(then_block);
     this->VisitStmt(op->then_case);
     builder_->CreateBr(end_block);
@@ -1109,6 +1180,16 @@ void CodeGenLLVM::VisitStmt_(const AttrStmtNode* op) {
     const VarNode* v = op->node.as<VarNode>();
     CHECK(v);
     volatile_buf_.insert(v);
+  } else if (op->attr_key == tir::attr::branch_probability) {
+    branch_probability_[op->body.get()] = op->value.as<FloatImmNode>()->value;
+  } else if (op->attr_key == "pragma_fast_math") {
+    // Whether the arithmetic of the region is fast math, overriding
+    // the default of the module.
+    llvm::FastMathFlags saved = builder_->getFastMathFlags();
+    builder_->setFastMathFlags(GetFastMathFlags(!is_zero(op->value)));
+    this->VisitStmt(op->body);
+    builder_->setFastMathFlags(saved);
+    return;
   }
   this->VisitStmt(op->body);
 }
@@ -74,6 +74,13 @@ class CodeGenLLVM :
                     llvm::LLVMContext* ctx,
                     bool system_lib,
                     bool dynamic_lookup);
+  /*!
+   * \brief Set the optimization options of the module.
+   * \param opt_level The optimization level of the IR passes.
+   * \param fast_math Whether floating point arithmetic is marked as fast
+   *  math in the IR, outside of the regions of fast math pragmas.
+   */
+  void SetOptOptions(int opt_level, bool fast_math);
   /*!
    * \brief Compile and add function f to the current module.
    * \param f The function to be added.
@@ -129,6 +136,7 @@ class CodeGenLLVM :
   llvm::Value* VisitExpr_(const OrNode* op) override;
   llvm::Value* VisitExpr_(const NotNode* op) override;
   llvm::Value* VisitExpr_(const SelectNode* op) override;
+  llvm::Value* VisitExpr_(const FuseSelectNode* op) override;
   llvm::Value* VisitExpr_(const LetNode* op) override;
   llvm::Value* VisitExpr_(const LoadNode* op) override;
   llvm::Value* VisitExpr_(const CallNode* op) override;
@@ -199,6 +207,9 @@ class CodeGenLLVM :
   virtual int NativeVectorBits(const runtime::StorageScope& storage_scope) const;
   // Get correct address space depending on the backend
   virtual unsigned GetGlobalAddressSpace();
+  // Whether vector loads of type t at non contiguous indices are
+  // emitted as masked gathers rather than as scalar loads.
+  virtual bool UseVectorGather(const DataType& t) const { return false; }
 
   void AddFunctionInternal(const LoweredFunc& f, bool ret_void);
   // Create extern call
@@ -276,10 +287,16 @@ class CodeGenLLVM :
   llvm::Type* t_float64_{nullptr};
   // meta data
   llvm::MDNode* md_very_likely_branch_{nullptr};
+  // The profiled probabilities of the conditions of branches.
+  std::unordered_map<const Object*, double> branch_probability_;
   llvm::MDNode* md_tbaa_root_{nullptr};
   llvm::MDNode* md_tbaa_alias_set_{nullptr};
   // modules to be linked.
   std::vector<std::unique_ptr<llvm::Module> > link_modules_;
+  // The optimization level of the IR passes.
+  int opt_level_{3};
+  // Whether floating point arithmetic is marked as fast math by default.
+  bool fast_math_{false};
   /*! \brief native vector bits of current targetx*/
   int native_vector_bits_{0};
   /*! \brief the storage scope of allocation */
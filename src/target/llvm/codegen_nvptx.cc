@@ -24,6 +24,8 @@
 #ifdef TVM_LLVM_VERSION
 
 #include <tvm/runtime/device_api.h>
+#include <string>
+#include <vector>
 #include "codegen_llvm.h"
 #include "../build_common.h"
 #include "../../runtime/cuda/cuda_module.h"
@@ -43,6 +45,8 @@ class CodeGenNVPTX : public CodeGenLLVM {
               llvm::ValueAsMetadata::get(function_),
               llvm::MDString::get(*ctx_, "kernel"),
               llvm::ValueAsMetadata::get(ConstInt32(1)) }));
+    // flush f32 denormals to zero along with fast math, as nvcc does
+    function_->addFnAttr("nvptx-f32ftz", fast_math_ ? "true" : "false");
   }
 
   void VisitStmt_(const AllocateNode* op) final {
@@ -131,8 +135,14 @@ class CodeGenNVPTX : public CodeGenLLVM {
   llvm::Value* CreateStorageSync(const CallNode* op) final {
     const std::string& sync = op->args[0].as<StringImmNode>()->value;
     if (sync == "warp") {
-      // TODO(tqchen) warp sync in CUDA9
+#if TVM_LLVM_VERSION >= 60
+      llvm::Function* f = llvm::Intrinsic::getDeclaration(
+          module_.get(),
+          ::llvm::Intrinsic::nvvm_bar_warp_sync);
+      return builder_->CreateCall(f, {ConstInt32(-1)});
+#else
       return nullptr;
+#endif
     } else if (sync == "shared") {
       llvm::Function* f = llvm::Intrinsic::getDeclaration(
           module_.get(),
@@ -144,11 +154,48 @@ class CodeGenNVPTX : public CodeGenLLVM {
     }
   }
 
+  llvm::Value* CreateIntrinsic(const CallNode* op) final {
+    // The memory intrinsics of the ragged kernels are emitted as inline
+    // PTX, the same as in the CUDA source.
+    if (op->is_intrinsic(intrinsic::tvm_cp_async)) {
+      CHECK_EQ(op->args.size(), 3U);
+      auto bytes = op->args[2].as<IntImmNode>();
+      CHECK(bytes && (bytes->value == 4 || bytes->value == 8 || bytes->value == 16));
+      llvm::Value* dst = MakeValue(op->args[0]);
+      if (dst->getType()->getPointerAddressSpace() != kSharedAddressSpace) {
+        dst = builder_->CreateAddrSpaceCast(dst, t_char_->getPointerTo(kSharedAddressSpace));
+      }
+      llvm::Value* src = MakeValue(op->args[1]);
+      // Copies of 16 bytes can bypass L1.
+      std::string cache = bytes->value == 16 ? "cg" : "ca";
+      return CreateInlinePTX("cp.async." + cache + ".shared.global [$0], [$1], " +
+                                 std::to_string(bytes->value) + ";",
+                             "r,l", {builder_->CreatePtrToInt(dst, t_int32_),
+                                     builder_->CreatePtrToInt(src, t_int64_)});
+    } else if (op->is_intrinsic(intrinsic::tvm_cp_async_commit_group)) {
+      return CreateInlinePTX("cp.async.commit_group;", "", {});
+    } else if (op->is_intrinsic(intrinsic::tvm_cp_async_wait_group)) {
+      CHECK_EQ(op->args.size(), 1U);
+      auto num_pending = op->args[0].as<IntImmNode>();
+      CHECK(num_pending);
+      return CreateInlinePTX("cp.async.wait_group " + std::to_string(num_pending->value) + ";",
+                             "", {});
+    } else if (op->is_intrinsic(CallNode::prefetch)) {
+      CHECK_EQ(op->args.size(), 4U);
+      llvm::Value* addr = MakeValue(op->args[0]);
+      return CreateInlinePTX("prefetch.global.L2 [$0];", "l",
+                             {builder_->CreatePtrToInt(addr, t_int64_)});
+    }
+    return CodeGenLLVM::CreateIntrinsic(op);
+  }
+
   void InitPassManagerBuilder(llvm::PassManagerBuilder* builder) final {
     // Additional optimization hook to tweak the builder.
   }
 
   void Optimize() final {
+    // select the ftz variants of the libdevice functions by NVVMReflect
+    module_->addModuleFlag(llvm::Module::Override, "nvvm-reflect-ftz", fast_math_ ? 1 : 0);
     for (auto& f : *module_) {
       auto fname = static_cast<std::string>(f.getName());
       if (fname.substr(0, 4) != "__nv") continue;
@@ -168,6 +215,25 @@ class CodeGenNVPTX : public CodeGenLLVM {
     native_vector_bits_ = 4 * 32;
     CodeGenLLVM::InitTarget(tm);
   }
+
+ private:
+  // Shared memory: address space  == 3
+  static constexpr unsigned kSharedAddressSpace = 3;
+
+  // Emit a volatile inline PTX statement with the operands args.
+  llvm::Value* CreateInlinePTX(const std::string& ptx, const std::string& constraints,
+                               const std::vector<llvm::Value*>& args) {
+    std::vector<llvm::Type*> arg_types;
+    for (llvm::Value* arg : args) arg_types.push_back(arg->getType());
+    llvm::FunctionType* ftype = llvm::FunctionType::get(t_void_, arg_types, false);
+    std::string clobbers = constraints.empty() ? "~{memory}" : constraints + ",~{memory}";
+    llvm::InlineAsm* asm_ptx = llvm::InlineAsm::get(ftype, ptx, clobbers, true);
+#if TVM_LLVM_VERSION >= 90
+    return builder_->CreateCall(ftype, asm_ptx, args);
+#else
+    return builder_->CreateCall(asm_ptx, args);
+#endif
+  }
 };
 
 inline int DetectCUDAComputeVersion() {
@@ -203,6 +269,7 @@ runtime::Module BuildNVPTX(Array<LoweredFunc> funcs, std::string target) {
   std::unique_ptr<CodeGenNVPTX> cg(new CodeGenNVPTX());
   std::unique_ptr<llvm::LLVMContext> ctx(new llvm::LLVMContext());
   cg->Init(funcs[0]->name, tm.get(), ctx.get(), false, false);
+  cg->SetOptOptions(GetLLVMOptLevel(target), GetLLVMTargetOption(target, "-fast-math") == "1");
   for (LoweredFunc f :  funcs) {
     cg->AddFunction(f);
   }
@@ -28,6 +28,8 @@
 #include <memory>
 #include "llvm_common.h"
 
+#include "llvm/MC/MCSubtargetInfo.h"
+
 namespace tvm {
 namespace codegen {
 
@@ -108,7 +110,8 @@ void ParseLLVMTargetOptions(const std::string& target_str,
       } else {
         LOG(FATAL) << "invalid -mfloat-abi option " << value;
       }
-    } else if (key == "-device" || key == "-libs" || key == "-model") {
+    } else if (key == "-device" || key == "-libs" || key == "-model" ||
+               key == "-opt-level" || key == "-fast-math") {
       // pass
     } else {
       LOG(FATAL) << "unknown option " << key;
@@ -130,7 +133,7 @@ void ParseLLVMTargetOptions(const std::string& target_str,
   // opt.NoInfsFPMath = false;
   // opt.NoNaNsFPMath = true;
 
-  opt.UnsafeFPMath = true;
+  opt.UnsafeFPMath = GetLLVMTargetOption(target_str, "-fast-math", "1") != "0";
   opt.NoInfsFPMath = false;
   opt.NoNaNsFPMath = false;
   if (soft_float_abi) {
@@ -140,6 +143,28 @@ void ParseLLVMTargetOptions(const std::string& target_str,
   }
 }
 
+std::string GetLLVMTargetOption(const std::string& target_str, const std::string& key,
+                                const std::string& default_value) {
+  std::string token, value = default_value;
+  std::istringstream is(target_str);
+  while (is >> token) {
+    size_t pos = token.find('=');
+    if (token.substr(0, pos) != key) continue;
+    if (pos != std::string::npos) {
+      value = token.substr(pos + 1);
+    } else {
+      CHECK(is >> value) << "Unspecified value for option " << key;
+    }
+  }
+  return value;
+}
+
+int GetLLVMOptLevel(const std::string& target_str) {
+  std::string value = GetLLVMTargetOption(target_str, "-opt-level", "3");
+  CHECK(value.length() == 1 && value[0] >= '0' && value[0] <= '3')
+      << "invalid -opt-level option " << value;
+  return value[0] - '0';
+}
 
 std::unique_ptr<llvm::TargetMachine>
 GetLLVMTargetMachine(const std::string& target_str,
@@ -168,11 +193,54 @@ GetLLVMTargetMachine(const std::string& target_str,
     CHECK(allow_null) << err << " target_triple=" << target_triple;
     return nullptr;
   }
+  // The default level of the backend, used unless one is requested.
+  llvm::CodeGenOpt::Level opt_level = llvm::CodeGenOpt::Default;
+  if (GetLLVMTargetOption(target_str, "-opt-level").length() != 0) {
+    const llvm::CodeGenOpt::Level levels[] = {llvm::CodeGenOpt::None, llvm::CodeGenOpt::Less,
+                                              llvm::CodeGenOpt::Default,
+                                              llvm::CodeGenOpt::Aggressive};
+    opt_level = levels[GetLLVMOptLevel(target_str)];
+  }
+#if TVM_LLVM_VERSION >= 60
   llvm::TargetMachine* tm = target->createTargetMachine(
-      target_triple, mcpu, mattr, opt, llvm::Reloc::PIC_);
+      target_triple, mcpu, mattr, opt, llvm::Reloc::PIC_, llvm::None, opt_level);
+#else
+  llvm::TargetMachine* tm = target->createTargetMachine(
+      target_triple, mcpu, mattr, opt, llvm::Reloc::PIC_, llvm::CodeModel::Default, opt_level);
+#endif
   return std::unique_ptr<llvm::TargetMachine>(tm);
 }
 
+bool TargetHasFeature(const llvm::TargetMachine& tm, const std::string& feature) {
+  // MCSubTargetInfo::checkFeatures was added in LLVM 6.0
+#if TVM_LLVM_VERSION >= 60
+  const auto* MCInfo = tm.getMCSubtargetInfo();
+  return MCInfo->checkFeatures(std::string("+") + feature);
+#else
+  return false;
+  // TODO(tulloch) - enable this block, need to figure out how to reimplement
+  // this given visibility constraints, similar to
+  // https://github.com/rust-lang/rust/pull/31709
+
+  // Copied from
+  // https://github.com/llvm-mirror/llvm/blob/5136df4/lib/MC/MCSubtargetInfo.cpp#L78-L88.
+
+  // auto checkFeatures = [&](const std::string FS) {
+  //   llvm::SubtargetFeatures T(FS);
+  //   llvm::FeatureBitset Set, All;
+  //   for (std::string F : T.getFeatures()) {
+  //     llvm::SubtargetFeatures::ApplyFeatureFlag(Set, F, MCInfo->ProcFeatures);
+  //     if (F[0] == '-') {
+  //       F[0] = '+';
+  //     }
+  //     llvm::SubtargetFeatures::ApplyFeatureFlag(All, F, MCInfo->ProcFeatures);
+  //   }
+  //   return (MCInfo->getFeatureBits() & All) == Set;
+  // };
+  // return checkFeatures(MCInfo, std::string("+") + feature);
+#endif
+}
+
 }  // namespace codegen
 }  // namespace tvm
 #endif  // TVM_LLVM_VERSION
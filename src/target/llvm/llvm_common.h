@@ -46,6 +46,7 @@
 #include <llvm/IR/DIBuilder.h>
 #include <llvm/IR/Function.h>
 #include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/InlineAsm.h>
 #include <llvm/IR/Instructions.h>
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
@@ -102,6 +103,24 @@ void ParseLLVMTargetOptions(const std::string& target_str,
                             std::string* mattr,
                             llvm::TargetOptions* options);
 
+/*!
+ * \brief Get the value of an option of a target string.
+ * \param target_str Target string, in format "llvm -target=xxx -mcpu=xxx"
+ * \param key The option, such as "-opt-level".
+ * \param default_value The value if the option is not set.
+ * \return The value of the option.
+ */
+std::string GetLLVMTargetOption(const std::string& target_str, const std::string& key,
+                                const std::string& default_value = "");
+
+/*!
+ * \brief Get the optimization level of a target string, set by
+ *  "-opt-level=<0-3>" and 3 by default.
+ * \param target_str Target string, in format "llvm -target=xxx -mcpu=xxx"
+ * \return The optimization level.
+ */
+int GetLLVMOptLevel(const std::string& target_str);
+
 /*!
  * \brief Get target machine from target_str string.
  * \param target_str Target string, in format "llvm -target=xxx -mcpu=xxx"
@@ -111,6 +130,14 @@ void ParseLLVMTargetOptions(const std::string& target_str,
 std::unique_ptr<llvm::TargetMachine>
 GetLLVMTargetMachine(const std::string& target_str, bool allow_null = false);
 
+/*!
+ * \brief Whether the subtarget of a target machine has a feature.
+ * \param tm The target machine.
+ * \param feature The feature, such as "avx512f".
+ * \return Whether the feature is enabled.
+ */
+bool TargetHasFeature(const llvm::TargetMachine& tm, const std::string& feature);
+
 }  // namespace codegen
 }  // namespace tvm
 #endif  // TVM_LLVM_VERSION
@@ -26,7 +26,13 @@
 #include <tvm/runtime/packed_func.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/target/codegen.h>
+#include <tvm/target/target.h>
+#include <algorithm>
+#include <exception>
 #include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 #include "llvm_common.h"
 #include "codegen_llvm.h"
 #include "codegen_blob.h"
@@ -70,6 +76,13 @@ class LLVMModuleNode final : public runtime::ModuleNode {
       });
     }
     if (ee_ == nullptr) LazyInitJIT();
+    if (name == runtime::symbol::tvm_get_fast_call) {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        std::string fname = args[0].operator std::string() + runtime::symbol::tvm_fast_call_suffix;
+        std::lock_guard<std::mutex> lock(mutex_);
+        *rv = reinterpret_cast<void*>(GetFunctionAddr(fname));
+      });
+    }
     std::lock_guard<std::mutex> lock(mutex_);
     const std::string& fname = (name == runtime::symbol::tvm_module_main ?
                                 entry_func_ : name);
@@ -198,14 +211,15 @@ class LLVMModuleNode final : public runtime::ModuleNode {
     bool system_lib = (target.find("-system-lib") != std::string::npos);
     CHECK_NE(funcs.size(), 0U);
     ctx_ = std::make_shared<llvm::LLVMContext>();
-    std::unique_ptr<CodeGenLLVM> cg = CodeGenLLVM::Create(tm_.get());
     entry_func_ = funcs[0]->name;
-    cg->Init(funcs[0]->name, tm_.get(), ctx_.get(), system_lib, system_lib);
-    for (LoweredFunc f :  funcs) {
-      cg->AddFunction(f);
+    std::vector<LoweredFunc> all_funcs(funcs.begin(), funcs.end());
+    int num_parts = std::min<int>(BuildConfig::Current()->llvm_codegen_threads,
+                                  all_funcs.size() / kMinPartFunctions);
+    if (num_parts > 1) {
+      module_ = BuildParallel(all_funcs, target, system_lib, num_parts);
+    } else {
+      module_ = BuildPart(all_funcs, target, tm_.get(), ctx_.get(), system_lib, entry_func_);
     }
-    cg->AddMainFunction(funcs[0]->name);
-    module_ = cg->Finish();
 
     module_->addModuleFlag(llvm::Module::Warning, "tvm_target", llvm::MDString::get(*ctx_, target));
     module_->addModuleFlag(llvm::Module::Override, "Debug Info Version",
@@ -264,6 +278,87 @@ class LLVMModuleNode final : public runtime::ModuleNode {
   }
 
  private:
+  // The least number of functions of a part of a module generated in
+  // parallel. Smaller modules are generated on one thread.
+  static constexpr size_t kMinPartFunctions = 8;
+
+  // Generates and optimizes funcs into a module of ctx, along with the
+  // main function entry_func if it is not empty.
+  static std::unique_ptr<llvm::Module> BuildPart(const std::vector<LoweredFunc>& funcs,
+                                                 const std::string& target,
+                                                 llvm::TargetMachine* tm, llvm::LLVMContext* ctx,
+                                                 bool system_lib, const std::string& entry_func) {
+    std::unique_ptr<CodeGenLLVM> cg = CodeGenLLVM::Create(tm);
+    cg->Init(funcs[0]->name, tm, ctx, system_lib, system_lib);
+    cg->SetOptOptions(GetLLVMOptLevel(target), GetLLVMTargetOption(target, "-fast-math") == "1");
+    for (LoweredFunc f : funcs) {
+      cg->AddFunction(f);
+    }
+    if (!entry_func.empty()) cg->AddMainFunction(entry_func);
+    return cg->Finish();
+  }
+
+  // Generates and optimizes funcs as num_parts modules on as many
+  // threads, and links them into a module of ctx_. LLVM contexts may
+  // not be shared by threads, so each part is built in its own context
+  // and moved to ctx_ as bitcode. The runtime globals of the parts are
+  // linkonce, and are merged by the linker.
+  std::unique_ptr<llvm::Module> BuildParallel(const std::vector<LoweredFunc>& funcs,
+                                              const std::string& target, bool system_lib,
+                                              int num_parts) {
+    size_t part_size = (funcs.size() + num_parts - 1) / num_parts;
+    num_parts = (funcs.size() + part_size - 1) / part_size;
+    std::vector<std::string> bitcodes(num_parts);
+    std::vector<std::exception_ptr> errors(num_parts);
+    auto worker = [&](int i) {
+      try {
+        std::unique_ptr<llvm::TargetMachine> tm = GetLLVMTargetMachine(target);
+        llvm::LLVMContext ctx;
+        auto begin = funcs.begin() + i * part_size;
+        std::vector<LoweredFunc> part(begin, funcs.begin() + std::min(funcs.size(),
+                                                                      (i + 1) * part_size));
+        std::unique_ptr<llvm::Module> module =
+            BuildPart(part, target, tm.get(), &ctx, system_lib, i == 0 ? entry_func_ : "");
+        llvm::raw_string_ostream os(bitcodes[i]);
+#if TVM_LLVM_VERSION <= 60
+        llvm::WriteBitcodeToFile(module.get(), os);
+#else
+        llvm::WriteBitcodeToFile(*module, os);
+#endif
+        os.flush();
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    };
+    std::vector<std::thread> threads;
+    for (int i = 1; i < num_parts; ++i) {
+      threads.emplace_back(worker, i);
+    }
+    worker(0);
+    for (auto& thread : threads) thread.join();
+    // Report errors as if the parts had been built in order.
+    for (auto& error : errors) {
+      if (error) std::rethrow_exception(error);
+    }
+
+    std::unique_ptr<llvm::Module> ret;
+    for (const std::string& bitcode : bitcodes) {
+      llvm::SMDiagnostic err;
+      std::unique_ptr<llvm::MemoryBuffer> buf =
+          llvm::MemoryBuffer::getMemBuffer(bitcode, entry_func_, false);
+      std::unique_ptr<llvm::Module> part = llvm::parseIR(*buf, err, *ctx_);
+      CHECK(part != nullptr) << "Fail to load the bitcode of a part of the module: "
+                             << std::string(err.getMessage());
+      if (ret == nullptr) {
+        ret = std::move(part);
+      } else {
+        CHECK(!llvm::Linker::linkModules(*ret, std::move(part)))
+            << "Failed to link the parts of the module";
+      }
+    }
+    return ret;
+  }
+
   void LazyInitJIT() {
     std::lock_guard<std::mutex> lock(mutex_);
     if (ee_) {
@@ -28,11 +28,23 @@
 #endif
 #include <cuda_runtime.h>
 #include <nvrtc.h>
+#include <tvm/target/target.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <cstdio>
 #include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "../../runtime/cuda/cuda_common.h"
 #include "../../runtime/cuda/cuda_module.h"
+#include "../../runtime/file_util.h"
 #include "../build_common.h"
 #include "../source/codegen_cuda.h"
 
@@ -74,11 +86,10 @@ std::string FindCUDAIncludePath() {
   return cuda_include_path;
 }
 
-std::string NVRTCCompile(const std::string& code, bool include_path = false) {
-  // std::cout << "[NVRTC] Compiling\n " << code << std::endl;
+// The NVRTC options of the code of a module, which are read on the
+// thread that builds it, as the build config is per thread.
+std::vector<std::string> NVRTCOptions(bool include_path) {
   std::vector<std::string> compile_params;
-  std::vector<const char*> param_cstrings{};
-  nvrtcProgram prog;
   std::string cc = "52";
   int major, minor;
   cudaError_t e1 = cudaDeviceGetAttribute(&major, cudaDevAttrComputeCapabilityMajor, 0);
@@ -97,15 +108,47 @@ std::string NVRTCCompile(const std::string& code, bool include_path = false) {
 
   compile_params.push_back("-arch=compute_" + cc);
 
+  // Capping the registers gives ragged kernels the occupancy to hide
+  // the latency of their indirect loads.
+  int max_registers = BuildConfig::Current()->cuda_max_registers;
+  if (max_registers > 0) {
+    compile_params.push_back("--maxrregcount=" + std::to_string(max_registers));
+  }
+
   if (include_path) {
     std::string include_option = "--include-path=" + FindCUDAIncludePath();
 
     compile_params.push_back(include_option);
   }
+  return compile_params;
+}
+
+// Compiles code to PTX with NVRTC, which is thread safe. With
+// TVM_CUDA_KERNEL_CACHE set to 1, the PTX is kept in the nvrtc
+// directory of the TVM cache directory, keyed by the hash of the code
+// and the options.
+std::string NVRTCCompile(const std::string& code, const std::vector<std::string>& compile_params) {
+  std::string cache_file;
+  std::string cache_dir = runtime::CUDAKernelCacheDir("nvrtc");
+  if (!cache_dir.empty()) {
+    std::string key = code;
+    for (const auto& param : compile_params) key += "\n" + param;
+    std::ostringstream os;
+    os << cache_dir << "/" << std::hex << runtime::StableHash(key) << std::dec << "_"
+       << key.size() << ".ptx";
+    cache_file = os.str();
+    std::ifstream fs(cache_file, std::ios::in | std::ios::binary);
+    if (!fs.fail()) {
+      std::string ptx((std::istreambuf_iterator<char>(fs)), std::istreambuf_iterator<char>());
+      if (!ptx.empty()) return ptx;
+    }
+  }
 
+  std::vector<const char*> param_cstrings{};
   for (const auto& string : compile_params) {
     param_cstrings.push_back(string.c_str());
   }
+  nvrtcProgram prog;
   NVRTC_CALL(nvrtcCreateProgram(&prog, code.c_str(), nullptr, 0, nullptr, nullptr));
   nvrtcResult compile_res = nvrtcCompileProgram(prog, param_cstrings.size(), param_cstrings.data());
 
@@ -123,9 +166,83 @@ std::string NVRTCCompile(const std::string& code, bool include_path = false) {
   NVRTC_CALL(nvrtcGetPTX(prog, &ptx[0]));
   NVRTC_CALL(nvrtcDestroyProgram(&prog));
 
+  if (!cache_file.empty()) {
+    // Written to a temporary file first, so that concurrent builds
+    // never read a partial PTX.
+    std::string tmp_file = cache_file + ".tmp" + std::to_string(getpid()) + "_" +
+                           std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    std::ofstream fs(tmp_file, std::ios::out | std::ios::binary);
+    fs.write(ptx.data(), ptx.size());
+    fs.close();
+    if (fs.fail() || rename(tmp_file.c_str(), cache_file.c_str()) != 0) {
+      remove(tmp_file.c_str());
+    }
+  }
   return ptx;
 }
 
+// Generates the code of each of parts of funcs as a separate
+// translation unit, and compiles the units on as many threads, as
+// compiling a module of many kernels at once takes long. The PTX of
+// the units is joined by null characters, see CUDAModuleCreate.
+// Returns false if the compile callback gives anything but PTX, in
+// which case the module is compiled as a whole.
+bool BuildCUDAParallel(const std::vector<LoweredFunc>& funcs, int num_parts, std::string* ptx) {
+  using tvm::runtime::Registry;
+  size_t part_size = (funcs.size() + num_parts - 1) / num_parts;
+  num_parts = (funcs.size() + part_size - 1) / part_size;
+  std::vector<std::string> codes(num_parts);
+  bool include_path = false;
+  for (int i = 0; i < num_parts; ++i) {
+    CodeGenCUDA cg;
+    cg.Init(false);
+    for (size_t j = i * part_size; j < std::min(funcs.size(), (i + 1) * part_size); ++j) {
+      cg.AddFunction(funcs[j]);
+    }
+    codes[i] = cg.Finish();
+    include_path |= cg.need_include_path();
+    if (const auto* f = Registry::Get("tvm_callback_cuda_postproc")) {
+      codes[i] = (*f)(codes[i]).operator std::string();
+    }
+  }
+  const auto* compile = Registry::Get("tvm_callback_cuda_compile");
+  std::vector<std::string> options;
+  if (compile == nullptr) options = NVRTCOptions(include_path);
+
+  std::vector<std::string> ptxs(num_parts);
+  std::vector<std::exception_ptr> errors(num_parts);
+  auto worker = [&](int i) {
+    try {
+      if (compile != nullptr) {
+        ptxs[i] = (*compile)(codes[i]).operator std::string();
+      } else {
+        ptxs[i] = NVRTCCompile(codes[i], options);
+      }
+    } catch (...) {
+      errors[i] = std::current_exception();
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 1; i < num_parts; ++i) {
+    threads.emplace_back(worker, i);
+  }
+  worker(0);
+  for (auto& thread : threads) thread.join();
+  // Report errors as if the parts had been compiled in order.
+  for (auto& error : errors) {
+    if (error) std::rethrow_exception(error);
+  }
+
+  ptx->clear();
+  for (const std::string& part : ptxs) {
+    // Dirty matching to check PTX vs cubin, as in BuildCUDA.
+    if (part.empty() || part[0] != '/') return false;
+    ptx->append(part.c_str());
+    ptx->push_back('\0');
+  }
+  return true;
+}
+
 runtime::Module BuildCUDA(Array<LoweredFunc> funcs) {
   using tvm::runtime::Registry;
   bool output_ssa = false;
@@ -142,13 +259,18 @@ runtime::Module BuildCUDA(Array<LoweredFunc> funcs) {
   }
   std::string fmt = "ptx";
   std::string ptx;
+  int num_parts = std::min<int>(BuildConfig::Current()->cuda_compile_threads, funcs.size());
+  if (num_parts > 1 &&
+      BuildCUDAParallel(std::vector<LoweredFunc>(funcs.begin(), funcs.end()), num_parts, &ptx)) {
+    return CUDAModuleCreate(ptx, fmt, ExtractFuncInfo(funcs), code);
+  }
   if (const auto* f = Registry::Get("tvm_callback_cuda_compile")) {
     ptx = (*f)(code).operator std::string();
     // Dirty matching to check PTX vs cubin.
     // TODO(tqchen) more reliable checks
     if (ptx[0] != '/') fmt = "cubin";
   } else {
-    ptx = NVRTCCompile(code, cg.need_include_path());
+    ptx = NVRTCCompile(code, NVRTCOptions(cg.need_include_path()));
   }
   return CUDAModuleCreate(ptx, fmt, ExtractFuncInfo(funcs), code);
 }
@@ -40,6 +40,7 @@ void CodeGenC::Init(bool output_ssa) { print_ssa_form_ = output_ssa; }
 void CodeGenC::InitFuncState(LoweredFunc f) {
   alloc_storage_scope_.clear();
   handle_data_type_.clear();
+  read_only_args_.clear();
   CodeGenSourceBase::ClearFuncState();
   current_func_ = f;
 }
@@ -95,6 +96,7 @@ void CodeGenC::AddFunction(LoweredFunc f) {
       if (it != alloc_storage_scope_.end()) PrintStorageScope(it->second, stream);
       stream << ' ';
 
+      if (read_only_args_.count(v.get())) stream << "const ";
       if (handle_data_type_.count(v.get())) {
         PrintType(handle_data_type_.at(v.get()), stream);
       } else {
@@ -601,6 +603,15 @@ void CodeGenC::VisitExpr_(const CallNode* op, std::ostream& os) {  // NOLINT(*)
     os << " *)(&(";
     this->PrintExpr(op->args[0], os);
     os << ")))";
+  } else if (op->is_intrinsic(CallNode::prefetch)) {
+    CHECK_EQ(op->args.size(), 4U);
+    os << "__builtin_prefetch(";
+    this->PrintExpr(op->args[0], os);
+    os << ", ";
+    this->PrintExpr(op->args[1], os);
+    os << ", ";
+    this->PrintExpr(op->args[2], os);
+    os << ")";
   } else if (op->is_intrinsic(CallNode::isnan)) {
     os << "(";
     this->PrintExpr(op->args[0], os);
@@ -778,6 +789,10 @@ void CodeGenC::VisitExpr_(const SelectNode* op, std::ostream& os) {  // NOLINT(*
   os << ")";
 }
 
+void CodeGenC::VisitExpr_(const FuseSelectNode* op, std::ostream& os) {  // NOLINT(*)
+  VisitExpr_(static_cast<const SelectNode*>(op), os);
+}
+
 void CodeGenC::VisitStmt_(const LetStmtNode* op) {
   std::string value = PrintExpr(op->value);
   if (print_ssa_form_) {
@@ -839,6 +854,8 @@ void CodeGenC::VisitStmt_(const AttrStmtNode* op) {
     const VarNode* v = op->node.as<VarNode>();
     CHECK(v);
     volatile_buf_.insert(v);
+  } else if (op->attr_key == tir::attr::branch_probability) {
+    branch_probability_[op->body.get()] = op->value.as<FloatImmNode>()->value;
   }
   this->PrintStmt(op->body);
 }
@@ -872,6 +889,8 @@ void CodeGenC::VisitStmt_(const ForNode* op) {
 
 void CodeGenC::VisitStmt_(const IfThenElseNode* op) {
   std::string cond = PrintExpr(op->condition);
+  auto it = branch_probability_.find(op);
+  if (it != branch_probability_.end()) cond = PrintBranchCondition(cond, it->second);
   PrintIndent();
   if (cond[0] == '(' && cond[cond.length() - 1] == ')') {
     stream << "if " << cond << " {\n";
@@ -125,6 +125,7 @@ class CodeGenC :
   void VisitExpr_(const CastNode* op, std::ostream& os) override;  // NOLINT(*)
   void VisitExpr_(const NotNode* op, std::ostream& os) override;  // NOLINT(*)
   void VisitExpr_(const SelectNode* op, std::ostream& os) override;  // NOLINT(*)
+  void VisitExpr_(const FuseSelectNode* op, std::ostream& os) override;  // NOLINT(*)
   void VisitExpr_(const RampNode* op, std::ostream& os) override;  // NOLINT(*)
   void VisitExpr_(const ShuffleNode* op, std::ostream& os) override;  // NOLINT(*)
   void VisitExpr_(const BroadcastNode* op, std::ostream& os) override;  // NOLINT(*)
@@ -173,6 +174,10 @@ class CodeGenC :
       const std::string& vec, DataType t, int i, const std::string& value);
   // Get a cast type from to
   virtual std::string CastFromTo(std::string value, DataType from, DataType target);
+  // Get the condition of a branch, hinted with the probability that it is true.
+  virtual std::string PrintBranchCondition(const std::string& cond, double probability) {
+    return cond;
+  }
 
  protected:
   // Print reference to struct location
@@ -229,6 +234,10 @@ class CodeGenC :
   std::unordered_map<const VarNode*, std::string> alloc_storage_scope_;
   /*! \brief the data type of allocated buffers */
   std::unordered_map<const VarNode*, DataType> handle_data_type_;
+  /*! \brief the handle arguments of the function that are never written, declared const */
+  std::unordered_set<const VarNode*> read_only_args_;
+  /*! \brief the profiled probabilities of the conditions of branches */
+  std::unordered_map<const Object*, double> branch_probability_;
   /*! \brief reserves common C keywords */
   void ReserveKeywordsAsUnique();
   /*! \brief Currently inside function */
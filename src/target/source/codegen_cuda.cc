@@ -27,12 +27,17 @@
 #include <cuda_runtime_api.h>
 #endif
 #include <tvm/runtime/registry.h>
+#include <tvm/target/target.h>
+#include <tvm/tir/stmt_functor.h>
 
+#include <algorithm>
 #include <cmath>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "literal/cuda_half_t.h"
+#include "../../runtime/thread_storage_scope.h"
 
 namespace tvm {
 namespace codegen {
@@ -68,11 +73,146 @@ void CodeGenCUDA::Init(bool output_ssa) {
   // }
 }
 
+// Collects the number of threads of the blocks of a kernel, from its
+// thread_extent attributes, and the minimum number of resident blocks
+// asked for through launch_min_blocks.
+class LaunchBoundsCollector : public StmtVisitor {
+ public:
+  void VisitStmt_(const AttrStmtNode* op) final {
+    if (op->attr_key == attr::thread_extent) {
+      IterVar iv = Downcast<IterVar>(op->node);
+      runtime::ThreadScope ts = runtime::ThreadScope::make(iv->thread_tag);
+      if (ts.rank == 1) {
+        // The bodies of an hfused kernel bind the same thread axes.
+        const auto* extent = op->value.as<IntImmNode>();
+        if (extent == nullptr) {
+          dynamic_threads = true;
+        } else {
+          int64_t& max_extent = thread_extents[ts.dim_index];
+          max_extent = std::max(max_extent, extent->value);
+        }
+      }
+    } else if (op->attr_key == attr::launch_min_blocks) {
+      const auto* value = op->value.as<IntImmNode>();
+      CHECK(value != nullptr) << "launch_min_blocks expects a constant";
+      min_blocks = std::max(min_blocks, value->value);
+    }
+    StmtVisitor::VisitStmt_(op);
+  }
+
+  int64_t MaxThreads() const {
+    return thread_extents[0] * thread_extents[1] * thread_extents[2];
+  }
+
+  int64_t thread_extents[3] = {1, 1, 1};
+  bool dynamic_threads{false};
+  int64_t min_blocks{0};
+};
+
 void CodeGenCUDA::AddFunction(LoweredFunc f) {
   this->stream << "extern \"C\" __global__ ";
+  LaunchBoundsCollector bounds;
+  bounds(f->body);
+  if (bounds.min_blocks > 0) {
+    if (bounds.dynamic_threads) {
+      LOG(WARNING) << "Ignoring launch_min_blocks of " << f->name
+                   << " as its number of threads is not constant";
+    } else {
+      this->stream << "__launch_bounds__(" << bounds.MaxThreads() << ", " << bounds.min_blocks
+                   << ") ";
+    }
+  }
   CodeGenC::AddFunction(f);
 }
 
+// Collects the handle variables of a kernel that are written or whose
+// address escapes to something that may write through it, like an
+// atomic or an extern call.
+class WrittenBufferCollector : public StmtExprVisitor {
+ public:
+  void VisitStmt_(const StoreNode* op) final {
+    written.insert(op->buffer_var.get());
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitExpr_(const VarNode* op) final {
+    // Loads and stores do not visit their buffer var, so any other
+    // use of a handle passes the pointer on.
+    if (op->dtype.is_handle()) written.insert(op);
+  }
+
+  void VisitExpr_(const CallNode* op) final {
+    if (op->is_intrinsic(intrinsic::tvm_address_of)) {
+      if (auto load = op->args[0].as<LoadNode>()) written.insert(load->buffer_var.get());
+    }
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  std::unordered_set<const VarNode*> written;
+};
+
+// Collects the aux structures of a kernel, along with the type of
+// their loads if they are all scalar loads of the same type.
+class AuxLoadCollector : public StmtExprVisitor {
+ public:
+  void VisitStmt_(const AttrStmtNode* op) final {
+    if (op->attr_key == attr::aux_data_structure) {
+      if (auto var = op->node.as<VarNode>()) aux.insert(var);
+    }
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitExpr_(const LoadNode* op) final {
+    auto it = load_types.find(op->buffer_var.get());
+    if (op->dtype.lanes() != 1 || (it != load_types.end() && it->second != op->dtype)) {
+      mixed.insert(op->buffer_var.get());
+    } else {
+      load_types[op->buffer_var.get()] = op->dtype;
+    }
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  std::unordered_set<const VarNode*> aux;
+  std::unordered_map<const VarNode*, DataType> load_types;
+  std::unordered_set<const VarNode*> mixed;
+};
+
+// The constant memory the aux structures of a module may take. Some
+// is left to the constants the compiler itself places there.
+constexpr int kAuxConstantMemoryBytes = 60 * 1024;
+
+void CodeGenCUDA::InitFuncState(LoweredFunc f) {
+  CodeGenC::InitFuncState(f);
+  // Buffers, such as the aggregate buffer of the aux structures of a
+  // ragged prelude, that the kernel only reads are declared const.
+  WrittenBufferCollector collector;
+  collector(f->body);
+  for (const auto& v : f->args) {
+    if (v.dtype().is_handle() && !collector.written.count(v.get())) {
+      read_only_args_.insert(v.get());
+    }
+  }
+
+  // Read-only aux structures only ever loaded from as scalars get a
+  // copy in constant memory, which the runtime fills in when they fit
+  // and then passes a null pointer for them.
+  constant_aux_.clear();
+  if (!BuildConfig::Current()->aux_constant_memory) return;
+  AuxLoadCollector aux_collector;
+  aux_collector(f->body);
+  for (size_t i = 0; i < f->args.size(); ++i) {
+    const VarNode* v = f->args[i].get();
+    if (!read_only_args_.count(v) || !aux_collector.aux.count(v) || aux_collector.mixed.count(v) ||
+        !aux_collector.load_types.count(v)) {
+      continue;
+    }
+    std::string symbol = f->name + runtime::symbol::tvm_aux_constant_suffix + std::to_string(i);
+    CHECK_EQ(GetUniqueName(symbol), symbol);
+    constant_aux_[v] = symbol;
+    constant_aux_symbols_.emplace_back(symbol, aux_collector.load_types.at(v));
+  }
+}
+
 std::string CodeGenCUDA::Finish() {
   if (enable_fp16_) {
     decl_stream << "#if defined(__CUDA_ARCH__) && (__CUDA_ARCH__ >= 530)\n";
@@ -106,6 +246,16 @@ std::string CodeGenCUDA::Finish() {
     decl_stream << "#include <cooperative_groups.h>\n";
   }
 
+  // The constant memory is split evenly among the aux structures.
+  if (constant_aux_symbols_.size() > 0) {
+    int nbytes = kAuxConstantMemoryBytes / constant_aux_symbols_.size() / 16 * 16;
+    for (const auto& it : constant_aux_symbols_) {
+      decl_stream << "__constant__ ";
+      PrintType(it.second, decl_stream);
+      decl_stream << ' ' << it.first << '[' << nbytes / it.second.bytes() << "];\n";
+    }
+  }
+
   return CodeGenC::Finish();
 }
 
@@ -326,7 +476,10 @@ void CodeGenCUDA::PrintVecElemStore(const std::string& vec, DataType t, int i,
 void CodeGenCUDA::PrintStorageSync(const CallNode* op) {
   const std::string& sync = op->args[0].as<StringImmNode>()->value;
   if (sync == "warp") {
-    // DO nothing.
+    // Threads of a warp are not guaranteed to run in lockstep since
+    // Volta.
+    this->PrintIndent();
+    this->stream << "__syncwarp();\n";
   } else if (sync == "shared") {
     this->PrintIndent();
     this->stream << "__syncthreads();\n";
@@ -380,7 +533,9 @@ void CodeGenCUDA::PrintStorageScope(const std::string& scope, std::ostream& os)
 }
 
 void CodeGenCUDA::VisitExpr_(const CallNode* op, std::ostream& os) {
-  if (op->is_intrinsic(intrinsic::tvm_fill_fragment)) {
+  if (op->is_intrinsic(intrinsic::tvm_cycle_counter)) {
+    os << "((int64_t)clock64())";
+  } else if (op->is_intrinsic(intrinsic::tvm_fill_fragment)) {
     need_mma_h_ = true;
     CHECK_EQ(op->args.size(), 6U);
     os << "nvcuda::wmma::fill_fragment(";
@@ -434,6 +589,10 @@ void CodeGenCUDA::VisitExpr_(const CallNode* op, std::ostream& os) {
   }
 }
 
+std::string CodeGenCUDA::PrintBranchCondition(const std::string& cond, double probability) {
+  return "__builtin_expect(" + cond + ", " + (probability >= 0.5 ? "1" : "0") + ")";
+}
+
 void CodeGenCUDA::VisitStmt_(const AttrStmtNode* op) {
   if (op->attr_key == attr::fragment_shape) {
     const VarNode* buffer = op->node.as<VarNode>();
@@ -515,6 +674,32 @@ void CodeGenCUDA::VisitStmt_(const EvaluateNode* op) {
       PrintIndent();
       stream << "}\n";
     }
+  } else if (call && call->is_intrinsic(intrinsic::tvm_cp_async)) {
+    CHECK_EQ(call->args.size(), 3U);
+    auto bytes = call->args[2].as<IntImmNode>();
+    CHECK(bytes && (bytes->value == 4 || bytes->value == 8 || bytes->value == 16));
+    std::string dst = PrintExpr(call->args[0]);
+    std::string src = PrintExpr(call->args[1]);
+    // Copies of 16 bytes can bypass L1.
+    std::string cache = bytes->value == 16 ? "cg" : "ca";
+    PrintIndent();
+    stream << "asm volatile(\"cp.async." << cache << ".shared.global [%0], [%1], %2;\\n\" :: "
+           << "\"r\"((unsigned)__cvta_generic_to_shared(" << dst << ")), \"l\"(" << src
+           << "), \"n\"(" << bytes->value << "));\n";
+  } else if (call && call->is_intrinsic(CallNode::prefetch)) {
+    CHECK_EQ(call->args.size(), 4U);
+    PrintIndent();
+    stream << "asm volatile(\"prefetch.global.L2 [%0];\\n\" :: \"l\"(" << PrintExpr(call->args[0])
+           << "));\n";
+  } else if (call && call->is_intrinsic(intrinsic::tvm_cp_async_commit_group)) {
+    PrintIndent();
+    stream << "asm volatile(\"cp.async.commit_group;\\n\" ::);\n";
+  } else if (call && call->is_intrinsic(intrinsic::tvm_cp_async_wait_group)) {
+    CHECK_EQ(call->args.size(), 1U);
+    auto num_pending = call->args[0].as<IntImmNode>();
+    CHECK(num_pending);
+    PrintIndent();
+    stream << "asm volatile(\"cp.async.wait_group " << num_pending->value << ";\\n\" ::);\n";
   } else {
     CodeGenC::VisitStmt_(op);
   }
@@ -565,6 +750,36 @@ void CodeGenCUDA::VisitExpr_(const BroadcastNode* op, std::ostream& os) {  // NO
   os << ')';
 }
 
+void CodeGenCUDA::VisitExpr_(const CastNode* op, std::ostream& os) {
+  DataType from = op->value.dtype();
+  DataType target = op->dtype;
+  // Vectors of halves are stored in uints, which a C style cast would
+  // reinterpret, so such casts, as of vectorized fp16 loads to float
+  // accumulators, are done one lane at a time.
+  if (from.lanes() == 1 || (!from.is_float16() && !target.is_float16())) {
+    CodeGenC::VisitExpr_(op, os);
+    return;
+  }
+  CHECK_EQ(from.lanes(), target.lanes());
+  int vec_scope = BeginScope();
+  std::string src = SSAGetID(PrintExpr(op->value), from);
+  std::string sret = GetUniqueName("_");
+  this->PrintIndent();
+  this->PrintType(target, stream);
+  stream << ' ' << sret << ";\n";
+  for (int i = 0; i < from.lanes(); ++i) {
+    std::ostringstream value;
+    value << "((";
+    this->PrintType(target.element_of(), value);
+    value << ")(";
+    PrintVecElemLoad(src, from, i, value);
+    value << "))";
+    PrintVecElemStore(sret, target, i, value.str());
+  }
+  os << sret;
+  EndScope(vec_scope);
+}
+
 void CodeGenCUDA::VisitExpr_(const ShuffleNode* op, std::ostream& os) {
   std::vector<std::string> to_shuffle(op->vectors.size());
   for (int i = 0, e = op->vectors.size(); i < e; ++i) {
@@ -663,6 +878,32 @@ int32_t CodeGenCUDA::GetWmmaFragmentSize(const std::string& scope, const VarNode
   return 0;
 }
 
+void CodeGenCUDA::VisitExpr_(const LoadNode* op, std::ostream& os) {
+  // Loads from restricted buffers the kernel never writes go through
+  // the read-only data cache.
+  const VarNode* buffer = op->buffer_var.get();
+  DataType t = op->dtype;
+  bool ldg_type =
+      ((t.is_int() || t.is_uint()) && t.bits() >= 8) || (t.is_float() && t.bits() >= 32);
+  std::ostringstream value;
+  if (t.lanes() == 1 && ldg_type && current_func_->is_restricted &&
+      restrict_keyword_.length() != 0 && read_only_args_.count(buffer) && !IsVolatile(buffer)) {
+    value << "__ldg(&" << GetBufferRef(t, buffer, op->index) << ")";
+  } else {
+    CodeGenC::VisitExpr_(op, value);
+  }
+  // The runtime passes a null pointer for aux structures it copied
+  // to constant memory.
+  auto it = constant_aux_.find(buffer);
+  if (it != constant_aux_.end()) {
+    os << '(' << GetVarID(buffer) << " ? " << value.str() << " : " << it->second << '[';
+    PrintExpr(op->index, os);
+    os << "])";
+  } else {
+    os << value.str();
+  }
+}
+
 void CodeGenCUDA::HandleVolatileLoads(const std::string& value, const LoadNode* op,
                                       std::ostream& os) {
   // Cast away volatile qualifier for fp16 types. That is, only loads and
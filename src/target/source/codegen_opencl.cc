@@ -20,6 +20,8 @@
 /*!
  * \file codegen_opencl.cc
  */
+#include <tvm/target/target.h>
+#include <tvm/tir/stmt_functor.h>
 #include <cmath>
 #include <vector>
 #include <string>
@@ -44,8 +46,29 @@ void CodeGenOpenCL::InitFuncState(LoweredFunc f) {
   }
 }
 
+// Whether the body calls the sub-group shuffles the warp shuffles
+// are lowered to.
+static bool UsesSubGroups(const Stmt& body) {
+  bool ret = false;
+  PostOrderVisit(body, [&ret](const ObjectRef& node) {
+    if (auto call = node.as<CallNode>()) {
+      if (call->call_type == CallNode::PureExtern && call->name.find("tvm_sub_group_") == 0) {
+        ret = true;
+      }
+    }
+  });
+  return ret;
+}
+
 void CodeGenOpenCL::AddFunction(LoweredFunc f) {
   this->stream << "__kernel ";
+  if (UsesSubGroups(f->body)) {
+    enable_sub_groups_ = true;
+    // The shuffles assume sub-groups as wide as the target's warps.
+    if (sub_group_size_ > 1) {
+      this->stream << "TVM_REQD_SUB_GROUP_SIZE(" << sub_group_size_ << ") ";
+    }
+  }
   CodeGenC::AddFunction(f);
 }
 
@@ -75,6 +98,31 @@ std::string CodeGenOpenCL::Finish() {
            "#endif\n\n";
   }
 
+  if (enable_sub_groups_) {
+    decl_stream
+        << "#if defined(cl_khr_subgroup_shuffle) && defined(cl_khr_subgroup_shuffle_relative)\n"
+           "#pragma OPENCL EXTENSION cl_khr_subgroups : enable\n"
+           "#pragma OPENCL EXTENSION cl_khr_subgroup_shuffle : enable\n"
+           "#pragma OPENCL EXTENSION cl_khr_subgroup_shuffle_relative : enable\n"
+           "#define tvm_sub_group_shuffle(v, lane) sub_group_shuffle(v, lane)\n"
+           "#define tvm_sub_group_shuffle_down(v, delta) sub_group_shuffle_down(v, delta)\n"
+           "#elif defined(cl_intel_subgroups)\n"
+           "#pragma OPENCL EXTENSION cl_intel_subgroups : enable\n"
+           "#define tvm_sub_group_shuffle(v, lane) intel_sub_group_shuffle(v, lane)\n"
+           "#define tvm_sub_group_shuffle_down(v, delta) "
+           "intel_sub_group_shuffle_down(v, v, delta)\n"
+           "#else\n"
+           "#error \"Sub-group shuffles not supported "
+                    "by OpenCL implementation on your device.\" \n"
+           "#endif\n"
+           "#ifdef cl_intel_required_subgroup_size\n"
+           "#pragma OPENCL EXTENSION cl_intel_required_subgroup_size : enable\n"
+           "#define TVM_REQD_SUB_GROUP_SIZE(n) __attribute__((intel_reqd_sub_group_size(n)))\n"
+           "#else\n"
+           "#define TVM_REQD_SUB_GROUP_SIZE(n)\n"
+           "#endif\n\n";
+  }
+
   return CodeGenC::Finish();
 }
 
@@ -259,11 +307,12 @@ void CodeGenOpenCL::VisitExpr_(const FloatImmNode *op, std::ostream& os) { // NO
   }
 }
 
-runtime::Module BuildOpenCL(Array<LoweredFunc> funcs) {
+runtime::Module BuildOpenCL(Array<LoweredFunc> funcs, std::string target) {
   using tvm::runtime::Registry;
   bool output_ssa = false;
   CodeGenOpenCL cg;
   cg.Init(output_ssa);
+  cg.SetSubGroupSize(Target::Create(target)->thread_warp_size);
   for (LoweredFunc f : funcs) {
     cg.AddFunction(f);
   }
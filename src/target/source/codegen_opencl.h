@@ -34,6 +34,11 @@ namespace codegen {
 class CodeGenOpenCL final : public CodeGenC {
  public:
   CodeGenOpenCL();
+  /*!
+   * \brief Set the sub-group size the warp shuffles were lowered for,
+   *  which the kernels using them require of the device.
+   */
+  void SetSubGroupSize(int sub_group_size) { sub_group_size_ = sub_group_size; }
   void AddFunction(LoweredFunc f);
   std::string Finish();
 
@@ -63,6 +68,10 @@ class CodeGenOpenCL final : public CodeGenC {
   // whether enable fp16 and fp64 extension
   bool enable_fp16_{false};
   bool enable_fp64_{false};
+  // whether enable the sub-group extensions
+  bool enable_sub_groups_{false};
+  // the sub-group size the kernels require
+  int sub_group_size_{1};
 };
 
 }  // namespace codegen
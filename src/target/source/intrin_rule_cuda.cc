@@ -86,6 +86,10 @@ struct CUDAActiveMask {
   std::string operator()(DataType t, std::string name) const { return "__activemask"; }
 };
 
+struct CUDABallot {
+  std::string operator()(DataType t, std::string name) const { return "__ballot_sync"; }
+};
+
 TVM_REGISTER_GLOBAL("tvm.intrin.rule.cuda.floor").set_body(DispatchExtern<CUDAMath>);
 
 TVM_REGISTER_GLOBAL("tvm.intrin.rule.cuda.ceil").set_body(DispatchExtern<CUDAMath>);
@@ -124,6 +128,8 @@ TVM_REGISTER_GLOBAL("tvm.intrin.rule.cuda.tvm_warp_shuffle_down")
 TVM_REGISTER_GLOBAL("tvm.intrin.rule.cuda.tvm_warp_activemask")
     .set_body(DispatchExtern<CUDAActiveMask>);
 
+TVM_REGISTER_GLOBAL("tvm.intrin.rule.cuda.tvm_warp_ballot").set_body(DispatchExtern<CUDABallot>);
+
 TVM_REGISTER_GLOBAL("tvm.intrin.rule.cuda.fmod").set_body(DispatchExtern<CUDAMath>);
 
 }  // namespace intrin
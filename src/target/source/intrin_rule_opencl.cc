@@ -21,6 +21,7 @@
  * \file intrin_rule_opencl.cc
  * \brief OpenCL intrinsic rules.
  */
+#include <tvm/tir/op.h>
 #include "../intrin_rule.h"
 
 namespace tvm {
@@ -63,16 +64,37 @@ TVM_REGISTER_GLOBAL("tvm.intrin.rule.opencl.popcount")
 TVM_REGISTER_GLOBAL("tvm.intrin.rule.opencl.fmod")
 .set_body(DispatchExtern<Direct>);
 
-// There is no warp shuffle instruction in standard OpenCL
-// When shuffle is used, we assume it is intel's shuffle extension
-struct IntelShuffle {
-  std::string operator()(DataType t, std::string name) const {
-    return "intel_sub_group_shuffle";
-  }
-};
+// There is no warp shuffle instruction in standard OpenCL. Shuffles
+// are lowered to the sub-group shuffles of cl_khr_subgroup_shuffle,
+// or of Intel's sub-group extension, which CodeGenOpenCL selects
+// between. Sub-groups have no lane masks, so the masks of the warp
+// reductions are dropped.
+static void DispatchSubGroupShuffle(const char* name, const TVMArgs& targs, TVMRetValue* rv) {
+  PrimExpr e = targs[0];
+  const CallNode* call = e.as<CallNode>();
+  CHECK(call != nullptr);
+  // (mask, value, lane) from the warp reductions, (value, lane) from
+  // the warp memory.
+  size_t begin = call->args.size() == 3 ? 1 : 0;
+  CHECK_EQ(call->args.size() - begin, 2U);
+  *rv = CallNode::make(call->dtype, name, {call->args[begin], call->args[begin + 1]},
+                       CallNode::PureExtern);
+}
 
 TVM_REGISTER_GLOBAL("tvm.intrin.rule.opencl.tvm_warp_shuffle")
-.set_body(DispatchExtern<IntelShuffle>);
+.set_body([](const TVMArgs& targs, TVMRetValue* rv) {
+  DispatchSubGroupShuffle("tvm_sub_group_shuffle", targs, rv);
+});
+
+TVM_REGISTER_GLOBAL("tvm.intrin.rule.opencl.tvm_warp_shuffle_down")
+.set_body([](const TVMArgs& targs, TVMRetValue* rv) {
+  DispatchSubGroupShuffle("tvm_sub_group_shuffle_down", targs, rv);
+});
+
+TVM_REGISTER_GLOBAL("tvm.intrin.rule.opencl.tvm_warp_activemask")
+.set_body([](const TVMArgs& targs, TVMRetValue* rv) {
+  *rv = make_const(DataType::UInt(32), 0xFFFFFFFFU);
+});
 
 }  // namespace intrin
 }  // namespace codegen
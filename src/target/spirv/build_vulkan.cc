@@ -85,6 +85,7 @@ runtime::Module BuildSPIRV(Array<LoweredFunc> funcs) {
     f = PointerValueTypeRewrite(f);
     VulkanShader shader;
     shader.data = cg.BuildFunction(f);
+    shader.flag = cg.shader_flag();
 
     if (postproc != nullptr) {
       TVMByteArray arr;
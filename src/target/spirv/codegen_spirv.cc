@@ -26,10 +26,14 @@
 #include <string>
 #include "codegen_spirv.h"
 #include "../../arith/compute_expr.h"
+#include "../../runtime/vulkan/vulkan_shader.h"
 
 namespace tvm {
 namespace codegen {
 
+// The push constant space every Vulkan device provides.
+static constexpr uint32_t kMaxPushConstantBytes = 128;
+
 std::vector<uint32_t> CodeGenSPIRV::BuildFunction(const LoweredFunc& f) {
   this->InitFuncState();
   CHECK(f->is_restricted)
@@ -57,13 +61,25 @@ std::vector<uint32_t> CodeGenSPIRV::BuildFunction(const LoweredFunc& f) {
   spirv::Value func_ptr = builder_->NewFunction();
   builder_->StartFunction(func_ptr);
 
-  // All the POD arguments are passed in through PushConstant
+  // The POD arguments are passed in through PushConstant. Ragged
+  // kernels take many extents and offsets though, and when these do
+  // not fit in the push constant space every device guarantees, they
+  // are read from a storage buffer bound after the buffer arguments.
   if (pod_args.size() != 0) {
     std::vector<spirv::SType> value_types;
+    uint32_t pod_bytes = 0;
     for (size_t i = 0; i < pod_args.size(); ++i) {
-      value_types.push_back(builder_->GetSType(pod_args[i].dtype()));
+      DataType t = pod_args[i].dtype();
+      value_types.push_back(builder_->GetSType(t));
+      pod_bytes += t.bits() * t.lanes() / 8;
+    }
+    spirv::Value ptr;
+    if (pod_bytes > kMaxPushConstantBytes) {
+      ptr = builder_->DeclarePODBuffer(value_types, 0, num_buffer);
+      shader_flag_ |= runtime::vulkan::kVulkanShaderPODArgsInBuffer;
+    } else {
+      ptr = builder_->DeclarePushConstant(value_types);
     }
-    spirv::Value ptr = builder_->DeclarePushConstant(value_types);
     for (size_t i = 0; i < pod_args.size(); ++i) {
       spirv::Value value = builder_->GetPushConstant(
           ptr, value_types[i], static_cast<uint32_t>(i));
@@ -82,6 +98,7 @@ std::vector<uint32_t> CodeGenSPIRV::BuildFunction(const LoweredFunc& f) {
 
 void CodeGenSPIRV::InitFuncState() {
   std::fill(workgroup_size_, workgroup_size_ + 3, 1);
+  shader_flag_ = 0;
   var_map_.clear();
   storage_info_.clear();
   analyzer_.reset(new arith::Analyzer());
@@ -228,6 +245,10 @@ spirv::Value CodeGenSPIRV::VisitExpr_(const SelectNode* op) {
                           MakeValue(op->false_value));
 }
 
+spirv::Value CodeGenSPIRV::VisitExpr_(const FuseSelectNode* op) {
+  return VisitExpr_(static_cast<const SelectNode*>(op));
+}
+
 spirv::Value CodeGenSPIRV::VisitExpr_(const LetNode* op) {
   CHECK(!var_map_.count(op->var.get()));
   var_map_[op->var.get()] = MakeValue(op->value);
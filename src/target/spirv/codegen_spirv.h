@@ -54,6 +54,13 @@ class CodeGenSPIRV:
    * \return The final spirv module.
    */
   virtual std::vector<uint32_t> BuildFunction(const LoweredFunc& f);
+  /*!
+   * \brief The header flag of the shader last built, a combination
+   *  of runtime::vulkan::VulkanShaderFlag.
+   */
+  uint32_t shader_flag() const {
+    return shader_flag_;
+  }
   /*!
    * \brief Create Value for expression e
    * \param e The expression to be created value for.
@@ -85,6 +92,7 @@ class CodeGenSPIRV:
   spirv::Value VisitExpr_(const OrNode* op) override;
   spirv::Value VisitExpr_(const NotNode* op) override;
   spirv::Value VisitExpr_(const SelectNode* op) override;
+  spirv::Value VisitExpr_(const FuseSelectNode* op) override;
   spirv::Value VisitExpr_(const LetNode* op) override;
   spirv::Value VisitExpr_(const CallNode* op) override;
   spirv::Value VisitExpr_(const RampNode* op) override;
@@ -136,6 +144,8 @@ class CodeGenSPIRV:
   std::unique_ptr<spirv::IRBuilder> builder_;
   // Work group size of three
   uint32_t workgroup_size_[3];
+  // The header flag of the shader.
+  uint32_t shader_flag_{0};
   // Likely branch
   uint32_t weight_likely_branch_{128};
   // the storage scope of allocation
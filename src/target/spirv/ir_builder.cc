@@ -202,8 +202,7 @@ Value IRBuilder::BufferArgument(const SType& value_type,
   return val;
 }
 
-Value IRBuilder::DeclarePushConstant(const std::vector<SType>& value_types) {
-  CHECK_EQ(push_const_.id, 0);
+SType IRBuilder::GetPODStructType(const std::vector<SType>& value_types) {
   SType struct_type;
   struct_type.id = id_counter_++;
   struct_type.type = DataType::Handle();
@@ -223,6 +222,12 @@ Value IRBuilder::DeclarePushConstant(const std::vector<SType>& value_types) {
     CHECK_EQ(nbits % 8 , 0);
     offset += nbits / 8;
   }
+  return struct_type;
+}
+
+Value IRBuilder::DeclarePushConstant(const std::vector<SType>& value_types) {
+  CHECK_EQ(push_const_.id, 0);
+  SType struct_type = GetPODStructType(value_types);
   // Decorate push constants as UBO
   this->Decorate(spv::OpDecorate, struct_type, spv::DecorationBlock);
 
@@ -234,9 +239,28 @@ Value IRBuilder::DeclarePushConstant(const std::vector<SType>& value_types) {
   return val;
 }
 
+Value IRBuilder::DeclarePODBuffer(const std::vector<SType>& value_types,
+                                  uint32_t descriptor_set,
+                                  uint32_t binding) {
+  SType struct_type = GetPODStructType(value_types);
+  // Bound as a storage buffer, like the buffer arguments.
+  this->Decorate(spv::OpDecorate, struct_type, spv::DecorationBufferBlock);
+
+  SType ptr_type = GetPointerType(struct_type, spv::StorageClassUniform);
+  Value val = NewValue(ptr_type, kPushConstantPtr);
+  ib_.Begin(spv::OpVariable)
+      .AddSeq(ptr_type, val, spv::StorageClassUniform).Commit(&global_);
+  this->Decorate(spv::OpDecorate,
+                 val, spv::DecorationDescriptorSet, descriptor_set);
+  this->Decorate(spv::OpDecorate,
+                 val, spv::DecorationBinding, binding);
+  return val;
+}
+
 Value IRBuilder::GetPushConstant(
     Value ptr_push_const, const SType& v_type, uint32_t index) {
-  SType ptr_vtype = this->GetPointerType(v_type, spv::StorageClassPushConstant);
+  CHECK_EQ(ptr_push_const.flag, kPushConstantPtr);
+  SType ptr_vtype = this->GetPointerType(v_type, ptr_push_const.stype.storage_class);
   Value ptr = this->MakeValue(
       spv::OpAccessChain, ptr_vtype, ptr_push_const,
       IntImm(t_int32_, static_cast<int64_t>(index)));
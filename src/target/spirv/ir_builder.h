@@ -497,7 +497,18 @@ class IRBuilder {
    */
   Value DeclarePushConstant(const std::vector<SType>& value_types);
   /*!
-   * \brief Get i-th push constant
+   * \brief Declare POD arguments read from a storage buffer, for when
+   *  they do not fit in the push constants.
+   * \param value_types The values in the buffer
+   * \param descriptor_set The descriptor set we want to use.
+   * \param binding The binding locaiton in descriptor set.
+   * \return The pointer to the buffer, read by GetPushConstant.
+   */
+  Value DeclarePODBuffer(const std::vector<SType>& value_types,
+                         uint32_t descriptor_set,
+                         uint32_t binding);
+  /*!
+   * \brief Get i-th push constant (or i-th value of a POD buffer)
    * \param v_type The value type
    * \param index The push constant index
    * \return the value of push constant
@@ -576,6 +587,8 @@ class IRBuilder {
   Value GetConst_(const SType& dtype, const uint64_t* pvalue);
   // declare type
   SType DeclareType(const DataType& dtype);
+  // declare the struct of POD values, with their member offsets
+  SType GetPODStructType(const std::vector<SType>& value_types);
   /*! \brief internal instruction builder  */
   InstrBuilder ib_;
   /*! \brief Current label */
@@ -61,6 +61,7 @@ Target CreateTarget(const std::string& target_name,
   std::string libs_flag = "-libs=";
   std::string device_flag = "-device=";
   std::string keys_flag = "-keys=";
+  std::string warp_size_flag = "-thread_warp_size=";
   for (auto& item : options) {
     t->options_array.push_back(tir::StringImmNode::make(item));
 
@@ -110,6 +111,13 @@ Target CreateTarget(const std::string& target_name,
     if (t->device_name == "intel_graphics") {
       t->thread_warp_size = 16;
     }
+    // The sub-group size of other OpenCL devices, such as Mali GPUs,
+    // depends on the device and has to be given.
+    for (auto& item : options) {
+      if (target_name == "opencl" && item.find(warp_size_flag) == 0) {
+        t->thread_warp_size = std::stoi(item.substr(warp_size_flag.length()));
+      }
+    }
   } else if (target_name == "metal" || target_name == "vulkan") {
     if (target_name == "metal") {
       t->device_type = kDLMetal;
@@ -388,6 +396,7 @@ TVM_STATIC_IR_FUNCTOR(ReprPrinter, vtable)
   p->stream << "data_alignment=" << op->data_alignment << ", ";
   p->stream << "offset_factor=" << op->offset_factor << ", ";
   p->stream << "double_buffer_split_loop=" << op->double_buffer_split_loop << ", ";
+  p->stream << "double_buffer_async_copy=" << op->double_buffer_async_copy << ", ";
   p->stream << "auto_unroll_max_step=" << op->auto_unroll_max_step << ", ";
   p->stream << "auto_unroll_max_depth=" << op->auto_unroll_max_depth << ", ";
   p->stream << "auto_unroll_max_extent=" << op->auto_unroll_max_extent << ", ";
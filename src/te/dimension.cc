@@ -84,6 +84,14 @@ DimensionRelationGraph DimensionRelationGraphNode::make(Array<Dimension> root_di
   return DimensionRelationGraph(n);
 }
 
+bool DimensionRelationGraphNode::IsChanged() const {
+  if (relations.size() > 0 || leaf_dimensions.size() != root_dimensions.size()) return true;
+  for (size_t i = 0; i < leaf_dimensions.size(); ++i) {
+    if (leaf_dimensions[i] != root_dimensions[i]) return true;
+  }
+  return false;
+}
+
 std::string op2str(const DimKey::OpType& op) {
   switch (op) {
     case DimKey::kFuse:
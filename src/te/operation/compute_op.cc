@@ -1411,6 +1411,14 @@ TVM_REGISTER_GLOBAL("te.ComputeOpSetOutputBuf")
       c_op->output_buffer_dims = buf_dims;
     });
 
+TVM_REGISTER_GLOBAL("te.BaseComputeOpSetStorageLayout")
+    .set_body_typed([](Operation op, int value_index, Modes layout) {
+      BaseComputeOpNode* c_op = const_cast<BaseComputeOpNode*>(op.as<BaseComputeOpNode>());
+      CHECK(c_op);
+      CHECK_LT(static_cast<size_t>(value_index), c_op->storage_layouts.size());
+      c_op->set_storage_layout(value_index, layout);
+    });
+
 TVM_REGISTER_GLOBAL("te.BaseComputeOpGetRootIndexDimensions")
     .set_body_typed([](Operation op, int value_index) {
       auto c_op = op.as<ComputeOpNode>();
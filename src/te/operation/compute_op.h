@@ -113,6 +113,35 @@ Stmt MakeTensorize(const ComputeOpNode* self, const Stage& stage,
  */
 Stmt TransformUpdate(const Stage& stage, const std::unordered_map<IterVar, Range>& dom_map,
                      const ComputeLoopNest& n, Stmt body, Stmt update);
+
+/*!
+ * \brief Build the scalar init and update of a reduction.
+ * \param s The stage.
+ * \param op The pointer to ComputeOpNode
+ * \param dom_map The range of each iter var.
+ * \param tensors The tensors the reduction updates.
+ * \param init_vmap The iter var values in the init nest.
+ * \param main_vmap The iter var values in the main nest.
+ * \param init The init statement.
+ * \param provide The update statement.
+ */
+void MakeReduction(const Stage s, const ComputeOpNode* op,
+                   const std::unordered_map<IterVar, Range>& dom_map, const Array<Tensor>& tensors,
+                   std::unordered_map<IterVar, PrimExpr> init_vmap,
+                   std::unordered_map<IterVar, PrimExpr> main_vmap, Stmt* init, Stmt* provide);
+
+/*!
+ * \brief Build the scalar provide of an output of a compute.
+ * \param s The stage.
+ * \param op The pointer to ComputeOpNode
+ * \param dom_map The range of each iter var.
+ * \param vmap The iter var values in the loop nest.
+ * \param t The output tensor.
+ * \return The provide statement.
+ */
+Stmt MakeProvide(const Stage s, const ComputeOpNode* op,
+                 const std::unordered_map<IterVar, Range>& dom_map,
+                 std::unordered_map<IterVar, PrimExpr> vmap, const Tensor& t);
 }  // namespace te
 }  // namespace tvm
 
@@ -48,6 +48,21 @@ TVM_REGISTER_NODE_TYPE(ConditionalOpNode);
 
 inline bool prove_equal(PrimExpr lhs, PrimExpr rhs) { return is_zero(tir::Simplify(lhs - rhs)); }
 
+int ParseLoweringMode(const Map<std::string, ObjectRef>& attrs) {
+  if (!attrs.count("lowering")) return ConditionalOpNode::kBranch;
+  auto str = attrs.at("lowering").as<StringImmNode>();
+  CHECK(str) << "The lowering attr of a conditional should be a string";
+  if (str->value == "branch") {
+    return ConditionalOpNode::kBranch;
+  } else if (str->value == "predicated") {
+    return ConditionalOpNode::kPredicated;
+  } else if (str->value == "partitioned") {
+    return ConditionalOpNode::kPartitioned;
+  }
+  LOG(FATAL) << "Unknown conditional lowering " << str->value;
+  return ConditionalOpNode::kBranch;
+}
+
 int ConditionalOpNode::num_outputs() const { return static_cast<int>(then_case.size()); }
 Array<IterVar> ConditionalOpNode::root_iter_vars() const {
   Array<IterVar> ret;
@@ -146,6 +161,22 @@ Operation ConditionalOpNode::make(std::string name, std::string tag,
   }
 
   n->condition = condition_uf.MakeCallTo(args, arg_dims);
+  n->lowering_mode = ParseLoweringMode(attrs);
+  if (n->lowering_mode == ConditionalOpNode::kPartitioned) {
+    // The permutation is over the elements of the single explicit
+    // loop, which the condition is a function of.
+    CHECK_EQ(n->explicit_loop_ivs.size(), 1)
+        << "Partitioned conditionals need exactly one explicit dimension";
+    IterVar iv = n->explicit_loop_ivs[0];
+    Var pos = iv->var.copy_with_suffix(".pos");
+    n->partition_perm_uf =
+        UninterpFunNode::make(name + "_perm", iv->dom, {explicit_dims[0]}, {pos},
+                              NullValue<PrimExpr>(), UninterpFunNode::kUnspecifiedFun);
+    n->partition_then_end_uf = UninterpFunNode::make(
+        name + "_then_end",
+        Range::make_by_min_max_inclusive(iv->dom->min, iv->dom->max_exclusive()), {}, {},
+        NullValue<PrimExpr>(), UninterpFunNode::kUnspecifiedFun);
+  }
 
   // In the following code, we collect, for each input (update, for
   // now) tensor, the dimensions corresponding to its operation, and
@@ -515,10 +546,30 @@ Stmt ConditionalOpNode::BuildProvide(
     bool debug_keep_trivial_loop) const {
   CHECK_EQ(stage->op.operator->(), this);
 
-  Stmt provide = IfThenElseNode::make(
-      condition,
-      AttrStmtNode::make(stage->op, attr::conditional_then_scope, 0, EvaluateNode::make(0)),
-      AttrStmtNode::make(stage->op, attr::conditional_else_scope, 0, EvaluateNode::make(0)));
+  Stmt provide;
+  if (lowering_mode == kPredicated) {
+    // Both branches run for every element. The condition is kept on
+    // the scopes, where the stores of the branches are predicated on
+    // it after they are injected (see LowerConditionalScopes).
+    provide = SeqStmt(
+        {AttrStmtNode::make(stage->op, attr::conditional_then_scope, condition,
+                            EvaluateNode::make(0)),
+         AttrStmtNode::make(stage->op, attr::conditional_else_scope, condition,
+                            EvaluateNode::make(0))});
+  } else {
+    // When partitioned, the explicit loop iterates over positions in
+    // the permutation, whose prefix up to then_end takes the then
+    // branch. The branches see the elements once the loop variable is
+    // mapped through the permutation in their scopes.
+    PrimExpr cond = condition;
+    if (lowering_mode == kPartitioned) {
+      cond = explicit_loop_ivs[0]->var <
+             partition_then_end_uf.MakeCallTo(Array<PrimExpr>(), Array<Dimension>());
+    }
+    provide = IfThenElseNode::make(
+        cond, AttrStmtNode::make(stage->op, attr::conditional_then_scope, 0, EvaluateNode::make(0)),
+        AttrStmtNode::make(stage->op, attr::conditional_else_scope, 0, EvaluateNode::make(0)));
+  }
 
   std::unordered_map<IterVar, PrimExpr> vmap;
   std::unordered_set<IterVar> empty;
@@ -25,6 +25,8 @@
 #include <tvm/runtime/registry.h>
 #include <tvm/te/operation.h>
 #include <tvm/tir/expr.h>
+#include <tvm/tir/ir_pass.h>
+#include <tvm/tir/uninterp_fun.h>
 
 #include <unordered_set>
 
@@ -52,9 +54,32 @@ Array<PrimExpr> ExternOpNode::output_shape(size_t i) const {
   return output_placeholders[i]->shape->get_dense_shape();
 }
 
+Modes ExternOpNode::output_layout(size_t i) const {
+  Modes layout = output_placeholders[i]->shape;
+  return layout->is_ragged() ? layout : NullValue<Modes>();
+}
+
+Modes ExternOpNode::buffer_layout(size_t idx) const {
+  if (idx < inputs.size()) {
+    Tensor t = inputs[idx];
+    return t->op->output_layout(t->value_index);
+  }
+  CHECK_LT(idx - inputs.size(), output_placeholders.size());
+  return output_layout(idx - inputs.size());
+}
+
 Operation ExternOpNode::make(std::string name, std::string tag, Map<std::string, ObjectRef> attrs,
                              Array<Tensor> inputs, Array<Buffer> input_placeholders,
                              Array<Buffer> output_placeholders, Stmt body) {
+  return ExternOpNode::make(name, tag, attrs, inputs, input_placeholders, output_placeholders, {},
+                            {}, {}, body);
+}
+
+Operation ExternOpNode::make(std::string name, std::string tag, Map<std::string, ObjectRef> attrs,
+                             Array<Tensor> inputs, Array<Buffer> input_placeholders,
+                             Array<Buffer> output_placeholders, Array<Buffer> aux_placeholders,
+                             Array<Integer> aux_buffer_indices, Array<Integer> aux_dims,
+                             Stmt body) {
   if (!attrs.defined()) {
     attrs = Map<std::string, ObjectRef>();
   }
@@ -75,11 +100,37 @@ Operation ExternOpNode::make(std::string name, std::string tag, Map<std::string,
   n->inputs = std::move(inputs);
   n->input_placeholders = std::move(input_placeholders);
   n->output_placeholders = std::move(output_placeholders);
+  CHECK_EQ(aux_placeholders.size(), aux_buffer_indices.size());
+  CHECK_EQ(aux_placeholders.size(), aux_dims.size());
+  for (size_t i = 0; i < aux_placeholders.size(); ++i) {
+    CHECK_LT(static_cast<size_t>(aux_buffer_indices[i]->value),
+             n->inputs.size() + n->output_placeholders.size())
+        << "Aux buffer " << aux_placeholders[i] << " of " << n->name
+        << " refers to a non-existent input or output";
+  }
+  n->aux_placeholders = std::move(aux_placeholders);
+  n->aux_buffer_indices = std::move(aux_buffer_indices);
+  n->aux_dims = std::move(aux_dims);
   n->body = std::move(body);
   return Operation(n);
 }
 
-TVM_REGISTER_GLOBAL("te.ExternOp").set_body_typed(ExternOpNode::make);
+TVM_REGISTER_GLOBAL("te.ExternOp")
+    .set_body_typed([](std::string name, std::string tag, Map<std::string, ObjectRef> attrs,
+                       Array<Tensor> inputs, Array<Buffer> input_placeholders,
+                       Array<Buffer> output_placeholders, Stmt body) {
+      return ExternOpNode::make(name, tag, attrs, inputs, input_placeholders, output_placeholders,
+                                body);
+    });
+
+TVM_REGISTER_GLOBAL("te.ExternOpWithAux")
+    .set_body_typed([](std::string name, std::string tag, Map<std::string, ObjectRef> attrs,
+                       Array<Tensor> inputs, Array<Buffer> input_placeholders,
+                       Array<Buffer> output_placeholders, Array<Buffer> aux_placeholders,
+                       Array<Integer> aux_buffer_indices, Array<Integer> aux_dims, Stmt body) {
+      return ExternOpNode::make(name, tag, attrs, inputs, input_placeholders, output_placeholders,
+                                aux_placeholders, aux_buffer_indices, aux_dims, body);
+    });
 
 Array<Tensor> ExternOpNode::InputTensors() const { return inputs; }
 
@@ -163,6 +214,32 @@ Stmt ExternOpNode::BuildProvide(const Stage& stage,
         bind_spec, attr::buffer_bind_scope,
         CallNode::make(DataType::Handle(), intrinsic::tvm_tuple, tuple, CallNode::Intrinsic), ret);
   };
+  // The aux buffers point into the arrays that the A-functions of the
+  // layouts load from, which are generated before the ops are lowered.
+  for (size_t i = aux_placeholders.size(); i != 0; --i) {
+    Buffer aux = aux_placeholders[i - 1];
+    size_t dim = aux_dims[i - 1]->value;
+    Modes layout = buffer_layout(aux_buffer_indices[i - 1]->value);
+    CHECK(layout.defined() && dim < layout->ndim())
+        << "Aux buffer " << aux << " of " << name << " refers to a dense layout";
+    UninterpFun afun = layout->a_funs[dim];
+    CHECK(afun.defined() && afun->body.defined())
+        << "Aux buffer " << aux << " of " << name << " refers to dimension " << dim
+        << ", which has no A-function";
+    std::unordered_map<const VarNode*, PrimExpr> vsub;
+    for (auto param : afun->parameters) {
+      vsub[param.get()] = make_zero(param.dtype());
+    }
+    PrimExpr first = Simplify(tir::Substitute(afun->body, vsub));
+    const LoadNode* load = first.as<LoadNode>();
+    CHECK(load) << "Aux buffer " << aux << " of " << name << " refers to dimension " << dim
+                << ", whose offsets have the closed form " << afun->body
+                << " and are not materialized";
+    ret = LetStmtNode::make(aux->data,
+                            CallNode::make(DataType::Handle(), intrinsic::tvm_address_of,
+                                           {first}, CallNode::PureIntrinsic),
+                            ret);
+  }
   for (size_t i = output_placeholders.size(); i != 0; --i) {
     f_push_bind(output_placeholders[i - 1], stage->op.output(i - 1));
   }
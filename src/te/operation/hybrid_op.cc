@@ -57,6 +57,11 @@ DataType HybridOpNode::output_dtype(size_t i) const { return outputs[i]->dtype;
 
 Array<PrimExpr> HybridOpNode::output_shape(size_t i) const { return outputs[i]->shape; }
 
+// Outputs declared in the script with a ragged layout keep it.
+Modes HybridOpNode::output_layout(size_t i) const {
+  return outputs[i]->op->output_layout(outputs[i]->value_index);
+}
+
 Operation HybridOpNode::make(std::string name, std::string tag, Map<std::string, ObjectRef> attrs,
                              Array<Tensor> inputs, Array<Tensor> outputs, Stmt body) {
   if (!attrs.defined()) {
@@ -149,6 +149,22 @@ void IndexLoopVarDeps(const Stage& stage, Array<DimInfo> all_dimensions,
   }
 }
 
+// Keeps the launch_min_blocks pragma of a thread axis inside the
+// kernel, for the device code generators.
+static void AddLaunchBoundsAttr(const Stage& stage, const IterVar& iv, const IterVar& bind_iv,
+                                std::vector<Stmt>* nest) {
+  if (!stage->iter_var_attrs.count(iv)) return;
+  IterVarAttr it_attr = stage->iter_var_attrs[iv];
+  for (size_t k = 0; k < it_attr->pragma_keys.size(); ++k) {
+    if (it_attr->pragma_keys[k].as<StringImmNode>()->value == tir::attr::launch_min_blocks) {
+      PrimExpr value = it_attr->pragma_values[k];
+      if (!value.defined()) value = make_const(DataType::Int(32), 1);
+      nest->emplace_back(AttrStmtNode::make(bind_iv, tir::attr::launch_min_blocks, value,
+                                            EvaluateNode::make(0)));
+    }
+  }
+}
+
 void MakeLoopNestFromDependentVars(
     const Stage& stage, const std::unordered_map<IterVar, Range>& dom_map, size_t begin_iter_pos,
     bool new_loop_var, const std::unordered_set<IterVar>& skip_iter,
@@ -346,6 +362,11 @@ void MakeLoopNestFromDependentVars(
       // annotate the extent of the IterVar
       nest[i + 1].emplace_back(
           AttrStmtNode::make(bind_iv, tir::attr::thread_extent, extent, no_op, hfuse_group_id));
+      AddLaunchBoundsAttr(stage, iv, bind_iv, &nest[i + 1]);
+      if (hfuse_group_id >= 0 && it_attr->hfuse_weight.defined()) {
+        nest[i + 1].emplace_back(
+            AttrStmtNode::make(bind_iv, tir::attr::hfuse_weight, it_attr->hfuse_weight, no_op));
+      }
       created_thread_extent = true;
       if (!debug_keep_trivial_loop && is_one(dom->extent)) {
         value_map[iv] = dom->min;
@@ -591,6 +612,7 @@ std::vector<std::vector<Stmt>> MakeLoopNest(const Stage& stage,
       // annotate the extent of the IterVar
       nest[i + 1].emplace_back(
           AttrStmtNode::make(bind_iv, tir::attr::thread_extent, extent, no_op));
+      AddLaunchBoundsAttr(stage, iv, bind_iv, &nest[i + 1]);
       if (!debug_keep_trivial_loop && is_one(dom->extent)) {
         value_map[iv] = dom->min;
       } else {
@@ -167,6 +167,13 @@ Operation SpecializationEnvelopeOpNode::make(std::string name, std::string tag,
     }
   }
 
+  if (attrs.count("dispatch_conditions")) {
+    n->dispatch_conditions = Downcast<Array<PrimExpr>>(attrs.at("dispatch_conditions"));
+    CHECK_EQ(n->dispatch_conditions.size() + 1, inputs.size())
+        << "Specializations other than the last one need a dispatch condition";
+    n->dispatch_var = Var(name + "_case", DataType::Int(32));
+  }
+
   n->name = std::move(name);
   n->tag = std::move(tag);
   n->attrs = std::move(attrs);
@@ -188,9 +195,18 @@ Array<Tensor> SpecializationEnvelopeOpNode::InputTensors() const {
       ret.push_back(t);
     }
   }
+  CollectTensors(ret, dispatch_conditions);
   return ret;
 }
 
+PrimExpr SpecializationEnvelopeOpNode::DispatchValue() const {
+  PrimExpr value = IntImm(DataType::Int(32), static_cast<int>(dispatch_conditions.size()));
+  for (int i = static_cast<int>(dispatch_conditions.size()) - 1; i >= 0; --i) {
+    value = SelectNode::make(dispatch_conditions[i], IntImm(DataType::Int(32), i), value);
+  }
+  return value;
+}
+
 Array<Tensor> SpecializationEnvelopeOpNode::InputTensorsWithUnemitted() const {
   return this->InputTensors();
 }
@@ -223,6 +239,8 @@ Operation SpecializationEnvelopeOpNode::ReplaceInputs(
     n->input_ops = GetInputOps(new_inputs);
     n->dim2var_maps = thisNode->dim2var_maps;
     n->spatial_dimensions_ = thisNode->spatial_dimensions_;
+    n->dispatch_conditions = thisNode->dispatch_conditions;
+    n->dispatch_var = thisNode->dispatch_var;
     return Operation(n);
     // return SpecializationEnvelopeOpNode::make(this->name, this->tag, this->attrs, new_inputs);
   } else {
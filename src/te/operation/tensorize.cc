@@ -24,8 +24,11 @@
 #include <tvm/runtime/registry.h>
 #include <tvm/tir/expr.h>
 #include <tvm/tir/ir_pass.h>
+#include <tvm/tir/op.h>
 #include <tvm/tir/stmt_functor.h>
 
+#include <algorithm>
+
 #include "../schedule/message_passing.h"
 #include "compute_op.h"
 #include "op_util.h"
@@ -109,12 +112,23 @@ size_t InferTensorizeRegion(const ComputeOpNode* self, const Stage& stage,
   return loc_scope;
 }
 
-void VerifyTensorizeLoopNest(const ComputeOpNode* self, const Stage& stage,
-                             const ComputeLoopNest& n, size_t tloc) {
+// Predicates of the nest that rely on vars of the tensorized scope.
+// These are the bound checks of ragged loops split by the size of the
+// intrinsic. The intrinsic is applied to the tiles where they hold
+// throughout, and the remaining tiles are computed by scalar code.
+struct TensorizeTail {
+  std::vector<PrimExpr> main_predicates;
+  std::vector<PrimExpr> init_predicates;
+
+  bool defined() const { return !main_predicates.empty() || !init_predicates.empty(); }
+};
+
+void VerifyTensorizeLoopNest(const ComputeOpNode* self, const Stage& stage, ComputeLoopNest* n,
+                             size_t tloc, TensorizeTail* tail) {
   // Veirfication step.
   std::unordered_set<const VarNode*> banned;
-  CHECK_EQ(n.main_nest.size(), stage->leaf_iter_vars.size() + 1);
-  CHECK(n.init_nest.size() == stage->leaf_iter_vars.size() + 1 || n.init_nest.size() == 0);
+  CHECK_EQ(n->main_nest.size(), stage->leaf_iter_vars.size() + 1);
+  CHECK(n->init_nest.size() == stage->leaf_iter_vars.size() + 1 || n->init_nest.size() == 0);
   auto f_push_banned = [&banned](const Stmt& s) {
     if (const ForNode* op = s.as<ForNode>()) {
       banned.insert(op->loop_var.get());
@@ -127,27 +141,116 @@ void VerifyTensorizeLoopNest(const ComputeOpNode* self, const Stage& stage,
     }
   };
   for (size_t i = tloc; i < stage->leaf_iter_vars.size(); ++i) {
-    for (const Stmt& s : n.main_nest[i + 1]) {
+    for (const Stmt& s : n->main_nest[i + 1]) {
       f_push_banned(s);
     }
-    if (n.init_nest.size() != 0) {
-      for (const Stmt& s : n.init_nest[i + 1]) {
+    if (n->init_nest.size() != 0) {
+      for (const Stmt& s : n->init_nest[i + 1]) {
         f_push_banned(s);
       }
     }
   }
-  for (const PrimExpr& pred : n.main_predicates) {
-    if (tir::ExprUseVar(pred, banned)) {
-      LOG(FATAL) << "Tensorize failed, split condition " << pred
-                 << " relies on var defined inside tensorize scope";
+  auto f_split = [&banned](std::vector<PrimExpr>* predicates, std::vector<PrimExpr>* tail) {
+    std::vector<PrimExpr> outer;
+    for (const PrimExpr& pred : *predicates) {
+      if (tir::ExprUseVar(pred, banned)) {
+        tail->push_back(pred);
+      } else {
+        outer.push_back(pred);
+      }
+    }
+    *predicates = std::move(outer);
+  };
+  f_split(&n->main_predicates, &tail->main_predicates);
+  f_split(&n->init_predicates, &tail->init_predicates);
+}
+
+// The condition for the tail predicates to hold throughout the tile
+// whose loops are nest[begin:]. The predicates are bound checks, which
+// are monotonic in the loop vars, so that it is enough to check them at
+// the first and the last point of the tile.
+PrimExpr MakeFullTileCondition(const std::vector<PrimExpr>& predicates,
+                               const std::vector<std::vector<Stmt>>& nest, size_t begin) {
+  std::unordered_set<const VarNode*> tile_vars;
+  std::unordered_map<const VarNode*, PrimExpr> first, last;
+  for (size_t i = begin; i < nest.size(); ++i) {
+    for (const Stmt& s : nest[i]) {
+      if (const ForNode* op = s.as<ForNode>()) {
+        first[op->loop_var.get()] = op->min;
+        last[op->loop_var.get()] = op->min + op->extent - 1;
+      } else if (const AttrStmtNode* op = s.as<AttrStmtNode>()) {
+        if (const IterVarNode* iv = op->node.as<IterVarNode>()) {
+          tile_vars.insert(iv->var.get());
+        }
+      } else if (const LetStmtNode* op = s.as<LetStmtNode>()) {
+        tile_vars.insert(op->var.get());
+      }
     }
   }
-  for (const PrimExpr& pred : n.init_predicates) {
-    if (tir::ExprUseVar(pred, banned)) {
+  PrimExpr full = const_true();
+  for (const PrimExpr& pred : predicates) {
+    PrimExpr at_first = tir::Substitute(pred, first);
+    PrimExpr at_last = tir::Substitute(pred, last);
+    if (tir::ExprUseVar(at_first, tile_vars) || tir::ExprUseVar(at_last, tile_vars)) {
       LOG(FATAL) << "Tensorize failed, split condition " << pred
                  << " relies on var defined inside tensorize scope";
     }
+    full = full && at_first && at_last;
+  }
+  return Simplify(full);
+}
+
+// The scalar computation of a tensorized tile, used for the tiles that
+// the tail predicates cut.
+Stmt MakeTensorizeTail(const ComputeOpNode* self, const Stage& stage,
+                       const std::unordered_map<IterVar, Range>& dom_map, const ComputeLoopNest& n,
+                       size_t tloc, const TensorizeTail& tail) {
+  if (self->reduce_axis.size() == 0) {
+    std::vector<Stmt> provides;
+    for (size_t i = 0; i < self->body.size(); ++i) {
+      provides.emplace_back(MakeProvide(stage, self, dom_map, n.main_vmap, stage->op.output(i)));
+    }
+    std::vector<std::vector<Stmt>> nest(n.main_nest.begin() + tloc + 1, n.main_nest.end());
+    nest.emplace_back(MakeIfNest(tail.main_predicates));
+    return MergeNest(nest, SeqStmt::Flatten(provides));
+  }
+  Stmt init, provide;
+  Array<Tensor> source;
+  for (size_t i = 0; i < self->body.size(); ++i) {
+    source.push_back(stage->op.output(i));
+  }
+  MakeReduction(stage, self, dom_map, source, n.init_vmap, n.main_vmap, &init, &provide);
+  size_t reduce_begin = std::max(tloc, n.num_common_loop) + 1;
+  std::vector<std::vector<Stmt>> reduce(n.main_nest.begin() + reduce_begin, n.main_nest.end());
+  reduce.emplace_back(MakeIfNest(tail.main_predicates));
+  provide = MergeNest(reduce, provide);
+  if (tloc <= n.num_common_loop) {
+    // The tile contains the whole reduction, including its init.
+    std::vector<std::vector<Stmt>> init_nest(n.init_nest.begin() + reduce_begin,
+                                             n.init_nest.end());
+    init_nest.emplace_back(MakeIfNest(tail.init_predicates));
+    init = te::Substitute(MergeNest(init_nest, init), n.init_vmap);
+    std::vector<std::vector<Stmt>> common(n.main_nest.begin() + tloc + 1,
+                                          n.main_nest.begin() + reduce_begin);
+    provide = MergeNest(common, SeqStmt::Flatten(init, provide));
+  }
+  return provide;
+}
+
+// The scalar init of a tensorized tile, used for the tiles that the
+// tail predicates cut.
+Stmt MakeTensorizeInitTail(const ComputeOpNode* self, const Stage& stage,
+                           const std::unordered_map<IterVar, Range>& dom_map,
+                           const ComputeLoopNest& n, size_t tloc, const TensorizeTail& tail) {
+  Stmt init, provide;
+  Array<Tensor> source;
+  for (size_t i = 0; i < self->body.size(); ++i) {
+    source.push_back(stage->op.output(i));
   }
+  MakeReduction(stage, self, dom_map, source, n.init_vmap, n.main_vmap, &init, &provide);
+  std::vector<std::vector<Stmt>> init_nest(n.init_nest.begin() + tloc + 1, n.init_nest.end());
+  init_nest.emplace_back(MakeIfNest(tail.init_predicates));
+  return MergeNest(init_nest, init);
 }
 
 // Remap the tensor placeholder, index and inline things.
@@ -350,7 +453,8 @@ Stmt MakeTensorize(const ComputeOpNode* self, const Stage& stage,
   ComputeLoopNest n =
       ComputeLoopNest::make(self, stage, dom_map, env_dom_map, env_var_map, bind_map, attach_stages,
                             attach_vars, debug_keep_trivial_loop);
-  VerifyTensorizeLoopNest(self, stage, n, tloc);
+  TensorizeTail tail;
+  VerifyTensorizeLoopNest(self, stage, &n, tloc, &tail);
   VerifyTensorizeBody(self, stage, dom_map, out_dom, in_region, intrin);
   // Start bind data.
   Stmt nop = EvaluateNode::make(0);
@@ -430,6 +534,12 @@ Stmt MakeTensorize(const ComputeOpNode* self, const Stage& stage,
     body = tir::Substitute(body, vmap);
     body = MergeNest(binder.asserts(), body);
     body = te::Substitute(body, n.main_vmap);
+    if (tail.defined()) {
+      PrimExpr full_tile = MakeFullTileCondition(tail.main_predicates, n.main_nest, tloc + 1) &&
+                           MakeFullTileCondition(tail.init_predicates, n.init_nest, tloc + 1);
+      body = IfThenElseNode::make(likely(full_tile), body,
+                                  MakeTensorizeTail(self, stage, dom_map, n, tloc, tail));
+    }
     body = MergeNest(nest, body);
     body = te::Substitute(body, n.main_vmap);
     return body;
@@ -456,6 +566,8 @@ Stmt MakeTensorize(const ComputeOpNode* self, const Stage& stage,
     //   }
     // }
 
+    update_nest.emplace_back(MakeIfNest(n.main_predicates));
+
     std::vector<Stmt> flattened;
     for (size_t i = tloc + 1; i < n.main_nest.size(); i++) {
       for (auto stmt : n.main_nest[i]) {
@@ -463,21 +575,36 @@ Stmt MakeTensorize(const ComputeOpNode* self, const Stage& stage,
       }
     }
 
+    std::vector<std::vector<Stmt>> tile_nest;
     for (size_t i = 0; i < flattened.size(); i += 2) {
       auto for_node = flattened[i].as<ForNode>();
       auto attr_node = flattened[i + 1].as<AttrStmtNode>();
       auto iv = Downcast<IterVar>(attr_node->node);
-      update_nest.push_back({AttrStmtNode::make(iv, attr::thread_extent_ragged_simplify,
-                                                for_node->extent, NullValue<Stmt>())});
+      tile_nest.push_back({AttrStmtNode::make(iv, attr::thread_extent_ragged_simplify,
+                                              for_node->extent, NullValue<Stmt>())});
     }
 
-    update_nest.emplace_back(MakeIfNest(n.main_predicates));
+    // Partial tiles of ragged loops fall back to the scalar update.
+    auto f_tail_update = [&](Stmt update) {
+      update = MergeNest(tile_nest, update);
+      if (!tail.main_predicates.empty()) {
+        update = IfThenElseNode::make(
+            likely(MakeFullTileCondition(tail.main_predicates, n.main_nest, tloc + 1)), update,
+            MakeTensorizeTail(self, stage, dom_map, n, tloc, tail));
+      }
+      return update;
+    };
 
     if (intrin->reduce_init.defined()) {
       // init nest
       std::vector<std::vector<Stmt>> init_nest(n.init_nest.begin(), n.init_nest.begin() + tloc + 1);
       init_nest.emplace_back(MakeIfNest(n.init_predicates));
       Stmt init = MergeNest(output_bind_nest, intrin->reduce_init);
+      if (!tail.init_predicates.empty()) {
+        init = IfThenElseNode::make(
+            likely(MakeFullTileCondition(tail.init_predicates, n.init_nest, tloc + 1)), init,
+            MakeTensorizeInitTail(self, stage, dom_map, n, tloc, tail));
+      }
       init = te::Substitute(init, n.init_vmap);
       init = MergeNest(init_nest, init);
       // The update
@@ -498,6 +625,7 @@ Stmt MakeTensorize(const ComputeOpNode* self, const Stage& stage,
       update = te::Substitute(update, n.main_vmap);
       // std::cout << "[TMP]   After " << update << std::endl;
 
+      update = f_tail_update(update);
       update = MergeNest(update_nest, update);
       update = MergeNest(common, SeqStmt::Flatten(init, update));
       update = te::Substitute(update, n.main_vmap);
@@ -505,12 +633,16 @@ Stmt MakeTensorize(const ComputeOpNode* self, const Stage& stage,
     } else {
       // When init op is not available, use body op for reset in the first iter.
       CHECK(intrin->body.defined()) << "Normal body op for intrin " << intrin << " is not defined";
+      CHECK(!tail.defined()) << "Tensorize failed, the tensorized scope of " << self->name
+                             << " has partial tiles, which need the reduce_init of intrin "
+                             << intrin->name;
       Stmt update = TransformUpdate(stage, dom_map, n, intrin->body, intrin->reduce_update);
       update = MergeNest(output_bind_nest, update);
       update = MergeNest(input_bind_nest, update);
       update = tir::Substitute(update, vmap);
       update = MergeNest(binder.asserts(), update);
       update = te::Substitute(update, n.main_vmap);
+      update = f_tail_update(update);
       update = MergeNest(update_nest, update);
       update = MergeNest(common, update);
       update = te::Substitute(update, n.main_vmap);
@@ -24,6 +24,8 @@
 #include <tvm/te/schedule_pass.h>
 #include <tvm/te/operation.h>
 #include <tvm/tir/expr_functor.h>
+#include <tvm/tir/modes.h>
+#include <tvm/tir/uninterp_fun.h>
 
 namespace tvm {
 namespace te {
@@ -32,7 +34,8 @@ using namespace tir;
 
 class ElemWiseDetector : public tir::ExprVisitor {
  public:
-  explicit ElemWiseDetector(Array<IterVar> axis) : axis_(axis) {}
+  explicit ElemWiseDetector(Array<IterVar> axis, Modes loop_layout)
+      : axis_(axis), loop_layout_(loop_layout) {}
 
   void VisitExpr(const PrimExpr& e) final {
     if (!is_elem_wise_) return;
@@ -40,6 +43,12 @@ class ElemWiseDetector : public tir::ExprVisitor {
   }
 
   void VisitExpr_(const CallNode* op) final {
+    // Only tensor accesses need to be at the axis. Calls to the length
+    // functions of ragged dimensions, and intrinsics, are not accesses.
+    if (op->call_type != CallNode::Halide) {
+      ExprVisitor::VisitExpr_(op);
+      return;
+    }
     Array<PrimExpr> axis = op->args;
     if (axis_.size() != axis.size()) {
       is_elem_wise_ = false;
@@ -52,19 +61,43 @@ class ElemWiseDetector : public tir::ExprVisitor {
         return;
       }
     }
+    if (auto producer = op->func.as<OperationNode>()) {
+      if (!MatchesLoopLayout(producer->output_layout(op->value_index))) {
+        is_elem_wise_ = false;
+        return;
+      }
+    }
     ExprVisitor::VisitExpr_(op);
   }
 
   bool is_elem_wise_{true};
 
  private:
+  // Whether the elements of a tensor stored in a ragged layout are
+  // those the loop layout iterates over, i.e. every dimension has the
+  // same width in both.
+  bool MatchesLoopLayout(Modes storage_layout) {
+    if (!storage_layout.defined() || !storage_layout->is_ragged()) return true;
+    if (!loop_layout_.defined()) return false;
+    if (storage_layout->ndim() != loop_layout_->ndim()) return false;
+    for (size_t i = 0; i < storage_layout->ndim(); ++i) {
+      if (!storage_layout->dimensions[i].same_as(loop_layout_->dimensions[i])) return false;
+      UninterpFun storage_width = storage_layout->l_funs[i];
+      UninterpFun loop_width = loop_layout_->l_funs[i];
+      if (storage_width.same_as(loop_width)) continue;
+      if (!storage_width->body.defined() || !loop_width->body.defined()) return false;
+      if (!UninterpFun::CheckEquality(storage_width, loop_width).equals) return false;
+    }
+    return true;
+  }
+
   Array<IterVar> axis_;
+  Modes loop_layout_;
 };
 
-
 bool IsElemWise(const Operation& op) {
   if (const ComputeOpNode* compute = op.as<ComputeOpNode>()) {
-    ElemWiseDetector v = ElemWiseDetector(compute->axis);
+    ElemWiseDetector v = ElemWiseDetector(compute->axis, compute->loop_layout());
     for (auto& e : compute->body) v(e);
     return v.is_elem_wise_;
   }
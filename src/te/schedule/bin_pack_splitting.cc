@@ -183,6 +183,8 @@ Array<Array<Operation>> SplitAGraph(Schedule& sch, Array<Operation> graph_ops,
   std::unordered_map<Tensor, Tensor> graph2_vsub;
   Array<Operation> graph1_ops;
   Array<Operation> graph2_ops;
+  graph1_ops.reserve(graph_ops.size());
+  graph2_ops.reserve(graph_ops.size());
   for (auto op : graph_ops) {
     auto new_ops = SplitALoop(sch, op, to_split_index, split_point, graph1_vsub, graph2_vsub);
     auto graph1_op = new_ops[0];
@@ -191,10 +193,10 @@ Array<Array<Operation>> SplitAGraph(Schedule& sch, Array<Operation> graph_ops,
       graph1_vsub[op.output(i)] = graph1_op.output(i);
       graph2_vsub[op.output(i)] = graph2_op.output(i);
     }
-    graph1_ops.push_back(graph1_op);
-    graph2_ops.push_back(graph2_op);
+    graph1_ops.push_back(std::move(graph1_op));
+    graph2_ops.push_back(std::move(graph2_op));
   }
-  return Array<Array<Operation>>({graph1_ops, graph2_ops});
+  return Array<Array<Operation>>({std::move(graph1_ops), std::move(graph2_ops)});
 }
 
 Array<Array<Operation>> Schedule::split_for_bin_packing(Array<Tensor> input_tensors,
@@ -216,10 +218,11 @@ Array<Array<Operation>> Schedule::split_for_bin_packing(Array<Tensor> input_tens
   Array<Array<Operation>> ops = {graph_ops};
   for (auto it : to_split_indices) {
     Array<Array<Operation>> new_ops;
+    new_ops.reserve(ops.size() * 2);
     for (auto op : ops) {
       new_ops.push_back_all(SplitAGraph(*this, op, it.first, it.second));
     }
-    ops = new_ops;
+    ops = std::move(new_ops);
   }
   return ops;
 }
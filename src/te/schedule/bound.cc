@@ -414,6 +414,7 @@ void InferRootBound(const Stage& stage, const GraphContext& ctx,
 }
 
 InferBoundsResult InferBound(const Schedule& sch) {
+  const_cast<Schedule&>(sch)->EnsurePostOrder();
   CheckSchedule(const_cast<Schedule&>(sch), "bound.cc:238");
 
   // Prepare context
@@ -560,7 +561,41 @@ InferBoundsResult InferBound(const Schedule& sch) {
                                      env_vars);
 }
 
+// The root iter vars of stages whose ragged extent is not provably
+// bounded by the inferred one, which is then that of both the loops
+// over the iter var and the allocation of the stage. Those are
+// usually left with a dense extent by a relaxation, as when a stage is
+// attached outside of the loop its extent depends on.
+Array<Array<ObjectRef>> DiagnoseRaggedBounds(const Schedule& sch,
+                                             const InferBoundsResult& bounds) {
+  arith::Analyzer analyzer;
+  std::unordered_set<const VarNode*> bound_vars;
+  for (const auto& it : bounds->bounds) {
+    if (bound_vars.insert(it.first->var.get()).second) {
+      analyzer.Bind(it.first->var, it.second);
+    }
+  }
+
+  Array<Array<ObjectRef>> ret;
+  for (Stage stage : sch->stages) {
+    if (stage->attach_type == kInline || stage->attach_type == kInlinedAlready) continue;
+    // The bounds of these are their domains.
+    if (stage->is_output || stage->op.as<PlaceholderOpNode>()) continue;
+    for (const auto& iv : stage->op->root_iter_vars()) {
+      if (!iv->dom.defined() || iv->dom->extent.as<IntImmNode>()) continue;
+      if (!bounds->bounds.count(iv)) continue;
+      Range inferred = bounds->bounds.at(iv);
+      PrimExpr proof = inferred->extent <= iv->dom->extent;
+      if (analyzer.CanProve(proof)) continue;
+      ret.push_back({stage->op, iv, iv->dom, inferred, proof});
+    }
+  }
+  return ret;
+}
+
 TVM_REGISTER_GLOBAL("schedule.InferBound").set_body_typed(InferBound);
 
+TVM_REGISTER_GLOBAL("schedule.DiagnoseRaggedBounds").set_body_typed(DiagnoseRaggedBounds);
+
 }  // namespace te
 }  // namespace tvm
@@ -6,6 +6,7 @@
 #include <tvm/tir/stmt_functor.h>
 
 #include <unordered_set>
+#include <utility>
 
 #include "../../arith/compute_expr.h"
 #include "../../tir/ir/var_replacer.h"
@@ -82,6 +83,40 @@ std::pair<PrimExpr, PrimExpr> CacheBodyBuilder(Tensor tensor, const Array<Operat
   return std::make_pair(body, ana.Simplify(cachePred));
 }
 
+// Whether a reader accesses the tensor across its rows, i.e. with the
+// variable of its innermost axis, to which threadIdx.x is usually
+// bound, in an index other than the last one. Consecutive threads then
+// read elements a row stride apart.
+static bool HasTransposedAccess(const PatternsVec& patterns) {
+  for (auto pattern : patterns) {
+    if (pattern->ufun || !pattern->reader_op->IsInstance<ComputeOpNode>()) continue;
+    auto reader = static_cast<const ComputeOpNode*>(pattern->reader_op);
+    if (reader->axis.size() == 0) continue;
+    Var inner = reader->axis[reader->axis.size() - 1]->var;
+    const Array<PrimExpr>& args = pattern->original_access->args;
+    if (args.size() < 2 || ExprUseVar(args[args.size() - 1], inner)) continue;
+    for (size_t i = 0; i < args.size() - 1; ++i) {
+      if (ExprUseVar(args[i], inner)) return true;
+    }
+  }
+  return false;
+}
+
+// Pad the rows of a shared memory cache, so that the row stride is
+// odd in units of the bank width when it is accessed across its rows.
+// The cache is laid out as (..., row, column, variant), so the padded
+// dimension is the one before the last original dimension.
+static void PadSharedMemoryBanks(Stage cache_stage, const Tensor& cache,
+                                 const PatternsVec& patterns) {
+  if (cache_stage->scope != "shared" || !HasTransposedAccess(patterns)) return;
+  const Array<Dimension>& dims = cache_stage->dim_relation_graph->leaf_dimensions;
+  int bits = cache->dtype.bits() * cache->dtype.lanes();
+  if (dims.size() < 3 || bits > 32) return;
+  // 32 banks, each 4 bytes wide.
+  int factor = 32 * 32 / bits;
+  cache_stage->align_info[dims[dims.size() - 3].as<DimensionNode>()] = std::make_pair(factor, 1);
+}
+
 Tensor CacheReadOpaqueInternal(Schedule& sch, const Tensor& tensor, const std::string& scope,
                                const Array<Operation>& readers, const std::string& suffix) {
   CheckSchedule(sch, "cache_read_opaque.cc:184_start_" + tensor->op->name);
@@ -276,6 +311,7 @@ Tensor CacheReadOpaqueInternal(Schedule& sch, const Tensor& tensor, const std::s
   CHECK_LT(pos, stages->data.size());
   stages->data.insert(stages->data.begin() + pos + 1, cache_stage);
   sch->stage_map.Set(cache->op, cache_stage);
+  PadSharedMemoryBanks(cache_stage, cache, patterns_vec);
   // Update group
   cache_stage->group = op_stage->group;
   if (cache_stage->group.defined()) {
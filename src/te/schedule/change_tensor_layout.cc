@@ -1,8 +1,10 @@
 #include <tvm/te/operation.h>
 #include <tvm/te/schedule.h>
+#include <tvm/tir/ir_pass.h>
 #include <tvm/tir/stmt_functor.h>
 
 #include <algorithm>
+#include <unordered_set>
 
 #include "graph.h"
 #include "message_passing.h"
@@ -46,9 +48,60 @@ Array<Range> ComputeRealizeBounds(const Stage& stage, const ComputeOpNode* compu
   return new_shape;
 }
 
-void Schedule::freeze_tensor_dimensions(const Map<IterVar, Range>& dom_map) {
-  Schedule& sch = *this;
+// Replaces, in the readers of the stage s, accesses to old_op by
+// accesses to s->op in the leaf layout of s.
+void ReplaceAccessesInReaders(Schedule& sch, Stage s, Operation old_op,
+                              const Map<IterVar, Range>& dom_map, Array<Modes> root_layouts) {
   auto feed_graph = GetFeedGraph(sch, true);
+  // CheckSchedule(sch, "change_tensor_layout.cc:269", false);
+
+  if (!feed_graph.count(old_op.output(0))) {
+    for (auto it : feed_graph) {
+      std::cout << "[FG] " << it.first->op << " " << old_op << std::endl;
+    }
+  }
+  CHECK(feed_graph.count(old_op.output(0))) << old_op;
+  auto readers = Array<Operation>(feed_graph.at(old_op.output(0)));
+
+  std::unordered_map<Tensor, Tensor> vmap;
+  std::unordered_map<Tensor, Tensor> rvmap;
+  sch->InvalidateCache();
+  sch->InitCache();
+  auto& op2stage_ = sch->op2stage_cache_;
+  for (Operation op : readers) {
+    // std::cout << "[CTD]   Reader " << op << std::endl;
+    Stage op_stage = op2stage_.at(op.get());
+    Operation repl_op = ReplaceInputsGeneral(s, old_op, s->op, op, dom_map, root_layouts);
+    // CHECK(!repl_op.same_as(op_stage->op))
+    // << "Cannot find tensor " << s->op << " in the inputs to " << repl_op;
+    if (!repl_op.same_as(op_stage->op)) {
+      for (size_t i = 0; i < static_cast<size_t>(op_stage->op->num_outputs()); ++i) {
+        vmap[op_stage->op.output(i)] = repl_op.output(i);
+        rvmap[repl_op.output(i)] = op_stage->op.output(i);
+      }
+      op_stage->op = repl_op;
+    }
+  }
+  ReplaceDataFlow(sch->stages, sch->cacheTensorInfos, &vmap, &rvmap);
+}
+
+// Whether accesses to the compute op need to carry their own realize
+// bounds, which is the case when the realize bounds of the op depend
+// on its own axes. Otherwise, the bounds of the buffer are the same.
+bool NeedsAccessRealizeBounds(const ComputeOpNode* compute_op) {
+  std::unordered_set<const VarNode*> axis_vars;
+  for (const auto& iv : compute_op->axis) {
+    axis_vars.insert(iv->var.get());
+  }
+  for (const auto& r : compute_op->realize_bounds) {
+    if (ExprUseVar(r->min, axis_vars)) return true;
+  }
+  return false;
+}
+
+Array<Stage> Schedule::freeze_tensor_dimensions(const Map<IterVar, Range>& dom_map) {
+  Schedule& sch = *this;
+  Array<Stage> changed_stages;
 
   sch->InvalidateCache();
   sch->InitCache();
@@ -66,56 +119,31 @@ void Schedule::freeze_tensor_dimensions(const Map<IterVar, Range>& dom_map) {
       mutable_compute_op->set_realize_bounds(ComputeRealizeBounds(s, compute_op, dom_map),
                                              "change_tensor_layout.cc:185");
 
+      // Only the stages whose layouts were changed, or whose accesses
+      // need their own realize bounds, need their readers rewritten.
+      bool changed = s->dim_relation_graph->IsChanged();
+      if (!changed && !NeedsAccessRealizeBounds(compute_op)) continue;
+
       auto root_layouts = compute_op->storage_layouts;
-      for (size_t i = 0; i < static_cast<size_t>(compute_op->num_outputs()); ++i) {
-        if (root_layouts.size() > 0) {
-          Modes leaf_layout = DimensionPassDownModes(s, compute_op, root_layouts[i]);
-          if (leaf_layout.defined()) {
-            mutable_compute_op->set_storage_layout(i, leaf_layout);
+      if (changed) {
+        for (size_t i = 0; i < static_cast<size_t>(compute_op->num_outputs()); ++i) {
+          if (root_layouts.size() > 0) {
+            Modes leaf_layout = DimensionPassDownModes(s, compute_op, root_layouts[i]);
+            if (leaf_layout.defined()) {
+              mutable_compute_op->set_storage_layout(i, leaf_layout);
+            }
           }
         }
+        changed_stages.push_back(s);
       }
 
       if (s->is_output) continue;
-      feed_graph = GetFeedGraph(sch, true);
-      // CheckSchedule(sch, "change_tensor_layout.cc:269", false);
-
-      if (!feed_graph.count(old_op.output(0))) {
-        for (auto it : feed_graph) {
-          std::cout << "[FG] " << it.first->op << " " << old_op << std::endl;
-        }
-      }
-      CHECK(feed_graph.count(old_op.output(0))) << old_op;
-      auto readers = Array<Operation>(feed_graph.at(old_op.output(0)));
-
-      std::unordered_map<Tensor, Tensor> vmap;
-      std::unordered_map<Tensor, Tensor> rvmap;
-      sch->InvalidateCache();
-      sch->InitCache();
-      auto& op2stage_ = sch->op2stage_cache_;
-      for (Operation op : readers) {
-        // std::cout << "[CTD]   Reader " << op << std::endl;
-        Stage op_stage = op2stage_.at(op.get());
-        Operation repl_op = ReplaceInputsGeneral(s, old_op, s->op, op, dom_map, root_layouts);
-        // CHECK(!repl_op.same_as(op_stage->op))
-        // << "Cannot find tensor " << s->op << " in the inputs to " << repl_op;
-        if (!repl_op.same_as(op_stage->op)) {
-          for (size_t i = 0; i < static_cast<size_t>(op_stage->op->num_outputs()); ++i) {
-            vmap[op_stage->op.output(i)] = repl_op.output(i);
-            rvmap[repl_op.output(i)] = op_stage->op.output(i);
-          }
-          op_stage->op = repl_op;
-        }
-      }
-      ReplaceDataFlow(sch->stages, sch->cacheTensorInfos, &vmap, &rvmap);
-
-      // Refresh the feed graph
-      feed_graph = GetFeedGraph(sch, true);
-      continue;
+      ReplaceAccessesInReaders(sch, s, old_op, dom_map, root_layouts);
     } else if (auto placeholder_op = s->op.as<PlaceholderOpNode>()) {
       Operation old_op = s->op;
 
-      if (placeholder_op->self_index_dimensions.size() == 0) {
+      if (placeholder_op->self_index_dimensions.size() == 0 ||
+          !s->dim_relation_graph->IsChanged()) {
         continue;
       }
 
@@ -129,44 +157,12 @@ void Schedule::freeze_tensor_dimensions(const Map<IterVar, Range>& dom_map) {
           mutable_placeholder_op->set_storage_layout(leaf_layout);
         }
       }
+      changed_stages.push_back(s);
 
-      feed_graph = GetFeedGraph(sch, true);
-      // CheckSchedule(sch, "change_tensor_layout.cc:269", false);
-
-      if (!feed_graph.count(old_op.output(0))) {
-        for (auto it : feed_graph) {
-          std::cout << "[FG] " << it.first->op << " " << old_op << std::endl;
-        }
-      }
-      CHECK(feed_graph.count(old_op.output(0))) << old_op;
-      auto readers = Array<Operation>(feed_graph.at(old_op.output(0)));
-
-      std::unordered_map<Tensor, Tensor> vmap;
-      std::unordered_map<Tensor, Tensor> rvmap;
-      sch->InvalidateCache();
-      sch->InitCache();
-      auto& op2stage_ = sch->op2stage_cache_;
-      for (Operation op : readers) {
-        // std::cout << "[CTD]   Reader " << op << std::endl;
-        Stage op_stage = op2stage_.at(op.get());
-        Operation repl_op = ReplaceInputsGeneral(s, old_op, s->op, op, dom_map, {root_layout});
-        // CHECK(!repl_op.same_as(op_stage->op))
-        // << "Cannot find tensor " << s->op << " in the inputs to " << repl_op;
-        if (!repl_op.same_as(op_stage->op)) {
-          for (size_t i = 0; i < static_cast<size_t>(op_stage->op->num_outputs()); ++i) {
-            vmap[op_stage->op.output(i)] = repl_op.output(i);
-            rvmap[repl_op.output(i)] = op_stage->op.output(i);
-          }
-          op_stage->op = repl_op;
-        }
-      }
-      ReplaceDataFlow(sch->stages, sch->cacheTensorInfos, &vmap, &rvmap);
-
-      // Refresh the feed graph
-      feed_graph = GetFeedGraph(sch, true);
-      continue;
+      ReplaceAccessesInReaders(sch, s, old_op, dom_map, {root_layout});
     }
   }
+  return changed_stages;
 }
 
 Tensor Schedule::split_tensor_dimension(const Tensor& tensor, const size_t dim_idx,
@@ -176,6 +172,18 @@ Tensor Schedule::split_tensor_dimension(const Tensor& tensor, const size_t dim_i
   CHECK(bvd_op) << "Layout changes allowed only for ComputeOp";
   CHECK(dim_idx < s->dim_relation_graph->leaf_dimensions.size());
   Dimension parent = s->dim_relation_graph->leaf_dimensions[dim_idx];
+  // A ragged dimension can be split, in which case its outer
+  // dimension is ragged as well, but the dimensions the lengths of
+  // ragged dimensions depend on cannot, as the lengths would then
+  // depend on two dimensions.
+  Modes layout = tensor->op->output_layout(tensor->value_index);
+  if (layout.defined()) {
+    size_t idx = layout->dimensions.GetIdx(parent);
+    CHECK(idx == layout->dimensions.size() || !layout->has_dependent_dims(idx))
+        << "Cannot split the dimension " << parent << " of " << tensor
+        << " as the ragged dimensions " << layout->get_immediate_dependent_dims(idx)
+        << " depend on it.";
+  }
   auto parent_lfs = GetLFunction(s.operator->(), parent, false, tensor->value_index);
   Dimension inner = Dimension::get_or_create_dimension(
       DimKey::SplitInnerKey(parent, parent_lfs.first, parent_lfs.second));
@@ -306,7 +314,9 @@ Tensor Schedule::reorder_tensor_dimensions(const Tensor& tensor, const size_t di
   Dimension dim1 = s->dim_relation_graph->leaf_dimensions[dim_idx1];
   Dimension dim2 = s->dim_relation_graph->leaf_dimensions[dim_idx2];
 
-  CHECK(verify_dimension_order(s, {dim2, dim1}));
+  CHECK(verify_dimension_order(s, {dim2, dim1}))
+      << "Cannot reorder the dimensions " << dim1 << " and " << dim2 << " of " << tensor
+      << " as the extent of " << dim2 << " depends on " << dim1 << ".";
 
   auto leaf_dims = s->dim_relation_graph->leaf_dimensions.CopyOnWrite();
   size_t pos1 = std::distance(leaf_dims->data.begin(),
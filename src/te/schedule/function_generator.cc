@@ -1,5 +1,7 @@
 #include "function_generator.h"
 
+#include <dmlc/common.h>
+#include <tvm/arith/pattern.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/te/operation.h>
 #include <tvm/te/schedule_pass.h>
@@ -7,6 +9,8 @@
 #include <tvm/tir/ir_pass.h>
 #include <tvm/tir/stmt_functor.h>
 
+#include <functional>
+#include <limits>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -20,53 +24,230 @@ namespace te {
 
 Buffer AllocationAggregator::create_buffer(Array<PrimExpr> extents, DataType buf_dtype,
                                            std::string name) {
-  CHECK_EQ(buf_dtype, dtype);
-  Buffer buf = BufferNode::make(aggregate_buffer_var, dtype, extents, {}, aggregate_allocated_size,
-                                name, "global", 0, 0, kDefault, kAll);
+  CHECK(buf_dtype.is_int() || buf_dtype.is_uint()) << buf_dtype;
+  CHECK_EQ(buf_dtype.lanes(), 1);
+  CHECK_EQ(dtype.bits() % buf_dtype.bits(), 0) << buf_dtype << " " << dtype;
+  // Buffers narrower than the aggregate are packed into its elements
+  int pack_factor = dtype.bits() / buf_dtype.bits();
+  Buffer buf = BufferNode::make(aggregate_buffer_var, buf_dtype, extents, {},
+                                aggregate_allocated_size * pack_factor, name, "global", 0, 0,
+                                kDefault, kAll);
   PrimExpr size = 1;
   for (auto ext : extents) {
     size = size * ext;
   }
+  if (pack_factor > 1) {
+    size = indexdiv(size + pack_factor - 1, pack_factor);
+  }
   aggregate_allocated_size = aggregate_allocated_size + size;
   return buf;
 }
 
+// The narrowest integer type that can hold all values of an auxiliary
+// array, given an exclusive upper bound on the (non-negative)
+// values. Falls back to int32 if no constant bound can be proven.
+DataType NarrowestAuxDType(PrimExpr max_exclusive) {
+  arith::Analyzer analyzer;
+  auto bound = analyzer.const_int_bound(
+      Simplify(UninterpFun::InlineUninterpFunCalls(max_exclusive)));
+  if (bound->max_value <= 256) {
+    return DataType::UInt(8);
+  } else if (bound->max_value <= 65536) {
+    return DataType::UInt(16);
+  }
+  return DataType::Int(32);
+}
+
+// Auxiliary arrays may be stored in narrower types than int32, so
+// loads from and stores to them go through these conversions.
+PrimExpr load_aux(const Buffer& buf, PrimExpr idx) {
+  return cast(DataType::Int(32), buf.vload({idx}, buf->dtype));
+}
+
+Stmt store_aux(const Buffer& buf, PrimExpr idx, PrimExpr value) {
+  return buf.vstore({idx}, cast(buf->dtype, value));
+}
+
 Buffer AllocationAggregator::aggregate_buffer() {
   return BufferNode::make(aggregate_buffer_var, dtype, {aggregate_allocated_size}, {}, 0,
                           aggregate_name, "global", 0, 0, kDefault, kAll);
 }
 
-size_t AFunctionGenerator::FunKeyHasher::operator()(const FunKey& pattern) const {
-  size_t hash = std::hash<const Object*>{}(pattern.dimension.get());
+// Number of threads per block used by the prep code kernels when the
+// prep code is generated on the device.
+constexpr int kPrepCodeDeviceThreads = 64;
+
+Stmt MakePrepCodeKernel(Stmt body, PrimExpr num_blocks, PrimExpr num_threads,
+                        IterVar* p_block_iv = nullptr, IterVar* p_thread_iv = nullptr) {
+  IterVar block_iv = p_block_iv ? *p_block_iv : thread_axis(Range(0, num_blocks), "blockIdx.x");
+  IterVar thread_iv =
+      p_thread_iv ? *p_thread_iv : thread_axis(Range(0, num_threads), "threadIdx.x");
+  body = AttrStmtNode::make(thread_iv, attr::thread_extent, num_threads, body);
+  return AttrStmtNode::make(block_iv, attr::thread_extent, num_blocks, body);
+}
+
+Stmt AllocateCounter(Buffer counter, Stmt body, std::string scope) {
+  return AttrStmtNode::make(counter->data, attr::storage_scope, StringImmNode::make(scope),
+                            AllocateNode::make(counter->data, DataType::Int(32), {1},
+                                               IntImm(DataType::Bool(1), 1), body));
+}
+
+Stmt SyncShared() {
+  return EvaluateNode::make(CallNode::make(DataType::Int(32), intrinsic::tvm_storage_sync,
+                                           {StringImmNode::make("shared")}, CallNode::Intrinsic));
+}
 
-  for (auto dim : pattern.dependent_dimensions) {
-    hash ^= std::hash<const Object*>{}(dim);
+// A device kernel storing the exclusive prefix sums of summand, a
+// function of loop_var, over [0, extent) with store, and their total
+// at extent if store_total. It runs in one thread block: every thread
+// sums a contiguous chunk, the chunk sums are scanned in shared memory
+// and every thread then stores the prefix sums of its chunk.
+Stmt MakeDeviceScanKernel(std::string prefix, Var loop_var, PrimExpr extent, PrimExpr summand,
+                          std::function<Stmt(PrimExpr, PrimExpr)> store, bool store_total) {
+  DataType dtype = DataType::Int(32);
+  IterVar block_iv = thread_axis(Range(0, 1), "blockIdx.x");
+  IterVar thread_iv = thread_axis(Range(0, kPrepCodeDeviceThreads), "threadIdx.x");
+  Var tx = thread_iv->var;
+  Buffer acc = decl_buffer({1}, dtype, prefix + "acc");
+  Buffer partials = decl_buffer({kPrepCodeDeviceThreads}, dtype, prefix + "partials");
+  PrimExpr acc_load = acc.vload({0}, dtype);
+  PrimExpr chunk = floordiv(extent + kPrepCodeDeviceThreads - 1, kPrepCodeDeviceThreads);
+
+  auto chunk_loop = [&](std::string name, std::function<Stmt(PrimExpr)> body) {
+    Var j = Var(prefix + name, dtype);
+    PrimExpr i = tx * chunk + j;
+    return ForNode::make(j, 0, chunk, ForType::Serial, DeviceAPI::None,
+                         IfThenElseNode::make(i < extent, body(i)));
+  };
+  auto summand_at = [&](PrimExpr i) { return VarReplacer({{loop_var.get(), i}})(summand); };
+
+  Stmt chunk_sum = SeqStmt(
+      {acc.vstore({0}, 0),
+       chunk_loop("j0", [&](PrimExpr i) { return acc.vstore({0}, acc_load + summand_at(i)); }),
+       partials.vstore({tx}, acc_load)});
+
+  Var t = Var(prefix + "t", dtype);
+  PrimExpr partial_load = partials.vload({t}, dtype);
+  // The old partial is read again after acc is updated.
+  Stmt scan_partials =
+      ForNode::make(t, 0, kPrepCodeDeviceThreads, ForType::Serial, DeviceAPI::None,
+                    SeqStmt({acc.vstore({0}, acc_load + partial_load),
+                             partials.vstore({t}, acc_load - partial_load)}));
+  scan_partials = SeqStmt({acc.vstore({0}, 0), scan_partials});
+  if (store_total) scan_partials = SeqStmt({scan_partials, store(extent, acc_load)});
+  scan_partials = IfThenElseNode::make(tx == 0, scan_partials);
+
+  Stmt chunk_store = SeqStmt(
+      {acc.vstore({0}, partials.vload({tx}, dtype)), chunk_loop("j1", [&](PrimExpr i) {
+         return SeqStmt({store(i, acc_load), acc.vstore({0}, acc_load + summand_at(i))});
+       })});
+
+  Stmt body = SeqStmt({chunk_sum, SyncShared(), scan_partials, SyncShared(), chunk_store});
+  body = AllocateCounter(acc, body, "local");
+  body = AttrStmtNode::make(partials->data, attr::storage_scope, StringImmNode::make("shared"),
+                            AllocateNode::make(partials->data, dtype, {kPrepCodeDeviceThreads},
+                                               IntImm(DataType::Bool(1), 1), body));
+  return MakePrepCodeKernel(body, 1, kPrepCodeDeviceThreads, &block_iv, &thread_iv);
+}
+
+// Hashes the body of an l_fun consistently with
+// l_funs_structurally_equal below, which matches variables by their
+// position and lets calls refer to different cache tensors of the same
+// tensor. Neither variables nor calls therefore contribute more than
+// their kind.
+class LFunBodyHasher : public ExprVisitor {
+ public:
+  size_t Hash(const PrimExpr& body) {
+    hash_ = 0;
+    VisitExpr(body);
+    return hash_;
+  }
+
+  void VisitExpr(const PrimExpr& e) final {
+    hash_ = dmlc::HashCombine(hash_, e->type_index());
+    ExprVisitor::VisitExpr(e);
   }
 
-  return hash;
+  void VisitExpr_(const IntImmNode* op) final { hash_ = dmlc::HashCombine(hash_, op->value); }
+
+  void VisitExpr_(const CallNode* op) final {}
+
+ private:
+  size_t hash_{0};
+};
+
+// As keys are compared structurally below, keys for different
+// dimensions may be equal. The hash therefore cannot depend on object
+// identities, and combines the bodies of the dependent l_funs in an
+// order independent way instead.
+size_t AFunctionGenerator::FunKeyHasher::operator()(const FunKey& pattern) const {
+  LFunBodyHasher hasher;
+  size_t l_funs_hash = 0;
+  for (const auto& l_fun : pattern.dependent_l_funs) {
+    if (!l_fun.defined() || !l_fun->body.defined()) continue;
+    l_funs_hash += dmlc::HashCombine(hasher.Hash(l_fun->body), l_fun->arity());
+  }
+  return dmlc::HashCombine(std::hash<size_t>{}(pattern.dependent_l_funs.size()), l_funs_hash);
+}
+
+bool l_funs_structurally_equal(const UninterpFun& lf1, const UninterpFun& lf2) {
+  if (lf1 == lf2) return true;
+  if (!lf1->body.defined() || !lf2->body.defined()) return false;
+  if (lf1->arity() != lf2->arity()) return false;
+  return UninterpFun::CheckEquality(lf1, lf2).equals;
 }
 
-// TODO: Consider using the associated l_funs to determine dependent
-// dimension equality as multiple dimensions might have the same
-// l_funs
+// Two keys are equal either if they refer to the same dimension with
+// the same dependent l_funs, or if the dimensions have the same extent
+// and the dependent l_funs are structurally equal. The latter allows
+// sharing a prefix sum array among different dimensions (say of
+// different tensors) driven by the same lengths.
 bool AFunctionGenerator::FunKeyEquality::operator()(const FunKey& p1, const FunKey& p2) const {
-  if (p1.dimension != p2.dimension) return false;
-  return (p1.dependent_dimensions == p2.dependent_dimensions);
+  if (p1.dimension == p2.dimension && p1.dependent_dimensions == p2.dependent_dimensions) {
+    return true;
+  }
+  if (p1.dependent_l_funs.size() != p2.dependent_l_funs.size()) return false;
+  if (!p1.extent.defined() || !p2.extent.defined()) return false;
+  if (!is_zero(Simplify(p1.extent - p2.extent))) return false;
+
+  std::vector<bool> matched(p2.dependent_l_funs.size(), false);
+  for (auto lf1 : p1.dependent_l_funs) {
+    bool found = false;
+    for (size_t j = 0; j < p2.dependent_l_funs.size(); ++j) {
+      if (!matched[j] && l_funs_structurally_equal(lf1, p2.dependent_l_funs[j])) {
+        matched[j] = true;
+        found = true;
+        break;
+      }
+    }
+    if (!found) return false;
+  }
+  return true;
 }
 
 AFunctionGenerator::FunKey make_key(const Modes& layout, const int& idx) {
   // std::cout << "[AFG] Making key " << layout->dimensions[idx] << std::endl;
   auto transitive_dependent_dims = layout->get_transitive_dependent_dims(idx);
   std::multiset<const Object*> transitive_dependent_dims_set;
+  Array<UninterpFun> dependent_l_funs;
   for (auto dim : transitive_dependent_dims) {
     auto l_fun = layout->l_funs[layout->dimensions.GetIdx(dim)];
     // std::cout << "[ADep " << dim << " " << l_fun << std::endl;
     transitive_dependent_dims_set.insert(l_fun.get());
+    dependent_l_funs.push_back(l_fun);
   }
-  return {layout->dimensions[idx], transitive_dependent_dims_set};
+  PrimExpr extent = layout->l_funs[idx]->range.defined()
+                        ? layout->l_funs[idx]->range->max_inclusive()
+                        : NullValue<PrimExpr>();
+  return {layout->dimensions[idx], transitive_dependent_dims_set, dependent_l_funs, extent};
 }
 
-Stmt AFunctionGenerator::Generate() {
+Stmt AFunctionGenerator::Generate() { return Generate(sch->stages, true); }
+
+Stmt AFunctionGenerator::Generate(const Array<Stage>& stages) { return Generate(stages, false); }
+
+Stmt AFunctionGenerator::Generate(const Array<Stage>& stages, bool include_buffers) {
+  stmts = {};
   auto lambda1 = [this](Modes layout) {
     if (layout.defined()) {
       for (size_t i = 0; i < layout->ndim(); ++i) {
@@ -101,15 +282,17 @@ Stmt AFunctionGenerator::Generate() {
     }
   };
 
-  for (Stage s : sch->stages) {
+  for (Stage s : stages) {
     for (size_t i = 0; i < static_cast<size_t>(s->op->num_outputs()); ++i) {
       lambda2(s->op->output_layout(i));
     }
   }
 
-  for (Buffer b : afuns_needed_for) {
-    if (b->shape->is_ragged()) {
-      lambda2(b->shape);
+  if (include_buffers) {
+    for (Buffer b : afuns_needed_for) {
+      if (b->shape->is_ragged()) {
+        lambda2(b->shape);
+      }
     }
   }
 
@@ -129,6 +312,21 @@ void copy_body_to_ufun_shell(UninterpFun fun, UninterpFun shell) {
   const_cast<UninterpFunNode*>(shell.as<UninterpFunNode>())->SetRange(fun->range);
 }
 
+// If the summand of an A-function is affine in the loop variable (as
+// with constant lengths, or the lengths i + 1 of a triangular layout),
+// the prefix sum has a closed form and need not be materialized in an
+// array. Returns the closed form in terms of param, or an undefined
+// expression otherwise.
+PrimExpr closed_form_prefix_sum(PrimExpr summand, Var loop_var, Var param) {
+  PrimExpr inlined = Simplify(UninterpFun::InlineUninterpFunCalls(summand));
+  Array<PrimExpr> coeffs = arith::DetectLinearEquation(inlined, {loop_var});
+  if (coeffs.size() != 2) return NullValue<PrimExpr>();
+  PrimExpr slope = coeffs[0];
+  PrimExpr intercept = coeffs[1];
+  // sum_{k = 0}^{param - 1} (slope * k + intercept)
+  return Simplify(slope * indexdiv(param * (param - 1), 2) + intercept * param);
+}
+
 UninterpFun AFunctionGenerator::set_afun(Modes layout, int idx, UninterpFun afun_shell) {
   // std::cout << "[AFG] Wanting to generate body for " << afun_shell << " " <<
   // layout->dimensions[idx]
@@ -164,35 +362,50 @@ UninterpFun AFunctionGenerator::set_afun(Modes layout, int idx, UninterpFun afun
       }
     }
 
+    CHECK_EQ(afun_shell->parameters.size(), 1);
+    Var param = afun_shell->parameters[0];
+    PrimExpr closed_form = closed_form_prefix_sum(body_expr, loop_var, param);
+    if (closed_form.defined()) {
+      // std::cout << "[AFG]   Closed form for " << afun_shell << " " << closed_form << std::endl;
+      if (debug_fill_function_bodies) {
+        const_cast<UninterpFunNode*>(afun_shell.as<UninterpFunNode>())->SetBody(closed_form);
+      }
+      dim_afun_map[key] = afun_shell;
+      return afun_shell;
+    }
+
     PrimExpr loop_extent = layout->l_funs[idx]->range->max_inclusive();
     PrimExpr buf_extent = loop_extent + 1;
     // std::cout << "[ASDC]   Buffer range " << layout->l_funs[idx]->range << std::endl;
     auto buffer_pair = agg_pair.create_buffer_pair({buf_extent}, DataType::Int(32), prefix);
     Buffer afun_buffer_host = buffer_pair.first;
     Buffer afun_buffer_dev = buffer_pair.second;
+    Buffer afun_buffer_out = gen_on_device ? afun_buffer_dev : afun_buffer_host;
     Buffer afun_counter = decl_buffer({1}, DataType::Int(32), prefix + "ctr");
 
-    Stmt fun_store =
-        afun_buffer_host.vstore({loop_var}, afun_counter.vload({0}, DataType::Int(32)));
-    Stmt counter_incr =
-        afun_counter.vstore({0}, afun_counter.vload({0}, DataType::Int(32)) + body_expr);
-    SeqStmt loop_stmts = SeqStmt({fun_store, counter_incr});
-    Stmt stmt =
-        ForNode::make(loop_var, 0, loop_extent, ForType::Serial, DeviceAPI::None, loop_stmts);
-
-    Stmt counter_init = afun_counter.vstore({0}, 0);
-    Stmt last_element =
-        afun_buffer_host.vstore({loop_extent}, afun_counter.vload({0}, DataType::Int(32)));
-    stmt = SeqStmt({counter_init, stmt, last_element});
-
-    stmt =
-        AttrStmtNode::make(afun_counter->data, attr::storage_scope, StringImmNode::make("global"),
-                           AllocateNode::make(afun_counter->data, DataType::Int(32), {1},
-                                              IntImm(DataType::Bool(1), 1), stmt));
+    Stmt stmt;
+    if (gen_on_device) {
+      // Writing the result directly into the device buffer avoids the
+      // host to device copy.
+      stmt = MakeDeviceScanKernel(
+          prefix, loop_var, loop_extent, body_expr,
+          [&](PrimExpr i, PrimExpr val) { return afun_buffer_out.vstore({i}, val); }, true);
+    } else {
+      Stmt fun_store =
+          afun_buffer_out.vstore({loop_var}, afun_counter.vload({0}, DataType::Int(32)));
+      Stmt counter_incr =
+          afun_counter.vstore({0}, afun_counter.vload({0}, DataType::Int(32)) + body_expr);
+      SeqStmt loop_stmts = SeqStmt({fun_store, counter_incr});
+      stmt = ForNode::make(loop_var, 0, loop_extent, ForType::Serial, DeviceAPI::None, loop_stmts);
+
+      Stmt counter_init = afun_counter.vstore({0}, 0);
+      Stmt last_element =
+          afun_buffer_out.vstore({loop_extent}, afun_counter.vload({0}, DataType::Int(32)));
+      stmt = SeqStmt({counter_init, stmt, last_element});
+      stmt = AllocateCounter(afun_counter, stmt, "global");
+    }
     stmts.push_back(stmt);
 
-    CHECK_EQ(afun_shell->parameters.size(), 1);
-    Var param = afun_shell->parameters[0];
     if (debug_fill_function_bodies) {
       // std::cout << "[FG] Setting body for " << afun_shell << std::endl;
       const_cast<UninterpFunNode*>(afun_shell.as<UninterpFunNode>())
@@ -218,6 +431,35 @@ bool is_constant(PrimExpr expr, Array<IterVar> iter_vars) {
   return true;
 }
 
+// The number of steps of the binary search over the start positions
+// of outer iterations in the fused space, or -1 if there is no
+// constant bound on the number of outer iterations.
+int FusedMapSearchSteps(PrimExpr max_outer_extent) {
+  arith::Analyzer analyzer;
+  auto bound = analyzer.const_int_bound(
+      Simplify(UninterpFun::InlineUninterpFunCalls(max_outer_extent)));
+  if (bound->max_value == arith::ConstIntBound::kPosInf ||
+      bound->max_value > std::numeric_limits<int32_t>::max()) {
+    return -1;
+  }
+  int steps = 0;
+  while ((int64_t(1) << steps) < bound->max_value) steps++;
+  return steps;
+}
+
+// The outer iteration a fused iteration belongs to, i.e., the last
+// outer iteration that starts at or before it in the fused space,
+// searched for in outer_to_fused_pos so as to not need the fused to
+// outer map.
+PrimExpr SearchFusedToOuter(const Buffer& outer_to_fused_pos, PrimExpr fused,
+                            PrimExpr outer_extent, int steps) {
+  return CallNode::make(DataType::Int(32), intrinsic::tvm_fused_map_search,
+                        {outer_to_fused_pos->data, outer_to_fused_pos->elem_offset,
+                         make_zero(outer_to_fused_pos->dtype), fused, outer_extent,
+                         IntImm(DataType::Int(32), steps)},
+                        CallNode::PureIntrinsic);
+}
+
 Stmt FusionFunctionGenerator::Generate() {
   for (Stage s : sch->stages) {
     if (s->op->loop_layout().defined()) {
@@ -281,18 +523,51 @@ Stmt FusionFunctionGenerator::generate_fusion_statements(Stage& stage, const Rag
   // std::cout << "[GFS]   Fused " << fused->var << " " << fused_dom << " " << fused_extent_relaxed
   //           << std::endl;
 
-  auto decl_both_buffers = [&](Array<PrimExpr> shape, std::string prefix) {
+  auto decl_both_buffers = [&](Array<PrimExpr> shape, DataType dtype, std::string prefix) {
     prefix = prefix + std::to_string(count);
-    auto buffer_pair = agg_pair.create_buffer_pair(shape, DataType::Int(32), prefix);
+    auto buffer_pair = agg_pair.create_buffer_pair(shape, dtype, prefix);
     Buffer host_buffer = buffer_pair.first;
     Buffer dev_buffer = buffer_pair.second;
     return std::make_pair(host_buffer, dev_buffer);
   };
 
-  // Allocate buffers
-  auto fused_to_inner_bufs = decl_both_buffers({fused_extent_relaxed}, "fi");
-  auto fused_to_outer_bufs = decl_both_buffers({fused_extent_relaxed}, "fo");
-  auto outer_to_fused_pos_bufs = decl_both_buffers({outer_extent_relaxed}, "ofp");
+  // Allocate buffers. The fused to outer and fused to inner maps are
+  // not needed when they are computed on the fly.
+  int search_steps = maps_on_the_fly ? FusedMapSearchSteps(outer_extent_relaxed) : -1;
+  bool on_the_fly = search_steps >= 0;
+  std::pair<Buffer, Buffer> fused_to_inner_bufs, fused_to_outer_bufs;
+  if (!on_the_fly) {
+    fused_to_inner_bufs = decl_both_buffers({fused_extent_relaxed},
+                                            NarrowestAuxDType(inner_extent_relaxed), "fi");
+    fused_to_outer_bufs = decl_both_buffers({fused_extent_relaxed},
+                                            NarrowestAuxDType(outer_extent_relaxed), "fo");
+  }
+  auto outer_to_fused_pos_bufs = decl_both_buffers(
+      {outer_extent_relaxed}, NarrowestAuxDType(fused_extent_relaxed + 1), "ofp");
+  // When the outer loop is itself a ragged fusion, the indices of that
+  // fusion are also stored per fused index, see ComposedFusionFuns.
+  const RaggedFuseNode* outer_rel = nullptr;
+  auto composed_it = composed_funs.find(rel);
+  std::pair<Buffer, Buffer> composed_outer_bufs, composed_inner_bufs;
+  PrimExpr composed_outer_extent, composed_inner_extent;
+  if (composed_it != composed_funs.end() && !on_the_fly && !gen_on_device) {
+    for (auto r : stage->relations) {
+      auto orel = r.as<RaggedFuseNode>();
+      if (orel && orel->fused == outer) outer_rel = orel;
+    }
+  }
+  if (outer_rel) {
+    auto relaxed_extent = [&](IterVar iv) {
+      return Simplify(UninterpFun::InlineUninterpFunCalls(
+          UninterpFun::RelaxUninterpCallsMaxInclusive(dom_map.at(iv)->max_exclusive(), false)));
+    };
+    composed_outer_extent = relaxed_extent(outer_rel->outer);
+    composed_inner_extent = relaxed_extent(outer_rel->inner);
+    composed_outer_bufs = decl_both_buffers({fused_extent_relaxed},
+                                            NarrowestAuxDType(composed_outer_extent), "fco");
+    composed_inner_bufs = decl_both_buffers({fused_extent_relaxed},
+                                            NarrowestAuxDType(composed_inner_extent), "fci");
+  }
   Buffer fused_val = decl_buffer({1}, DataType::Int(32), "f" + std::to_string(count));
   count++;
 
@@ -348,33 +623,57 @@ Stmt FusionFunctionGenerator::generate_fusion_statements(Stage& stage, const Rag
 
   Stmt no_op = EvaluateNode::make(0);
   Stmt body = NullValue<Stmt>();
-  PrimExpr fused_val_load = fused_val.vload({0}, DataType::Int(32));
-  {
-    Stmt outer_store = fused_to_outer_bufs.first.vstore({fused_val_load}, outer_value);
-    Stmt inner_store = fused_to_inner_bufs.first.vstore({fused_val_load}, inner_value);
-    Stmt fused_incr = fused_val.vstore({0}, fused_val_load + 1);
-    body = SeqStmt({outer_store, inner_store, fused_incr});
-  }
+  if (gen_on_device) {
+    body = generate_device_fusion_statements(
+        "f" + std::to_string(count - 1), outer->var, outer_dom->min, outer_loop_extent,
+        inner_dom->min, inner_loop_extent, fused_to_outer_bufs.second, fused_to_inner_bufs.second,
+        outer_to_fused_pos_bufs.second);
+  } else {
+    PrimExpr fused_val_load = fused_val.vload({0}, DataType::Int(32));
+    if (on_the_fly) {
+      body = fused_val.vstore({0}, fused_val_load + inner_loop_extent);
+    } else {
+      {
+        Stmt outer_store = store_aux(fused_to_outer_bufs.first, fused_val_load, outer_value);
+        Stmt inner_store = store_aux(fused_to_inner_bufs.first, fused_val_load, inner_value);
+        Stmt fused_incr = fused_val.vstore({0}, fused_val_load + 1);
+        if (outer_rel) {
+          // The maps of the outer fusion were generated before this one.
+          auto outer_index = [&](UninterpFun uf) {
+            return UninterpFun::InlineUninterpFunCalls(
+                uf.MakeCallTo(Array<PrimExpr>{outer_value}, uf->dimensions, DataType::Int(32)));
+          };
+          body = SeqStmt({outer_store, inner_store,
+                          store_aux(composed_outer_bufs.first, fused_val_load,
+                                    outer_index(outer_rel->fused_to_outer_uf)),
+                          store_aux(composed_inner_bufs.first, fused_val_load,
+                                    outer_index(outer_rel->fused_to_inner_uf)),
+                          fused_incr});
+        } else {
+          body = SeqStmt({outer_store, inner_store, fused_incr});
+        }
+      }
 
-  body = ForNode::make(inner->var, inner_dom->min, inner_loop_extent, ForType::Serial,
-                       DeviceAPI::None, body);
-  body = SeqStmt(
-      {outer_to_fused_pos_bufs.first.vstore({outer_value - outer_dom->min}, fused_val_load), body});
-  body = ForNode::make(outer->var, outer_dom->min, outer_loop_extent, ForType::Serial,
-                       DeviceAPI::None, body);
+      body = ForNode::make(inner->var, inner_dom->min, inner_loop_extent, ForType::Serial,
+                           DeviceAPI::None, body);
+    }
+    body = SeqStmt(
+        {store_aux(outer_to_fused_pos_bufs.first, outer_value - outer_dom->min, fused_val_load),
+         body});
+    body = ForNode::make(outer->var, outer_dom->min, outer_loop_extent, ForType::Serial,
+                         DeviceAPI::None, body);
+    body = SeqStmt({fused_val.vstore({0}, 0), body});
+    body = AllocateCounter(fused_val, body, "global");
+  }
 
   // Add annotations stating that the buffers we create all contain
   // non-negative integers
-  non_negative_objects.push_back(fused_to_outer_bufs.second->data);
-  non_negative_objects.push_back(fused_to_inner_bufs.second->data);
+  if (!on_the_fly) {
+    non_negative_objects.push_back(fused_to_outer_bufs.second->data);
+    non_negative_objects.push_back(fused_to_inner_bufs.second->data);
+  }
   non_negative_objects.push_back(outer_to_fused_pos_bufs.second->data);
 
-  body = SeqStmt({fused_val.vstore({0}, 0), body});
-
-  body = AttrStmtNode::make(fused_val->data, attr::storage_scope, StringImmNode::make("global"),
-                            AllocateNode::make(fused_val->data, DataType::Int(32), {1},
-                                               IntImm(DataType::Bool(1), 1), body));
-
   PrimExpr fused_min = VarReplacer({{outer->var.get(), outer_dom->min}})(inner_dom->min);
   auto init_uf = [&](UninterpFun uf, PrimExpr max_extent, Buffer loadee,
                      PrimExpr body = NullValue<PrimExpr>()) {
@@ -382,9 +681,7 @@ Stmt FusionFunctionGenerator::generate_fusion_statements(Stage& stage, const Rag
 
     if (!body.defined()) {
       CHECK_EQ(uf->arity(), 1);
-      Array<PrimExpr> extents;
-      for (auto param : uf->parameters) extents.push_back(param - fused_min);
-      body = loadee.vload(extents, DataType::Int(32));
+      body = load_aux(loadee, uf->parameters[0] - fused_min);
     }
 
     // std::cout << "[FPL]   Setting body " << uf->func_name() << " " << body << std::endl;
@@ -394,11 +691,37 @@ Stmt FusionFunctionGenerator::generate_fusion_statements(Stage& stage, const Rag
 
     uf_node->SetRange(Range::make_by_min_extent(0, max_extent));
   };
-  init_uf(rel->fused_to_outer_uf, outer_extent_relaxed, fused_to_outer_bufs.second);
-  init_uf(rel->fused_to_inner_uf, inner_extent_relaxed, fused_to_inner_bufs.second);
+  if (on_the_fly) {
+    CHECK_EQ(rel->fused_to_outer_uf->arity(), 1);
+    CHECK_EQ(rel->fused_to_inner_uf->arity(), 1);
+    PrimExpr fo_pos = rel->fused_to_outer_uf->parameters[0] - fused_min;
+    PrimExpr fo_body = SearchFusedToOuter(outer_to_fused_pos_bufs.second, fo_pos,
+                                          outer_loop_extent, search_steps) +
+                       outer_dom->min;
+    init_uf(rel->fused_to_outer_uf, outer_extent_relaxed, Buffer(), fo_body);
+
+    // The search is lowered once per distinct call, so the two uses of
+    // fi_outer share it.
+    PrimExpr fi_pos = rel->fused_to_inner_uf->parameters[0] - fused_min;
+    PrimExpr fi_outer = SearchFusedToOuter(outer_to_fused_pos_bufs.second, fi_pos,
+                                           outer_loop_extent, search_steps);
+    PrimExpr fi_body =
+        VarReplacer({{outer->var.get(), fi_outer + outer_dom->min}})(inner_dom->min) + fi_pos -
+        load_aux(outer_to_fused_pos_bufs.second, fi_outer);
+    init_uf(rel->fused_to_inner_uf, inner_extent_relaxed, Buffer(), fi_body);
+  } else {
+    init_uf(rel->fused_to_outer_uf, outer_extent_relaxed, fused_to_outer_bufs.second);
+    init_uf(rel->fused_to_inner_uf, inner_extent_relaxed, fused_to_inner_bufs.second);
+  }
+  if (outer_rel) {
+    init_uf(composed_it->second.first, composed_outer_extent, composed_outer_bufs.second);
+    init_uf(composed_it->second.second, composed_inner_extent, composed_inner_bufs.second);
+    non_negative_objects.push_back(composed_outer_bufs.second->data);
+    non_negative_objects.push_back(composed_inner_bufs.second->data);
+  }
 
-  auto oif_body = outer_to_fused_pos_bufs.second.vload(
-                      {rel->outer_inner_to_fused_uf->parameters[0]}, DataType::Int(32)) +
+  auto oif_body = load_aux(outer_to_fused_pos_bufs.second,
+                           rel->outer_inner_to_fused_uf->parameters[0]) +
                   rel->outer_inner_to_fused_uf->parameters[1];
   init_uf(rel->outer_inner_to_fused_uf, fused_extent_relaxed, outer_to_fused_pos_bufs.second,
           oif_body);
@@ -429,18 +752,26 @@ Stmt FusionFunctionGenerator::generate_fusion_statements(Stage& stage,
   // std::cout << "[GFS]           " << inner_extent << std::endl;
   // std::cout << "[GFS]           " << fused_extent << std::endl;
 
-  auto decl_both_buffers = [&](Array<PrimExpr> shape, std::string prefix) {
+  auto decl_both_buffers = [&](Array<PrimExpr> shape, DataType dtype, std::string prefix) {
     prefix = "d_" + prefix + std::to_string(count);
-    auto buffer_pair = agg_pair.create_buffer_pair(shape, DataType::Int(32), prefix);
+    auto buffer_pair = agg_pair.create_buffer_pair(shape, dtype, prefix);
     Buffer host_buffer = buffer_pair.first;
     Buffer dev_buffer = buffer_pair.second;
     return std::make_pair(host_buffer, dev_buffer);
   };
 
   // Allocate buffers
-  auto fused_to_inner_bufs = decl_both_buffers({fused_extent}, "fi");
-  auto fused_to_outer_bufs = decl_both_buffers({fused_extent}, "fo");
-  auto outer_to_fused_pos_bufs = decl_both_buffers({outer_extent}, "ofp");
+  int search_steps = maps_on_the_fly ? FusedMapSearchSteps(outer_extent) : -1;
+  bool on_the_fly = search_steps >= 0;
+  std::pair<Buffer, Buffer> fused_to_inner_bufs, fused_to_outer_bufs;
+  if (!on_the_fly) {
+    fused_to_inner_bufs =
+        decl_both_buffers({fused_extent}, NarrowestAuxDType(inner_extent), "fi");
+    fused_to_outer_bufs =
+        decl_both_buffers({fused_extent}, NarrowestAuxDType(outer_extent), "fo");
+  }
+  auto outer_to_fused_pos_bufs =
+      decl_both_buffers({outer_extent}, NarrowestAuxDType(fused_extent + 1), "ofp");
   Buffer fused_val = decl_buffer({1}, DataType::Int(32), "fb" + std::to_string(count));
   count++;
 
@@ -452,35 +783,44 @@ Stmt FusionFunctionGenerator::generate_fusion_statements(Stage& stage,
 
   Stmt no_op = EvaluateNode::make(0);
   Stmt body = NullValue<Stmt>();
-  PrimExpr fused_val_load = fused_val.vload({0}, DataType::Int(32));
-  {
-    Stmt outer_store = fused_to_outer_bufs.first.vstore({fused_val_load}, outer_loop_var);
-    Stmt inner_store = fused_to_inner_bufs.first.vstore({fused_val_load}, inner_loop_var);
-    Stmt fused_incr = fused_val.vstore({0}, fused_val_load + 1);
-    body = SeqStmt({outer_store, inner_store, fused_incr});
-  }
-
   // std::cout << "[GFS]  LFun: " << layout->l_funs[layout->dimensions.GetIdx(rel->inner)]
   //           << std::endl;
-  body = ForNode::make(inner_loop_var, 0,
-                       layout->l_funs[layout->dimensions.GetIdx(rel->inner)].MakeCallTo(
-                           Array<Var>({outer_loop_var}), {rel->outer}),
-                       ForType::Serial, DeviceAPI::None, body);
-  body = SeqStmt({outer_to_fused_pos_bufs.first.vstore({outer_loop_var}, fused_val_load), body});
-  body = ForNode::make(outer_loop_var, 0, outer_extent, ForType::Serial, DeviceAPI::None, body);
+  PrimExpr inner_loop_extent = layout->l_funs[layout->dimensions.GetIdx(rel->inner)].MakeCallTo(
+      Array<Var>({outer_loop_var}), {rel->outer});
+  if (gen_on_device) {
+    body = generate_device_fusion_statements(
+        "fb" + std::to_string(count - 1), outer_loop_var, 0, outer_extent, 0, inner_loop_extent,
+        fused_to_outer_bufs.second, fused_to_inner_bufs.second, outer_to_fused_pos_bufs.second);
+  } else {
+    PrimExpr fused_val_load = fused_val.vload({0}, DataType::Int(32));
+    if (on_the_fly) {
+      body = fused_val.vstore({0}, fused_val_load + inner_loop_extent);
+    } else {
+      {
+        Stmt outer_store = store_aux(fused_to_outer_bufs.first, fused_val_load, outer_loop_var);
+        Stmt inner_store = store_aux(fused_to_inner_bufs.first, fused_val_load, inner_loop_var);
+        Stmt fused_incr = fused_val.vstore({0}, fused_val_load + 1);
+        body = SeqStmt({outer_store, inner_store, fused_incr});
+      }
+
+      body = ForNode::make(inner_loop_var, 0, inner_loop_extent, ForType::Serial,
+                           DeviceAPI::None, body);
+    }
+    body = SeqStmt(
+        {store_aux(outer_to_fused_pos_bufs.first, outer_loop_var, fused_val_load), body});
+    body = ForNode::make(outer_loop_var, 0, outer_extent, ForType::Serial, DeviceAPI::None, body);
+    body = SeqStmt({fused_val.vstore({0}, 0), body});
+    body = AllocateCounter(fused_val, body, "global");
+  }
 
   // Add annotations stating that the buffers we create all contain
   // non-negative integers
-  non_negative_objects.push_back(fused_to_outer_bufs.second->data);
-  non_negative_objects.push_back(fused_to_inner_bufs.second->data);
+  if (!on_the_fly) {
+    non_negative_objects.push_back(fused_to_outer_bufs.second->data);
+    non_negative_objects.push_back(fused_to_inner_bufs.second->data);
+  }
   non_negative_objects.push_back(outer_to_fused_pos_bufs.second->data);
 
-  body = SeqStmt({fused_val.vstore({0}, 0), body});
-
-  body = AttrStmtNode::make(fused_val->data, attr::storage_scope, StringImmNode::make("global"),
-                            AllocateNode::make(fused_val->data, DataType::Int(32), {1},
-                                               IntImm(DataType::Bool(1), 1), body));
-
   auto init_uf = [&](UninterpFun uf, PrimExpr max_extent, Buffer loadee,
                      PrimExpr body = NullValue<PrimExpr>()) {
     UninterpFunNode* uf_node = const_cast<UninterpFunNode*>(uf.as<UninterpFunNode>());
@@ -492,29 +832,91 @@ Stmt FusionFunctionGenerator::generate_fusion_statements(Stage& stage,
         uf_node->SetBody(body);
         // std::cout << "[FG]   Custom body " << uf << std::endl;
       } else {
-        uf_node->SetBody(loadee.vload(extents, DataType::Int(32)));
+        uf_node->SetBody(cast(DataType::Int(32), loadee.vload(extents, loadee->dtype)));
         // std::cout << "[FG]   Loadee body " << uf << std::endl;
       }
     }
     uf_node->SetRange(Range::make_by_min_extent(0, max_extent));
   };
 
-  init_uf(rel->fused_to_outer_uf, outer_extent, fused_to_outer_bufs.second);
-  init_uf(rel->fused_to_inner_uf, inner_extent, fused_to_inner_bufs.second);
-  auto oif_body = outer_to_fused_pos_bufs.second.vload(
-                      {rel->outer_inner_to_fused_uf->parameters[0]}, DataType::Int(32)) +
+  if (on_the_fly) {
+    CHECK_EQ(rel->fused_to_outer_uf->arity(), 1);
+    CHECK_EQ(rel->fused_to_inner_uf->arity(), 1);
+    PrimExpr fo_pos = rel->fused_to_outer_uf->parameters[0];
+    init_uf(rel->fused_to_outer_uf, outer_extent, Buffer(),
+            SearchFusedToOuter(outer_to_fused_pos_bufs.second, fo_pos, outer_extent,
+                               search_steps));
+    PrimExpr fi_pos = rel->fused_to_inner_uf->parameters[0];
+    PrimExpr fi_outer =
+        SearchFusedToOuter(outer_to_fused_pos_bufs.second, fi_pos, outer_extent, search_steps);
+    init_uf(rel->fused_to_inner_uf, inner_extent, Buffer(),
+            fi_pos - load_aux(outer_to_fused_pos_bufs.second, fi_outer));
+  } else {
+    init_uf(rel->fused_to_outer_uf, outer_extent, fused_to_outer_bufs.second);
+    init_uf(rel->fused_to_inner_uf, inner_extent, fused_to_inner_bufs.second);
+  }
+  auto oif_body = load_aux(outer_to_fused_pos_bufs.second,
+                           rel->outer_inner_to_fused_uf->parameters[0]) +
                   rel->outer_inner_to_fused_uf->parameters[1];
   init_uf(rel->outer_inner_to_fused_uf, fused_extent, outer_to_fused_pos_bufs.second, oif_body);
   return body;
 }
 
+// Generate the fusion maps for a fused loop nest directly on the
+// device. The start positions of each outer iteration in the fused
+// space are first computed by a block wide scan. Each outer iteration
+// then gets its own thread block which fills in its slice of the
+// fused to outer and fused to inner maps in parallel.
+Stmt FusionFunctionGenerator::generate_device_fusion_statements(
+    std::string prefix, Var outer_var, PrimExpr outer_min, PrimExpr outer_extent,
+    PrimExpr inner_min, PrimExpr inner_extent, Buffer fused_to_outer, Buffer fused_to_inner,
+    Buffer outer_to_fused_pos) {
+  DataType dtype = DataType::Int(32);
+  Stmt scan_kernel;
+  {
+    Var o_var = Var(prefix + "_o", dtype);
+    PrimExpr o_inner_extent = VarReplacer({{outer_var.get(), o_var + outer_min}})(inner_extent);
+    scan_kernel = MakeDeviceScanKernel(
+        prefix + "_", o_var, outer_extent, o_inner_extent,
+        [&](PrimExpr o, PrimExpr val) { return store_aux(outer_to_fused_pos, o, val); }, false);
+  }
+  // The maps are computed on the fly from the start positions.
+  if (!fused_to_outer.defined()) return scan_kernel;
+
+  Stmt fill_kernel;
+  {
+    IterVar block_iv = thread_axis(Range(0, outer_extent), "blockIdx.x");
+    IterVar thread_iv = thread_axis(Range(0, kPrepCodeDeviceThreads), "threadIdx.x");
+    PrimExpr o = block_iv->var + outer_min;
+    std::unordered_map<const VarNode*, PrimExpr> vsub = {{outer_var.get(), o}};
+    PrimExpr o_inner_extent = VarReplacer(vsub)(inner_extent);
+    PrimExpr o_inner_min = VarReplacer(vsub)(inner_min);
+
+    Var k_var = Var(prefix + "_k", dtype);
+    PrimExpr offset = k_var * kPrepCodeDeviceThreads + thread_iv->var;
+    PrimExpr pos = load_aux(outer_to_fused_pos, block_iv->var) + offset;
+    Stmt body = SeqStmt({store_aux(fused_to_outer, pos, o),
+                         store_aux(fused_to_inner, pos, o_inner_min + offset)});
+    body = IfThenElseNode::make(offset < o_inner_extent, body);
+    body = ForNode::make(
+        k_var, 0, floordiv(o_inner_extent + kPrepCodeDeviceThreads - 1, kPrepCodeDeviceThreads),
+        ForType::Serial, DeviceAPI::None, body);
+    fill_kernel =
+        MakePrepCodeKernel(body, outer_extent, kPrepCodeDeviceThreads, &block_iv, &thread_iv);
+  }
+  return SeqStmt({scan_kernel, fill_kernel});
+}
+
 std::pair<Buffer, Buffer> AggregatorPair::create_buffer_pair(Array<PrimExpr> extents,
                                                              DataType buf_dtype, std::string name) {
   if (distinct_device) {
-    return std::make_pair(host_agg.create_buffer(extents, buf_dtype, name + "_h"),
-                          dev_agg.create_buffer(extents, buf_dtype, name + "_d"));
+    Buffer host_buffer = host_agg.create_buffer(extents, buf_dtype, name + "_h");
+    Buffer dev_buffer = dev_agg.create_buffer(extents, buf_dtype, name + "_d");
+    dev_buffers.push_back(dev_buffer);
+    return std::make_pair(host_buffer, dev_buffer);
   } else {
     Buffer buffer = host_agg.create_buffer(extents, buf_dtype, name);
+    dev_buffers.push_back(buffer);
     return std::make_pair(buffer, buffer);
   }
 }
@@ -597,6 +999,7 @@ Stmt FusionFunctionSimplifier::Simplify(Stmt body,
     }
     if (to_add) {
       stages_to_generate_fusion_funcs_for.push_back(s);
+      ComposeChainedFusions(s);
     }
   }
   body = this->VisitStmt(body);
@@ -604,8 +1007,49 @@ Stmt FusionFunctionSimplifier::Simplify(Stmt body,
   return body;
 }
 
+void FusionFunctionSimplifier::ComposeChainedFusions(const Stage& stage) {
+  for (auto rel : stage->relations) {
+    auto frel = rel.as<RaggedFuseNode>();
+    if (!frel) continue;
+    for (auto outer_rel : stage->relations) {
+      auto orel = outer_rel.as<RaggedFuseNode>();
+      if (!orel || orel->fused != frel->outer) continue;
+      // The maps of fusions shared with other stages are generated
+      // for those stages.
+      if (fsub.count(frel->fused_to_outer_uf.get()) || fsub.count(orel->fused_to_outer_uf.get())) {
+        continue;
+      }
+      auto make = [&](UninterpFun outer_uf, std::string suffix) {
+        return UninterpFunNode::make(frel->fused->var->name_hint + suffix, outer_uf->range,
+                                     frel->fused_to_outer_uf->dimensions, {frel->fused->var},
+                                     NullValue<PrimExpr>(), outer_uf->type);
+      };
+      UninterpFun fo = make(orel->fused_to_outer_uf, "_foo");
+      UninterpFun fi = make(orel->fused_to_inner_uf, "_foi");
+      composed_funs[frel] = std::make_pair(fo, fi);
+      compositions[orel->fused_to_outer_uf.get()][frel->fused_to_outer_uf.get()] = fo;
+      compositions[orel->fused_to_inner_uf.get()][frel->fused_to_outer_uf.get()] = fi;
+    }
+  }
+}
+
 PrimExpr FusionFunctionSimplifier::VisitExpr_(const CallNode* op) {
   // std::cout << "[FG]   CallEXpre " << GetRef<PrimExpr>(op) << " " << op->func << std::endl;
+  PrimExpr ret = SubstituteShared(op);
+  // Map the index of an outer fusion recovered from the fused to outer
+  // map of the fusion of its fused loop with one lookup.
+  auto call = ret.as<CallNode>();
+  if (call == nullptr || call->args.size() != 1) return ret;
+  auto it = compositions.find(call->func.get());
+  if (it == compositions.end()) return ret;
+  auto arg = call->args[0].as<CallNode>();
+  if (arg == nullptr) return ret;
+  auto jt = it->second.find(arg->func.get());
+  if (jt == it->second.end()) return ret;
+  return jt->second.MakeCallTo(arg->args, arg->arg_dims, call->dtype);
+}
+
+PrimExpr FusionFunctionSimplifier::SubstituteShared(const CallNode* op) {
   auto it = fsub.find(op->func.get());
   if (it != fsub.end()) {
     // std::cout << "[FG]     Found " << it->second << std::endl;
@@ -632,23 +1076,87 @@ PrimExpr FusionFunctionSimplifier::VisitExpr_(const FuseSelectNode* op) {
                           this->VisitExpr(op->false_value));
 }
 
+// Generates the permutation of the elements of a partitioned
+// conditional that places the elements taking the then branch first,
+// along with the position where the others start. Like the prefix
+// sums, this is a sequential pass over the elements.
+Stmt FunctionGenerator::generate_partition_statements(const ConditionalOpNode* op) {
+  IterVar iv = op->explicit_loop_ivs[0];
+  std::string prefix = op->name + "_part";
+  Range dom = dom_map.count(iv) ? dom_map.at(iv) : iv->dom;
+  PrimExpr min = UninterpFun::InlineUninterpFunCalls(dom->min);
+  PrimExpr extent = UninterpFun::InlineUninterpFunCalls(dom->extent);
+  PrimExpr extent_relaxed = Simplify(UninterpFun::InlineUninterpFunCalls(
+      UninterpFun::RelaxUninterpCallsMaxInclusive(dom->extent, false)));
+
+  // The permutation is followed by the number of elements taking the
+  // then branch.
+  auto buffer_pair = agg_pair.create_buffer_pair({extent_relaxed + 1}, DataType::Int(32), prefix);
+  Buffer perm_buffer_dev = buffer_pair.second;
+  Buffer perm_buffer_out = gen_on_device ? perm_buffer_dev : buffer_pair.first;
+  Buffer counter = decl_buffer({1}, DataType::Int(32), prefix + "ctr");
+  non_negative_objects.push_back(perm_buffer_dev->data);
+
+  Var elem = iv->var.copy_with_suffix(".elem");
+  PrimExpr condition =
+      VarReplacer({{iv->var.get(), elem}})(UninterpFun::InlineUninterpFunCalls(op->condition));
+  PrimExpr count = counter.vload({0}, DataType::Int(32));
+  auto partition_loop = [&](PrimExpr cond) {
+    Stmt append = SeqStmt({perm_buffer_out.vstore({count}, elem), counter.vstore({0}, count + 1)});
+    return ForNode::make(elem, min, extent, ForType::Serial, DeviceAPI::None,
+                         IfThenElseNode::make(cond, append));
+  };
+  Stmt stmt = SeqStmt({counter.vstore({0}, 0), partition_loop(condition),
+                       perm_buffer_out.vstore({extent_relaxed}, count),
+                       partition_loop(!condition)});
+  if (gen_on_device) {
+    stmt = AllocateCounter(counter, stmt, "local");
+    stmt = MakePrepCodeKernel(stmt, 1, 1);
+  } else {
+    stmt = AllocateCounter(counter, stmt, "global");
+  }
+
+  if (debug_fill_function_bodies) {
+    UninterpFun perm = op->partition_perm_uf;
+    const_cast<UninterpFunNode*>(perm.as<UninterpFunNode>())
+        ->SetBody(perm_buffer_dev.vload({perm->parameters[0] - dom->min}, DataType::Int(32)));
+    const_cast<UninterpFunNode*>(op->partition_then_end_uf.as<UninterpFunNode>())
+        ->SetBody(dom->min + perm_buffer_dev.vload({extent_relaxed}, DataType::Int(32)));
+  }
+  return stmt;
+}
+
+void FunctionGenerator::GeneratePartitionFunctions() {
+  Array<Stmt> stmts;
+  for (Stage s : sch->stages) {
+    auto op = s->op.as<ConditionalOpNode>();
+    if (op && op->lowering_mode == ConditionalOpNode::kPartitioned) {
+      stmts.push_back(generate_partition_statements(op));
+    }
+  }
+  pfun_stmt = SeqStmt(stmts);
+}
+
 Stmt FunctionGenerator::SimplifyFusionFunctions(Stmt body) {
-  FusionFunctionSimplifier simplifier(sch, dom_map);
+  FusionFunctionSimplifier simplifier(sch, dom_map, &composed_fusion_funs);
   return simplifier.Simplify(body, stages_to_generate_fusion_funcs_for);
 }
 
 void FunctionGenerator::GenerateAFunctions() {
-  AFunctionGenerator generator(sch, &buffer_map, &agg_pair, debug_fill_function_bodies,
-                               afuns_needed_for);
-  afun_stmt = generator.Generate();
+  afun_stmt = afun_generator.Generate();
   // std::cout << "[AFUNSTMT]\n " << afun_stmt << std::endl;
   // exit(0);
 }
 
+void FunctionGenerator::GenerateAFunctions(const Array<Stage>& stages) {
+  afun_stmt = SeqStmt::Flatten(afun_stmt, afun_generator.Generate(stages));
+}
+
 void FunctionGenerator::GenerateFusionFunctions() {
   FusionFunctionGenerator generator(sch, dom_map, root_layout_map,
                                     stages_to_generate_fusion_funcs_for, &non_negative_objects,
-                                    &buffer_map, &agg_pair, debug_fill_function_bodies);
+                                    &buffer_map, &agg_pair, debug_fill_function_bodies,
+                                    gen_on_device, fused_maps_on_the_fly, composed_fusion_funs);
   // std::cout << "[MAPMAP11] " << generator.root_layout_map.defined() << std::endl;
   // std::cout << "[MAPMAP12] " << generator.root_layout_map.size() << std::endl;
   ffun_stmt = generator.Generate();
@@ -673,8 +1181,10 @@ Stmt FunctionGenerator::CreateBody(Stmt body) {
   auto dev_agg_buf = agg_buf_pair.second;
   buffer_map.Set(host_agg_buf, dev_agg_buf);
   Stmt prep_code_body;
-  if (is_zero(agg_pair.aggregate_size()) || dev_agg_buf == host_agg_buf) {
-    prep_code_body = SeqStmt({ffun_stmt, afun_stmt});
+  if (is_zero(agg_pair.aggregate_size()) || dev_agg_buf == host_agg_buf || gen_on_device) {
+    // When generated on the device, the prep code writes directly to
+    // the device buffer and there is nothing to copy.
+    prep_code_body = SeqStmt({ffun_stmt, afun_stmt, pfun_stmt});
   } else {
     Stmt copy_stmt = EvaluateNode::make(copy_to_device(
         host_agg_buf->data, 0, dev_agg_buf->data, 0,
@@ -682,7 +1192,11 @@ Stmt FunctionGenerator::CreateBody(Stmt body) {
         Var("src_devtype_dummy", DataType::Handle()), Var("src_devid_dummy", DataType::Handle()),
         Var("dst_devtype_dummy", DataType::Handle()), Var("dst_devid_dummy", DataType::Handle()),
         kDLInt, 32));
-    prep_code_body = SeqStmt({ffun_stmt, afun_stmt, copy_stmt});
+    prep_code_body = SeqStmt({ffun_stmt, afun_stmt, pfun_stmt, copy_stmt});
+  }
+  if (agg_pair.device_buffers().size() > 0) {
+    prep_code_body = AttrStmtNode::make(agg_pair.device_buffers(), attr::aux_buffer_layout, 0,
+                                        prep_code_body);
   }
   Stmt prep_code = AttrStmtNode::make(buffer_map, attr::prep_code_scope, 0, prep_code_body);
   // std::cout << "[PREPSTMT]\n " << prep_code << std::endl;
@@ -10,6 +10,7 @@
 
 #include <set>
 #include <unordered_map>
+#include <utility>
 
 namespace tvm {
 namespace te {
@@ -51,8 +52,11 @@ class AggregatorPair {
 
   PrimExpr current_device_buffer_size() const { return dev_agg.aggregate_size(); }
 
+  Array<Buffer> device_buffers() const { return dev_buffers; }
+
  private:
   bool distinct_device;
+  Array<Buffer> dev_buffers;
   AllocationAggregator host_agg;
   AllocationAggregator dev_agg;
 };
@@ -61,18 +65,29 @@ class AFunctionGenerator {
  public:
   AFunctionGenerator(const Schedule& sch_, Map<Buffer, Buffer>* p_buffer_map_,
                      AggregatorPair* p_agg_pair_, bool debug_fill_function_bodies_,
-                     Array<Buffer> afuns_needed_for_)
+                     Array<Buffer> afuns_needed_for_, bool gen_on_device_)
       : sch(sch_),
         buffer_map(*p_buffer_map_),
         agg_pair(*p_agg_pair_),
         debug_fill_function_bodies(debug_fill_function_bodies_),
-        afuns_needed_for(afuns_needed_for_) {}
+        afuns_needed_for(afuns_needed_for_),
+        gen_on_device(gen_on_device_) {}
 
   Stmt Generate();
 
+  // Generates the A-functions of the storage layouts of stages only,
+  // reusing the ones generated by earlier calls wherever the
+  // dependences are the same.
+  Stmt Generate(const Array<Stage>& stages);
+
   struct FunKey {
     Dimension dimension;
     std::multiset<const Object*> dependent_dimensions;
+    // The l_funs of the transitive dependent dimensions and the extent
+    // of the dimension. Used to identify A-functions that compute the
+    // same prefix sums for different dimensions.
+    Array<UninterpFun> dependent_l_funs;
+    PrimExpr extent;
   };
 
  private:
@@ -86,6 +101,8 @@ class AFunctionGenerator {
     bool operator()(const FunKey& p1, const FunKey& p2) const;
   };
 
+  Stmt Generate(const Array<Stage>& stages, bool include_buffers);
+
   UninterpFun set_afun(Modes layout, int idx, UninterpFun a_fun_shell);
 
   Schedule sch;
@@ -93,11 +110,20 @@ class AFunctionGenerator {
   AggregatorPair& agg_pair;
   bool debug_fill_function_bodies;
   Array<Buffer> afuns_needed_for;
+  bool gen_on_device;
   std::unordered_map<FunKey, UninterpFun, FunKeyHasher, FunKeyEquality> dim_afun_map;
   Array<Stmt> stmts;
   int count{0};
 };
 
+// The maps from the fused index of a ragged loop fusion whose outer
+// loop is itself the fused loop of a ragged fusion straight to the
+// outer and inner indices of that fusion, keyed by the outer fusion's
+// relation. With them, the indices of chained fusions, such as those
+// of batch, head and a ragged sequence, are recovered with one lookup
+// each rather than one per level.
+using ComposedFusionFuns = std::unordered_map<const Object*, std::pair<UninterpFun, UninterpFun>>;
+
 class FusionFunctionGenerator : public StmtExprMutator {
  public:
   FusionFunctionGenerator(const Schedule& sch_, const std::unordered_map<IterVar, Range>& dom_map_,
@@ -105,7 +131,8 @@ class FusionFunctionGenerator : public StmtExprMutator {
                           const std::vector<Stage>& stages_to_generate_for_,
                           Array<ObjectRef>* p_non_negative_objects_,
                           Map<Buffer, Buffer>* p_buffer_map_, AggregatorPair* p_agg_pair_,
-                          bool debug_fill_function_bodies_)
+                          bool debug_fill_function_bodies_, bool gen_on_device_,
+                          bool maps_on_the_fly_, const ComposedFusionFuns& composed_funs_)
       : sch(sch_),
         dom_map(dom_map_),
         root_layout_map(root_layout_map_),
@@ -114,12 +141,10 @@ class FusionFunctionGenerator : public StmtExprMutator {
         buffer_map(*p_buffer_map_),
         agg_pair(*p_agg_pair_),
         debug_fill_function_bodies(debug_fill_function_bodies_),
-        count(0) {
-    for (auto it : root_layout_map_) {
-      /* std::cout << "[MAPMAP] " << it.first << " " << it.second << std::endl; */
-      root_layout_map.Set(it.first, it.second);
-    }
-  }
+        gen_on_device(gen_on_device_),
+        maps_on_the_fly(maps_on_the_fly_),
+        composed_funs(composed_funs_),
+        count(0) {}
 
   Stmt Generate();
 
@@ -127,6 +152,11 @@ class FusionFunctionGenerator : public StmtExprMutator {
 
   Stmt generate_fusion_statements(Stage& stage, const RaggedDimensionFuseNode* rel);
 
+  Stmt generate_device_fusion_statements(std::string prefix, Var outer_var, PrimExpr outer_min,
+                                         PrimExpr outer_extent, PrimExpr inner_min,
+                                         PrimExpr inner_extent, Buffer fused_to_outer,
+                                         Buffer fused_to_inner, Buffer outer_to_fused_pos);
+
   const Schedule& sch;
   const std::unordered_map<IterVar, Range>& dom_map;
   Map<Stage, Modes>& root_layout_map;
@@ -135,6 +165,9 @@ class FusionFunctionGenerator : public StmtExprMutator {
   Map<Buffer, Buffer>& buffer_map;
   AggregatorPair& agg_pair;
   bool debug_fill_function_bodies;
+  bool gen_on_device;
+  bool maps_on_the_fly;
+  const ComposedFusionFuns& composed_funs;
 
  private:
   int count;
@@ -142,8 +175,9 @@ class FusionFunctionGenerator : public StmtExprMutator {
 
 class FusionFunctionSimplifier : public StmtExprMutator {
  public:
-  FusionFunctionSimplifier(const Schedule& sch_, const std::unordered_map<IterVar, Range>& dom_map_)
-      : sch(sch_), dom_map(dom_map_) {}
+  FusionFunctionSimplifier(const Schedule& sch_, const std::unordered_map<IterVar, Range>& dom_map_,
+                           ComposedFusionFuns* p_composed_funs_)
+      : sch(sch_), dom_map(dom_map_), composed_funs(*p_composed_funs_) {}
 
   Stmt Simplify(Stmt body, std::vector<Stage>& stages_to_generate_fusion_funcs_for);
 
@@ -152,21 +186,36 @@ class FusionFunctionSimplifier : public StmtExprMutator {
 
   PrimExpr VisitExpr_(const FuseSelectNode* op) override;
 
+  // Substitutes the fusion functions shared with other stages.
+  PrimExpr SubstituteShared(const CallNode* op);
+
+  // Creates the composed maps of the chained ragged fusions of stage.
+  void ComposeChainedFusions(const Stage& stage);
+
   const Schedule& sch;
   const std::unordered_map<IterVar, Range>& dom_map;
+  ComposedFusionFuns& composed_funs;
   std::unordered_map<const Object*, UninterpFun> fsub;
+  // The composed map of each pair of the map of an outer fusion and
+  // the fused to outer map of the fusion of its fused loop.
+  std::unordered_map<const Object*, std::unordered_map<const Object*, UninterpFun>> compositions;
 };
 
 class FunctionGenerator {
  public:
   FunctionGenerator(const Schedule& sch_, const std::unordered_map<IterVar, Range>& dom_map_,
                     bool distinct_device_, bool debug_fill_function_bodies_,
-                    Array<Buffer> afuns_needed_for_)
+                    Array<Buffer> afuns_needed_for_, bool gen_on_device_ = false,
+                    bool fused_maps_on_the_fly_ = false)
       : sch(sch_),
         dom_map(dom_map_),
         agg_pair(distinct_device_),
         debug_fill_function_bodies(debug_fill_function_bodies_),
-        afuns_needed_for(afuns_needed_for_) {
+        afuns_needed_for(afuns_needed_for_),
+        gen_on_device(distinct_device_ && gen_on_device_),
+        fused_maps_on_the_fly(fused_maps_on_the_fly_),
+        afun_generator(sch_, &buffer_map, &agg_pair, debug_fill_function_bodies_,
+                       afuns_needed_for_, distinct_device_ && gen_on_device_) {
     for (auto s : sch->stages) {
       for (auto rel : s->dim_relation_graph->relations) {
         if (rel.as<RaggedDimensionFuseNode>()) {
@@ -181,24 +230,44 @@ class FunctionGenerator {
 
   void GenerateAFunctions();
 
+  // Generates the A-functions of the layouts of stages, which were
+  // changed after GenerateAFunctions.
+  void GenerateAFunctions(const Array<Stage>& stages);
+
   void GenerateFusionFunctions();
 
+  // Generates the permutations of the conditionals lowered as
+  // partitioned.
+  void GeneratePartitionFunctions();
+
   Stmt CreateBody(Stmt body);
 
   PrimExpr GetCurrentAggregateBufferSize() { return agg_pair.current_device_buffer_size(); }
 
  private:
+  Stmt generate_partition_statements(const ConditionalOpNode* op);
+
   const Schedule& sch;
   const std::unordered_map<IterVar, Range>& dom_map;
   AggregatorPair agg_pair;
   bool debug_fill_function_bodies;
   Array<Buffer> afuns_needed_for;
+  // Whether the prep code should be generated as device kernels
+  // writing directly to the device aggregate buffer. Only meaningful
+  // when the target is a distinct device.
+  bool gen_on_device;
+  // Whether the fused to outer and fused to inner maps are computed
+  // from the outer to fused positions where they are used.
+  bool fused_maps_on_the_fly;
   Map<Buffer, Buffer> buffer_map;
+  AFunctionGenerator afun_generator;
   Array<ObjectRef> non_negative_objects;
   std::vector<Stage> stages_to_generate_fusion_funcs_for;
   Map<Stage, Modes> root_layout_map;
   Stmt afun_stmt;
   Stmt ffun_stmt;
+  Stmt pfun_stmt;
+  ComposedFusionFuns composed_fusion_funs;
 };
 
 }  // namespace te
@@ -14,11 +14,14 @@
 namespace tvm {
 namespace te {
 
+// Rewrites the accesses to the fused tensors to index the fused
+// dimension, which replaces the outermost of the fused dimensions,
+// with the fused variable, and to drop the others.
 class FuseRewriter : public ExprMutator {
  public:
-  FuseRewriter(const Map<Operation, Operation>& rmap_, Dimension outer_, Dimension inner_,
-               Dimension fused_, IterVar fused_iv_)
-      : rmap(rmap_), outer(outer_), inner(inner_), fused(fused_), fused_iv(fused_iv_) {}
+  FuseRewriter(const Map<Operation, Operation>& rmap_, Array<Dimension> dims_, Dimension fused_,
+               IterVar fused_iv_)
+      : rmap(rmap_), dims(dims_), fused(fused_), fused_iv(fused_iv_) {}
 
   PrimExpr VisitExpr_(const CallNode* op) override {
     // std::cout << "[FA]  RRewriting " << GetRef<PrimExpr>(op) << " " << op->args.size() << " "
@@ -36,11 +39,11 @@ class FuseRewriter : public ExprMutator {
 
       for (int i = 0; i < op->args.size(); ++i) {
         auto dim = bvd_op->GetBaseIndexDimension(0, i);
-        if (dim == outer) {
+        if (dim == dims[0]) {
           CHECK(op->args[i].as<VarNode>());
           // arg_dims.push_back(fused);
           args.push_back(fused_iv->var);
-        } else if (dim == inner) {
+        } else if (dims.Contains(dim)) {
           CHECK(op->args[i].as<VarNode>());
         } else {
           args.push_back(op->args[i]);
@@ -58,16 +61,27 @@ class FuseRewriter : public ExprMutator {
   }
 
   const Map<Operation, Operation>& rmap;
-  Dimension outer;
-  Dimension inner;
+  Array<Dimension> dims;
   Dimension fused;
   IterVar fused_iv;
 };
 
-Map<Operation, Operation> fuse_ragged_axis(Array<Tensor> input_tensors, Tensor output_tensor,
-                                           Dimension outer, Dimension inner, Dimension fused,
+// Fuses the dimensions dims, outermost first, of the tensors of the
+// graph between input_tensors and output_tensor into the single
+// dimension fused of the given extent. Fusing all the levels at once,
+// rather than a pair at a time, rewrites the graph once and creates
+// no intermediate fused dimensions.
+Map<Operation, Operation> fuse_ragged_axes(Array<Tensor> input_tensors, Tensor output_tensor,
+                                           Array<Dimension> dims, Dimension fused,
                                            PrimExpr extent) {
+  CHECK_GE(dims.size(), 2) << "Need at least two dimensions to fuse";
   Array<Operation> graph_ops = GetSubGraph({output_tensor}, input_tensors, true);
+  auto contains_all = [&dims](const Array<Dimension>& dimensions) {
+    for (const auto& dim : dims) {
+      if (!dimensions.Contains(dim)) return false;
+    }
+    return true;
+  };
 
   Map<Operation, Operation> rewritten;
   Map<Operation, Operation> ret;
@@ -77,10 +91,7 @@ Map<Operation, Operation> fuse_ragged_axis(Array<Tensor> input_tensors, Tensor o
     auto bvd_op = op.as<BaseVarDimOpNode>();
     if (auto pop = op.as<PlaceholderOpNode>()) {
       Array<Dimension> dimensions = pop->self_index_dimensions;
-      if (dimensions.Contains(outer) && dimensions.Contains(inner)) {
-        IterVar ivo = pop->GetIterVarFromDim(0, outer);
-        IterVar ivi = pop->GetIterVarFromDim(0, inner);
-
+      if (contains_all(dimensions)) {
         IterVar ivf = IterVarNode::make(Range::make_by_min_extent(0, extent),
                                         Var("fused", DataType::Int(32)), kDataPar);
         auto layout = pop->layout;
@@ -93,14 +104,14 @@ Map<Operation, Operation> fuse_ragged_axis(Array<Tensor> input_tensors, Tensor o
         for (size_t i = 0; i < dimensions.size(); ++i) {
           auto dim = dimensions[i];
           auto iv = pop->GetIterVarFromDim(0, dim);
-          if (dim == outer) {
+          if (dim == dims[0]) {
             fused_dimensions.push_back(fused);
             fused_axis.push_back(ivf);
             fused_l_maxes.push_back(extent);
             fused_l_funs.push_back(
                 UninterpFunNode::from_constant("f", extent, UninterpFunNode::kLFun));
             continue;
-          } else if (dim == inner) {
+          } else if (dims.Contains(dim)) {
             continue;
           }
           fused_dimensions.push_back(dim);
@@ -120,10 +131,7 @@ Map<Operation, Operation> fuse_ragged_axis(Array<Tensor> input_tensors, Tensor o
     } else if (auto cop = op.as<ComputeOpNode>()) {
       CHECK_EQ(op->num_outputs(), 1);
       Array<Dimension> dimensions = cop->root_index_dimensions;
-      if (dimensions.Contains(outer) && dimensions.Contains(inner)) {
-        IterVar ivo = cop->GetIterVarFromDim(0, outer);
-        IterVar ivi = cop->GetIterVarFromDim(0, inner);
-
+      if (contains_all(dimensions)) {
         IterVar ivf = IterVarNode::make(Range::make_by_min_extent(0, extent),
                                         Var("fused", DataType::Int(32)), kDataPar);
 
@@ -139,7 +147,7 @@ Map<Operation, Operation> fuse_ragged_axis(Array<Tensor> input_tensors, Tensor o
         for (size_t i = 0; i < dimensions.size(); ++i) {
           auto dim = dimensions[i];
           auto iv = cop->axis[i];
-          if (dim == outer) {
+          if (dim == dims[0]) {
             fused_dimensions.push_back(fused);
             fused_axis.push_back(ivf);
             if (layout.defined()) {
@@ -155,7 +163,7 @@ Map<Operation, Operation> fuse_ragged_axis(Array<Tensor> input_tensors, Tensor o
                   UninterpFunNode::from_constant("z", 0, UninterpFunNode::kLFun));
             }
             continue;
-          } else if (dim == inner) {
+          } else if (dims.Contains(dim)) {
             continue;
           }
           fused_dimensions.push_back(dim);
@@ -171,7 +179,7 @@ Map<Operation, Operation> fuse_ragged_axis(Array<Tensor> input_tensors, Tensor o
           }
         }
 
-        FuseRewriter rewriter(rewritten, outer, inner, fused, ivf);
+        FuseRewriter rewriter(rewritten, dims, fused, ivf);
         Array<PrimExpr> fused_body;
         Array<PrimExpr> fused_pred;
         for (auto e : cop->body) {
@@ -215,9 +223,11 @@ TVM_REGISTER_GLOBAL("te.FuseRaggedAxis")
     .set_body_typed([](Array<Tensor> input_tensors, Tensor output_tensor, Dimension outer,
                        Dimension inner, Dimension fused, PrimExpr extent) {
       // std::cout << "[FA] Fusing Ragged Axis" << std::endl;
-      return fuse_ragged_axis(input_tensors, output_tensor, outer, inner, fused, extent);
+      return fuse_ragged_axes(input_tensors, output_tensor, {outer, inner}, fused, extent);
     });
 
+TVM_REGISTER_GLOBAL("te.FuseRaggedAxes").set_body_typed(fuse_ragged_axes);
+
 }  // namespace te
 }  // namespace tvm
 
@@ -28,6 +28,8 @@
 #include <tvm/tir/expr.h>
 #include <tvm/tir/ir_pass.h>
 
+#include <mutex>
+
 #include "../../arith/compute_expr.h"
 #include "../../runtime/thread_storage_scope.h"
 #include "../../tir/ir/var_replacer.h"
@@ -1290,9 +1292,55 @@ void Update(std::unordered_map<const DimensionNode*, Range>* p_state, const Dime
   }
 }
 
+// Memoization of DimensionPassDownDomain. The result only depends on
+// the op, the relations, which are only ever appended to, and the
+// domains passed down, which are compared by identity as they usually
+// come from the same bounds map. The memo of a stage is shared by the
+// threads building stage bodies in ScheduleOps, hence the lock.
+static std::mutex dim_domain_memo_mutex;
+static constexpr size_t kMaxDimensionDomainMemos = 8;
+
+static bool SameDomains(const std::unordered_map<const DimensionNode*, Range>& a,
+                        const std::unordered_map<const DimensionNode*, Range>& b) {
+  if (a.size() != b.size()) return false;
+  for (const auto& it : a) {
+    auto jt = b.find(it.first);
+    if (jt == b.end() || !jt->second.same_as(it.second)) return false;
+  }
+  return true;
+}
+
+static void DimensionPassDownDomainImpl(Stage s, const BaseVarDimOpNode* op,
+                                        std::unordered_map<const DimensionNode*, Range>* p_state,
+                                        bool allow_missing);
+
 void DimensionPassDownDomain(Stage s, const BaseVarDimOpNode* op,
                              std::unordered_map<const DimensionNode*, Range>* p_state,
                              bool allow_missing) {
+  const auto& relations = s->dim_relation_graph->relations;
+  {
+    std::lock_guard<std::mutex> lock(dim_domain_memo_mutex);
+    for (const auto& memo : s->dim_domain_memo) {
+      if (memo.op == op && memo.relations == relations.get() &&
+          memo.num_relations == relations.size() && memo.allow_missing == allow_missing &&
+          SameDomains(memo.input, *p_state)) {
+        *p_state = memo.output;
+        return;
+      }
+    }
+  }
+  DimensionDomainMemo memo{op, relations.get(), relations.size(), allow_missing, *p_state, {}};
+  DimensionPassDownDomainImpl(s, op, p_state, allow_missing);
+  memo.output = *p_state;
+  std::lock_guard<std::mutex> lock(dim_domain_memo_mutex);
+  auto& memos = s->dim_domain_memo;
+  if (memos.size() == kMaxDimensionDomainMemos) memos.erase(memos.begin());
+  memos.push_back(std::move(memo));
+}
+
+static void DimensionPassDownDomainImpl(Stage s, const BaseVarDimOpNode* op,
+                                        std::unordered_map<const DimensionNode*, Range>* p_state,
+                                        bool allow_missing) {
   // std::cout << "[DPDD] Stage " << s << std::endl;
   const DimensionRelationGraph& graph = s->dim_relation_graph;
   arith::Analyzer analyzer;
@@ -1451,7 +1499,8 @@ void DimensionPassUpBitMaskExact(const Stage& stage,
 Modes DimensionPassDownModes(Stage& stage, const BaseVarDimOpNode* compute_op,
                              // const std::unordered_map<const DimensionNode*, Range>& dom_map,
                              const Modes& root_layout) {
-  if (stage->dim_relation_graph->relations.size() == 0) {
+  const DimensionRelationGraph& graph = stage->dim_relation_graph;
+  if (!graph->IsChanged()) {
     return root_layout;
   }
   std::unordered_map<const DimensionNode*, UninterpFun> l_funs;
@@ -1459,18 +1508,26 @@ Modes DimensionPassDownModes(Stage& stage, const BaseVarDimOpNode* compute_op,
     l_funs[root_layout->dimensions[i].operator->()] = root_layout->l_funs[i];
   }
 
-  for (size_t i = stage->dim_relation_graph->relations.size(); i != 0; --i) {
-    DimensionRelation rel = stage->dim_relation_graph->relations[i - 1];
+  auto ceil_div = [](PrimExpr a, PrimExpr b) { return indexdiv(a + (b - 1), b); };
+  // forward iteration on relations
+  for (DimensionRelation rel : graph->relations) {
     if (const DimensionSplitNode* s = rel.as<DimensionSplitNode>()) {
       CHECK(l_funs.count(s->parent.operator->()));
       UninterpFun parent_fun = l_funs.at(s->parent.operator->());
       UninterpFun inner_fun = UninterpFunNode::from_constant(s->inner->name + "_luf", s->factor);
-      UninterpFun outer_fun =
-          UninterpFunNode::make(s->outer->name + "_luf",
-                                Range::make_by_min_extent(parent_fun->range->min / s->factor,
-                                                          parent_fun->range->extent / s->factor),
-                                parent_fun->dimensions, parent_fun->parameters,
-                                parent_fun->body / s->factor, UninterpFunNode::kLFun);
+      // The outer dimension of a split ragged dimension is ragged
+      // itself, and depends on the same dimension as its parent. The
+      // last tile of every row is padded.
+      PrimExpr parent_body =
+          parent_fun->body.defined()
+              ? parent_fun->body
+              : parent_fun.MakeCallTo(parent_fun->parameters, parent_fun->dimensions);
+      UninterpFun outer_fun = UninterpFunNode::make(
+          s->outer->name + "_luf",
+          Range::make_by_min_max_inclusive(ceil_div(parent_fun->range->min, s->factor),
+                                           ceil_div(parent_fun->range->max_inclusive(), s->factor)),
+          parent_fun->dimensions, parent_fun->parameters, ceil_div(parent_body, s->factor),
+          UninterpFunNode::kLFun);
       l_funs[s->inner.operator->()] = inner_fun;
       l_funs[s->outer.operator->()] = outer_fun;
     } else if (const RaggedDimensionFuseNode* s = rel.as<RaggedDimensionFuseNode>()) {
@@ -1532,22 +1589,29 @@ Modes DimensionPassDownModes(Stage& stage, const BaseVarDimOpNode* compute_op,
 
   Array<PrimExpr> leaf_l_fun_maxs;
   Array<UninterpFun> leaf_l_funs;
-  Map<Dimension, UninterpFun> leaf_a_funs;
-  for (auto dim : stage->dim_relation_graph->leaf_dimensions) {
+  for (auto dim : graph->leaf_dimensions) {
     CHECK(l_funs.count(dim.operator->()));
     auto l_fun = l_funs.at(dim.operator->());
+    for (auto dependent_dim : l_fun->dimensions) {
+      CHECK(graph->leaf_dimensions.Contains(dependent_dim))
+          << "The ragged dimension " << dim << " of " << stage->op
+          << " depends on the dimension " << dependent_dim
+          << ", which is not a dimension of the changed layout.";
+    }
     leaf_l_funs.push_back(l_fun);
     leaf_l_fun_maxs.push_back(l_fun->range->max_inclusive());
-    leaf_a_funs.Set(dim, UninterpFunNode::make("a_fi", NullValue<Range>(), {}, {},
-                                               NullValue<PrimExpr>(), UninterpFunNode::kAFun));
   }
 
   if (root_layout->loop_layout) {
     CHECK(false);
     return {};
   } else {
-    return ModesNode::make_storage_layout(stage->dim_relation_graph->leaf_dimensions,
-                                          leaf_l_fun_maxs, leaf_l_funs, leaf_a_funs);
+    // The A-function shells of the leaf layout are created by
+    // ModesNode::make and filled in by AFunctionGenerator, which
+    // reuses the bodies of the root layout wherever the dependences
+    // are unchanged.
+    return ModesNode::make_storage_layout(graph->leaf_dimensions, leaf_l_fun_maxs, leaf_l_funs,
+                                          Map<Dimension, UninterpFun>());
   }
 }
 
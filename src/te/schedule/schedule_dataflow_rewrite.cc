@@ -798,6 +798,80 @@ Schedule Schedule::normalize() {
   CheckSchedule(sn, "schedule_dataflow_rewrite.cc:832");
   return sn;
 }
+// If the extent of the factored axis depends on the outer axes of the
+// factored op, as when factoring a split of a ragged reduction, the
+// partials are stored in a ragged layout whose factored dimension
+// only has the valid entries, instead of being padded to the maximum
+// extent. The final reduction then only iterates over them as well.
+// Returns false, and the partials are stored densely, if the factored
+// axis is not ragged or depends on inner axes.
+bool RaggedRFactorLayouts(const ComputeOpNode* n, const ComputeOpNode* compute_op,
+                          const IterVar& factor_pos_iv, Modes* p_storage_layout,
+                          Modes* p_loop_layout) {
+  PrimExpr extent = factor_pos_iv->dom->extent;
+  auto extent_vars = VarCollector().collect(extent);
+  size_t num_dependences = 0;
+  for (auto iv : n->axis) {
+    if (extent_vars.count(iv->var.get())) ++num_dependences;
+  }
+  if (num_dependences == 0) return false;
+
+  Array<PrimExpr> l_maxes;
+  Array<UninterpFun> l_fun_mins;
+  Array<UninterpFun> l_funs;
+  Array<Var> outer_params;
+  Array<Dimension> outer_dims;
+  std::unordered_map<const VarNode*, PrimExpr> param_sub;
+  Modes orig_layout = compute_op->output_layout(0);
+  for (size_t i = 0; i < n->axis.size(); ++i) {
+    IterVar iv = n->axis[i];
+    Dimension dim = n->root_index_dimensions[i];
+    PrimExpr zero = make_zero(DataType::Int(32));
+    l_fun_mins.push_back(UninterpFunNode::make("z", Range(zero, zero), Array<Dimension>(),
+                                               Array<Var>(), zero, UninterpFunNode::kLFun));
+    if (iv.same_as(factor_pos_iv)) {
+      // All the axes the extent depends on have to be outer to it.
+      if (num_dependences > 0) return false;
+      PrimExpr max_extent = Simplify(UninterpFun::InlineUninterpFunCalls(
+          UninterpFun::RelaxUninterpCallsMaxInclusive(extent, false)));
+      l_maxes.push_back(max_extent);
+      l_funs.push_back(UninterpFunNode::make(
+          n->name + "_rf_len", Range::make_by_min_max_inclusive(0, max_extent), outer_dims,
+          outer_params, VarReplacer(param_sub)(extent), UninterpFunNode::kLFun));
+      continue;
+    }
+
+    // The other dimensions keep the widths of the original layout.
+    size_t orig_idx = 0;
+    for (; orig_idx < compute_op->root_index_dimensions.size(); ++orig_idx) {
+      if (compute_op->root_index_dimensions[orig_idx] == dim) break;
+    }
+    CHECK_LT(orig_idx, compute_op->root_index_dimensions.size());
+    if (orig_layout.defined()) {
+      l_maxes.push_back(orig_layout->l_maxes[orig_idx]);
+      l_funs.push_back(orig_layout->l_funs[orig_idx]);
+    } else {
+      l_maxes.push_back(compute_op->output_shape_storage[orig_idx]);
+      PrimExpr width = compute_op->output_shape_storage[orig_idx];
+      l_funs.push_back(UninterpFunNode::make(dim->name + "_w", Range(width, width),
+                                             Array<Dimension>(), Array<Var>(), width,
+                                             UninterpFunNode::kLFun));
+    }
+
+    if (extent_vars.count(iv->var.get())) --num_dependences;
+    Var param = iv->var.copy_with_suffix(".p");
+    param_sub[iv->var.get()] = param;
+    outer_params.push_back(param);
+    outer_dims.push_back(dim);
+  }
+
+  *p_storage_layout = ModesNode::make_storage_layout(n->root_index_dimensions, l_maxes, l_funs,
+                                                     Map<Dimension, UninterpFun>());
+  *p_loop_layout =
+      ModesNode::make_loop_layout(n->root_index_dimensions, l_maxes, l_fun_mins, l_funs);
+  return true;
+}
+
 // Reduction along the factored axis is moved to a new stage. So in
 // the original stage, after the rfactor transform, the factored axis
 // is no longer a reduction axis, allowing one to parallelize along
@@ -968,8 +1042,16 @@ Array<Tensor> Schedule::rfactor(const Tensor& tensor, const IterVar& axis, int f
              "pos?";
     }
 
-    n->loop_layout_object =
-        ModesNode::make_loop_layout(n->root_index_dimensions, n->output_shape_storage, {}, {});
+    Modes storage_layout, loop_layout;
+    if (RaggedRFactorLayouts(n.get(), compute_op, factor_pos_iv, &storage_layout, &loop_layout)) {
+      n->loop_layout_object = loop_layout;
+      for (int i = 0; i < compute_op->num_outputs(); ++i) {
+        n->storage_layouts.push_back(storage_layout);
+      }
+    } else {
+      n->loop_layout_object =
+          ModesNode::make_loop_layout(n->root_index_dimensions, n->output_shape_storage, {}, {});
+    }
   }
   // predicate generation, copy not touched axis.
   int idx = tensor->value_index;
@@ -27,6 +27,8 @@
 
 #include <bitset>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "../../tir/ir/var_replacer.h"
 #include "graph.h"
@@ -592,6 +594,53 @@ Stage& Stage::peel(IterVar var) {  // NOLINT(*)
   return *this;
 }
 
+Stage& Stage::ragged_tile(IterVar parent, PrimExpr factor, IterVar* p_outer,
+                          IterVar* p_inner) {  // NOLINT(*)
+  CHECK(factor.as<IntImmNode>()) << "Ragged tiling needs a constant tile size";
+  split(parent, factor, p_outer, p_inner);
+  // The tiles are separated from the remainder during lowering, by
+  // the RaggedTileLoops pass.
+  pragma(*p_outer, "ragged_tile", factor);
+  return *this;
+}
+
+Stage& Stage::vectorized_fetch(IterVar parent, int lanes, IterVar thread, IterVar* p_tile,
+                               IterVar* p_lane) {  // NOLINT(*)
+  CHECK_GT(lanes, 0);
+  int factor = lanes;
+  if (thread.defined()) {
+    auto num_threads = thread->dom.defined() ? thread->dom->extent.as<IntImmNode>() : nullptr;
+    CHECK(num_threads) << "Vectorized fetches need a constant number of threads";
+    factor *= num_threads->value;
+  }
+  IterVar rest;
+  ragged_tile(parent, factor, p_tile, &rest);
+  if (thread.defined()) {
+    IterVar thread_iv;
+    split(rest, lanes, &thread_iv, p_lane);
+    bind(thread_iv, thread);
+  } else {
+    *p_lane = rest;
+  }
+  vectorize(*p_lane);
+
+  // The vectorized loop has to be the innermost one.
+  Array<IterVar> order = {*p_lane};
+  bool after = false;
+  for (auto iv : (*this)->leaf_iter_vars) {
+    if (after) order.push_back(iv);
+    if (iv.same_as(*p_lane)) after = true;
+  }
+  if (order.size() > 1) {
+    Array<IterVar> inner_first(order.begin() + 1, order.end());
+    inner_first.push_back(*p_lane);
+    // reorder assigns the given loops to the positions they occupy,
+    // in the given order.
+    reorder(inner_first);
+  }
+  return *this;
+}
+
 Stage& Stage::split_loop(IterVar var) {  // NOLINT(*)
   SetAttrIterType(operator->(), var, kSplit);
   return *this;
@@ -663,10 +712,12 @@ Stage& Stage::storage_align_dim(int dim_idx, int factor, int offset) {
   return *this;
 }
 
-Stage& Stage::double_buffer() {
+Stage& Stage::double_buffer(int num_stages) {
   StageNode* self = operator->();
   CHECK(!self->is_output) << "Cannot apply double buffer on output";
+  CHECK_GE(num_stages, 2) << "Double buffering needs at least two buffers";
   self->double_buffer = true;
+  self->double_buffer_stages = num_stages;
   return *this;
 }
 
@@ -719,6 +770,7 @@ Stage CopyStage(const Stage& s) {
 Schedule Schedule::copy() const {
   // map of stages.
   const ScheduleNode* self = operator->();
+  const_cast<ScheduleNode*>(self)->EnsurePostOrder();
   std::unordered_map<Stage, Stage, ObjectHash, ObjectEqual> smap;
   ObjectPtr<ScheduleNode> n = make_object<ScheduleNode>();
   n->outputs = self->outputs;
@@ -933,12 +985,15 @@ Stage Schedule::create_group(const Array<Tensor>& outputs, const Array<Tensor>&
   return gstage;
 }
 
-void Schedule::hfuse(const Array<Operation>& ops, const Array<IterVar>& ivs) {
+void Schedule::hfuse(const Array<Operation>& ops, const Array<IterVar>& ivs,
+                     const Array<PrimExpr>& weights) {
   ScheduleNode* self = operator->();
   int hfuse_group_num = self->num_hfuse_groups++;
   self->InitCache();
   const auto& op2stage_cache = self->op2stage_cache_;
   CHECK_EQ(ops.size(), ivs.size());
+  CHECK(weights.size() == 0 || weights.size() == ivs.size())
+      << "Either all or none of the hfused ops should have weights";
   for (size_t i = 0; i < ops.size(); ++i) {
     auto stage = op2stage_cache.at(ops[i].get());
     auto it = stage->iter_var_attrs.find(ivs[i]);
@@ -950,21 +1005,48 @@ void Schedule::hfuse(const Array<Operation>& ops, const Array<IterVar>& ivs) {
       n = make_object<IterVarAttrNode>();
     }
     n->hfuse_group_id = hfuse_group_num;
+    if (weights.size() > 0) n->hfuse_weight = weights[i];
     stage->iter_var_attrs.Set(ivs[i], IterVarAttr(n));
   }
 }
 
-void ScheduleNode::InvalidateCache() { op2stage_cache_.clear(); }
+void ScheduleNode::InvalidateCache() { cache_dirty_ = true; }
 
 void ScheduleNode::InitCache() {
-  if (op2stage_cache_.size() == stages.size()) return;
-  InvalidateCache();
+  if (!cache_dirty_ && op2stage_cache_.size() == stages.size()) return;
+  // Primitives only add stages or replace the ops of a few, so the
+  // entries of the other stages are kept.
   for (Stage s : stages) {
-    if (s->op.defined()) {
-      op2stage_cache_[s->op.get()] = s;
+    s->dim_domain_memo.clear();
+    if (!s->op.defined()) continue;
+    auto it = op2stage_cache_.find(s->op.get());
+    if (it == op2stage_cache_.end()) {
+      op2stage_cache_.emplace(s->op.get(), s);
+    } else if (!it->second.same_as(s)) {
+      it->second = s;
+    }
+  }
+  if (op2stage_cache_.size() != stages.size()) {
+    // Drop the entries of the ops that were replaced.
+    for (auto it = op2stage_cache_.begin(); it != op2stage_cache_.end();) {
+      if (it->second->op.get() != it->first) {
+        it = op2stage_cache_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  if (op2stage_cache_.size() != stages.size()) {
+    // Stages were removed.
+    op2stage_cache_.clear();
+    for (Stage s : stages) {
+      if (s->op.defined()) {
+        op2stage_cache_[s->op.get()] = s;
+      }
     }
   }
   CHECK_EQ(op2stage_cache_.size(), stages.size());
+  cache_dirty_ = false;
 }
 
 bool ScheduleNode::Contain(const Operation& op) const {
@@ -987,12 +1069,18 @@ void ScheduleNode::remakePostOrder() {
 
   auto g = te::CreateReadGraph(roots, true);
   Array<Operation> post_order = te::PostDFSOrder(roots, g);
-  Array<Stage> stages;
+  std::vector<Stage> stages;
+  stages.reserve(post_order.size());
   for (auto op : post_order) {
     CHECK(self->op2stage_cache_.count(op.get())) << op;
     stages.push_back(self->op2stage_cache_.at(op.get()));
   }
-  self->stages = stages;
+  self->stages = Array<Stage>(std::move(stages));
+  self->post_order_dirty_ = false;
+}
+
+void ScheduleNode::EnsurePostOrder() {
+  if (post_order_dirty_) remakePostOrder();
 }
 
 Schedule ScheduleNode::make(Array<Operation> ops) {
@@ -1223,6 +1311,20 @@ TVM_REGISTER_GLOBAL("te.StageNoUnrollVThread").set_body_method(&Stage::no_unroll
 
 TVM_REGISTER_GLOBAL("te.StagePeel").set_body_method(&Stage::peel);
 
+TVM_REGISTER_GLOBAL("te.StageRaggedTile")
+    .set_body_typed([](Stage stage, IterVar parent, PrimExpr factor) {
+      IterVar outer, inner;
+      stage.ragged_tile(parent, factor, &outer, &inner);
+      return Array<IterVar>({outer, inner});
+    });
+
+TVM_REGISTER_GLOBAL("te.StageVectorizedFetch")
+    .set_body_typed([](Stage stage, IterVar parent, int lanes, IterVar thread) {
+      IterVar tile, lane;
+      stage.vectorized_fetch(parent, lanes, thread, &tile, &lane);
+      return Array<IterVar>({tile, lane});
+    });
+
 TVM_REGISTER_GLOBAL("te.StageSplitLoop").set_body_method(&Stage::split_loop);
 
 TVM_REGISTER_GLOBAL("te.StageMarkNoRelax").set_body_method(&Stage::mark_no_relax);
@@ -27,9 +27,14 @@
 #include <tvm/tir/ir_pass.h>
 #include <tvm/tir/stmt_functor.h>
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "../../tir/ir/var_replacer.h"
 #include "../../tir/pass/ir_util.h"
@@ -43,21 +48,35 @@ namespace te {
 
 using namespace tir;
 
+// The bodies of the producers of stages, which only depend on the
+// stage and the bounds, and can thus be built ahead of time.
+using ProducerMap = std::unordered_map<const Object*, Stmt>;
+
 Stmt MakePipeline(const Stage& s, const std::unordered_map<IterVar, Range>& dom_map,
                   const std::unordered_map<std::string, Range>& env_dom_map,
                   const std::unordered_map<std::string, IterVar>& env_var_map,
                   const std::unordered_map<const VarNode*, std::string>& bind_map,
                   const AttachPathWithStages& attach_path, Stmt consumer,
-                  bool debug_keep_trivial_loop) {
-  Stmt producer =
-      s->op->BuildProvide(s, dom_map, env_dom_map, env_var_map, bind_map, attach_path.second,
-                          attach_path.first, debug_keep_trivial_loop);
+                  bool debug_keep_trivial_loop, const ProducerMap* producers = nullptr,
+                  PrimExpr producer_guard = PrimExpr()) {
+  Stmt producer;
+  if (producers && producers->count(s.get())) {
+    producer = producers->at(s.get());
+  } else {
+    producer =
+        s->op->BuildProvide(s, dom_map, env_dom_map, env_var_map, bind_map, attach_path.second,
+                            attach_path.first, debug_keep_trivial_loop);
+  }
 
   if (producer.defined()) {
     producer = ProducerConsumerNode::make(s->op, true, producer);
+    if (producer_guard.defined()) {
+      producer = IfThenElseNode::make(producer_guard, producer);
+    }
   }
   if (s->double_buffer) {
-    producer = AttrStmtNode::make(s->op, tir::attr::double_buffer_scope, 1, producer);
+    producer = AttrStmtNode::make(s->op, tir::attr::double_buffer_scope,
+                                   s->double_buffer_stages, producer);
   }
   Stmt pipeline = producer;
 
@@ -89,7 +108,8 @@ class InjectAttach : public StmtMutator {
                const std::unordered_map<std::string, Range>& env_dom_map,
                const std::unordered_map<std::string, IterVar>& env_var_map,
                const std::unordered_map<const VarNode*, std::string>& bind_map,
-               const AttachPathWithStages& attach_path, bool debug_keep_trivial_loop)
+               const AttachPathWithStages& attach_path, bool debug_keep_trivial_loop,
+               const ProducerMap& producers)
       : stage_(stage),
         attach_spec_(attach_spec),
         dom_map_(dom_map),
@@ -97,7 +117,8 @@ class InjectAttach : public StmtMutator {
         env_var_map_(env_var_map),
         bind_map_(bind_map),
         attach_path_(attach_path),
-        debug_keep_trivial_loop_(debug_keep_trivial_loop) {}
+        debug_keep_trivial_loop_(debug_keep_trivial_loop),
+        producers_(producers) {}
 
   Stmt VisitStmt(const Stmt& input_stmt) final {
     CHECK(input_stmt.defined());
@@ -110,10 +131,10 @@ class InjectAttach : public StmtMutator {
         CHECK(!found_attach) << "Find IterVar " << attach_spec_->attach_ivar
                              << " in multiple places in the IR " << input_stmt;
         found_attach = true;
-        stmt =
-            AttrStmtNode::make(op->node, op->attr_key, op->value,
-                               MakePipeline(stage_, dom_map_, env_dom_map_, env_var_map_, bind_map_,
-                                            attach_path_, op->body, debug_keep_trivial_loop_));
+        stmt = AttrStmtNode::make(
+            op->node, op->attr_key, op->value,
+            MakePipeline(stage_, dom_map_, env_dom_map_, env_var_map_, bind_map_, attach_path_,
+                         op->body, debug_keep_trivial_loop_, &producers_));
       }
     }
     return stmt;
@@ -135,6 +156,8 @@ class InjectAttach : public StmtMutator {
   // Whether keep trivial loops with extent of 1 during lowering.
   // This is a debug feature for dataflow/axis analysis
   bool debug_keep_trivial_loop_;
+  // Producers of stages built ahead of time.
+  const ProducerMap& producers_;
 };
 
 // inject the operator's realization on the stmt.
@@ -146,7 +169,7 @@ class InjectScanStep : public StmtMutator {
                  const std::unordered_map<std::string, IterVar>& env_var_map,
                  const std::unordered_map<const VarNode*, std::string>& bind_map,
                  const AttachPathWithStages& attach_path, bool is_init,
-                 bool debug_keep_trivial_loop)
+                 bool debug_keep_trivial_loop, const ProducerMap& producers)
       : stage_(stage),
         scan_op_(scan_op),
         dom_map_(dom_map),
@@ -155,7 +178,8 @@ class InjectScanStep : public StmtMutator {
         bind_map_(bind_map),
         attach_path_(attach_path),
         is_init_(is_init),
-        debug_keep_trivial_loop_(debug_keep_trivial_loop) {}
+        debug_keep_trivial_loop_(debug_keep_trivial_loop),
+        producers_(producers) {}
 
   Stmt VisitStmt(const Stmt& input_stmt) final {
     CHECK(input_stmt.defined());
@@ -167,10 +191,10 @@ class InjectScanStep : public StmtMutator {
       if (op->node.same_as(scan_op_)) {
         // std::cout << "[OPS] Injecting " << stage_->op << " at " << scan_op_ << std::endl;
         found_attach = true;
-        stmt =
-            AttrStmtNode::make(op->node, op->attr_key, op->value,
-                               MakePipeline(stage_, dom_map_, env_dom_map_, env_var_map_, bind_map_,
-                                            attach_path_, op->body, debug_keep_trivial_loop_));
+        stmt = AttrStmtNode::make(
+            op->node, op->attr_key, op->value,
+            MakePipeline(stage_, dom_map_, env_dom_map_, env_var_map_, bind_map_, attach_path_,
+                         op->body, debug_keep_trivial_loop_, &producers_));
       }
     }
     return stmt;
@@ -194,6 +218,8 @@ class InjectScanStep : public StmtMutator {
   // Whether keep trivial loops with extent of 1 during lowering.
   // This is a debug feature for dataflow/axis analysis
   bool debug_keep_trivial_loop_;
+  // Producers of stages built ahead of time.
+  const ProducerMap& producers_;
 };
 
 // inject the operator's realization on the stmt.
@@ -205,7 +231,7 @@ class InjectConditionalStep : public StmtMutator {
                         const std::unordered_map<std::string, IterVar>& env_var_map,
                         const std::unordered_map<const VarNode*, std::string>& bind_map,
                         const AttachPathWithStages& attach_path, bool is_else,
-                        bool debug_keep_trivial_loop)
+                        bool debug_keep_trivial_loop, const ProducerMap& producers)
       : stage_(stage),
         conditional_op_(conditional_op),
         dom_map_(dom_map),
@@ -214,7 +240,8 @@ class InjectConditionalStep : public StmtMutator {
         bind_map_(bind_map),
         attach_path_(attach_path),
         is_else_(is_else),
-        debug_keep_trivial_loop_(debug_keep_trivial_loop) {}
+        debug_keep_trivial_loop_(debug_keep_trivial_loop),
+        producers_(producers) {}
 
   Stmt VisitStmt(const Stmt& input_stmt) final {
     CHECK(input_stmt.defined());
@@ -227,10 +254,10 @@ class InjectConditionalStep : public StmtMutator {
         // std::cout << "[OPS] Injecting " << stage_->op << " at " << conditional_op_ <<
         // std::endl;
         found_attach = true;
-        stmt =
-            AttrStmtNode::make(op->node, op->attr_key, op->value,
-                               MakePipeline(stage_, dom_map_, env_dom_map_, env_var_map_, bind_map_,
-                                            attach_path_, op->body, debug_keep_trivial_loop_));
+        stmt = AttrStmtNode::make(
+            op->node, op->attr_key, op->value,
+            MakePipeline(stage_, dom_map_, env_dom_map_, env_var_map_, bind_map_, attach_path_,
+                         op->body, debug_keep_trivial_loop_, &producers_));
       }
     }
     return stmt;
@@ -254,6 +281,8 @@ class InjectConditionalStep : public StmtMutator {
   // Whether keep trivial loops with extent of 1 during lowering.
   // This is a debug feature for dataflow/axis analysis
   bool debug_keep_trivial_loop_;
+  // Producers of stages built ahead of time.
+  const ProducerMap& producers_;
 };
 
 // inject the operator's realization on the stmt.
@@ -265,7 +294,7 @@ class InjectSingleKernelInput : public StmtMutator {
                           const std::unordered_map<std::string, IterVar>& env_var_map,
                           const std::unordered_map<const VarNode*, std::string>& bind_map,
                           const AttachPathWithStages& attach_path, bool is_init,
-                          bool debug_keep_trivial_loop)
+                          bool debug_keep_trivial_loop, const ProducerMap& producers)
       : stage_(stage),
         single_kernel_op_(single_kernel_op),
         dom_map_(dom_map),
@@ -274,7 +303,8 @@ class InjectSingleKernelInput : public StmtMutator {
         bind_map_(bind_map),
         attach_path_(attach_path),
         is_init_(is_init),
-        debug_keep_trivial_loop_(debug_keep_trivial_loop) {}
+        debug_keep_trivial_loop_(debug_keep_trivial_loop),
+        producers_(producers) {}
 
   Stmt VisitStmt(const Stmt& input_stmt) final {
     CHECK(input_stmt.defined());
@@ -284,10 +314,10 @@ class InjectSingleKernelInput : public StmtMutator {
     if (op != nullptr && ((op->attr_key == attr::single_kernel_input_scope))) {
       if (op->node.same_as(single_kernel_op_)) {
         found_attach = true;
-        stmt =
-            AttrStmtNode::make(op->node, op->attr_key, op->value,
-                               MakePipeline(stage_, dom_map_, env_dom_map_, env_var_map_, bind_map_,
-                                            attach_path_, op->body, debug_keep_trivial_loop_));
+        stmt = AttrStmtNode::make(
+            op->node, op->attr_key, op->value,
+            MakePipeline(stage_, dom_map_, env_dom_map_, env_var_map_, bind_map_, attach_path_,
+                         op->body, debug_keep_trivial_loop_, &producers_));
         // std::cout << "[BODY] " << stmt << std::endl;
       }
     }
@@ -312,6 +342,69 @@ class InjectSingleKernelInput : public StmtMutator {
   // Whether keep trivial loops with extent of 1 during lowering.
   // This is a debug feature for dataflow/axis analysis
   bool debug_keep_trivial_loop_;
+  // Producers of stages built ahead of time.
+  const ProducerMap& producers_;
+};
+
+// Applies the non-branching lowerings of conditional ops to the
+// branches injected into their scopes. Predicated branches store a
+// select between their value and the value of the other branch, which
+// shares the conditional's output buffer. Partitioned branches see the
+// element at the current position of the permutation.
+class LowerConditionalScopes : public StmtExprMutator {
+ public:
+  Stmt VisitStmt_(const AttrStmtNode* op) final {
+    if (op->attr_key != attr::conditional_then_scope &&
+        op->attr_key != attr::conditional_else_scope) {
+      return StmtExprMutator::VisitStmt_(op);
+    }
+    auto conditional = op->node.as<ConditionalOpNode>();
+    CHECK(conditional);
+    bool is_else = op->attr_key == attr::conditional_else_scope;
+    if (conditional->lowering_mode == ConditionalOpNode::kPredicated) {
+      // Branches may be nested in other predicated branches.
+      auto old_branch_ops = branch_ops_;
+      auto old_condition = condition_;
+      auto old_is_else = is_else_;
+      for (const auto& t : is_else ? conditional->else_case : conditional->then_case) {
+        branch_ops_.insert(t->op.get());
+      }
+      condition_ = op->value;
+      is_else_ = is_else;
+      Stmt body = this->VisitStmt(op->body);
+      branch_ops_ = old_branch_ops;
+      condition_ = old_condition;
+      is_else_ = old_is_else;
+      return AttrStmtNode::make(op->node, op->attr_key, op->value, body);
+    }
+
+    Stmt body = this->VisitStmt(op->body);
+    if (conditional->lowering_mode == ConditionalOpNode::kPartitioned) {
+      Var pos = conditional->explicit_loop_ivs[0]->var;
+      PrimExpr elem = conditional->partition_perm_uf.MakeCallTo(
+          Array<PrimExpr>({pos}), Array<Dimension>({conditional->explicit_dims[0]}));
+      body = VarReplacer({{pos.get(), elem}})(body);
+    }
+    return AttrStmtNode::make(op->node, op->attr_key, op->value, body);
+  }
+
+  Stmt VisitStmt_(const ProvideNode* op) final {
+    Stmt stmt = StmtExprMutator::VisitStmt_(op);
+    op = stmt.as<ProvideNode>();
+    if (!branch_ops_.count(op->func.get())) return stmt;
+    PrimExpr other = CallNode::make(op->value.dtype(), op->func->func_name(), op->args,
+                                    CallNode::Halide, op->func, op->value_index);
+    PrimExpr value = is_else_ ? SelectNode::make(condition_, other, op->value)
+                              : SelectNode::make(condition_, op->value, other);
+    return ProvideNode::make(op->func, op->value_index, value, op->args);
+  }
+
+ private:
+  // The final ops of the predicated branches being visited, and the
+  // condition of the innermost one.
+  std::unordered_set<const Object*> branch_ops_;
+  PrimExpr condition_;
+  bool is_else_{false};
 };
 
 // Postprocessing of schedule op
@@ -746,9 +839,59 @@ class SimplifyFusionFunctions : public StmtExprMutator {
   std::unordered_set<const Object*> fused_functions;
 };
 
+// Builds the producers of the stages that get one on num_threads
+// threads. Building a producer only reads the schedule and the bounds,
+// and the position memo of layouts, which may be shared by stages, is
+// guarded by a lock.
+ProducerMap BuildProducers(const std::vector<Stage>& stages,
+                           const std::unordered_map<IterVar, Range>& dom_map,
+                           const Map<Stage, Map<std::string, Range>>& env_dom_maps,
+                           const Map<Stage, Map<std::string, IterVar>>& env_var_maps,
+                           const std::unordered_map<const VarNode*, std::string>& bind_map,
+                           const AttachPathWithStages& attach_path, bool debug_keep_trivial_loop,
+                           int num_threads) {
+  std::vector<Stage> work;
+  for (Stage s : stages) {
+    if (s->op.as<PlaceholderOpNode>() || s.GetAttachSpec()->attach_type == kInlinedAlready) {
+      continue;
+    }
+    work.push_back(s);
+  }
+  std::vector<Stmt> results(work.size());
+  std::vector<std::exception_ptr> errors(work.size());
+  std::atomic<size_t> next{0};
+  auto worker = [&]() {
+    for (size_t i = next++; i < work.size(); i = next++) {
+      Stage s = work[i];
+      try {
+        results[i] = s->op->BuildProvide(
+            s, dom_map, as_unordered_map(env_dom_maps.at(s)), as_unordered_map(env_var_maps.at(s)),
+            bind_map, attach_path.second, attach_path.first, debug_keep_trivial_loop);
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 1; i < std::min<int>(num_threads, work.size()); ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) thread.join();
+
+  ProducerMap ret;
+  for (size_t i = 0; i < work.size(); ++i) {
+    // Report errors as if the stages had been built in order.
+    if (errors[i]) std::rethrow_exception(errors[i]);
+    ret[work[i].get()] = results[i];
+  }
+  return ret;
+}
+
 Stmt ScheduleOps(Schedule sch, InferBoundsResult bounds, bool debug_keep_trivial_loop,
                  bool distinct_device, bool debug_fill_function_bodies,
-                 Array<Buffer> afuns_needed_for) {
+                 Array<Buffer> afuns_needed_for, bool prep_code_on_device,
+                 bool fused_maps_on_the_fly, int num_threads) {
   Map<IterVar, Range> dom_map_ = bounds->bounds;
   Map<Stage, Map<std::string, Range>> env_dom_map_ = bounds->env_bounds;
   Map<Stage, Map<std::string, IterVar>> env_var_map_ = bounds->env_vars;
@@ -768,19 +911,30 @@ Stmt ScheduleOps(Schedule sch, InferBoundsResult bounds, bool debug_keep_trivial
 
   // Generate A functions for all layouts
   FunctionGenerator function_generator(sch, dom_map, distinct_device, debug_fill_function_bodies,
-                                       afuns_needed_for);
+                                       afuns_needed_for, prep_code_on_device,
+                                       fused_maps_on_the_fly);
   function_generator.GenerateAFunctions();
   PrimExpr afun_buf_size = function_generator.GetCurrentAggregateBufferSize();
   // Map<Buffer, Buffer> prep_buffer_map;
   // AFunGenerator generator(sch);
   // Stmt a_fun_stmt = generator.GenerateAndSetAFuns(&prep_buffer_map);
 
-  sch.freeze_tensor_dimensions(dom_map_);
+  // The A-functions of the layouts changed by tensor dimension
+  // transforms are generated from their leaf layouts.
+  Array<Stage> relaid_stages = sch.freeze_tensor_dimensions(dom_map_);
+  if (relaid_stages.size() > 0) {
+    function_generator.GenerateAFunctions(relaid_stages);
+  }
+  function_generator.GeneratePartitionFunctions();
 
   Stmt body = Stmt();
   // scan init and scan updates
   std::unordered_map<Operation, Operation> scan_init;
   std::unordered_map<Operation, Operation> single_kernel_inputs;
+  // Specializations of envelopes that dispatch to one of them run only
+  // when selected.
+  std::unordered_map<const Object*, PrimExpr> dispatch_guards;
+  Array<Operation> dispatching_envelopes;
   for (Stage s : sch->stages) {
     if (const ScanOpNode* scan = s->op.as<ScanOpNode>()) {
       for (Tensor t : scan->init) {
@@ -801,6 +955,15 @@ Stmt ScheduleOps(Schedule sch, InferBoundsResult bounds, bool debug_keep_trivial
           single_kernel_inputs[t->op] = s->op;
         }
       }
+    } else if (const SpecializationEnvelopeOpNode* envelope =
+                   s->op.as<SpecializationEnvelopeOpNode>()) {
+      if (envelope->dispatch_var.defined()) {
+        for (size_t i = 0; i < envelope->inputs.size(); ++i) {
+          dispatch_guards[envelope->inputs[i][0]->op.get()] =
+              EQNode::make(envelope->dispatch_var, IntImm(DataType::Int(32), i));
+        }
+        dispatching_envelopes.push_back(s->op);
+      }
     }
   }
   // verify correctness of group.
@@ -872,6 +1035,12 @@ Stmt ScheduleOps(Schedule sch, InferBoundsResult bounds, bool debug_keep_trivial
   }
   AttachPathWithStages attach_path = CreateAttachPathWithStages(sch);
 
+  ProducerMap producers;
+  if (num_threads > 1) {
+    producers = BuildProducers(stage_order, dom_map, env_dom_map_, env_var_map_, bind_map,
+                               attach_path, debug_keep_trivial_loop, num_threads);
+  }
+
   // std::cout << "[SO] Original Order " << std::endl;
   // for (auto s : sch->stages) {
   //   std::cout << "[SO]   " << s << std::endl;
@@ -923,14 +1092,15 @@ Stmt ScheduleOps(Schedule sch, InferBoundsResult bounds, bool debug_keep_trivial
       // std::cout << "[OPS]  " << __LINE__ << std::endl;
       CHECK(body.defined());
       InjectScanStep mu(s, scan_init.at(s->op), dom_map, env_dom_map, env_var_map, bind_map,
-                        attach_path, true, debug_keep_trivial_loop);
+                        attach_path, true, debug_keep_trivial_loop, producers);
       body = mu(std::move(body));
       CHECK(mu.found_attach) << "did not find attachment point for scan.init";
     } else if (attach_spec->attach_type == kSingleKernelScope) {
       // std::cout << "[OPS]  " << __LINE__ << std::endl;
       CHECK(body.defined());
       InjectSingleKernelInput mu(s, attach_spec->attach_stage->op, dom_map, env_dom_map,
-                                 env_var_map, bind_map, attach_path, true, debug_keep_trivial_loop);
+                                 env_var_map, bind_map, attach_path, true, debug_keep_trivial_loop,
+                                 producers);
       body = mu(std::move(body));
       CHECK(mu.found_attach) << "did not find attachment point for scan.update";
     } else if (attach_spec->attach_type == kScanUpdate) {
@@ -938,7 +1108,7 @@ Stmt ScheduleOps(Schedule sch, InferBoundsResult bounds, bool debug_keep_trivial
       // Handle scan update
       CHECK(body.defined());
       InjectScanStep mu(s, attach_spec->attach_stage->op, dom_map, env_dom_map, env_var_map,
-                        bind_map, attach_path, false, debug_keep_trivial_loop);
+                        bind_map, attach_path, false, debug_keep_trivial_loop, producers);
       body = mu(std::move(body));
       CHECK(mu.found_attach) << "did not find attachment point for scan.update";
     } else if (attach_spec->attach_type == kConditionalThen) {
@@ -946,7 +1116,7 @@ Stmt ScheduleOps(Schedule sch, InferBoundsResult bounds, bool debug_keep_trivial
       // Handle scan update
       CHECK(body.defined());
       InjectConditionalStep mu(s, attach_spec->attach_stage->op, dom_map, env_dom_map, env_var_map,
-                               bind_map, attach_path, false, debug_keep_trivial_loop);
+                               bind_map, attach_path, false, debug_keep_trivial_loop, producers);
       body = mu(std::move(body));
       CHECK(mu.found_attach) << "did not find attachment point for scan.update";
     } else if (attach_spec->attach_type == kConditionalElse) {
@@ -954,7 +1124,7 @@ Stmt ScheduleOps(Schedule sch, InferBoundsResult bounds, bool debug_keep_trivial
       // Handle scan update
       CHECK(body.defined());
       InjectConditionalStep mu(s, attach_spec->attach_stage->op, dom_map, env_dom_map, env_var_map,
-                               bind_map, attach_path, true, debug_keep_trivial_loop);
+                               bind_map, attach_path, true, debug_keep_trivial_loop, producers);
       body = mu(std::move(body));
       CHECK(mu.found_attach) << "did not find attachment point for scan.update";
     } else if (attach_spec->attach_type == kInlinedAlready) {
@@ -963,8 +1133,10 @@ Stmt ScheduleOps(Schedule sch, InferBoundsResult bounds, bool debug_keep_trivial
     } else if (attach_spec->attach_type == kGroupRoot) {
       // std::cout << "[OPS]  " << __LINE__ << std::endl;
       CHECK(!s->group.defined());
+      auto it = dispatch_guards.find(s->op.get());
       body = MakePipeline(s, dom_map, env_dom_map, env_var_map, bind_map, attach_path, body,
-                          debug_keep_trivial_loop);
+                          debug_keep_trivial_loop, &producers,
+                          it != dispatch_guards.end() ? it->second : PrimExpr());
     } else {
       // std::cout << "[OPS]  " << __LINE__ << std::endl;
       // CHECK_EQ(attach_spec->attach_type, kScope) << s;
@@ -972,7 +1144,7 @@ Stmt ScheduleOps(Schedule sch, InferBoundsResult bounds, bool debug_keep_trivial
           << s;
       CHECK(body.defined());
       InjectAttach mutator(s, attach_spec, dom_map, env_dom_map, env_var_map, bind_map, attach_path,
-                           debug_keep_trivial_loop);
+                           debug_keep_trivial_loop, producers);
       // std::cout << "[BODY] "  << body << std::endl;
       body = mutator(std::move(body));
       CHECK(mutator.found_attach) << "did not find attachment point for " << s << " in "
@@ -984,6 +1156,20 @@ Stmt ScheduleOps(Schedule sch, InferBoundsResult bounds, bool debug_keep_trivial
     previous_hfuse_group_id = current_hfuse_group_id;
   }
 
+  for (const auto& s : sch->stages) {
+    if (dispatch_guards.count(s->op.get())) {
+      CHECK_EQ(s->attach_type, kGroupRoot)
+          << "Specializations of a dispatching envelope should be at the root: " << s;
+    }
+  }
+  // The specialization is picked once per call, so that each of them
+  // lowers to its own unguarded loop nests, or kernels on GPUs, which
+  // only the host code chooses between.
+  for (const auto& op : dispatching_envelopes) {
+    auto envelope = op.as<SpecializationEnvelopeOpNode>();
+    body = LetStmtNode::make(envelope->dispatch_var, envelope->DispatchValue(), body);
+  }
+  body = LowerConditionalScopes()(body);
   // std::cout << "Body after gen " << body << std::endl;
   body = function_generator.SimplifyFusionFunctions(body);
   // std::cout << "Body after function simpl " << body << std::endl;
@@ -1017,8 +1203,15 @@ Stmt ScheduleOps(Schedule sch, InferBoundsResult bounds, bool debug_keep_trivial
 TVM_REGISTER_GLOBAL("schedule.ScheduleOps").set_body([](TVMArgs args, TVMRetValue* ret) {
   if (args.size() == 2)
     *ret = ScheduleOps(args[0], args[1], false, true, true, {});
-  else
+  else if (args.size() == 6)
     *ret = ScheduleOps(args[0], args[1], args[2], args[3], args[4], args[5]);
+  else if (args.size() == 7)
+    *ret = ScheduleOps(args[0], args[1], args[2], args[3], args[4], args[5], args[6]);
+  else if (args.size() == 8)
+    *ret = ScheduleOps(args[0], args[1], args[2], args[3], args[4], args[5], args[6], args[7]);
+  else
+    *ret = ScheduleOps(args[0], args[1], args[2], args[3], args[4], args[5], args[6], args[7],
+                       args[8]);
 });
 
 }  // namespace te
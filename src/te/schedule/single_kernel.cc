@@ -116,7 +116,7 @@ Operation CreateSingleKernel(Schedule& sch, std::string name, std::string tag,
   // return envelope.output(0);
   // std::cout << "[SK] REt " << envelope << std::endl;
   CheckSchedule(sch, "single_kernel.cc:120_end_" + name, false);
-  sch->remakePostOrder();
+  sch->InvalidatePostOrder();
   return envelope;
 }
 
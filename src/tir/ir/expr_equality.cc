@@ -112,6 +112,8 @@ bool ExprEquality::VisitExpr_(const BroadcastNode* op1, const BroadcastNode* op2
   }
 
 bool ExprEquality::VisitExpr(PrimExpr e1, PrimExpr e2) const {
+  // Shared (say, interned) subexpressions.
+  if (e1.same_as(e2)) return true;
   CALL_VISIT_EXPR_EE_(AddNode, e1, e2);
   CALL_VISIT_EXPR_EE_(SubNode, e1, e2);
   CALL_VISIT_EXPR_EE_(MulNode, e1, e2);
@@ -149,6 +151,7 @@ bool ExprEquality::VisitExpr(PrimExpr e1, PrimExpr e2) const {
 }
 
 bool ExprEquality::VisitExprConst(const PrimExpr e1, const PrimExpr e2) const {
+  if (e1.same_as(e2)) return true;
   CALL_VISIT_EXPR_EE_(AddNode, e1, e2);
   CALL_VISIT_EXPR_EE_(SubNode, e1, e2);
   CALL_VISIT_EXPR_EE_(MulNode, e1, e2);
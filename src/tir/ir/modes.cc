@@ -39,9 +39,8 @@ Modes ModesNode::make(Array<tvm::te::Dimension> dimensions, Array<PrimExpr> l_ma
   n->l_fun_mins = l_fun_mins;
   n->a_funs = a_funs;
   n->loop_layout = is_loop_layout;
-  auto ret = Modes(n);
-  ret->setup_transitive_dependences();
-  return ret;
+  n->setup_transitive_dependences();
+  return Modes(n);
 }
 
 Modes ModesNode::make(Array<tvm::te::Dimension> dimensions, Array<PrimExpr> l_maxes,
@@ -87,8 +86,8 @@ Modes ModesNode::make(Array<tvm::te::Dimension> dimensions, Array<PrimExpr> l_ma
     }
   }
 
+  n->setup_transitive_dependences();
   auto ret = Modes(n);
-  ret->setup_transitive_dependences();
 
   Array<UninterpFun> a_funs;
   for (size_t i = 0; i < dimensions.size(); ++i) {
@@ -102,9 +101,29 @@ Modes ModesNode::make(Array<tvm::te::Dimension> dimensions, Array<PrimExpr> l_ma
         a_fun_max_extent = a_fun_max_extent * l_funs[dependent_dim_idx]->range->extent;
       }
 
-      a_funs.push_back(UninterpFunNode::make(
-          dim->name + "_afun", Range::make_by_min_extent(0, a_fun_max_extent), {dim},
-          {Var("param", DataType::Int(32))}, NullValue<PrimExpr>(), UninterpFunNode::kAFun));
+      Var param("param", DataType::Int(32));
+      UninterpFun a_fun = UninterpFunNode::make(
+          dim->name + "_afun", Range::make_by_min_extent(0, a_fun_max_extent), {dim}, {param},
+          NullValue<PrimExpr>(), UninterpFunNode::kAFun);
+      // When the dependent dims only depend on this dim, the A-function
+      // is the prefix sum of the product of their widths.
+      PrimExpr summand;
+      bool known_summand = true;
+      for (auto dependent_dim : ret->get_immediate_dependent_dims(i)) {
+        int dependent_dim_idx = dimensions.GetIdx(dependent_dim);
+        UninterpFun l_fun = l_funs[dependent_dim_idx];
+        if (ret->has_dependent_dims(dependent_dim_idx) || l_fun->dimensions.size() != 1 ||
+            !l_fun->dimensions[0].same_as(dim)) {
+          known_summand = false;
+          break;
+        }
+        PrimExpr width = l_fun.MakeCallTo(Array<PrimExpr>({param}), {dim});
+        summand = summand.defined() ? summand * width : width;
+      }
+      if (known_summand && summand.defined()) {
+        const_cast<UninterpFunNode*>(a_fun.as<UninterpFunNode>())->SetSummand(summand);
+      }
+      a_funs.push_back(a_fun);
     } else {
       a_funs.push_back(NullValue<UninterpFun>());
     }
@@ -141,6 +160,107 @@ Modes ModesNode::make_storage_layout(Array<tvm::te::Dimension> dimensions, Array
   return ModesNode::make(dimensions, l_maxes, {}, l_funs, user_a_funs, false);
 }
 
+UninterpFun PadLFunToTile(UninterpFun l_fun, int tile) {
+  if (tile <= 1) return l_fun;
+  auto pad = [&](PrimExpr e) { return floordiv(e + (tile - 1), tile) * tile; };
+
+  Array<Var> parameters;
+  for (auto param : l_fun->parameters) {
+    parameters.push_back(Var(param->name_hint, param->dtype));
+  }
+  // Inline the original body where there is one, since calls nested
+  // in an inlined body are not themselves inlined again.
+  Array<PrimExpr> args(parameters.begin(), parameters.end());
+  PrimExpr unpadded = l_fun->body.defined() ? l_fun->substitute(args, l_fun->dimensions)
+                                            : l_fun.MakeCallTo(args, l_fun->dimensions);
+  PrimExpr body = pad(unpadded);
+  PrimExpr min = pad(l_fun->range->min);
+  PrimExpr max_inclusive = pad(l_fun->range->max_inclusive());
+  return UninterpFunNode::make(l_fun->fname + "_t" + std::to_string(tile),
+                               Range::make_by_min_extent(min, max_inclusive - min + 1),
+                               l_fun->dimensions, parameters, body, l_fun->type);
+}
+
+Modes ModesNode::make_tiled_storage_layout(Array<tvm::te::Dimension> dimensions,
+                                           Array<PrimExpr> l_maxes, Array<UninterpFun> l_funs,
+                                           Map<Dimension, UninterpFun> user_a_funs,
+                                           Array<Integer> tile_factors) {
+  CHECK_EQ(tile_factors.size(), dimensions.size());
+  if (l_funs.size() == 0) {
+    for (size_t i = 0; i < l_maxes.size(); ++i) {
+      l_funs.push_back(UninterpFunNode::from_constant(dimensions[i]->name + "_w", l_maxes[i]));
+    }
+  }
+  CHECK_EQ(l_funs.size(), dimensions.size());
+
+  // Padding the widths is all that is needed: ComputePosition,
+  // GetAllocationSize and the generated A-functions are all defined
+  // in terms of the l_funs, and hence see the padded row lengths.
+  Array<PrimExpr> padded_l_maxes;
+  Array<UninterpFun> padded_l_funs;
+  for (size_t i = 0; i < dimensions.size(); ++i) {
+    int tile = tile_factors[i]->value;
+    CHECK_GE(tile, 1) << "Invalid tile factor for " << dimensions[i];
+    padded_l_funs.push_back(PadLFunToTile(l_funs[i], tile));
+    padded_l_maxes.push_back(tile > 1 ? floordiv(l_maxes[i] + (tile - 1), tile) * tile
+                                      : l_maxes[i]);
+  }
+
+  Modes ret = ModesNode::make(dimensions, padded_l_maxes, {}, padded_l_funs, user_a_funs, false);
+  const_cast<ModesNode*>(ret.operator->())->tile_factors = tile_factors;
+  return ret;
+}
+
+Modes ModesNode::make_paged_storage_layout(Array<tvm::te::Dimension> dimensions,
+                                           Array<PrimExpr> l_maxes, Array<UninterpFun> l_funs,
+                                           int paged_dim, int page_size, UninterpFun page_table,
+                                           PrimExpr num_pages) {
+  CHECK(paged_dim >= 0 && paged_dim < static_cast<int>(dimensions.size()));
+  CHECK_GE(page_size, 1);
+  CHECK(page_table.defined() && num_pages.defined());
+  for (auto dim : page_table->dimensions) {
+    int idx = dimensions.GetIdx(dim);
+    CHECK(idx >= 0 && idx <= paged_dim)
+        << "The page table of " << dimensions[paged_dim] << " can only depend on it and outer "
+        << "dimensions, not " << dim;
+  }
+
+  Modes ret = ModesNode::make(dimensions, l_maxes, {}, l_funs, Map<Dimension, UninterpFun>(),
+                              false);
+  for (size_t i = paged_dim + 1; i < dimensions.size(); ++i) {
+    CHECK(!ret->is_ragged(i)) << "Dimensions inner to the paged dimension should be dense";
+  }
+  ModesNode* n = const_cast<ModesNode*>(ret.operator->());
+  n->paged_dim = paged_dim;
+  n->page_size = page_size;
+  n->page_table = page_table;
+  n->num_pages = num_pages;
+  return ret;
+}
+
+// The position in a paged layout: the row of paged_dim is found in its
+// page, and the dimensions inner to it are laid out densely in the row.
+PrimExpr ComputePagedPosition(const ModesNode* self, const Array<PrimExpr>& coords) {
+  CHECK_EQ(coords.size(), self->ndim());
+  int paged_dim = self->paged_dim;
+  PrimExpr row_width = 1;
+  PrimExpr row_offset = 0;
+  for (int j = self->ndim() - 1; j > paged_dim; --j) {
+    row_offset = row_offset + coords[j] * row_width;
+    row_width = row_width * self->l_funs[j]->range->max_inclusive();
+  }
+
+  Array<PrimExpr> table_args;
+  Array<Dimension> table_dims;
+  for (int i = 0; i <= paged_dim; ++i) {
+    table_args.push_back(i == paged_dim ? indexdiv(coords[i], self->page_size) : coords[i]);
+    table_dims.push_back(self->dimensions[i]);
+  }
+  PrimExpr page = self->page_table.MakeCallTo(table_args, table_dims);
+  PrimExpr row = page * self->page_size + indexmod(coords[paged_dim], self->page_size);
+  return UninterpFun::InlineUninterpFunCalls(row * row_width + row_offset);
+}
+
 Modes ModesNode::make(std::string name, Array<PrimExpr> dense_shape, bool is_loop_layout) {
   Array<Dimension> dimensions;
   for (size_t i = 0; i < dense_shape.size(); ++i) {
@@ -176,6 +296,10 @@ TVM_REGISTER_GLOBAL("tir.ModesIsRagged").set_body_typed([](Modes modes) {
 
 const bool ModesNode::is_ragged(int i) const { return (l_funs[i]->arity() > 0); }
 
+TVM_REGISTER_GLOBAL("tir.ModesIsRaggedDim").set_body_typed([](Modes modes, int i) {
+  return modes->is_ragged(i);
+});
+
 const std::string ModesNode::str() const {
   std::string str = "";
   for (size_t i = 0; i < ndim(); ++i) {
@@ -185,13 +309,13 @@ const std::string ModesNode::str() const {
 }
 
 const bool ModesNode::has_dependent_dims(int idx) const {
-  setup_transitive_dependences();
-  return transitive_dependent_dims.count(dimensions[idx]) &&
-         transitive_dependent_dims.at(dimensions[idx]).size() > 0;
+  const Array<Dimension>& deps = transitive_deps_by_idx[idx];
+  return deps.defined() && deps.size() > 0;
 }
 
-const void ModesNode::setup_transitive_dependences() const {
-  if (transitive_dependent_dims.size() > 0) return;
+void ModesNode::setup_transitive_dependences() {
+  transitive_deps_by_idx = std::vector<Array<Dimension>>(ndim(), NullValue<Array<Dimension>>());
+  immediate_deps_by_idx = std::vector<Array<Dimension>>(ndim(), NullValue<Array<Dimension>>());
 
   std::unordered_map<int, std::vector<int>> temp_map;
   for (size_t i = 0; i < ndim(); ++i) {
@@ -242,19 +366,44 @@ const void ModesNode::setup_transitive_dependences() const {
     auto deps = get_transitive_deps(it.first);
     immediate_dependent_dims.Set(dimensions[it.first], deps.first);
     transitive_dependent_dims.Set(dimensions[it.first], deps.second);
+    immediate_deps_by_idx[it.first] = deps.first;
+    transitive_deps_by_idx[it.first] = deps.second;
   }
 }
 
 const Array<Dimension> ModesNode::get_transitive_dependent_dims(int idx) const {
-  setup_transitive_dependences();
-  CHECK(transitive_dependent_dims.count(dimensions[idx]));
-  return transitive_dependent_dims.at(dimensions[idx]);
+  CHECK(transitive_deps_by_idx[idx].defined());
+  return transitive_deps_by_idx[idx];
 }
 
 const Array<Dimension> ModesNode::get_immediate_dependent_dims(int idx) const {
-  setup_transitive_dependences();
-  CHECK(immediate_dependent_dims.count(dimensions[idx]));
-  return immediate_dependent_dims.at(dimensions[idx]);
+  CHECK(immediate_deps_by_idx[idx].defined());
+  return immediate_deps_by_idx[idx];
+}
+
+size_t ModesNode::PositionKeyHasher::operator()(const PositionKey& key) const {
+  size_t hash = key.all_dims;
+  for (auto dim : key.relevant_dims) {
+    hash = hash * 31 + std::hash<const Object*>()(dim.get());
+  }
+  for (auto coord : key.coords) {
+    hash = hash * 31 + DeeperExprHash()(coord);
+  }
+  return hash;
+}
+
+bool ModesNode::PositionKeyEquality::operator()(const PositionKey& k1,
+                                                const PositionKey& k2) const {
+  if (k1.all_dims != k2.all_dims) return false;
+  if (k1.coords.size() != k2.coords.size()) return false;
+  if (k1.relevant_dims.size() != k2.relevant_dims.size()) return false;
+  for (size_t i = 0; i < k1.relevant_dims.size(); ++i) {
+    if (k1.relevant_dims[i] != k2.relevant_dims[i]) return false;
+  }
+  for (size_t i = 0; i < k1.coords.size(); ++i) {
+    if (!DeeperExprEquality()(k1.coords[i], k2.coords[i])) return false;
+  }
+  return true;
 }
 
 const PrimExpr ComputeTExpr(const ModesNode* self, int dim_idx, Array<PrimExpr> relaxed_coords,
@@ -307,6 +456,7 @@ const PrimExpr ComputeTExpr(const ModesNode* self, int dim_idx, Array<PrimExpr>
 
 const PrimExpr ModesNode::ComputePosition(std::string name, Array<PrimExpr> coords) const {
   bool print = false;  //(name == "O");
+  if (is_paged()) return ComputePagedPosition(this, coords);
 
   if (print) {
     for (size_t i = 0; i < dimensions.size(); ++i) {
@@ -315,6 +465,15 @@ const PrimExpr ModesNode::ComputePosition(std::string name, Array<PrimExpr> coor
   }
 
   // std::cout << "[CP] For " << name << std::endl;
+  PositionKey key{coords, {}, true};
+  {
+    std::lock_guard<std::mutex> lock(position_cache_mutex);
+    auto it = position_cache.find(key);
+    if (it != position_cache.end()) {
+      return UninterpFun::InlineUninterpFunCalls(it->second);
+    }
+  }
+
   PrimExpr lowered_offset = 0;
 
   std::vector<PrimExpr> relaxed_coords;
@@ -328,15 +487,39 @@ const PrimExpr ModesNode::ComputePosition(std::string name, Array<PrimExpr> coor
     relaxed_coords[i] = l_funs[i].MakeCallTo(Array<PrimExpr>(relaxed_coords), dimensions);
   }
 
+  {
+    std::lock_guard<std::mutex> lock(position_cache_mutex);
+    position_cache[key] = lowered_offset;
+  }
   return UninterpFun::InlineUninterpFunCalls(lowered_offset);
 }
 
+TVM_REGISTER_GLOBAL("tir.ModesComputePosition")
+    .set_body_typed([](Modes modes, Array<PrimExpr> coords) {
+      return modes->ComputePosition("", coords);
+    });
+
 const PrimExpr ModesNode::ComputePosition(std::string name, Array<PrimExpr> coords,
                                           Array<Dimension> relevant_dims) const {
   bool print = false;
   // bool print = (name == "mummy");
+  if (is_paged()) {
+    CHECK(relevant_dims.size() == ndim()) << "Paged layouts need all coordinates";
+    return ComputePagedPosition(this, coords);
+  }
   if (print) std::cout << "[CP] For " << name << " " << coords.size() << std::endl;
 
+  // The cached expressions are stored before inlining, as A-function
+  // bodies may only be filled in after the first query.
+  PositionKey key{coords, relevant_dims, false};
+  {
+    std::lock_guard<std::mutex> lock(position_cache_mutex);
+    auto it = position_cache.find(key);
+    if (it != position_cache.end()) {
+      return UninterpFun::InlineUninterpFunCalls(it->second);
+    }
+  }
+
   // Map from an outer dimension Do to the outermost inner dimension
   // Di such that Di depends on Do and Do is outer to Di
   std::unordered_map<int, std::vector<int>> outer_to_inner_deps;
@@ -467,10 +650,23 @@ const PrimExpr ModesNode::ComputePosition(std::string name, Array<PrimExpr> coor
     offset = offset + this_offset;
     processed.insert(i_idx);
   }
+  {
+    std::lock_guard<std::mutex> lock(position_cache_mutex);
+    position_cache[key] = offset;
+  }
   return UninterpFun::InlineUninterpFunCalls(offset);
 }
 
 const PrimExpr ModesNode::GetAllocationSize() const {
+  if (is_paged()) {
+    // The whole pool, whichever rows its pages hold.
+    PrimExpr size = num_pages * page_size;
+    for (size_t j = paged_dim + 1; j < ndim(); ++j) {
+      size = size * l_funs[j]->range->max_inclusive();
+    }
+    return size;
+  }
+
   Array<PrimExpr> l_maxes;
   Array<Dimension> dims;
   for (size_t i = 0; i < ndim(); ++i) {
@@ -490,6 +686,22 @@ TVM_REGISTER_GLOBAL("tir.StorageModes")
       return ModesNode::make_storage_layout(dimensions, l_maxes, l_funs, user_a_funs);
     });
 
+TVM_REGISTER_GLOBAL("tir.TiledStorageModes")
+    .set_body_typed([](Array<tvm::te::Dimension> dimensions, Array<PrimExpr> l_maxes,
+                       Array<UninterpFun> l_funs, Map<Dimension, UninterpFun> user_a_funs,
+                       Array<Integer> tile_factors) {
+      return ModesNode::make_tiled_storage_layout(dimensions, l_maxes, l_funs, user_a_funs,
+                                                  tile_factors);
+    });
+
+TVM_REGISTER_GLOBAL("tir.PagedStorageModes")
+    .set_body_typed([](Array<tvm::te::Dimension> dimensions, Array<PrimExpr> l_maxes,
+                       Array<UninterpFun> l_funs, int paged_dim, int page_size,
+                       UninterpFun page_table, PrimExpr num_pages) {
+      return ModesNode::make_paged_storage_layout(dimensions, l_maxes, l_funs, paged_dim,
+                                                  page_size, page_table, num_pages);
+    });
+
 TVM_REGISTER_GLOBAL("tir.LoopModes")
     .set_body_typed([](Array<tvm::te::Dimension> dimensions, Array<PrimExpr> l_maxes,
                        Array<UninterpFun> l_fun_mins, Array<UninterpFun> l_funs) {
@@ -8,6 +8,7 @@
 #include <tvm/tir/uf_equality.h>
 #include <tvm/tir/uninterp_fun.h>
 
+#include <unordered_map>
 #include <vector>
 
 #include "../../arith/interval_set.h"
@@ -235,28 +236,110 @@ bool UninterpFunNode::is_complex() const {
 
 const PrimExpr UninterpFunNode::substitute(Array<PrimExpr> args,
                                            Array<tvm::te::Dimension> arg_dims) const {
-  std::unordered_map<const VarNode*, PrimExpr> replace_map;
   // if (args.size() != arg_dims.size()) {
   // std::cout << "Really?" << std::endl;
   // }
   CHECK_EQ(args.size(), arg_dims.size());
-  Map<tvm::te::Dimension, PrimExpr> arg_dim_map;
-  for (size_t i = 0; i < args.size(); ++i) {
-    arg_dim_map.Set(arg_dims[i], args[i]);
-  }
+  if (this->parameters.size() == 0) return this->body;
 
+  // Arities are small, so a linear search over the argument
+  // dimensions is cheaper than building a map.
+  std::unordered_map<const VarNode*, PrimExpr> replace_map;
   for (size_t i = 0; i < this->parameters.size(); ++i) {
     auto param = this->parameters[i].get();
     auto param_dim = this->dimensions[i];
-    if (arg_dim_map.count(param_dim) == 0) {
+    size_t j = 0;
+    for (; j < arg_dims.size(); ++j) {
+      if (arg_dims[j] == param_dim) break;
+    }
+    if (j == arg_dims.size()) {
       std::cout << param_dim->name;
     }
-    CHECK(arg_dim_map.count(param_dim) > 0) << param_dim->name;
-    replace_map[param] = arg_dim_map.at(param_dim);
+    CHECK(j < arg_dims.size()) << param_dim->name;
+    replace_map[param] = args[j];
   }
   return VarReplacer(replace_map)(this->body);
 }
 
+/*!
+ * \brief Memo of uninterpreted function applications seen while
+ * inlining. Most applications during lowering substitute the same
+ * function into the same argument nodes, so the inlined body is
+ * reused instead of being rebuilt. Arguments are compared by node
+ * identity (integer constants by value), which is safe as the keys
+ * hold on to them. The function body is part of the key as bodies can
+ * be set after a function is first inlined.
+ */
+class UninterpFunApplicationCache {
+ public:
+  static UninterpFunApplicationCache* ThreadLocal() {
+    static thread_local UninterpFunApplicationCache inst;
+    return &inst;
+  }
+
+  PrimExpr Substitute(const UninterpFun& ufun, const Array<PrimExpr>& args,
+                      const Array<Dimension>& arg_dims) {
+    CHECK_EQ(args.size(), arg_dims.size());
+    Key key{ufun, ufun->body, args, arg_dims};
+    auto it = cache_.find(key);
+    if (it != cache_.end()) return it->second;
+    if (cache_.size() >= kMaxEntries) cache_.clear();
+    PrimExpr ret = ufun->substitute(args, arg_dims);
+    cache_[key] = ret;
+    return ret;
+  }
+
+ private:
+  static constexpr size_t kMaxEntries = 1 << 16;
+
+  struct Key {
+    UninterpFun ufun;
+    PrimExpr body;
+    Array<PrimExpr> args;
+    Array<Dimension> arg_dims;
+  };
+
+  static size_t HashArg(const PrimExpr& e) {
+    if (auto imm = e.as<IntImmNode>()) return std::hash<int64_t>()(imm->value);
+    return std::hash<const Object*>()(e.get());
+  }
+
+  static bool ArgEqual(const PrimExpr& e1, const PrimExpr& e2) {
+    if (e1.same_as(e2)) return true;
+    auto imm1 = e1.as<IntImmNode>();
+    auto imm2 = e2.as<IntImmNode>();
+    return imm1 && imm2 && imm1->value == imm2->value && imm1->dtype == imm2->dtype;
+  }
+
+  class KeyHasher {
+   public:
+    size_t operator()(const Key& key) const {
+      size_t hash = std::hash<const Object*>()(key.ufun.get()) ^
+                    (std::hash<const Object*>()(key.body.get()) << 1);
+      for (size_t i = 0; i < key.args.size(); ++i) {
+        hash = hash * 31 + HashArg(key.args[i]);
+        hash = hash * 31 + std::hash<const Object*>()(key.arg_dims[i].get());
+      }
+      return hash;
+    }
+  };
+
+  class KeyEquality {
+   public:
+    bool operator()(const Key& k1, const Key& k2) const {
+      if (!k1.ufun.same_as(k2.ufun) || !k1.body.same_as(k2.body)) return false;
+      if (k1.args.size() != k2.args.size()) return false;
+      for (size_t i = 0; i < k1.args.size(); ++i) {
+        if (!ArgEqual(k1.args[i], k2.args[i])) return false;
+        if (k1.arg_dims[i] != k2.arg_dims[i]) return false;
+      }
+      return true;
+    }
+  };
+
+  std::unordered_map<Key, PrimExpr, KeyHasher, KeyEquality> cache_;
+};
+
 int UninterpFunNode::GetArgPos(Var var) const {
   size_t i = 0;
   for (; i < this->parameters.size(); ++i) {
@@ -272,6 +355,8 @@ void UninterpFunNode::SetBody(PrimExpr expr) {
 
 void UninterpFunNode::SetRange(Range r) { this->range = r; }
 
+void UninterpFunNode::SetSummand(PrimExpr expr) { this->summand = expr; }
+
 class UninterpCallInliner : StmtExprMutator {
   PrimExpr VisitExpr_(const CallNode* op) {
     if (op->func.as<UninterpFunNode>()) {
@@ -286,7 +371,7 @@ class UninterpCallInliner : StmtExprMutator {
         arguments.push_back(this->VisitExpr(arg));
       }
       if (print) std::cout << "[IUF]  Substituting" << std::endl;
-      return ufun->substitute(arguments, op->arg_dims);
+      return UninterpFunApplicationCache::ThreadLocal()->Substitute(ufun, arguments, op->arg_dims);
     } else {
       if (op->custom_realize_bounds.size() > 0) {
         Array<Range> new_bounds;
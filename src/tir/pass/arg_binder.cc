@@ -68,6 +68,17 @@ bool ArgBinder::Bind_(const PrimExpr& arg, const PrimExpr& value, const std::str
         BinderAddAssert(it->second == value, arg_name, &asserts_);
       }
     }
+  } else if (const MulNode* m = arg.as<MulNode>()) {
+    // A dimension declared as a multiple of a constant, v * c, defines v
+    // if it is not defined yet.
+    const VarNode* v = m->a.as<VarNode>();
+    const IntImmNode* c = m->b.as<IntImmNode>();
+    if (v != nullptr && c != nullptr && c->value > 0 && !def_map_->count(v)) {
+      PrimExpr factor = make_const(value.dtype(), c->value);
+      BinderAddAssert(truncmod(value, factor) == make_zero(value.dtype()), arg_name, &asserts_);
+      return Bind_(m->a, truncdiv(value, factor), arg_name, with_lets);
+    }
+    BinderAddAssert(arg == value, arg_name, &asserts_);
   } else {
     // std::cout << "[BIND] " << arg << " " << value << " " << arg_name << std::endl;
     BinderAddAssert(arg == value, arg_name, &asserts_);
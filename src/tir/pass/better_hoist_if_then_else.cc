@@ -18,6 +18,81 @@
 #define COUT std::cout << "[RIfR] "
 namespace tvm {
 namespace tir {
+// Observed probabilities that the conditions of branches are true.
+// Profiles give them for the IfThenElse nodes of the input in
+// pre-order. As the passes below move and fuse branches, but do not
+// change their conditions, the probabilities are kept by condition.
+class BranchProfile {
+ public:
+  BranchProfile() {}
+
+  BranchProfile(Stmt stmt, Map<Integer, FloatImm> profile) {
+    if (profile.size() == 0) return;
+    // Map keys compare by identity, so the profile is looked up by
+    // value in a copy.
+    std::unordered_map<int64_t, double> by_index;
+    for (const auto& kv : profile) {
+      by_index[kv.first->value] = kv.second->value;
+    }
+    class BranchVisitor : public StmtVisitor {
+     public:
+      BranchVisitor(BranchProfile* self, const std::unordered_map<int64_t, double>& profile)
+          : self_(self), profile_(profile) {}
+
+      void VisitStmt_(const IfThenElseNode* op) final {
+        auto it = profile_.find(index_++);
+        if (it != profile_.end() && !self_->probabilities_.count(op->condition)) {
+          self_->probabilities_[op->condition] = it->second;
+        }
+        StmtVisitor::VisitStmt_(op);
+      }
+
+     private:
+      BranchProfile* self_;
+      const std::unordered_map<int64_t, double>& profile_;
+      int64_t index_{0};
+    };
+    BranchVisitor(this, by_index)(stmt);
+  }
+
+  bool defined() const { return !probabilities_.empty(); }
+
+  // The probability that cond is true, or a negative value if it is
+  // not known.
+  double Get(const PrimExpr& cond) const {
+    auto it = probabilities_.find(cond);
+    return it == probabilities_.end() ? -1 : it->second;
+  }
+
+ private:
+  std::unordered_map<PrimExpr, double, DeeperExprHash, DeeperExprEquality> probabilities_;
+};
+
+// Lays out profiled branches so that the more likely side is the then
+// case, which code generators emit as the fall-through, and annotates
+// them with the probability of that side, with which rarely taken
+// branches, such as ragged tails, are emitted as cold.
+class BranchLayoutAnnotator : public StmtMutator {
+ public:
+  explicit BranchLayoutAnnotator(const BranchProfile& profile) : profile_(profile) {}
+
+  Stmt VisitStmt_(const IfThenElseNode* op) final {
+    Stmt stmt = StmtMutator::VisitStmt_(op);
+    double probability = profile_.Get(op->condition);
+    if (probability < 0) return stmt;
+    op = stmt.as<IfThenElseNode>();
+    if (probability < 0.5 && op->else_case.defined()) {
+      stmt = IfThenElseNode::make(NotNode::make(op->condition), op->else_case, op->then_case);
+      probability = 1 - probability;
+    }
+    return AttrStmtNode::make(NullValue<ObjectRef>(), attr::branch_probability,
+                              FloatImm(DataType::Float(32), probability), stmt);
+  }
+
+ private:
+  const BranchProfile& profile_;
+};
+
 class ConsecutiveIfFuser : public StmtMutator {
   Stmt VisitStmt_(const SeqStmtNode* op) override {
     Array<Stmt> seq = op->seq;
@@ -136,6 +211,10 @@ class DuplicateNestedIfsRemover : public StmtMutator {
 };
 
 class IfHoister : public StmtMutator {
+ public:
+  explicit IfHoister(const BranchProfile& profile) : profile_(profile) {}
+
+ private:
   Stmt VisitStmt_(const ForNode* op) override {
     // std::cout << "[HOIST]   " << op->loop_var << std::endl;
     if (auto ite = op->body.as<IfThenElseNode>()) {
@@ -164,6 +243,12 @@ class IfHoister : public StmtMutator {
   }
 
   bool Hoistable(const ForNode* for_loop, const IfThenElseNode* if_stmt) {
+    // Hoisting a branch with an else case duplicates the loop. If only
+    // one side was ever taken, one of the copies is dead in practice.
+    if (if_stmt->else_case.defined()) {
+      double probability = profile_.Get(if_stmt->condition);
+      if (probability == 0 || probability == 1) return false;
+    }
     auto stored_vars = GetAllStoredVars(GetRef<Stmt>(for_loop));
     bool ret = !ReadsVariablesFromSet(if_stmt->condition, stored_vars);
     // std::cout << "[HOIST]   " << if_stmt->condition << " " << ret << std::endl;
@@ -210,6 +295,8 @@ class IfHoister : public StmtMutator {
     checker(expr);
     return checker.found;
   }
+
+  const BranchProfile& profile_;
 };
 
 class RedundantIfRemover : public StmtExprMutator {
@@ -290,27 +377,31 @@ class RedundantIfRemover : public StmtExprMutator {
   }
 };
 
-Stmt BetterHoistIfThenElseStmt(Stmt stmt, std::string target, Array<PrimExpr> constraints) {
+Stmt BetterHoistIfThenElseStmt(Stmt stmt, std::string target, Array<PrimExpr> constraints,
+                               Map<Integer, FloatImm> branch_profile) {
   // std::cout << "[STMT] Hoisting" << std::endl;
   // if (target != "cuda") return stmt;
+  BranchProfile profile(stmt, branch_profile);
   for (int i = 0; i < 10; ++i) {
     // std::cout << "[STMT0] " << stmt << std::endl;
     stmt = DuplicateNestedIfsRemover()(stmt);
     // std::cout << "[STMT1] " << stmt << std::endl;
     stmt = ConsecutiveIfFuser()(stmt);
     // std::cout << "[STMT2] " << stmt << std::endl;
-    stmt = IfHoister()(stmt);
+    stmt = IfHoister(profile)(stmt);
     // std::cout << "[STMT3] " << stmt << std::endl;
     stmt = RedundantIfRemover(constraints)(stmt);
     // std::cout << "[STMT4] " << stmt << std::endl;
   }
+  if (profile.defined()) stmt = BranchLayoutAnnotator(profile)(stmt);
   return ConvertSSA(stmt);
 }
 
-LoweredFunc BetterHoistIfThenElse(LoweredFunc f, std::string target, Array<PrimExpr> constraints) {
+LoweredFunc BetterHoistIfThenElse(LoweredFunc f, std::string target, Array<PrimExpr> constraints,
+                                  Map<Integer, FloatImm> branch_profile) {
   // if (target != "cuda") return f;
   auto n = make_object<LoweredFuncNode>(*f.operator->());
-  n->body = BetterHoistIfThenElseStmt(f->body, target, constraints);
+  n->body = BetterHoistIfThenElseStmt(f->body, target, constraints, branch_profile);
   return LoweredFunc(n);
 }
 
@@ -22,14 +22,20 @@
  */
 // Instrument checkers for out of the bounds access.
 
+#include <tvm/arith/analyzer.h>
 #include <tvm/tir/expr.h>
 #include <tvm/tir/ir_pass.h>
+#include <tvm/tir/op.h>
 #include <tvm/tir/stmt_functor.h>
+#include <tvm/tir/uninterp_fun.h>
 
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "../../arith/compute_expr.h"
+
 namespace tvm {
 namespace tir {
 
@@ -49,11 +55,230 @@ class BoundCollector : public StmtVisitor {
   std::unordered_map<const VarNode*, PrimExpr> mem_to_shape;
 };
 
+// Proves accesses in bounds over the loops enclosing them, so that
+// they need no check. Besides affine indices in loops of constant
+// extent, this covers accesses to ragged tensors, whose indices are
+// of the form A(o) + i, for a prefix sum A of the lengths L and
+// i < L(o). Bounding i by L(o) - 1 and rewriting A(o) + L(o) as
+// A(o + 1) leaves an index that is non-decreasing in o, and so
+// bounded by A(N) for o < N.
+class RaggedBoundProver {
+ public:
+  void EnterLoop(const Var& var, PrimExpr min, PrimExpr extent) {
+    loops_.push_back({var, Range::make_by_min_extent(min, extent)});
+  }
+
+  void ExitLoop() { loops_.pop_back(); }
+
+  void EnterLet(const Var& var, PrimExpr value) { lets_[var.get()] = value; }
+
+  void ExitLet(const Var& var) { lets_.erase(var.get()); }
+
+  bool CanProveInBounds(PrimExpr index, PrimExpr upper_bound) {
+    PrimExpr first = index, last = index;
+    if (auto ramp = index.as<RampNode>()) {
+      int64_t stride = 0;
+      if (!arith::GetConst(ramp->stride, &stride) || stride < 0) return false;
+      first = ramp->base;
+      last = ramp->base + ramp->stride * make_const(ramp->stride.dtype(), ramp->lanes - 1);
+    }
+    PrimExpr lower = Eliminate(Inline(first), false);
+    if (!lower.defined() || !CanProveNonNegative(cast(DataType::Int(64), lower))) return false;
+    PrimExpr upper = Eliminate(Inline(last), true);
+    return upper.defined() &&
+           CanProveNonNegative(cast(DataType::Int(64), upper_bound) -
+                               cast(DataType::Int(64), upper) - make_const(DataType::Int(64), 1));
+  }
+
+ private:
+  static constexpr int kUnknown = 2;
+
+  PrimExpr Inline(PrimExpr e) {
+    for (int i = 0; i < 8 && ExprUseVar(e, KeySet(lets_)); ++i) {
+      e = Substitute(e, lets_);
+    }
+    return Simplify(e);
+  }
+
+  template <typename T>
+  static std::unordered_set<const VarNode*> KeySet(const std::unordered_map<const VarNode*, T>& m) {
+    std::unordered_set<const VarNode*> keys;
+    for (auto it : m) keys.insert(it.first);
+    return keys;
+  }
+
+  static bool IsPrefixSum(const CallNode* call) {
+    auto ufun = call->func.as<UninterpFunNode>();
+    return ufun && ufun->type == UninterpFunNode::kAFun && call->args.size() == 1;
+  }
+
+  static int Combine(int a, int b) {
+    if (a == 0) return b;
+    if (b == 0 || a == b) return a;
+    return kUnknown;
+  }
+
+  // Whether e is non-decreasing (1), non-increasing (-1) or constant
+  // (0) in the sub-expression target, or kUnknown. Prefix sums are
+  // non-decreasing in their argument.
+  static int Monotonicity(const PrimExpr& e, const Object* target) {
+    if (e.get() == target) return 1;
+    bool uses = false;
+    PostOrderVisit(e, [&](const ObjectRef& node) { uses |= node.get() == target; });
+    if (!uses) return 0;
+    if (auto add = e.as<AddNode>()) {
+      return Combine(Monotonicity(add->a, target), Monotonicity(add->b, target));
+    } else if (auto sub = e.as<SubNode>()) {
+      int b = Monotonicity(sub->b, target);
+      return Combine(Monotonicity(sub->a, target), b == kUnknown ? b : -b);
+    } else if (auto mul = e.as<MulNode>()) {
+      int64_t c = 0;
+      if (arith::GetConst(mul->b, &c)) {
+        int a = Monotonicity(mul->a, target);
+        if (c == 0 || a == kUnknown) return c == 0 ? 0 : a;
+        return c > 0 ? a : -a;
+      }
+      if (arith::GetConst(mul->a, &c)) return Monotonicity(MulNode::make(mul->b, mul->a), target);
+      return kUnknown;
+    } else if (auto div = e.as<FloorDivNode>()) {
+      int64_t c = 0;
+      if (arith::GetConst(div->b, &c) && c > 0) return Monotonicity(div->a, target);
+      return kUnknown;
+    } else if (auto min_node = e.as<MinNode>()) {
+      return Combine(Monotonicity(min_node->a, target), Monotonicity(min_node->b, target));
+    } else if (auto max_node = e.as<MaxNode>()) {
+      return Combine(Monotonicity(max_node->a, target), Monotonicity(max_node->b, target));
+    } else if (auto cast_node = e.as<CastNode>()) {
+      return cast_node->dtype.is_int() ? Monotonicity(cast_node->value, target) : kUnknown;
+    } else if (auto call = e.as<CallNode>()) {
+      if (IsPrefixSum(call)) return Monotonicity(call->args[0], target);
+    }
+    return kUnknown;
+  }
+
+  // Bound e over the enclosing loops, innermost first, from above or
+  // below. Returns an undefined expression if e is not monotonic in a
+  // loop variable.
+  PrimExpr Eliminate(PrimExpr e, bool upper) {
+    for (auto it = loops_.rbegin(); it != loops_.rend(); ++it) {
+      int dir = Monotonicity(e, it->first.get());
+      if (dir == 0) continue;
+      if (dir == kUnknown) return PrimExpr();
+      const Range& r = it->second;
+      PrimExpr value = (upper == (dir > 0)) ? r->min + r->extent - 1 : r->min;
+      e = RewritePrefixSums(Simplify(Substitute(e, {{it->first, Inline(value)}})));
+    }
+    return e;
+  }
+
+  static size_t ExprSize(const PrimExpr& e) {
+    size_t size = 0;
+    PostOrderVisit(e, [&size](const ObjectRef& node) { ++size; });
+    return size;
+  }
+
+  // Rewrite A(x) + summand(x) as A(x + 1) where that simplifies e.
+  static PrimExpr RewritePrefixSums(PrimExpr e) {
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      std::vector<const CallNode*> calls;
+      PostOrderVisit(e, [&calls](const ObjectRef& node) {
+        if (auto call = node.as<CallNode>()) {
+          if (IsPrefixSum(call)) calls.push_back(call);
+        }
+      });
+      for (auto call : calls) {
+        auto ufun = call->func.as<UninterpFunNode>();
+        if (!ufun->summand.defined() || ufun->parameters.size() != 1) continue;
+        PrimExpr x = call->args[0];
+        PrimExpr summand = Substitute(ufun->summand, {{ufun->parameters[0], x}});
+        PrimExpr next = CallNode::make(call->dtype, call->name, {x + 1}, call->call_type,
+                                       call->arg_dims, call->func, call->value_index);
+        PrimExpr rewritten =
+            Simplify(e - GetRef<PrimExpr>(call) - cast(call->dtype, summand) + next);
+        if (ExprSize(rewritten) < ExprSize(e)) {
+          e = rewritten;
+          changed = true;
+          break;
+        }
+      }
+    }
+    return e;
+  }
+
+  // Prefix sums are non-negative, so they can be bounded by 0 where
+  // e is non-decreasing in them.
+  bool CanProveNonNegative(PrimExpr e) {
+    e = Simplify(e);
+    std::vector<const CallNode*> calls;
+    PostOrderVisit(e, [&calls](const ObjectRef& node) {
+      if (auto call = node.as<CallNode>()) {
+        if (IsPrefixSum(call)) calls.push_back(call);
+      }
+    });
+    std::unordered_map<const Object*, PrimExpr> zeros;
+    for (auto call : calls) {
+      if (Monotonicity(e, call) == 1) zeros[call] = make_zero(call->dtype);
+    }
+    if (!zeros.empty()) {
+      e = Simplify(CallReplacer(zeros)(e));
+    }
+    return analyzer_.CanProve(e >= 0);
+  }
+
+  class CallReplacer : public ExprMutator {
+   public:
+    explicit CallReplacer(const std::unordered_map<const Object*, PrimExpr>& vmap)
+        : vmap_(vmap) {}
+
+    PrimExpr VisitExpr_(const CallNode* op) final {
+      auto it = vmap_.find(op);
+      if (it != vmap_.end()) return it->second;
+      return ExprMutator::VisitExpr_(op);
+    }
+
+   private:
+    const std::unordered_map<const Object*, PrimExpr>& vmap_;
+  };
+
+  // The enclosing loops, outermost first
+  std::vector<std::pair<Var, Range>> loops_;
+  // The values of the enclosing let bindings
+  std::unordered_map<const VarNode*, PrimExpr> lets_;
+  arith::Analyzer analyzer_;
+};
+
 class BoundChecker : public StmtExprMutator {
  public:
   explicit BoundChecker(const std::unordered_map<const VarNode*, PrimExpr>& mem_to_shape)
       : mem_to_shape_(mem_to_shape) {}
 
+  Stmt VisitStmt_(const ForNode* op) final {
+    prover_.EnterLoop(op->loop_var, op->min, op->extent);
+    Stmt ret = StmtExprMutator::VisitStmt_(op);
+    prover_.ExitLoop();
+    return ret;
+  }
+
+  Stmt VisitStmt_(const LetStmtNode* op) final {
+    prover_.EnterLet(op->var, op->value);
+    Stmt ret = StmtExprMutator::VisitStmt_(op);
+    prover_.ExitLet(op->var);
+    return ret;
+  }
+
+  Stmt VisitStmt_(const AttrStmtNode* op) final {
+    if (op->attr_key == attr::thread_extent || op->attr_key == attr::virtual_thread) {
+      IterVar iv = Downcast<IterVar>(op->node);
+      prover_.EnterLoop(iv->var, make_zero(iv->var.dtype()), op->value);
+      Stmt ret = StmtExprMutator::VisitStmt_(op);
+      prover_.ExitLoop();
+      return ret;
+    }
+    return StmtExprMutator::VisitStmt_(op);
+  }
+
   Stmt VisitStmt_(const AllocateNode* op) final {
     // If the shape was updated we should update the hashtable.
     if (UpdateIsNeeded(op->buffer_var)) {
@@ -148,6 +373,8 @@ class BoundChecker : public StmtExprMutator {
   }
 
   void Collect(PrimExpr index, Var buffer_var) {
+    // Accesses proven in bounds need no check.
+    if (prover_.CanProveInBounds(index, mem_to_shape_[buffer_var.get()])) return;
     store_scope_bound_collector_.push_back(std::make_pair(index, mem_to_shape_[buffer_var.get()]));
   }
 
@@ -194,6 +421,8 @@ class BoundChecker : public StmtExprMutator {
   const char* const error_message_ = "OUT OF THE BOUNDS";
   // Hashtable which maps buffer_var to shape.
   std::unordered_map<const VarNode*, PrimExpr> mem_to_shape_;
+  // Proves accesses in bounds.
+  RaggedBoundProver prover_;
 };
 
 Stmt InstrumentBoundCheckers(Stmt stmt) {
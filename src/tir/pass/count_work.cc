@@ -0,0 +1,305 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file count_work.cc
+ * \brief Count the arithmetic work and memory traffic of ragged kernels.
+ */
+#include <tvm/arith/pattern.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/expr.h>
+#include <tvm/tir/ir_pass.h>
+#include <tvm/tir/op.h>
+#include <tvm/tir/stmt_functor.h>
+
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace tvm {
+namespace tir {
+
+// The floating point operations and the bytes of global memory a
+// piece of code performs, as int64 expressions.
+struct WorkCount {
+  PrimExpr flops{make_const(DataType::Int(64), 0)};
+  PrimExpr bytes{make_const(DataType::Int(64), 0)};
+  // The bytes read from the auxiliary arrays, which are not part of
+  // bytes.
+  PrimExpr aux_bytes{make_const(DataType::Int(64), 0)};
+
+  template <typename F>
+  WorkCount Apply(F f) const {
+    WorkCount ret;
+    ret.flops = f(flops);
+    ret.bytes = f(bytes);
+    ret.aux_bytes = f(aux_bytes);
+    return ret;
+  }
+
+  WorkCount operator+(const WorkCount& other) const {
+    WorkCount ret;
+    ret.flops = Add(flops, other.flops);
+    ret.bytes = Add(bytes, other.bytes);
+    ret.aux_bytes = Add(aux_bytes, other.aux_bytes);
+    return ret;
+  }
+
+  static PrimExpr Add(PrimExpr a, PrimExpr b) {
+    if (is_zero(a)) return b;
+    if (is_zero(b)) return a;
+    return a + b;
+  }
+};
+
+// Counts the work of the expressions of a single statement.
+class ExprWorkCounter : public ExprVisitor {
+ public:
+  ExprWorkCounter(const std::unordered_map<const VarNode*, std::string>& scopes,
+                  const std::unordered_set<const VarNode*>& aux_vars)
+      : scopes_(scopes), aux_vars_(aux_vars) {}
+
+  void VisitExpr_(const LoadNode* op) final {
+    Access(op->buffer_var.get(), op->dtype);
+    ExprVisitor::VisitExpr_(op);
+  }
+
+  void VisitExpr_(const AddNode* op) final { Arith(op); }
+  void VisitExpr_(const SubNode* op) final { Arith(op); }
+  void VisitExpr_(const MulNode* op) final { Arith(op); }
+  void VisitExpr_(const DivNode* op) final { Arith(op); }
+  void VisitExpr_(const MinNode* op) final { Arith(op); }
+  void VisitExpr_(const MaxNode* op) final { Arith(op); }
+
+  void VisitExpr_(const CallNode* op) final {
+    // Math functions, such as exp, count as one operation.
+    if (op->dtype.is_float() && (op->call_type == CallNode::PureExtern ||
+                                 op->call_type == CallNode::PureIntrinsic)) {
+      flops += op->dtype.lanes();
+    }
+    ExprVisitor::VisitExpr_(op);
+  }
+
+  void Access(const VarNode* buffer, DataType dtype) {
+    auto it = scopes_.find(buffer);
+    if (it != scopes_.end() && it->second != "global") return;
+    int64_t nbytes = dtype.bytes() * dtype.lanes();
+    if (aux_vars_.count(buffer)) {
+      aux_bytes += nbytes;
+    } else {
+      bytes += nbytes;
+    }
+  }
+
+  int64_t flops{0};
+  int64_t bytes{0};
+  int64_t aux_bytes{0};
+
+ private:
+  template <typename T>
+  void Arith(const T* op) {
+    if (op->dtype.is_float()) flops += op->dtype.lanes();
+    ExprVisitor::VisitExpr_(op);
+  }
+
+  const std::unordered_map<const VarNode*, std::string>& scopes_;
+  const std::unordered_set<const VarNode*>& aux_vars_;
+};
+
+// Counts the work of a statement as a function of its inputs. The
+// count of a loop is the sum of those of its iterations, which is a
+// product when they do not depend on the loop variable, and is
+// narrowed to the iterations that pass the linear bounds on the loop
+// variable of the conditions in its body, such as the length checks
+// of ragged loops. Other sums are left as reductions, for
+// BindFootprintInputs to evaluate once the inputs are known. Global
+// memory accesses are counted as the code issues them, which is an
+// upper bound on the traffic to device memory.
+class WorkCounter : public StmtFunctor<WorkCount(const Stmt&)> {
+ public:
+  explicit WorkCounter(const std::unordered_set<const VarNode*>& aux_vars)
+      : aux_vars_(aux_vars) {}
+
+  WorkCount VisitStmt_(const AttrStmtNode* op) final {
+    if (op->attr_key == attr::storage_scope) {
+      if (auto var = op->node.as<VarNode>()) {
+        scopes_[var] = op->value.as<StringImmNode>()->value;
+      }
+    } else if (op->attr_key == attr::prep_code_scope) {
+      // The prep code only computes the aux arrays.
+      return WorkCount();
+    } else if (op->attr_key == attr::thread_extent || op->attr_key == attr::virtual_thread) {
+      Var var = Downcast<IterVar>(op->node)->var;
+      WorkCount body = this->VisitStmt(op->body);
+      PrimExpr extent = cast(DataType::Int(64), op->value);
+      return body.Apply([&](PrimExpr c) { return SumOver(var, Zero(), extent, c); });
+    }
+    return this->VisitStmt(op->body);
+  }
+
+  WorkCount VisitStmt_(const ForNode* op) final {
+    WorkCount body = this->VisitStmt(op->body);
+    PrimExpr min = cast(DataType::Int(64), op->min);
+    PrimExpr extent = cast(DataType::Int(64), op->extent);
+    return body.Apply([&](PrimExpr c) { return SumOver(op->loop_var, min, extent, c); });
+  }
+
+  WorkCount VisitStmt_(const LetStmtNode* op) final {
+    WorkCount value = Count(op->value);
+    std::unordered_map<const VarNode*, PrimExpr> vmap{{op->var.get(), op->value}};
+    WorkCount body = this->VisitStmt(op->body).Apply([&](PrimExpr c) {
+      return ExprUseVar(c, op->var) ? Substitute(c, vmap) : c;
+    });
+    return value + body;
+  }
+
+  WorkCount VisitStmt_(const IfThenElseNode* op) final {
+    WorkCount then_case = Guard(op->condition, this->VisitStmt(op->then_case));
+    WorkCount ret = Count(op->condition) + then_case;
+    if (op->else_case.defined()) {
+      ret = ret + Guard(!op->condition, this->VisitStmt(op->else_case));
+    }
+    return ret;
+  }
+
+  WorkCount VisitStmt_(const StoreNode* op) final {
+    ExprWorkCounter counter(scopes_, aux_vars_);
+    counter(op->value);
+    counter(op->index);
+    counter.Access(op->buffer_var.get(), op->value.dtype());
+    return Make(counter);
+  }
+
+  WorkCount VisitStmt_(const SeqStmtNode* op) final {
+    WorkCount ret;
+    for (const Stmt& stmt : op->seq) ret = ret + this->VisitStmt(stmt);
+    return ret;
+  }
+
+  WorkCount VisitStmt_(const EvaluateNode* op) final { return Count(op->value); }
+  WorkCount VisitStmt_(const AllocateNode* op) final { return this->VisitStmt(op->body); }
+  WorkCount VisitStmt_(const AssertStmtNode* op) final { return this->VisitStmt(op->body); }
+  WorkCount VisitStmt_(const ProducerConsumerNode* op) final { return this->VisitStmt(op->body); }
+
+  WorkCount VisitStmtDefault_(const Object* op) final { return WorkCount(); }
+
+ private:
+  static PrimExpr Zero() { return make_const(DataType::Int(64), 0); }
+
+  WorkCount Count(const PrimExpr& e) {
+    ExprWorkCounter counter(scopes_, aux_vars_);
+    counter(e);
+    return Make(counter);
+  }
+
+  static WorkCount Make(const ExprWorkCounter& counter) {
+    WorkCount ret;
+    ret.flops = make_const(DataType::Int(64), counter.flops);
+    ret.bytes = make_const(DataType::Int(64), counter.bytes);
+    ret.aux_bytes = make_const(DataType::Int(64), counter.aux_bytes);
+    return ret;
+  }
+
+  // Conjunctions are split into nested guards, so that each bound can
+  // narrow the loop it is on.
+  static WorkCount Guard(PrimExpr cond, WorkCount count) {
+    return count.Apply([&](PrimExpr c) { return Guard(cond, c); });
+  }
+
+  static PrimExpr Guard(PrimExpr cond, PrimExpr c) {
+    if (is_zero(c) || is_one(cond)) return c;
+    if (auto op = cond.as<AndNode>()) return Guard(op->a, Guard(op->b, c));
+    return SelectNode::make(cond, c, Zero());
+  }
+
+  // The sum of c over var in [min, min + extent).
+  static PrimExpr SumOver(const Var& var, PrimExpr min, PrimExpr extent, PrimExpr c) {
+    if (is_zero(c)) return c;
+    if (!ExprUseVar(c, var)) return extent * c;
+    if (auto op = c.as<AddNode>()) {
+      return SumOver(var, min, extent, op->a) + SumOver(var, min, extent, op->b);
+    }
+    if (auto op = c.as<MulNode>()) {
+      if (!ExprUseVar(op->a, var)) return op->a * SumOver(var, min, extent, op->b);
+      if (!ExprUseVar(op->b, var)) return op->b * SumOver(var, min, extent, op->a);
+    }
+    if (auto op = c.as<SelectNode>()) {
+      if (is_zero(op->false_value)) {
+        if (!ExprUseVar(op->condition, var)) {
+          return SelectNode::make(op->condition, SumOver(var, min, extent, op->true_value),
+                                  Zero());
+        }
+        PrimExpr lo = min, hi = min + extent;
+        if (NarrowRange(var, op->condition, &lo, &hi)) {
+          return SumOver(var, lo, max(hi - lo, Zero()), op->true_value);
+        }
+      }
+    }
+    IterVar axis = IterVarNode::make(Range::make_by_min_extent(min, extent), var, kCommReduce);
+    return sum(c, {axis});
+  }
+
+  // Narrows [lo, hi) to the values of var that satisfy cond, when cond
+  // is a linear bound on var.
+  static bool NarrowRange(const Var& var, PrimExpr cond, PrimExpr* lo, PrimExpr* hi) {
+    PrimExpr diff;
+    // cond is diff < 0 for integer operands.
+    if (auto op = cond.as<LTNode>()) {
+      diff = op->a - op->b;
+    } else if (auto op = cond.as<LENode>()) {
+      diff = op->a - op->b - 1;
+    } else if (auto op = cond.as<GTNode>()) {
+      diff = op->b - op->a;
+    } else if (auto op = cond.as<GENode>()) {
+      diff = op->b - op->a - 1;
+    } else {
+      return false;
+    }
+    if (!diff.dtype().is_int()) return false;
+    Array<PrimExpr> coeffs = arith::DetectLinearEquation(diff, {var});
+    if (coeffs.size() != 2) return false;
+    auto coeff = coeffs[0].as<IntImmNode>();
+    if (!coeff || coeff->value == 0) return false;
+    if (ExprUseVar(coeffs[1], var)) return false;
+    PrimExpr base = cast(DataType::Int(64), coeffs[1]);
+    PrimExpr a = make_const(DataType::Int(64), std::abs(coeff->value));
+    if (coeff->value > 0) {
+      // a * var < -base
+      *hi = min(*hi, floordiv(-base - 1, a) + 1);
+    } else {
+      // a * var > base
+      *lo = max(*lo, floordiv(base, a) + 1);
+    }
+    return true;
+  }
+
+  const std::unordered_set<const VarNode*>& aux_vars_;
+  std::unordered_map<const VarNode*, std::string> scopes_;
+};
+
+Array<PrimExpr> CountWork(Stmt stmt, Array<Var> aux_vars) {
+  std::unordered_set<const VarNode*> aux_set;
+  for (const auto& var : aux_vars) aux_set.insert(var.get());
+  WorkCount count = WorkCounter(aux_set)(stmt);
+  return {Simplify(count.flops), Simplify(count.bytes), Simplify(count.aux_bytes)};
+}
+
+}  // namespace tir
+}  // namespace tvm
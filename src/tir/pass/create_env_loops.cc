@@ -4,12 +4,14 @@
 #include <tvm/runtime/registry.h>
 #include <tvm/tir/expr.h>
 #include <tvm/tir/expr_equality.h>
+#include <tvm/tir/ir_pass.h>
 #include <tvm/tir/lowered_func.h>
 #include <tvm/tir/stmt_functor.h>
 
 #include <queue>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "../../arith/interval_set.h"
 #include "../../runtime/thread_storage_scope.h"
@@ -17,19 +19,154 @@
 #define COUT std::cout << "[RIfR] "
 namespace tvm {
 namespace tir {
+// Turns the thread bindings of GPU-style schedules into loops for the
+// CPU. The outermost block loop runs in parallel on the runtime thread
+// pool, which does not nest, so the block loops in it run serially.
+// The thread loops run serially in each block, split at the barriers
+// ThreadSync placed so that all the threads finish the code before a
+// barrier before any of them runs the code after it. The innermost
+// thread loops of constant extent are vectorized.
 class EnvLoopsCreator : public StmtMutator {
   Stmt VisitStmt_(const AttrStmtNode* op) final {
-    if (op->attr_key == attr::thread_extent) {
-      Var var = Downcast<IterVar>(op->node)->var;
-      PrimExpr max = op->value;
-      Stmt ret = ForNode::make(var, 0, op->value, ForType::Parallel, DeviceAPI::None,
-                               StmtMutator::VisitStmt(op->body));
-      return ret;
-    } else {
-      return StmtMutator::VisitStmt_(op);
+    if (op->attr_key != attr::thread_extent) return StmtMutator::VisitStmt_(op);
+    IterVar iv = Downcast<IterVar>(op->node);
+    if (runtime::ThreadScope::make(iv->thread_tag).rank == 1) {
+      return Flatten(SplitAtBarriers(GetRef<Stmt>(op), {}));
     }
+    bool parallel = !in_parallel_;
+    in_parallel_ = true;
+    Stmt body = this->VisitStmt(op->body);
+    if (parallel) in_parallel_ = false;
+    return ForNode::make(iv->var, 0, op->value, parallel ? ForType::Parallel : ForType::Serial,
+                         DeviceAPI::None, body);
   }
 
+  // The code of stmt between the barriers in it, in order, each piece
+  // in loops over the thread indices threads binds around it. Control
+  // flow around barriers must be the same for all the threads of a
+  // block, as on GPUs, and is kept around the pieces.
+  std::vector<Stmt> SplitAtBarriers(const Stmt& stmt, std::vector<IterVar> threads) {
+    if (stmt.as<EvaluateNode>() && IsBarrier(stmt)) return {};
+    if (!HasBarrier(stmt)) return {MakeThreadLoops(this->VisitStmt(stmt), threads)};
+    auto uniform = [&threads](const PrimExpr& e) {
+      for (const IterVar& iv : threads) {
+        if (ExprUseVar(e, iv->var)) return false;
+      }
+      return true;
+    };
+    if (auto op = stmt.as<SeqStmtNode>()) {
+      std::vector<Stmt> pieces;
+      for (const Stmt& s : op->seq) {
+        for (const Stmt& piece : SplitAtBarriers(s, threads)) pieces.push_back(piece);
+      }
+      return pieces;
+    } else if (auto op = stmt.as<AttrStmtNode>()) {
+      if (op->attr_key == attr::thread_extent) {
+        IterVar iv = Downcast<IterVar>(op->node);
+        CHECK_EQ(runtime::ThreadScope::make(iv->thread_tag).rank, 1)
+            << "Cannot run a block loop with barriers in it on the CPU";
+        threads.push_back(IterVarNode::make(Range::make_by_min_extent(0, op->value), iv->var,
+                                            kThreadIndex, iv->thread_tag));
+        return SplitAtBarriers(op->body, threads);
+      }
+      return {AttrStmtNode::make(op->node, op->attr_key, op->value,
+                                 Flatten(SplitAtBarriers(op->body, threads)))};
+    } else if (auto op = stmt.as<ProducerConsumerNode>()) {
+      return SplitAtBarriers(op->body, threads);
+    } else if (auto op = stmt.as<ForNode>()) {
+      if (uniform(op->min) && uniform(op->extent)) {
+        return {ForNode::make(op->loop_var, op->min, op->extent, ForType::Serial, op->device_api,
+                              Flatten(SplitAtBarriers(op->body, threads)))};
+      }
+    } else if (auto op = stmt.as<IfThenElseNode>()) {
+      if (uniform(op->condition)) {
+        Stmt else_case;
+        if (op->else_case.defined()) else_case = Flatten(SplitAtBarriers(op->else_case, threads));
+        return {IfThenElseNode::make(op->condition, Flatten(SplitAtBarriers(op->then_case, threads)),
+                                     else_case)};
+      }
+    } else if (auto op = stmt.as<LetStmtNode>()) {
+      if (uniform(op->value)) {
+        return {LetStmtNode::make(op->var, op->value, Flatten(SplitAtBarriers(op->body, threads)))};
+      }
+    } else if (auto op = stmt.as<AllocateNode>()) {
+      // Allocations in the thread loops are per thread.
+      if (threads.empty()) {
+        return {AllocateNode::make(op->buffer_var, op->dtype, op->extents, op->layout,
+                                   op->condition, Flatten(SplitAtBarriers(op->body, threads)),
+                                   op->new_expr, op->free_function)};
+      }
+    }
+    // The state of each thread would have to be kept across the barrier.
+    LOG(FATAL) << "Cannot run the barrier in " << stmt << " on the CPU, as the code around it "
+               << "differs across threads";
+    return {};
+  }
+
+  // Loops over the thread indices threads binds around body, the
+  // innermost one vectorized when its extent allows.
+  Stmt MakeThreadLoops(Stmt body, const std::vector<IterVar>& threads) {
+    for (size_t i = threads.size(); i-- > 0;) {
+      const Var& var = threads[i]->var;
+      const PrimExpr& extent = threads[i]->dom->extent;
+      const IntImmNode* imm = extent.as<IntImmNode>();
+      if (i + 1 != threads.size() || imm == nullptr || imm->value % kVectorLanes != 0 ||
+          HasVectorizedLoop(body)) {
+        body = ForNode::make(var, 0, extent, ForType::Serial, DeviceAPI::None, body);
+        continue;
+      }
+      // Vectorized in chunks of kVectorLanes, as wider vectors would
+      // only be split again by the backend.
+      Var outer = var.copy_with_suffix(".outer");
+      Var inner = var.copy_with_suffix(".inner");
+      PrimExpr index = outer * make_const(var.dtype(), kVectorLanes) + inner;
+      body = ForNode::make(inner, 0, make_const(extent.dtype(), kVectorLanes),
+                           ForType::Vectorized, DeviceAPI::None,
+                           Substitute(body, Map<Var, PrimExpr>{{var, index}}));
+      body = ForNode::make(outer, 0, make_const(extent.dtype(), imm->value / kVectorLanes),
+                           ForType::Serial, DeviceAPI::None, body);
+    }
+    return body;
+  }
+
+  static Stmt Flatten(const std::vector<Stmt>& pieces) {
+    if (pieces.empty()) return EvaluateNode::make(0);
+    return SeqStmt::Flatten(pieces);
+  }
+
+  // Whether n is a barrier of the threads of a block.
+  static bool IsBarrier(const ObjectRef& n) {
+    if (auto op = n.as<EvaluateNode>()) return IsBarrier(op->value);
+    if (auto call = n.as<CallNode>()) {
+      if (call->is_intrinsic(intrinsic::tvm_storage_sync)) {
+        auto scope = call->args[0].as<StringImmNode>();
+        return scope != nullptr && scope->value == "shared";
+      }
+    }
+    return false;
+  }
+
+  static bool HasBarrier(const Stmt& stmt) {
+    bool found = false;
+    PostOrderVisit(stmt, [&found](const ObjectRef& n) {
+      if (IsBarrier(n)) found = true;
+    });
+    return found;
+  }
+
+  static bool HasVectorizedLoop(const Stmt& stmt) {
+    bool found = false;
+    PostOrderVisit(stmt, [&found](const ObjectRef& n) {
+      if (auto loop = n.as<ForNode>()) {
+        if (loop->for_type == ForType::Vectorized) found = true;
+      }
+    });
+    return found;
+  }
+
+  static constexpr int64_t kVectorLanes = 8;
+  bool in_parallel_{false};
+
  public:
   EnvLoopsCreator() {}
 };
@@ -39,14 +176,14 @@ LoweredFunc CreateEnvLoopsForFunc(LoweredFunc f, std::string target) {
   auto n = make_object<LoweredFuncNode>(*f.operator->());
   Stmt body = f->body;
   body = EnvLoopsCreator()(body);
-  n->body = body;
+  n->body = VectorizeLoop(body);
   return LoweredFunc(n);
 }
 
 Stmt CreateEnvLoopsForStmt(Stmt stmt, std::string target) {
   if (target != "llvm" && target != "c") return stmt;
   Stmt ret = EnvLoopsCreator()(stmt);
-  return ret;
+  return VectorizeLoop(ret);
 }
 }  // namespace tir
 }  // namespace tvm
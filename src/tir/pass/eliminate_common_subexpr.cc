@@ -0,0 +1,335 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file eliminate_common_subexpr.cc
+ * \brief Bind repeated index subexpressions to variables.
+ */
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/expr.h>
+#include <tvm/tir/expr_equality.h>
+#include <tvm/tir/ir_pass.h>
+#include <tvm/tir/stmt_functor.h>
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace tvm {
+namespace tir {
+
+// Variables defined in a stmt, and buffers written in it.
+class DefinitionCollector : public StmtExprVisitor {
+ public:
+  void VisitStmt_(const ForNode* op) final {
+    defined.insert(op->loop_var.get());
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitStmt_(const LetStmtNode* op) final {
+    defined.insert(op->var.get());
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitExpr_(const LetNode* op) final {
+    defined.insert(op->var.get());
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  void VisitStmt_(const AttrStmtNode* op) final {
+    if (op->attr_key == attr::thread_extent || op->attr_key == attr::virtual_thread) {
+      defined.insert(Downcast<IterVar>(op->node)->var.get());
+      has_threads = true;
+    }
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitStmt_(const StoreNode* op) final {
+    written.insert(op->buffer_var.get());
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitExpr_(const CallNode* op) final {
+    if (op->is_intrinsic(intrinsic::tvm_access_ptr)) {
+      auto rw_mask = op->args[4].as<IntImmNode>();
+      if (!rw_mask || (rw_mask->value & 2)) {
+        if (auto buf = op->args[1].as<VarNode>()) written.insert(buf);
+      }
+    } else if (op->is_intrinsic(intrinsic::tvm_address_of)) {
+      if (auto load = op->args[0].as<LoadNode>()) written.insert(load->buffer_var.get());
+    }
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  std::unordered_set<const VarNode*> defined;
+  std::unordered_set<const VarNode*> written;
+  bool has_threads{false};
+};
+
+struct StructuralEqual {
+  bool operator()(const PrimExpr& a, const PrimExpr& b) const { return Equal(a, b); }
+};
+
+// The number of occurrences of an index subexpression in a scope.
+struct Occurrences {
+  int count{0};
+  // The occurrences that are evaluated whenever the scope is.
+  int unconditional{0};
+  int size{0};
+  // Whether evaluating the expression where it does not occur may
+  // fault, as for loads and divisions by variables.
+  bool unsafe{false};
+};
+
+using OccurrenceMap =
+    std::unordered_map<PrimExpr, Occurrences, DeeperExprHash, StructuralEqual>;
+
+// Counts the subexpressions of the indices of loads and stores in a
+// scope that can be evaluated at its start: their variables are
+// defined there, their loads are of buffers that are not written and
+// they have no side effects.
+class IndexExprCounter : public StmtExprVisitor {
+ public:
+  IndexExprCounter(const std::unordered_set<const VarNode*>& defined,
+                   const std::unordered_set<const VarNode*>& written,
+                   const std::unordered_set<const VarNode*>& in_scope,
+                   const std::unordered_set<const VarNode*>& bound)
+      : defined_(defined), written_(written), in_scope_(in_scope), bound_(bound) {}
+
+  void VisitExpr(const PrimExpr& e) final {
+    if (!in_index_) {
+      StmtExprVisitor::VisitExpr(e);
+      return;
+    }
+    bool outer_valid = valid_, outer_unsafe = unsafe_;
+    int outer_size = size_;
+    valid_ = true;
+    unsafe_ = false;
+    size_ = 0;
+    StmtExprVisitor::VisitExpr(e);
+    ++size_;
+    if (valid_ && size_ > 1 && e.dtype().is_int() && e.dtype().lanes() == 1) {
+      Occurrences& occ = occurrences[e];
+      ++occ.count;
+      if (conditional_depth_ == 0) ++occ.unconditional;
+      occ.size = size_;
+      occ.unsafe = unsafe_;
+    }
+    valid_ = outer_valid && valid_;
+    unsafe_ = outer_unsafe || unsafe_;
+    size_ = outer_size + size_;
+  }
+
+  void VisitExpr_(const VarNode* op) final {
+    if (defined_.count(op) && !in_scope_.count(op)) valid_ = false;
+  }
+
+  void VisitExpr_(const LoadNode* op) final {
+    if (written_.count(op->buffer_var.get()) || !is_one(op->predicate)) valid_ = false;
+    unsafe_ = true;
+    bool outer_in_index = in_index_;
+    in_index_ = true;
+    this->VisitExpr(op->index);
+    in_index_ = outer_in_index;
+  }
+
+  void VisitExpr_(const CallNode* op) final {
+    if (!op->is_pure() || op->call_type == CallNode::Halide) valid_ = false;
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  void VisitExpr_(const LetNode* op) final {
+    valid_ = false;
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  void VisitExpr_(const SelectNode* op) final {
+    valid_ = false;
+    this->VisitExpr(op->condition);
+    ++conditional_depth_;
+    this->VisitExpr(op->true_value);
+    this->VisitExpr(op->false_value);
+    --conditional_depth_;
+  }
+
+  void VisitExpr_(const DivNode* op) final { VisitDivision(op); }
+  void VisitExpr_(const ModNode* op) final { VisitDivision(op); }
+  void VisitExpr_(const FloorDivNode* op) final { VisitDivision(op); }
+  void VisitExpr_(const FloorModNode* op) final { VisitDivision(op); }
+
+  void VisitStmt_(const StoreNode* op) final {
+    this->VisitExpr(op->value);
+    in_index_ = true;
+    this->VisitExpr(op->index);
+    in_index_ = false;
+  }
+
+  // The values of the variables bound by the pass are index
+  // expressions as well.
+  void VisitStmt_(const LetStmtNode* op) final {
+    in_index_ = bound_.count(op->var.get());
+    this->VisitExpr(op->value);
+    in_index_ = false;
+    this->VisitStmt(op->body);
+  }
+
+  void VisitStmt_(const ForNode* op) final {
+    this->VisitExpr(op->min);
+    this->VisitExpr(op->extent);
+    ++conditional_depth_;
+    this->VisitStmt(op->body);
+    --conditional_depth_;
+  }
+
+  void VisitStmt_(const IfThenElseNode* op) final {
+    this->VisitExpr(op->condition);
+    ++conditional_depth_;
+    this->VisitStmt(op->then_case);
+    if (op->else_case.defined()) this->VisitStmt(op->else_case);
+    --conditional_depth_;
+  }
+
+  OccurrenceMap occurrences;
+
+ private:
+  template <typename T>
+  void VisitDivision(const T* op) {
+    if (!is_const(op->b)) unsafe_ = true;
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  const std::unordered_set<const VarNode*>& defined_;
+  const std::unordered_set<const VarNode*>& written_;
+  const std::unordered_set<const VarNode*>& in_scope_;
+  const std::unordered_set<const VarNode*>& bound_;
+  bool in_index_{false};
+  bool valid_{true};
+  bool unsafe_{false};
+  int size_{0};
+  int conditional_depth_{0};
+};
+
+class ExprReplacer : public StmtExprMutator {
+ public:
+  ExprReplacer(PrimExpr expr, Var var) : expr_(expr), var_(var), hash_(DeeperExprHash()(expr)) {}
+
+  PrimExpr VisitExpr(const PrimExpr& e) final {
+    if (e.dtype() == expr_.dtype() && DeeperExprHash()(e) == hash_ && Equal(e, expr_)) {
+      return var_;
+    }
+    return StmtExprMutator::VisitExpr(e);
+  }
+
+ private:
+  PrimExpr expr_;
+  Var var_;
+  size_t hash_;
+};
+
+// Binds the index subexpressions that occur more than once in a scope
+// to variables at the start of the outermost scope in which their
+// variables are defined. Scopes are visited outside in, so that an
+// expression is bound in the first scope where it can be.
+class CommonSubexprEliminator : public StmtMutator {
+ public:
+  explicit CommonSubexprEliminator(const DefinitionCollector& collector)
+      : defined_(collector.defined),
+        written_(collector.written),
+        in_kernel_(!collector.has_threads) {}
+
+  Stmt VisitScope(Stmt body) {
+    // Expressions are not bound on the host, where the buffers the
+    // kernels read may not be accessible.
+    while (in_kernel_) {
+      IndexExprCounter counter(defined_, written_, in_scope_, bound_);
+      counter(body);
+      PrimExpr best;
+      int best_size = 0;
+      for (const auto& it : counter.occurrences) {
+        const Occurrences& occ = it.second;
+        if (occ.count < 2 || (occ.unsafe && occ.unconditional == 0)) continue;
+        if (occ.size > best_size) {
+          best = it.first;
+          best_size = occ.size;
+        }
+      }
+      if (!best.defined()) break;
+      // The largest expressions are bound first, so the bindings of
+      // their subexpressions are placed around them.
+      Var var("cse" + std::to_string(num_vars_++), best.dtype());
+      defined_.insert(var.get());
+      bound_.insert(var.get());
+      body = LetStmtNode::make(var, best, ExprReplacer(best, var)(body));
+    }
+    return this->VisitStmt(body);
+  }
+
+  Stmt VisitStmt_(const ForNode* op) final {
+    in_scope_.insert(op->loop_var.get());
+    Stmt body = VisitScope(op->body);
+    in_scope_.erase(op->loop_var.get());
+    return ForNode::make(op->loop_var, op->min, op->extent, op->for_type, op->device_api, body);
+  }
+
+  Stmt VisitStmt_(const LetStmtNode* op) final {
+    in_scope_.insert(op->var.get());
+    Stmt body = VisitScope(op->body);
+    in_scope_.erase(op->var.get());
+    return LetStmtNode::make(op->var, op->value, body);
+  }
+
+  Stmt VisitStmt_(const AttrStmtNode* op) final {
+    if (op->attr_key == attr::thread_extent || op->attr_key == attr::virtual_thread) {
+      const VarNode* var = Downcast<IterVar>(op->node)->var.get();
+      bool outer_in_kernel = in_kernel_;
+      in_kernel_ = true;
+      in_scope_.insert(var);
+      Stmt body = VisitScope(op->body);
+      in_scope_.erase(var);
+      in_kernel_ = outer_in_kernel;
+      return AttrStmtNode::make(op->node, op->attr_key, op->value, body, op->hfuse_group_id);
+    }
+    return StmtMutator::VisitStmt_(op);
+  }
+
+  Stmt VisitStmt_(const IfThenElseNode* op) final {
+    Stmt then_case = VisitScope(op->then_case);
+    Stmt else_case = op->else_case.defined() ? VisitScope(op->else_case) : Stmt();
+    return IfThenElseNode::make(op->condition, then_case, else_case);
+  }
+
+ private:
+  std::unordered_set<const VarNode*> defined_;
+  const std::unordered_set<const VarNode*>& written_;
+  std::unordered_set<const VarNode*> in_scope_;
+  // The variables introduced by this pass.
+  std::unordered_set<const VarNode*> bound_;
+  bool in_kernel_;
+  int num_vars_{0};
+};
+
+Stmt EliminateCommonSubexpr(Stmt stmt) {
+  stmt = ConvertSSA(std::move(stmt));
+  DefinitionCollector collector;
+  collector(stmt);
+  return CommonSubexprEliminator(collector).VisitScope(stmt);
+}
+
+}  // namespace tir
+}  // namespace tvm
@@ -21,6 +21,7 @@
  *  Exposure of pass functions.
  * \file ffi_api.cc
  */
+#include <tvm/driver/pass_profiler.h>
 #include <tvm/ir/attrs.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/tir/expr.h>
@@ -32,37 +33,39 @@
 namespace tvm {
 namespace tir {
 
-TVM_REGISTER_GLOBAL("ir_pass.Simplify").set_body([](TVMArgs args, TVMRetValue* ret) {
-  if (args[0].IsObjectRef<Stmt>()) {
-    if (args.size() > 1) {
-      *ret = Simplify(args[0].operator Stmt(), args[1]);
-    } else {
-      *ret = Simplify(args[0].operator Stmt());
-    }
-  } else {
-    if (args.size() > 1) {
-      *ret = Simplify(args[0].operator PrimExpr(), args[1]);
-    } else {
-      *ret = Simplify(args[0].operator PrimExpr());
-    }
-  }
-});
+TVM_REGISTER_GLOBAL("ir_pass.Simplify")
+    .set_body(ProfiledPackedFunc("ir_pass.Simplify", [](TVMArgs args, TVMRetValue* ret) {
+      if (args[0].IsObjectRef<Stmt>()) {
+        if (args.size() > 1) {
+          *ret = Simplify(args[0].operator Stmt(), args[1]);
+        } else {
+          *ret = Simplify(args[0].operator Stmt());
+        }
+      } else {
+        if (args.size() > 1) {
+          *ret = Simplify(args[0].operator PrimExpr(), args[1]);
+        } else {
+          *ret = Simplify(args[0].operator PrimExpr());
+        }
+      }
+    }));
 
-TVM_REGISTER_GLOBAL("ir_pass.CanonicalSimplify").set_body([](TVMArgs args, TVMRetValue* ret) {
-  if (args[0].IsObjectRef<Stmt>()) {
-    if (args.size() > 1) {
-      *ret = CanonicalSimplify(args[0].operator Stmt(), args[1]);
-    } else {
-      *ret = CanonicalSimplify(args[0].operator Stmt());
-    }
-  } else {
-    if (args.size() > 1) {
-      *ret = CanonicalSimplify(args[0].operator PrimExpr(), args[1]);
-    } else {
-      *ret = CanonicalSimplify(args[0].operator PrimExpr());
-    }
-  }
-});
+TVM_REGISTER_GLOBAL("ir_pass.CanonicalSimplify")
+    .set_body(ProfiledPackedFunc("ir_pass.CanonicalSimplify", [](TVMArgs args, TVMRetValue* ret) {
+      if (args[0].IsObjectRef<Stmt>()) {
+        if (args.size() > 1) {
+          *ret = CanonicalSimplify(args[0].operator Stmt(), args[1]);
+        } else {
+          *ret = CanonicalSimplify(args[0].operator Stmt());
+        }
+      } else {
+        if (args.size() > 1) {
+          *ret = CanonicalSimplify(args[0].operator PrimExpr(), args[1]);
+        } else {
+          *ret = CanonicalSimplify(args[0].operator PrimExpr());
+        }
+      }
+    }));
 
 TVM_REGISTER_GLOBAL("ir_pass.Substitute").set_body([](TVMArgs args, TVMRetValue* ret) {
   if (args[0].IsObjectRef<Stmt>()) {
@@ -80,28 +83,78 @@ TVM_REGISTER_GLOBAL("ir_pass.Equal").set_body([](TVMArgs args, TVMRetValue* ret)
   }
 });
 
-TVM_REGISTER_GLOBAL("ir_pass.StorageFlatten").set_body([](TVMArgs args, TVMRetValue* ret) {
-  if (args.size() <= 3) {
-    *ret = StorageFlatten(args[0], args[1], args[2]);
-  } else {
-    *ret = StorageFlatten(args[0], args[1], args[2], args[3]);
-  }
-});
+TVM_REGISTER_GLOBAL("ir_pass.StorageFlatten")
+    .set_body(ProfiledPackedFunc("ir_pass.StorageFlatten", [](TVMArgs args, TVMRetValue* ret) {
+      if (args.size() <= 3) {
+        *ret = StorageFlatten(args[0], args[1], args[2]);
+      } else {
+        *ret = StorageFlatten(args[0], args[1], args[2], args[3]);
+      }
+    }));
 
-TVM_REGISTER_GLOBAL("ir_pass.MakeAPIWithPrepCode").set_body([](TVMArgs args, TVMRetValue* ret) {
-  *ret = MakeAPI(args[0], args[1], args[2], args[3], args[4], args[5],
-                 tvm::tir::PrepCodeMode::kWithPrepCode);
-});
+TVM_REGISTER_GLOBAL("ir_pass.InjectDoubleBuffer")
+    .set_body(ProfiledPackedFunc("ir_pass.InjectDoubleBuffer", [](TVMArgs args, TVMRetValue* ret) {
+      if (args.size() <= 2) {
+        *ret = InjectDoubleBuffer(args[0], args[1]);
+      } else {
+        *ret = InjectDoubleBuffer(args[0], args[1], args[2]);
+      }
+    }));
 
-TVM_REGISTER_GLOBAL("ir_pass.MakeAPINoPrepCode").set_body([](TVMArgs args, TVMRetValue* ret) {
-  *ret = MakeAPI(args[0], args[1], args[2], args[3], args[4], args[5],
-                 tvm::tir::PrepCodeMode::kNoPrepCode);
-});
+TVM_REGISTER_GLOBAL("ir_pass.BetterHoistIfThenElse")
+    .set_body(ProfiledPackedFunc(
+        "ir_pass.BetterHoistIfThenElse", [](TVMArgs args, TVMRetValue* ret) {
+          if (args.size() <= 3) {
+            *ret = BetterHoistIfThenElse(args[0], args[1], args[2]);
+          } else {
+            *ret = BetterHoistIfThenElse(args[0], args[1], args[2], args[3]);
+          }
+        }));
 
-TVM_REGISTER_GLOBAL("ir_pass.MakeAPIOnlyPrepCode").set_body([](TVMArgs args, TVMRetValue* ret) {
-  *ret = MakeAPI(args[0], args[1], args[2], args[3], args[4], args[5],
-                 tvm::tir::PrepCodeMode::kOnlyPrepCode);
-});
+// The MakeAPI variants optionally take whether to instrument the prep
+// code as the last argument
+inline bool InstrumentPrepCodeArg(const TVMArgs& args) {
+  return args.size() > 6 && static_cast<bool>(args[6]);
+}
+
+TVM_REGISTER_GLOBAL("ir_pass.MakeAPIWithPrepCode")
+    .set_body(ProfiledPackedFunc("ir_pass.MakeAPIWithPrepCode", [](TVMArgs args, TVMRetValue* ret) {
+      *ret = MakeAPI(args[0], args[1], args[2], args[3], args[4], args[5],
+                     tvm::tir::PrepCodeMode::kWithPrepCode, InstrumentPrepCodeArg(args));
+    }));
+
+TVM_REGISTER_GLOBAL("ir_pass.MakeAPINoPrepCode")
+    .set_body(ProfiledPackedFunc("ir_pass.MakeAPINoPrepCode", [](TVMArgs args, TVMRetValue* ret) {
+      *ret = MakeAPI(args[0], args[1], args[2], args[3], args[4], args[5],
+                     tvm::tir::PrepCodeMode::kNoPrepCode, InstrumentPrepCodeArg(args));
+    }));
+
+TVM_REGISTER_GLOBAL("ir_pass.MakeAPIOnlyPrepCode")
+    .set_body(ProfiledPackedFunc("ir_pass.MakeAPIOnlyPrepCode", [](TVMArgs args, TVMRetValue* ret) {
+      *ret = MakeAPI(args[0], args[1], args[2], args[3], args[4], args[5],
+                     tvm::tir::PrepCodeMode::kOnlyPrepCode, InstrumentPrepCodeArg(args));
+    }));
+
+TVM_REGISTER_GLOBAL("ir_pass.MakeAPIWithCachedPrepCode")
+    .set_body(ProfiledPackedFunc(
+        "ir_pass.MakeAPIWithCachedPrepCode", [](TVMArgs args, TVMRetValue* ret) {
+          *ret = MakeAPI(args[0], args[1], args[2], args[3], args[4], args[5],
+                         tvm::tir::PrepCodeMode::kWithCachedPrepCode, InstrumentPrepCodeArg(args));
+        }));
+
+TVM_REGISTER_GLOBAL("ir_pass.MakeAPIExternalPrepCode")
+    .set_body(ProfiledPackedFunc(
+        "ir_pass.MakeAPIExternalPrepCode", [](TVMArgs args, TVMRetValue* ret) {
+          *ret = MakeAPI(args[0], args[1], args[2], args[3], args[4], args[5],
+                         tvm::tir::PrepCodeMode::kExternalPrepCode, InstrumentPrepCodeArg(args));
+        }));
+
+TVM_REGISTER_GLOBAL("ir_pass.MakeAPIFusedPrepCode")
+    .set_body(ProfiledPackedFunc(
+        "ir_pass.MakeAPIFusedPrepCode", [](TVMArgs args, TVMRetValue* ret) {
+          *ret = MakeAPI(args[0], args[1], args[2], args[3], args[4], args[5],
+                         tvm::tir::PrepCodeMode::kFusedPrepCode, InstrumentPrepCodeArg(args));
+        }));
 
 TVM_REGISTER_GLOBAL("ir_pass.InlineLets").set_body([](TVMArgs args, TVMRetValue* ret) {
   *ret = InlineLets(args[0]);
@@ -141,8 +194,16 @@ TVM_REGISTER_GLOBAL("ir_pass.LowerStorageAccess").set_body([](TVMArgs args, TVMR
   *ret = LoweredFunc(n);
 });
 
+// Wrap a pass so that its calls are recorded by the pass profiler.
+template <typename F>
+inline PackedFunc ProfiledPass(const char* name, F pass) {
+  using FType = typename runtime::detail::function_signature<F>::FType;
+  return ProfiledPackedFunc(name, runtime::TypedPackedFunc<FType>(pass).packed());
+}
+
 // make from two arguments
-#define REGISTER_PASS(PassName) TVM_REGISTER_GLOBAL("ir_pass." #PassName).set_body_typed(PassName);
+#define REGISTER_PASS(PassName) \
+  TVM_REGISTER_GLOBAL("ir_pass." #PassName).set_body(ProfiledPass("ir_pass." #PassName, PassName));
 
 REGISTER_PASS(ConvertSSA);
 REGISTER_PASS(VerifySSA);
@@ -154,19 +215,36 @@ REGISTER_PASS(SkipVectorize);
 REGISTER_PASS(CreateEnvLoopsForStmt);
 REGISTER_PASS(CreateEnvLoopsForFunc);
 REGISTER_PASS(UnrollLoop);
+REGISTER_PASS(UnrollRaggedLoop);
 REGISTER_PASS(PeelLoop);
 REGISTER_PASS(InjectCopyIntrin);
 REGISTER_PASS(ThreadSync);
 REGISTER_PASS(BindDeviceType);
+REGISTER_PASS(MakeFastCall);
 REGISTER_PASS(SplitHostDevice);
 REGISTER_PASS(StorageRewrite);
+REGISTER_PASS(PlanRaggedArena);
+REGISTER_PASS(EstimateMemoryFootprint);
+REGISTER_PASS(BindFootprintInputs);
+REGISTER_PASS(CountWork);
+REGISTER_PASS(RaggedScanEarlyExit);
+REGISTER_PASS(RaggedScanEarlyExitFunc);
+REGISTER_PASS(PersistentRaggedBlocks);
+REGISTER_PASS(PersistentRaggedBlocksFunc);
+REGISTER_PASS(InstrumentBlockCycles);
+REGISTER_PASS(InjectIndirectPrefetch);
+REGISTER_PASS(InternExprs);
+REGISTER_PASS(EliminateCommonSubexpr);
+REGISTER_PASS(RaggedTileLoops);
+REGISTER_PASS(LowerFusedMapSearch);
 REGISTER_PASS(CoProcSync);
 REGISTER_PASS(LowerStorageAccessInfo);
 REGISTER_PASS(LowerDeviceStorageAccessInfo)
 REGISTER_PASS(InjectVirtualThread);
 REGISTER_PASS(InjectPrefetch);
-REGISTER_PASS(InjectDoubleBuffer);
 REGISTER_PASS(LoopPartition);
+REGISTER_PASS(RaggedLoopPartition);
+REGISTER_PASS(RaggedLoopPartitionStmt);
 REGISTER_PASS(RemoveNoOp);
 REGISTER_PASS(LiftAttrScope);
 REGISTER_PASS(LowerThreadAllreduce);
@@ -182,7 +260,6 @@ REGISTER_PASS(DecorateDeviceScope);
 REGISTER_PASS(InstrumentBoundCheckers);
 REGISTER_PASS(VerifyCompactBuffer);
 REGISTER_PASS(HoistIfThenElse);
-REGISTER_PASS(BetterHoistIfThenElse);
 REGISTER_PASS(HoistLoads);
 REGISTER_PASS(RemoveRedundantIfs);
 REGISTER_PASS(RemoveRedundantIfsFromFunc);
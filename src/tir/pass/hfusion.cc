@@ -8,6 +8,8 @@
 #include <tvm/tir/lowered_func.h>
 #include <tvm/tir/stmt_functor.h>
 
+#include <algorithm>
+#include <cmath>
 #include <queue>
 #include <unordered_map>
 #include <unordered_set>
@@ -39,17 +41,191 @@ class HFuser : public StmtMutator {
     }
   }
 
+  // Removes the hfuse_weight attribute from a body, remembering its
+  // value.
+  class HFuseWeightExtractor : public StmtMutator {
+   public:
+    Stmt VisitStmt_(const AttrStmtNode* op) final {
+      if (op->attr_key == attr::hfuse_weight) {
+        weight = op->value;
+        return this->VisitStmt(op->body);
+      }
+      return StmtMutator::VisitStmt_(op);
+    }
+
+    PrimExpr weight;
+  };
+
+  static bool GetConstWeight(const PrimExpr& e, double* out) {
+    if (auto imm = e.as<IntImmNode>()) {
+      *out = static_cast<double>(imm->value);
+      return true;
+    } else if (auto imm = e.as<FloatImmNode>()) {
+      *out = imm->value;
+      return true;
+    }
+    return false;
+  }
+
+  // Interleaves the blocks of the bodies instead of concatenating
+  // them, so that heavy and light blocks are dispatched together rather
+  // than the heaviest body forming a tail. Blocks are handed out in
+  // rounds. In every round each body that still has blocks left gets a
+  // share proportional to its cost per block, relative to the lightest
+  // body, so heavier bodies drain faster and the tail is made of the
+  // cheapest blocks. Within a round the heaviest body comes first. The
+  // rounds are split into segments in which the share of every body is
+  // constant, so that the body and its block can be computed in closed
+  // form from the fused block index.
+  Stmt FuseGroupWeighted(const Array<Stmt>& bodies, const Array<Var>& vars,
+                         const std::vector<int64_t>& extents, const std::vector<double>& weights,
+                         const IterVar& common_iv) {
+    size_t n = bodies.size();
+    std::vector<size_t> order(n);
+    for (size_t i = 0; i < n; ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return weights[a] > weights[b]; });
+
+    double min_weight = 0;
+    for (auto w : weights) {
+      if (w > 0 && (min_weight == 0 || w < min_weight)) min_weight = w;
+    }
+    // Blocks of body i per full round, the number of full rounds and
+    // the blocks left for the last, partial round.
+    std::vector<int64_t> shares(n), full_rounds(n), remainders(n);
+    std::vector<int64_t> boundaries;
+    for (size_t i = 0; i < n; ++i) {
+      int64_t share = 1;
+      if (min_weight > 0 && weights[i] > 0) {
+        share = std::max<int64_t>(1, std::llround(weights[i] / min_weight));
+      }
+      shares[i] = share;
+      full_rounds[i] = std::max<int64_t>(extents[i], 0) / share;
+      remainders[i] = std::max<int64_t>(extents[i], 0) % share;
+      if (full_rounds[i] > 0) boundaries.push_back(full_rounds[i]);
+      if (remainders[i] > 0) boundaries.push_back(full_rounds[i] + 1);
+    }
+    std::sort(boundaries.begin(), boundaries.end());
+    boundaries.erase(std::unique(boundaries.begin(), boundaries.end()), boundaries.end());
+
+    struct Participant {
+      size_t body;
+      int64_t count;
+      int64_t first_local;
+    };
+    struct Segment {
+      int64_t offset;
+      int64_t round_size;
+      std::vector<Participant> participants;
+    };
+    std::vector<Segment> segments;
+    int64_t offset = 0, prev_round = 0;
+    for (auto end_round : boundaries) {
+      Segment segment{offset, 0, {}};
+      for (auto i : order) {
+        int64_t count = 0;
+        if (prev_round < full_rounds[i]) {
+          count = shares[i];
+        } else if (prev_round == full_rounds[i]) {
+          count = remainders[i];
+        }
+        if (count == 0) continue;
+        segment.participants.push_back({i, count, prev_round * shares[i]});
+        segment.round_size += count;
+      }
+      offset += segment.round_size * (end_round - prev_round);
+      prev_round = end_round;
+      segments.push_back(segment);
+    }
+
+    Var b = common_iv->var;
+    DataType dtype = b.dtype();
+    PrimExpr body_idx, local_idx;
+    for (size_t s = segments.size(); s != 0; --s) {
+      const Segment& segment = segments[s - 1];
+      PrimExpr r = b - make_const(dtype, segment.offset);
+      PrimExpr round_idx = indexdiv(r, make_const(dtype, segment.round_size));
+      PrimExpr pos = indexmod(r, make_const(dtype, segment.round_size));
+      std::vector<int64_t> starts;
+      int64_t start = 0;
+      for (const auto& p : segment.participants) {
+        starts.push_back(start);
+        start += p.count;
+      }
+      size_t last = segment.participants.size() - 1;
+      auto local_of = [&](size_t j) {
+        const Participant& p = segment.participants[j];
+        return make_const(dtype, p.first_local) + round_idx * make_const(dtype, p.count) + pos -
+               make_const(dtype, starts[j]);
+      };
+      PrimExpr which = make_const(dtype, segment.participants[last].body);
+      PrimExpr local = local_of(last);
+      for (size_t j = last; j != 0; --j) {
+        PrimExpr in_share = pos < make_const(dtype, starts[j]);
+        which = SelectNode::make(in_share, make_const(dtype, segment.participants[j - 1].body),
+                                 which);
+        local = SelectNode::make(in_share, local_of(j - 1), local);
+      }
+      if (!body_idx.defined()) {
+        body_idx = which;
+        local_idx = local;
+      } else {
+        PrimExpr in_segment = b < make_const(dtype, segments[s].offset);
+        body_idx = SelectNode::make(in_segment, which, body_idx);
+        local_idx = SelectNode::make(in_segment, local, local_idx);
+      }
+    }
+
+    Var body_var("hfuse_body", dtype);
+    Var local_var("hfuse_local", dtype);
+    Stmt new_stmt;
+    for (size_t i = n; i != 0; --i) {
+      std::unordered_map<const VarNode*, PrimExpr> vsub;
+      vsub[vars[i - 1].operator->()] = local_var;
+      Stmt new_body = VarReplacer(vsub)(bodies[i - 1]);
+      if (!new_stmt.defined()) {
+        new_stmt = new_body;
+      } else {
+        new_stmt = IfThenElseNode::make(body_var == make_const(dtype, i - 1), new_body, new_stmt);
+      }
+    }
+    new_stmt = LetStmtNode::make(local_var, Simplify(local_idx), new_stmt);
+    new_stmt = LetStmtNode::make(body_var, Simplify(body_idx), new_stmt);
+
+    CHECK(!fused_attr_iv.defined());
+    fused_attr_iv = common_iv;
+    fused_iv_extent = make_const(dtype, offset);
+    return new_stmt;
+  }
+
   Stmt FuseGroupAttrStmt(std::vector<const AttrStmtNode*> group) {
     Array<Stmt> bodies;
     Array<Var> vars;
     Array<PrimExpr> extents;
     IterVar common_iv = Downcast<IterVar>(group[0]->node);
+    bool weighted = true;
+    std::vector<int64_t> const_extents;
+    std::vector<double> weights;
     for (size_t i = 0; i < group.size(); ++i) {
       auto attr = group[i];
-      bodies.push_back(attr->body);
+      HFuseWeightExtractor extractor;
+      bodies.push_back(extractor(attr->body));
       vars.push_back(Downcast<IterVar>(attr->node)->var);
       extents.push_back(attr->value);
+
+      double weight;
+      const int64_t* extent = as_const_int(attr->value);
+      if (extractor.weight.defined() && GetConstWeight(extractor.weight, &weight) && extent) {
+        weights.push_back(weight);
+        const_extents.push_back(*extent);
+      } else {
+        weighted = false;
+      }
     }
+    if (weighted) {
+      return FuseGroupWeighted(bodies, vars, const_extents, weights, common_iv);
+    }
+
     Array<Stmt> new_bodies;
     Array<PrimExpr> cumulative_extents;
     FuseGroupCommon(bodies, vars, extents, common_iv->var, &new_bodies, &cumulative_extents);
@@ -112,12 +288,17 @@ class HFuser : public StmtMutator {
       return FuseGroupFor(for_group);
     } else {
       std::vector<const AttrStmtNode*> attr_group;
-      ObjectRef last_iv = NullValue<ObjectRef>();
+      std::string last_tag = "";
       for (auto stmt : group) {
         auto attr_node = stmt.as<AttrStmtNode>();
         CHECK(attr_node) << "Mixed groups not allowed";
         CHECK(attr_node->attr_key == attr::thread_extent);
-        CHECK(!last_iv.defined() || last_iv == attr_node->node);
+        // The stages may be bound to distinct thread IterVars, as the
+        // vars of all bodies are replaced by the common one anyway.
+        std::string tag = Downcast<IterVar>(attr_node->node)->thread_tag;
+        CHECK(last_tag.empty() || last_tag == tag)
+            << "Stages bound to different threads cannot be hfused";
+        last_tag = tag;
         attr_group.push_back(attr_node);
       }
       return FuseGroupAttrStmt(attr_group);
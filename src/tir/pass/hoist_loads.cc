@@ -6,6 +6,7 @@
 #include <tvm/tir/lowered_func.h>
 #include <tvm/tir/stmt_functor.h>
 
+#include <algorithm>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -71,9 +72,36 @@ class ThreadVarHoister : public StmtExprMutator {
   std::unordered_map<std::string, PrimExpr> thread_var_extents_;
 };
 
+// Buffers that are written or whose address is taken in a function.
+// Loads from these are not invariant, even if they are auxiliary.
+class WrittenBufferCollector : public StmtExprVisitor {
+ public:
+  void VisitStmt_(const StoreNode* op) final {
+    written.insert(op->buffer_var.get());
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitExpr_(const CallNode* op) final {
+    if (op->is_intrinsic(intrinsic::tvm_access_ptr)) {
+      auto rw_mask = op->args[4].as<IntImmNode>();
+      if (!rw_mask || (rw_mask->value & 2)) {
+        if (auto buf = op->args[1].as<VarNode>()) written.insert(buf);
+      }
+    } else if (op->is_intrinsic(intrinsic::tvm_address_of)) {
+      if (auto load = op->args[0].as<LoadNode>()) written.insert(load->buffer_var.get());
+    }
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  std::unordered_set<const VarNode*> written;
+};
+
 class LoadCollector : public StmtExprVisitor {
  public:
-  LoadCollector() { scope_loops_.push_back(std::make_pair(nullptr, 0)); }
+  explicit LoadCollector(std::unordered_set<const VarNode*> written_buffers)
+      : written_buffers_(std::move(written_buffers)) {
+    scope_loops_.push_back(std::make_pair(nullptr, 0));
+  }
 
   void CollectHoistableLoads(Stmt stmt) { this->VisitStmt(stmt); }
 
@@ -82,13 +110,26 @@ class LoadCollector : public StmtExprVisitor {
     //   std::cout << "[HL] Loop previously: " << op->body << std::endl;
     // }
 
+    this->VisitExpr(op->min);
+    this->VisitExpr(op->extent);
     scope_loops_.push_back(std::make_pair(op, 2));
+    var_scopes_[op->loop_var.get()] = scope_loops_.size() - 1;
     this->VisitStmt(op->body);
     scope_loops_.pop_back();
   }
 
+  void VisitStmt_(const LetStmtNode* op) override {
+    // Loads using the var are hoisted at most to the first scope
+    // nested in the let, as they would otherwise be bound at the top of
+    // the let's own scope, before it.
+    this->VisitExpr(op->value);
+    var_scopes_[op->var.get()] = scope_loops_.size();
+    this->VisitStmt(op->body);
+  }
+
   void VisitStmt_(const IfThenElseNode* op) override {
     // std::cout << "[HL] IFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF" << std::endl;
+    this->VisitExpr(op->condition);
     scope_loops_.push_back(std::make_pair(op, 0));
     this->VisitStmt(op->then_case);
     scope_loops_.pop_back();
@@ -101,7 +142,10 @@ class LoadCollector : public StmtExprVisitor {
 
   void VisitStmt_(const AttrStmtNode* op) final {
     if (op->attr_key == attr::aux_data_structure) {
-      if (auto buf = op->node.as<VarNode>()) {
+      // Auxiliary buffers that are written in the function are not
+      // read-only.
+      auto buf = op->node.as<VarNode>();
+      if (buf && !written_buffers_.count(buf)) {
         hoistable_buffers_.insert(buf);
         this->VisitStmt(op->body);
         hoistable_buffers_.erase(buf);
@@ -123,20 +167,23 @@ class LoadCollector : public StmtExprVisitor {
     // << std::endl;
     if (hoistable_buffers_.count(op->buffer_var.operator->())) {
       // std::cout << "[HL]    Hoistable buf" << std::endl;
+      // Loads in the index, as for indirect accesses such as
+      // a_fun(l_fun(i)), are collected first, so that they are bound
+      // before the loads that use them.
+      this->VisitExpr(op->index);
+
+      // The innermost scope that binds a var used by the index. The
+      // index may use vars bound by the lets of loads hoisted to the
+      // same scope, but these are collected in order.
       std::unordered_set<const VarNode*> used_vars = VarCollector().collect(op->index);
-      int i = scope_loops_.size() - 1;
-      for (; i > 0; --i) {
-        const VarNode* loop_var = nullptr;
-        if (scope_loops_[i].first && scope_loops_[i].first->IsInstance<ForNode>()) {
-          loop_var = static_cast<const ForNode*>(scope_loops_[i].first)->loop_var.operator->();
-        }
-        if (used_vars.count(loop_var)) {
-          break;
-        }
+      size_t i = 0;
+      for (auto var : used_vars) {
+        auto it = var_scopes_.find(var);
+        if (it != var_scopes_.end()) i = std::max(i, it->second);
       }
 
       bool incr = false;
-      while (scope_loops_[i].second <= 1) {
+      while (i < scope_loops_.size() && scope_loops_[i].second <= 1) {
         ++i;
         incr = true;
       }
@@ -159,7 +206,6 @@ class LoadCollector : public StmtExprVisitor {
           else_hoistable_loads_[scope_loops_[i].first].push_back(op);
         }
       }
-      this->VisitExpr(op->index);
     } else {
       StmtExprVisitor::VisitExpr_(op);
     }
@@ -170,6 +216,12 @@ class LoadCollector : public StmtExprVisitor {
   std::unordered_map<const Object*, std::vector<const LoadNode*>> if_hoistable_loads_;
   std::unordered_map<const Object*, std::vector<const LoadNode*>> else_hoistable_loads_;
   std::unordered_set<const VarNode*> hoistable_buffers_;
+
+ private:
+  // The index in scope_loops_ of the outermost scope that loads using
+  // a var can be hoisted to.
+  std::unordered_map<const VarNode*, size_t> var_scopes_;
+  std::unordered_set<const VarNode*> written_buffers_;
 };
 
 class LoadHoister : public StmtExprMutator {
@@ -201,8 +253,9 @@ class LoadHoister : public StmtExprMutator {
         load_vars_[load] = added_loads[load];
       }
       Var load_var = Var("var" + std::to_string(count_++), load.dtype());
+      // Loads in the index hoisted earlier are replaced by their vars.
+      let_nest.push_back(LetStmtNode::make(load_var, this->VisitExpr(load), noop));
       load_vars_[load] = load_var;
-      let_nest.push_back(LetStmtNode::make(load_var, load, noop));
       added_loads[load] = load_var;
       // std::cout << "[HL] Adding load " << load_var << " " << load << std::endl;
     }
@@ -326,7 +379,9 @@ LoweredFunc HoistLoads(LoweredFunc f) {
   // std::cout << "[HL] Hoisting loads" << std::endl;
   auto n = make_object<LoweredFuncNode>(*f.operator->());
   Stmt body = ThreadVarHoister()(f->body);
-  LoadCollector load_collector;
+  WrittenBufferCollector written_collector;
+  written_collector(body);
+  LoadCollector load_collector(written_collector.written);
   load_collector.CollectHoistableLoads(body);
   n->body = LoadHoister(load_collector.for_hoistable_loads_, load_collector.if_hoistable_loads_,
                         load_collector.else_hoistable_loads_)
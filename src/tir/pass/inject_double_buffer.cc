@@ -25,6 +25,8 @@
 #include <tvm/tir/op.h>
 #include <tvm/tir/stmt_functor.h>
 
+#include <algorithm>
+
 #include "../../arith/compute_expr.h"
 #include "ir_util.h"
 
@@ -37,6 +39,10 @@ class DoubleBufferDetector : public StmtExprVisitor {
   void VisitStmt_(const AttrStmtNode* op) final {
     if (op->attr_key == attr::double_buffer_scope) {
       touched_.insert(op->node.as<VarNode>());
+      auto num_stages = op->value.as<IntImmNode>();
+      // Older schedules mark the scope with 1.
+      stages_[op->node.as<VarNode>()] =
+          num_stages ? std::max(num_stages->value, static_cast<int64_t>(2)) : 2;
       StmtExprVisitor::VisitStmt_(op);
     } else {
       StmtExprVisitor::VisitStmt_(op);
@@ -50,6 +56,8 @@ class DoubleBufferDetector : public StmtExprVisitor {
   }
   // The set of touched variable.
   std::unordered_set<const VarNode*> touched_;
+  // The number of pipeline stages of each buffer.
+  std::unordered_map<const VarNode*, int64_t> stages_;
 };
 
 class StripDoubleBufferWrite : public StmtMutator {
@@ -65,7 +73,8 @@ class StripDoubleBufferWrite : public StmtMutator {
 
 class DoubleBufferInjector : public StmtExprMutator {
  public:
-  explicit DoubleBufferInjector(int split_loop) : split_loop_(split_loop) {}
+  DoubleBufferInjector(int split_loop, bool async_copy)
+      : split_loop_(split_loop), async_copy_(async_copy) {}
 
   Stmt Inject(Stmt stmt) {
     DoubleBufferDetector detector;
@@ -73,6 +82,7 @@ class DoubleBufferInjector : public StmtExprMutator {
     if (detector.touched_.empty()) return stmt;
     for (const VarNode* v : detector.touched_) {
       dbuffer_info_[v] = StorageEntry();
+      dbuffer_info_[v].num_stages = detector.stages_.at(v);
     }
     return ConvertSSA(operator()(std::move(stmt)));
   }
@@ -80,6 +90,7 @@ class DoubleBufferInjector : public StmtExprMutator {
   Stmt VisitStmt_(const AttrStmtNode* op) final {
     if (op->attr_key == attr::storage_scope) {
       const VarNode* buf = op->node.as<VarNode>();
+      storage_scope_[buf] = op->value.as<StringImmNode>()->value;
       auto it = dbuffer_info_.find(buf);
       if (it != dbuffer_info_.end()) {
         it->second.scope = op->value.as<StringImmNode>()->value;
@@ -101,7 +112,8 @@ class DoubleBufferInjector : public StmtExprMutator {
           arith::ComputeReduce<MulNode>(op->extents, PrimExpr()) * op->dtype.lanes();
       Stmt stmt = StmtExprMutator::VisitStmt_(op);
       op = stmt.as<AllocateNode>();
-      Array<PrimExpr> new_extents{make_const(op->extents[0].dtype(), 2)};
+      Array<PrimExpr> new_extents{
+          make_const(op->extents[0].dtype(), it->second.num_stages)};
       for (PrimExpr e : op->extents) {
         new_extents.push_back(e);
       }
@@ -143,9 +155,11 @@ class DoubleBufferInjector : public StmtExprMutator {
         }
         Stmt loop = ForNode::make(outer_var, zero, outer_ext, old_loop->for_type,
                                   old_loop->device_api, SeqStmt::Flatten(loop_seq));
-        // tail
+        // tail. With more than two stages, the iterations of the tail
+        // may still have to fetch.
         std::vector<Stmt> tail_seq;
-        Stmt tail_body = StripDoubleBufferWrite()(old_loop->body);
+        Stmt tail_body =
+            max_stages_[op] > 2 ? old_loop->body : StripDoubleBufferWrite()(old_loop->body);
         for (int32_t i = 0; i < split_loop_; ++i) {
           PrimExpr idx = tail_base + make_const(tail_base.dtype(), i);
           vmap[old_loop->loop_var.get()] = idx;
@@ -172,8 +186,12 @@ class DoubleBufferInjector : public StmtExprMutator {
       const StorageEntry& e = it->second;
       CHECK(in_double_buffer_scope_);
       CHECK(e.stride.defined());
-      return StoreNode::make(op->buffer_var, op->value, e.switch_write_var * e.stride + op->index,
-                             op->predicate, op->sync_type);
+      PrimExpr index = e.switch_write_var * e.stride + op->index;
+      if (async_copy_ && e.scope == "shared") {
+        Stmt async_copy = MakeAsyncCopy(op, index);
+        if (async_copy.defined()) return async_copy;
+      }
+      return StoreNode::make(op->buffer_var, op->value, index, op->predicate, op->sync_type);
     } else {
       return stmt;
     }
@@ -200,6 +218,55 @@ class DoubleBufferInjector : public StmtExprMutator {
   }
 
  private:
+  // The base of a scalar or contiguous vector index.
+  static PrimExpr ContiguousBase(const PrimExpr& index, int lanes) {
+    if (lanes == 1) return index;
+    if (auto ramp = index.as<RampNode>()) {
+      if (is_one(ramp->stride) && ramp->lanes == lanes) return ramp->base;
+    }
+    return PrimExpr();
+  }
+
+  // Rewrites a store of a global load into the pipelined buffer to an
+  // asynchronous copy, if it is one that cp.async supports. Returns an
+  // undefined stmt otherwise.
+  Stmt MakeAsyncCopy(const StoreNode* op, PrimExpr index) {
+    auto load = op->value.as<LoadNode>();
+    if (!load || !is_one(op->predicate) || !is_one(load->predicate)) return Stmt();
+    auto it = storage_scope_.find(load->buffer_var.get());
+    if (it != storage_scope_.end() && it->second != "global") return Stmt();
+    DataType dtype = op->value.dtype();
+    int bytes = dtype.bits() * dtype.lanes() / 8;
+    if (bytes != 4 && bytes != 8 && bytes != 16) return Stmt();
+    PrimExpr dst_base = ContiguousBase(index, dtype.lanes());
+    PrimExpr src_base = ContiguousBase(load->index, dtype.lanes());
+    if (!dst_base.defined() || !src_base.defined()) return Stmt();
+
+    DataType elem = dtype.element_of();
+    PrimExpr lanes = make_const(dst_base.dtype(), dtype.lanes());
+    auto access_ptr = [&](Var buffer, PrimExpr base, int rw_mask) {
+      return CallNode::make(DataType::Handle(), intrinsic::tvm_access_ptr,
+                            {TypeAnnotation(elem), buffer, base, lanes, rw_mask},
+                            CallNode::Intrinsic);
+    };
+    has_async_copy_ = true;
+    return EvaluateNode::make(
+        CallNode::make(DataType::Int(32), intrinsic::tvm_cp_async,
+                       {access_ptr(op->buffer_var, dst_base, 2),
+                        access_ptr(load->buffer_var, src_base, 1), bytes},
+                       CallNode::Intrinsic));
+  }
+
+  static Stmt MakeIntrinsicCall(const char* name, Array<PrimExpr> args) {
+    return EvaluateNode::make(CallNode::make(DataType::Int(32), name, args, CallNode::Intrinsic));
+  }
+
+  // The fetch of iteration i + num_stages - 1 is issued in iteration
+  // i, into the stage read by iteration i - 1. The first num_stages -
+  // 1 iterations are fetched before the loop. All fetches are guarded
+  // by the extent of the loop, which may be too short to fill the
+  // pipeline, as for ragged loops whose extents vary from one row to
+  // the next.
   Stmt MakeProducer(const AttrStmtNode* op) {
     const Var buffer = Downcast<Var>(op->node);
     CHECK_NE(loop_nest_.size(), 0U) << "Double buffer scope must be inside a loop";
@@ -210,24 +277,56 @@ class DoubleBufferInjector : public StmtExprMutator {
     }
     StorageEntry& e = it->second;
     e.loop = loop_nest_.back();
-    PrimExpr zero = make_const(e.loop->loop_var.dtype(), 0);
-    PrimExpr one = make_const(e.loop->loop_var.dtype(), 1);
-    PrimExpr two = make_const(e.loop->loop_var.dtype(), 2);
-    PrimExpr loop_shift = e.loop->loop_var + one;
-    e.switch_write_var = Var(e.loop->loop_var->name_hint + ".db", e.loop->loop_var.dtype());
-    e.switch_read_var = indexmod(e.loop->loop_var, two);
+    DataType dtype = e.loop->loop_var.dtype();
+    int64_t num_stages = e.num_stages;
+    max_stages_[e.loop] = std::max(max_stages_[e.loop], num_stages);
+    PrimExpr stages = make_const(dtype, num_stages);
+    PrimExpr loop_shift = e.loop->loop_var + make_const(dtype, num_stages - 1);
+    e.switch_write_var = Var(e.loop->loop_var->name_hint + ".db", dtype);
+    e.switch_read_var = indexmod(e.loop->loop_var, stages);
     in_double_buffer_scope_ = true;
+    has_async_copy_ = false;
     Stmt body = this->VisitStmt(op->body);
     in_double_buffer_scope_ = false;
+    bool async = has_async_copy_;
+
+    Stmt commit_group = MakeIntrinsicCall(intrinsic::tvm_cp_async_commit_group, {});
+    Stmt wait_group = MakeIntrinsicCall(intrinsic::tvm_cp_async_wait_group,
+                                        {static_cast<int>(num_stages - 2)});
+    if (e.scope == "shared") {
+      // The wait only covers the copies of the calling thread, while
+      // the consumer reads the ones of the others as well.
+      Stmt sync = MakeIntrinsicCall(intrinsic::tvm_storage_sync, {StringImmNode::make("shared")});
+      wait_group = SeqStmt({wait_group, sync});
+    }
     std::unordered_map<const VarNode*, PrimExpr> vmap;
-    vmap[e.switch_write_var.get()] = zero;
-    vmap[e.loop->loop_var.get()] = zero;
-    loop_pre_[e.loop].emplace_back(Substitute(body, vmap));
+    for (int64_t i = 0; i + 1 < num_stages; ++i) {
+      PrimExpr iter = make_const(dtype, i);
+      vmap[e.switch_write_var.get()] = iter;
+      vmap[e.loop->loop_var.get()] = iter;
+      Stmt fetch = Substitute(body, vmap);
+      // Two stage buffering always fetched the first iteration.
+      if (num_stages > 2 && !is_one(Simplify(iter < e.loop->extent))) {
+        fetch = IfThenElseNode::make(iter < e.loop->extent, fetch);
+      }
+      loop_pre_[e.loop].emplace_back(fetch);
+      if (async) loop_pre_[e.loop].emplace_back(commit_group);
+    }
+    if (async) {
+      // The first stage is complete before the loop.
+      loop_pre_[e.loop].emplace_back(wait_group);
+    }
     vmap[e.loop->loop_var.get()] = loop_shift;
-    vmap[e.switch_write_var.get()] = indexmod(loop_shift, two);
+    vmap[e.switch_write_var.get()] = indexmod(loop_shift, stages);
     body = Substitute(body, vmap);
     body = AttrStmtNode::make(buffer, attr::double_buffer_write, 1, body);
     body = IfThenElseNode::make(loop_shift < e.loop->extent, body);
+    if (async) {
+      // The stage read in this iteration is complete once at most
+      // num_stages - 2 of the later ones are pending. Empty groups
+      // are committed at the end of the loop to keep the count.
+      body = SeqStmt({wait_group, body, commit_group});
+    }
     return body;
   }
   // Storage entry for those who need double buffering.
@@ -242,9 +341,19 @@ class DoubleBufferInjector : public StmtExprMutator {
     PrimExpr switch_read_var;
     // The storage scope.
     std::string scope;
+    // The number of stages.
+    int64_t num_stages{2};
   };
   // Whether split loop
   int32_t split_loop_;
+  // Whether fetches from global to shared memory are asynchronous.
+  bool async_copy_;
+  // Whether the current fetch has asynchronous copies.
+  bool has_async_copy_{false};
+  // The largest number of stages of the buffers fetched in a loop.
+  std::unordered_map<const ForNode*, int64_t> max_stages_;
+  // The storage scope of each buffer.
+  std::unordered_map<const VarNode*, std::string> storage_scope_;
   // Whether we are inside double buffer scope.
   bool in_double_buffer_scope_{false};
   // The current loop next
@@ -257,8 +366,8 @@ class DoubleBufferInjector : public StmtExprMutator {
   std::unordered_map<const VarNode*, StorageEntry> dbuffer_info_;
 };
 
-Stmt InjectDoubleBuffer(Stmt stmt, int split_loop) {
-  return DoubleBufferInjector(split_loop).Inject(stmt);
+Stmt InjectDoubleBuffer(Stmt stmt, int split_loop, bool async_copy) {
+  return DoubleBufferInjector(split_loop, async_copy).Inject(stmt);
 }
 }  // namespace tir
 }  // namespace tvm
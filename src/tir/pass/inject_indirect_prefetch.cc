@@ -0,0 +1,239 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file inject_indirect_prefetch.cc
+ * \brief Prefetch the targets of indirect loads through auxiliary arrays.
+ */
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/expr.h>
+#include <tvm/tir/expr_equality.h>
+#include <tvm/tir/ir_pass.h>
+#include <tvm/tir/stmt_functor.h>
+
+#include <unordered_map>
+#include <unordered_set>
+
+namespace tvm {
+namespace tir {
+
+// A gather in the body of a loop: a load whose index reads an aux
+// array at an index that depends on the loop variable, such as
+// A[a_fun[o + 1] * H + j].
+struct Gather {
+  const LoadNode* data;
+  const LoadNode* aux;
+};
+
+// Collects the gathers of a loop body whose addresses can be computed
+// ahead of time at the top of the body: the loads are unconditional,
+// and their indices are functions of the loop variable, loop invariant
+// vars and the variables of inner loops (which are replaced by their
+// minimum, so that the start of the gathered row is prefetched).
+class GatherCollector : public StmtExprVisitor {
+ public:
+  explicit GatherCollector(Var loop_var) : loop_var_(loop_var) {}
+
+  void VisitStmt_(const ForNode* op) final {
+    this->VisitExpr(op->min);
+    this->VisitExpr(op->extent);
+    PrimExpr min = Substitute(op->min, inner_mins_);
+    if (ExprUseVar(min, defined_vars_)) {
+      defined_vars_.insert(op->loop_var.get());
+    } else {
+      inner_mins_[op->loop_var.get()] = min;
+    }
+    this->VisitStmt(op->body);
+  }
+
+  void VisitStmt_(const LetStmtNode* op) final {
+    defined_vars_.insert(op->var.get());
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitStmt_(const AllocateNode* op) final {
+    defined_vars_.insert(op->buffer_var.get());
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitStmt_(const StoreNode* op) final {
+    stored_buffers_.insert(op->buffer_var.get());
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitStmt_(const IfThenElseNode* op) final {
+    this->VisitExpr(op->condition);
+    ++conditional_depth_;
+    this->VisitStmt(op->then_case);
+    if (op->else_case.defined()) this->VisitStmt(op->else_case);
+    --conditional_depth_;
+  }
+
+  void VisitExpr_(const LetNode* op) final {
+    defined_vars_.insert(op->var.get());
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  void VisitExpr_(const SelectNode* op) final {
+    this->VisitExpr(op->condition);
+    ++conditional_depth_;
+    this->VisitExpr(op->true_value);
+    this->VisitExpr(op->false_value);
+    --conditional_depth_;
+  }
+
+  void VisitExpr_(const CallNode* op) final {
+    if (op->is_intrinsic(intrinsic::tvm_if_then_else)) {
+      this->VisitExpr(op->args[0]);
+      ++conditional_depth_;
+      this->VisitExpr(op->args[1]);
+      this->VisitExpr(op->args[2]);
+      --conditional_depth_;
+    } else {
+      StmtExprVisitor::VisitExpr_(op);
+    }
+  }
+
+  void VisitExpr_(const LoadNode* op) final {
+    StmtExprVisitor::VisitExpr_(op);
+    if (conditional_depth_ > 0 || op->dtype.lanes() != 1 || !is_one(op->predicate)) return;
+    const LoadNode* aux = nullptr;
+    PostOrderVisit(op->index, [&](const ObjectRef& node) {
+      if (auto load = node.as<LoadNode>()) {
+        if (!aux && load->dtype.is_int() && load->dtype.lanes() == 1 &&
+            ExprUseVar(load->index, loop_var_)) {
+          aux = load;
+        }
+      }
+    });
+    if (aux) candidates_.push_back({op, aux});
+  }
+
+  // The gathers whose addresses can be computed ahead of time.
+  std::vector<Gather> Gathers() {
+    std::vector<Gather> ret;
+    for (auto gather : candidates_) {
+      // The aux arrays are read ahead for real when computing the
+      // address of the data, so they may not be written in the loop.
+      if (!IsInvariant(gather.data->index) || ExprUseVar(gather.aux->index, defined_vars_)) {
+        continue;
+      }
+      PrimExpr index = Substitute(gather.data->index, inner_mins_);
+      if (ExprUseVar(index, defined_vars_)) continue;
+      ret.push_back(gather);
+    }
+    return ret;
+  }
+
+  // The minimums of the inner loops, in terms of outer vars.
+  std::unordered_map<const VarNode*, PrimExpr> inner_mins_;
+
+ private:
+  // Whether the index only reads memory not written in the loop.
+  bool IsInvariant(const PrimExpr& index) {
+    bool invariant = true;
+    PostOrderVisit(index, [&](const ObjectRef& node) {
+      if (auto load = node.as<LoadNode>()) {
+        if (stored_buffers_.count(load->buffer_var.get())) invariant = false;
+      }
+    });
+    return invariant;
+  }
+
+  Var loop_var_;
+  int conditional_depth_{0};
+  std::vector<Gather> candidates_;
+  std::unordered_set<const VarNode*> defined_vars_;
+  std::unordered_set<const VarNode*> stored_buffers_;
+};
+
+// Injects, at the top of the bodies of serial loops, software
+// prefetches for the gathers through aux arrays the loops perform:
+// the aux entries are prefetched 2 * distance iterations ahead, and
+// the data they point to distance iterations ahead, by when the aux
+// entries needed to compute its address should be in cache.
+class IndirectPrefetchInjector : public StmtMutator {
+ public:
+  explicit IndirectPrefetchInjector(int distance) : distance_(distance) {}
+
+  Stmt VisitStmt_(const ForNode* op) final {
+    Stmt stmt = StmtMutator::VisitStmt_(op);
+    op = stmt.as<ForNode>();
+    if (op->for_type != ForType::Serial || is_one(op->extent)) return stmt;
+
+    GatherCollector collector(op->loop_var);
+    collector(op->body);
+    std::vector<Gather> gathers = collector.Gathers();
+    if (gathers.size() == 0) return stmt;
+
+    DataType dtype = op->loop_var.dtype();
+    PrimExpr end = op->min + op->extent;
+    PrimExpr data_iter = op->loop_var + make_const(dtype, distance_);
+    PrimExpr aux_iter = op->loop_var + make_const(dtype, 2 * distance_);
+
+    std::unordered_set<PrimExpr, DeeperExprHash, DeeperExprEquality> aux_addrs, data_addrs;
+    std::vector<Stmt> aux_prefetches, data_prefetches;
+    for (auto gather : gathers) {
+      PrimExpr aux_addr = Address(gather.aux, op->loop_var, aux_iter, {});
+      if (aux_addrs.insert(aux_addr).second) {
+        aux_prefetches.push_back(Prefetch(aux_addr, gather.aux->dtype));
+      }
+      PrimExpr data_addr = Address(gather.data, op->loop_var, data_iter, collector.inner_mins_);
+      if (data_addrs.insert(data_addr).second) {
+        data_prefetches.push_back(Prefetch(data_addr, gather.data->dtype));
+      }
+    }
+
+    Array<Stmt> prefetches;
+    prefetches.push_back(IfThenElseNode::make(aux_iter < end, SeqStmt::Flatten(aux_prefetches)));
+    prefetches.push_back(
+        IfThenElseNode::make(data_iter < end, SeqStmt::Flatten(data_prefetches)));
+    prefetches.push_back(op->body);
+    return ForNode::make(op->loop_var, op->min, op->extent, op->for_type, op->device_api,
+                         SeqStmt(prefetches), op->hfuse_group_id);
+  }
+
+ private:
+  // The address load reads when loop_var is iter.
+  static PrimExpr Address(const LoadNode* load, const Var& loop_var, PrimExpr iter,
+                          std::unordered_map<const VarNode*, PrimExpr> vmap) {
+    vmap[loop_var.get()] = iter;
+    PrimExpr index = Substitute(load->index, vmap);
+    PrimExpr ahead =
+        LoadNode::make(load->dtype, load->buffer_var, index, load->predicate, load->sync_type);
+    return CallNode::make(DataType::Handle(), intrinsic::tvm_address_of, {ahead},
+                          CallNode::PureIntrinsic);
+  }
+
+  static Stmt Prefetch(PrimExpr address, DataType dtype) {
+    // Read, with high temporal locality, from the data cache.
+    return EvaluateNode::make(
+        CallNode::make(dtype, CallNode::prefetch, {address, 0, 3, 1}, CallNode::Intrinsic));
+  }
+
+  int distance_;
+};
+
+Stmt InjectIndirectPrefetch(Stmt stmt, int distance) {
+  CHECK_GT(distance, 0);
+  return IndirectPrefetchInjector(distance)(std::move(stmt));
+}
+
+}  // namespace tir
+}  // namespace tvm
@@ -21,6 +21,8 @@
  * \file inject_virtual_thread.cc
  */
 #include <tvm/arith/analyzer.h>
+#include <tvm/arith/int_set.h>
+#include <tvm/arith/pattern.h>
 #include <tvm/tir/expr.h>
 #include <tvm/tir/ir_pass.h>
 #include <tvm/tir/stmt_functor.h>
@@ -28,6 +30,7 @@
 #include <unordered_set>
 
 #include "../../arith/compute_expr.h"
+#include "../../arith/const_fold.h"
 
 namespace tvm {
 namespace tir {
@@ -412,6 +415,76 @@ class VTInjector : public StmtExprMutator {
     return false;
   }
 
+  // Find the number of virtual threads that do any work in stmt, from
+  // a guard of the form c * vthread + rest < bound enclosing all of its
+  // effects, such as the length check of a ragged loop split into
+  // virtual threads. Returns whether the guard is nested in loops.
+  bool FindActiveVThreads(Stmt stmt, PrimExpr* p_active, bool* p_in_loop) {
+    std::unordered_map<const VarNode*, arith::IntSet> dom_map;
+    std::unordered_set<const VarNode*> defined;
+    bool in_loop = false;
+    while (true) {
+      if (auto loop = stmt.as<ForNode>()) {
+        dom_map[loop->loop_var.get()] =
+            arith::IntSet::range(Range::make_by_min_extent(loop->min, loop->extent));
+        defined.insert(loop->loop_var.get());
+        in_loop = true;
+        stmt = loop->body;
+      } else if (auto let = stmt.as<LetStmtNode>()) {
+        defined.insert(let->var.get());
+        stmt = let->body;
+      } else if (auto alloc = stmt.as<AllocateNode>()) {
+        defined.insert(alloc->buffer_var.get());
+        stmt = alloc->body;
+      } else if (auto attr = stmt.as<AttrStmtNode>()) {
+        if (attr->attr_key != attr::storage_scope) return false;
+        stmt = attr->body;
+      } else {
+        break;
+      }
+    }
+    auto ite = stmt.as<IfThenElseNode>();
+    if (!ite || ite->else_case.defined()) return false;
+
+    std::vector<PrimExpr> conjuncts{ite->condition};
+    while (!conjuncts.empty()) {
+      PrimExpr cond = conjuncts.back();
+      conjuncts.pop_back();
+      if (auto call = cond.as<CallNode>()) {
+        if (call->is_intrinsic(CallNode::likely)) conjuncts.push_back(call->args[0]);
+        continue;
+      }
+      if (auto and_node = cond.as<AndNode>()) {
+        conjuncts.push_back(and_node->a);
+        conjuncts.push_back(and_node->b);
+        continue;
+      }
+      PrimExpr lhs, bound;
+      if (auto lt = cond.as<LTNode>()) {
+        lhs = lt->a;
+        bound = lt->b;
+      } else if (auto le = cond.as<LENode>()) {
+        lhs = le->a;
+        bound = le->b + 1;
+      } else {
+        continue;
+      }
+      if (!ExprUseVar(lhs, var_) || ExprUseVar(bound, var_) || ExprUseVar(bound, defined)) {
+        continue;
+      }
+      Array<PrimExpr> coeffs = arith::DetectLinearEquation(lhs, {var_});
+      int64_t coeff = 0;
+      if (coeffs.size() != 2 || !arith::GetConst(coeffs[0], &coeff) || coeff <= 0) continue;
+      PrimExpr rest_min = arith::EvalSet(coeffs[1], dom_map).min();
+      if (arith::is_neg_inf(rest_min) || ExprUseVar(rest_min, defined)) continue;
+      PrimExpr c = make_const(bound.dtype(), coeff);
+      *p_active = Simplify(indexdiv(bound - cast(bound.dtype(), rest_min) + c - 1, c));
+      *p_in_loop = in_loop;
+      return true;
+    }
+    return false;
+  }
+
   // inject vthread loop
   Stmt InjectVTLoop(Stmt stmt, bool before_mutation) {
     // std::cout << "[VT]  Injecting virtual thread loop " << stmt << std::endl;
@@ -435,12 +508,23 @@ class VTInjector : public StmtExprMutator {
       }
     }
 
+    // The virtual threads past a ragged bound do no work. Unrolled
+    // copies for them exit early, and loops over them are shortened.
+    PrimExpr active;
+    bool guard_in_loop = false;
+    bool bounded = FindActiveVThreads(stmt, &active, &guard_in_loop);
+
     // only unroll if number of vthreads are small
     if (allow_unroll_ && max_loop_depth_ == 0 && num_threads_ <= 16) {
       // do unrolling if it is inside innermost content.
       Array<Stmt> seq;
       for (int i = 0; i < num_threads_; ++i) {
-        seq.push_back(Substitute(stmt, {{var_, make_const(var_.dtype(), i)}}));
+        PrimExpr vt = make_const(var_.dtype(), i);
+        Stmt replica = Substitute(stmt, {{var_, vt}});
+        if (bounded && guard_in_loop) {
+          replica = IfThenElseNode::make(likely(cast(active.dtype(), vt) < active), replica);
+        }
+        seq.push_back(replica);
       }
       return SeqStmt::Flatten(seq);
     } else {
@@ -448,8 +532,12 @@ class VTInjector : public StmtExprMutator {
       Var idx(var_->name_hint + ".s", var_->dtype);
       Map<Var, PrimExpr> values{{var_, idx}};
       stmt = Substitute(stmt, values);
-      return ForNode::make(idx, make_zero(idx.dtype()), make_const(idx.dtype(), num_threads_),
-                           ForType::Serial, DeviceAPI::None, stmt);
+      PrimExpr extent = make_const(idx.dtype(), num_threads_);
+      if (bounded) {
+        extent = Simplify(min(extent, max(cast(idx.dtype(), active), make_zero(idx.dtype()))));
+      }
+      return ForNode::make(idx, make_zero(idx.dtype()), extent, ForType::Serial, DeviceAPI::None,
+                           stmt);
     }
   }
 
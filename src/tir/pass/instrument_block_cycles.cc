@@ -0,0 +1,181 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file instrument_block_cycles.cc
+ * \brief Record the cycle counts of each block of CUDA kernels.
+ */
+#include <tvm/runtime/module.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/expr.h>
+#include <tvm/tir/ir_pass.h>
+#include <tvm/tir/stmt_functor.h>
+
+#include <algorithm>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace tvm {
+namespace tir {
+
+// Makes each block of the kernels of a function record the cycle
+// counter at its entry and, once all of its threads are done, at its
+// exit. The records go to a device buffer of two int64 per block that
+// the host gets from the runtime before each launch, keyed by the
+// function name and the index of the kernel in it. With the blocks of
+// a fused ragged loop each covering a fixed number of fused
+// iterations, the durations show how well the fusion balances the
+// work of the outer iterations.
+class BlockCyclesInstrumenter : public StmtMutator {
+ public:
+  BlockCyclesInstrumenter(std::string name, int device_type, PrimExpr device_id)
+      : name_(name), device_type_(device_type), device_id_(device_id) {}
+
+  Stmt VisitStmt_(const AttrStmtNode* op) final {
+    if (op->attr_key != attr::thread_extent) return StmtMutator::VisitStmt_(op);
+    // This is the root of a kernel. Kernels do not nest, so there is
+    // no need to visit the body.
+    Stmt stmt = GetRef<Stmt>(op);
+
+    // The thread extents of the whole kernel, which may be bound below
+    // its top in horizontally fused kernels.
+    std::unordered_set<std::string> kernel_tags;
+    PostOrderVisit(stmt, [&kernel_tags](const ObjectRef& node) {
+      if (auto attr = node.as<AttrStmtNode>()) {
+        if (attr->attr_key == attr::thread_extent) {
+          kernel_tags.insert(Downcast<IterVar>(attr->node)->thread_tag);
+        }
+      }
+    });
+
+    // Peel off the thread extents and allocations at the top of the
+    // kernel.
+    std::vector<Stmt> wrappers;
+    std::vector<const AttrStmtNode*> block_attrs;
+    std::vector<Var> thread_vars;
+    std::unordered_set<std::string> top_tags;
+    Stmt body = stmt;
+    while (true) {
+      if (auto attr = body.as<AttrStmtNode>()) {
+        if (attr->attr_key == attr::thread_extent) {
+          IterVar iv = Downcast<IterVar>(attr->node);
+          if (!top_tags.insert(iv->thread_tag).second) break;
+          if (iv->thread_tag.find("blockIdx") == 0) {
+            block_attrs.push_back(attr);
+          } else if (iv->thread_tag.find("threadIdx") == 0) {
+            thread_vars.push_back(iv->var);
+          }
+        } else if (attr->attr_key != attr::storage_scope) {
+          break;
+        }
+        wrappers.push_back(body);
+        body = attr->body;
+      } else if (auto alloc = body.as<AllocateNode>()) {
+        wrappers.push_back(body);
+        body = alloc->body;
+      } else {
+        break;
+      }
+    }
+    // The records need the block and thread indices of the whole
+    // kernel where they are made.
+    if (top_tags != kernel_tags) return stmt;
+    int kernel = num_kernels_++;
+
+    // The linear block index, x fastest.
+    std::sort(block_attrs.begin(), block_attrs.end(),
+              [](const AttrStmtNode* a, const AttrStmtNode* b) {
+                return Downcast<IterVar>(a->node)->thread_tag <
+                       Downcast<IterVar>(b->node)->thread_tag;
+              });
+    PrimExpr block = make_const(DataType::Int(64), 0);
+    PrimExpr num_blocks = make_const(DataType::Int(64), 1);
+    for (size_t i = block_attrs.size(); i != 0; --i) {
+      const AttrStmtNode* attr = block_attrs[i - 1];
+      PrimExpr extent = cast(DataType::Int(64), attr->value);
+      block = block * extent + cast(DataType::Int(64), Downcast<IterVar>(attr->node)->var);
+      num_blocks = num_blocks * extent;
+    }
+
+    PrimExpr is_leader = const_true();
+    for (auto var : thread_vars) {
+      is_leader = is_leader && (var == make_zero(var.dtype()));
+    }
+
+    Var records("block_cycles", DataType::Handle());
+    auto record = [&](int offset) {
+      PrimExpr cycles = CallNode::make(DataType::Int(64), intrinsic::tvm_cycle_counter, {},
+                                       CallNode::Intrinsic);
+      return IfThenElseNode::make(
+          is_leader, StoreNode::make(records, cycles, block * 2 + offset, const_true(), kAll));
+    };
+    // The exit is recorded once all threads of the block are done.
+    Stmt new_body = SeqStmt({record(0), body, SyncThread(), record(1)});
+
+    // Rebuild the top of the kernel around the instrumented body.
+    for (size_t i = wrappers.size(); i != 0; --i) {
+      Stmt wrapper = wrappers[i - 1];
+      if (auto attr = wrapper.as<AttrStmtNode>()) {
+        new_body = AttrStmtNode::make(attr->node, attr->attr_key, attr->value, new_body,
+                                      attr->hfuse_group_id);
+      } else if (auto alloc = wrapper.as<AllocateNode>()) {
+        new_body = AllocateNode::make(alloc->buffer_var, alloc->dtype, alloc->extents,
+                                      alloc->layout, alloc->condition, new_body, alloc->new_expr,
+                                      alloc->free_function);
+      }
+    }
+
+    PrimExpr get_records = CallNode::make(
+        DataType::Handle(), intrinsic::tvm_call_packed,
+        {StringImmNode::make(runtime::symbol::tvm_block_cycles_buffer), StringImmNode::make(name_),
+         make_const(DataType::Int(32), kernel), Simplify(num_blocks),
+         make_const(DataType::Int(32), device_type_), device_id_},
+        CallNode::Intrinsic);
+    return LetStmtNode::make(records, get_records, new_body);
+  }
+
+ private:
+  static Stmt SyncThread() {
+    return EvaluateNode::make(CallNode::make(DataType::Int(32), intrinsic::tvm_storage_sync,
+                                             {StringImmNode::make("shared")},
+                                             CallNode::Intrinsic));
+  }
+
+  std::string name_;
+  int device_type_;
+  PrimExpr device_id_;
+  int num_kernels_{0};
+};
+
+LoweredFunc InstrumentBlockCycles(LoweredFunc f, int device_type) {
+  CHECK_NE(device_type, kDLCPU);
+  PrimExpr device_id = make_const(DataType::Int(32), 0);
+  PostOrderVisit(f->body, [&device_id](const ObjectRef& node) {
+    if (auto attr = node.as<AttrStmtNode>()) {
+      if (attr->attr_key == attr::device_context_id) device_id = attr->value;
+    }
+  });
+  auto n = make_object<LoweredFuncNode>(*f.operator->());
+  n->body = BlockCyclesInstrumenter(f->name, device_type, device_id)(n->body);
+  return LoweredFunc(n);
+}
+
+}  // namespace tir
+}  // namespace tvm
@@ -0,0 +1,134 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file intern_exprs.cc
+ * \brief Intern structurally equal expressions of a statement.
+ */
+#include <tvm/node/reflection.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/expr.h>
+#include <tvm/tir/ir_pass.h>
+#include <tvm/tir/stmt_functor.h>
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace tvm {
+namespace tir {
+
+// The fields of an expression node, with the nodes it refers to taken
+// by identity. When the children of two nodes have been interned, the
+// nodes are structurally equal iff their fields are the same.
+class ExprFields : public AttrVisitor {
+ public:
+  explicit ExprFields(const Object* node) : type_index_(node->type_index()) {
+    ReflectionVTable::Global()->VisitAttrs(const_cast<Object*>(node), this);
+  }
+
+  void Visit(const char* key, double* value) final { doubles_.push_back(*value); }
+  void Visit(const char* key, int64_t* value) final { ints_.push_back(*value); }
+  void Visit(const char* key, uint64_t* value) final {
+    ints_.push_back(static_cast<int64_t>(*value));
+  }
+  void Visit(const char* key, int* value) final { ints_.push_back(*value); }
+  void Visit(const char* key, bool* value) final { ints_.push_back(*value); }
+  void Visit(const char* key, std::string* value) final { strings_.push_back(*value); }
+  void Visit(const char* key, void** value) final { objects_.push_back(*value); }
+  void Visit(const char* key, DataType* value) final {
+    ints_.push_back(value->code());
+    ints_.push_back(value->bits());
+    ints_.push_back(value->lanes());
+  }
+  void Visit(const char* key, runtime::NDArray* value) final {
+    objects_.push_back(value->defined() ? value->operator->() : nullptr);
+  }
+  void Visit(const char* key, ObjectRef* value) final {
+    // Arrays of arguments, say, are rebuilt along with the node.
+    if (auto arr = value->as<ArrayNode>()) {
+      ints_.push_back(static_cast<int64_t>(arr->data.size()));
+      for (const auto& elem : arr->data) objects_.push_back(elem.get());
+    } else {
+      objects_.push_back(value->get());
+    }
+  }
+
+  bool operator==(const ExprFields& other) const {
+    return type_index_ == other.type_index_ && ints_ == other.ints_ &&
+           objects_ == other.objects_ && doubles_ == other.doubles_ &&
+           strings_ == other.strings_;
+  }
+
+  size_t Hash() const {
+    size_t hash = std::hash<uint32_t>()(type_index_);
+    auto combine = [&hash](size_t h) { hash ^= h + 0x9e3779b9 + (hash << 6) + (hash >> 2); };
+    for (auto v : ints_) combine(std::hash<int64_t>()(v));
+    for (auto v : objects_) combine(std::hash<const void*>()(v));
+    for (auto v : doubles_) combine(std::hash<double>()(v));
+    for (const auto& v : strings_) combine(std::hash<std::string>()(v));
+    return hash;
+  }
+
+ private:
+  uint32_t type_index_;
+  std::vector<int64_t> ints_;
+  std::vector<const void*> objects_;
+  std::vector<double> doubles_;
+  std::vector<std::string> strings_;
+};
+
+// Rebuilds expressions bottom up so that structurally equal subtrees
+// are represented by the same node. Vars are identities and are never
+// merged.
+class ExprInterner : public StmtExprMutator {
+ public:
+  PrimExpr VisitExpr(const PrimExpr& expr) final {
+    auto it = memo_.find(expr);
+    if (it != memo_.end()) return it->second;
+    PrimExpr ret = StmtExprMutator::VisitExpr(expr);
+    if (!ret->IsInstance<VarNode>()) {
+      Entry entry{ret, ExprFields(ret.get())};
+      ret = table_.insert(std::move(entry)).first->expr;
+    }
+    memo_[expr] = ret;
+    return ret;
+  }
+
+ private:
+  struct Entry {
+    PrimExpr expr;
+    ExprFields fields;
+  };
+  struct EntryHash {
+    size_t operator()(const Entry& e) const { return e.fields.Hash(); }
+  };
+  struct EntryEqual {
+    bool operator()(const Entry& a, const Entry& b) const { return a.fields == b.fields; }
+  };
+
+  std::unordered_set<Entry, EntryHash, EntryEqual> table_;
+  std::unordered_map<PrimExpr, PrimExpr, ObjectHash, ObjectEqual> memo_;
+};
+
+Stmt InternExprs(Stmt stmt) { return ExprInterner()(std::move(stmt)); }
+
+}  // namespace tir
+}  // namespace tvm
@@ -119,8 +119,73 @@ namespace tir {
     std::unordered_map<const StoreNode*, std::vector<const CallNode*>> if_else_exprs;
   };
 
-  Stmt ExpandIntrinsicITE(Stmt stmt) {
+  // Lowers the if_then_else calls whose branches are cheap and safe to
+  // evaluate unconditionally to selects, which the backends emit
+  // without branches (selp in PTX, select in LLVM). Expanding them
+  // instead duplicates the enclosing store for each combination of
+  // the conditions, and on GPUs, the branches on conditions that vary
+  // across the threads of a warp, such as those of the recovery of
+  // fused ragged indices, diverge and are executed in turn anyway.
+  class BranchlessITELowerer : public StmtExprMutator {
+  public:
+    explicit BranchlessITELowerer(bool for_gpu) : for_gpu_(for_gpu) {}
+
+    PrimExpr VisitExpr_(const CallNode* op) final {
+      PrimExpr ret = StmtExprMutator::VisitExpr_(op);
+      op = ret.as<CallNode>();
+      if (op == nullptr || !op->is_intrinsic(intrinsic::tvm_if_then_else) ||
+          op->dtype.lanes() != 1) {
+        return ret;
+      }
+      // Both branches are always evaluated, so divergent GPU code
+      // affords more work in them than CPU code, where branches on
+      // such conditions are mostly predicted well.
+      int budget = for_gpu_ ? kMaxGPUBranchCost : kMaxCPUBranchCost;
+      if (!IsCheap(op->args[1], budget) || !IsCheap(op->args[2], budget)) return ret;
+      return SelectNode::make(op->args[0], op->args[1], op->args[2]);
+    }
+
+  private:
+    static constexpr int kMaxGPUBranchCost = 16;
+    static constexpr int kMaxCPUBranchCost = 4;
+
+    // Whether e has no more than budget nodes, and none that may fault
+    // or have side effects when its guard does not hold: loads, which
+    // the guard may keep in bounds, calls other than pure ones, and
+    // divisions by anything but a nonzero constant.
+    static bool IsCheap(const PrimExpr& e, int budget) {
+      bool cheap = true;
+      int cost = 0;
+      PostOrderVisit(e, [&](const ObjectRef& n) {
+        if (++cost > budget || n.as<LoadNode>() || n.as<LetNode>()) {
+          cheap = false;
+        } else if (const CallNode* call = n.as<CallNode>()) {
+          if (call->call_type != CallNode::PureIntrinsic &&
+              call->call_type != CallNode::PureExtern) {
+            cheap = false;
+          }
+        } else if (!SafeDivisor<DivNode>(n) || !SafeDivisor<ModNode>(n) ||
+                   !SafeDivisor<FloorDivNode>(n) || !SafeDivisor<FloorModNode>(n)) {
+          cheap = false;
+        }
+      });
+      return cheap;
+    }
+
+    template <typename T>
+    static bool SafeDivisor(const ObjectRef& n) {
+      const T* op = n.as<T>();
+      if (op == nullptr || !op->dtype.is_int()) return true;
+      const IntImmNode* imm = op->b.template as<IntImmNode>();
+      return imm != nullptr && imm->value != 0;
+    }
+
+    bool for_gpu_;
+  };
+
+  Stmt ExpandIntrinsicITE(Stmt stmt, bool for_gpu) {
     // std::cout << "Better hoisting ifelse" << std::endl;
+    stmt = BranchlessITELowerer(for_gpu)(std::move(stmt));
     return ConvertSSA(InlineIfThenElseExpander(stmt).ExpandIfThenElseExpr());
   }
 }
@@ -23,11 +23,49 @@
  */
 #include "ir_util.h"
 
+#include <tvm/tir/ir_pass.h>
 #include <tvm/tir/stmt_functor.h>
 
 namespace tvm {
 namespace tir {
 
+bool HasDivergentBarrier(const Stmt& stmt, const std::unordered_set<const VarNode*>& vars) {
+  class BarrierChecker : public StmtExprVisitor {
+   public:
+    explicit BarrierChecker(const std::unordered_set<const VarNode*>& vars) : vars_(vars) {}
+
+    void VisitStmt_(const IfThenElseNode* op) final {
+      Guarded(ExprUseVar(op->condition, vars_), [&]() { StmtExprVisitor::VisitStmt_(op); });
+    }
+
+    void VisitStmt_(const ForNode* op) final {
+      Guarded(ExprUseVar(op->min, vars_) || ExprUseVar(op->extent, vars_),
+              [&]() { StmtExprVisitor::VisitStmt_(op); });
+    }
+
+    void VisitExpr_(const CallNode* op) final {
+      if (op->is_intrinsic(intrinsic::tvm_storage_sync) && divergent_depth_ > 0) found = true;
+      StmtExprVisitor::VisitExpr_(op);
+    }
+
+    bool found{false};
+
+   private:
+    template <typename F>
+    void Guarded(bool divergent, F visit) {
+      if (divergent) ++divergent_depth_;
+      visit();
+      if (divergent) --divergent_depth_;
+    }
+
+    const std::unordered_set<const VarNode*>& vars_;
+    int divergent_depth_{0};
+  };
+  BarrierChecker checker(vars);
+  checker(stmt);
+  return checker.found;
+}
+
 Map<Buffer, Buffer> ExtractPrepCode(const Stmt& full_body, Stmt* p_prep_code, Stmt* p_main_body) {
   class PrepCodeChecker : public StmtVisitor {
     void VisitStmt_(const LetStmtNode* op) final {
@@ -29,12 +29,23 @@
 #include <tvm/tir/expr.h>
 #include <tvm/tir/op.h>
 
+#include <unordered_set>
 #include <vector>
 
 namespace tvm {
 namespace tir {
 Map<Buffer, Buffer> ExtractPrepCode(const Stmt& full_body, Stmt* p_prep_code, Stmt* p_main_body);
 
+/*!
+ * \brief Check whether a barrier in stmt sits under a branch or loop
+ *  whose condition or extent depends on one of vars, so that some
+ *  threads could skip a barrier others wait at.
+ * \param stmt The stmt to check, after ThreadSync.
+ * \param vars The variables that vary across the threads of a block.
+ * \return Whether there is such a barrier.
+ */
+bool HasDivergentBarrier(const Stmt& stmt, const std::unordered_set<const VarNode*>& vars);
+
 /*!
  * \brief combine the nest stmt, whose body is not defined.
  * \param nest A list of For and LetStmt, whose body is not defined.
@@ -21,10 +21,13 @@
  * \file loop_partition.cc
  */
 #include <tvm/arith/analyzer.h>
+#include <tvm/arith/z3_analyzer.h>
 #include <tvm/tir/expr.h>
 #include <tvm/tir/ir_pass.h>
+#include <tvm/tir/lowered_func.h>
 #include <tvm/tir/stmt_functor.h>
 
+#include <functional>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -591,6 +594,193 @@ Stmt RemoveLikelyTags(Stmt stmt) {
   return stmt;
 }
 
+// Replaces the conjuncts of conditions that are equal to a given
+// condition with a value, removing the branches that become constant.
+class RaggedConditionEliminator : public StmtMutator {
+ public:
+  RaggedConditionEliminator(PrimExpr cond, bool cond_value)
+      : cond_(cond), cond_value_(cond_value) {}
+
+  Stmt VisitStmt_(const IfThenElseNode* op) final {
+    PrimExpr cond = Replace(op->condition);
+    if (is_one(cond)) return this->VisitStmt(op->then_case);
+    if (is_zero(cond)) {
+      return op->else_case.defined() ? this->VisitStmt(op->else_case) : EvaluateNode::make(0);
+    }
+    Stmt then_case = this->VisitStmt(op->then_case);
+    Stmt else_case = op->else_case.defined() ? this->VisitStmt(op->else_case) : Stmt();
+    return IfThenElseNode::make(cond, then_case, else_case);
+  }
+
+ private:
+  PrimExpr Replace(const PrimExpr& cond) {
+    if (auto op = cond.as<AndNode>()) {
+      PrimExpr a = Replace(op->a);
+      PrimExpr b = Replace(op->b);
+      if (is_zero(a) || is_zero(b)) return const_false();
+      if (is_one(a)) return b;
+      if (is_one(b)) return a;
+      return AndNode::make(a, b);
+    }
+    if (auto call = cond.as<CallNode>()) {
+      if (call->is_intrinsic(CallNode::likely)) return Replace(call->args[0]);
+    }
+    if (Equal(cond, cond_)) return make_const(cond.dtype(), cond_value_);
+    return cond;
+  }
+
+  PrimExpr cond_;
+  bool cond_value_;
+};
+
+// Partitions serial loops whose bodies are guarded by conditions of
+// the form i < bound, with the bound invariant in the loop, as ragged
+// lowering produces for bounds given by uninterpreted functions (or
+// the auxiliary arrays they have been lowered to), such as i <
+// l_fun(o). The loop is split at the bound into a loop in which the
+// condition holds and one in which it does not, neither of which
+// branches on it. The constraints of the function are used to drop
+// the clamping of the split point to the range of the loop when it is
+// not needed.
+class RaggedLoopPartitioner : public StmtMutator {
+ public:
+  explicit RaggedLoopPartitioner(const Array<PrimExpr>& constraints) {
+    for (const auto& constraint : constraints) analyzer_.AddConstraint(constraint);
+  }
+
+  Stmt VisitStmt_(const AttrStmtNode* op) final {
+    if (op->attr_key == attr::thread_extent) {
+      IterVar iv = Downcast<IterVar>(op->node);
+      analyzer_.Update(iv->var, Range::make_by_min_extent(0, op->value), true);
+      if (iv->thread_tag.find("threadIdx") == 0) thread_vars_.insert(iv->var.get());
+    }
+    return StmtMutator::VisitStmt_(op);
+  }
+
+  Stmt VisitStmt_(const LetStmtNode* op) final {
+    analyzer_.Update(op->var, op->value, true);
+    return StmtMutator::VisitStmt_(op);
+  }
+
+  Stmt VisitStmt_(const ForNode* op) final {
+    analyzer_.Update(op->loop_var, Range::make_by_min_extent(op->min, op->extent), true);
+    Stmt stmt = StmtMutator::VisitStmt_(op);
+    op = stmt.as<ForNode>();
+    if (op->for_type != ForType::Serial) return stmt;
+
+    PrimExpr cond, bound;
+    std::tie(cond, bound) = FindBound(op);
+    if (!cond.defined()) return stmt;
+
+    // Threads of a block that run different numbers of iterations
+    // would not all arrive at a barrier in the body.
+    if (ExprUseVar(bound, thread_vars_) && HasSync(op->body)) return stmt;
+
+    PrimExpr end = op->min + op->extent;
+    PrimExpr split = bound;
+    if (!analyzer_.CanProve(split <= end)) split = min(split, end);
+    if (!analyzer_.CanProve(split >= op->min)) split = max(split, op->min);
+    split = Simplify(split);
+
+    Stmt true_body = RaggedConditionEliminator(cond, true)(op->body);
+    Stmt false_body = RaggedConditionEliminator(cond, false)(op->body);
+    // The loop in which the condition holds is the steady state, in
+    // which the other bounds are partitioned on as well.
+    Stmt head = this->VisitStmt(ForNode::make(op->loop_var, op->min, Simplify(split - op->min),
+                                              op->for_type, op->device_api, true_body,
+                                              op->hfuse_group_id));
+    if (is_no_op(RemoveNoOp(false_body)) || analyzer_.CanProve(bound >= end)) return head;
+    Stmt tail = ForNode::make(op->loop_var, split, Simplify(end - split), op->for_type,
+                              op->device_api, false_body, op->hfuse_group_id);
+    return SeqStmt({head, tail});
+  }
+
+ private:
+  // Finds the first condition guarding a branch in the body of the
+  // loop that bounds the loop var, i + c < b (or b > i + c, or their
+  // non strict counterparts) with b and c invariant in the loop.
+  // Returns the condition and the bound it places on i, or undefined
+  // exprs if there is none.
+  std::pair<PrimExpr, PrimExpr> FindBound(const ForNode* loop) {
+    std::unordered_set<const VarNode*> inner_vars = {loop->loop_var.get()};
+    PostOrderVisit(loop->body, [&](const ObjectRef& node) {
+      if (auto let = node.as<LetStmtNode>()) {
+        inner_vars.insert(let->var.get());
+      } else if (auto inner = node.as<ForNode>()) {
+        inner_vars.insert(inner->loop_var.get());
+      } else if (auto alloc = node.as<AllocateNode>()) {
+        inner_vars.insert(alloc->buffer_var.get());
+      } else if (auto store = node.as<StoreNode>()) {
+        // Loads of buffers written in the loop are not invariant.
+        inner_vars.insert(store->buffer_var.get());
+      }
+    });
+
+    PrimExpr cond, bound;
+    std::function<void(const PrimExpr&)> visit_conjuncts = [&](const PrimExpr& expr) {
+      if (cond.defined()) return;
+      if (auto op = expr.as<AndNode>()) {
+        visit_conjuncts(op->a);
+        visit_conjuncts(op->b);
+        return;
+      }
+      if (auto call = expr.as<CallNode>()) {
+        if (call->is_intrinsic(CallNode::likely)) visit_conjuncts(call->args[0]);
+        return;
+      }
+      PrimExpr a, b;
+      int64_t strict_offset = 0;
+      if (auto op = expr.as<LTNode>()) {
+        a = op->a, b = op->b;
+      } else if (auto op = expr.as<GTNode>()) {
+        a = op->b, b = op->a;
+      } else if (auto op = expr.as<LENode>()) {
+        a = op->a, b = op->b, strict_offset = 1;
+      } else if (auto op = expr.as<GENode>()) {
+        a = op->b, b = op->a, strict_offset = 1;
+      } else {
+        return;
+      }
+      if (!a.dtype().is_int() || ExprUseVar(b, inner_vars)) return;
+      PrimExpr offset = Simplify(a - loop->loop_var);
+      if (ExprUseVar(offset, inner_vars)) return;
+      cond = expr;
+      bound = Simplify(b - offset + make_const(b.dtype(), strict_offset));
+    };
+    PostOrderVisit(loop->body, [&](const ObjectRef& node) {
+      if (auto branch = node.as<IfThenElseNode>()) visit_conjuncts(branch->condition);
+    });
+    return std::make_pair(cond, bound);
+  }
+
+  static bool HasSync(const Stmt& body) {
+    bool has_sync = false;
+    PostOrderVisit(body, [&](const ObjectRef& node) {
+      if (auto call = node.as<CallNode>()) {
+        if (call->is_intrinsic(intrinsic::tvm_storage_sync)) has_sync = true;
+      }
+    });
+    return has_sync;
+  }
+
+  arith::Z3Analyzer analyzer_;
+  std::unordered_set<const VarNode*> thread_vars_;
+};
+
+Stmt RaggedLoopPartitionStmt(Stmt stmt, Array<PrimExpr> constraints) {
+  Stmt ret = RaggedLoopPartitioner(constraints)(stmt);
+  if (!ret.same_as(stmt)) {
+    return ConvertSSA(RemoveNoOp(ret));
+  }
+  return ret;
+}
+
+LoweredFunc RaggedLoopPartition(LoweredFunc f, Array<PrimExpr> constraints) {
+  auto n = make_object<LoweredFuncNode>(*f.operator->());
+  n->body = RaggedLoopPartitionStmt(f->body, constraints);
+  return LoweredFunc(n);
+}
+
 Stmt LoopPartition(Stmt stmt, bool split_const_loop) {
   stmt = LoopPartitioner(split_const_loop).VisitAndMutate(std::move(stmt));
   stmt = LikelyTagsRemover()(std::move(stmt));
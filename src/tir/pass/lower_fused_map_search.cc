@@ -0,0 +1,168 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file lower_fused_map_search.cc
+ * \brief Lower the searches of fused loop maps computed on the fly.
+ */
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/expr.h>
+#include <tvm/tir/ir_pass.h>
+#include <tvm/tir/stmt_functor.h>
+
+#include <unordered_set>
+
+namespace tvm {
+namespace tir {
+
+// Lowers the tvm_fused_map_search calls, which compute the maps of
+// ragged fused loops where they are used instead of loading them from
+// auxiliary arrays, into binary search loops. Each distinct search is
+// hoisted out of the statements it is used in, up to the statement
+// that defines a variable it depends on, but not out of a kernel.
+class FusedMapSearchLowerer : public StmtExprMutator {
+ public:
+  Stmt Lower(Stmt stmt) {
+    stmt = this->VisitStmt(stmt);
+    return Place(stmt, nullptr);
+  }
+
+  PrimExpr VisitExpr_(const CallNode* op) final {
+    PrimExpr expr = StmtExprMutator::VisitExpr_(op);
+    op = expr.as<CallNode>();
+    if (!op || !op->is_intrinsic(intrinsic::tvm_fused_map_search)) return expr;
+    for (const auto& search : pending_) {
+      if (Equal(search.call, expr)) return search.result;
+    }
+    Var result("fused_outer", op->dtype);
+    pending_.push_back({result, expr});
+    return result;
+  }
+
+  Stmt VisitStmt_(const ForNode* op) final {
+    PrimExpr min = this->VisitExpr(op->min);
+    PrimExpr extent = this->VisitExpr(op->extent);
+    std::vector<Search> outer;
+    std::swap(outer, pending_);
+    Stmt body = this->VisitStmt(op->body);
+    body = Place(body, op->loop_var.get(), &outer);
+    return ForNode::make(op->loop_var, min, extent, op->for_type, op->device_api, body,
+                         op->hfuse_group_id);
+  }
+
+  Stmt VisitStmt_(const LetStmtNode* op) final {
+    PrimExpr value = this->VisitExpr(op->value);
+    std::vector<Search> outer;
+    std::swap(outer, pending_);
+    Stmt body = this->VisitStmt(op->body);
+    body = Place(body, op->var.get(), &outer);
+    return LetStmtNode::make(op->var, value, body);
+  }
+
+  Stmt VisitStmt_(const AllocateNode* op) final {
+    Array<PrimExpr> extents;
+    for (auto extent : op->extents) extents.push_back(this->VisitExpr(extent));
+    PrimExpr condition = this->VisitExpr(op->condition);
+    std::vector<Search> outer;
+    std::swap(outer, pending_);
+    Stmt body = this->VisitStmt(op->body);
+    body = Place(body, op->buffer_var.get(), &outer);
+    return AllocateNode::make(op->buffer_var, op->dtype, extents, op->layout, condition, body,
+                              op->new_expr, op->free_function);
+  }
+
+  Stmt VisitStmt_(const AttrStmtNode* op) final {
+    if (op->attr_key != attr::thread_extent) return StmtExprMutator::VisitStmt_(op);
+    PrimExpr value = this->VisitExpr(op->value);
+    std::vector<Search> outer;
+    std::swap(outer, pending_);
+    Stmt body = this->VisitStmt(op->body);
+    // Searches in a kernel are performed by every thread, so they stay
+    // within the kernel.
+    body = Place(body, nullptr, &outer);
+    return AttrStmtNode::make(op->node, op->attr_key, value, body, op->hfuse_group_id);
+  }
+
+ private:
+  struct Search {
+    Var result;
+    PrimExpr call;
+  };
+
+  // Places the pending searches that depend on var (all of them if var
+  // is null) around body. The others are moved to outer and become
+  // pending again.
+  Stmt Place(Stmt body, const VarNode* var, std::vector<Search>* outer = nullptr) {
+    std::unordered_set<const VarNode*> placed_vars;
+    if (var) placed_vars.insert(var);
+    std::vector<Search> placed;
+    std::vector<Search> rest = outer ? *outer : std::vector<Search>();
+    for (auto& search : pending_) {
+      // Searches can depend on the results of earlier ones.
+      if (!var || ExprUseVar(search.call, placed_vars)) {
+        placed.push_back(search);
+        placed_vars.insert(search.result.get());
+      } else {
+        rest.push_back(search);
+      }
+    }
+    pending_ = rest;
+    for (size_t i = placed.size(); i != 0; --i) {
+      body = MakeSearch(placed[i - 1], body);
+    }
+    return body;
+  }
+
+  static Stmt MakeSearch(const Search& search, Stmt body) {
+    auto call = search.call.as<CallNode>();
+    CHECK_EQ(call->args.size(), 6);
+    Var pos_data = Downcast<Var>(call->args[0]);
+    PrimExpr pos_offset = call->args[1];
+    DataType pos_dtype = call->args[2].dtype();
+    PrimExpr fused = call->args[3];
+    PrimExpr outer_extent = call->args[4];
+    int steps = Downcast<IntImm>(call->args[5])->value;
+    DataType dtype = search.result.dtype();
+    if (steps == 0) return LetStmtNode::make(search.result, make_zero(dtype), body);
+
+    Var lo_buf("fused_outer_lo", DataType::Handle());
+    Var step("step", dtype);
+    PrimExpr lo = LoadNode::make(dtype, lo_buf, 0, const_true(), kAll);
+    PrimExpr candidate = lo + (make_const(dtype, 1 << (steps - 1)) >> step);
+    PrimExpr pos = cast(dtype, LoadNode::make(pos_dtype, pos_data, pos_offset + candidate,
+                                              const_true(), kAll));
+    // The start positions are only loaded for valid candidates.
+    Stmt update = IfThenElseNode::make(
+        candidate < outer_extent,
+        IfThenElseNode::make(pos <= fused, StoreNode::make(lo_buf, candidate, 0, const_true(),
+                                                           kAll)));
+    Stmt loop = ForNode::make(step, 0, steps, ForType::Serial, DeviceAPI::None, update);
+    Stmt ret = SeqStmt({StoreNode::make(lo_buf, make_zero(dtype), 0, const_true(), kAll), loop,
+                        LetStmtNode::make(search.result, lo, body)});
+    ret = AllocateNode::make(lo_buf, dtype, {1}, const_true(), ret);
+    return AttrStmtNode::make(lo_buf, attr::storage_scope, StringImmNode::make("local"), ret);
+  }
+
+  std::vector<Search> pending_;
+};
+
+Stmt LowerFusedMapSearch(Stmt stmt) { return FusedMapSearchLowerer().Lower(std::move(stmt)); }
+
+}  // namespace tir
+}  // namespace tvm
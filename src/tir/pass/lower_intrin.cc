@@ -53,6 +53,11 @@ class IntrinInjecter : public tvm::arith::IRMutatorWithAnalyzer {
   }
 
   PrimExpr VisitExpr_(const CallNode* op) final {
+    if (fast_math_ && op->call_type == CallNode::PureIntrinsic && op->args.size() == 1 &&
+        op->dtype.element_of() == DataType::Float(32)) {
+      PrimExpr r = MakeFastMath(op);
+      if (r.defined()) return this->VisitExpr(r);
+    }
     if (op->call_type == CallNode::Intrinsic || op->call_type == CallNode::PureIntrinsic) {
       PrimExpr r = ApplyPattern(op->name, GetRef<PrimExpr>(op));
       if (r.defined()) return r;
@@ -225,6 +230,14 @@ class IntrinInjecter : public tvm::arith::IRMutatorWithAnalyzer {
         analyzer_->RemoveLastConstraintScoped();
       }
       return ret;
+    } else if (op->attr_key == "pragma_fast_math") {
+      // The attribute is kept, as the LLVM backends also set the fast
+      // math flags of the arithmetic in the region from it.
+      bool fast_math = !is_zero(op->value);
+      std::swap(fast_math, fast_math_);
+      Stmt ret = IRMutatorWithAnalyzer::VisitStmt_(op);
+      std::swap(fast_math, fast_math_);
+      return ret;
     } else {
       return IRMutatorWithAnalyzer::VisitStmt_(op);
     }
@@ -281,6 +294,59 @@ class IntrinInjecter : public tvm::arith::IRMutatorWithAnalyzer {
     return IRMutatorWithAnalyzer::VisitExpr_(op);
   }
 
+  // Approximate exp, tanh and erf of float32 by polynomials, which
+  // run on the FMA units instead of the special function units of
+  // GPUs, and are vectorized on CPUs instead of calling into libm.
+  PrimExpr MakeFastMath(const CallNode* op) {
+    DataType t = op->dtype;
+    Var x(op->name + "_x", t);
+    PrimExpr body;
+    if (op->name == "exp") {
+      // exp(x) = 2^n * exp(f), for n = floor(x * log2(e) + 1/2) and
+      // f = x - n * ln(2), with exp(f) approximated by a polynomial.
+      PrimExpr xc = max(min(x, make_const(t, 88.3762626647950)), make_const(t, -88.3762626647949));
+      PrimExpr n = floor(xc * make_const(t, 1.44269504088896341) + make_const(t, 0.5));
+      PrimExpr f = xc - n * make_const(t, 0.6931471805599453);
+      const double p[] = {1.9875691500E-4, 1.3981999507E-3, 8.3334519073E-3,
+                          4.1665795894E-2, 1.6666665459E-1, 5.0000001201E-1};
+      PrimExpr y = make_const(t, p[0]);
+      for (int i = 1; i < 6; ++i) y = y * f + make_const(t, p[i]);
+      y = y * f * f + f + make_const(t, 1.0);
+      DataType it = DataType::Int(32, t.lanes());
+      PrimExpr two_n = reinterpret(t, cast(it, n + make_const(t, 127.0)) << make_const(it, 23));
+      body = max(two_n * y, x);
+    } else if (op->name == "tanh") {
+      // Rational approximation from Eigen, as in topi.fast_tanh.
+      PrimExpr xc = max(min(x, make_const(t, 9.0)), make_const(t, -9.0));
+      const double alpha[] = {-2.76076847742355e-16, 2.00018790482477e-13, -8.60467152213735e-11,
+                              5.12229709037114e-08,  1.48572235717979e-05, 6.37261928875436e-04,
+                              4.89352455891786e-03};
+      const double beta[] = {1.19825839466702e-06, 1.18534705686654e-04, 2.26843463243900e-03,
+                             4.89352518554385e-03};
+      body = xc * Horner(xc * xc, alpha, 7, t) / Horner(xc * xc, beta, 4, t);
+    } else if (op->name == "erf") {
+      // Rational approximation from Eigen.
+      PrimExpr xc = max(min(x, make_const(t, 4.0)), make_const(t, -4.0));
+      const double alpha[] = {-2.72614225801306e-10, 2.77068142495902e-08, -2.10102402082508e-06,
+                              -5.69250639462346e-05, -7.34990630326855e-04, -2.95459980854025e-03,
+                              -1.60960333262415e-02};
+      const double beta[] = {-1.45660718464996e-05, -2.13374055278905e-04, -1.68282697438203e-03,
+                             -7.37332916720468e-03, -1.42647390514189e-02};
+      body = xc * Horner(xc * xc, alpha, 7, t) / Horner(xc * xc, beta, 5, t);
+    } else {
+      return PrimExpr();
+    }
+    return LetNode::make(x, op->args[0], body);
+  }
+
+  // Evaluate the polynomial with the coefficients c, highest degree
+  // first, at x.
+  static PrimExpr Horner(PrimExpr x, const double* c, int n, DataType t) {
+    PrimExpr ret = make_const(t, c[0]);
+    for (int i = 1; i < n; ++i) ret = ret * x + make_const(t, c[i]);
+    return ret;
+  }
+
   PrimExpr ApplyPattern(const std::string& name, const PrimExpr& e) {
     bool print = false;//name == "exp";
     if (print) std::cout << "[LI] Patterning " << name << " " << e << std::endl;
@@ -309,6 +375,8 @@ class IntrinInjecter : public tvm::arith::IRMutatorWithAnalyzer {
   std::vector<std::string> patterns_;
   const PackedFunc* fma_{nullptr};
   bool support_bitwise_op_{true};
+  // Whether the region being visited is under pragma_fast_math
+  bool fast_math_{false};
 };
 
 Stmt LowerIntrinStmt(Stmt stmt, const std::string& target) {
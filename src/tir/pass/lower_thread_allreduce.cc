@@ -135,8 +135,11 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
 
   std::pair<bool, int> is_warp_reduction(const std::vector<DataType>& types,
                                          std::unordered_set<const VarNode*>& reduce_threads) const {
-    // Only cuda target supports warp reductions.
-    if ((target_ != "cuda")) return std::make_pair(false, -1);
+    // Only cuda, and opencl through sub-group shuffles, support warp
+    // reductions.
+    if (target_ != "cuda" && (target_ != "opencl" || warp_size_ <= 1)) {
+      return std::make_pair(false, -1);
+    }
 
     // Warp reduction supported only on threadIdx.x
     bool other_threads = false;
@@ -152,7 +155,10 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
 
     // Supported types:
     // {u}int, {u}long, {u}long long, float, double, half/half2
-    if (std::any_of(types.begin(), types.end(), [](DataType ty) {
+    // Sub-group shuffles are only portable for scalars.
+    bool scalars_only = target_ == "opencl";
+    if (std::any_of(types.begin(), types.end(), [scalars_only](DataType ty) {
+          if (scalars_only && ty.is_vector()) return true;
           if (ty.is_float16()) return ty.lanes() > 2;
           if (ty.is_vector()) return true;
           return ty.bytes() < 4 || ty.bytes() > 8;
@@ -330,10 +336,32 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
         local_masks.push_back(stmt);
       }
 
+      // Steps of the tree may only be skipped if every lane of the warp
+      // skips them, i.e. if each warp holds a single row or all rows
+      // in the block have the same length.
+      PrimExpr row_bound = RaggedRowBound(
+          cond, vred, reduce_extent == warp_size_ ? reduce_set : AllThreadVars());
+      // With several short rows per warp, the row length differs across
+      // the lanes of the warp. Each row then only takes the steps within
+      // its length, and the shuffles of a step are masked to the lanes
+      // that take it.
+      PrimExpr group_row_bound;
+      Var step_mask_var;
+      if (!row_bound.defined() && target_ == "cuda") {
+        group_row_bound = RaggedRowBound(cond, vred, reduce_set);
+      }
+      if (group_row_bound.defined()) {
+        step_mask_var = Var("step_mask" + std::to_string(global_red_idx_), DataType::UInt(32));
+        auto stmt = AllocateNode::make(step_mask_var, step_mask_var->dtype, {PrimExpr(1)},
+                                       const_true(1), EvaluateNode::make(0));
+        local_masks.push_back(stmt);
+      }
+
       // Emit reductions within a warp.
       for (int offset = p.second / 2; offset > 0; offset /= 2) {
         // Load reduction values, no synchronization needed.
 
+        std::vector<Stmt> step_seq;
         Array<PrimExpr> a, b;
 
         for (size_t i = 0; i < size; ++i) {
@@ -355,9 +383,10 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
           // branch with a warp sync call inside.
           //
           PrimExpr shuffle =
-              WarpShuffle(tir::intrinsic::tvm_warp_shuffle_down, mask_var, val, offset);
-          seq.push_back(StoreNode::make(temp_vars[i], shuffle, IntImm(DataType::Int(32), 0),
-                                        const_true(1), tir::kAll));
+              WarpShuffle(tir::intrinsic::tvm_warp_shuffle_down,
+                          group_row_bound.defined() ? step_mask_var : mask_var, val, offset);
+          step_seq.push_back(StoreNode::make(temp_vars[i], shuffle, IntImm(DataType::Int(32), 0),
+                                             const_true(1), tir::kAll));
           a.push_back(val);
           b.push_back(LoadNode::make(types[i], temp_vars[i], IntImm(DataType::Int(32), 0),
                                      const_true(1), tir::kAll));
@@ -369,7 +398,21 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
           PrimExpr pred = const_true(types[i].lanes());
           const AllocateNode* repl = local_vars[i].as<AllocateNode>();
           Stmt s = StoreNode::make(repl->buffer_var, ret[i], index, pred, tir::kAll);
-          seq.push_back(s);
+          step_seq.push_back(s);
+        }
+        if (group_row_bound.defined()) {
+          // The ballot is taken by all lanes, outside of the divergent
+          // branch of the step.
+          PrimExpr take_step = make_const(group_row_bound.dtype(), offset) < group_row_bound;
+          PrimExpr step_mask = CallNode::make(
+              DataType::UInt(32), tir::intrinsic::tvm_warp_ballot,
+              {LoadNode::make(DataType::UInt(32), mask_var, index, const_true(1), tir::kAll),
+               take_step},
+              tir::CallNode::Intrinsic);
+          seq.push_back(StoreNode::make(step_mask_var, step_mask, index, const_true(1), tir::kAll));
+          seq.push_back(IfThenElseNode::make(take_step, SeqStmt::Flatten(step_seq)));
+        } else {
+          seq.push_back(GuardReductionStep(SeqStmt::Flatten(step_seq), offset, row_bound));
         }
 
         // // Do reductions.
@@ -394,7 +437,8 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
         Var var = repl->buffer_var;
         PrimExpr pred = const_true(types[i].lanes());
         PrimExpr val = LoadNode::make(types[i], var, index, pred, tir::kAll);
-        PrimExpr lane_id = indexdiv(indexmod(get_reduction_group_id(), 32), p.second) * p.second;
+        PrimExpr lane_id =
+            indexdiv(indexmod(get_reduction_group_id(), warp_size_), p.second) * p.second;
         PrimExpr splat = WarpShuffle(tir::intrinsic::tvm_warp_shuffle, mask_var, val, lane_id);
         seq.push_back(StoreNode::make(var, splat, index, pred, tir::kAll));
       }
@@ -440,8 +484,12 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
                                          tir::kAll));
       }
       seq.emplace_back(SyncThread("shared"));
+      // The steps of the tree are separated by block-wide barriers, so
+      // they may only be skipped if the row length is the same for all
+      // threads of the block.
+      PrimExpr row_bound = RaggedRowBound(cond, vred, AllThreadVars());
       seq.emplace_back(MakeBufAllreduce(combiner, types, shared_bufs, reduce_index, group_index,
-                                        reduce_extent, threadx_extent));
+                                        reduce_extent, threadx_extent, row_bound));
       for (size_t idx = 0; idx < size; ++idx) {
         CHECK(!load_remap_.count(buffers[idx])) << " " << buffers[idx]->name_hint;
         PrimExpr pred = const_true(types[idx].lanes());
@@ -470,7 +518,7 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
   // make allreduce.
   Stmt MakeBufAllreduce(const CommReducerNode* combiner, const std::vector<DataType>& types,
                         const Array<Var>& shared_bufs, PrimExpr reduce_index, PrimExpr group_index,
-                        int reduce_extent, int threadx_extent) {
+                        int reduce_extent, int threadx_extent, PrimExpr row_bound) {
     // Get next power of two
     int reduce_align = 1;
     while (reduce_extent > reduce_align) {
@@ -502,23 +550,25 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
       // reduction with the boundary condition
       reduce_align = reduce_align >> 1;
       PrimExpr cond = reduce_index < (reduce_extent - reduce_align);
-      seq.emplace_back(IfThenElseNode::make(cond, freduce(reduce_align)));
-      seq.emplace_back(SyncThread("shared"));
+      seq.emplace_back(GuardReductionStep(
+          SeqStmt::Flatten(IfThenElseNode::make(cond, freduce(reduce_align)), SyncThread("shared")),
+          reduce_align, row_bound));
     }
     CHECK(threadx_extent >= 1 && warp_size_ >= 1);
     // normal synchronization
     while (reduce_align > threadx_extent || reduce_align > warp_size_) {
       reduce_align = reduce_align >> 1;
       PrimExpr cond = reduce_index < reduce_align;
-      seq.emplace_back(IfThenElseNode::make(cond, freduce(reduce_align)));
-      seq.emplace_back(SyncThread("shared"));
+      seq.emplace_back(GuardReductionStep(
+          SeqStmt::Flatten(IfThenElseNode::make(cond, freduce(reduce_align)), SyncThread("shared")),
+          reduce_align, row_bound));
     }
     // in warp synchronization.
     std::vector<Stmt> in_warp_seq;
     PrimExpr in_warp_cond = reduce_index < (reduce_align >> 1);
     while (reduce_align > 1) {
       reduce_align = reduce_align >> 1;
-      in_warp_seq.emplace_back(freduce(reduce_align));
+      in_warp_seq.emplace_back(GuardReductionStep(freduce(reduce_align), reduce_align, row_bound));
       seq.emplace_back(SyncThread("warp"));
     }
     if (in_warp_seq.size() != 0) {
@@ -528,6 +578,49 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
     }
     return SeqStmt::Flatten(seq);
   }
+  // A reduction along a ragged dimension bound to threadIdx.x is
+  // predicated on threadIdx.x < len, where len is the row length given
+  // by the dimension's l_fun, while the thread extent is the padded
+  // maximum length. Threads at or beyond len only contribute the
+  // identity element, so a step of the reduction tree combining values
+  // at an offset >= len does not change the result of the first
+  // thread, from which the result is read. Returns len if cond is of
+  // this form and len does not depend on any of nonuniform_vars, and
+  // an undefined expression otherwise.
+  static PrimExpr RaggedRowBound(PrimExpr cond, const std::vector<ThreadEntry>& vred,
+                                 const std::unordered_set<const VarNode*>& nonuniform_vars) {
+    if (vred.size() != 1 || vred[0].scope.dim_index != 0) return PrimExpr();
+    const VarNode* reduce_var = vred[0].iv->var.get();
+    if (auto call = cond.as<CallNode>()) {
+      if (call->is_intrinsic(CallNode::likely)) cond = call->args[0];
+    }
+    PrimExpr bound;
+    if (auto op = cond.as<AndNode>()) {
+      bound = RaggedRowBound(op->a, vred, nonuniform_vars);
+      if (!bound.defined()) bound = RaggedRowBound(op->b, vred, nonuniform_vars);
+      return bound;
+    } else if (auto op = cond.as<LTNode>()) {
+      if (op->a.get() == reduce_var) bound = op->b;
+    } else if (auto op = cond.as<GTNode>()) {
+      if (op->b.get() == reduce_var) bound = op->a;
+    }
+    if (!bound.defined() || ExprUseVar(bound, nonuniform_vars)) return PrimExpr();
+    return bound;
+  }
+  // Guard a step of a reduction tree combining values at the given
+  // offset by the row length, if known.
+  static Stmt GuardReductionStep(Stmt step, int offset, PrimExpr row_bound) {
+    if (!row_bound.defined()) return step;
+    return IfThenElseNode::make(make_const(row_bound.dtype(), offset) < row_bound, step);
+  }
+  // The variables of all surrounding thread indices.
+  std::unordered_set<const VarNode*> AllThreadVars() const {
+    std::unordered_set<const VarNode*> vars;
+    for (const AttrStmtNode* attr : thread_extents_) {
+      vars.insert(Downcast<IterVar>(attr->node)->var.get());
+    }
+    return vars;
+  }
   // Flatten the thread index.
   // Also return a warp number,
   PrimExpr FlattenThread(const std::vector<ThreadEntry>& tvec, int* out_total_extent) {
@@ -360,8 +360,10 @@ class BuiltinLower : public StmtExprMutator {
   }
 
   PrimExpr MakeMemcpy(const CallNode* op) {
+    // Copies in the prep code only feed kernels launched afterwards,
+    // so they need not block the host.
     return CallNode::make(
-        op->dtype, "TVMBackendCopyMemory",
+        op->dtype, in_prep_code_ ? "TVMBackendCopyMemoryAsync" : "TVMBackendCopyMemory",
         {op->args[0], cast(DataType::UInt(32), op->args[1]), op->args[2],
          cast(DataType::UInt(32), op->args[3]), cast(DataType::UInt(32), op->args[4]),
          cast(DataType::UInt(32), op->args[5]), cast(DataType::UInt(32), op->args[6]),
@@ -67,6 +67,14 @@ namespace tir {
 //   store warp_mem[m * y + x]
 //   warp_shuffle(load warp_mem[m * y + x], z)
 //   subject to (m * y + x) is invariant to warp_index
+//
+// z need not be affine in warp_index. A lane can read a neighbor at a
+// data dependent offset, such as warp_index + offset[row], as when the
+// halos of a sliding window over a ragged row are exchanged. As all
+// lanes of the warp have to execute a shuffle, loads under the
+// conditions of if_then_else or select, such as the bounds checks of
+// the row, are shuffled before the enclosing statement, with the
+// condition guarding the source lane and the local index instead.
 
 // Algorithm
 //
@@ -207,13 +215,43 @@ class WarpAccessRewriter : protected StmtExprMutator {
     if (op->buffer_var.get() == buffer_) {
       PrimExpr local_index, group;
       std::tie(local_index, group) = SplitIndexByGroup(op->index);
-      return StoreNode::make(op->buffer_var, op->value, local_index, op->predicate, op->sync_type);
+      return StoreNode::make(op->buffer_var, this->VisitExpr(op->value), local_index,
+                             op->predicate, op->sync_type);
     } else {
       return StmtExprMutator::VisitStmt_(op);
     }
   }
 
-  PrimExpr Mutate_(const LoadNode* op) {
+  Stmt VisitStmt(const Stmt& stmt) final {
+    std::vector<std::pair<Var, PrimExpr>> outer_shuffles;
+    std::swap(outer_shuffles, hoisted_shuffles_);
+    Stmt ret = StmtExprMutator::VisitStmt(stmt);
+    for (auto it = hoisted_shuffles_.rbegin(); it != hoisted_shuffles_.rend(); ++it) {
+      ret = LetStmtNode::make(it->first, it->second, ret);
+    }
+    hoisted_shuffles_ = std::move(outer_shuffles);
+    return ret;
+  }
+
+  PrimExpr VisitExpr_(const CallNode* op) final {
+    if (op->is_intrinsic(intrinsic::tvm_if_then_else)) {
+      PrimExpr cond = this->VisitExpr(op->args[0]);
+      PrimExpr then_case = VisitGuarded(cond, op->args[1]);
+      PrimExpr else_case = VisitGuarded(NotNode::make(cond), op->args[2]);
+      return CallNode::make(op->dtype, op->name, {cond, then_case, else_case}, op->call_type,
+                            op->arg_dims, op->func, op->value_index, op->custom_realize_bounds);
+    }
+    return StmtExprMutator::VisitExpr_(op);
+  }
+
+  PrimExpr VisitExpr_(const SelectNode* op) final {
+    PrimExpr cond = this->VisitExpr(op->condition);
+    PrimExpr true_value = VisitGuarded(cond, op->true_value);
+    PrimExpr false_value = VisitGuarded(NotNode::make(cond), op->false_value);
+    return SelectNode::make(cond, true_value, false_value);
+  }
+
+  PrimExpr VisitExpr_(const LoadNode* op) final {
     if (op->buffer_var.get() == buffer_) {
       PrimExpr local_index, group;
       std::tie(local_index, group) = SplitIndexByGroup(op->index);
@@ -221,14 +259,36 @@ class WarpAccessRewriter : protected StmtExprMutator {
       CHECK(!ExprUseVar(local_index, {warp_index_.get()}))
           << "LowerWarpMemory failed to rewrite load to shuffle for index " << op->index
           << " local_index=" << local_index;
+      bool hoist = guard_.defined() && op->dtype.lanes() == 1;
+      if (hoist) {
+        // Read a lane's own value when the load is not taken.
+        local_index = if_then_else(guard_, local_index, make_zero(local_index.dtype()));
+        group = if_then_else(guard_, group, cast(group.dtype(), warp_index_));
+      }
       PrimExpr load_value =
           LoadNode::make(op->dtype, op->buffer_var, local_index, op->predicate, op->sync_type);
-      return CallNode::make(load_value.dtype(), intrinsic::tvm_warp_shuffle, {load_value, group},
-                            CallNode::Intrinsic);
+      PrimExpr mask = make_const(DataType::UInt(32), warp_size_ >= 32
+                                                         ? 0xFFFFFFFFU
+                                                         : (1U << warp_size_) - 1);
+      PrimExpr shuffle = CallNode::make(load_value.dtype(), intrinsic::tvm_warp_shuffle,
+                                        {mask, load_value, group}, CallNode::Intrinsic);
+      if (!hoist) return shuffle;
+      Var value(op->buffer_var->name_hint + ".shfl", op->dtype);
+      hoisted_shuffles_.push_back({value, shuffle});
+      return value;
     } else {
       return StmtExprMutator::VisitExpr_(op);
     }
   }
+
+  // Visit an expression that is only evaluated under cond.
+  PrimExpr VisitGuarded(const PrimExpr& cond, const PrimExpr& e) {
+    PrimExpr outer_guard = guard_;
+    guard_ = guard_.defined() ? AndNode::make(guard_, cond) : cond;
+    PrimExpr ret = this->VisitExpr(e);
+    guard_ = outer_guard;
+    return ret;
+  }
   // Split the index to the two component
   // <local_index, source_index>
   // local index is the index in the local
@@ -273,6 +333,11 @@ class WarpAccessRewriter : protected StmtExprMutator {
   int warp_group_{0};
   // Internal analyzer
   arith::Analyzer* analyzer_;
+  // The conditions the expression being visited is evaluated under
+  PrimExpr guard_;
+  // The shuffles hoisted out of the conditions of the statement being
+  // visited, to be let bound before it
+  std::vector<std::pair<Var, PrimExpr>> hoisted_shuffles_;
 };
 
 // Bind bound information of variables to make analyzer more effective
@@ -21,6 +21,7 @@
  * \file make_api.cc Build API function.
  */
 #include <tvm/runtime/device_api.h>
+#include <tvm/runtime/module.h>
 #include <tvm/tir/buffer.h>
 #include <tvm/tir/expr.h>
 #include <tvm/tir/ir_pass.h>
@@ -38,11 +39,13 @@ namespace tvm {
 namespace tir {
 
 MakeAPIResult MakeAPIResultNode::make(LoweredFunc function, Array<Buffer> host_intermediate_buffers,
-                                      Array<Buffer> device_intermediate_buffers) {
+                                      Array<Buffer> device_intermediate_buffers,
+                                      Array<Buffer> aux_buffer_layout) {
   auto n = make_object<MakeAPIResultNode>();
   n->function = std::move(function);
   n->host_intermediate_buffers = std::move(host_intermediate_buffers);
   n->device_intermediate_buffers = std::move(device_intermediate_buffers);
+  n->aux_buffer_layout = std::move(aux_buffer_layout);
   return MakeAPIResult(n);
 }
 
@@ -260,9 +263,112 @@ class CopyStatementsRewriter : public StmtExprMutator {
   const Var& device_id_;
 };
 
+// Guard the prep code with a lookup into the runtime prep code
+// cache, so that it is skipped when the auxiliary buffers already
+// hold its results for the lengths passed in this call.
+Stmt GuardPrepCodeWithCache(Stmt prep_code, std::string name, Array<ObjectRef> lengths_api_args,
+                            Array<Buffer> aux_buffers) {
+  auto prep_attr = prep_code.as<AttrStmtNode>();
+  CHECK(prep_attr);
+  Array<PrimExpr> args;
+  args.push_back(StringImmNode::make(runtime::symbol::tvm_prep_code_cache_lookup));
+  args.push_back(StringImmNode::make(name));
+  args.push_back(static_cast<int>(aux_buffers.size()));
+  for (auto buf : aux_buffers) {
+    args.push_back(buf->data);
+  }
+  for (auto arg : lengths_api_args) {
+    if (auto buf_node = arg.as<BufferNode>()) {
+      PrimExpr extent = 1;
+      for (auto dim_length : buf_node->shape->get_dense_shape()) {
+        extent = extent * dim_length;
+      }
+      args.push_back(buf_node->data);
+      args.push_back(cast(DataType::Int(64), extent * buf_node->dtype.bytes()));
+    } else if (auto var_node = arg.as<VarNode>()) {
+      CHECK(var_node->dtype.is_int() || var_node->dtype.is_uint())
+          << "Prep code can only be cached on integer length arguments";
+      args.push_back(cast(DataType::Int(64), GetRef<Var>(var_node)));
+    }
+  }
+  PrimExpr hit =
+      CallNode::make(DataType::Int(32), intrinsic::tvm_call_packed, args, CallNode::Intrinsic);
+  return AttrStmtNode::make(prep_attr->node, prep_attr->attr_key, prep_attr->value,
+                            IfThenElseNode::make(hit == 0, prep_attr->body),
+                            prep_attr->hfuse_group_id);
+}
+
+// Bracket the prep code with calls into the runtime prep code
+// profiler, which records the time spent in it along with the number
+// of auxiliary arrays and bytes it copies to the device.
+Stmt InstrumentPrepCode(Stmt prep_code, std::string name, int num_aux_arrays) {
+  auto prep_attr = prep_code.as<AttrStmtNode>();
+  CHECK(prep_attr);
+  PrimExpr copied_bytes = make_const(DataType::Int(64), 0);
+  PostOrderVisit(prep_attr->body, [&copied_bytes](const ObjectRef& node) {
+    if (auto call = node.as<CallNode>()) {
+      if (call->is_intrinsic(intrinsic::tvm_memcopy_to_device)) {
+        copied_bytes = copied_bytes + cast(DataType::Int(64), call->args[4]);
+      }
+    }
+  });
+  Stmt begin = EvaluateNode::make(CallNode::make(
+      DataType::Int(32), intrinsic::tvm_call_packed,
+      {StringImmNode::make(runtime::symbol::tvm_prep_code_profile_begin), StringImmNode::make(name)},
+      CallNode::Intrinsic));
+  Stmt end = EvaluateNode::make(CallNode::make(
+      DataType::Int(32), intrinsic::tvm_call_packed,
+      {StringImmNode::make(runtime::symbol::tvm_prep_code_profile_end), StringImmNode::make(name),
+       num_aux_arrays, Simplify(copied_bytes)},
+      CallNode::Intrinsic));
+  return AttrStmtNode::make(prep_attr->node, prep_attr->attr_key, prep_attr->value,
+                            SeqStmt({begin, prep_attr->body, end}), prep_attr->hfuse_group_id);
+}
+
+// Remove the aux_buffer_layout annotation from the prep code,
+// returning the layout it records.
+Stmt StripAuxBufferLayout(Stmt prep_code, Array<Buffer>* p_layout) {
+  class Stripper : public StmtMutator {
+   public:
+    explicit Stripper(Array<Buffer>* p_layout) : p_layout_(p_layout) {}
+
+    Stmt VisitStmt_(const AttrStmtNode* op) final {
+      if (op->attr_key == attr::aux_buffer_layout) {
+        p_layout_->push_back_all(Downcast<Array<Buffer>>(op->node));
+        return this->VisitStmt(op->body);
+      }
+      return StmtMutator::VisitStmt_(op);
+    }
+
+   private:
+    Array<Buffer>* p_layout_;
+  };
+  return Stripper(p_layout)(prep_code);
+}
+
+// Whether the prep code was generated to run as kernels on the device,
+// in which case the length buffers it reads need to be on the device
+// before it runs.
+bool IsDevicePrepCode(Stmt prep_code_body) {
+  bool found = false;
+  PostOrderVisit(prep_code_body, [&found](const ObjectRef& node) {
+    if (auto attr = node.as<AttrStmtNode>()) {
+      found |= (attr->attr_key == attr::thread_extent);
+    }
+  });
+  return found;
+}
+
+// Whether a statement writes to memory.
+bool HasStores(Stmt stmt) {
+  bool found = false;
+  PostOrderVisit(stmt, [&found](const ObjectRef& node) { found |= node->IsInstance<StoreNode>(); });
+  return found;
+}
+
 MakeAPIResult MakeAPI(Stmt body, std::string name, Array<ObjectRef> lengths_api_args,
                       Array<ObjectRef> tensor_api_args, int num_unpacked_args, bool is_restricted,
-                      PrepCodeMode prep_code_mode) {
+                      PrepCodeMode prep_code_mode, bool instrument_prep_code) {
   Var device_type("dev_type"), device_id("dev_id");
   std::unordered_map<const VarNode*, PrimExpr> vmap;
   ArgBinder binder(&vmap);
@@ -277,6 +383,8 @@ MakeAPIResult MakeAPI(Stmt body, std::string name, Array<ObjectRef> lengths_api_
     Stmt prep_code;
     Stmt main_body;
     Map<Buffer, Buffer> prep_buffer_map = ExtractPrepCode(body, &prep_code, &main_body);
+    Array<Buffer> aux_buffer_layout;
+    prep_code = StripAuxBufferLayout(prep_code, &aux_buffer_layout);
     Array<Buffer> host_intermediate_api_args;
     Array<Buffer> device_intermediate_api_args;
     if (prep_buffer_map.defined()) {
@@ -286,19 +394,33 @@ MakeAPIResult MakeAPI(Stmt body, std::string name, Array<ObjectRef> lengths_api_
       }
     }
 
+    // In the fused mode, the length buffers are passed in on the
+    // device and read only there, so nothing is copied or looked at
+    // on the host between the prep code and main kernels.
+    bool fused_prep_code = prep_code_mode == tvm::tir::PrepCodeMode::kFusedPrepCode;
+
     // Add copy statements for length api args that are also used in
-    // main body
+    // main body, or in the prep code if it runs on the device
     {
       // std::cout << "[VR] Replacing Main Body" << std::endl;
       auto prep_attr = prep_code.as<AttrStmtNode>();
       CHECK(prep_attr);
+      bool device_prep_code = IsDevicePrepCode(prep_attr->body);
+      CHECK(!fused_prep_code || device_prep_code || !HasStores(prep_attr->body))
+          << "The fused_prep_code mode needs the prep code to be generated on the device. "
+          << "Set prep_code_on_device in the build config.";
       auto body_vars = VarCollector(true).collect(main_body);
+      if (device_prep_code) {
+        for (auto var : VarCollector(true).collect(prep_attr->body)) {
+          body_vars.insert(var);
+        }
+      }
       Map<Buffer, Buffer> to_copy_l_buffer_map;
       std::unordered_map<const VarNode*, PrimExpr> vsub;
       for (auto arg : lengths_api_args) {
         // std::cout << "[M_API] Length Arg " << arg << std::endl;
         if (auto buf_node = arg.as<BufferNode>()) {
-          if (body_vars.count(buf_node->data.get())) {
+          if (!fused_prep_code && body_vars.count(buf_node->data.get())) {
             // std::cout << "[M_API]  Used in body" << std::endl;
             auto host_buf = Downcast<Buffer>(arg);
             auto dev_buf = BufferNode::make(
@@ -313,9 +435,12 @@ MakeAPIResult MakeAPI(Stmt body, std::string name, Array<ObjectRef> lengths_api_
         }
       }
 
-      // Add copy statements at the end of the prep_code
+      // Add copy statements at the end of the prep_code, or at the
+      // start if the prep code itself runs on the device
       Array<Stmt> l_copy_stmts;
-      l_copy_stmts.push_back(prep_attr->body);
+      if (!device_prep_code) {
+        l_copy_stmts.push_back(prep_attr->body);
+      }
       // Add aux_data_structure annotation for l_tensors
       std::vector<Stmt> aux_data_structure_annotations;
       auto noop = EvaluateNode::make(0);
@@ -333,6 +458,10 @@ MakeAPIResult MakeAPI(Stmt body, std::string name, Array<ObjectRef> lengths_api_
             AttrStmtNode::make(it.second->data, attr::aux_data_structure, 0, noop));
       }
 
+      if (device_prep_code) {
+        l_copy_stmts.push_back(VarReplacer(vsub, true)(prep_attr->body));
+      }
+
       // Replace the buffers in the main_body
       main_body = VarReplacer(vsub, true)(main_body);
       main_body = MergeNest(aux_data_structure_annotations, main_body);
@@ -342,6 +471,16 @@ MakeAPIResult MakeAPI(Stmt body, std::string name, Array<ObjectRef> lengths_api_
 
     // Construct/rewrite prep_code
     prep_code = CopyStatementsRewriter(device_type, device_id)(prep_code);
+    if (instrument_prep_code) {
+      CHECK(!fused_prep_code) << "Instrumenting the prep code synchronizes with the device, "
+                              << "and is not supported in the fused_prep_code mode";
+      prep_code = InstrumentPrepCode(prep_code, name, aux_buffer_layout.size());
+    }
+    if (prep_code_mode == tvm::tir::PrepCodeMode::kWithCachedPrepCode &&
+        device_intermediate_api_args.size() > 0) {
+      prep_code =
+          GuardPrepCodeWithCache(prep_code, name, lengths_api_args, device_intermediate_api_args);
+    }
 
     Array<ObjectRef> full_api_args;
     std::unordered_set<const Object*> cpu_args;
@@ -355,22 +494,28 @@ MakeAPIResult MakeAPI(Stmt body, std::string name, Array<ObjectRef> lengths_api_
       full_api_args.push_back(buf);
     }
 
-    for (auto obj : lengths_api_args) {
-      cpu_args.insert(obj.get());
+    if (!fused_prep_code) {
+      for (auto obj : lengths_api_args) {
+        cpu_args.insert(obj.get());
+      }
     }
 
     Stmt body;
     if (prep_code_mode == tvm::tir::PrepCodeMode::kOnlyPrepCode) {
       body = prep_code;
+    } else if (prep_code_mode == tvm::tir::PrepCodeMode::kExternalPrepCode) {
+      body = main_body;
     } else {
-      CHECK(prep_code_mode == tvm::tir::PrepCodeMode::kWithPrepCode);
+      CHECK(prep_code_mode == tvm::tir::PrepCodeMode::kWithPrepCode ||
+            prep_code_mode == tvm::tir::PrepCodeMode::kWithCachedPrepCode ||
+            prep_code_mode == tvm::tir::PrepCodeMode::kFusedPrepCode);
       body = SeqStmt({prep_code, main_body});
     }
     LoweredFunc full_func = MakeAPIInternal(UninterpFun::InlineUninterpFunCalls(body), name,
                                             full_api_args, num_unpacked_args, is_restricted,
                                             cpu_args, &vmap, &binder, &device_type, &device_id);
     return MakeAPIResultNode::make(full_func, host_intermediate_api_args,
-                                   device_intermediate_api_args);
+                                   device_intermediate_api_args, aux_buffer_layout);
   }
 }
 
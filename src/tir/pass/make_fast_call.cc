@@ -0,0 +1,121 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file make_fast_call.cc
+ * \brief Build fast call entries that take kernel arguments unboxed.
+ */
+#include <tvm/runtime/module.h>
+#include <tvm/tir/expr.h>
+#include <tvm/tir/ir_pass.h>
+#include <tvm/tir/stmt_functor.h>
+
+#include <map>
+#include <unordered_set>
+
+namespace tvm {
+namespace tir {
+
+// Strips the unpacking of the TVMValue arguments of a host function
+// made by MakeAPI, recording the variables the arguments were loaded
+// into, which become the parameters of the fast call entry.
+class PackedArgsStripper : public StmtExprMutator {
+ public:
+  PackedArgsStripper(const std::string& fast_name, Var packed_args, Var type_ids, Var num_args)
+      : fast_name_(fast_name), packed_args_(packed_args), type_ids_(type_ids),
+        num_args_(num_args) {}
+
+  Stmt VisitStmt_(const LetStmtNode* op) final {
+    PrimExpr value = op->value;
+    if (auto cast = value.as<CastNode>()) value = cast->value;
+    if (auto call = value.as<CallNode>()) {
+      if (call->is_intrinsic(intrinsic::tvm_struct_get) && call->args[0].same_as(packed_args_)) {
+        CHECK_EQ(call->args[2].as<IntImmNode>()->value, intrinsic::kTVMValueContent);
+        int index = static_cast<int>(call->args[1].as<IntImmNode>()->value);
+        CHECK(!params.count(index)) << "Argument " << index << " is unpacked twice";
+        params[index] = op->var;
+        return this->VisitStmt(op->body);
+      }
+    }
+    if (auto load = value.as<LoadNode>()) {
+      if (load->buffer_var.same_as(type_ids_)) {
+        type_codes_.insert(op->var.get());
+        return this->VisitStmt(op->body);
+      }
+    }
+    return StmtExprMutator::VisitStmt_(op);
+  }
+
+  Stmt VisitStmt_(const AssertStmtNode* op) final {
+    // The checks of the number and the type codes of the arguments.
+    bool packed_check = false;
+    PostOrderVisit(op->condition, [&](const ObjectRef& node) {
+      if (auto var = node.as<VarNode>()) {
+        packed_check |= var == num_args_.get() || type_codes_.count(var);
+      }
+    });
+    if (packed_check) return this->VisitStmt(op->body);
+    return StmtExprMutator::VisitStmt_(op);
+  }
+
+  Stmt VisitStmt_(const AttrStmtNode* op) final {
+    // Keep the name of the compute function of the entry unique.
+    if (op->attr_key == attr::compute_scope) {
+      return AttrStmtNode::make(op->node, op->attr_key,
+                                StringImmNode::make(fast_name_ + "_compute_"),
+                                this->VisitStmt(op->body), op->hfuse_group_id);
+    }
+    return StmtExprMutator::VisitStmt_(op);
+  }
+
+  // The parameters of the entry, by argument index.
+  std::map<int, Var> params;
+
+ private:
+  std::string fast_name_;
+  Var packed_args_;
+  Var type_ids_;
+  Var num_args_;
+  std::unordered_set<const VarNode*> type_codes_;
+};
+
+LoweredFunc MakeFastCall(LoweredFunc func) {
+  CHECK(func->is_packed_func) << func->name << " is not a packed function";
+  CHECK_EQ(func->args.size(), 5U) << "Fast call entries need all arguments of "
+                                  << func->name << " to be packed";
+  auto n = make_object<LoweredFuncNode>(*func.operator->());
+  n->name = func->name + runtime::symbol::tvm_fast_call_suffix;
+  PackedArgsStripper stripper(n->name, func->args[0], func->args[1], func->args[2]);
+  n->body = stripper(func->body);
+  n->args = {};
+  for (const auto& param : stripper.params) {
+    CHECK_EQ(param.first, static_cast<int>(n->args.size()))
+        << "Argument " << n->args.size() << " of " << func->name << " is never unpacked";
+    n->args.push_back(param.second);
+  }
+  n->is_packed_func = false;
+  LoweredFunc f(n);
+  Array<Var> undefined = UndefinedVars(f->body, f->args);
+  CHECK_EQ(undefined.size(), 0U) << "The body of " << func->name
+                                 << " reads its packed arguments beyond unpacking them";
+  return f;
+}
+
+}  // namespace tir
+}  // namespace tvm
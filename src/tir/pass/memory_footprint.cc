@@ -0,0 +1,202 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file memory_footprint.cc
+ * \brief Estimate the peak device memory of ragged kernels.
+ */
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/expr.h>
+#include <tvm/tir/ir_pass.h>
+#include <tvm/tir/stmt_functor.h>
+
+#include <string>
+#include <unordered_map>
+
+namespace tvm {
+namespace tir {
+
+// The peak, over the points of a statement, of the bytes of the global
+// allocations live there. Allocations in kernels are on chip, and
+// those of the prep code and workspaces on the host are not counted.
+class MemoryFootprintEstimator : public StmtFunctor<PrimExpr(const Stmt&)> {
+ public:
+  PrimExpr VisitStmt_(const AttrStmtNode* op) final {
+    if (op->attr_key == attr::storage_scope) {
+      if (auto var = op->node.as<VarNode>()) {
+        scopes_[var] = op->value.as<StringImmNode>()->value;
+      }
+    } else if (op->attr_key == attr::thread_extent || op->attr_key == attr::prep_code_scope) {
+      return Zero();
+    }
+    return this->VisitStmt(op->body);
+  }
+
+  PrimExpr VisitStmt_(const AllocateNode* op) final {
+    auto it = scopes_.find(op->buffer_var.get());
+    PrimExpr body = this->VisitStmt(op->body);
+    if (it != scopes_.end() && it->second != "global") return body;
+    PrimExpr nbytes = make_const(DataType::Int(64), op->dtype.bytes() * op->dtype.lanes());
+    return nbytes * cast(DataType::Int(64), op->GetAllocationSize()) + body;
+  }
+
+  PrimExpr VisitStmt_(const LetStmtNode* op) final {
+    PrimExpr body = this->VisitStmt(op->body);
+    // Allocations already lowered to workspaces
+    auto call = op->value.as<CallNode>();
+    if (call && call->name == "TVMBackendAllocWorkspace") {
+      auto device_type = call->args[0].as<IntImmNode>();
+      if (device_type && device_type->value == kDLCPU) return body;
+      return cast(DataType::Int(64), call->args[2]) + body;
+    }
+    return body;
+  }
+
+  PrimExpr VisitStmt_(const SeqStmtNode* op) final {
+    PrimExpr peak = Zero();
+    for (const Stmt& stmt : op->seq) peak = Max(peak, this->VisitStmt(stmt));
+    return peak;
+  }
+
+  PrimExpr VisitStmt_(const IfThenElseNode* op) final {
+    PrimExpr peak = this->VisitStmt(op->then_case);
+    if (op->else_case.defined()) peak = Max(peak, this->VisitStmt(op->else_case));
+    return peak;
+  }
+
+  PrimExpr VisitStmt_(const ForNode* op) final { return this->VisitStmt(op->body); }
+  PrimExpr VisitStmt_(const AssertStmtNode* op) final { return this->VisitStmt(op->body); }
+  PrimExpr VisitStmt_(const ProducerConsumerNode* op) final { return this->VisitStmt(op->body); }
+  PrimExpr VisitStmt_(const RealizeNode* op) final { return this->VisitStmt(op->body); }
+
+  PrimExpr VisitStmtDefault_(const Object* op) final { return Zero(); }
+
+ private:
+  static PrimExpr Zero() { return make_const(DataType::Int(64), 0); }
+
+  static PrimExpr Max(PrimExpr a, PrimExpr b) {
+    if (is_zero(a)) return b;
+    if (is_zero(b)) return a;
+    return max(a, b);
+  }
+
+  std::unordered_map<const VarNode*, std::string> scopes_;
+};
+
+PrimExpr EstimateMemoryFootprint(Stmt stmt) {
+  return Simplify(MemoryFootprintEstimator()(stmt));
+}
+
+// Replaces the variables and the elements of the arrays an expression
+// reads with their values, by name.
+class FootprintInputBinder : public ExprMutator {
+ public:
+  FootprintInputBinder(const Map<std::string, PrimExpr>& scalars,
+                       const Map<std::string, runtime::NDArray>& arrays)
+      : scalars_(scalars), arrays_(arrays) {}
+
+  PrimExpr VisitExpr_(const VarNode* op) final {
+    auto it = scalars_.find(op->name_hint);
+    if (it != scalars_.end()) return cast(op->dtype, (*it).second);
+    return GetRef<PrimExpr>(op);
+  }
+
+  PrimExpr VisitExpr_(const LoadNode* op) final {
+    PrimExpr index = Simplify(this->VisitExpr(op->index));
+    PrimExpr value = Read(op->buffer_var->name_hint, {index}, op->dtype);
+    if (value.defined()) return value;
+    return LoadNode::make(op->dtype, op->buffer_var, index, op->predicate, op->sync_type);
+  }
+
+  PrimExpr VisitExpr_(const CallNode* op) final {
+    if (op->call_type == CallNode::Halide) {
+      Array<PrimExpr> indices;
+      for (const auto& arg : op->args) indices.push_back(Simplify(this->VisitExpr(arg)));
+      PrimExpr value = Read(op->name, indices, op->dtype);
+      if (value.defined()) return value;
+    }
+    return ExprMutator::VisitExpr_(op);
+  }
+
+  // Sums over a known range, such as those CountWork leaves for the
+  // iterations of ragged loops, are evaluated one term at a time.
+  PrimExpr VisitExpr_(const ReduceNode* op) final {
+    if (op->axis.size() == 1 && op->source.size() == 1 && is_one(op->condition) &&
+        op->combiner->result.size() == 1 && op->combiner->result[0].as<AddNode>()) {
+      IterVar iv = op->axis[0];
+      auto min = Simplify(this->VisitExpr(iv->dom->min)).as<IntImmNode>();
+      auto extent = Simplify(this->VisitExpr(iv->dom->extent)).as<IntImmNode>();
+      if (min && extent) {
+        PrimExpr total = make_zero(op->dtype);
+        for (int64_t i = min->value; i < min->value + extent->value; ++i) {
+          std::unordered_map<const VarNode*, PrimExpr> vmap{
+              {iv->var.get(), make_const(iv->var.dtype(), i)}};
+          total = Simplify(total + this->VisitExpr(Substitute(op->source[0], vmap)));
+        }
+        return total;
+      }
+    }
+    return ExprMutator::VisitExpr_(op);
+  }
+
+ private:
+  PrimExpr Read(const std::string& name, const Array<PrimExpr>& indices, DataType dtype) {
+    auto it = arrays_.find(name);
+    if (it == arrays_.end()) return PrimExpr();
+    const DLTensor* array = (*it).second.operator->();
+    CHECK(array->ctx.device_type == kDLCPU) << "Expect the array " << name << " on the host";
+    CHECK(array->dtype.code == kDLInt && (array->dtype.bits == 32 || array->dtype.bits == 64))
+        << "Expect an integer array for " << name;
+    // Indices are either flat, after storage flattening, or one per
+    // dimension of the array.
+    int64_t flat = 0;
+    if (indices.size() == 1) {
+      auto imm = indices[0].as<IntImmNode>();
+      if (!imm) return PrimExpr();
+      flat = imm->value;
+    } else {
+      CHECK_EQ(indices.size(), static_cast<size_t>(array->ndim));
+      for (int i = 0; i < array->ndim; ++i) {
+        auto imm = indices[i].as<IntImmNode>();
+        if (!imm) return PrimExpr();
+        flat = flat * array->shape[i] + imm->value;
+      }
+    }
+    int64_t size = 1;
+    for (int i = 0; i < array->ndim; ++i) size *= array->shape[i];
+    CHECK(flat >= 0 && flat < size) << "Index " << flat << " out of bounds of " << name;
+    const char* data = static_cast<const char*>(array->data) + array->byte_offset;
+    int64_t value = array->dtype.bits == 32 ? reinterpret_cast<const int32_t*>(data)[flat]
+                                            : reinterpret_cast<const int64_t*>(data)[flat];
+    return make_const(dtype, value);
+  }
+
+  const Map<std::string, PrimExpr>& scalars_;
+  const Map<std::string, runtime::NDArray>& arrays_;
+};
+
+PrimExpr BindFootprintInputs(PrimExpr expr, Map<std::string, PrimExpr> scalars,
+                             Map<std::string, runtime::NDArray> arrays) {
+  return Simplify(FootprintInputBinder(scalars, arrays)(expr));
+}
+
+}  // namespace tir
+}  // namespace tvm
@@ -0,0 +1,222 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file persistent_ragged_blocks.cc
+ * \brief Lower runtime sized grids to persistent work-queue kernels.
+ */
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/expr.h>
+#include <tvm/tir/ir_pass.h>
+#include <tvm/tir/stmt_functor.h>
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include "ir_util.h"
+
+namespace tvm {
+namespace tir {
+
+// Kernels whose grid is sized by a runtime extent, as is the case for
+// a fused ragged loop bound to blockIdx.x, launch one block per fused
+// element (or tile thereof). This rewrites such kernels to a fixed
+// size, persistent grid whose blocks repeatedly take the next chunk
+// of the fused iteration space from a global atomic counter, until
+// none are left.
+class PersistentBlockRewriter : public StmtMutator {
+ public:
+  PersistentBlockRewriter(int num_blocks, int chunk_size)
+      : num_blocks_(num_blocks), chunk_size_(chunk_size) {}
+
+  Stmt VisitStmt_(const AttrStmtNode* op) final {
+    if (op->attr_key != attr::thread_extent) return StmtMutator::VisitStmt_(op);
+    // This is the root of a kernel. Kernels do not nest, so there is
+    // no need to visit the body.
+    Stmt stmt = GetRef<Stmt>(op);
+
+    // Peel off the thread extents and allocations at the top of the
+    // kernel, which stay outside the work loop.
+    std::vector<Stmt> wrappers;
+    const AttrStmtNode* block_attr = nullptr;
+    std::vector<Var> thread_vars;
+    Stmt body = stmt;
+    while (true) {
+      if (auto attr = body.as<AttrStmtNode>()) {
+        if (attr->attr_key == attr::thread_extent) {
+          // Leave kernels that are yet to be horizontally fused alone.
+          if (attr->hfuse_group_id >= 0) return stmt;
+          IterVar iv = Downcast<IterVar>(attr->node);
+          if (iv->thread_tag == "blockIdx.x") {
+            block_attr = attr;
+          } else if (iv->thread_tag.find("blockIdx") == 0) {
+            // The counter would be shared by the other grid dimensions.
+            return stmt;
+          } else if (iv->thread_tag.find("threadIdx") == 0) {
+            thread_vars.push_back(iv->var);
+          }
+        } else if (attr->attr_key != attr::storage_scope) {
+          break;
+        }
+        wrappers.push_back(body);
+        body = attr->body;
+      } else if (auto alloc = body.as<AllocateNode>()) {
+        wrappers.push_back(body);
+        body = alloc->body;
+      } else {
+        break;
+      }
+    }
+    if (!block_attr || block_attr->value.as<IntImmNode>()) return stmt;
+    Var block_var = Downcast<IterVar>(block_attr->node)->var;
+    for (auto wrapper : wrappers) {
+      if (wrapper.get() == block_attr) continue;
+      if (auto attr = wrapper.as<AttrStmtNode>()) {
+        if (ExprUseVar(attr->value, block_var)) return stmt;
+      } else if (auto alloc = wrapper.as<AllocateNode>()) {
+        for (auto extent : alloc->extents) {
+          if (ExprUseVar(extent, block_var)) return stmt;
+        }
+      }
+    }
+    // Blocks waiting at a grid-wide barrier would expect all blocks
+    // of the original grid.
+    bool has_global_sync = false;
+    PostOrderVisit(body, [&](const ObjectRef& node) {
+      if (auto call = node.as<CallNode>()) {
+        if (call->is_intrinsic(intrinsic::tvm_storage_sync)) {
+          auto scope = call->args[0].as<StringImmNode>();
+          if (scope && scope->value == "global") has_global_sync = true;
+        }
+      }
+    });
+    if (has_global_sync) return stmt;
+    // The work loop and its guards are uniform over the threads of a
+    // block, so the barriers of the body stay safe as long as none of
+    // them already sits under a branch that only some threads take.
+    std::unordered_set<const VarNode*> thread_var_set;
+    for (auto var : thread_vars) thread_var_set.insert(var.get());
+    if (HasDivergentBarrier(body, thread_var_set)) return stmt;
+
+    DataType dtype = block_var.dtype();
+    Var extent("persistent_extent", dtype);
+    Var counter("work_queue_counter", DataType::Handle());
+    Var head("work_queue_head", DataType::Handle());
+    Var start("chunk_start", dtype);
+    PrimExpr chunk = make_const(dtype, chunk_size_);
+    PrimExpr num_chunks = indexdiv(extent + (chunk_size_ - 1), chunk);
+    PrimExpr head_val = LoadNode::make(dtype, head, 0, const_true(), kAll);
+
+    PrimExpr is_leader = const_true();
+    for (auto var : thread_vars) {
+      is_leader = is_leader && (var == make_zero(dtype));
+    }
+
+    // Process one chunk.
+    Stmt work;
+    std::unordered_map<const VarNode*, PrimExpr> vsub;
+    if (chunk_size_ == 1) {
+      vsub[block_var.get()] = start;
+      work = Substitute(body, vsub);
+    } else {
+      Var elem("chunk_elem", dtype);
+      vsub[block_var.get()] = start + elem;
+      work = Substitute(body, vsub);
+      work = IfThenElseNode::make(start + elem < extent, work);
+      work = ForNode::make(elem, 0, chunk, ForType::Serial, DeviceAPI::None, work);
+    }
+    work = IfThenElseNode::make(start < extent, work);
+    work = LetStmtNode::make(start, head_val * chunk, work);
+
+    PrimExpr fetch_value =
+        CallNode::make(dtype, "atomicAdd",
+                       {CallNode::make(DataType::Handle(), intrinsic::tvm_address_of,
+                                       {LoadNode::make(dtype, counter, 0, const_true(), kAll)},
+                                       CallNode::PureIntrinsic),
+                        make_const(dtype, 1)},
+                       CallNode::Extern);
+    Stmt fetch =
+        IfThenElseNode::make(is_leader, StoreNode::make(head, fetch_value, 0, const_true(), kAll));
+
+    // Once the queue is exhausted, the remaining iterations only read
+    // the (block uniform) head.
+    Stmt iteration = IfThenElseNode::make(
+        head_val < num_chunks, SeqStmt({SyncThread(), fetch, SyncThread(), work}));
+    Var iteration_var("queue_iteration", dtype);
+    Stmt loop = ForNode::make(iteration_var, 0, num_chunks, ForType::Serial, DeviceAPI::None,
+                              iteration);
+    Stmt init = IfThenElseNode::make(
+        is_leader, StoreNode::make(head, make_zero(dtype), 0, const_true(), kAll));
+    Stmt new_body = SeqStmt({init, SyncThread(), loop});
+    new_body = AllocateNode::make(head, dtype, {1}, const_true(), new_body);
+    new_body =
+        AttrStmtNode::make(head, attr::storage_scope, StringImmNode::make("shared"), new_body);
+
+    // Rebuild the top of the kernel around the work loop.
+    for (size_t i = wrappers.size(); i != 0; --i) {
+      Stmt wrapper = wrappers[i - 1];
+      if (auto attr = wrapper.as<AttrStmtNode>()) {
+        PrimExpr value = attr->value;
+        if (attr == block_attr) value = min(make_const(dtype, num_blocks_), num_chunks);
+        new_body = AttrStmtNode::make(attr->node, attr->attr_key, value, new_body);
+      } else if (auto alloc = wrapper.as<AllocateNode>()) {
+        new_body = AllocateNode::make(alloc->buffer_var, alloc->dtype, alloc->extents,
+                                      alloc->layout, alloc->condition, new_body, alloc->new_expr,
+                                      alloc->free_function);
+      }
+    }
+    new_body = LetStmtNode::make(extent, block_attr->value, new_body);
+
+    // The counter is reset by a single thread kernel before each
+    // launch.
+    IterVar reset_iv = IterVarNode::make(Range(0, 1), Var("blockIdx.x", dtype), kThreadIndex,
+                                         "blockIdx.x");
+    Stmt reset = AttrStmtNode::make(
+        reset_iv, attr::thread_extent, 1,
+        StoreNode::make(counter, make_zero(dtype), 0, const_true(), kAll));
+    Stmt ret = SeqStmt({reset, new_body});
+    ret = AllocateNode::make(counter, dtype, {1}, const_true(), ret);
+    return AttrStmtNode::make(counter, attr::storage_scope, StringImmNode::make("global"), ret);
+  }
+
+ private:
+  static Stmt SyncThread() {
+    return EvaluateNode::make(CallNode::make(DataType::Int(32), intrinsic::tvm_storage_sync,
+                                             {StringImmNode::make("shared")},
+                                             CallNode::Intrinsic));
+  }
+
+  int num_blocks_;
+  int chunk_size_;
+};
+
+Stmt PersistentRaggedBlocks(Stmt stmt, int num_blocks, int chunk_size) {
+  CHECK_GT(num_blocks, 0);
+  CHECK_GT(chunk_size, 0);
+  return PersistentBlockRewriter(num_blocks, chunk_size)(std::move(stmt));
+}
+
+LoweredFunc PersistentRaggedBlocksFunc(LoweredFunc f, int num_blocks, int chunk_size) {
+  auto n = make_object<LoweredFuncNode>(*f.operator->());
+  n->body = PersistentRaggedBlocks(f->body, num_blocks, chunk_size);
+  return LoweredFunc(n);
+}
+
+}  // namespace tir
+}  // namespace tvm
@@ -0,0 +1,282 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file ragged_arena.cc
+ * \brief Plan the runtime sized allocations of ragged intermediates
+ *  out of a single arena.
+ */
+#include <tvm/arith/analyzer.h>
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/expr.h>
+#include <tvm/tir/ir_pass.h>
+#include <tvm/tir/stmt_functor.h>
+
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "ir_util.h"
+
+namespace tvm {
+namespace tir {
+
+// Finds global allocations whose size is only known at runtime (as is
+// the case for ragged intermediate tensors, which storage rewriting
+// sizes by their layout's GetAllocationSize()) and whose size can be
+// evaluated at the start of the region being planned.
+class ArenaCandidateCollector : public StmtExprVisitor {
+ public:
+  explicit ArenaCandidateCollector(const std::unordered_set<const VarNode*>& bound_vars)
+      : bound_vars_(bound_vars) {}
+
+  void VisitStmt_(const AttrStmtNode* op) final {
+    if (op->attr_key == attr::storage_scope) {
+      if (auto var = op->node.as<VarNode>()) {
+        scopes_[var] = op->value.as<StringImmNode>()->value;
+      }
+    } else if (op->attr_key == attr::thread_extent || op->attr_key == attr::prep_code_scope) {
+      // Allocations inside kernels or the prep code are left alone.
+      return;
+    }
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitStmt_(const AllocateNode* op) final {
+    auto it = scopes_.find(op->buffer_var.get());
+    if (it != scopes_.end() && it->second == "global" && !op->new_expr.defined() &&
+        op->constant_allocation_size() == 0 && is_one(op->condition) && IsHoistable(op)) {
+      candidates.push_back(op);
+    }
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  std::vector<const AllocateNode*> candidates;
+
+ private:
+  bool IsHoistable(const AllocateNode* op) {
+    bool hoistable = true;
+    for (auto extent : op->extents) {
+      PostOrderVisit(extent, [&](const ObjectRef& node) {
+        if (auto var = node.as<VarNode>()) {
+          if (bound_vars_.count(var)) hoistable = false;
+        } else if (auto load = node.as<LoadNode>()) {
+          if (bound_vars_.count(load->buffer_var.get())) hoistable = false;
+        }
+      });
+    }
+    return hoistable;
+  }
+
+  const std::unordered_set<const VarNode*>& bound_vars_;
+  std::unordered_map<const VarNode*, std::string> scopes_;
+};
+
+class ArenaAllocationRewriter : public StmtMutator {
+ public:
+  ArenaAllocationRewriter(Var arena, const std::unordered_map<const AllocateNode*, Var>& offsets)
+      : arena_(arena), offsets_(offsets) {}
+
+  Stmt VisitStmt_(const AllocateNode* op) final {
+    auto it = offsets_.find(op);
+    if (it == offsets_.end()) return StmtMutator::VisitStmt_(op);
+    Stmt body = this->VisitStmt(op->body);
+    PrimExpr addr = AddressOffset(arena_, DataType::UInt(8), it->second);
+    return LetStmtNode::make(op->buffer_var, addr, body);
+  }
+
+ private:
+  Var arena_;
+  const std::unordered_map<const AllocateNode*, Var>& offsets_;
+};
+
+// Computes, for each candidate allocation, the range of statements of
+// the sequence at the top of the region (below the allocations and
+// lets wrapping it) that access it. Allocations whose ranges do not
+// overlap are never live at the same time and can share arena space.
+class ArenaLivenessAnalyzer {
+ public:
+  explicit ArenaLivenessAnalyzer(const std::vector<const AllocateNode*>& candidates) {
+    for (size_t i = 0; i < candidates.size(); ++i) {
+      index_[candidates[i]->buffer_var.get()] = i;
+    }
+    live.assign(candidates.size(), {0, std::numeric_limits<int>::max()});
+  }
+
+  void Analyze(Stmt region) {
+    while (true) {
+      if (auto op = region.as<AllocateNode>()) {
+        region = op->body;
+      } else if (auto op = region.as<AttrStmtNode>()) {
+        if (op->attr_key != attr::storage_scope) break;
+        region = op->body;
+      } else if (auto op = region.as<LetStmtNode>()) {
+        region = op->body;
+      } else {
+        break;
+      }
+    }
+    auto seq = region.as<SeqStmtNode>();
+    if (!seq) return;
+    std::vector<std::pair<int, int>> ranges(live.size(), {-1, -1});
+    for (size_t i = 0; i < seq->seq.size(); ++i) {
+      PostOrderVisit(seq->seq[i], [&](const ObjectRef& node) {
+        if (auto var = node.as<VarNode>()) {
+          auto it = index_.find(var);
+          if (it == index_.end()) return;
+          auto& range = ranges[it->second];
+          if (range.first < 0) range.first = static_cast<int>(i);
+          range.second = static_cast<int>(i);
+        }
+      });
+    }
+    for (size_t i = 0; i < live.size(); ++i) {
+      // Buffers that are never accessed are left live throughout.
+      if (ranges[i].first >= 0) live[i] = ranges[i];
+    }
+  }
+
+  // Inclusive ranges of statement indices.
+  std::vector<std::pair<int, int>> live;
+
+ private:
+  std::unordered_map<const VarNode*, size_t> index_;
+};
+
+Stmt PlanRaggedArenaInRegion(Stmt region, const std::unordered_set<const VarNode*>& bound_vars) {
+  ArenaCandidateCollector collector(bound_vars);
+  collector(region);
+  if (collector.candidates.size() < 2) return region;
+  ArenaLivenessAnalyzer liveness(collector.candidates);
+  liveness.Analyze(region);
+
+  // Each allocation is placed after all the earlier allocations it is
+  // live at the same time as, each aligned as a workspace allocation
+  // would have been. Allocations live at disjoint times thus overlap
+  // in the arena.
+  Var arena("ragged_arena", DataType::Handle());
+  std::unordered_map<const AllocateNode*, Var> offsets;
+  std::vector<std::pair<Var, PrimExpr>> offset_lets;
+  std::vector<PrimExpr> ends;
+  PrimExpr total = make_const(DataType::Int(64), 0);
+  const int align = runtime::kAllocAlignment;
+  for (size_t i = 0; i < collector.candidates.size(); ++i) {
+    const AllocateNode* op = collector.candidates[i];
+    PrimExpr nbytes = make_const(DataType::Int(64), op->dtype.bytes() * op->dtype.lanes());
+    for (auto extent : op->extents) {
+      nbytes = nbytes * cast(DataType::Int(64), extent);
+    }
+    PrimExpr current = make_const(DataType::Int(64), 0);
+    for (size_t j = 0; j < i; ++j) {
+      if (liveness.live[j].second < liveness.live[i].first ||
+          liveness.live[i].second < liveness.live[j].first) {
+        continue;
+      }
+      current = is_zero(current) ? ends[j] : max(current, ends[j]);
+    }
+    Var offset(op->buffer_var->name_hint + "_arena_offset", DataType::Int(64));
+    offset_lets.push_back(std::make_pair(offset, current));
+    offsets[op] = offset;
+    ends.push_back(offset + indexdiv(nbytes + (align - 1), align) * align);
+    total = i == 0 ? ends[i] : max(total, ends[i]);
+  }
+
+  Stmt body = ArenaAllocationRewriter(arena, offsets)(region);
+  body = AllocateNode::make(arena, DataType::UInt(8), {Simplify(total)}, const_true(), body);
+  body = AttrStmtNode::make(arena, attr::storage_scope, StringImmNode::make("global"), body);
+  for (auto it = offset_lets.rbegin(); it != offset_lets.rend(); ++it) {
+    body = LetStmtNode::make(it->first, Simplify(it->second), body);
+  }
+  return body;
+}
+
+class RaggedArenaPlanner : public StmtMutator {
+ public:
+  explicit RaggedArenaPlanner(const std::unordered_set<const VarNode*>& bound_vars)
+      : bound_vars_(bound_vars) {}
+
+  Stmt Plan(Stmt stmt) {
+    // Without any prep code, the whole body can be planned at once.
+    if (!ContainsPrepCode(stmt)) return PlanRaggedArenaInRegion(stmt, bound_vars_);
+    return this->VisitStmt(stmt);
+  }
+
+  Stmt VisitStmt_(const SeqStmtNode* op) final {
+    for (size_t i = 0; i < op->seq.size(); ++i) {
+      if (ContainsPrepCode(op->seq[i])) {
+        // Allocation sizes may read the auxiliary structures the prep
+        // code computes, so the arena is only set up after it.
+        Array<Stmt> rest;
+        for (size_t j = i + 1; j < op->seq.size(); ++j) {
+          rest.push_back(op->seq[j]);
+        }
+        if (rest.size() == 0) return GetRef<Stmt>(op);
+        Array<Stmt> seq;
+        for (size_t j = 0; j <= i; ++j) {
+          seq.push_back(op->seq[j]);
+        }
+        seq.push_back(PlanRaggedArenaInRegion(SeqStmt::Flatten(rest), bound_vars_));
+        return SeqStmt(seq);
+      }
+    }
+    return GetRef<Stmt>(op);
+  }
+
+  Stmt VisitStmt_(const AttrStmtNode* op) final {
+    if (op->attr_key == attr::prep_code_scope) return GetRef<Stmt>(op);
+    return StmtMutator::VisitStmt_(op);
+  }
+
+ private:
+  static bool ContainsPrepCode(const Stmt& stmt) {
+    bool found = false;
+    PostOrderVisit(stmt, [&found](const ObjectRef& node) {
+      if (auto attr = node.as<AttrStmtNode>()) {
+        if (attr->attr_key == attr::prep_code_scope) found = true;
+      }
+    });
+    return found;
+  }
+
+  const std::unordered_set<const VarNode*>& bound_vars_;
+};
+
+Stmt PlanRaggedArena(Stmt stmt) {
+  std::unordered_set<const VarNode*> bound_vars;
+  PostOrderVisit(stmt, [&bound_vars](const ObjectRef& node) {
+    if (auto loop = node.as<ForNode>()) {
+      bound_vars.insert(loop->loop_var.get());
+    } else if (auto let = node.as<LetStmtNode>()) {
+      bound_vars.insert(let->var.get());
+    } else if (auto let = node.as<LetNode>()) {
+      bound_vars.insert(let->var.get());
+    } else if (auto alloc = node.as<AllocateNode>()) {
+      bound_vars.insert(alloc->buffer_var.get());
+    } else if (auto attr = node.as<AttrStmtNode>()) {
+      if (auto iv = attr->node.as<IterVarNode>()) {
+        bound_vars.insert(iv->var.get());
+      }
+    }
+  });
+  return RaggedArenaPlanner(bound_vars).Plan(stmt);
+}
+
+}  // namespace tir
+}  // namespace tvm
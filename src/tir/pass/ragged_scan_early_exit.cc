@@ -0,0 +1,116 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file ragged_scan_early_exit.cc
+ * \brief Let ragged scan loops in kernels exit at the sequence length.
+ */
+#include <tvm/arith/analyzer.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/expr.h>
+#include <tvm/tir/ir_pass.h>
+#include <tvm/tir/stmt_functor.h>
+
+#include <unordered_set>
+
+namespace tvm {
+namespace tir {
+
+// Inside device kernels, a serial loop over a ragged scan dimension
+// runs up to the maximum length, with every iteration guarded by the
+// sequence's own length. This rewrites such loops so that they stop
+// at the sequence's length instead, letting every row of a persistent
+// scan kernel exit as soon as its own sequence is done.
+class RaggedScanEarlyExitRewriter : public StmtMutator {
+ public:
+  Stmt VisitStmt_(const AttrStmtNode* op) final {
+    if (op->attr_key == attr::thread_extent) {
+      IterVar iv = Downcast<IterVar>(op->node);
+      bool is_thread = iv->thread_tag.find("threadIdx") == 0;
+      if (is_thread) thread_vars_.insert(iv->var.get());
+      bool old_in_kernel = in_kernel_;
+      in_kernel_ = true;
+      Stmt ret = StmtMutator::VisitStmt_(op);
+      in_kernel_ = old_in_kernel;
+      if (is_thread) thread_vars_.erase(iv->var.get());
+      return ret;
+    }
+    return StmtMutator::VisitStmt_(op);
+  }
+
+  Stmt VisitStmt_(const ForNode* op) final {
+    Stmt stmt = StmtMutator::VisitStmt_(op);
+    op = stmt.as<ForNode>();
+    if (!in_kernel_ || op->for_type != ForType::Serial) return stmt;
+
+    auto guard = op->body.as<IfThenElseNode>();
+    if (!guard || guard->else_case.defined()) return stmt;
+    PrimExpr cond = StripLikely(guard->condition);
+    auto lt = cond.as<LTNode>();
+    if (!lt || !lt->a.same_as(op->loop_var)) return stmt;
+    PrimExpr bound = lt->b;
+    if (ExprUseVar(bound, op->loop_var)) return stmt;
+
+    // Once a thread leaves the loop early, it must not be expected at
+    // a barrier by the threads that continue. This runs after
+    // ThreadSync, so the barriers of the body are all in place.
+    bool has_global_sync = false, has_shared_sync = false;
+    PostOrderVisit(guard->then_case, [&](const ObjectRef& node) {
+      if (auto call = node.as<CallNode>()) {
+        if (call->is_intrinsic(intrinsic::tvm_storage_sync)) {
+          auto scope = call->args[0].as<StringImmNode>();
+          if (scope && scope->value == "global") {
+            has_global_sync = true;
+          } else {
+            has_shared_sync = true;
+          }
+        }
+      }
+    });
+    if (has_global_sync) return stmt;
+    if (has_shared_sync && ExprUseVar(bound, thread_vars_)) return stmt;
+
+    PrimExpr extent = analyzer_.Simplify(min(op->extent, max(bound - op->min, 0)));
+    return ForNode::make(op->loop_var, op->min, extent, op->for_type, op->device_api,
+                         guard->then_case, op->hfuse_group_id);
+  }
+
+ private:
+  static PrimExpr StripLikely(PrimExpr cond) {
+    if (auto call = cond.as<CallNode>()) {
+      if (call->is_intrinsic(CallNode::likely)) return call->args[0];
+    }
+    return cond;
+  }
+
+  bool in_kernel_{false};
+  std::unordered_set<const VarNode*> thread_vars_;
+  arith::Analyzer analyzer_;
+};
+
+Stmt RaggedScanEarlyExit(Stmt stmt) { return RaggedScanEarlyExitRewriter()(std::move(stmt)); }
+
+LoweredFunc RaggedScanEarlyExitFunc(LoweredFunc f) {
+  auto n = make_object<LoweredFuncNode>(*f.operator->());
+  n->body = RaggedScanEarlyExit(f->body);
+  return LoweredFunc(n);
+}
+
+}  // namespace tir
+}  // namespace tvm
@@ -0,0 +1,169 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file ragged_tile.cc
+ * \brief Tile ragged loops.
+ */
+#include <tvm/arith/analyzer.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/expr.h>
+#include <tvm/tir/ir_pass.h>
+#include <tvm/tir/stmt_functor.h>
+
+#include <unordered_set>
+
+namespace tvm {
+namespace tir {
+
+// Removes, from the body of a loop over full tiles, the predicates
+// that check that a tile iteration, tile * factor + r with r in
+// [0, factor), is within the ragged bound of the row. The bound is
+// taken from the first such predicate, and only predicates against
+// the same bound are removed.
+class TileBoundRemover : public StmtMutator {
+ public:
+  TileBoundRemover(Var tile_var, int64_t factor) : tile_var_(tile_var), factor_(factor) {}
+
+  Stmt VisitStmt_(const ForNode* op) final {
+    if (MarkBound(op->loop_var)) {
+      analyzer_.Bind(op->loop_var, Range::make_by_min_extent(op->min, op->extent));
+    }
+    return StmtMutator::VisitStmt_(op);
+  }
+
+  Stmt VisitStmt_(const LetStmtNode* op) final {
+    if (MarkBound(op->var)) analyzer_.Bind(op->var, op->value);
+    return StmtMutator::VisitStmt_(op);
+  }
+
+  Stmt VisitStmt_(const AttrStmtNode* op) final {
+    // Threads fetching parts of a tile cooperatively.
+    if (op->attr_key == attr::thread_extent) {
+      Var var = Downcast<IterVar>(op->node)->var;
+      if (MarkBound(var)) analyzer_.Bind(var, Range::make_by_min_extent(0, op->value));
+    }
+    return StmtMutator::VisitStmt_(op);
+  }
+
+  Stmt VisitStmt_(const IfThenElseNode* op) final {
+    if (!op->else_case.defined()) {
+      PrimExpr cond = RemoveConjuncts(op->condition);
+      if (is_one(cond)) return this->VisitStmt(op->then_case);
+      if (!cond.same_as(op->condition)) {
+        return IfThenElseNode::make(cond, this->VisitStmt(op->then_case));
+      }
+    }
+    return StmtMutator::VisitStmt_(op);
+  }
+
+  PrimExpr bound;
+
+ private:
+  // Vars can only be bound once in the analyzer. Vars that are bound
+  // more than once (the body may not be in SSA form) are not reasoned
+  // about.
+  bool MarkBound(const Var& var) {
+    if (bound_vars_.insert(var.get()).second) return true;
+    ambiguous_vars_.insert(var.get());
+    return false;
+  }
+
+  PrimExpr RemoveConjuncts(PrimExpr cond) {
+    if (auto op = cond.as<AndNode>()) {
+      PrimExpr a = RemoveConjuncts(op->a);
+      PrimExpr b = RemoveConjuncts(op->b);
+      if (is_one(a)) return b;
+      if (is_one(b)) return a;
+      if (a.same_as(op->a) && b.same_as(op->b)) return cond;
+      return AndNode::make(a, b);
+    }
+    return IsTileBound(cond) ? const_true() : cond;
+  }
+
+  bool IsTileBound(PrimExpr cond) {
+    if (auto call = cond.as<CallNode>()) {
+      if (call->is_intrinsic(CallNode::likely)) cond = call->args[0];
+    }
+    auto lt = cond.as<LTNode>();
+    // The bound has to be available outside the tile loop.
+    if (!lt || ExprUseVar(lt->b, tile_var_) || ExprUseVar(lt->b, bound_vars_)) return false;
+    if (bound.defined() && !Equal(bound, lt->b)) return false;
+    PrimExpr rem = analyzer_.Simplify(lt->a - tile_var_ * make_const(tile_var_.dtype(), factor_));
+    if (ExprUseVar(rem, tile_var_) || ExprUseVar(lt->a, ambiguous_vars_) ||
+        ExprUseVar(rem, ambiguous_vars_)) {
+      return false;
+    }
+    if (!analyzer_.CanProve(rem >= 0) || !analyzer_.CanProve(rem < static_cast<int>(factor_))) {
+      return false;
+    }
+    if (!bound.defined()) bound = lt->b;
+    return true;
+  }
+
+  Var tile_var_;
+  int64_t factor_;
+  arith::Analyzer analyzer_;
+  std::unordered_set<const VarNode*> bound_vars_;
+  std::unordered_set<const VarNode*> ambiguous_vars_;
+};
+
+class RaggedTileRewriter : public StmtMutator {
+ public:
+  Stmt VisitStmt_(const AttrStmtNode* op) final {
+    if (op->attr_key != std::string(attr::pragma_scope_prefix) + "ragged_tile") {
+      return StmtMutator::VisitStmt_(op);
+    }
+    Stmt body = this->VisitStmt(op->body);
+    auto loop = body.as<ForNode>();
+    auto factor = op->value.as<IntImmNode>();
+    if (!loop || !factor || !is_zero(loop->min)) return body;
+
+    TileBoundRemover remover(loop->loop_var, factor->value);
+    Stmt full_body = remover(loop->body);
+    if (!remover.bound.defined()) return body;
+
+    // The tiles entirely within the bound.
+    DataType dtype = loop->loop_var.dtype();
+    PrimExpr num_full =
+        Simplify(min(indexdiv(remover.bound, make_const(dtype, factor->value)), loop->extent));
+    Stmt full_tiles = ForNode::make(loop->loop_var, 0, num_full, loop->for_type,
+                                    loop->device_api, full_body, loop->hfuse_group_id);
+
+    // The partial last tile, if any, which keeps its predicates.
+    Map<Var, PrimExpr> vmap;
+    vmap.Set(loop->loop_var, num_full);
+    Stmt last_tile = Substitute(loop->body, vmap);
+    PrimExpr has_last_tile = num_full < loop->extent &&
+                             num_full * make_const(dtype, factor->value) < remover.bound;
+    last_tile = IfThenElseNode::make(has_last_tile, last_tile);
+    return SeqStmt({full_tiles, last_tile});
+  }
+};
+
+Stmt RaggedTileLoops(Stmt stmt) {
+  Stmt ret = RaggedTileRewriter()(stmt);
+  if (!ret.same_as(stmt)) {
+    return ConvertSSA(ret);
+  }
+  return ret;
+}
+
+}  // namespace tir
+}  // namespace tvm
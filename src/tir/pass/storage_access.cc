@@ -132,6 +132,10 @@ void StorageAccessVisitor::VisitStmt_(const AttrStmtNode* op) {
       scope_.back().emplace_back(std::move(s));
     }
     double_buffer_write_ = nullptr;
+  } else if (op->attr_key == attr::aux_data_structure) {
+    aux_data_structures_.push_back(op->node);
+    StmtExprVisitor::VisitStmt_(op);
+    aux_data_structures_.pop_back();
   } else if (op->attr_key == attr::coproc_scope) {
     IterVar iv = Downcast<IterVar>(op->node);
     env_threads_.push_back(iv);
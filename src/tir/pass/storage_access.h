@@ -96,6 +96,11 @@ class StorageAccessVisitor : public StmtExprVisitor {
   bool in_device_env() const { return in_device_env_; }
   /*! \return environment threads */
   const Array<IterVar>& env_threads() const { return env_threads_; }
+  /*!
+   * \return The auxiliary data structures (uninterpreted functions
+   *  or buffers) in scope, all of whose values are non-negative.
+   */
+  const std::vector<ObjectRef>& aux_data_structures() const { return aux_data_structures_; }
   /*! \return thread extent. Must be an env_thread */
   const Range get_thread_extent(IterVar iv) const {
     if (thread_extents_.count(iv)) {
@@ -152,6 +157,8 @@ class StorageAccessVisitor : public StmtExprVisitor {
   Map<IterVar, PrimExpr> thread_extents_;
   // The storage scope of each buffer
   std::unordered_map<const VarNode*, StorageScope> storage_scope_;
+  // The auxiliary data structures in scope
+  std::vector<ObjectRef> aux_data_structures_;
 };
 
 }  // namespace tir
@@ -34,6 +34,7 @@
 #include <tvm/tir/stmt_functor.h>
 
 #include <unordered_map>
+#include <unordered_set>
 
 #include "../../arith/compute_expr.h"
 #include "../../arith/ir_visitor_with_analyzer.h"
@@ -63,6 +64,12 @@ class StorageFlattener : public StmtExprMutator {
     cache_line_size_ = cache_line_size;
   }
 
+  // Regions of these tensors are accessed with dense strides, so they
+  // are never stored packed.
+  void MarkDenseOnly(const te::Tensor& tensor) {
+    dense_only_.insert(TensorKey{tensor->op, tensor->value_index});
+  }
+
   SyncType getSyncType(FunctionRef func) {
     if (func.as<te::OperationNode>()->attrs.count("no_sync")) {
       // std::cout << "[NONE] " << func << std::endl;
@@ -186,8 +193,7 @@ class StorageFlattener : public StmtExprMutator {
                                   getSyncType(op->func, e.buffer));
       body = this->VisitStmt(body);
       if (create_bound_attributes_ && ShapeIsValid(e.buffer->shape->get_dense_shape())) {
-        shape_collector_.push_back(
-            std::make_pair(e.buffer->data, e.buffer->shape->get_dense_shape()));
+        shape_collector_.push_back(std::make_pair(e.buffer->data, BoundShape(e.buffer)));
       }
       // To create bound attribute collector should has at least one item.
       if (create_bound_attributes_ && shape_collector_.size()) {
@@ -232,6 +238,8 @@ class StorageFlattener : public StmtExprMutator {
       if (op->layout.defined()) {
         layout = Downcast<Modes>(op->layout);
       }
+      bool packed = IsPackedRealize(key, layout, e.bounds);
+      e.packed = packed;
 
       // use small alignment for small arrays
       int32_t const_size = AllocateNode::constant_allocation_size(shape, layout);
@@ -274,9 +282,9 @@ class StorageFlattener : public StmtExprMutator {
         // }
       }
 
-      // if (layout.defined()) {
-      if (false) {
-        // std::cout << "[SF] Dimensions for " << op->func << std::endl;
+      if (packed) {
+        // Accesses get the packed positions of the layout as their
+        // offsets, see ElemOffset.
         e.buffer = BufferNode::make(Var(key.GetName(), DataType::Handle()), op->dtype, layout,
                                     strides, PrimExpr(), key.GetName(), skey.to_string(), align, 0,
                                     kDefault, getSyncType(op->func));
@@ -300,7 +308,11 @@ class StorageFlattener : public StmtExprMutator {
       if (storage_type == DataType::Bool()) {
         storage_type = DataType::Int(8);
       }
-      if (strides.size() != 0) {
+      if (packed) {
+        PrimExpr size = this->VisitExpr(layout->GetAllocationSize());
+        ret = AllocateNode::make(e.buffer->data, storage_type, {size}, layout,
+                                 make_const(DataType::Bool(e.buffer->dtype.lanes()), true), body);
+      } else if (strides.size() != 0) {
         CHECK(!layout.defined()) << "Not sure how to handle storage layouts in the presence of "
                                     "strides. This happens for "
                                  << op->func;
@@ -326,9 +338,8 @@ class StorageFlattener : public StmtExprMutator {
                                StringImmNode::make(e.buffer->scope), ret);
 
       if (create_bound_attributes_ && ShapeIsValid(e.buffer->shape->get_dense_shape())) {
-        ret =
-            AttrStmtNode::make(e.buffer->data, tir::attr::buffer_bound,
-                               MakeBound(e.buffer->dtype, e.buffer->shape->get_dense_shape()), ret);
+        ret = AttrStmtNode::make(e.buffer->data, tir::attr::buffer_bound,
+                                 MakeBound(e.buffer->dtype, BoundShape(e.buffer)), ret);
       }
       return ret;
     }
@@ -372,7 +383,7 @@ class StorageFlattener : public StmtExprMutator {
 
       auto buffer_dense_shape = e.buffer->shape->get_dense_shape();
       if (create_bound_attributes_ && ShapeIsValid(buffer_dense_shape)) {
-        shape_collector_.push_back(std::make_pair(e.buffer->data, buffer_dense_shape));
+        shape_collector_.push_back(std::make_pair(e.buffer->data, BoundShape(e.buffer)));
       }
       Array<PrimExpr> args;
       for (auto arg: op->args) {
@@ -399,6 +410,7 @@ class StorageFlattener : public StmtExprMutator {
     const BufferEntry& e = it->second;
 
     CHECK(!e.released) << "Read a buffer that is already out of scope";
+    CHECK(!e.packed) << "Cannot prefetch the packed ragged buffer " << e.buffer->name;
 
     auto buffer_dense_shape = e.buffer->shape->get_dense_shape();
     CHECK_EQ(buffer_dense_shape.size(), op->bounds.size())
@@ -495,6 +507,7 @@ class StorageFlattener : public StmtExprMutator {
                                << " value=" << tensor->value_index;
     const BufferEntry& be = buf_map_.at(key);
     CHECK(!be.released);
+    CHECK(!be.packed) << "Cannot bind a region of the packed ragged buffer " << be.buffer->name;
     auto buffer_dense_shape = be.buffer->shape->get_dense_shape();
     if (tuple->args.size() != buffer_dense_shape.size() * 2) {
       for (auto s : buffer_dense_shape) {
@@ -552,6 +565,8 @@ class StorageFlattener : public StmtExprMutator {
     bool external{false};
     // Whether we are out of allocation bounds and buffer get released.
     bool released{false};
+    // Whether the buffer is stored packed as per its ragged layout.
+    bool packed{false};
     // relative index
     inline Array<PrimExpr> RelIndex(StorageFlattener* flattener, Array<PrimExpr> args,
                                     Array<Range> override_realize_bounds = {}) const {
@@ -560,6 +575,10 @@ class StorageFlattener : public StmtExprMutator {
         if (override_realize_bounds.size() > 0) {
           CHECK_EQ(override_realize_bounds.size(), args.size()) << buffer;
           for (size_t i = 0; i < override_realize_bounds.size(); ++i) {
+            // Packed positions are only defined relative to the
+            // start of the whole tensor.
+            CHECK(!packed || is_zero(tir::Simplify(override_realize_bounds[i]->min)))
+                << "Offset realize bounds for the packed ragged buffer " << buffer->name;
             PrimExpr rel_index = tir::Simplify(flattener->VisitExpr(
                 UninterpFun::InlineUninterpFunCalls(args[i] - override_realize_bounds[i]->min)));
             index.push_back(rel_index);
@@ -579,6 +598,33 @@ class StorageFlattener : public StmtExprMutator {
     }
   };
 
+  // Ragged realizes of whole tensors are stored packed, as their
+  // layout lays them out, rather than padded to their dense shape.
+  // Regions that start past the origin, or that are accessed with
+  // dense strides, keep the padded storage.
+  bool IsPackedRealize(const TensorKey& key, const Modes& layout, const Region& bounds) {
+    if (!layout.defined() || !layout->is_ragged() || layout->ndim() != bounds.size()) {
+      return false;
+    }
+    if (dense_only_.count(key) || dim_align_.count(key)) return false;
+    Array<PrimExpr> dense_shape = layout->get_dense_shape();
+    arith::Analyzer analyzer;
+    for (size_t i = 0; i < bounds.size(); ++i) {
+      if (!is_zero(tir::Simplify(bounds[i]->min))) return false;
+      PrimExpr slack = bounded_analyzer_->Simplify(bounds[i]->extent - dense_shape[i]);
+      if (!analyzer.CanProve(slack >= 0)) return false;
+    }
+    return true;
+  }
+
+  // The shape the accesses to a buffer are bounded by.
+  Array<PrimExpr> BoundShape(const Buffer& buffer) {
+    if (buffer->shape->is_ragged() && buffer->strides.size() == 0) {
+      return {this->VisitExpr(buffer->shape->GetAllocationSize())};
+    }
+    return buffer->shape->get_dense_shape();
+  }
+
   bool ShapeIsValid(const Array<PrimExpr>& shape) {
     // Zero-dimensional tensor does not need boundary check.
     if (!shape.size()) return false;
@@ -608,6 +654,8 @@ class StorageFlattener : public StmtExprMutator {
   std::unordered_map<TensorKey, BufferEntry> buf_map_;
   // Dimension alignment
   std::unordered_map<TensorKey, std::vector<DimAlignInfo>> dim_align_;
+  // Tensors never stored packed
+  std::unordered_set<TensorKey> dense_only_;
   // Storage scope
   std::unordered_map<const Object*, std::string> storage_scope_;
   // The current thread scope.
@@ -630,8 +678,18 @@ Stmt StorageFlatten(Stmt stmt, Map<te::Tensor, Buffer> extern_buffer, int cache_
   // std::cout << "Yo flattening" << std::endl;
   IRVisitorWithAnalyzer bounded_analyzer;
   bounded_analyzer(stmt);
-  stmt = StorageFlattener(extern_buffer, cache_line_size, create_bound_attributes,
-                          &bounded_analyzer)(std::move(stmt));
+  StorageFlattener flattener(extern_buffer, cache_line_size, create_bound_attributes,
+                             &bounded_analyzer);
+  for (const auto& tensor : CompactBufferBoundTensors(stmt)) {
+    flattener.MarkDenseOnly(tensor);
+  }
+  PostOrderVisit(stmt, [&](const ObjectRef& n) {
+    if (auto prefetch = n.as<PrefetchNode>()) {
+      auto func = Downcast<te::Operation>(prefetch->func);
+      flattener.MarkDenseOnly(func.output(prefetch->value_index));
+    }
+  });
+  stmt = flattener(std::move(stmt));
   return stmt;
   // std::cout << "[SF] Inlining " << std::endl;
   // return UninterpFun::InlineUninterpFunCalls(stmt);
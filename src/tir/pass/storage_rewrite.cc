@@ -886,24 +886,38 @@ class StoragePlanRewriter : public StmtExprMutator {
         return e;
       }
     } else {
-      // Simple strategy: round robin.
-      // std::cout << "[FINDALL] SymFreeList " << sym_free_list_.size() << std::endl;
-      for (auto it = sym_free_list_.begin(); it != sym_free_list_.end(); ++it) {
-        StorageEntry* e = *it;
-        // std::cout << "[FINDALL]   Considering " << e->allocs[0]->buffer_var << " "
-        // << e->variable_nbytes << std::endl;
-        if (e->attach_scope_ != attach_scope) continue;
-        if (e->scope != scope) continue;
-        if (e->elem_type != op->dtype.element_of()) continue;
-        if (!analyzer_.CanProve(e->variable_nbytes <= op->variable_allocation_size())) continue;
-        sym_free_list_.erase(it);
-        // std::cout << "[FINDALL]   Found " << e->allocs[0]->buffer_var << std::endl;
-        return e;
+      // Ragged allocations are sized by uninterpreted functions of
+      // the aux structures, which mostly only z3 can compare. Free
+      // entries that the new allocation provably fits in are taken
+      // first, as reusing them does not grow the
+      // storage. Then, entries that provably fit in the new
+      // allocation, which is grown to its size.
+      PrimExpr op_size = op->variable_allocation_size();
+      for (int grow = 0; grow < 2; ++grow) {
+        for (auto it = sym_free_list_.begin(); it != sym_free_list_.end(); ++it) {
+          StorageEntry* e = *it;
+          if (e->attach_scope_ != attach_scope) continue;
+          if (e->scope != scope) continue;
+          if (e->elem_type != op->dtype.element_of()) continue;
+          if (grow) {
+            if (!CanProveFits(e->variable_nbytes, op_size)) continue;
+            e->variable_nbytes = op_size;
+          } else if (!CanProveFits(op_size, e->variable_nbytes)) {
+            continue;
+          }
+          sym_free_list_.erase(it);
+          return e;
+        }
       }
     }
     // std::cout << "[FINDALL]   New" << std::endl;
     return NewAlloc(op, attach_scope, scope, const_nbits);
   }
+  // Whether an allocation of size small provably fits in one of
+  // size big.
+  bool CanProveFits(const PrimExpr& small, const PrimExpr& big) {
+    return analyzer_.CanProve(small <= big);
+  }
   // simulated free.
   void Free(const VarNode* var) {
     auto it = alloc_map_.find(var);
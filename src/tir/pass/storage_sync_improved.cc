@@ -25,6 +25,7 @@
 #include <tvm/tir/ir_pass.h>
 #include <tvm/tir/stmt_functor.h>
 
+#include <algorithm>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -238,6 +239,15 @@ class ThreadSyncPlanner : public StorageAccessVisitor {
  private:
   // find conflicting entry in vec.
   bool FindConflict(const std::vector<AccessEntry>& vec, const AccessEntry& e, bool loop_carry) {
+    bool has_candidate = false;
+    for (const AccessEntry& x : vec) {
+      if (x.buffer.same_as(e.buffer)) {
+        has_candidate = true;
+        break;
+      }
+    }
+    if (!has_candidate) return false;
+
     arith::Analyzer analyzer;
 
     for (IterVar iv : env_threads()) {
@@ -247,6 +257,23 @@ class ThreadSyncPlanner : public StorageAccessVisitor {
       }
     }
 
+    // Indices into ragged buffers go through the auxiliary data
+    // structures (lengths, A-functions and fusion maps), whose values
+    // are known to be non-negative. Telling the analyzer lets it
+    // prove, for example, that a[afun[i] + j] with j in [0, 4) is
+    // disjoint from a[afun[i] + j + 4], and skip the barrier.
+    for (const ObjectRef& obj : aux_data_structures()) {
+      if (auto ufn = obj.as<UninterpFunNode>()) {
+        if (ufn->body.defined()) {
+          analyzer.AddForallConstraint(ufn->parameters, ufn->body >= 0);
+        }
+      } else if (obj.as<VarNode>()) {
+        Var index = Var("idx", DataType::Int(32));
+        analyzer.AddForallConstraint(
+            {index}, LoadNode::make(DataType::Int(32), Downcast<Var>(obj), index, 1, kAll) >= 0);
+      }
+    }
+
     for (const AccessEntry& x : vec) {
       if (x.buffer.same_as(e.buffer)) {
         // std::cout << "[SYNC] Sync for " << x.buffer << " " << (e.type == kWrite && x.type ==
@@ -313,6 +340,15 @@ class ThreadSyncInserter : public StmtExprMutator {
       Stmt barrier;
       if (sync_scope_.rank == StorageRank::kGlobal) {
         barrier = MakeGlobalBarrier();
+      } else if (sync_scope_.rank == StorageRank::kShared && block_threads_ == 1) {
+        // A single thread needs no barrier.
+        return StmtExprMutator::VisitStmt(stmt);
+      } else if (sync_scope_.rank == StorageRank::kShared && block_threads_ > 0 &&
+                 block_threads_ <= kWarpSize) {
+        // All the threads of the block are in the same warp.
+        barrier = EvaluateNode::make(CallNode::make(DataType::Int(32), intrinsic::tvm_storage_sync,
+                                                    {StringImmNode::make("warp")},
+                                                    CallNode::Intrinsic));
       } else {
         barrier = EvaluateNode::make(CallNode::make(DataType::Int(32), intrinsic::tvm_storage_sync,
                                                     {StringImmNode::make(sync_scope_.to_string())},
@@ -343,9 +379,12 @@ class ThreadSyncInserter : public StmtExprMutator {
     if (op->attr_key == attr::thread_extent) {
       bool temp = true;
       std::swap(temp, in_thread_env_);
+      int64_t old_block_threads = block_threads_;
+      if (!temp) block_threads_ = CountBlockThreads(op);
       thread_extents_.push_back(op);
       Stmt ret = StmtExprMutator::VisitStmt_(op);
       thread_extents_.pop_back();
+      block_threads_ = old_block_threads;
       std::swap(temp, in_thread_env_);
       // first thread scope.
 
@@ -405,6 +444,29 @@ class ThreadSyncInserter : public StmtExprMutator {
     if (it == storage_scope_.end()) return s;
     return it->second;
   }
+  // The number of threads in a block of the kernel rooted at op, if
+  // it is constant and the target is CUDA, and -1 otherwise.
+  int64_t CountBlockThreads(const AttrStmtNode* op) {
+    if (target_ != "cuda") return -1;
+    std::unordered_map<std::string, int64_t> extents;
+    bool all_constant = true;
+    PostOrderVisit(GetRef<Stmt>(op), [&](const ObjectRef& node) {
+      auto attr = node.as<AttrStmtNode>();
+      if (!attr || attr->attr_key != attr::thread_extent) return;
+      IterVar iv = Downcast<IterVar>(attr->node);
+      if (iv->thread_tag.find("threadIdx") != 0) return;
+      auto extent = attr->value.as<IntImmNode>();
+      if (!extent) {
+        all_constant = false;
+      } else {
+        extents[iv->thread_tag] = std::max(extents[iv->thread_tag], extent->value);
+      }
+    });
+    if (!all_constant) return -1;
+    int64_t ret = 1;
+    for (auto it : extents) ret *= it.second;
+    return ret;
+  }
   // private functions.
   Stmt InitGlobalBarrier(const AttrStmtNode* op) {
     if (target_ == "cuda") {
@@ -468,6 +530,10 @@ class ThreadSyncInserter : public StmtExprMutator {
   bool in_thread_env_{false};
   // memorized results
   std::vector<const AttrStmtNode*> thread_extents_;
+  // The number of threads in a block of the current kernel, or -1 if
+  // not known.
+  int64_t block_threads_{-1};
+  static constexpr int64_t kWarpSize = 32;
   size_t num_work_dim_{0};
   PrimExpr num_blocks_;
   PrimExpr is_lead_;
@@ -475,7 +541,9 @@ class ThreadSyncInserter : public StmtExprMutator {
 };
 
 Stmt ThreadSync(Stmt stmt, std::string storage_scope, std::string target) {
-  if (storage_scope != "global" && target == "llvm") return stmt;
+  // Barriers on shared memory split the thread loops of CPU code, see
+  // CreateEnvLoopsForFunc.
+  if (storage_scope == "warp" && target == "llvm") return stmt;
   // std::cout << "[SYNC] for " << storage_scope << std::endl;
   StorageScope sync_scope = StorageScope::make(storage_scope);
   ThreadSyncPlanner planner(sync_scope);
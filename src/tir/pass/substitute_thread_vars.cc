@@ -25,7 +25,9 @@
 #include <tvm/tir/ir_pass.h>
 #include <tvm/tir/stmt_functor.h>
 
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
 
 #include "../../arith/compute_expr.h"
 
@@ -59,22 +61,66 @@ class ThreadVarRewriter : public StmtExprMutator {
     }
   }
 
+  // The substituted value of a thread variable is computed once, at
+  // the start of the scope of the thread variable, instead of at each
+  // of its uses, which for the fused_to_outer and fused_to_inner maps
+  // of horizontally fused kernels are loads.
+  Stmt VisitStmt_(const AttrStmtNode* op) override {
+    if (op->attr_key == attr::thread_extent) {
+      IterVar iv = Downcast<IterVar>(op->node);
+      if (vsub.count(iv->var->name_hint)) {
+        const VarNode* thread_var = iv->var.get();
+        PrimExpr value = Substitution(iv->var);
+        Var cached(iv->var->name_hint + ".sub", value.dtype());
+        auto outer = substituted_.find(thread_var) != substituted_.end()
+                         ? substituted_.at(thread_var)
+                         : std::make_pair(Var(), false);
+        substituted_[thread_var] = std::make_pair(cached, false);
+        Stmt body = this->VisitStmt(op->body);
+        bool used = substituted_.at(thread_var).second;
+        if (outer.first.defined()) {
+          substituted_[thread_var] = outer;
+        } else {
+          substituted_.erase(thread_var);
+        }
+        if (used) {
+          body = LetStmtNode::make(cached, value, body);
+        }
+        return AttrStmtNode::make(op->node, op->attr_key, this->VisitExpr(op->value), body,
+                                  op->hfuse_group_id);
+      }
+    }
+    return StmtExprMutator::VisitStmt_(op);
+  }
+
   PrimExpr VisitExpr_(const VarNode* op) override {
     // if (op->name_hint == "blockIdx.y")
     // std::cout << "[STV] Var " << substitute << std::endl;
     if (substitute && vsub.count(op->name_hint)) {
-      auto function = Downcast<UninterpFun>(vsub.at(op->name_hint));
-      return UninterpFun::InlineUninterpFunCalls(
-          function.MakeCallTo({GetRef<PrimExpr>(op)}, function->dimensions));
+      auto it = substituted_.find(op);
+      if (it != substituted_.end()) {
+        it->second.second = true;
+        return it->second.first;
+      }
+      return Substitution(GetRef<Var>(op));
     } else {
       return StmtExprMutator::VisitExpr_(op);
     }
   }
 
  private:
+  PrimExpr Substitution(const Var& thread_var) {
+    auto function = Downcast<UninterpFun>(vsub.at(thread_var->name_hint));
+    Array<PrimExpr> args{thread_var};
+    return UninterpFun::InlineUninterpFunCalls(function.MakeCallTo(args, function->dimensions));
+  }
+
   Map<std::string, FunctionRef> vsub;
   Array<FunctionRef> to_substitute_in;
   bool substitute;
+  // The variables holding the substituted values of the thread
+  // variables in scope, and whether they are used
+  std::unordered_map<const VarNode*, std::pair<Var, bool>> substituted_;
 };
 
 Stmt SubstituteThreadVars(Stmt stmt, Array<FunctionRef> to_substitute_in,
@@ -395,6 +395,7 @@ class BufferAnalyser : public StmtExprVisitor {
       bi.dtype = kv.second->dtype;
       bi.strides = kv.second->strides;
       bi.shape = kv.second->shape->get_dense_shape();
+      bi.ragged_rows = bi.shape.size() >= 2 && kv.second->shape->is_ragged(bi.shape.size() - 2);
       bi.external = true;
       buf_map_[TensorKey{kv.first->op, kv.first->value_index}] = bi;
     }
@@ -435,18 +436,9 @@ class BufferAnalyser : public StmtExprVisitor {
     const BufferInfo& bi = it->second;
     CHECK(!bi.released) << "Read a buffer that is already out of scope";
 
-    if (matrix_abc_.count(key.GetName())) {
-      if (bi.shape.size() < 2) {
-        invalid_ = true;
-        return;
-      }
-      for (auto i = bi.shape.size() - 1; i + 2 >= bi.shape.size(); --i) {
-        const IntImmNode* shape = bi.shape[i].as<IntImmNode>();
-        if (shape == nullptr || shape->value % 16 != 0) {
-          invalid_ = true;
-          return;
-        }
-      }
+    if (matrix_abc_.count(key.GetName()) && !check_matrix_shape_(bi)) {
+      invalid_ = true;
+      return;
     }
 
     Array<PrimExpr> strides;
@@ -467,6 +459,12 @@ class BufferAnalyser : public StmtExprVisitor {
     if (frag_reg_.count(bi.name)) {
       PrimExpr dst = CallNode::make(bi.dtype, bi.name, op->args, CallNode::Halide, op->func, 0);
       frag_load_.insert(std::make_pair(op, dst));
+      if (auto src = op->value.as<CallNode>()) {
+        auto it = storage_scope_.find(src->func.get());
+        if (it != storage_scope_.end() && it->second == "shared") {
+          frag_src_.insert(src->func.get());
+        }
+      }
 
       auto rel_index = bi.RelIndex(op->args);
       if (op->args.size() < 2) {
@@ -536,18 +534,9 @@ class BufferAnalyser : public StmtExprVisitor {
       const BufferInfo& bi = it->second;
       CHECK(!bi.released) << "Read a buffer that is already out of scope";
 
-      if (matrix_abc_.count(op->name)) {
-        if (bi.shape.size() < 2) {
-          invalid_ = true;
-          return;
-        }
-        for (auto i = bi.shape.size() - 1; i + 2 >= bi.shape.size(); --i) {
-          const IntImmNode* shape = bi.shape[i].as<IntImmNode>();
-          if (shape == nullptr || shape->value % 16 != 0) {
-            invalid_ = true;
-            return;
-          }
-        }
+      if (matrix_abc_.count(op->name) && !check_matrix_shape_(bi)) {
+        invalid_ = true;
+        return;
       }
 
       Array<PrimExpr> strides;
@@ -671,6 +660,9 @@ class BufferAnalyser : public StmtExprVisitor {
     Array<PrimExpr> strides;
     Array<PrimExpr> shape;
     Region bounds;
+    // Whether the rows of the matrix, i.e. its second innermost
+    // dimension, are ragged.
+    bool ragged_rows{false};
     bool external{false};
     bool released{false};
     inline Array<PrimExpr> RelIndex(Array<PrimExpr> args) const {
@@ -687,6 +679,26 @@ class BufferAnalyser : public StmtExprVisitor {
     }
   };
 
+  // The innermost dimension of a matrix has to be a constant multiple
+  // of the fragment size. So does the dimension of its rows, unless
+  // they are ragged: partial tiles at the end of ragged rows are then
+  // zero-padded when staged in shared memory.
+  bool check_matrix_shape_(const BufferInfo& bi) {
+    if (bi.shape.size() < 2) {
+      return false;
+    }
+    for (auto i = bi.shape.size() - 1; i + 2 >= bi.shape.size(); --i) {
+      if (i + 2 == bi.shape.size() && bi.ragged_rows) {
+        continue;
+      }
+      const IntImmNode* shape = bi.shape[i].as<IntImmNode>();
+      if (shape == nullptr || shape->value % 16 != 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   bool assign_or_check_(int* dst, int src) {
     if (*dst <= 0) {
       *dst = src;
@@ -720,6 +732,7 @@ class BufferAnalyser : public StmtExprVisitor {
   std::unordered_map<std::string, Array<PrimExpr>> strides_;
   std::unordered_map<const ProvideNode*, PrimExpr> frag_load_;
   std::unordered_map<const ProvideNode*, PrimExpr> frag_store_;
+  std::unordered_set<const Object*> frag_src_;
   std::unordered_map<std::string, int> thread_extent_;
   IndexVisitor index_visitor;
   Tile warp_tile_;
@@ -768,6 +781,7 @@ class TensorCoreIRMutator : public StmtExprMutator {
         loop_scaling_(buffer_analyser.index_visitor.loop_scaling_),
         frag_load_(buffer_analyser.frag_load_),
         frag_store_(buffer_analyser.frag_store_),
+        frag_src_(buffer_analyser.frag_src_),
         warp_tile_(buffer_analyser.warp_tile_),
         warp_threads_y_(buffer_analyser.warp_threads_y_) {}
 
@@ -950,6 +964,37 @@ class TensorCoreIRMutator : public StmtExprMutator {
     return stmt;
   }
 
+  Stmt VisitStmt_(const IfThenElseNode* op) final {
+    Stmt stmt = StmtExprMutator::VisitStmt_(op);
+    auto provide = op->then_case.as<ProvideNode>();
+    if (provide != nullptr && !op->else_case.defined() && frag_src_.count(provide->func.get())) {
+      // Elements of shared memory tiles past the ragged bound are
+      // zero-filled, so that full fragments can be loaded from them.
+      auto new_op = stmt.as<IfThenElseNode>();
+      Stmt zero_fill = ProvideNode::make(provide->func, provide->value_index,
+                                         make_zero(provide->value.dtype()), provide->args);
+      return IfThenElseNode::make(new_op->condition, new_op->then_case, zero_fill);
+    }
+    bool has_fragment_op = false;
+    PostOrderVisit(op->then_case, [this, &has_fragment_op](const ObjectRef& node) {
+      if (auto provide = node.as<ProvideNode>()) {
+        if (mma_sync_.count(provide) || frag_load_.count(provide) || frag_store_.count(provide)) {
+          has_fragment_op = true;
+        }
+      }
+    });
+    if (has_fragment_op) {
+      // Fragment intrinsics are executed by the whole warp, so the
+      // predicates around them, such as ragged bounds, are evaluated
+      // for the first thread of the warp.
+      auto new_op = stmt.as<IfThenElseNode>();
+      ThreadIdxMutator thread_idx_mutator(IntImm(DataType::Int(32), warp_threads_y_));
+      return IfThenElseNode::make(thread_idx_mutator(new_op->condition), new_op->then_case,
+                                  new_op->else_case);
+    }
+    return stmt;
+  }
+
   Stmt VisitStmt_(const ForNode* op) final {
     Stmt stmt = StmtExprMutator::VisitStmt_(op);
     op = stmt.as<ForNode>();
@@ -957,12 +1002,16 @@ class TensorCoreIRMutator : public StmtExprMutator {
       auto it = loop_scaling_.find(op->loop_var.get());
       if (it != loop_scaling_.end()) {
         int scale_factor = it->second;
-        int scaled_extent_value = 1;
+        PrimExpr scaled_extent;
         if (const IntImmNode* ori_extent = op->extent.as<IntImmNode>()) {
           int ori_extent_value = ori_extent->value;
-          scaled_extent_value = ori_extent_value / scale_factor;
+          scaled_extent = make_const(op->extent.dtype(), ori_extent_value / scale_factor);
+        } else {
+          // A ragged extent: the last, partial tile is computed on
+          // zero-padded data.
+          PrimExpr factor = make_const(op->extent.dtype(), scale_factor);
+          scaled_extent = Simplify(indexdiv(op->extent + factor - 1, factor));
         }
-        PrimExpr scaled_extent = make_const(op->extent.dtype(), scaled_extent_value);
         stmt = ForNode::make(op->loop_var, op->min, scaled_extent, op->for_type, op->device_api,
                              op->body);
       }
@@ -1078,6 +1127,7 @@ class TensorCoreIRMutator : public StmtExprMutator {
   std::unordered_map<const VarNode*, unsigned> loop_scaling_;
   std::unordered_map<const ProvideNode*, PrimExpr> frag_load_;
   std::unordered_map<const ProvideNode*, PrimExpr> frag_store_;
+  std::unordered_set<const Object*> frag_src_;
   std::unordered_map<TensorKey, Region> bounds_;
   Tile warp_tile_;
   int warp_threads_y_{-1};
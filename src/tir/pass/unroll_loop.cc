@@ -22,9 +22,12 @@
  * \file unroll_loop.cc
  */
 // Unrolls the loop as in Halide pipeline.
+#include <tvm/arith/analyzer.h>
 #include <tvm/tir/expr.h>
 #include <tvm/tir/ir_pass.h>
+#include <tvm/tir/op.h>
 #include <tvm/tir/stmt_functor.h>
+#include <tvm/tir/uninterp_fun.h>
 #include <unordered_set>
 #include <unordered_map>
 #include <vector>
@@ -199,6 +202,64 @@ Stmt UnrollLoop(Stmt stmt,
   }
 }
 
+// Unrolls innermost serial loops whose extent is not a constant, but
+// is bounded by a small constant, such as ragged loops whose lengths
+// have a small maximum. The loop becomes that many copies of its
+// body, each guarded by whether the iteration is in the loop.
+class RaggedLoopUnroller : public StmtMutator {
+ public:
+  explicit RaggedLoopUnroller(int max_extent) : max_extent_(max_extent) {}
+
+  Stmt VisitStmt_(const ForNode* op) final {
+    analyzer_.Bind(op->loop_var, Range::make_by_min_extent(op->min, op->extent));
+    Stmt stmt = StmtMutator::VisitStmt_(op);
+    op = stmt.as<ForNode>();
+    if (op->for_type != ForType::Serial || op->extent.as<IntImmNode>()) return stmt;
+    int64_t bound = GetExtentBound(op->extent);
+    if (bound < 0 || bound > max_extent_ || HasLoop(op->body)) return stmt;
+
+    Var extent(op->loop_var->name_hint + ".extent", op->extent.dtype());
+    Map<Var, PrimExpr> vmap;
+    Array<Stmt> unrolled;
+    for (int64_t i = 0; i < bound; ++i) {
+      PrimExpr iter = make_const(op->loop_var.dtype(), i);
+      vmap.Set(op->loop_var, op->min + iter);
+      Stmt step = Substitute(op->body, vmap);
+      unrolled.push_back(IfThenElseNode::make(likely(iter < extent), step));
+    }
+    if (unrolled.size() == 0) return EvaluateNode::make(0);
+    return LetStmtNode::make(extent, op->extent, SeqStmt::Flatten(unrolled));
+  }
+
+ private:
+  // The constant upper bound of an extent, or -1 if it has none.
+  int64_t GetExtentBound(const PrimExpr& extent) {
+    PrimExpr relaxed = Simplify(UninterpFun::InlineUninterpFunCalls(
+        UninterpFun::RelaxUninterpCallsMaxInclusive(extent, false)));
+    auto bound = analyzer_.const_int_bound(relaxed);
+    if (bound->max_value == arith::ConstIntBound::kPosInf) return -1;
+    return std::max<int64_t>(bound->max_value, 0);
+  }
+
+  static bool HasLoop(const Stmt& body) {
+    bool found = false;
+    PostOrderVisit(body, [&found](const ObjectRef& node) { found |= node->IsInstance<ForNode>(); });
+    return found;
+  }
+
+  int max_extent_;
+  arith::Analyzer analyzer_;
+};
+
+Stmt UnrollRaggedLoop(Stmt stmt, int max_extent) {
+  Stmt ret = RaggedLoopUnroller(max_extent)(stmt);
+  if (!ret.same_as(stmt)) {
+    return ConvertSSA(ret);
+  } else {
+    return ret;
+  }
+}
+
 Stmt UnrollLoopExplicitly(Stmt stmt) {
   const ForNode* op = stmt.as<ForNode>();
   if (!op) {
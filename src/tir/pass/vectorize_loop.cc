@@ -460,13 +460,82 @@ class LoopVectorizer : public StmtMutator {
       int lanes = 0;
       bool succ = arith::GetConstInt(op->extent, &lanes);
       if (!succ || lanes < 1) {
-        LOG(FATAL) << "Failed to vectorize loop with extent " << op->extent;
+        LOG(FATAL) << "Failed to vectorize loop with extent " << op->extent
+                   << ". Loops with ragged extents can be split by a constant factor and the "
+                   << "inner loop vectorized.";
       }
+      Stmt ragged = VectorizeRaggedBody(op, lanes);
+      if (ragged.defined()) return ragged;
       return Vectorizer(op->loop_var, lanes)(op->body);
     } else {
       return StmtMutator::VisitStmt_(op);
     }
   }
+
+ private:
+  // The inner loop of a ragged loop split by the vector width has its
+  // body guarded by the ragged bound, as in
+  //
+  //   for (i, 0, 4) vectorized
+  //     if (o * 4 + i < l_fun(b)) ...
+  //
+  // which would be scalarized entirely. Instead, this generates a
+  // vector body without the guard, for when all lanes are within the
+  // bound, and keeps the scalar loop as the epilogue for the last,
+  // partial vector. Returns an undefined stmt if the body is not of
+  // this form.
+  Stmt VectorizeRaggedBody(const ForNode* op, int lanes) {
+    auto guard = op->body.as<IfThenElseNode>();
+    if (!guard || guard->else_case.defined() || lanes == 1) return Stmt();
+    if (!ExprUseVar(guard->condition, op->loop_var)) return Stmt();
+    PrimExpr all_lanes = AllLanesCondition(guard->condition, op->loop_var, lanes);
+    if (!all_lanes.defined()) return Stmt();
+    Stmt vector_body = Vectorizer(op->loop_var, lanes)(guard->then_case);
+    Stmt scalar_loop = ForNode::make(op->loop_var, op->min, op->extent, ForType::Serial,
+                                     op->device_api, op->body, op->hfuse_group_id);
+    return IfThenElseNode::make(Simplify(all_lanes), vector_body, scalar_loop);
+  }
+
+  // The condition under which cond holds for all values of var in [0,
+  // lanes), if cond is a conjunction of bounds on var + c, with c
+  // invariant, and of conditions that do not depend on var.
+  static PrimExpr AllLanesCondition(const PrimExpr& cond, const Var& var, int lanes) {
+    if (auto op = cond.as<AndNode>()) {
+      PrimExpr a = AllLanesCondition(op->a, var, lanes);
+      PrimExpr b = AllLanesCondition(op->b, var, lanes);
+      if (!a.defined() || !b.defined()) return PrimExpr();
+      return a && b;
+    }
+    if (auto call = cond.as<CallNode>()) {
+      if (call->is_intrinsic(CallNode::likely)) {
+        return AllLanesCondition(call->args[0], var, lanes);
+      }
+    }
+    if (!ExprUseVar(cond, var)) return cond;
+
+    // Upper bounds hold for all lanes if they hold for the last one,
+    // lower bounds if they hold for the first one.
+    PrimExpr value, bound;
+    bool upper;
+    if (auto op = cond.as<LTNode>()) {
+      value = op->a, bound = op->b, upper = true;
+    } else if (auto op = cond.as<LENode>()) {
+      value = op->a, bound = op->b, upper = true;
+    } else if (auto op = cond.as<GTNode>()) {
+      value = op->a, bound = op->b, upper = false;
+    } else if (auto op = cond.as<GENode>()) {
+      value = op->a, bound = op->b, upper = false;
+    } else {
+      return PrimExpr();
+    }
+    if (ExprUseVar(bound, var)) {
+      std::swap(value, bound);
+      upper = !upper;
+    }
+    if (ExprUseVar(bound, var) || ExprUseVar(Simplify(value - var), var)) return PrimExpr();
+    PrimExpr lane = make_const(var.dtype(), upper ? lanes - 1 : 0);
+    return Substitute(cond, {{var, lane}});
+  }
 };
 
 Stmt VectorizeLoop(Stmt stmt) { return LoopVectorizer()(std::move(stmt)); }
@@ -55,5 +55,25 @@ bool VerifyCompactBuffer(Stmt stmt) {
   return verifier.Verify(stmt);
 }
 
+class BoundTensorCollector : public StmtVisitor {
+ public:
+  void VisitStmt_(const AttrStmtNode* op) final {
+    if (op->attr_key == attr::buffer_bind_scope) {
+      Array<ObjectRef> arr = Downcast<Array<ObjectRef>>(op->node);
+      CHECK_EQ(arr.size(), 2U);
+      tensors.push_back(Downcast<te::Tensor>(arr[1]));
+    }
+    StmtVisitor::VisitStmt_(op);
+  }
+
+  Array<te::Tensor> tensors;
+};
+
+Array<te::Tensor> CompactBufferBoundTensors(Stmt stmt) {
+  BoundTensorCollector collector;
+  collector(stmt);
+  return collector.tensors;
+}
+
 }  // namespace tir
 }  // namespace tvm
@@ -0,0 +1,52 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import tvm
+from tvm.tir import Modes, LFunsWrapper
+
+
+def _dense_layout():
+    dims = [tvm.te.RangeDimension("d0"), tvm.te.RangeDimension("d1")]
+    return Modes.storage_layout(dims, [4, 8], LFunsWrapper(4, 8), {})
+
+
+def _position(layout, coords):
+    return tvm.ir_pass.Simplify(layout.compute_position(coords))
+
+
+def test_compute_position():
+    layout = _dense_layout()
+    i = tvm.var("i")
+    j = tvm.var("j")
+    assert tvm.ir_pass.Equal(_position(layout, [i, j]), tvm.ir_pass.Simplify(i * 8 + j))
+
+
+def test_memoized_position():
+    layout = _dense_layout()
+    i = tvm.var("i")
+    j = tvm.var("j")
+    first = _position(layout, [i, j])
+    # Structurally equal coordinates hit the cached position, and
+    # different ones do not.
+    assert tvm.ir_pass.Equal(_position(layout, [i, j]), first)
+    assert tvm.ir_pass.Equal(_position(layout, [j, i]), tvm.ir_pass.Simplify(j * 8 + i))
+    assert tvm.ir_pass.Equal(_position(layout, [i + 1, j]),
+                             tvm.ir_pass.Simplify((i + 1) * 8 + j))
+
+
+if __name__ == "__main__":
+    test_compute_position()
+    test_memoized_position()
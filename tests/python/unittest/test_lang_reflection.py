@@ -114,7 +114,19 @@ def test_env_func():
     assert x.func(10) == 11
 
 
+def test_saveload_binary_map_keys():
+    # Maps compare keys by address, so equal keys must stay apart.
+    x = tvm.var("x")
+    smap = tvm.convert({x + 1: 1, x + 1: 2, tvm.tir.IntImm("int32", 0): 3,
+                        tvm.tir.IntImm("int32", 0): 4})
+    assert len(smap) == 4
+    loaded = tvm.ir.load_binary(tvm.ir.save_binary(smap))
+    assert len(loaded) == 4
+    assert sorted(v.value for _, v in loaded.items()) == [1, 2, 3, 4]
+
+
 if __name__ == "__main__":
+    test_saveload_binary_map_keys()
     test_env_func()
     test_make_attrs()
     test_make_node()
@@ -0,0 +1,76 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import tvm
+from tvm.driver.build_module import _branch_profile_map
+
+
+def _ragged_tail_func():
+    ib = tvm.ir_builder.create()
+    n = tvm.size_var("n")
+    Ab = tvm.decl_buffer((n,), "float32", name="A")
+    A = ib.buffer_ptr(Ab)
+    with ib.for_range(0, n, name="i") as i:
+        with ib.if_scope(i < n - 3):
+            A[i] = A[i] + 1.0
+        with ib.else_scope():
+            A[i] = A[i] + 2.0
+    return tvm.ir_pass.MakeAPINoPrepCode(ib.get(), "tail", [], [Ab], 0, True).function
+
+
+def _branches(stmt):
+    probabilities = []
+    ifs = []
+    def _visit(op):
+        if isinstance(op, tvm.tir.AttrStmt) and op.attr_key == "branch_probability":
+            probabilities.append(op.value.value)
+        elif isinstance(op, tvm.tir.IfThenElse):
+            ifs.append(op)
+    tvm.ir_pass.PostOrderVisit(stmt, _visit)
+    return probabilities, ifs
+
+
+def test_branch_profile_map():
+    profile = _branch_profile_map({0: 0.25})
+    assert isinstance(profile, dict)
+    key, value = list(profile.items())[0]
+    assert isinstance(key, tvm.tir.IntImm) and key.value == 0
+    assert isinstance(value, tvm.tir.FloatImm) and value.value == 0.25
+
+
+def test_profiled_branch_layout():
+    func = tvm.ir_pass.BetterHoistIfThenElse(_ragged_tail_func(), "cuda", [],
+                                             _branch_profile_map({0: 0.1}))
+    probabilities, ifs = _branches(func.body)
+    # The rarely taken then case becomes the else case.
+    assert len(probabilities) == 1
+    assert abs(probabilities[0] - 0.9) < 1e-6
+    assert len(ifs) == 1
+    assert isinstance(ifs[0].condition, tvm.tir.Not)
+
+
+def test_unprofiled_branch():
+    func = tvm.ir_pass.BetterHoistIfThenElse(_ragged_tail_func(), "cuda", [])
+    probabilities, ifs = _branches(func.body)
+    assert not probabilities
+    assert len(ifs) == 1
+    assert not isinstance(ifs[0].condition, tvm.tir.Not)
+
+
+if __name__ == "__main__":
+    test_branch_profile_map()
+    test_profiled_branch_layout()
+    test_unprofiled_branch()
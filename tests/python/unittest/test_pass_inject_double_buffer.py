@@ -49,5 +49,37 @@ def test_double_buffer():
     assert count[0] == 4
 
 
+def test_async_pipeline_sync():
+    n = 100
+    m = 4
+    tx = tvm.thread_axis("threadIdx.x")
+    ib = tvm.ir_builder.create()
+    A = ib.pointer("float32", name="A")
+    C = ib.pointer("float32", name="C")
+    ib.scope_attr(tx, "thread_extent", m)
+    with ib.for_range(0, n) as i:
+        B = ib.allocate("float32", m, name="B", scope="shared")
+        with ib.new_scope():
+            ib.scope_attr(B.asobject(), "double_buffer_scope", 3)
+            B[tx] = A[i * m + tx]
+        C[i * m + tx] = B[(tx + 1) % m] + 1
+
+    stmt = tvm.ir_pass.InjectDoubleBuffer(ib.get(), 0, True)
+    waits = []
+    def _visit(op):
+        if isinstance(op, tvm.tir.SeqStmt):
+            seq = list(op.seq)
+            for k, s in enumerate(seq):
+                if isinstance(s, tvm.tir.Evaluate) and isinstance(s.value, tvm.tir.Call) and \
+                   s.value.name == "tvm_cp_async_wait_group":
+                    nxt = seq[k + 1] if k + 1 < len(seq) else None
+                    waits.append(isinstance(nxt, tvm.tir.Evaluate) and
+                                 nxt.value.name == "tvm_storage_sync")
+    tvm.ir_pass.PostOrderVisit(stmt, _visit)
+    # Threads read the copies of their neighbors right after the wait.
+    assert waits and all(waits)
+
+
 if __name__ == "__main__":
     test_double_buffer()
+    test_async_pipeline_sync()
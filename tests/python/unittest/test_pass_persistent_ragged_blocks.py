@@ -0,0 +1,71 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import tvm
+
+
+def _fused_kernel(sync):
+    ib = tvm.ir_builder.create()
+    n = tvm.size_var("n")
+    A = ib.pointer("float32", name="A")
+    bx = tvm.thread_axis("blockIdx.x")
+    tx = tvm.thread_axis("threadIdx.x")
+    ib.scope_attr(bx, "thread_extent", n)
+    ib.scope_attr(tx, "thread_extent", 32)
+    A[bx * 32 + tx] = A[bx * 32 + tx] + 1.0
+    barrier = tvm.call_intrin("int32", "tvm_storage_sync", "shared")
+    if sync == "uniform":
+        with ib.if_scope(bx < n - 1):
+            ib.emit(barrier)
+    elif sync == "divergent":
+        with ib.if_scope(tx < 16):
+            ib.emit(barrier)
+    A[bx * 32 + tx] = A[bx * 32 + tx] * 2.0
+    return ib.get()
+
+
+def _is_persistent(stmt):
+    calls = []
+    def _visit(op):
+        if isinstance(op, tvm.tir.Call) and op.name == "atomicAdd":
+            calls.append(op)
+    tvm.ir_pass.PostOrderVisit(stmt, _visit)
+    return len(calls) > 0
+
+
+def test_persistent_blocks():
+    stmt = tvm.ir_pass.PersistentRaggedBlocks(_fused_kernel(None), 80, 1)
+    assert _is_persistent(stmt)
+    stmt = tvm.ir_pass.PersistentRaggedBlocks(_fused_kernel(None), 80, 4)
+    assert _is_persistent(stmt)
+
+
+def test_block_uniform_barrier():
+    # The barrier is under a condition on the block, which becomes a
+    # condition on the chunk, the same for all threads of a block.
+    stmt = tvm.ir_pass.PersistentRaggedBlocks(_fused_kernel("uniform"), 80, 1)
+    assert _is_persistent(stmt)
+
+
+def test_divergent_barrier_kept():
+    stmt = tvm.ir_pass.PersistentRaggedBlocks(_fused_kernel("divergent"), 80, 1)
+    assert not _is_persistent(stmt)
+
+
+if __name__ == "__main__":
+    test_persistent_blocks()
+    test_block_uniform_barrier()
+    test_divergent_barrier_kept()
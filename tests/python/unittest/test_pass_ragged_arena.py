@@ -0,0 +1,58 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import tvm
+
+
+def _allocations(stmt):
+    allocs = []
+    def _visit(op):
+        if isinstance(op, tvm.tir.Allocate):
+            allocs.append(op.buffer_var.name)
+    tvm.ir_pass.PostOrderVisit(stmt, _visit)
+    return allocs
+
+
+def test_plan_arena():
+    ib = tvm.ir_builder.create()
+    n = tvm.size_var("n")
+    C = ib.pointer("float32", name="C")
+    A = ib.allocate("float32", n, name="A", scope="global")
+    B = ib.allocate("float32", n * 2, name="B", scope="global")
+    with ib.for_range(0, n, name="i") as i:
+        A[i] = C[i]
+    with ib.for_range(0, n, name="i") as i:
+        B[i] = C[i] + 1.0
+    stmt = tvm.ir_pass.PlanRaggedArena(ib.get())
+    assert _allocations(stmt) == ["ragged_arena"]
+
+
+def test_loop_dependent_size_kept():
+    ib = tvm.ir_builder.create()
+    n = tvm.size_var("n")
+    C = ib.pointer("float32", name="C")
+    with ib.for_range(0, n, name="i") as i:
+        A = ib.allocate("float32", i + 1, name="A", scope="global")
+        B = ib.allocate("float32", i + 2, name="B", scope="global")
+        A[0] = C[i]
+        B[0] = A[0]
+    stmt = tvm.ir_pass.PlanRaggedArena(ib.get())
+    assert sorted(_allocations(stmt)) == ["A", "B"]
+
+
+if __name__ == "__main__":
+    test_plan_arena()
+    test_loop_dependent_size_kept()
@@ -0,0 +1,73 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import tvm
+
+
+def _scan_kernel(with_sync, length_per_thread):
+    ib = tvm.ir_builder.create()
+    lengths = ib.pointer("int32", name="lengths")
+    A = ib.pointer("float32", name="A")
+    bx = tvm.thread_axis("blockIdx.x")
+    tx = tvm.thread_axis("threadIdx.x")
+    ib.scope_attr(bx, "thread_extent", 16)
+    ib.scope_attr(tx, "thread_extent", 32)
+    length = lengths[bx * 32 + tx] if length_per_thread else lengths[bx]
+    with ib.for_range(0, 64, name="i") as i:
+        with ib.if_scope(i < length):
+            A[(bx * 32 + tx) * 64 + i] = A[(bx * 32 + tx) * 64 + i] + 1.0
+            if with_sync:
+                ib.emit(tvm.call_intrin("int32", "tvm_storage_sync", "shared"))
+    return ib.get()
+
+
+def _loops(stmt):
+    loops = []
+    def _visit(op):
+        if isinstance(op, tvm.tir.For):
+            loops.append(op)
+    tvm.ir_pass.PostOrderVisit(stmt, _visit)
+    return loops
+
+
+def _is_early_exit(stmt):
+    loop = _loops(stmt)[0]
+    return not isinstance(loop.extent, tvm.tir.IntImm) and \
+        not isinstance(loop.body, tvm.tir.IfThenElse)
+
+
+def test_early_exit():
+    stmt = tvm.ir_pass.RaggedScanEarlyExit(_scan_kernel(False, True))
+    assert _is_early_exit(stmt)
+
+
+def test_divergent_barrier_kept():
+    # Threads with shorter sequences would skip barriers the others
+    # wait at.
+    stmt = tvm.ir_pass.RaggedScanEarlyExit(_scan_kernel(True, True))
+    assert not _is_early_exit(stmt)
+
+
+def test_uniform_barrier():
+    # All threads of a block share the length, so they leave together.
+    stmt = tvm.ir_pass.RaggedScanEarlyExit(_scan_kernel(True, False))
+    assert _is_early_exit(stmt)
+
+
+if __name__ == "__main__":
+    test_early_exit()
+    test_divergent_barrier_kept()
+    test_uniform_barrier()
@@ -71,6 +71,37 @@ def test_fp16_conversion():
 
         tvm.testing.assert_allclose(expected, real)
 
+
+def test_ragged_row_view():
+    rows = [np.arange(3, dtype="float32"), np.arange(1, dtype="float32")]
+    ragged = tvm.nd.ragged_array(rows)
+    for i, row in enumerate(rows):
+        np.testing.assert_equal(ragged.sequence(i).asnumpy(), row)
+    # The dense shape fits a view this long, but it runs past the end
+    # of the first row.
+    try:
+        ragged.data.create_offset_view(0, (4,), int(ragged.offsets[1]))
+        assert False
+    except tvm.error.TVMError:
+        pass
+
+
+def test_ragged_from_dlpack():
+    values = tvm.nd.array(np.arange(4, dtype="float32"))
+    offsets = tvm.nd.array(np.array([0, 3, 4], dtype="int64"))
+    ragged = tvm.nd.ragged_from_dlpack(values.to_dlpack(), offsets.to_dlpack())
+    np.testing.assert_equal(ragged.sequence(0).asnumpy(), [0, 1, 2])
+    # Rows past the end of the values are rejected.
+    offsets = tvm.nd.array(np.array([0, 3, 6], dtype="int64"))
+    try:
+        tvm.nd.ragged_from_dlpack(values.to_dlpack(), offsets.to_dlpack())
+        assert False
+    except tvm.error.TVMError:
+        pass
+
+
 if __name__ == "__main__":
     test_nd_create()
     test_fp16_conversion()
+    test_ragged_row_view()
+    test_ragged_from_dlpack()
@@ -0,0 +1,69 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import ctypes
+import tvm
+import numpy as np
+
+
+def _lookup(aux_data, lengths):
+    lookup = tvm.get_global_func("__tvm_prep_code_cache_lookup")
+    return lookup("f", 1, aux_data, lengths.ctypes.data_as(ctypes.c_void_p),
+                  lengths.nbytes)
+
+
+def test_cache_hit():
+    tvm.runtime.clear_prep_code_cache()
+    aux = tvm.nd.empty((16,), "int32")
+    aux_data = ctypes.c_void_p(aux.handle.contents.data)
+    lengths = np.array([1, 2, 3], dtype="int32")
+    assert _lookup(aux_data, lengths) == 0
+    assert _lookup(aux_data, lengths) == 1
+    lengths[0] = 4
+    assert _lookup(aux_data, lengths) == 0
+    assert tvm.runtime.get_prep_code_cache_stats() == (1, 2)
+
+
+def test_freed_buffer_forgotten():
+    tvm.runtime.clear_prep_code_cache()
+    aux = tvm.nd.empty((16,), "int32")
+    aux_data = ctypes.c_void_p(aux.handle.contents.data)
+    lengths = np.array([1, 2, 3], dtype="int32")
+    assert _lookup(aux_data, lengths) == 0
+    del aux
+    # A buffer allocated at the same address holds none of the results.
+    assert _lookup(aux_data, lengths) == 0
+
+
+def test_patch_ragged_prefix_sum():
+    lengths = np.array([3, 1, 4, 1, 5], dtype="int32")
+    # The array sits after two other elements of the buffer.
+    aux_np = np.zeros((2 + len(lengths) + 1,), dtype="int32")
+    aux_np[2:] = np.concatenate([[0], np.cumsum(lengths)])
+    aux = tvm.nd.array(aux_np)
+    lengths[1] += 2
+    lengths[3] -= 1
+    rows = tvm.nd.array(np.array([3, 1], dtype="int32"))
+    tvm.runtime.patch_ragged_prefix_sum(aux, 2, len(lengths), rows,
+                                        tvm.nd.array(lengths))
+    expected = np.concatenate([[0], np.cumsum(lengths)])
+    np.testing.assert_equal(aux.asnumpy()[2:], expected)
+
+
+if __name__ == "__main__":
+    test_cache_hit()
+    test_freed_buffer_forgotten()
+    test_patch_ragged_prefix_sum()
@@ -27,12 +27,14 @@ from .depthwise_conv2d import schedule_depthwise_conv2d_backward_input_nhwc
 from .depthwise_conv2d import schedule_depthwise_conv2d_backward_weight_nhwc
 from .group_conv2d_nchw import schedule_conv2d_nchw_cuda
 from .reduction import schedule_reduce
-from .softmax import schedule_softmax
+from .softmax import schedule_softmax, schedule_ragged_softmax
 from .injective import schedule_injective, schedule_elemwise, schedule_broadcast
 from .dense import schedule_dense
 from .pooling import schedule_pool, schedule_adaptive_pool
-from .nn import schedule_lrn
-from .batch_matmul import schedule_batch_matmul
+from .nn import schedule_lrn, schedule_ragged_layer_norm, schedule_ragged_attention, \
+    schedule_ragged_embedding_bag
+from .batch_matmul import schedule_batch_matmul, schedule_ragged_batch_matmul
+from .sparse import schedule_sparse_ragged
 from .vision import *
 from . import ssd
 from .ssd import *
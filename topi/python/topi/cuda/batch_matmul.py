@@ -21,7 +21,9 @@ import tvm
 from tvm.contrib import cublas
 from topi.nn import batch_matmul, batch_matmul_default
 from .. import generic
+from ..nn.util import ragged_mode, ragged_mode_tiled
 from ..util import traverse_inline, get_const_tuple, get_max_power2_factor
+from .injective import schedule_injective_from_existing
 
 @batch_matmul.register(["cuda", "gpu"])
 def batch_matmul_cuda(x, y):
@@ -134,3 +136,37 @@ def schedule_batch_matmul(outs):
 
     traverse_inline(s, outs[0].op, _callback)
     return s
+
+
+@generic.schedule_ragged_batch_matmul.register(["cuda", "gpu"])
+def schedule_ragged_batch_matmul(outs):
+    """Schedule for ragged_batch_matmul
+
+    The spatial axes are fused and split over blocks and threads, and
+    each thread runs the ragged reduction of its row serially, which is
+    empty on the padded rows.
+
+    Parameters
+    ----------
+    outs: Array of Tensor
+          The computation graph description of ragged_batch_matmul
+          in the format of an array of tensors.
+
+    Returns
+    -------
+    s: Schedule
+        The computation schedule for the op.
+    """
+    outs = [outs] if isinstance(outs, tvm.tensor.Tensor) else outs
+    s = tvm.create_schedule([x.op for x in outs])
+    tvm.schedule.AutoInlineInjective(s)
+    for out in outs:
+        s = schedule_injective_from_existing(s, out)
+    return s
+
+
+@ragged_mode.register(["cuda", "gpu"])
+def _ragged_mode_cuda(lengths, extent, dtype):  # pylint: disable=unused-argument
+    # Round the ragged loops up to whole warps, so that the threads of a
+    # warp do not diverge on the lengths.
+    return ragged_mode_tiled(lengths, extent, 32)
@@ -306,3 +306,46 @@ def schedule_conv1d_nwc(cfg, outs):
     traverse_inline(s, outs[0].op, _callback)
 
     return s
+
+
+@generic.schedule_ragged_conv1d_nwc.register(["cuda", "gpu"])
+def schedule_ragged_conv1d_nwc(outs):
+    """Schedule for ragged_conv1d_nwc on cuda gpu
+
+    The batch and ragged width loops are fused into one loop over the
+    packed positions, which is tiled regardless of where sequences end.
+    Every position bounds its window by its own sequence, so tiles that
+    span a boundary read nothing from the neighboring sequence. Threads
+    take output channels, reading the kernel coalesced, and each
+    computes a tile of positions.
+
+    Parameters
+    ----------
+    outs : Array of Tensor
+        The computation graph description of ragged_conv1d_nwc
+        in the format of an array of tensors.
+
+    Returns
+    -------
+    s : Schedule
+        The computation schedule for ragged_conv1d_nwc.
+    """
+    outs = [outs] if isinstance(outs, tvm.tensor.Tensor) else outs
+    s = tvm.create_schedule([x.op for x in outs])
+    conv = outs[0]
+    if conv.op.tag != 'ragged_conv1d':
+        raise ValueError('Tag is expected to be ragged_conv1d. Got {0}'.format(conv.op.tag))
+    num_thread = 32
+    pos_tile = 4
+
+    b, w, c = s[conv].op.axis
+    rc, rw = s[conv].op.reduce_axis
+    fused = s[conv].fuse(b, w)
+    fo, fi = s[conv].split(fused, factor=pos_tile)
+    co, ci = s[conv].split(c, factor=num_thread)
+    s[conv].reorder(fo, co, ci, fi, rc, rw)
+    s[conv].bind(fo, tvm.thread_axis("blockIdx.x"))
+    s[conv].bind(co, tvm.thread_axis("blockIdx.y"))
+    s[conv].bind(ci, tvm.thread_axis("threadIdx.x"))
+    s[conv].unroll(rw)
+    return s
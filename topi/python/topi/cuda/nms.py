@@ -23,7 +23,8 @@ import tvm
 from tvm import api
 from tvm.generic import cast
 from tvm.intrin import if_then_else, log, power
-from topi.vision import non_max_suppression, get_valid_counts
+from topi.vision import non_max_suppression, get_valid_counts, ragged_non_max_suppression
+from topi.vision.nms import ragged_sort_boxes, ragged_box_iou
 from .sort import argsort
 from .. import tag
 
@@ -675,6 +676,37 @@ def invalid_to_bottom_ir(data, flag, idx, out):
     return ib.get()
 
 
+def _invalid_to_bottom(out):
+    """Move the valid boxes of each image of the nms output to the top."""
+    score_shape = (out.shape[0], out.shape[1])
+    valid_count_dtype = "int32"
+    out_buf = api.decl_buffer(
+        out.shape, out.dtype, "out_buf", data_alignment=8)
+    output_buf = api.decl_buffer(
+        out.shape, out.dtype, "output_buf", data_alignment=8)
+    temp_flag_buf = api.decl_buffer(
+        score_shape, valid_count_dtype, "temp_flag", data_alignment=8)
+    temp_idx_buf = api.decl_buffer(
+        score_shape, valid_count_dtype, "temp_idx", data_alignment=8)
+    temp_flag, temp_idx = tvm.extern([score_shape, score_shape], [out],
+                                     lambda ins, outs: invalid_to_bottom_pre(
+                                         ins[0], outs[0], outs[1]),
+                                     dtype=["int32", "int32"],
+                                     in_buffers=[out_buf],
+                                     out_buffers=[temp_flag_buf, temp_idx_buf],
+                                     name="invalid_to_bottom_phase_one")
+
+    output = tvm.extern([out.shape], [out, temp_flag, temp_idx],
+                        lambda ins, outs: invalid_to_bottom_ir(
+                            ins[0], ins[1], ins[2], outs[0]),
+                        dtype=[out.dtype],
+                        in_buffers=[out_buf, temp_flag_buf, temp_idx_buf],
+                        out_buffers=[output_buf],
+                        name="invalid_to_bottom",
+                        tag="invalid_to_bottom")
+    return output
+
+
 @non_max_suppression.register(["cuda", "gpu"])
 def non_max_suppression_gpu(data, valid_count, max_output_size=-1,
                             iou_threshold=0.5, force_suppress=False, top_k=-1,
@@ -765,9 +797,6 @@ def non_max_suppression_gpu(data, valid_count, max_output_size=-1,
     data_buf = api.decl_buffer(
         data.shape, data.dtype, "data_buf", data_alignment=8)
 
-    out_buf = api.decl_buffer(
-        data.shape, data.dtype, "out_buf", data_alignment=8)
-
     out, box_indices = \
         tvm.extern([data.shape, score_shape],
                    [data, sort_tensor, valid_count],
@@ -784,28 +813,224 @@ def non_max_suppression_gpu(data, valid_count, max_output_size=-1,
         return box_indices
 
     if invalid_to_bottom:
-        output_buf = api.decl_buffer(
-            data.shape, data.dtype, "output_buf", data_alignment=8)
-        temp_flag_buf = api.decl_buffer(
-            score_shape, valid_count_dtype, "temp_flag", data_alignment=8)
-        temp_idx_buf = api.decl_buffer(
-            score_shape, valid_count_dtype, "temp_idx", data_alignment=8)
-        temp_flag, temp_idx = tvm.extern([score_shape, score_shape], [out],
-                                         lambda ins, outs: invalid_to_bottom_pre(
-                                             ins[0], outs[0], outs[1]),
-                                         dtype=["int32", "int32"],
-                                         in_buffers=[out_buf],
-                                         out_buffers=[temp_flag_buf, temp_idx_buf],
-                                         name="invalid_to_bottom_phase_one")
-
-        output = tvm.extern([data.shape], [out, temp_flag, temp_idx],
-                            lambda ins, outs: invalid_to_bottom_ir(
-                                ins[0], ins[1], ins[2], outs[0]),
-                            dtype=[data.dtype],
-                            in_buffers=[out_buf, temp_flag_buf, temp_idx_buf],
-                            out_buffers=[output_buf],
-                            name="invalid_to_bottom",
-                            tag="invalid_to_bottom")
-        return output
+        return _invalid_to_bottom(out)
+
+    return out
+
+
+def ragged_nms_ir(sorted_data, sorted_index, iou, valid_count, out, box_indices,
+                  max_output_size, iou_threshold, top_k, id_index, score_index):
+    """Low level IR routing for the suppression of ragged non-maximum
+    suppression. One block per image walks its boxes in score order and
+    its threads suppress, in parallel, the later boxes overlapping a kept
+    one, reading the precomputed IoU.
+
+    Parameters
+    ----------
+    sorted_data : Buffer
+        Buffer of boxes sorted by score.
+
+    sorted_index : Buffer
+        Buffer of box indexes sorted by score.
+
+    iou : Buffer
+        Buffer of the IoU of the sorted boxes.
+
+    valid_count : Buffer
+        Buffer of number of valid boxes.
+
+    out : Buffer
+        Output buffer.
+
+    box_indices : Buffer
+        Output buffer of the kept box indexes.
+
+    max_output_size : int
+        Max number of output valid boxes for each instance.
+
+    iou_threshold : float
+        Overlapping(IoU) threshold to suppress object with smaller score.
+
+    top_k : int
+        Keep maximum top k detections before nms, -1 for no limit.
+
+    id_index : int
+        index of the class categories, -1 to disable.
+
+    score_index : int
+        Index of the scores/confidence of boxes.
+
+    Returns
+    -------
+    stmt : Stmt
+        The result IR statement.
+    """
+    batch_size = sorted_data.shape[0]
+    num_anchors = sorted_data.shape[1]
+    box_data_length = sorted_data.shape[2]
+
+    ib = tvm.ir_builder.create()
+
+    sorted_data = ib.buffer_ptr(sorted_data)
+    sorted_index = ib.buffer_ptr(sorted_index)
+    iou = ib.buffer_ptr(iou)
+    valid_count = ib.buffer_ptr(valid_count)
+    out = ib.buffer_ptr(out)
+    box_indices = ib.buffer_ptr(box_indices)
+    num_valid_boxes = ib.allocate("int32", (1,), name="num_valid_boxes", scope="local")
+
+    max_threads = int(
+        tvm.target.Target.current(allow_none=False).max_num_threads)
+    tx = tvm.thread_axis("threadIdx.x")
+    bx = tvm.thread_axis("blockIdx.x")
+    ib.scope_attr(tx, "thread_extent", max_threads)
+    ib.scope_attr(bx, "thread_extent", batch_size)
+    i = bx
+    nkeep = valid_count[i]
+    if top_k > 0:
+        nkeep = tvm.min(nkeep, top_k)
+
+    def _sync():
+        ib.emit(tvm.make.Call(None, 'tvm_storage_sync',
+                              tvm.convert(['shared']),
+                              tvm.expr.Call.Intrinsic, None, 0))
+
+    def _suppress(j, remove_box):
+        offset_j = (i * num_anchors + j) * box_data_length
+        if remove_box:
+            with ib.for_range(0, box_data_length) as k:
+                out[offset_j + k] = -1.0
+        else:
+            out[offset_j + score_index] = -1.0
+            if id_index >= 0:
+                out[offset_j + id_index] = -1.0
+        box_indices[i * num_anchors + j] = -1
+
+    # Copy the sorted boxes and clear the rest.
+    with ib.for_range(0, (num_anchors + max_threads - 1) // max_threads) as t:
+        j = t * max_threads + tx
+        with ib.if_scope(j < num_anchors):
+            offset_j = (i * num_anchors + j) * box_data_length
+            with ib.if_scope(j < nkeep):
+                with ib.for_range(0, box_data_length) as k:
+                    out[offset_j + k] = sorted_data[offset_j + k]
+                box_indices[i * num_anchors + j] = sorted_index[i * num_anchors + j]
+            with ib.else_scope():
+                _suppress(j, True)
+    _sync()
+
+    # Walk the boxes in score order. The conditions are the same in all
+    # threads, which sync after every box.
+    num_valid_boxes[0] = 0
+    with ib.for_range(0, nkeep) as j:
+        offset_j = (i * num_anchors + j) * box_data_length
+        alive = out[offset_j + score_index] > 0
+        if id_index >= 0:
+            alive = tvm.all(alive, out[offset_j + id_index] >= 0)
+        def _keep():
+            num_valid_boxes[0] += 1
+            with ib.for_range(0, (num_anchors + max_threads - 1) // max_threads) as t:
+                k = t * max_threads + tx
+                with ib.if_scope(tvm.all(k > j, k < nkeep)):
+                    with ib.if_scope(iou[(i * num_anchors + j) * num_anchors + k] >=
+                                     iou_threshold):
+                        _suppress(k, False)
+
+        with ib.if_scope(alive):
+            if max_output_size > 0:
+                # Boxes past max_output_size are dropped, so they need not
+                # suppress others.
+                with ib.if_scope(num_valid_boxes[0] >= max_output_size):
+                    with ib.if_scope(tx == 0):
+                        _suppress(j, True)
+                with ib.else_scope():
+                    _keep()
+            else:
+                _keep()
+        _sync()
+
+    return ib.get()
+
+
+@ragged_non_max_suppression.register(["cuda", "gpu"])
+def ragged_non_max_suppression_gpu(data, valid_count, max_output_size=-1,
+                                   iou_threshold=0.5, force_suppress=False, top_k=-1,
+                                   coord_start=2, score_index=1, id_index=0,
+                                   return_indices=True, invalid_to_bottom=False):
+    """Ragged non-maximum suppression on GPU. The arguments and outputs are
+    those of topi.vision.ragged_non_max_suppression. Unlike
+    non_max_suppression_gpu, which runs the images one after the other
+    over num_anchors threads, images run in parallel blocks and only visit
+    their valid boxes.
+
+    Parameters
+    ----------
+    data : tvm.Tensor
+        3-D tensor with shape [batch_size, num_anchors, elem_length].
+
+    valid_count : tvm.Tensor
+        1-D tensor for valid number of boxes.
+
+    max_output_size : optional, int
+        Max number of output valid boxes for each instance.
+        By default all valid boxes are returned.
+
+    iou_threshold : optional, float
+        Non-maximum suppression threshold.
+
+    force_suppress : optional, boolean
+        Whether to suppress all detections regardless of class_id.
+
+    top_k : optional, int
+        Keep maximum top k detections before nms, -1 for no limit.
+
+    coord_start : required, int
+        Start index of the consecutive 4 coordinates.
+
+    score_index : optional, int
+        Index of the scores/confidence of boxes.
+
+    id_index : optional, int
+        index of the class categories, -1 to disable.
+
+    return_indices : boolean
+        Whether to return box indices in input data.
+
+    invalid_to_bottom : optional, boolean
+        Whether to move all valid bounding boxes to the top.
+
+    Returns
+    -------
+    out : tvm.Tensor
+        3-D tensor with shape [batch_size, num_anchors, elem_length].
+    """
+    assert iou_threshold > 0, "ragged_non_max_suppression needs a positive iou_threshold"
+    batch_size, num_anchors, _ = data.shape
+    sorted_data, sorted_index = ragged_sort_boxes(data, valid_count, top_k, score_index)
+    iou = ragged_box_iou(sorted_data, valid_count, top_k, coord_start, id_index,
+                         force_suppress)
+
+    in_buffers = [api.decl_buffer(t.shape, t.dtype, name, data_alignment=8)
+                  for t, name in [(sorted_data, "sorted_data_buf"),
+                                  (sorted_index, "sorted_index_buf"),
+                                  (iou, "iou_buf")]]
+    in_buffers.append(api.decl_buffer(valid_count.shape, "int32",
+                                      "valid_count_buf", data_alignment=4))
+    out, box_indices = \
+        tvm.extern([data.shape, (batch_size, num_anchors)],
+                   [sorted_data, sorted_index, iou, valid_count],
+                   lambda ins, outs: ragged_nms_ir(
+                       ins[0], ins[1], ins[2], ins[3], outs[0], outs[1],
+                       max_output_size, iou_threshold, top_k, id_index, score_index),
+                   dtype=[data.dtype, "int32"],
+                   in_buffers=in_buffers,
+                   name="ragged_nms",
+                   tag="ragged_nms")
+
+    if return_indices:
+        return box_indices
+
+    if invalid_to_bottom:
+        return _invalid_to_bottom(out)
 
     return out
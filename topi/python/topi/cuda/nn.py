@@ -21,6 +21,7 @@ from __future__ import absolute_import as _abs
 import tvm
 from .. import generic
 from .. import cpp
+from .injective import schedule_injective_from_existing
 
 @generic.schedule_lrn.register(["cuda"])
 def schedule_lrn(outs):
@@ -40,3 +41,115 @@ def schedule_lrn(outs):
     target = tvm.target.Target.current(allow_none=False)
     cpp_target = cpp.TEST_create_target(target.target_name)
     return cpp.cuda.schedule_lrn(cpp_target, outs)
+
+
+@generic.schedule_ragged_layer_norm.register(["cuda", "gpu"])
+def schedule_ragged_layer_norm(outs):
+    """Schedule for ragged_layer_norm
+
+    Each stage is fused and split over blocks and threads. The mean and
+    variance reductions of a row run serially in its thread, and are
+    empty on the padded rows.
+
+    Parameters
+    ----------
+    outs: Array of Tensor
+          The computation graph description of ragged_layer_norm
+          in the format of an array of tensors.
+
+    Returns
+    -------
+    sch: Schedule
+        The computation schedule for the op.
+    """
+    outs = [outs] if isinstance(outs, tvm.tensor.Tensor) else outs
+    s = tvm.create_schedule([x.op for x in outs])
+    norm = outs[0]
+    tvm.schedule.AutoInlineInjective(s)
+    stages = {t.op.name: t for t in norm.op.input_tensors}
+    var = stages['T_ragged_layer_norm_var']
+    mean = stages['T_ragged_layer_norm_mean']
+    for op in [mean.op, var.op, norm.op]:
+        s = schedule_injective_from_existing(s, op.output(0))
+    return s
+
+
+@generic.schedule_ragged_attention.register(["cuda", "gpu"])
+def schedule_ragged_attention(outs):
+    """Schedule for ragged_attention
+
+    The scores, the stages of the softmax and the weighted sum are each
+    fused and split over blocks and threads, with their ragged
+    reductions run serially in each thread. The probabilities are kept
+    in memory rather than recomputed for every value column.
+
+    Parameters
+    ----------
+    outs: Array of Tensor
+          The computation graph description of ragged_attention
+          in the format of an array of tensors.
+
+    Returns
+    -------
+    sch: Schedule
+        The computation schedule for the op.
+    """
+    outs = [outs] if isinstance(outs, tvm.tensor.Tensor) else outs
+    s = tvm.create_schedule([x.op for x in outs])
+    out = outs[0]
+    prob = {t.op.name: t for t in out.op.input_tensors}['T_ragged_softmax_norm']
+    stages = {t.op.name: t for t in prob.op.input_tensors}
+    for name in ['T_ragged_attention_score', 'T_ragged_softmax_maxelem',
+                 'T_ragged_softmax_expsum']:
+        s = schedule_injective_from_existing(s, stages[name])
+    for tensor in [prob, out]:
+        s = schedule_injective_from_existing(s, tensor)
+    return s
+
+
+@generic.schedule_ragged_embedding_bag.register(["cuda", "gpu"])
+def schedule_ragged_embedding_bag(outs):
+    """Schedule for ragged_embedding_bag
+
+    Blocks own whole bags, so no two blocks write the same output and no
+    atomics are needed. For embeddings at least a warp wide, threads take
+    columns of a bag, reading the gathered rows coalesced, and reduce
+    their column over the bag in registers. Narrower embeddings reduce
+    each bag column across a warp instead.
+
+    Parameters
+    ----------
+    outs: Array of Tensor
+          The computation graph description of ragged_embedding_bag
+          in the format of an array of tensors.
+
+    Returns
+    -------
+    sch: Schedule
+        The computation schedule for the op.
+    """
+    outs = [outs] if isinstance(outs, tvm.tensor.Tensor) else outs
+    s = tvm.create_schedule([x.op for x in outs])
+    out = outs[0]
+    tvm.schedule.AutoInlineInjective(s)
+    bag = {t.op.name: t for t in out.op.input_tensors}['T_ragged_embedding_bag_reduce']
+    num_thread = 32
+    block_x = tvm.thread_axis("blockIdx.x")
+    thread_x = tvm.thread_axis("threadIdx.x")
+
+    dim = bag.shape[1]
+    if isinstance(dim, tvm.expr.IntImm) and dim.value < num_thread:
+        fused = s[bag].fuse(*s[bag].op.axis)
+        ko, ki = s[bag].split(s[bag].op.reduce_axis[0], factor=num_thread)
+        s[bag].bind(fused, block_x)
+        s[bag].bind(ki, thread_x)
+        s[bag].set_store_predicate(thread_x.var.equal(0))
+        return schedule_injective_from_existing(s, out)
+
+    b, j = s[out].op.axis
+    jo, ji = s[out].split(j, factor=num_thread)
+    fused = s[out].fuse(b, jo)
+    s[out].bind(fused, block_x)
+    s[out].bind(ji, thread_x)
+    s[bag].compute_at(s[out], ji)
+    return s
@@ -80,3 +80,38 @@ def schedule_softmax(outs):
         s[softmax].bind(tx, thread_x)
 
     return s
+
+
+@generic.schedule_ragged_softmax.register(["cuda", "gpu"])
+def schedule_ragged_softmax(outs):
+    """Schedule for ragged_softmax op.
+
+    The spatial axes of every stage have constant extents, so each stage
+    is fused and split over blocks and threads. The ragged reductions
+    run serially in their thread, over the valid length only. Injective
+    producers fused into the op are inlined.
+
+    Parameters
+    ----------
+    outs: Array of Tensor
+          The computation graph description of ragged_softmax in the
+          format of an array of tensors.
+
+    Returns
+    -------
+    sch: Schedule
+        The computation schedule for the op.
+    """
+    outs = [outs] if isinstance(outs, tvm.tensor.Tensor) else outs
+    s = tvm.create_schedule([x.op for x in outs])
+    softmax = outs[0]
+    if softmax.op.tag != 'ragged_softmax_output':
+        raise ValueError('Tag is expected to be ragged_softmax_output. \
+                         Got {0}'.format(softmax.op.tag))
+    tvm.schedule.AutoInlineInjective(s)
+    stages = {t.op.name: t for t in softmax.op.input_tensors}
+    max_elem = stages['T_ragged_softmax_maxelem']
+    expsum = stages['T_ragged_softmax_expsum']
+    for op in [max_elem.op, expsum.op, softmax.op]:
+        s = schedule_injective_from_existing(s, op.output(0))
+    return s
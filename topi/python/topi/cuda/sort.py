@@ -19,9 +19,9 @@
 import tvm
 
 from tvm import api
-from ..sort import argsort, topk
+from ..sort import argsort, topk, segmented_argsort, segmented_topk
 from ..math import identity
-from ..transform import strided_slice
+from ..transform import strided_slice, reshape
 from .. import generic
 from .. import tag
 
@@ -405,3 +405,177 @@ def schedule_topk(outs):
       The computation schedule for the op.
     """
     return _schedule_sort(outs)
+
+
+def segmented_sort_ir(data, offsets, values_out, indices_out, is_ascend):
+    """Low level IR to sort each segment [offsets[i], offsets[i + 1]) of the
+    flattened data on the GPU, same usage as tvm.contrib.sort.segmented_argsort
+    on the CPU. Each segment is sorted by a thread block, so that the work
+    follows the segment lengths rather than a padded extent.
+
+    Parameters
+    ----------
+    data: Buffer
+        Buffer of input data.
+
+    offsets: Buffer
+        1-D buffer of num_segments + 1 offsets into the flattened data.
+
+    values_out : Buffer
+        Output buffer of the sorted data, with the same shape as data.
+
+    indices_out : Buffer
+        Output buffer of the indices local to the segments of the sorted
+        data, with the same shape as data.
+
+    is_ascend : Boolean
+        Whether to sort in ascending or descending order.
+
+    Returns
+    -------
+    stmt : Stmt
+        The result IR statement.
+    """
+    max_threads = int(tvm.target.Target.current(allow_none=False).max_num_threads)
+    num_segments = offsets.shape[0] - 1
+    ib = tvm.ir_builder.create()
+    data = ib.buffer_ptr(data)
+    offsets = ib.buffer_ptr(offsets)
+    values_out = ib.buffer_ptr(values_out)
+    indices_out = ib.buffer_ptr(indices_out)
+    idxd = tvm.indexdiv
+    idxm = tvm.indexmod
+
+    tx = tvm.thread_axis("threadIdx.x")
+    bx = tvm.thread_axis("blockIdx.x")
+    ib.scope_attr(tx, "thread_extent", max_threads)
+    ib.scope_attr(bx, "thread_extent", num_segments)
+    begin = tvm.generic.cast(offsets[bx], "int32")
+    num = tvm.generic.cast(offsets[bx + 1], "int32") - begin
+    temp_data = ib.allocate(values_out.dtype, (1,), name="temp_data", scope="local")
+    temp_index = ib.allocate(indices_out.dtype, (1,), name="temp_index", scope="local")
+
+    with ib.for_range(0, idxd(num + max_threads - 1, max_threads)) as i:
+        idx = i * max_threads + tx
+        with ib.if_scope(idx < num):
+            values_out[begin + idx] = data[begin + idx]
+            indices_out[begin + idx] = tvm.generic.cast(idx, indices_out.dtype)
+    ib.emit(tvm.make.Call(None, 'tvm_storage_sync',
+                          tvm.convert(['shared']),
+                          tvm.expr.Call.Intrinsic, None, 0))
+
+    # OddEvenTransposeSort, by pairs of max_threads at a time.
+    num_pairs = idxd(num + 1, 2)
+    with ib.for_range(0, num) as k:
+        with ib.for_range(0, idxd(num_pairs + max_threads - 1, max_threads)) as i:
+            pos = 2 * (i * max_threads + tx) + idxm(k, 2)
+            offset = begin + pos
+            if is_ascend:
+                cond = tvm.all(pos + 1 < num, values_out[offset] > values_out[offset + 1])
+            else:
+                cond = tvm.all(pos + 1 < num, values_out[offset] < values_out[offset + 1])
+            with ib.if_scope(cond):
+                temp_data[0] = values_out[offset]
+                values_out[offset] = values_out[offset + 1]
+                values_out[offset + 1] = temp_data[0]
+                temp_index[0] = indices_out[offset]
+                indices_out[offset] = indices_out[offset + 1]
+                indices_out[offset + 1] = temp_index[0]
+        ib.emit(tvm.make.Call(None, 'tvm_storage_sync',
+                              tvm.convert(['shared']),
+                              tvm.expr.Call.Intrinsic, None, 0))
+
+    return ib.get()
+
+
+def _segmented_sort(data, offsets, is_ascend, dtype, name):
+    value_buf = api.decl_buffer(data.shape, data.dtype, "value_buf", data_alignment=8)
+    indices_buf = api.decl_buffer(data.shape, dtype, "indices_buf", data_alignment=8)
+    return tvm.extern([data.shape, data.shape],
+                      [data, offsets],
+                      lambda ins, outs: segmented_sort_ir(
+                          ins[0], ins[1], outs[0], outs[1], is_ascend),
+                      out_buffers=[value_buf, indices_buf],
+                      name=name,
+                      tag=name)
+
+@segmented_argsort.register(["cuda", "gpu"])
+def segmented_argsort_gpu(data, offsets, is_ascend=1, dtype="int32"):
+    """Sorts each segment [offsets[i], offsets[i + 1]) of the flattened data.
+
+    Parameters
+    ----------
+    data: tvm.Tensor
+        The input array.
+
+    offsets : tvm.Tensor
+        1-D tensor of num_segments + 1 offsets into the flattened data.
+
+    is_ascend : boolean, optional
+        Whether to sort in ascending or descending order.
+
+    dtype : string, optional
+        DType of the output indices.
+
+    Returns
+    -------
+    out : tvm.Tensor
+        The indices local to the segments of the sorted data.
+    """
+    return _segmented_sort(data, offsets, is_ascend, dtype, "segmented_argsort_gpu")[1]
+
+@segmented_topk.register(["cuda", "gpu"])
+def segmented_topk_gpu(data, offsets, k=1, ret_type="both", is_ascend=False, dtype="int64"):
+    """Get the top k elements of each segment [offsets[i], offsets[i + 1])
+    of the flattened data.
+
+    Parameters
+    ----------
+    data : tvm.Tensor
+        The input tensor.
+
+    offsets : tvm.Tensor
+        1-D tensor of num_segments + 1 offsets into the flattened data.
+
+    k : int, optional
+        Number of top elements to select, at least 1.
+
+    ret_type: str, optional
+        The return type [both, values, indices].
+
+    is_ascend : boolean, optional
+        Whether to sort in ascending or descending order.
+
+    dtype : string, optional
+        The data type of the indices output.
+
+    Returns
+    -------
+    out : List[tvm.Tensor]
+        The (num_segments, k) top values and indices, padded with value 0
+        and index -1 for segments of fewer than k elements.
+    """
+    assert ret_type in ["both", "values", "indices"]
+    assert k >= 1
+    if len(data.shape) != 1:
+        size = 1
+        for dim in data.shape:
+            size = size * dim
+        data = reshape(data, (size,))
+    values, indices = _segmented_sort(data, offsets, is_ascend, dtype, "segmented_topk_gpu")
+    out_shape = (offsets.shape[0] - 1, k)
+
+    def _gather(sorted_out, pad):
+        def _compute(i, j):
+            begin = tvm.generic.cast(offsets[i], "int32")
+            num = tvm.generic.cast(offsets[i + 1], "int32") - begin
+            return tvm.if_then_else(j < num, sorted_out[begin + j],
+                                    tvm.const(pad, sorted_out.dtype))
+        return tvm.compute(out_shape, _compute, tag=tag.INJECTIVE)
+
+    output = []
+    if ret_type in ["both", "values"]:
+        output.append(_gather(values, 0))
+    if ret_type in ["both", "indices"]:
+        output.append(_gather(indices, -1))
+    return output
@@ -0,0 +1,106 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name
+"""Schedules for the ragged sparse ops on CUDA"""
+import tvm
+
+from .. import generic
+from ..nn import sparse
+from ..util import traverse_inline, get_const_int
+from .injective import schedule_injective_from_existing
+
+
+@sparse.sparse_dense.register(["cuda", "gpu"])
+def sparse_dense(data, weight_data, weight_indices, weight_indptr):
+    """sparse_dense on CUDA. CSR weights use the ragged declaration, so
+    that the nonzeros of a weight row can be spread over threads."""
+    if len(weight_data.shape) == 1:
+        return sparse.sparse_dense_csrmm_ragged(data, weight_data, weight_indices,
+                                                weight_indptr)
+    return sparse.sparse_dense.fdefault(data, weight_data, weight_indices, weight_indptr)
+
+
+def _schedule_rows(s, op, num_thread):
+    """CSR-vector: one block per output element, with the nonzeros of its
+    row reduced across the threads of the block. Rows with many more
+    nonzeros than others only cost their block more iterations."""
+    stage = s[op]
+    fused = stage.fuse(*op.axis)
+    ko, ki = stage.split(op.reduce_axis[0], factor=num_thread)
+    stage.reorder(fused, ko, ki)
+    thread_x = tvm.thread_axis("threadIdx.x")
+    stage.bind(fused, tvm.thread_axis("blockIdx.x"))
+    stage.bind(ki, thread_x)
+    stage.set_store_predicate(thread_x.var.equal(0))
+
+
+def _schedule_columns(s, op, num_thread):
+    """One block per sparse row and a range of dense columns, with a thread
+    per column running over the nonzeros of the row. Threads of a block
+    read consecutive columns of the same dense row."""
+    stage = s[op]
+    row, col = op.axis
+    co, ci = stage.split(col, factor=num_thread)
+    fused = stage.fuse(row, co)
+    stage.reorder(fused, ci, *op.reduce_axis)
+    stage.bind(fused, tvm.thread_axis("blockIdx.x"))
+    stage.bind(ci, tvm.thread_axis("threadIdx.x"))
+
+
+@generic.schedule_sparse_ragged.register(["cuda", "gpu"])
+def schedule_sparse_ragged(outs):
+    """Schedule for the ragged sparse ops on CUDA.
+
+    csrmv_ragged and sparse_dense_csrmm_ragged reduce the nonzeros of a
+    row across a warp. csrmm_ragged gives threads the columns of the dense
+    operand when it is at least a warp wide, and otherwise also reduces
+    across a warp.
+
+    Parameters
+    ----------
+    outs: Array of Tensor
+          The computation graph description of the sparse op
+          in the format of an array of tensors.
+
+    Returns
+    -------
+    sch: Schedule
+        The computation schedule for the op.
+    """
+    outs = [outs] if isinstance(outs, tvm.tensor.Tensor) else outs
+    s = tvm.create_schedule([x.op for x in outs])
+    num_thread = 32
+
+    def _callback(op):
+        if op.tag in ("csrmv_ragged", "sparse_dense_csrmm_ragged"):
+            _schedule_rows(s, op, num_thread)
+        elif op.tag == "csrmm_ragged":
+            ncol = op.axis[1].dom.extent
+            if isinstance(ncol, tvm.expr.IntImm) and get_const_int(ncol) < num_thread:
+                _schedule_rows(s, op, num_thread)
+            else:
+                _schedule_columns(s, op, num_thread)
+        else:
+            return
+        if op not in [x.op for x in outs]:
+            schedule_injective_from_existing(s, outs[0])
+
+    traverse_inline(s, outs[0].op, _callback)
+    return s
+
+
+generic.schedule_sparse_dense.register(["cuda", "gpu"])(schedule_sparse_ragged)
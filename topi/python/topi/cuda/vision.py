@@ -74,6 +74,50 @@ def schedule_nms(outs):
     """
     return _default_schedule(outs)
 
+def _schedule_ragged_boxes(s, op):
+    """Images over blockIdx.y. The boxes of an image, of which there are
+    as many as valid, go over blockIdx.x, and over threadIdx.x for the
+    gather of sorted boxes or the boxes compared with for the IoU."""
+    num_thread = 64
+    b, j, k = s[op].op.axis
+    s[op].bind(b, tvm.thread_axis("blockIdx.y"))
+    if op.tag == 'ragged_nms_sorted':
+        jo, ji = s[op].split(j, factor=num_thread)
+        s[op].bind(jo, tvm.thread_axis("blockIdx.x"))
+        s[op].bind(ji, tvm.thread_axis("threadIdx.x"))
+    else:
+        ko, ki = s[op].split(k, factor=num_thread)
+        s[op].bind(j, tvm.thread_axis("blockIdx.x"))
+        s[op].bind(ki, tvm.thread_axis("threadIdx.x"))
+
+@generic.schedule_ragged_nms.register(["cuda", "gpu"])
+def schedule_ragged_nms(outs):
+    """Schedule for ragged non-maximum suppression
+
+    Parameters
+    ----------
+    outs: Array of Tensor
+      The computation graph description of ragged nms
+      in the format of an array of tensors.
+
+    Returns
+    -------
+    s: Schedule
+      The computation schedule for the op.
+    """
+    s = _default_schedule(outs)
+    def traverse(op, visited):
+        if op in visited:
+            return
+        visited.add(op)
+        if op.tag in ['ragged_nms_sorted', 'ragged_box_iou']:
+            _schedule_ragged_boxes(s, op)
+        for tensor in op.input_tensors:
+            traverse(tensor.op, visited)
+    outs = [outs] if isinstance(outs, tvm.tensor.Tensor) else outs
+    traverse(outs[0].op, set())
+    return s
+
 @generic.schedule_multibox_prior.register(["cuda", "gpu"])
 def schedule_multibox_prior(outs):
     """Schedule for multibox_prior operator.
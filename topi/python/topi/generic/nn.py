@@ -70,6 +70,24 @@ def schedule_conv1d_nwc(outs):
     return _default_schedule(outs, False)
 
 
+@tvm.target.generic_func
+def schedule_ragged_conv1d_nwc(outs):
+    """Schedule for ragged_conv1d_nwc
+
+    Parameters
+    ----------
+    outs: Array of Tensor
+          The computation graph description of ragged_conv1d_nwc
+          in the format of an array of tensors.
+
+    Returns
+    -------
+    sch: Schedule
+        The computation schedule for the op.
+    """
+    return _default_schedule(outs, False)
+
+
 @tvm.target.generic_func
 def schedule_conv2d_hwcn(outs):
     """Schedule for conv2d_hwcn
@@ -507,6 +525,85 @@ def schedule_softmax(outs):
     return _default_schedule(outs, False)
 
 
+@tvm.target.override_native_generic_func("schedule_ragged_softmax")
+def schedule_ragged_softmax(outs):
+    """Schedule for ragged_softmax
+
+    Parameters
+    ----------
+    outs: Array of Tensor
+          The computation graph description of ragged_softmax
+          in the format of an array of tensors.
+
+    Returns
+    -------
+    sch: Schedule
+        The computation schedule for the op.
+    """
+    s = _default_schedule(outs, False)
+    # inline the elementwise producers fused into the ragged reductions
+    tvm.schedule.AutoInlineInjective(s)
+    return s
+
+
+@tvm.target.override_native_generic_func("schedule_ragged_layer_norm")
+def schedule_ragged_layer_norm(outs):
+    """Schedule for ragged_layer_norm
+
+    Parameters
+    ----------
+    outs: Array of Tensor
+          The computation graph description of ragged_layer_norm
+          in the format of an array of tensors.
+
+    Returns
+    -------
+    sch: Schedule
+        The computation schedule for the op.
+    """
+    s = _default_schedule(outs, False)
+    tvm.schedule.AutoInlineInjective(s)
+    return s
+
+
+@tvm.target.override_native_generic_func("schedule_ragged_attention")
+def schedule_ragged_attention(outs):
+    """Schedule for ragged_attention
+
+    Parameters
+    ----------
+    outs: Array of Tensor
+          The computation graph description of ragged_attention
+          in the format of an array of tensors.
+
+    Returns
+    -------
+    sch: Schedule
+        The computation schedule for the op.
+    """
+    return _default_schedule(outs, False)
+
+
+@tvm.target.override_native_generic_func("schedule_ragged_embedding_bag")
+def schedule_ragged_embedding_bag(outs):
+    """Schedule for ragged_embedding_bag
+
+    Parameters
+    ----------
+    outs: Array of Tensor
+          The computation graph description of ragged_embedding_bag
+          in the format of an array of tensors.
+
+    Returns
+    -------
+    sch: Schedule
+        The computation schedule for the op.
+    """
+    s = _default_schedule(outs, False)
+    tvm.schedule.AutoInlineInjective(s)
+    return s
+
+
 @tvm.target.override_native_generic_func("schedule_dense")
 def schedule_dense(outs):
     """Schedule for dense
@@ -667,6 +764,24 @@ def schedule_sparse_dense(outs):
     """
     return _default_schedule(outs, False)
 
+@tvm.target.override_native_generic_func("schedule_sparse_ragged")
+def schedule_sparse_ragged(outs):
+    """Schedule for the ragged sparse ops csrmm_ragged, csrmv_ragged and
+    sparse_dense_csrmm_ragged
+
+    Parameters
+    ----------
+    outs: Array of Tensor
+          The computation graph description of the sparse op
+          in the format of an array of tensors.
+
+    Returns
+    -------
+    sch: Schedule
+        The computation schedule for the op.
+    """
+    return _default_schedule(outs, False)
+
 @tvm.target.generic_func
 def schedule_sparse_transpose(outs):
     """Schedule for sparse_transpose
@@ -689,3 +804,23 @@ def schedule_batch_matmul(outs):
     target = tvm.target.Target.current(allow_none=False)
     cpp_target = cpp.TEST_create_target(target.target_name)
     return cpp.generic.default_schedule(cpp_target, outs, False)
+
+
+@tvm.target.override_native_generic_func("schedule_ragged_batch_matmul")
+def schedule_ragged_batch_matmul(outs):
+    """Schedule for ragged_batch_matmul
+
+    Parameters
+    ----------
+    outs: Array of Tensor
+          The computation graph description of ragged_batch_matmul
+          in the format of an array of tensors.
+
+    Returns
+    -------
+    sch: Schedule
+        The computation schedule for the op.
+    """
+    s = _default_schedule(outs, False)
+    tvm.schedule.AutoInlineInjective(s)
+    return s
@@ -86,6 +86,23 @@ def schedule_nms(outs):
     """
     return _default_schedule(outs, False)
 
+@tvm.target.generic_func
+def schedule_ragged_nms(outs):
+    """Schedule for ragged non-maximum suppression
+
+    Parameters
+    ----------
+    outs: Array of Tensor
+      The computation graph description of ragged nms
+      in the format of an array of tensors.
+
+    Returns
+    -------
+    s: Schedule
+      The computation schedule for the op.
+    """
+    return _default_schedule(outs, False)
+
 @tvm.target.generic_func
 def schedule_multibox_prior(outs):
     """Schedule for multibox_prior
@@ -31,6 +31,10 @@ from .dense import *
 from .mapping import *
 from .pooling import *
 from .softmax import *
+from .layer_norm import *
+from .attention import *
+from .embedding import *
+from .beam_search import *
 from .conv2d_transpose import *
 from .conv1d_transpose import *
 from .bnn import *
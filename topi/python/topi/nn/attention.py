@@ -0,0 +1,215 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name
+"""TVM operator for ragged multi-head attention compute."""
+from __future__ import absolute_import
+import tvm
+from tvm.tir.modes import Modes
+from ..util import get_const_int
+from .softmax import ragged_softmax
+
+
+def ragged_attention(q, k, v, lengths, scale=1.0):
+    """Compute scaled dot product attention over a padded batch of
+    sequences, where only the first lengths[b] queries and keys of
+    sequence b are valid.
+
+    The scores, the softmax and the weighted sum of the values are
+    ragged_compute ops that only visit valid query and key pairs, so the
+    work follows the sum of the squared lengths rather than the padded
+    size. The output is dense, with zeros at the padded queries.
+
+    Parameters
+    ----------
+    q : tvm.Tensor
+        4-D with shape [batch, heads, seq_len, head_dim]
+
+    k : tvm.Tensor
+        4-D with shape [batch, heads, seq_len, head_dim]
+
+    v : tvm.Tensor
+        4-D with shape [batch, heads, seq_len, value_dim]
+
+    lengths : tvm.Tensor
+        1-D int32 tensor with shape [batch] of the valid lengths
+
+    scale : float
+        the scale of the scores, typically 1 / sqrt(head_dim)
+
+    Returns
+    -------
+    output : tvm.Tensor
+        4-D with shape [batch, heads, seq_len, value_dim]
+    """
+    assert len(q.shape) == 4 and len(k.shape) == 4 and len(v.shape) == 4, \
+        "only support 4-dim ragged attention"
+    batch, heads, seq_len, head_dim = q.shape
+    value_dim = v.shape[3]
+
+    dims = [tvm.te.RangeDimension('rat_d%d' % i) for i in range(4)]
+    score_ufs = [tvm.tir.UninterpFun.from_constant('rat_c%d' % i, extent, 'l')
+                 for i, extent in enumerate((batch, heads, seq_len, seq_len))]
+    d_uf = tvm.tir.UninterpFun(
+        'rat_d', 'l', (0, head_dim), [dims[0], dims[2], dims[3]],
+        lambda b, i, j: tvm.if_then_else(tvm.all(i < lengths[b], j < lengths[b]), head_dim, 0))
+
+    def _score(ds, rs):
+        b, h, i, j = [ds[d] for d in dims]
+        return tvm.sum(q[b, h, i, rs['d']] * k[b, h, j, rs['d']] * tvm.const(scale, q.dtype),
+                       axis=rs['d'])
+
+    score = tvm.te.ragged_compute(
+        (batch, heads, seq_len, seq_len), dims, score_ufs, _score,
+        reduce_axis_ufs=[('d', d_uf)], name='T_ragged_attention_score')
+
+    prob = ragged_softmax(score, lengths, axis=3, batch_axis=0)
+
+    out_dims = [tvm.te.RangeDimension('rat_o%d' % i) for i in range(4)]
+    out_ufs = [tvm.tir.UninterpFun.from_constant('rat_oc%d' % i, extent, 'l')
+               for i, extent in enumerate((batch, heads, seq_len, value_dim))]
+    j_uf = tvm.tir.UninterpFun(
+        'rat_j', 'l', (0, seq_len), [out_dims[0], out_dims[2]],
+        lambda b, i: tvm.if_then_else(i < lengths[b], lengths[b], 0))
+
+    def _weighted(ds, rs):
+        b, h, i, e = [ds[d] for d in out_dims]
+        return tvm.sum(prob[b, h, i, rs['j']] * v[b, h, rs['j'], e], axis=rs['j'])
+
+    return tvm.te.ragged_compute(
+        (batch, heads, seq_len, value_dim), out_dims, out_ufs, _weighted,
+        reduce_axis_ufs=[('j', j_uf)], name='T_ragged_attention_out',
+        tag='ragged_attention_output')
+
+
+def block_sparse_attention(q, k, v, indptr, indices, block_size, max_blocks_per_row, scale=1.0):
+    """Compute scaled dot product attention where each block of queries
+    only attends to some blocks of keys, such as the local, global and
+    random blocks of BigBird, see tvm.te.BlockSparsePattern.
+
+    The key blocks of a query block are a ragged dimension, over which
+    the scores, the softmax and the weighted sum of the values only
+    iterate the listed blocks. The scores are stored in a block sparse
+    layout of the listed blocks only, so both work and memory grow with
+    the number of nonzero blocks rather than with the square of the
+    sequence length.
+
+    Parameters
+    ----------
+    q : tvm.Tensor
+        4-D with shape [batch, heads, seq_len, head_dim]
+
+    k : tvm.Tensor
+        4-D with shape [batch, heads, seq_len, head_dim]
+
+    v : tvm.Tensor
+        4-D with shape [batch, heads, seq_len, value_dim]
+
+    indptr : tvm.Tensor
+        1-D int32 tensor with shape [seq_len / block_size + 1]. The key
+        blocks of query block qb are indices[indptr[qb]:indptr[qb + 1]].
+
+    indices : tvm.Tensor
+        1-D int32 tensor of the key blocks of all query blocks
+
+    block_size : int
+        the number of queries and keys in a block, which divides seq_len
+
+    max_blocks_per_row : int
+        the largest number of key blocks of a query block
+
+    scale : float
+        the scale of the scores, typically 1 / sqrt(head_dim)
+
+    Returns
+    -------
+    output : tvm.Tensor
+        4-D with shape [batch, heads, seq_len, value_dim]
+    """
+    assert len(q.shape) == 4 and len(k.shape) == 4 and len(v.shape) == 4, \
+        "only support 4-dim block sparse attention"
+    batch, heads, seq_len, head_dim = q.shape
+    value_dim = v.shape[3]
+    bs = block_size
+    assert get_const_int(seq_len) % bs == 0, "the block size should divide the sequence length"
+    num_blocks = get_const_int(seq_len) // bs
+
+    def _key_block(qb, t):
+        return indices[indptr[qb] + t]
+
+    dims = [tvm.te.RangeDimension('bsa_d%d' % i) for i in range(6)]
+    ufs = [tvm.tir.UninterpFun.from_constant('bsa_c%d' % i, extent, 'l')
+           for i, extent in enumerate((batch, heads, num_blocks))]
+    ufs.append(Modes.block_sparse_slot_uf('bsa_slots', dims[2], indptr, max_blocks_per_row))
+    ufs += [tvm.tir.UninterpFun.from_constant('bsa_c%d' % i, bs, 'l') for i in (4, 5)]
+    d_uf = tvm.tir.UninterpFun.from_constant('bsa_hd', head_dim, 'l')
+
+    def _score(ds, rs):
+        b, h, qb, t, qq, kk = [ds[d] for d in dims]
+        return tvm.sum(q[b, h, qb * bs + qq, rs['d']] *
+                       k[b, h, _key_block(qb, t) * bs + kk, rs['d']] *
+                       tvm.const(scale, q.dtype), axis=rs['d'])
+
+    score = tvm.te.ragged_compute(
+        (batch, heads, num_blocks, max_blocks_per_row, bs, bs), dims, ufs, _score,
+        reduce_axis_ufs=[('d', d_uf)], name='T_block_sparse_attention_score',
+        width_uf_lists=[ufs])
+
+    row_dims = [tvm.te.RangeDimension('bsa_r%d' % i) for i in range(4)]
+    row_ufs = [tvm.tir.UninterpFun.from_constant('bsa_rc%d' % i, extent, 'l')
+               for i, extent in enumerate((batch, heads, num_blocks, bs))]
+    t_uf = Modes.block_sparse_slot_uf('bsa_rslots', row_dims[2], indptr, max_blocks_per_row)
+    c_uf = tvm.tir.UninterpFun.from_constant('bsa_bs', bs, 'l')
+
+    def _row_score(ds, rs):
+        b, h, qb, qq = [ds[d] for d in row_dims]
+        return score[b, h, qb, rs['t'], qq, rs['c']]
+
+    max_elem = tvm.te.ragged_compute(
+        (batch, heads, num_blocks, bs), row_dims, row_ufs,
+        lambda ds, rs: tvm.max(_row_score(ds, rs), axis=[rs['t'], rs['c']]),
+        reduce_axis_ufs=[('t', t_uf), ('c', c_uf)], name='T_block_sparse_attention_maxelem')
+
+    def _row_exp(ds, rs):
+        b, h, qb, qq = [ds[d] for d in row_dims]
+        return tvm.exp(_row_score(ds, rs) - max_elem[b, h, qb, qq])
+
+    expsum = tvm.te.ragged_compute(
+        (batch, heads, num_blocks, bs), row_dims, row_ufs,
+        lambda ds, rs: tvm.sum(_row_exp(ds, rs), axis=[rs['t'], rs['c']]),
+        reduce_axis_ufs=[('t', t_uf), ('c', c_uf)], name='T_block_sparse_attention_expsum')
+
+    out_dims = [tvm.te.RangeDimension('bsa_o%d' % i) for i in range(4)]
+    out_ufs = [tvm.tir.UninterpFun.from_constant('bsa_oc%d' % i, extent, 'l')
+               for i, extent in enumerate((batch, heads, seq_len, value_dim))]
+    ot_uf = tvm.tir.UninterpFun(
+        'bsa_oslots', 'l', (0, max_blocks_per_row), [out_dims[2]],
+        lambda i: indptr[i // bs + 1] - indptr[i // bs])
+
+    def _weighted(ds, rs):
+        b, h, i, e = [ds[d] for d in out_dims]
+        qb, qq, t, c = i // bs, i % bs, rs['t'], rs['c']
+        prob = tvm.exp(score[b, h, qb, t, qq, c] - max_elem[b, h, qb, qq])
+        return tvm.sum(prob * v[b, h, _key_block(qb, t) * bs + c, e], axis=[t, c])
+
+    weighted = tvm.te.ragged_compute(
+        (batch, heads, seq_len, value_dim), out_dims, out_ufs, _weighted,
+        reduce_axis_ufs=[('t', ot_uf), ('c', c_uf)], name='T_block_sparse_attention_weighted')
+
+    return tvm.compute(
+        (batch, heads, seq_len, value_dim),
+        lambda b, h, i, e: weighted[b, h, i, e] / expsum[b, h, i // bs, i % bs],
+        name='T_block_sparse_attention_out', tag='block_sparse_attention_output')
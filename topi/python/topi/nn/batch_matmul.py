@@ -19,6 +19,7 @@
 from __future__ import absolute_import as _abs
 import tvm
 from ..util import get_const_tuple
+from .util import get_ragged_extent, unpack_int4
 
 def batch_matmul_default(x, y):
     """Computes batch matrix multiplication of `x` and `y` when `x` and `y` are
@@ -68,3 +69,82 @@ def batch_matmul(x, y):
         3-D with shape [batch, M, N]
     """
     return batch_matmul_default(x, y)
+
+
+@tvm.target.generic_func
+def ragged_batch_matmul(x, y, lengths, out_dtype=None, mode='ragged', tile=1, y_dtype=None):
+    """Computes batch matrix multiplication of `x` and `y`, where only the
+    first lengths[b] rows of x[b] are valid, such as the tokens routed to
+    each expert of a mixture of experts layer.
+
+    The reduction is a ragged_compute op whose extent is zero on the
+    padded rows, so that they are skipped. The output is dense, with
+    zeros at the padded rows.
+
+    Parameters
+    ----------
+    x : tvm.Tensor
+        3-D with shape [batch, M, K], padded along M
+
+    y : tvm.Tensor
+        3-D with shape [batch, N, K], or [batch, N, K // 2] when y_dtype
+        is a packed 4-bit type
+
+    lengths : tvm.Tensor
+        1-D int32 tensor with shape [batch] of the valid rows of x
+
+    out_dtype : str
+        the output and accumulation type, such as int32 for int8 inputs.
+        Defaults to float32 for float16 inputs, and to the input type
+        otherwise.
+
+    mode : str
+        how the rows of x are iterated, see topi.nn.ragged_softmax
+
+    tile : int
+        the tile of the 'tiled' mode
+
+    y_dtype : str
+        'int4' or 'uint4' if y holds 4-bit weights packed two to a byte,
+        see topi.nn.util.unpack_int4. The weights are unpacked where they are
+        read.
+
+    Returns
+    -------
+    output : tvm.Tensor
+        3-D with shape [batch, M, N]
+    """
+    assert len(x.shape) == 3 and len(y.shape) == 3, "only support 3-dim batch_matmul"
+    x_shape = get_const_tuple(x.shape)
+    y_shape = get_const_tuple(y.shape)
+    assert x_shape[0] == y_shape[0], "batch dimension doesn't match"
+    y_k = y_shape[2] * 2 if y_dtype else y_shape[2]
+    assert x_shape[2] == y_k, "shapes of x and y is inconsistant"
+    batch, M, K = x.shape
+    N = y.shape[1]
+    if out_dtype is None:
+        out_dtype = 'float32' if x.dtype == 'float16' else x.dtype
+
+    dims = [tvm.te.RangeDimension('rbm_d%d' % i) for i in range(3)]
+    ufs = [tvm.tir.UninterpFun.from_constant('rbm_c%d' % i, extent, 'l')
+           for i, extent in enumerate((batch, M, N))]
+    k_uf = tvm.tir.UninterpFun(
+        'rbm_k', 'l', (0, K), [dims[0], dims[1]],
+        lambda b, i: tvm.if_then_else(i < get_ragged_extent(lengths[b], M, mode, tile), K, 0))
+
+    def _product(ds, k):
+        b, i = ds[dims[0]], ds[dims[1]]
+        if y_dtype:
+            weight = unpack_int4(y, (b, ds[dims[2]], k), y_dtype)
+        else:
+            weight = y[b, ds[dims[2]], k]
+        value = x[b, i, k].astype(out_dtype) * weight.astype(out_dtype)
+        if mode == 'ragged':
+            return value
+        return tvm.if_then_else(i < lengths[b], value, tvm.const(0, out_dtype))
+
+    return tvm.te.ragged_compute(
+        (batch, M, N), dims, ufs,
+        lambda ds, rs: tvm.sum(_product(ds, rs['k']), axis=rs['k']),
+        reduce_axis_ufs=[('k', k_uf)], name='T_ragged_batch_matmul',
+        tag='ragged_batch_matmul')
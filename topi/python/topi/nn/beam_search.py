@@ -0,0 +1,106 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name
+"""TVM operators to reorder ragged per-sequence state for beam search."""
+from __future__ import absolute_import
+import tvm
+
+
+@tvm.tag_scope(tag='ragged_reorder_offsets')
+def ragged_reorder_offsets(offsets, beam_indices):
+    """Compute the offsets of the packed rows of sequences after they are
+    reordered by beam_indices, on the device.
+
+    Parameters
+    ----------
+    offsets : tvm.Tensor
+        1-D int32 with shape [num_seqs + 1], the start of the rows of
+        each sequence in the packed state followed by the number of rows
+
+    beam_indices : tvm.Tensor
+        1-D int32 with shape [num_new_seqs], the sequence each new
+        sequence continues. A sequence may be continued by several
+        beams, or by none.
+
+    Returns
+    -------
+    new_offsets : tvm.Tensor
+        1-D int32 with shape [num_new_seqs + 1]
+    """
+    n = beam_indices.shape[0]
+    length = tvm.compute(
+        (n,), lambda i: offsets[beam_indices[i] + 1] - offsets[beam_indices[i]],
+        name='T_ragged_reorder_length')
+    # The number of beams is small, so the prefix sum is a reduction
+    # over all of them rather than a scan.
+    j = tvm.reduce_axis((0, n), name='j')
+    return tvm.compute(
+        (n + 1,), lambda i: tvm.sum(tvm.if_then_else(j < i, length[j], 0), axis=j),
+        name='T_ragged_reorder_offsets')
+
+
+@tvm.tag_scope(tag='ragged_reorder')
+def ragged_reorder(data, offsets, new_offsets, beam_indices, num_rows):
+    """Gather the packed rows of the sequences that beam_indices selects,
+    such as the KV caches or hidden states of the beams of a step.
+
+    Row r of the output belongs to the new sequence i with
+    new_offsets[i] <= r < new_offsets[i + 1], and is the row
+    r - new_offsets[i] of the sequence beam_indices[i] in data. Rows
+    past new_offsets[num_new_seqs] are 0.
+
+    Parameters
+    ----------
+    data : tvm.Tensor
+        2-D with shape [total_rows, dim], the rows of all sequences back
+        to back
+
+    offsets : tvm.Tensor
+        1-D int32 with shape [num_seqs + 1], the offsets of data
+
+    new_offsets : tvm.Tensor
+        1-D int32 with shape [num_new_seqs + 1], as computed by
+        ragged_reorder_offsets
+
+    beam_indices : tvm.Tensor
+        1-D int32 with shape [num_new_seqs]
+
+    num_rows : int or Expr
+        The number of rows of the output, at least the total length of
+        the new sequences
+
+    Returns
+    -------
+    output : tvm.Tensor
+        2-D with shape [num_rows, dim]
+    """
+    assert len(data.shape) == 2, "only support packed 2-dim state"
+    n = beam_indices.shape[0]
+    dim = data.shape[1]
+    # The sequence of each output row, as the number of sequences that
+    # start at or before it.
+    j = tvm.reduce_axis((1, n), name='j')
+    row_seq = tvm.compute(
+        (num_rows,), lambda r: tvm.sum(tvm.if_then_else(new_offsets[j] <= r, 1, 0), axis=j),
+        name='T_ragged_reorder_seq')
+
+    def _gather(r, h):
+        s = row_seq[r]
+        src = offsets[beam_indices[s]] + r - new_offsets[s]
+        return tvm.if_then_else(r < new_offsets[n], data[src, h], tvm.const(0, data.dtype))
+
+    return tvm.compute((num_rows, dim), _gather, name='T_ragged_reorder')
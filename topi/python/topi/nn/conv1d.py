@@ -184,3 +184,86 @@ def conv1d_nwc(data,
             * kernel[rw, rc, c].astype(out_dtype),
             axis=[rc, rw]),
         tag="conv1d_nwc")
+
+
+def ragged_conv1d_nwc(data,
+                      kernel,
+                      lengths,
+                      padding='SAME',
+                      dilation=1,
+                      out_dtype=None):
+    """ 1D convolution over a batch of sequences of different lengths, in
+    NWC layout with the sequences packed back to back.
+
+    Sequence b has lengths[b] valid positions. The output is a
+    ragged_compute op whose loop over positions has lengths[b] iterations
+    and whose storage is packed, so padded positions are neither computed
+    nor stored. Positions outside a sequence read as zeros: a window never
+    reads the neighboring sequence, however the positions of the batch are
+    tiled.
+
+    Parameters
+    ----------
+    data : tvm.Tensor
+        3-D with dense shape [batch, max_width, in_channel]. To be packed,
+        it should be declared with tvm.te.ragged_placeholder, with
+        lengths[b] as the width of the second dimension.
+
+    kernel : tvm.Tensor
+        3-D with shape [filter_size, in_channel, num_filter]
+
+    lengths : tvm.Tensor
+        1-D int32 with shape [batch]
+
+    padding : tuple or str
+        'SAME', 'CAUSAL' (all padding on the left, as streaming models
+        need) or a tuple of (left, right) summing to the dilated filter
+        size minus one, so that each output has the length of its input.
+
+    dilation : int or tuple
+        Dilation rate if convolution should be dilated.
+
+    out_dtype : str
+        The output data type. If None then output is same type as input.
+
+    Returns
+    -------
+    output : tvm.Tensor
+        3-D with dense shape [batch, max_width, num_filter], packed
+    """
+    if out_dtype is None:
+        out_dtype = data.dtype
+    if isinstance(dilation, (tuple, list)):
+        dilation = dilation[0]
+    batch, max_width, in_channels = data.shape
+    kernel_size, _, out_channels = kernel.shape
+
+    dilated_kernel_size = (kernel_size - 1) * dilation + 1
+    if padding == 'CAUSAL':
+        pad_left, pad_right = dilated_kernel_size - 1, 0
+    else:
+        pad_left, pad_right = get_pad_tuple1d(padding, (dilated_kernel_size, ))
+    assert simplify(pad_left + pad_right - dilated_kernel_size + 1) == 0, \
+        "ragged conv1d needs padding that preserves the sequence lengths"
+
+    dims = [tvm.te.RangeDimension('rc1d_d%d' % i) for i in range(3)]
+    ufs = [tvm.tir.UninterpFun.from_constant('rc1d_b', batch, 'l'),
+           tvm.tir.UninterpFun('rc1d_w', 'l', (0, max_width), [dims[0]],
+                               lambda b: lengths[b]),
+           tvm.tir.UninterpFun.from_constant('rc1d_c', out_channels, 'l')]
+    rc_uf = tvm.tir.UninterpFun.from_constant('rc1d_rc', in_channels, 'l')
+    rw_uf = tvm.tir.UninterpFun.from_constant('rc1d_rw', kernel_size, 'l')
+
+    def _conv(ds, rs):
+        b, w, c = ds[dims[0]], ds[dims[1]], ds[dims[2]]
+        rc, rw = rs['rc'], rs['rw']
+        pos = w + rw * dilation - pad_left
+        value = tvm.if_then_else(tvm.all(pos >= 0, pos < lengths[b]),
+                                 data[b, pos, rc].astype(out_dtype),
+                                 tvm.const(0, out_dtype))
+        return tvm.sum(value * kernel[rw, rc, c].astype(out_dtype), axis=[rc, rw])
+
+    return tvm.te.ragged_compute((batch, max_width, out_channels), dims, ufs, _conv,
+                                 reduce_axis_ufs=[('rc', rc_uf), ('rw', rw_uf)],
+                                 name='ragged_conv1d', tag='ragged_conv1d',
+                                 width_uf_lists=[ufs])
@@ -0,0 +1,81 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name
+# pylint: disable=invalid-name
+"""TVM operator for ragged embedding bag compute."""
+from __future__ import absolute_import
+import tvm
+
+
+@tvm.tag_scope(tag='ragged_embedding_bag_output')
+def ragged_embedding_bag(weight, indices, offsets, mode="sum"):
+    """Gather rows of an embedding table and reduce them per bag, as the
+    embedding lookups of recommendation models do.
+
+    Bag b holds the rows indices[offsets[b]:offsets[b + 1]] of weight.
+    Its reduction is a ragged_compute op whose extent is the bag size, so
+    each output element is reduced by a single thread, in order, without
+    atomics: the result is deterministic.
+
+    Parameters
+    ----------
+    weight : tvm.Tensor
+        2-D with shape [num_embeddings, dim]
+
+    indices : tvm.Tensor
+        1-D int32 with shape [nnz], the rows of all bags back to back
+
+    offsets : tvm.Tensor
+        1-D int32 with shape [num_bags + 1], the start of each bag in
+        indices followed by nnz
+
+    mode : str
+        "sum", "mean" or "max". Empty bags are 0 in all modes.
+
+    Returns
+    -------
+    output : tvm.Tensor
+        2-D with shape [num_bags, dim]
+    """
+    assert len(weight.shape) == 2, "only support 2-dim embedding tables"
+    assert mode in ("sum", "mean", "max"), "unsupported embedding bag mode " + mode
+    num_bags = offsets.shape[0] - 1
+    dim = weight.shape[1]
+    nnz = indices.shape[0]
+
+    dims = [tvm.te.RangeDimension('reb_d%d' % i) for i in range(2)]
+    ufs = [tvm.tir.UninterpFun.from_constant('reb_c%d' % i, extent, 'l')
+           for i, extent in enumerate((num_bags, dim))]
+    k_uf = tvm.tir.UninterpFun('reb_k', 'l', (0, nnz), [dims[0]],
+                               lambda b: offsets[b + 1] - offsets[b])
+    reducer = tvm.max if mode == "max" else tvm.sum
+
+    bag = tvm.te.ragged_compute(
+        (num_bags, dim), dims, ufs,
+        lambda ds, rs: reducer(weight[indices[offsets[ds[dims[0]]] + rs['k']], ds[dims[1]]],
+                               axis=rs['k']),
+        reduce_axis_ufs=[('k', k_uf)], name='T_ragged_embedding_bag_reduce')
+
+    def _finalize(b, j):
+        size = offsets[b + 1] - offsets[b]
+        if mode == "sum":
+            return bag[b, j]
+        if mode == "mean":
+            return bag[b, j] / tvm.max(size, 1).astype(weight.dtype)
+        return tvm.if_then_else(size > 0, bag[b, j], tvm.const(0, weight.dtype))
+
+    return tvm.compute((num_bags, dim), _finalize, name='T_ragged_embedding_bag_out')
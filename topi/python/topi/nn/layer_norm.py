@@ -0,0 +1,97 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name
+"""TVM operator for ragged layer normalization compute."""
+from __future__ import absolute_import
+import tvm
+
+
+@tvm.tag_scope(tag='ragged_layer_norm_output')
+def ragged_layer_norm(x, gamma, beta, lengths, epsilon=1e-5, center=True, scale=True):
+    """Perform layer normalization over the last axis of the valid rows of
+    a padded batch of sequences, such as the tokens of a transformer layer.
+
+    The mean and variance are ragged_compute ops whose reduction is empty
+    on the padded rows, so that they are skipped. The output is dense,
+    with zeros at the padded rows. For float16 x, the mean and variance
+    are float32.
+
+    Parameters
+    ----------
+    x : tvm.Tensor
+        3-D with shape [batch, seq_len, hidden], padded along seq_len
+
+    gamma : tvm.Tensor
+        1-D with shape [hidden]
+
+    beta : tvm.Tensor
+        1-D with shape [hidden]
+
+    lengths : tvm.Tensor
+        1-D int32 tensor with shape [batch] of the valid rows of x
+
+    epsilon : float
+        the small value added to the variance to avoid dividing by zero
+
+    center : bool
+        whether to add beta
+
+    scale : bool
+        whether to multiply by gamma
+
+    Returns
+    -------
+    output : tvm.Tensor
+        3-D with shape [batch, seq_len, hidden]
+    """
+    assert len(x.shape) == 3, "only support 3-dim ragged layer_norm"
+    batch, seq_len, hidden = x.shape
+
+    dims = [tvm.te.RangeDimension('rln_d%d' % i) for i in range(2)]
+    ufs = [tvm.tir.UninterpFun.from_constant('rln_c%d' % i, extent, 'l')
+           for i, extent in enumerate((batch, seq_len))]
+    k_uf = tvm.tir.UninterpFun('rln_k', 'l', (0, hidden), [dims[0], dims[1]],
+                               lambda b, i: tvm.if_then_else(i < lengths[b], hidden, 0))
+    # the statistics of half precision rows are accumulated in float32
+    acc_dtype = 'float32' if x.dtype == 'float16' else x.dtype
+    inv_hidden = tvm.const(1.0, acc_dtype) / hidden.astype(acc_dtype)
+
+    mean = tvm.te.ragged_compute(
+        (batch, seq_len), dims, ufs,
+        lambda ds, rs: tvm.sum(x[ds[dims[0]], ds[dims[1]], rs['k']].astype(acc_dtype) *
+                               inv_hidden, axis=rs['k']),
+        reduce_axis_ufs=[('k', k_uf)], name='T_ragged_layer_norm_mean')
+
+    def _centered(b, i, j):
+        return x[b, i, j].astype(acc_dtype) - mean[b, i]
+
+    var = tvm.te.ragged_compute(
+        (batch, seq_len), dims, ufs,
+        lambda ds, rs: tvm.sum(_centered(ds[dims[0]], ds[dims[1]], rs['k']) *
+                               _centered(ds[dims[0]], ds[dims[1]], rs['k']) * inv_hidden,
+                               axis=rs['k']),
+        reduce_axis_ufs=[('k', k_uf)], name='T_ragged_layer_norm_var')
+
+    def _normalize(b, i, j):
+        value = _centered(b, i, j) * tvm.rsqrt(var[b, i] + tvm.const(epsilon, acc_dtype))
+        if scale:
+            value = value * gamma[j].astype(acc_dtype)
+        if center:
+            value = value + beta[j].astype(acc_dtype)
+        return tvm.if_then_else(i < lengths[b], value.astype(x.dtype), tvm.const(0, x.dtype))
+
+    return tvm.compute(x.shape, _normalize, name='T_ragged_layer_norm_norm')
@@ -18,6 +18,7 @@
 """TVM operator for softmax and log_softmax compute."""
 from __future__ import absolute_import
 import tvm
+from .util import get_ragged_extent
 
 @tvm.tag_scope(tag='softmax_output')
 def softmax(x, axis=-1):
@@ -101,3 +102,114 @@ def log_softmax(x):
         (m, ), lambda i: tvm.sum(tvm.exp(x[i, k] - max_elem[i]), axis=k))
     return tvm.compute(
         x.shape, lambda i, j: x[i, j] - max_elem[i] - tvm.log(expsum[i]))
+
+
+@tvm.tag_scope(tag='ragged_softmax_output')
+def ragged_softmax(x, lengths, axis=1, batch_axis=0, scale=1.0, mode='ragged', tile=1):
+    """Perform softmax activation over the valid prefix of a padded axis,
+    whose length varies with the batch index, such as attention scores
+    whose keys are masked by sequence lengths.
+
+    The max and sum reductions are ragged_compute ops over a loop layout
+    in which the extent of axis is lengths[b], so that they skip the
+    padding. The output is dense, with zeros at the padded positions.
+
+    Parameters
+    ----------
+    x : tvm.Tensor
+        can be any dimension
+
+    lengths : tvm.Tensor
+        1-D int32 tensor of the valid lengths of axis, indexed by the
+        index along batch_axis
+
+    axis : int
+        the padded axis to perform softmax over
+
+    batch_axis : int
+        the axis that lengths is indexed by
+
+    scale : float
+        the scale of integer x, such as int8 quantized scores. The max
+        of each sequence is found and subtracted in the integer domain,
+        so that only the shifted values are scaled to float32.
+
+    mode : str
+        'ragged' iterates the valid length only, 'tiled' rounds it up to
+        a multiple of tile and 'dense' iterates the whole padded axis.
+        The last two mask the extra elements, which trades a few wasted
+        iterations for loops that can be vectorized or unrolled.
+
+    tile : int
+        the tile of the 'tiled' mode
+
+    Returns
+    -------
+    output : tvm.Tensor
+        output shape is the same as input, float32 for integer x. The
+        sum of float16 x is accumulated in float32.
+    """
+    shape = x.shape
+    ndim = len(shape)
+    if axis < 0:
+        axis = ndim + axis
+    if batch_axis < 0:
+        batch_axis = ndim + batch_axis
+    assert axis != batch_axis, "softmax axis and batch axis must differ"
+
+    dims = [tvm.te.RangeDimension('rsm_d%d' % i) for i in range(ndim)]
+    len_uf = tvm.tir.UninterpFun('rsm_len', 'l', (0, shape[axis]), [dims[batch_axis]],
+                                 lambda b: get_ragged_extent(lengths[b], shape[axis],
+                                                             mode, tile))
+    reduced = [i for i in range(ndim) if i != axis]
+    reduced_shape = [shape[i] for i in reduced]
+    reduced_dims = [dims[i] for i in reduced]
+    reduced_ufs = [tvm.tir.UninterpFun.from_constant('rsm_c%d' % i, shape[i], 'l')
+                   for i in reduced]
+
+    def _eval_range(ds, k):
+        return tuple(k if i == axis else ds[dims[i]] for i in range(ndim))
+
+    def _masked(ds, k, value, pad_value):
+        if mode == 'ragged':
+            return value
+        return tvm.if_then_else(k < lengths[ds[dims[batch_axis]]], value, pad_value)
+
+    max_elem = tvm.te.ragged_compute(
+        reduced_shape, reduced_dims, reduced_ufs,
+        lambda ds, rs: tvm.max(_masked(ds, rs['k'], x[_eval_range(ds, rs['k'])],
+                                       tvm.min_value(x.dtype)),
+                               axis=rs['k']),
+        reduce_axis_ufs=[('k', len_uf)], name='T_ragged_softmax_maxelem')
+
+    def _max_at(ds):
+        return max_elem[tuple(ds[d] for d in reduced_dims)]
+
+    out_dtype = x.dtype if 'float' in x.dtype else 'float32'
+    # half precision scores are exponentiated and summed in float32
+    acc_dtype = 'float32' if out_dtype == 'float16' else out_dtype
+
+    def _shifted(value, max_value):
+        if out_dtype == x.dtype:
+            return (value - max_value).astype(acc_dtype)
+        # int8 differences may overflow, so they are taken in int32
+        diff = value.astype('int32') - max_value.astype('int32')
+        return diff.astype(acc_dtype) * tvm.const(scale, acc_dtype)
+
+    expsum = tvm.te.ragged_compute(
+        reduced_shape, reduced_dims, reduced_ufs,
+        lambda ds, rs: tvm.sum(
+            _masked(ds, rs['k'], tvm.exp(_shifted(x[_eval_range(ds, rs['k'])], _max_at(ds))),
+                    tvm.const(0, acc_dtype)),
+            axis=rs['k']),
+        reduce_axis_ufs=[('k', len_uf)], name='T_ragged_softmax_expsum')
+
+    def _normalize(*indices):
+        non_reduce_indices = tuple(v for (i, v) in enumerate(indices) if i != axis)
+        value = (tvm.exp(_shifted(x[indices], max_elem[non_reduce_indices])) /
+                 expsum[non_reduce_indices]).astype(out_dtype)
+        return tvm.if_then_else(indices[axis] < lengths[indices[batch_axis]], value,
+                                tvm.const(0, out_dtype))
+
+    return tvm.compute(shape, _normalize, name='T_ragged_softmax_norm',
+                       attrs={"axis" : axis, "batch_axis" : batch_axis})
@@ -75,6 +75,50 @@ def _sparse_dense_csrmm(data, weight_data, weight_indices, weight_indptr):
     return tvm.compute(oshape, f, tag="sparse_dense_csrmm")
 
 
+def sparse_dense_csrmm_ragged(data, weight_data, weight_indices, weight_indptr):
+    """sparse_dense with a CSR weight, as a ragged_compute op whose
+    reduction over the nonzeros of a weight row has the row length as its
+    extent. Unlike the tvm.compute declaration, the reduction can be split
+    and bound to threads, which the GPU schedules rely on.
+
+    Parameters
+    ----------
+    data : tvm.Tensor
+        2-D with shape [M, K]
+
+    weight_data : tvm.Tensor
+        1-D with shape [nnz]
+
+    weight_indices : tvm.Tensor
+        1-D with shape [nnz]
+
+    weight_indptr : tvm.Tensor
+        1-D with shape [N + 1]
+
+    Returns
+    -------
+    output : tvm.Tensor
+        2-D with shape [M, N]
+    """
+    m, k = get_const_tuple(data.shape)
+    n = get_const_tuple(weight_indptr.shape)[0] - 1
+
+    dims = [tvm.te.RangeDimension('sparse_dense_d%d' % i) for i in range(2)]
+    ufs = [tvm.tir.UninterpFun.from_constant('sparse_dense_c%d' % i, extent, 'l')
+           for i, extent in enumerate((m, n))]
+    nnz_uf = tvm.tir.UninterpFun('sparse_dense_nnz', 'l', (0, k), [dims[1]],
+                                 lambda row: weight_indptr[row + 1] - weight_indptr[row])
+
+    def _dot(ds, rs):
+        elem = weight_indptr[ds[dims[1]]] + rs['elem_idx']
+        return tvm.sum(weight_data[elem] * data[ds[dims[0]], weight_indices[elem]],
+                       axis=rs['elem_idx'])
+
+    return tvm.te.ragged_compute((m, n), dims, ufs, _dot,
+                                 reduce_axis_ufs=[('elem_idx', nnz_uf)],
+                                 name='sparse_dense', tag="sparse_dense_csrmm_ragged")
+
+
 def _sparse_dense_bsrmm(data, weight_data, weight_indices, weight_indptr):
     (m, _) = get_const_tuple(data.shape)
     (_, bs_r, bs_c) = get_const_tuple(weight_data.shape)
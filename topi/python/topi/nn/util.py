@@ -258,3 +258,134 @@ def get_pad_tuple1d(padding, kernel):
         raise ValueError("Unknown padding option %s" % padding)
     pad_left = (pad_w + 1) // 2
     return pad_left, pad_w - pad_left
+
+
+def get_ragged_extent(length, extent, mode, tile):
+    """Get the loop extent of a padded axis whose valid length is length,
+    in one of the iteration modes of the ragged operators.
+
+    Parameters
+    ----------
+    length : tvm.Expr
+        the valid length
+
+    extent : tvm.Expr or int
+        the padded extent of the axis
+
+    mode : str
+        'ragged' visits the valid length only, 'tiled' rounds it up to a
+        multiple of tile and 'dense' visits the whole padded axis
+
+    tile : int
+        the tile of the 'tiled' mode
+
+    Returns
+    -------
+    extent : tvm.Expr
+        the loop extent, where the elements past length must be masked
+        unless mode is 'ragged'
+    """
+    if mode == 'ragged':
+        return length
+    if mode == 'tiled':
+        rounded = tvm.indexdiv(length + (tile - 1), tile) * tile
+        return tvm.min(rounded, tvm.convert(extent))
+    if mode == 'dense':
+        return tvm.convert(extent)
+    raise ValueError("Unknown ragged mode {0}".format(mode))
+
+
+def unpack_int4(packed, indices, dtype='int4'):
+    """Read an element of a tensor of 4-bit integers stored two to a
+    byte, the element at an even position of the last axis in the low
+    nibble.
+
+    Parameters
+    ----------
+    packed : tvm.Tensor
+        the int8 or uint8 storage, whose last axis is half as long as
+        the logical one
+
+    indices : list of tvm.Expr
+        the logical indices of the element
+
+    dtype : str
+        'int4' or 'uint4'
+
+    Returns
+    -------
+    value : tvm.Expr
+        the int32 value of the element
+    """
+    last = indices[-1]
+    byte = packed(*(list(indices[:-1]) + [tvm.indexdiv(last, 2)])).astype('int32')
+    shift = tvm.indexmod(last, 2) * 4
+    if dtype == 'int4':
+        # Shift the nibble to the top and back, to extend its sign.
+        return (byte << (28 - shift)) >> 28
+    if dtype == 'uint4':
+        return (byte >> shift) & 15
+    raise ValueError("Unknown packed dtype {0}".format(dtype))
+
+
+def _ragged_utilization(lengths, extent):
+    """The fraction of a padded axis that is valid, or None if unknown."""
+    if lengths is None or lengths.size == 0 or extent == 0:
+        return None
+    return float(lengths.clip(0, extent).sum()) / (lengths.size * extent)
+
+
+@tvm.target.generic_func
+def ragged_mode(lengths, extent, dtype):
+    """Choose the iteration mode of a ragged operator, see get_ragged_extent.
+
+    Parameters
+    ----------
+    lengths : numpy.ndarray or None
+        the valid lengths, if they are known at compile time
+
+    extent : int
+        the padded extent of the ragged axis
+
+    dtype : str
+        the data type the ragged axis is iterated over
+
+    Returns
+    -------
+    mode : tuple of str and int
+        the mode and its tile
+    """
+    # Without vector units, masking the padding only wastes iterations,
+    # unless there is hardly any of it.
+    utilization = _ragged_utilization(lengths, extent)
+    if utilization is not None and utilization >= 0.9:
+        return 'dense', 1
+    return 'ragged', 1
+
+
+def ragged_mode_tiled(lengths, extent, tile):
+    """Choose between the modes of ragged operators on targets that
+    prefer loops whose extent is a multiple of tile.
+
+    Parameters
+    ----------
+    lengths : numpy.ndarray or None
+        the valid lengths, if they are known at compile time
+
+    extent : int
+        the padded extent of the ragged axis
+
+    tile : int
+        the vector or warp width of the target
+
+    Returns
+    -------
+    mode : tuple of str and int
+        the mode and its tile
+    """
+    if extent <= tile:
+        return 'dense', 1
+    utilization = _ragged_utilization(lengths, extent)
+    if utilization is not None and utilization >= 0.9:
+        return 'dense', 1
+    return 'tiled', tile
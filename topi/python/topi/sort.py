@@ -152,3 +152,108 @@ def topk(data, k=1, axis=-1, ret_type="both", is_ascend=False, dtype="int64"):
                      name="topk_cpu",
                      tag="topk_cpu")
     return out
+
+
+@tvm.target.generic_func
+def segmented_argsort(data, offsets, is_ascend=1, dtype="int32"):
+    """Sorts each segment [offsets[i], offsets[i + 1]) of the flattened
+    data, such as the rows of a ragged tensor, whose offsets are the
+    row positions of its storage layout, and returns an array of the
+    shape of data that holds, at the positions of each segment, the
+    indices local to the segment of its elements in sorted order.
+    Positions outside of all segments are left undefined.
+
+    Parameters
+    ----------
+    data : tvm.Tensor
+        The input tensor.
+
+    offsets : tvm.Tensor
+        1-D int32 or int64 tensor of num_segments + 1 non decreasing
+        offsets into the flattened data.
+
+    is_ascend : boolean, optional
+        Whether to sort in ascending or descending order.
+
+    dtype : string, optional
+        DType of the output indices, int32 or int64.
+
+    Returns
+    -------
+    out : tvm.Tensor
+        Sorted index tensor. Schedule it with schedule_argsort.
+    """
+    data_buf = api.decl_buffer(data.shape, data.dtype, "data_buf", data_alignment=8)
+    offsets_buf = api.decl_buffer(offsets.shape, offsets.dtype, "offsets_buf", data_alignment=4)
+    out_buf = api.decl_buffer(data.shape, dtype, "out_buf", data_alignment=8)
+    out = tvm.extern(data.shape,
+                     [data, offsets],
+                     lambda ins, outs: tvm.call_packed(
+                         "tvm.contrib.sort.segmented_argsort", ins[0], ins[1],
+                         outs[0], is_ascend),
+                     dtype=dtype,
+                     in_buffers=[data_buf, offsets_buf],
+                     out_buffers=out_buf,
+                     name="segmented_argsort_cpu",
+                     tag="segmented_argsort_cpu")
+    return out
+
+
+@tvm.target.generic_func
+def segmented_topk(data, offsets, k=1, ret_type="both", is_ascend=False, dtype="int64"):
+    """Get the top k elements of each segment [offsets[i], offsets[i + 1])
+    of the flattened data, such as the rows of a ragged tensor.
+
+    Parameters
+    ----------
+    data : tvm.Tensor
+        The input tensor.
+
+    offsets : tvm.Tensor
+        1-D int32 or int64 tensor of num_segments + 1 non decreasing
+        offsets into the flattened data.
+
+    k : int, optional
+        Number of top elements to select, at least 1.
+
+    ret_type: str, optional
+        The return type [both, values, indices].
+        "both": return both top k data and indices.
+        "values": return top k data only.
+        "indices": return top k indices only.
+
+    is_ascend : boolean, optional
+        Whether to sort in ascending or descending order.
+
+    dtype : string, optional
+        The data type of the indices output, int32 or int64.
+
+    Returns
+    -------
+    out : tvm.Tensor or List[tvm.Tensor]
+        The (num_segments, k) top values and indices local to the
+        segments. Segments of fewer than k elements are padded with
+        index -1 and value 0. Schedule them with schedule_topk.
+    """
+    assert ret_type in ["both", "values", "indices"]
+    assert k >= 1
+    data_buf = api.decl_buffer(data.shape, data.dtype, "data_buf", data_alignment=8)
+    offsets_buf = api.decl_buffer(offsets.shape, offsets.dtype, "offsets_buf", data_alignment=4)
+    out_shape = [offsets.shape[0] - 1, k]
+    out_bufs = []
+    if ret_type in ["both", "values"]:
+        out_bufs.append(api.decl_buffer(out_shape, data.dtype, "value_buf", data_alignment=8))
+    if ret_type in ["both", "indices"]:
+        out_bufs.append(api.decl_buffer(out_shape, dtype, "indices_buf", data_alignment=8))
+    out_shapes = [out_shape] * len(out_bufs)
+
+    out = tvm.extern(out_shapes,
+                     [data, offsets],
+                     lambda ins, outs: tvm.call_packed(
+                         "tvm.contrib.sort.segmented_topk", ins[0], ins[1], *outs,
+                         k, ret_type, is_ascend),
+                     in_buffers=[data_buf, offsets_buf],
+                     out_buffers=out_bufs,
+                     name="segmented_topk_cpu",
+                     tag="segmented_topk_cpu")
+    return out
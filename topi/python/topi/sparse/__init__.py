@@ -19,6 +19,6 @@
 """Sparse operators"""
 from __future__ import absolute_import as _abs
 
-from .csrmv import csrmv
-from .csrmm import csrmm
+from .csrmv import csrmv, csrmv_ragged
+from .csrmm import csrmm, csrmm_ragged
 from .dense import dense
@@ -87,6 +87,60 @@ def csrmm_default(data, indices, indptr, weight, bias=None):
     return matmul
 
 
+def csrmm_ragged(data, indices, indptr, weight, bias=None):
+    # pylint: disable=invalid-name
+    """csrmm as a ragged_compute op, whose reduction over the nonzeros of a
+    row has the row length indptr[row + 1] - indptr[row] as its extent.
+    Unlike csrmm_default, it can be scheduled, e.g. with the columns of a
+    row spread over threads.
+
+    Parameters
+    ----------
+    data : tvm.Tensor
+        1-D with shape [nonzeros]
+
+    indices : tvm.Tensor
+        1-D with shape [nonzeros]
+
+    indptr : tvm.Tensor
+        1-D with shape [m+1]
+
+    weight : tvm.Tensor
+        2-D with shape [k, n]
+
+    bias : tvm.Tensor, optional
+        1-D with shape [m]
+
+    Returns
+    -------
+    output : tvm.Tensor
+        2-D with shape [m, n]
+    """
+    assert len(data.shape) == 1 and len(indices.shape) == 1 and len(indptr.shape) == 1 \
+        and len(weight.shape) == 2, "only support 2-dim csrmm"
+    if bias is not None:
+        assert len(bias.shape) == 1
+    M = simplify(indptr.shape[0]-1)
+    K, N = weight.shape
+
+    dims = [tvm.te.RangeDimension('csrmm_d%d' % i) for i in range(2)]
+    ufs = [tvm.tir.UninterpFun.from_constant('csrmm_c%d' % i, extent, 'l')
+           for i, extent in enumerate((M, N))]
+    nnz_uf = tvm.tir.UninterpFun('csrmm_nnz', 'l', (0, K), [dims[0]],
+                                 lambda row: indptr[row + 1] - indptr[row])
+
+    def _dot(ds, rs):
+        elem = indptr[ds[dims[0]]] + rs['k']
+        return tvm.sum(data[elem] * weight[indices[elem], ds[dims[1]]], axis=rs['k'])
+
+    matmul = tvm.te.ragged_compute((M, N), dims, ufs, _dot, reduce_axis_ufs=[('k', nnz_uf)],
+                                   name='csrmm', tag='csrmm_ragged')
+    if bias is not None:
+        matmul = tvm.compute((M, N), lambda i, j: matmul[i, j] + bias[i], \
+                             tag=tag.BROADCAST)
+    return matmul
+
+
 def csrmm(a, b, c=None):
     """The `csrmm` routine performs a matrix-matrix operation defined as :math:`C := A*B + C`,
     where `B` and `C` are dense matrices, `A` is an m-by-k sparse matrix in the CSR format.
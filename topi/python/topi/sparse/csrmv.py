@@ -82,6 +82,60 @@ def csrmv_default(data, indices, indptr, weight, bias=None):
     return matmul
 
 
+def csrmv_ragged(data, indices, indptr, weight, bias=None):
+    """csrmv as a ragged_compute op, whose reduction over the nonzeros of a
+    row has the row length indptr[row + 1] - indptr[row] as its extent.
+    Unlike csrmv_default, it can be scheduled, e.g. with the nonzeros of a
+    row reduced across the threads of a warp.
+
+    Parameters
+    ----------
+    data : tvm.Tensor
+        1-D with shape [nonzeros]
+
+    indices : tvm.Tensor
+        1-D with shape [nonzeros]
+
+    indptr : tvm.Tensor
+        1-D with shape [m+1]
+
+    weight : tvm.Tensor
+        2-D with shape [k, 1]
+
+    bias : tvm.Tensor, optional
+        1-D with shape [1]
+
+    Returns
+    -------
+    output : tvm.Tensor
+        2-D with shape [m, 1]
+    """
+    assert len(data.shape) == 1 and len(weight.shape) == 2, \
+        "only support 2-dim csrmv"
+    if bias is not None:
+        assert len(bias.shape) == 1
+    batch = indptr.shape[0]-1
+    k = weight.shape[0]
+
+    dims = [tvm.te.RangeDimension('csrmv_d%d' % i) for i in range(2)]
+    ufs = [tvm.tir.UninterpFun.from_constant('csrmv_c%d' % i, extent, 'l')
+           for i, extent in enumerate((batch, 1))]
+    nnz_uf = tvm.tir.UninterpFun('csrmv_nnz', 'l', (0, k), [dims[0]],
+                                 lambda row: indptr[row + 1] - indptr[row])
+
+    def _dot(ds, rs):
+        elem = indptr[ds[dims[0]]] + rs['k']
+        return tvm.sum(data[elem] * weight[indices[elem], 0], axis=rs['k'])
+
+    matmul = tvm.te.ragged_compute((batch, 1), dims, ufs, _dot,
+                                   reduce_axis_ufs=[('k', nnz_uf)],
+                                   name='csrmv', tag='csrmv_ragged')
+    if bias is not None:
+        matmul = tvm.compute((batch, 1), lambda i, j: matmul[i, 0] + bias[i], \
+                             tag=tag.BROADCAST)
+    return matmul
+
+
 def csrmv(a, x, y=None):
     """The `csrmv` routine performs a matrix-vector operation defined as :math:`y := A*x + y`,
     where `x` and `y` are vectors, `A` is an m-by-k sparse matrix in the CSR format.
@@ -20,6 +20,7 @@ import tvm
 
 from tvm import hybrid
 from ..sort import argsort
+from .. import tag
 
 @hybrid.script
 def hybrid_rearrange_out(data, one):
@@ -380,3 +381,280 @@ def non_max_suppression(data, valid_count, max_output_size=-1,
         out = hybrid_rearrange_out(out, one=tvm.const(1, dtype=data.dtype))
 
     return box_indices if return_indices else out
+
+
+def _ragged_nkeep(valid_count, top_k):
+    """The boxes of each image that take part in nms."""
+    if top_k > 0:
+        return lambda b: tvm.min(valid_count[b], top_k)
+    return lambda b: valid_count[b]
+
+
+def ragged_sort_boxes(data, valid_count, top_k=-1, score_index=1):
+    """Sort the valid boxes of each image by decreasing score.
+
+    The gather is a ragged_compute op whose loop over the boxes of image b
+    has min(valid_count[b], top_k) iterations, so padded boxes are not
+    copied. Entries past that are left undefined.
+
+    Parameters
+    ----------
+    data : tvm.Tensor
+        3-D tensor with shape [batch_size, num_anchors, elem_length].
+
+    valid_count : tvm.Tensor
+        1-D int32 tensor for valid number of boxes.
+
+    top_k : optional, int
+        Keep maximum top k detections, -1 for no limit.
+
+    score_index: optional, int
+        Index of the scores/confidence of boxes.
+
+    Returns
+    -------
+    sorted_data : tvm.Tensor
+        3-D tensor with shape [batch_size, num_anchors, elem_length].
+
+    sorted_index : tvm.Tensor
+        2-D int32 tensor with shape [batch_size, num_anchors].
+    """
+    batch_size, num_anchors, box_data_length = data.shape
+    score_tensor = tvm.compute((batch_size, num_anchors),
+                               lambda i, j: data[i, j, score_index], tag=tag.ELEMWISE)
+    sorted_index = argsort(score_tensor, valid_count=valid_count, axis=1, is_ascend=False)
+
+    dims = [tvm.te.RangeDimension('rnms_sort_d%d' % i) for i in range(3)]
+    ufs = [tvm.tir.UninterpFun.from_constant('rnms_sort_b', batch_size, 'l'),
+           tvm.tir.UninterpFun('rnms_sort_j', 'l', (0, num_anchors), [dims[0]],
+                               _ragged_nkeep(valid_count, top_k)),
+           tvm.tir.UninterpFun.from_constant('rnms_sort_k', box_data_length, 'l')]
+    sorted_data = tvm.te.ragged_compute(
+        (batch_size, num_anchors, box_data_length), dims, ufs,
+        lambda ds: data[ds[dims[0]], sorted_index[ds[dims[0]], ds[dims[1]]], ds[dims[2]]],
+        name='T_ragged_nms_sorted', tag='ragged_nms_sorted')
+    return sorted_data, sorted_index
+
+
+def ragged_box_iou(sorted_data, valid_count, top_k=-1, coord_start=2, id_index=0,
+                   force_suppress=False):
+    """IoU of all pairs of the valid boxes of each image.
+
+    The pairs of image b form a square of side min(valid_count[b], top_k)
+    that a ragged_compute op iterates over, so the work scales with the
+    actual box counts rather than with num_anchors. Pairs of boxes of
+    different classes get an IoU of 0 unless force_suppress is set.
+
+    Parameters
+    ----------
+    sorted_data : tvm.Tensor
+        3-D tensor with shape [batch_size, num_anchors, elem_length].
+
+    valid_count : tvm.Tensor
+        1-D int32 tensor for valid number of boxes.
+
+    top_k : optional, int
+        Keep maximum top k detections, -1 for no limit.
+
+    coord_start : optional, int
+        Start index of the consecutive 4 coordinates.
+
+    id_index : optional, int
+        index of the class categories, -1 to disable.
+
+    force_suppress : optional, boolean
+        Whether to compare boxes regardless of class_id.
+
+    Returns
+    -------
+    iou : tvm.Tensor
+        3-D tensor with shape [batch_size, num_anchors, num_anchors].
+    """
+    batch_size, num_anchors, _ = sorted_data.shape
+    zero = tvm.const(0, sorted_data.dtype)
+
+    dims = [tvm.te.RangeDimension('rnms_iou_d%d' % i) for i in range(3)]
+    nkeep = _ragged_nkeep(valid_count, top_k)
+    ufs = [tvm.tir.UninterpFun.from_constant('rnms_iou_b', batch_size, 'l'),
+           tvm.tir.UninterpFun('rnms_iou_j', 'l', (0, num_anchors), [dims[0]], nkeep),
+           tvm.tir.UninterpFun('rnms_iou_k', 'l', (0, num_anchors), [dims[0]], nkeep)]
+
+    def _iou(ds):
+        b, j, k = ds[dims[0]], ds[dims[1]], ds[dims[2]]
+
+        def coord(box, c):
+            return sorted_data[b, box, coord_start + c]
+        w = tvm.max(zero, tvm.min(coord(j, 2), coord(k, 2)) - tvm.max(coord(j, 0), coord(k, 0)))
+        h = tvm.max(zero, tvm.min(coord(j, 3), coord(k, 3)) - tvm.max(coord(j, 1), coord(k, 1)))
+        area = w * h
+        u = (coord(j, 2) - coord(j, 0)) * (coord(j, 3) - coord(j, 1)) + \
+            (coord(k, 2) - coord(k, 0)) * (coord(k, 3) - coord(k, 1)) - area
+        iou = tvm.if_then_else(u <= zero, zero, area / u)
+        if force_suppress or id_index < 0:
+            return iou
+        same_class = sorted_data[b, j, id_index] == sorted_data[b, k, id_index]
+        return tvm.if_then_else(same_class, iou, zero)
+
+    return tvm.te.ragged_compute((batch_size, num_anchors, num_anchors), dims, ufs, _iou,
+                                 name='T_ragged_box_iou', tag='ragged_box_iou')
+
+
+@hybrid.script
+def hybrid_ragged_nms(sorted_data, sorted_index, iou, valid_count, max_output_size,
+                      iou_threshold, top_k, id_index, score_index, one):
+    """Hybrid routing for the suppression of ragged non-maximum suppression,
+    over the precomputed IoU of the valid boxes.
+
+    Parameters
+    ----------
+    sorted_data : tvm.Tensor or numpy NDArray
+        Bounding boxes sorted by score, with shape
+        [batch_size, num_anchors, 6].
+
+    sorted_index : tvm.Tensor or numpy NDArray
+        Bounding box indexes sorted by score, with shape
+        [batch_size, num_anchors].
+
+    iou : tvm.Tensor or numpy NDArray
+        IoU of the sorted boxes, with shape
+        [batch_size, num_anchors, num_anchors].
+
+    valid_count : tvm.Tensor or numpy NDArray
+        1-D tensor for valid number of boxes.
+
+    max_output_size : tvm.const
+        Max number of output valid boxes for each instance.
+
+    iou_threshold : tvm.const
+        Overlapping(IoU) threshold to suppress object with smaller score.
+
+    top_k : tvm.const
+        Keep maximum top k detections before nms, -1 for no limit.
+
+    id_index : tvm.const
+        index of the class categories, -1 to disable.
+
+    score_index: tvm.const
+        Index of the scores/confidence of boxes.
+
+    one: tvm.const
+        Constant one with the same dtype as data.
+
+    Returns
+    -------
+    output : tvm.Tensor
+        3-D tensor with shape [batch_size, num_anchors, 6].
+
+    box_indices: tvm.Tensor
+        2-D tensor with shape [batch_size, num_anchors].
+    """
+    batch_size = sorted_data.shape[0]
+    num_anchors = sorted_data.shape[1]
+    box_data_length = sorted_data.shape[2]
+    box_indices = output_tensor((batch_size, num_anchors), "int32")
+    output = output_tensor((batch_size,
+                            num_anchors,
+                            box_data_length,), sorted_data.dtype)
+
+    for i in parallel(batch_size):
+        nkeep = valid_count[i]
+        if 0 < top_k < nkeep:
+            nkeep = top_k
+        for j in range(nkeep):
+            for k in range(box_data_length):
+                output[i, j, k] = sorted_data[i, j, k]
+            box_indices[i, j] = sorted_index[i, j]
+        for j in range(num_anchors - nkeep):
+            for k in range(box_data_length):
+                output[i, j + nkeep, k] = -one
+            box_indices[i, j + nkeep] = -1
+        # Boxes past max_output_size are dropped, so they need not
+        # suppress others.
+        num_valid_boxes = 0
+        for j in range(nkeep):
+            if output[i, j, score_index] > 0 and (id_index < 0 or output[i, j, id_index] >= 0):
+                if 0 < max_output_size <= num_valid_boxes:
+                    for k in range(box_data_length):
+                        output[i, j, k] = -one
+                    box_indices[i, j] = -1
+                else:
+                    num_valid_boxes += 1
+                    for k in range(nkeep - j - 1):
+                        if iou[i, j, j + k + 1] >= iou_threshold:
+                            output[i, j + k + 1, score_index] = -one
+                            if id_index >= 0:
+                                output[i, j + k + 1, id_index] = -one
+                            box_indices[i, j + k + 1] = -1
+    return output, box_indices
+
+
+@tvm.target.generic_func
+def ragged_non_max_suppression(data, valid_count, max_output_size=-1,
+                               iou_threshold=0.5, force_suppress=False, top_k=-1,
+                               coord_start=2, score_index=1, id_index=0,
+                               return_indices=True, invalid_to_bottom=False):
+    """Non-maximum suppression whose work scales with the valid boxes of
+    each image rather than with num_anchors.
+
+    The sort gather and the IoU of all pairs of valid boxes are
+    ragged_compute ops driven by valid_count and top_k, and the
+    suppression scan only reads the precomputed IoU. The arguments and
+    outputs are those of non_max_suppression, except that iou_threshold
+    must be positive.
+
+    Parameters
+    ----------
+    data : tvm.Tensor
+        3-D tensor with shape [batch_size, num_anchors, 6] or [batch_size, num_anchors, 5].
+
+    valid_count : tvm.Tensor
+        1-D tensor for valid number of boxes.
+
+    max_output_size : optional, int
+        Max number of output valid boxes for each instance.
+        By default all valid boxes are returned.
+
+    iou_threshold : optional, float
+        Non-maximum suppression threshold.
+
+    force_suppress : optional, boolean
+        Whether to suppress all detections regardless of class_id.
+
+    top_k : optional, int
+        Keep maximum top k detections before nms, -1 for no limit.
+
+    coord_start : required, int
+        Start index of the consecutive 4 coordinates.
+
+    score_index: optional, int
+        Index of the scores/confidence of boxes.
+
+    id_index : optional, int
+        index of the class categories, -1 to disable.
+
+    return_indices : optional, boolean
+        Whether to return box indices in input data.
+
+    invalid_to_bottom : optional, boolean
+        Whether to move all valid bounding boxes to the top.
+
+    Returns
+    -------
+    out : tvm.Tensor
+        3-D tensor with shape [batch_size, num_anchors, 6].
+    """
+    assert iou_threshold > 0, "ragged_non_max_suppression needs a positive iou_threshold"
+    sorted_data, sorted_index = ragged_sort_boxes(data, valid_count, top_k, score_index)
+    iou = ragged_box_iou(sorted_data, valid_count, top_k, coord_start, id_index,
+                         force_suppress)
+    out, box_indices = hybrid_ragged_nms(sorted_data, sorted_index, iou, valid_count,
+                                         tvm.const(max_output_size, dtype="int32"),
+                                         tvm.const(iou_threshold, dtype=data.dtype),
+                                         tvm.const(top_k, dtype="int32"),
+                                         tvm.const(id_index, dtype="int32"),
+                                         tvm.const(score_index, dtype="int32"),
+                                         one=tvm.const(1, dtype=data.dtype))
+    if not return_indices and invalid_to_bottom:
+        out = hybrid_rearrange_out(out, one=tvm.const(1, dtype=data.dtype))
+
+    return box_indices if return_indices else out
@@ -19,7 +19,7 @@
 """x86 specific declaration and schedules."""
 from __future__ import absolute_import as _abs
 
-from .conv1d import schedule_conv1d_nwc
+from .conv1d import schedule_conv1d_nwc, schedule_ragged_conv1d_nwc
 from .conv2d import schedule_conv2d, schedule_conv2d_nhwc
 from .conv3d import schedule_conv3d_ndhwc
 from .binarize_pack import schedule_binarize_pack
@@ -33,7 +33,7 @@ from .bitserial_conv2d import schedule_bitserial_conv2d
 from .bitserial_dense import schedule_bitserial_dense
 from .depthwise_conv2d import schedule_depthwise_conv2d_NCHWc
 from .dense import _schedule_dense, _schedule_dense_pack, _schedule_dense_nopack
-from .batch_matmul import schedule_batch_matmul
+from .batch_matmul import schedule_batch_matmul, schedule_ragged_batch_matmul
 from .roi_align import roi_align_nchw
 from .conv2d_transpose import _schedule_conv2d_transpose_nchw
 from .sparse import *
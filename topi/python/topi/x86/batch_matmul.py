@@ -22,7 +22,9 @@ from tvm import autotvm
 from tvm.autotvm.task.space import SplitEntity
 from tvm.contrib import cblas
 from .. import generic, nn
+from ..nn.util import ragged_mode, ragged_mode_tiled, get_ragged_extent, unpack_int4
 from ..util import traverse_inline, get_const_tuple, get_max_power2_factor
+from .util import get_fp32_len
 
 
 @autotvm.register_topi_compute(nn.batch_matmul, "cpu", "direct")
@@ -137,3 +139,170 @@ def _default_batch_matmul_nopack_config(cfg, M, N, K):
     cfg["tile_x"] = SplitEntity([N // x_bn, x_bn])
     y_bn = get_max_power2_factor(M, 8)
     cfg["tile_y"] = SplitEntity([M // y_bn, y_bn])
+
+
+def _ragged_gemm_tiles(M, N, dtype):
+    """The rows and columns of the register tile of the ragged GEMM
+    micro-kernel: a few rows, and whole vectors of columns."""
+    lanes = get_fp32_len() * 32 // tvm.DataType(dtype).bits
+    return get_max_power2_factor(M, 8), get_max_power2_factor(N, lanes)
+
+
+@nn.ragged_batch_matmul.register(["cpu"])
+def ragged_batch_matmul_packed(x, y, lengths, out_dtype=None, mode='ragged', tile=1,
+                               y_dtype=None):
+    """Computes ragged_batch_matmul with packed panels, see
+    topi.nn.ragged_batch_matmul for the parameters.
+
+    The valid rows of each sequence, rounded up to the rows of the
+    micro-kernel tile, are packed on the fly into panels of shape [K, mr],
+    and y into panels of shape [K, nr], so that the micro-kernel reads
+    both contiguously. The product is a ragged_compute op over the rounded
+    rows with a dense reduction, which the micro-kernel tiles in
+    registers. The output is dense, with zeros at the padded rows.
+    Packed 4-bit weights are unpacked into the panels of y.
+    """
+    assert len(x.shape) == 3 and len(y.shape) == 3, "only support 3-dim batch_matmul"
+    batch, M, K = get_const_tuple(x.shape)
+    YB, N, YK = get_const_tuple(y.shape)
+    assert batch == YB, "batch dimension doesn't match"
+    assert K == (YK * 2 if y_dtype else YK), "shapes of x and y is inconsistant"
+    if out_dtype is None:
+        out_dtype = 'float32' if x.dtype == 'float16' else x.dtype
+    mr, nr = _ragged_gemm_tiles(M, N, out_dtype)
+
+    def num_rows(b):
+        # the rows computed for sequence b, rounded up to whole tiles
+        return get_ragged_extent(lengths[b], M, 'dense' if mode == 'dense' else 'tiled', mr)
+
+    def _y(b, j, k):
+        if y_dtype:
+            return unpack_int4(y, (b, j, k), y_dtype).astype(out_dtype)
+        return y[b, j, k]
+
+    y_packed = tvm.compute(
+        (batch, N // nr, K, nr), lambda b, jo, k, ji: _y(b, jo * nr + ji, k),
+        name='T_ragged_batch_matmul_ypack')
+
+    dims = [tvm.te.RangeDimension('rbmp_d%d' % i) for i in range(4)]
+    x_packed = tvm.te.ragged_compute(
+        (batch, M // mr, K, mr), dims,
+        [tvm.tir.UninterpFun.from_constant('rbmp_b', batch, 'l'),
+         tvm.tir.UninterpFun('rbmp_p', 'l', (0, M // mr), [dims[0]],
+                             lambda b: tvm.indexdiv(num_rows(b), mr)),
+         tvm.tir.UninterpFun.from_constant('rbmp_k', K, 'l'),
+         tvm.tir.UninterpFun.from_constant('rbmp_r', mr, 'l')],
+        lambda ds: x[ds[dims[0]], ds[dims[1]] * mr + ds[dims[3]], ds[dims[2]]],
+        name='T_ragged_batch_matmul_xpack')
+
+    gemm_dims = [tvm.te.RangeDimension('rbmp_g%d' % i) for i in range(3)]
+    product = tvm.te.ragged_compute(
+        (batch, M, N), gemm_dims,
+        [tvm.tir.UninterpFun.from_constant('rbmp_gb', batch, 'l'),
+         tvm.tir.UninterpFun('rbmp_gi', 'l', (0, M), [gemm_dims[0]], num_rows),
+         tvm.tir.UninterpFun.from_constant('rbmp_gj', N, 'l')],
+        lambda ds, rs: tvm.sum(
+            x_packed[ds[gemm_dims[0]], tvm.indexdiv(ds[gemm_dims[1]], mr), rs['k'],
+                     tvm.indexmod(ds[gemm_dims[1]], mr)].astype(out_dtype) *
+            y_packed[ds[gemm_dims[0]], tvm.indexdiv(ds[gemm_dims[2]], nr), rs['k'],
+                     tvm.indexmod(ds[gemm_dims[2]], nr)].astype(out_dtype),
+            axis=rs['k']),
+        reduce_axis_ufs=[('k', tvm.tir.UninterpFun.from_constant('rbmp_gk', K, 'l'))],
+        name='T_ragged_batch_matmul_packed', tag='ragged_batch_matmul_packed')
+
+    return tvm.compute(
+        (batch, M, N),
+        lambda b, i, j: tvm.if_then_else(i < lengths[b], product[b, i, j],
+                                         tvm.const(0, out_dtype)),
+        name='T_ragged_batch_matmul', tag='ragged_batch_matmul')
+
+
+def _schedule_ragged_gemm_packed(s, product):
+    """Schedule the packing stages and the micro-kernel of
+    ragged_batch_matmul_packed."""
+    stages = {t.op.name: t for t in product.op.input_tensors}
+    x_packed = stages['T_ragged_batch_matmul_xpack']
+    y_packed = stages['T_ragged_batch_matmul_ypack']
+    mr = get_const_tuple(x_packed.shape)[3]
+    nr = get_const_tuple(y_packed.shape)[3]
+
+    # The packing of each panel is independent.
+    b, p, _, r = s[x_packed].op.axis
+    s[x_packed].parallel(s[x_packed].fuse(b, p, padding=1))
+    s[x_packed].unroll(r)
+    b, jo, _, ji = s[y_packed].op.axis
+    s[y_packed].parallel(s[y_packed].fuse(b, jo))
+    s[y_packed].vectorize(ji)
+
+    # Fusing the batch and the rounded rows leaves one flat loop over the
+    # (sequence, tile) pairs, which the thread pool splits evenly however
+    # the lengths vary. Each tile accumulates an mr x nr block in registers.
+    b, i, j = s[product].op.axis
+    k, = s[product].op.reduce_axis
+    tiles, ii = s[product].split(s[product].fuse(b, i, padding=mr), factor=mr)
+    jo, ji = s[product].split(j, factor=nr)
+    ko, ki = s[product].split(k, factor=4)
+    s[product].reorder(tiles, jo, ko, ki, ii, ji)
+    s[product].unroll(ki)
+    s[product].unroll(ii)
+    s[product].vectorize(ji)
+    s[product].parallel(tiles)
+
+
+@generic.schedule_ragged_batch_matmul.register(["cpu"])
+def schedule_ragged_batch_matmul(outs):
+    """Schedule for ragged_batch_matmul
+
+    For the packed declaration, see _schedule_ragged_gemm_packed.
+    Otherwise, the batch and row axes run in parallel, and each output row
+    is computed column by column over the ragged reduction, which is
+    empty on the padded rows.
+
+    Parameters
+    ----------
+    outs: Array of Tensor
+          The computation graph description of ragged_batch_matmul
+          in the format of an array of tensors.
+
+    Returns
+    -------
+    sch: Schedule
+        The computation schedule for the op.
+    """
+    outs = [outs] if isinstance(outs, tvm.tensor.Tensor) else outs
+    s = tvm.create_schedule([x.op for x in outs])
+    out = outs[0]
+    packed, masks = [], []
+
+    def _callback(op):
+        if op.tag != 'ragged_batch_matmul':
+            return
+        for tensor in op.input_tensors:
+            if tensor.op.tag == 'ragged_batch_matmul_packed':
+                packed.append(tensor)
+                if op not in s.outputs:
+                    masks.append(op)
+
+    traverse_inline(s, out.op, _callback)
+    if not packed:
+        tvm.schedule.AutoInlineInjective(s)
+        b, i, _ = s[out].op.axis
+        s[out].parallel(s[out].fuse(b, i))
+        return s
+
+    _schedule_ragged_gemm_packed(s, packed[0])
+    for op in masks:
+        s[op].compute_inline()
+    b, i, j = s[out].op.axis
+    _, nr = _ragged_gemm_tiles(1, get_const_tuple(out.shape)[2], out.dtype)
+    _, ji = s[out].split(j, factor=nr)
+    s[out].parallel(s[out].fuse(b, i))
+    s[out].vectorize(ji)
+    return s
+
+
+@ragged_mode.register(["cpu"])
+def _ragged_mode_x86(lengths, extent, dtype):
+    # Round the ragged loops up to whole vectors of dtype.
+    lanes = get_fp32_len() * 32 // tvm.DataType(dtype).bits
+    return ragged_mode_tiled(lengths, extent, lanes)
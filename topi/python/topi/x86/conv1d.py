@@ -129,3 +129,24 @@ def schedule_conv1d_nwc(outs):
 
     traverse(output_op)
     return s
+
+
+@generic.schedule_ragged_conv1d_nwc.register(["cpu"])
+def schedule_ragged_conv1d_nwc(outs):
+    """Schedule for ragged_conv1d_nwc on x86
+
+    The batch and ragged width loops are fused into one parallel loop over
+    the packed positions, and the output channels are vectorized."""
+    outs = [outs] if isinstance(outs, tvm.tensor.Tensor) else outs
+    s = tvm.create_schedule([x.op for x in outs])
+    conv = outs[0]
+    if conv.op.tag != 'ragged_conv1d':
+        raise ValueError('Tag is expected to be ragged_conv1d. Got {0}'.format(conv.op.tag))
+    b, w, c = s[conv].op.axis
+    rc, rw = s[conv].op.reduce_axis
+    fused = s[conv].fuse(b, w)
+    co, ci = s[conv].split(c, factor=16)
+    s[conv].reorder(fused, co, rc, rw, ci)
+    s[conv].parallel(fused)
+    s[conv].vectorize(ci)
+    return s
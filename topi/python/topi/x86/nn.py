@@ -67,3 +67,121 @@ def schedule_softmax(outs):
         s[exp].compute_at(s[softmax], fused_outer_axes)
 
     return s
+
+
+def _parallel_outer(s, tensor):
+    """Run the outer spatial axes of a ragged stage in parallel. The last
+    axis, and the ragged reduction of each point, run serially."""
+    axes = s[tensor].op.axis
+    outer = s[tensor].fuse(*axes[:-1]) if len(axes) > 1 else axes[0]
+    s[tensor].parallel(outer)
+
+
+@generic.schedule_ragged_softmax.register(["cpu"])
+def schedule_ragged_softmax(outs):
+    """Schedule for ragged_softmax
+
+    Parameters
+    ----------
+    outs: Array of Tensor
+          The computation graph description of ragged_softmax
+          in the format of an array of tensors.
+
+    Returns
+    -------
+    sch: Schedule
+        The computation schedule for the op.
+    """
+    outs = [outs] if isinstance(outs, tvm.tensor.Tensor) else outs
+    s = tvm.create_schedule([x.op for x in outs])
+    softmax = outs[0]
+    tvm.schedule.AutoInlineInjective(s)
+    stages = {t.op.name: t for t in softmax.op.input_tensors}
+    for tensor in [stages['T_ragged_softmax_maxelem'], stages['T_ragged_softmax_expsum'],
+                   softmax]:
+        _parallel_outer(s, tensor)
+    return s
+
+
+@generic.schedule_ragged_layer_norm.register(["cpu"])
+def schedule_ragged_layer_norm(outs):
+    """Schedule for ragged_layer_norm
+
+    Parameters
+    ----------
+    outs: Array of Tensor
+          The computation graph description of ragged_layer_norm
+          in the format of an array of tensors.
+
+    Returns
+    -------
+    sch: Schedule
+        The computation schedule for the op.
+    """
+    outs = [outs] if isinstance(outs, tvm.tensor.Tensor) else outs
+    s = tvm.create_schedule([x.op for x in outs])
+    norm = outs[0]
+    tvm.schedule.AutoInlineInjective(s)
+    stages = {t.op.name: t for t in norm.op.input_tensors}
+    for tensor in [stages['T_ragged_layer_norm_mean'], stages['T_ragged_layer_norm_var'],
+                   norm]:
+        _parallel_outer(s, tensor)
+    return s
+
+
+@generic.schedule_ragged_attention.register(["cpu"])
+def schedule_ragged_attention(outs):
+    """Schedule for ragged_attention
+
+    Parameters
+    ----------
+    outs: Array of Tensor
+          The computation graph description of ragged_attention
+          in the format of an array of tensors.
+
+    Returns
+    -------
+    sch: Schedule
+        The computation schedule for the op.
+    """
+    outs = [outs] if isinstance(outs, tvm.tensor.Tensor) else outs
+    s = tvm.create_schedule([x.op for x in outs])
+    out = outs[0]
+    prob = {t.op.name: t for t in out.op.input_tensors}['T_ragged_softmax_norm']
+    stages = {t.op.name: t for t in prob.op.input_tensors}
+    for tensor in [stages['T_ragged_attention_score'], stages['T_ragged_softmax_maxelem'],
+                   stages['T_ragged_softmax_expsum'], prob, out]:
+        _parallel_outer(s, tensor)
+    return s
+
+
+@generic.schedule_ragged_embedding_bag.register(["cpu"])
+def schedule_ragged_embedding_bag(outs):
+    """Schedule for ragged_embedding_bag
+
+    Bags run in parallel. Each bag is reduced into a row of the output
+    one gathered row at a time, vectorized along the embedding.
+
+    Parameters
+    ----------
+    outs: Array of Tensor
+          The computation graph description of ragged_embedding_bag
+          in the format of an array of tensors.
+
+    Returns
+    -------
+    sch: Schedule
+        The computation schedule for the op.
+    """
+    outs = [outs] if isinstance(outs, tvm.tensor.Tensor) else outs
+    s = tvm.create_schedule([x.op for x in outs])
+    out = outs[0]
+    tvm.schedule.AutoInlineInjective(s)
+    bag = {t.op.name: t for t in out.op.input_tensors}['T_ragged_embedding_bag_reduce']
+    b, j = s[out].op.axis
+    s[out].parallel(b)
+    s[out].vectorize(j)
+    s[bag].compute_at(s[out], b)
+    s[bag].reorder(s[bag].op.reduce_axis[0], s[bag].op.axis[1])
+    s[bag].vectorize(s[bag].op.axis[1])
+    return s
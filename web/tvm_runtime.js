@@ -219,6 +219,20 @@ var tvm_runtime = tvm_runtime || {};
       "number"  // int TVMArrayHandle* out
      ]);
 
+    var TVMRaggedArrayAlloc = Module.cwrap
+    ("TVMRaggedArrayAlloc",
+     "number",
+     ["number", // const tvm_index_t* shape
+      "number", // const tvm_index_t flat_size
+      "number", // int ndim
+      "number", // int dtype_code
+      "number", // int dtype_bits
+      "number", // int dtype_lanes
+      "number", // int device_type
+      "number", // int device_id
+      "number"  // int TVMArrayHandle* out
+     ]);
+
     var TVMArrayFree = Module.cwrap
     ("TVMArrayFree",
      "number",
@@ -237,7 +251,8 @@ var tvm_runtime = tvm_runtime || {};
      "number",
      ["number", // TVMArrayHandle handle
       "number", // int data
-      "number"  // size_t nbytes
+      "number", // size_t nbytes
+      "number"  // bool is_dst_ragged
      ]);
 
     var TVMArrayCopyToBytes = Module.cwrap
@@ -245,7 +260,8 @@ var tvm_runtime = tvm_runtime || {};
      "number",
      ["number", // TVMArrayHandle handle
       "number", // int data
-      "number"  // size_t nbytes
+      "number", // size_t nbytes
+      "number"  // bool is_src_ragged
      ]);
 
     var TVMModLoadFromFile = Module.cwrap
@@ -782,6 +798,41 @@ var tvm_runtime = tvm_runtime || {};
       out.release();
       return new NDArray(out_handle);
     };
+    /**
+     * Create an empty ragged ndarray with given dense shape, with room
+     * for the packed valid elements of its rows.
+     *
+     * Modules with ragged functions are built for the "llvm" target with
+     * "-system-lib", their prep code included, and run on the CPU, where
+     * the auxiliary arrays the prep code computes stay in WASM memory.
+     *
+     * @param {Array.<number>} shape The dense shape of the array.
+     * @param {number} flat_size The number of packed elements.
+     * @param {string} dtype The data type of the array, optional, default="float32"
+     * @param {tvm.TVMContext} ctx The context of the array, optional, default=cpu(0).
+     * @return {tvm.NDArray} The created ndarray.
+     */
+    this.emptyRagged = function(shape, flat_size, dtype, ctx) {
+      dtype = (typeof dtype !== "undefined") ?  dtype: "float32";
+      ctx = (typeof ctx !== "undefined") ?  ctx : context("cpu", 0);
+      shape = (typeof shape == "number") ? [shape] : shape;
+      // alloc
+      var cshape = Module._malloc(SIZEOF_INT64 * shape.length);
+      var out = new RefTVMValue();
+      for (var i = 0; i < shape.length; ++i) {
+        Module.setValue(cshape + i * SIZEOF_INT64, shape[i], "i64");
+      }
+      dtype = getTVMType(dtype);
+      TVM_CALL(TVMRaggedArrayAlloc(cshape, flat_size, shape.length,
+                                   dtype.code, dtype.bits, dtype.lanes,
+                                   ctx.device_type, ctx.device_id,
+                                   out.data));
+      var out_handle = out.asHandle();
+      // release
+      Module._free(cshape);
+      out.release();
+      return new NDArray(out_handle);
+    };
     /**
      * List all global function names in the TVM runtime.
      * @return {Array.<string>} List of global function names.
@@ -1161,10 +1212,40 @@ var tvm_runtime = tvm_runtime || {};
               " vs " + nbytes);
         var temp = Module._malloc(nbytes);
         Module.HEAPU8.set(data, temp);
-        TVM_CALL(TVMArrayCopyFromBytes(this.handle, temp, nbytes));
+        TVM_CALL(TVMArrayCopyFromBytes(this.handle, temp, nbytes, 0));
+        Module._free(temp);
+        return this;
+      },
+      /**
+       * Copy the packed data of a ragged NDArray, the valid elements of
+       * its rows one after the other, from raw bytes, which may be fewer
+       * than the dense shape implies.
+       * @param {Uint8Array} data Uint8Array of bytes.
+       */
+      copyFromRaggedBytes : function(data) {
+        CHECK(data instanceof Uint8Array);
+        var nbytes = data.length;
+        var temp = Module._malloc(nbytes);
+        Module.HEAPU8.set(data, temp);
+        TVM_CALL(TVMArrayCopyFromBytes(this.handle, temp, nbytes, 1));
         Module._free(temp);
         return this;
       },
+      /**
+       * Return a copied Uint8Array of the first flat_size packed
+       * elements of a ragged NDArray.
+       * @param {number} flat_size The number of packed elements.
+       * @return {Uint8Array} The created array.
+       */
+      asRaggedBytes : function(flat_size) {
+        var nbytes = this.BYTES_PER_ELEMENT * flat_size;
+        var temp = Module._malloc(nbytes);
+        TVM_CALL(TVMArrayCopyToBytes(this.handle, temp, nbytes, 1));
+        var ret = new Uint8Array(new ArrayBuffer(nbytes));
+        ret.set(new Uint8Array(Module.HEAPU8.buffer, temp, nbytes));
+        Module._free(temp);
+        return ret;
+      },
       /**
        * Return a copied Uint8Array of the raw bytes in the NDArray.
        * @return {Uint8Array} The created array.
@@ -1173,7 +1254,7 @@ var tvm_runtime = tvm_runtime || {};
         var size = this.shape.reduce(function(a, b) { return a * b; }, 1);
         var nbytes = this.BYTES_PER_ELEMENT * size;
         var temp = Module._malloc(nbytes);
-        TVM_CALL(TVMArrayCopyToBytes(this.handle, temp, nbytes));
+        TVM_CALL(TVMArrayCopyToBytes(this.handle, temp, nbytes, 0));
         var ret = new Uint8Array(new ArrayBuffer(nbytes));
         ret.set(new Uint8Array(Module.HEAPU8.buffer, temp, nbytes));
         Module._free(temp);
@@ -26,6 +26,7 @@
 #include "../src/runtime/c_runtime_api.cc"
 #include "../src/runtime/cpu_device_api.cc"
 #include "../src/runtime/workspace_pool.cc"
+#include "../src/runtime/memory_profile.cc"
 #include "../src/runtime/library_module.cc"
 #include "../src/runtime/system_library.cc"
 #include "../src/runtime/module.cc"
@@ -33,6 +34,10 @@
 #include "../src/runtime/object.cc"
 #include "../src/runtime/registry.cc"
 #include "../src/runtime/file_util.cc"
+#include "../src/runtime/mapped_file.cc"
+#include "../src/runtime/prep_code_cache.cc"
+#include "../src/runtime/prep_code_profile.cc"
+#include "../src/runtime/prep_code_update.cc"
 #include "../src/runtime/dso_library.cc"
 #include "../src/runtime/rpc/rpc_session.cc"
 #include "../src/runtime/rpc/rpc_event_impl.cc"
@@ -86,3 +91,8 @@ int TVMBackendParallelLaunch(
 int TVMBackendParallelBarrier(int task_id, TVMParallelGroupEnv* penv) {
   return 0;
 }
+
+int TVMBackendParallelNextChunk(TVMParallelGroupEnv* penv, int64_t extent, int64_t min_chunk,
+                                int guided, int64_t* begin, int64_t* end) {
+  return 0;
+}